@@ -2,6 +2,7 @@
 #include "app/core/app_core.h"
 #include "app/game/game.h"
 #include "sys/mem_allocator.h"
+#include "sys/profiler.h"
 #include "window_manager/wm_input.h"
 #include <assert.h>
 #include <getopt.h>
@@ -31,7 +32,8 @@ parse_args
    char** argv,
    const char** model_path,
    const char** render_driver_path,
-   const char** term_font_path)
+   const char** term_font_path,
+   const char** trace_path)
 {
   int err = 0;
   int i = 0;
@@ -41,7 +43,7 @@ parse_args
   if(argc == 1)
     goto usage;
 
-  while(-1 != (i = getopt(argc, argv, "f:r:m:h"))) {
+  while(-1 != (i = getopt(argc, argv, "f:r:m:hp:"))) {
     switch(i) {
       case 'f':
         *term_font_path = optarg;
@@ -52,6 +54,9 @@ parse_args
       case 'm':
         *model_path = optarg;
         break;
+      case 'p':
+        *trace_path = optarg;
+        break;
       case 'r':
         *render_driver_path = optarg;
         break;
@@ -71,9 +76,10 @@ exit:
   return err;
 usage:
   printf
-    ("Usage: %s -r RENDER_DRIVER [-f TERM_FONT] [-m MODEL]\n"
+    ("Usage: %s -r RENDER_DRIVER [-f TERM_FONT] [-m MODEL] [-p TRACE]\n"
      "  -f  Define the TERM_FONT to use.\n"
      "  -m  Load MODEL at the launch of the application.\n"
+     "  -p  Profile the application and write the Chrome TRACE at exit.\n"
      "  -r  Define the RENDER_DRIVER to use.\n",
      argv[0]);
   err = 1;
@@ -141,6 +147,7 @@ main(int argc, char** argv)
   const char* term_font_path = NULL;
   const char* model_path = NULL;
   const char* render_driver_path = NULL;
+  const char* trace_path = NULL;
   enum app_error app_err = APP_NO_ERROR;
   enum edit_error edit_err = EDIT_NO_ERROR;
   enum game_error game_err = GAME_NO_ERROR;
@@ -157,7 +164,8 @@ main(int argc, char** argv)
 
   /* Parse the argument list. */
   err = parse_args
-    (argc, argv, &model_path, &render_driver_path, &term_font_path);
+    (argc, argv, &model_path, &render_driver_path, &term_font_path,
+     &trace_path);
   if(err == 1) {
     err = 0;
     goto exit;
@@ -165,6 +173,8 @@ main(int argc, char** argv)
     goto error;
   }
   atexit(app_exit);
+  if(trace_path)
+    prof_enable(true);
 
   /* Initialize the application modules. */
   args.allocator = &engine_allocator;
@@ -251,6 +261,14 @@ exit:
       printf("Engine leaks summary:\n%s\n", buffer);
     }
   }
+  /* Dump the trace once the model loader threads are joined. */
+  if(trace_path) {
+    FILE* trace = fopen(trace_path, "w");
+    if(!trace || prof_dump_chrome_trace(trace) != 0)
+      fprintf(stderr, "Error writing the trace `%s'.\n", trace_path);
+    if(trace)
+      fclose(trace);
+  }
   mem_shutdown_proxy_allocator(&edit_allocator);
   mem_shutdown_proxy_allocator(&engine_allocator);
   mem_shutdown_proxy_allocator(&game_allocator);
@@ -139,6 +139,9 @@ app_has_command
    const char* name,
    bool* has_command);
 
+/* The syntaxes of the command are tried from the last added one and the first
+ * syntax that accepts the command line is invoked. The syntaxes of a command
+ * should thus not be ambiguous. */
 APP_API enum app_error
 app_execute_command
   (struct app* app,
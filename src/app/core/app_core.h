@@ -5,6 +5,7 @@
 #include "app/core/app_error.h"
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 struct app_args {
   const char* term_font;
@@ -13,6 +14,29 @@ struct app_args {
   struct mem_allocator* allocator; /* May be NULL. */
 };
 
+/* Distribution of a time over the last recorded frames, in milliseconds. */
+struct app_time_stats {
+  float median;
+  float p95;
+  float p99;
+  float max;
+};
+
+struct app_frame_stats {
+  struct app_time_stats frame_time; /* Between the end of two frames. */
+  struct app_time_stats cpu_time; /* Frame time without the buffer swap. */
+  size_t nb_timed_frames;
+  /* Counters of the last frame. */
+  size_t nb_draw_calls;
+  size_t nb_state_changes;
+  size_t uploaded_size; /* In bytes. */
+  size_t nb_instances;
+  size_t nb_culled_instances;
+  size_t nb_triangles;
+  size_t allocated_size; /* Memory allocated by the engine, in bytes. */
+  int64_t allocated_size_delta;
+};
+
 struct app;
 struct app_model;
 struct app_model_instance;
@@ -30,6 +54,10 @@ enum app_signal {
   APP_SIGNAL_DESTROY_MODEL,
   APP_SIGNAL_CREATE_MODEL_INSTANCE,
   APP_SIGNAL_DESTROY_MODEL_INSTANCE,
+  /* Invoked once per frame with the whole list of the model instances whose
+   * world transform changed since the previous frame. The callback signature is
+   * void(struct app_model_instance* list[], size_t nb_instances, void*). */
+  APP_SIGNAL_TRANSFORM_MODEL_INSTANCES,
   APP_NB_SIGNALS
 };
 
@@ -121,6 +149,11 @@ app_is_callback_attached
    void* data,
    bool* is_attached);
 
+APP_API enum app_error
+app_get_frame_stats
+  (struct app* app,
+   struct app_frame_stats* stats);
+
 /* When enabled, the terminal intercepts user inputs. */
 APP_API enum app_error
 app_enable_term
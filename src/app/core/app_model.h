@@ -20,6 +20,11 @@ struct app_model_it {
   size_t id;
 };
 
+typedef void (*app_model_load_callback_t)
+  (struct app_model* model,
+   enum app_error err,
+   void* data);
+
 APP_API enum app_error
 app_create_model
   (struct app* app,
@@ -51,6 +56,21 @@ app_load_model
   (const char* path,
    struct app_model* model);
 
+/* Load the model resource on a loader thread. The render data of the model
+ * are set up, and the callback is invoked, by the thread that runs the app_run
+ * or the app_flush_model_loads functions once the resource is built. */
+APP_API enum app_error
+app_load_model_async
+  (const char* path,
+   struct app_model* model,
+   app_model_load_callback_t func, /* May be NULL. */
+   void* data);
+
+/* Wait for the completion of the asynchronous model loads. */
+APP_API enum app_error
+app_flush_model_loads
+  (struct app* app);
+
 APP_API enum app_error
 app_model_path
   (const struct app_model* model,
@@ -71,6 +91,20 @@ app_is_model_instantiated
   (const struct app_model* model,
    bool* is_instantiated);
 
+/* Use the triangles of the model as occluders of the occlusion culling, e.g.
+ * for the walls of a building. The occluders are rasterized for each instance
+ * and should thus have few triangles. The instances of an occluder model are
+ * never culled by the occluders. */
+APP_API enum app_error
+app_set_model_occluder
+  (struct app_model* model,
+   bool is_occluder);
+
+APP_API enum app_error
+app_is_model_occluder
+  (const struct app_model* model,
+   bool* is_occluder);
+
 APP_API enum app_error
 app_get_model_aabb
   (const struct app_model* mdl,
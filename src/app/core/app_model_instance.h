@@ -23,6 +23,18 @@ app_instantiate_model
    const char* name, /* May be NULL. */
    struct app_model_instance** instance); /* May be NULL. */
 
+/* Create nb_instances instances of model at once. A NULL name gives a default
+ * name to the instance; the transform list defines the initial transformation
+ * of each instance. On error no instance is created. */
+APP_API enum app_error
+app_instantiate_model_n
+  (struct app* app,
+   struct app_model* model,
+   size_t nb_instances,
+   const char* name_list[], /* May be NULL. */
+   const struct aosf44* transform_list, /* May be NULL. */
+   struct app_model_instance* instance_list[]);
+
 /* Remove the instance from the application. If the instance is referenced
  * elsewehere, it is unregistered from the application without freeing it. */
 APP_API enum app_error
@@ -52,11 +64,42 @@ app_model_instance_name
   (const struct app_model_instance* instance,
    const char** cstr);
 
+/* The raw transform is relative to the parent of the instance. The transform
+ * functions below thus transform the instances in the space of their parent.
+ */
 APP_API enum app_error
 app_get_raw_model_instance_transform
   (const struct app_model_instance* instance,
    const struct aosf44** transform);
 
+APP_API enum app_error
+app_get_model_instance_world_transform
+  (const struct app_model_instance* instance,
+   struct aosf44* transform);
+
+/* Attach the instance to a parent whose world transform then applies to the
+ * instance. The raw transform of the instance is kept. A NULL parent detaches
+ * the instance; an instance cannot be one of its own ancestors. The children
+ * of a released instance are detached but keep their world transform. */
+APP_API enum app_error
+app_set_model_instance_parent
+  (struct app_model_instance* instance,
+   struct app_model_instance* parent); /* May be NULL. */
+
+APP_API enum app_error
+app_get_model_instance_parent
+  (const struct app_model_instance* instance,
+   struct app_model_instance** parent); /* Set to NULL for a root instance. */
+
+/* Propagate the transforms changed since the last commit to the descendants
+ * of the changed instances and to their render data, and notify the updated
+ * instances with the APP_SIGNAL_TRANSFORM_MODEL_INSTANCES signal. It is
+ * invoked by app_run before drawing and must not be invoked by the callbacks
+ * of this signal. */
+APP_API enum app_error
+app_commit_model_instance_transforms
+  (struct app* app);
+
 APP_API enum app_error
 app_translate_model_instances
   (struct app_model_instance* instance_list[],
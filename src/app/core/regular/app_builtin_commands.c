@@ -1,5 +1,7 @@
 #include "app/core/regular/app_builtin_commands.h"
 #include "app/core/regular/app_core_c.h"
+#include "app/core/regular/app_model_loader_c.h"
+#include "app/core/regular/app_stats_c.h"
 #include "app/core/app_command.h"
 #include "app/core/app_cvar.h"
 #include "app/core/app_model.h"
@@ -165,6 +167,26 @@ cmd_help
     APP_PRINT_MSG(app->logger, "%s", app->cmd.scratch);
 }
 
+static void
+cmd_loads
+  (struct app* app,
+   size_t argc UNUSED,
+   const struct app_cmdarg** argv UNUSED,
+   void* data UNUSED)
+{
+  APP(print_model_loads(app));
+}
+
+static void
+cmd_stats
+  (struct app* app,
+   size_t argc UNUSED,
+   const struct app_cmdarg** argv UNUSED,
+   void* data UNUSED)
+{
+  APP(print_stats(app));
+}
+
 static void
 cmd_ls
   (struct app* app,
@@ -332,6 +354,10 @@ app_setup_builtin_commands(struct app* app)
       APP_CMDARG_END),
      "give command informations"));
 
+  CALL(app_add_command
+    (app, "loads", cmd_loads, NULL, NULL, NULL,
+     "list the in-flight model loads"));
+
   CALL(app_add_command
     (app, "ls", cmd_ls, NULL, NULL,
      APP_CMDARGV
@@ -354,6 +380,10 @@ app_setup_builtin_commands(struct app* app)
       APP_CMDARG_END),
      "set the value of a client variable"));
 
+  CALL(app_add_command
+    (app, "stats", cmd_stats, NULL, NULL, NULL,
+     "print the frame statistics"));
+
   #undef CALL
 
 exit:
@@ -17,15 +17,33 @@
 #include <stdio.h>
 #include <string.h>
 
+/* Typed view on the argtable results of an argument. It is resolved once when
+ * the syntax is added so that the execution of a command line does not
+ * dispatch on the argtable types. */
+struct cmdarg_source {
+  struct arg_hdr* hdr;
+  const int* count; /* Number of parsed values. */
+  union {
+    const char** string; /* String and file args. */
+    const int* integer;
+    const double* real;
+  } values; /* Unused by the literals. */
+};
+
 struct app_command {
   struct list_node node;
   size_t argc;
+  /* Range of the number of tokens, command name included, of the command
+   * lines that this syntax may accept. */
+  size_t min_tokens;
+  size_t max_tokens;
   void(*func)(struct app*, size_t, const struct app_cmdarg**, void* data);
   void* data;
   enum app_error (*completion)
     (struct app*, const char*, size_t, size_t*, const char**[]);
   struct sl_string* description;
   union app_cmdarg_domain* arg_domain;
+  struct cmdarg_source* arg_source; /* Indexed as argv. */
   struct app_cmdarg** argv;
   void** arg_table;
 };
@@ -74,6 +92,40 @@ cmpstr(const void* a, const void* b)
  * Helper function.
  *
  ******************************************************************************/
+static void
+bind_arg_source
+  (struct cmdarg_source* src,
+   const enum app_cmdarg_type type,
+   void* arg)
+{
+  assert(src);
+  if(!arg) /* Checked by arg_nullcheck. */
+    return;
+  src->hdr = (struct arg_hdr*)arg;
+  switch(type) {
+    case APP_CMDARG_INT:
+      src->count = &((struct arg_int*)arg)->count;
+      src->values.integer = ((struct arg_int*)arg)->ival;
+      break;
+    case APP_CMDARG_FILE:
+      src->count = &((struct arg_file*)arg)->count;
+      src->values.string = ((struct arg_file*)arg)->filename;
+      break;
+    case APP_CMDARG_FLOAT:
+      src->count = &((struct arg_dbl*)arg)->count;
+      src->values.real = ((struct arg_dbl*)arg)->dval;
+      break;
+    case APP_CMDARG_STRING:
+      src->count = &((struct arg_str*)arg)->count;
+      src->values.string = ((struct arg_str*)arg)->sval;
+      break;
+    case APP_CMDARG_LITERAL:
+      src->count = &((struct arg_lit*)arg)->count;
+      break;
+    default: assert(0); break;
+  }
+}
+
 static enum app_error
 init_domain_and_table
   (struct app* app UNUSED,
@@ -133,6 +185,7 @@ init_domain_and_table
       }
       cmd->arg_table[i] = arg;
       cmd->arg_domain[i + 1] = argv_desc[i].domain; /* +1 <=> command name. */
+      bind_arg_source(cmd->arg_source + i + 1, argv_desc[i].type, arg);
     }
   }
 
@@ -157,38 +210,14 @@ static FINLINE void
 set_optvalue_flag(struct app_command* cmd, const bool val)
 {
   size_t argv_id = 0;
-  size_t tbl_id = 0;
   assert(cmd);
 
-  #define SET_OPTVAL(arg, val) \
-    do { \
-      if(val) \
-        (arg)->hdr.flag |= ARG_HASOPTVALUE; \
-      else \
-        (arg)->hdr.flag &= ~ARG_HASOPTVALUE; \
-    } while(0)
-
-  for(argv_id = 1, tbl_id = 0; argv_id < cmd->argc; ++argv_id, ++tbl_id) {
-    switch(cmd->argv[argv_id]->type) {
-      case APP_CMDARG_INT:
-        SET_OPTVAL((struct arg_int*)cmd->arg_table[tbl_id], val);
-        break;
-      case APP_CMDARG_FILE:
-        SET_OPTVAL((struct arg_file*)cmd->arg_table[tbl_id], val);
-        break;
-      case APP_CMDARG_FLOAT:
-        SET_OPTVAL((struct arg_dbl*)cmd->arg_table[tbl_id], val);
-        break;
-      case APP_CMDARG_STRING:
-        SET_OPTVAL((struct arg_str*)cmd->arg_table[tbl_id], val);
-        break;
-      case APP_CMDARG_LITERAL:
-        SET_OPTVAL((struct arg_lit*)cmd->arg_table[tbl_id], val);
-        break;
-      default: assert(0); break;
-    }
+  for(argv_id = 1; argv_id < cmd->argc; ++argv_id) {
+    if(val)
+      cmd->arg_source[argv_id].hdr->flag |= ARG_HASOPTVALUE;
+    else
+      cmd->arg_source[argv_id].hdr->flag &= ~ARG_HASOPTVALUE;
   }
-  #undef SET_OPTVAL
 }
 
 static int
@@ -196,29 +225,10 @@ defined_args_count(struct app_command* cmd)
 {
   int count = 0;
   size_t argv_id = 0;
-  size_t tbl_id = 0;
   assert(cmd);
 
-  for(argv_id = 1, tbl_id = 0; argv_id < cmd->argc; ++argv_id, ++tbl_id) {
-    switch(cmd->argv[argv_id]->type) {
-      case APP_CMDARG_INT:
-        count += ((struct arg_int*)cmd->arg_table[tbl_id])->count;
-        break;
-      case APP_CMDARG_FILE:
-        count += ((struct arg_file*)cmd->arg_table[tbl_id])->count;
-        break;
-      case APP_CMDARG_FLOAT:
-        count += ((struct arg_dbl*)cmd->arg_table[tbl_id])->count;
-        break;
-      case APP_CMDARG_STRING:
-        count += ((struct arg_str*)cmd->arg_table[tbl_id])->count;
-        break;
-      case APP_CMDARG_LITERAL:
-        count += ((struct arg_lit*)cmd->arg_table[tbl_id])->count;
-        break;
-      default: assert(0); break;
-    }
-  }
+  for(argv_id = 1; argv_id < cmd->argc; ++argv_id)
+    count += *cmd->arg_source[argv_id].count;
   return count;
 }
 
@@ -232,73 +242,54 @@ setup_cmd_arg(struct app* app, struct app_command* cmd, const char* name)
   cmd->argv[0]->value_list[0].is_defined = true;
   cmd->argv[0]->value_list[0].data.string = name;
   for(arg_id = 1; arg_id < cmd->argc; ++arg_id) {
-    const char** value_list = NULL;
-    const char* str = NULL;
-    const size_t arg_tbl_id = arg_id - 1; /* -1 <=> arg name. */
-    int val_id = 0;
-    bool isdef = true;
-
-    for(val_id=0; isdef && (size_t)val_id<cmd->argv[arg_id]->count; ++val_id) {
-      switch(cmd->argv[arg_id]->type) {
+    const struct cmdarg_source* src = cmd->arg_source + arg_id;
+    const union app_cmdarg_domain* domain = cmd->arg_domain + arg_id;
+    struct app_cmdarg* arg = cmd->argv[arg_id];
+    const size_t nb_values = MIN((size_t)*src->count, arg->count);
+    size_t val_id = 0;
+
+    for(val_id = 0; val_id < nb_values; ++val_id) {
+      struct app_cmdarg_value* value = arg->value_list + val_id;
+      switch(arg->type) {
         case APP_CMDARG_STRING:
-          isdef = val_id < ((struct arg_str*)cmd->arg_table[arg_tbl_id])->count;
-          if(isdef) {
-            str = ((struct arg_str*)(cmd->arg_table[arg_tbl_id]))->sval[val_id];
-            /* Check the string domain. */
-            value_list = cmd->arg_domain[arg_id].string.value_list;
-            if(value_list == NULL) {
-              cmd->argv[arg_id]->value_list[val_id].data.string = str;
-            } else {
-              size_t i = 0;
-              for(i = 0; value_list[i] != NULL; ++i) {
-                if(strcmp(str, value_list[i]) == 0)
-                  break;
-              }
-              if(value_list[i] != NULL) {
-                cmd->argv[arg_id]->value_list[val_id].data.string = str;
-              } else {
-                APP_PRINT_ERR
-                  (app->logger, "%s: unexpected option value `%s'\n",name, str);
-                app_err = APP_COMMAND_ERROR;
-                goto error;
-              }
+          value->data.string = src->values.string[val_id];
+          /* Check the string domain. */
+          if(domain->string.value_list) {
+            const char** value_list = domain->string.value_list;
+            size_t i = 0;
+            for(i = 0; value_list[i] != NULL; ++i) {
+              if(strcmp(value->data.string, value_list[i]) == 0)
+                break;
+            }
+            if(value_list[i] == NULL) {
+              APP_PRINT_ERR
+                (app->logger, "%s: unexpected option value `%s'\n",
+                 name, value->data.string);
+              app_err = APP_COMMAND_ERROR;
+              goto error;
             }
           }
           break;
         case APP_CMDARG_FILE:
-          isdef = val_id< ((struct arg_file*)cmd->arg_table[arg_tbl_id])->count;
-          if(isdef) {
-            cmd->argv[arg_id]->value_list[val_id].data.string =
-             ((struct arg_file*)(cmd->arg_table[arg_tbl_id]))->filename[val_id];
-          }
+          value->data.string = src->values.string[val_id];
           break;
         case APP_CMDARG_INT:
-          isdef = val_id < ((struct arg_int*)cmd->arg_table[arg_tbl_id])->count;
-          if(isdef) {
-            cmd->argv[arg_id]->value_list[val_id].data.integer = MAX(MIN(
-              ((struct arg_int*)(cmd->arg_table[arg_tbl_id]))->ival[val_id],
-              cmd->arg_domain[arg_id].integer.max),
-              cmd->arg_domain[arg_id].integer.min);
-          }
+          value->data.integer = MAX(MIN
+            (src->values.integer[val_id], domain->integer.max),
+             domain->integer.min);
           break;
         case APP_CMDARG_FLOAT:
-          isdef = val_id < ((struct arg_dbl*)cmd->arg_table[arg_tbl_id])->count;
-          if(isdef) {
-            cmd->argv[arg_id]->value_list[val_id].data.real = MAX(MIN(
-              ((struct arg_dbl*)(cmd->arg_table[arg_tbl_id]))->dval[val_id],
-              cmd->arg_domain[arg_id].real.max),
-              cmd->arg_domain[arg_id].real.min);
-          }
-          break;
-        case APP_CMDARG_LITERAL:
-          isdef = val_id < ((struct arg_lit*)cmd->arg_table[arg_tbl_id])->count;
-          break;
-        default:
-          assert(0);
+          value->data.real = MAX(MIN
+            (src->values.real[val_id], domain->real.max),
+             domain->real.min);
           break;
+        case APP_CMDARG_LITERAL: break;
+        default: assert(0); break;
       }
-      cmd->argv[arg_id]->value_list[val_id].is_defined = isdef;
+      value->is_defined = true;
     }
+    for(; val_id < arg->count; ++val_id)
+      arg->value_list[val_id].is_defined = false;
   }
 exit:
   return app_err;
@@ -306,6 +297,96 @@ error:
   goto exit;
 }
 
+static void
+count_tokens
+  (const struct app_cmdarg_desc* desc,
+   size_t* min_tokens,
+   size_t* max_tokens)
+{
+  bool is_option = false;
+  assert(desc && min_tokens && max_tokens);
+
+  is_option = desc->short_options || desc->long_options;
+  if(desc->type == APP_CMDARG_LITERAL) {
+    /* Short literals may be grouped in one token, e.g. "-vV", and even with
+     * the option of an other argument. They thus may not add any token. */
+    *max_tokens += desc->max_count;
+  } else {
+    /* An option value is either in the option token, e.g. "--name=foo" or
+     * "-nfoo", or in the following one. */
+    *min_tokens += desc->min_count;
+    *max_tokens += desc->max_count * (is_option ? 2 : 1);
+  }
+}
+
+static FINLINE struct command_cache_entry*
+get_cache_entry(struct app* app, struct list_node* list, size_t argc)
+{
+  const size_t id = (((uintptr_t)list >> 4) ^ (argc * 31));
+  assert(app && list);
+  return app->cmd.cache + (id & (APP_CMD_CACHE_SIZE - 1));
+}
+
+static FINLINE void
+clear_command_cache(struct app* app)
+{
+  assert(app);
+  memset(app->cmd.cache, 0, sizeof(app->cmd.cache));
+}
+
+static FINLINE bool
+is_arity_valid(const struct app_command* cmd, size_t argc)
+{
+  assert(cmd);
+  return argc >= cmd->min_tokens && argc <= cmd->max_tokens;
+}
+
+static enum app_error
+print_syntax_errors
+  (struct app* app,
+   struct list_node* command_list,
+   size_t argc,
+   char** argv)
+{
+  struct list_node* node = NULL;
+  long fpos = 0;
+  size_t size = 0;
+  size_t nb = 0;
+  int min_nerror = INT_MAX;
+  assert(app && command_list && argc && argv);
+
+  /* Print the syntax and the errors of the syntaxes that are the closest to
+   * the command line. The command line is parsed again since the arg tables
+   * keep the result of their last parsing only. */
+  LIST_FOR_EACH(node, command_list) {
+    struct app_command* cmd = CONTAINER_OF(node, struct app_command, node);
+    const int nerror = arg_parse(argc, argv, cmd->arg_table);
+
+    if(nerror <= min_nerror) {
+      if(nerror < min_nerror) {
+        min_nerror = nerror;
+        rewind(app->cmd.stream);
+      }
+      fprintf(app->cmd.stream, "\n%s", argv[0]);
+      arg_print_syntaxv(app->cmd.stream, cmd->arg_table, "\n");
+      arg_print_errors
+        (app->cmd.stream,
+         (struct arg_end*)cmd->arg_table[cmd->argc - 1],
+         argv[0]);
+    }
+  }
+  assert(min_nerror != 0);
+
+  fpos = ftell(app->cmd.stream);
+  size = MIN((size_t)fpos, sizeof(app->cmd.scratch)/sizeof(char) - 1);
+  rewind(app->cmd.stream);
+  nb = fread(app->cmd.scratch, size, 1, app->cmd.stream);
+  assert(nb == 1);
+  app->cmd.scratch[size] = '\0';
+  APP_PRINT_ERR(app->logger, "%s", app->cmd.scratch);
+  return APP_COMMAND_ERROR;
+}
+
 static enum app_error
 register_command
   (struct app* app,
@@ -398,6 +479,7 @@ del_all_commands(struct app* app)
       }
       MEM_FREE(app->allocator, cmd->argv);
       MEM_FREE(app->allocator, cmd->arg_domain);
+      MEM_FREE(app->allocator, cmd->arg_source);
       arg_freetable(cmd->arg_table, cmd->argc + 1); /* +1 <=> arg_end. */
       MEM_FREE(app->allocator, cmd->arg_table);
       MEM_FREE(app->allocator, cmd);
@@ -407,6 +489,7 @@ del_all_commands(struct app* app)
     SL(hash_table_it_next(&it, &b));
   }
   SL(hash_table_clear(app->cmd.htbl));
+  clear_command_cache(app);
 }
 
 /*******************************************************************************
@@ -428,6 +511,8 @@ app_add_command
   struct app_command* cmd = NULL;
   size_t argc = 0;
   size_t buffer_len = 0;
+  size_t min_tokens = 0;
+  size_t max_tokens = 0;
   size_t arg_id = 0;
   size_t desc_id = 0;
   size_t i = 0;
@@ -457,6 +542,7 @@ app_add_command
         goto error;
       }
       buffer_len += argv_desc[argc].max_count;
+      count_tokens(&argv_desc[argc], &min_tokens, &max_tokens);
     }
   }
   ++argc; /* +1 <=> command name. */
@@ -474,6 +560,12 @@ app_add_command
     app_err = APP_MEMORY_ERROR;
     goto error;
   }
+  cmd->arg_source = MEM_CALLOC
+    (app->allocator, argc, sizeof(struct cmdarg_source));
+  if(NULL == cmd->arg_source) {
+    app_err = APP_MEMORY_ERROR;
+    goto error;
+  }
   cmd->argv = MEM_CALLOC(app->allocator, argc, sizeof(struct app_cmdarg*));
   if(NULL == cmd->argv) {
     app_err = APP_MEMORY_ERROR;
@@ -510,6 +602,10 @@ app_add_command
     cmd->argv[arg_id]->count = argv_desc[desc_id].max_count;
   }
   cmd->argc = argc;
+  /* +1 <=> command name. The upper bound is relaxed by one token to accept
+   * the "--" end of options marker. */
+  cmd->min_tokens = min_tokens + 1;
+  cmd->max_tokens = max_tokens + 2;
 
   /* Setup the command description. */
   if(NULL == description) {
@@ -523,10 +619,12 @@ app_add_command
   }
   cmd->completion = completion_func;
 
-  /* Register the command against the command system. */
+  /* Register the command against the command system. The new syntax may
+   * take precedence over the cached ones. */
   app_err = register_command(app, cmd, name);
   if(app_err != APP_NO_ERROR)
     goto error;
+  clear_command_cache(app);
 
 exit:
   return app_err;
@@ -551,6 +649,10 @@ error:
       }
       MEM_FREE(app->allocator, cmd->argv);
     }
+    if(cmd->arg_source)
+      MEM_FREE(app->allocator, cmd->arg_source);
+    if(cmd->arg_domain)
+      MEM_FREE(app->allocator, cmd->arg_domain);
     MEM_FREE(app->allocator, cmd);
     cmd = NULL;
   }
@@ -580,6 +682,7 @@ app_del_command(struct app* app, const char* name)
   }
 
   /* Free the command syntaxes. */
+  clear_command_cache(app);
   list = (struct list_node*)pair.data;
   LIST_FOR_EACH_SAFE(pos, tmp, list) {
     struct app_command* cmd = CONTAINER_OF(pos, struct app_command, node);
@@ -592,6 +695,7 @@ app_del_command(struct app* app, const char* name)
     }
     MEM_FREE(app->allocator, cmd->argv);
     MEM_FREE(app->allocator, cmd->arg_domain);
+    MEM_FREE(app->allocator, cmd->arg_source);
     arg_freetable(cmd->arg_table, cmd->argc + 1); /* +1 <=> arg_end. */
     MEM_FREE(app->allocator, cmd->arg_table);
     MEM_FREE(app->allocator, cmd);
@@ -627,14 +731,15 @@ app_execute_command(struct app* app, const char* command)
 {
   #define MAX_ARG_COUNT 128
   char* argv[MAX_ARG_COUNT];
+  struct command_cache_entry* cache_entry = NULL;
   struct list_node* command_list = NULL;
   struct list_node* node = NULL;
   struct app_command* valid_cmd = NULL;
   char* name = NULL;
   char* ptr = NULL;
   size_t argc = 0;
+  size_t nb_candidates = 0;
   enum app_error app_err = APP_NO_ERROR;
-  int min_nerror = 0;
 
   if(!app || !command) {
     app_err = APP_INVALID_ARGUMENT;
@@ -664,43 +769,34 @@ app_execute_command(struct app* app, const char* command)
     argv[argc] = ptr;
   }
 
-  min_nerror = INT_MAX;
-  LIST_FOR_EACH(node, command_list) {
-    struct app_command* cmd = CONTAINER_OF(node, struct app_command, node);
-    int nerror = 0;
-
-    assert(cmd->argc > 0);
-    nerror = arg_parse(argc, argv, cmd->arg_table);
-
-    if(nerror <= min_nerror) {
-      if(nerror < min_nerror) {
-        min_nerror = nerror;
-        rewind(app->cmd.stream);
+  /* The syntaxes are tried in the order of the command list and those whose
+   * arity does not match the command line are not parsed. The syntax that
+   * accepted the line is cached if it is the only one of this arity; it is
+   * then the only syntax to try for the next lines of the same arity. */
+  cache_entry = get_cache_entry(app, command_list, argc);
+  if(cache_entry->list == command_list && cache_entry->argc == argc) {
+    assert(is_arity_valid(cache_entry->cmd, argc));
+    if(arg_parse(argc, argv, cache_entry->cmd->arg_table) == 0)
+      valid_cmd = cache_entry->cmd;
+  } else {
+    LIST_FOR_EACH(node, command_list) {
+      struct app_command* cmd = CONTAINER_OF(node, struct app_command, node);
+      assert(cmd->argc > 0);
+      if(is_arity_valid(cmd, argc)) {
+        ++nb_candidates;
+        if(!valid_cmd && arg_parse(argc, argv, cmd->arg_table) == 0)
+          valid_cmd = cmd;
       }
-      fprintf(app->cmd.stream, "\n%s", name);
-      arg_print_syntaxv(app->cmd.stream, cmd->arg_table, "\n");
-      arg_print_errors
-        (app->cmd.stream, (struct arg_end*)cmd->arg_table[cmd->argc - 1], name);
     }
-    if(nerror == 0) {
-      valid_cmd = cmd;
-      break;
+    if(valid_cmd && nb_candidates == 1) {
+      cache_entry->list = command_list;
+      cache_entry->cmd = valid_cmd;
+      cache_entry->argc = argc;
     }
   }
-
-  if(min_nerror != 0) {
-    long fpos = 0;
-    size_t size =0;
-    size_t nb = 0;
-
-    fpos = ftell(app->cmd.stream);
-    size = MIN((size_t)fpos, sizeof(app->cmd.scratch)/sizeof(char) - 1);
-    rewind(app->cmd.stream);
-    nb = fread(app->cmd.scratch, size, 1, app->cmd.stream);
-    assert(nb == 1);
-    app->cmd.scratch[size] = '\0';
-    APP_PRINT_ERR(app->logger, "%s", app->cmd.scratch);
-    app_err = APP_COMMAND_ERROR;
+  /* The syntax errors are printed only if the command line is invalid. */
+  if(!valid_cmd) {
+    app_err = print_syntax_errors(app, command_list, argc, argv);
     goto error;
   }
 
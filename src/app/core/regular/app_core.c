@@ -1,6 +1,11 @@
 #include "app/core/regular/app_core_c.h"
 #include "app/core/regular/app_command_c.h"
 #include "app/core/regular/app_error_c.h"
+#include "app/core/regular/app_model_instance_c.h"
+#include "app/core/regular/app_model_loader_c.h"
+#include "app/core/regular/app_model_watcher_c.h"
+#include "app/core/regular/app_scene_graph_c.h"
+#include "app/core/regular/app_stats_c.h"
 #include "app/core/regular/app_term.h"
 #include "app/core/regular/app_world_c.h"
 #include "app/core/app.h"
@@ -26,7 +31,10 @@
 #include "stdlib/sl_flat_set.h"
 #include "stdlib/sl_logger.h"
 #include "stdlib/sl_vector.h"
+#include "sys/clock_time.h"
+#include "sys/math.h"
 #include "sys/mem_allocator.h"
+#include "sys/profiler.h"
 #include "sys/sys.h"
 #include "window_manager/wm.h"
 #include "window_manager/wm_device.h"
@@ -34,8 +42,10 @@
 #include "window_manager/wm_window.h"
 #include <assert.h>
 #include <error.h>
+#include <limits.h>
 #include <stdarg.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -153,6 +163,55 @@ term_log_func(const char* msg, void* data)
     (term, RDR_TERM_STDOUT, buffer, RDR_TERM_COLOR_WHITE));
 }
 
+/* Rasterize the glyph of the terminal font on its first use. Note that the
+ * loader is invoked while the terminal is drawn and thus it must not print
+ * any message. */
+static bool
+load_term_glyph(wchar_t ch, struct rdr_glyph_desc* desc, void* data)
+{
+  struct rsrc_glyph_desc glyph_desc;
+  struct app* app = data;
+  struct rsrc_glyph* glyph = NULL;
+  size_t width = 0;
+  size_t height = 0;
+  size_t Bpp = 0;
+  size_t size = 0;
+  bool is_loaded = false;
+  assert(desc && app);
+
+  if(RSRC_NO_ERROR != rsrc_font_glyph(app->rsrc.font, ch, &glyph))
+    goto exit;
+
+  RSRC(glyph_desc(glyph, &glyph_desc));
+  RSRC(glyph_bitmap(glyph, true, &width, &height, &Bpp, NULL));
+  size = width * height * Bpp;
+  if(size > app->rdr.sizeof_glyph_bitmap) {
+    unsigned char* buffer = MEM_REALLOC
+      (&app->rdr.allocator, app->rdr.glyph_bitmap, size);
+    if(!buffer)
+      goto exit;
+    app->rdr.glyph_bitmap = buffer;
+    app->rdr.sizeof_glyph_bitmap = size;
+  }
+  if(size)
+    RSRC(glyph_bitmap(glyph, true, NULL, NULL, NULL, app->rdr.glyph_bitmap));
+
+  desc->character = ch;
+  desc->width = glyph_desc.width;
+  desc->bitmap_left = glyph_desc.bbox.x_min;
+  desc->bitmap_top = glyph_desc.bbox.y_min;
+  desc->bitmap.width = width;
+  desc->bitmap.height = height;
+  desc->bitmap.bytes_per_pixel = Bpp;
+  desc->bitmap.buffer = size ? app->rdr.glyph_bitmap : NULL;
+  is_loaded = true;
+
+exit:
+  if(glyph)
+    RSRC(glyph_ref_put(glyph));
+  return is_loaded;
+}
+
 static enum app_error
 manage_callback
   (struct app* app,
@@ -274,6 +333,11 @@ shutdown_renderer(struct app* app)
     CALL(rdr_font_ref_put(app->rdr.term_font));
     app->rdr.term_font = NULL;
   }
+  if(app->rdr.glyph_bitmap) {
+    MEM_FREE(&app->rdr.allocator, app->rdr.glyph_bitmap);
+    app->rdr.glyph_bitmap = NULL;
+    app->rdr.sizeof_glyph_bitmap = 0;
+  }
   if(app->rdr.frame) {
     CALL(rdr_frame_ref_put(app->rdr.frame));
     app->rdr.frame = NULL;
@@ -364,6 +428,14 @@ shutdown_common(struct app* app)
     APP(world_ref_put(app->world));
   if(app->view)
     APP(view_ref_put(app->view));
+  if(app->transform.dirty_list) {
+    SL(free_vector(app->transform.dirty_list));
+    app->transform.dirty_list = NULL;
+  }
+  if(app->transform.commit_list) {
+    SL(free_vector(app->transform.commit_list));
+    app->transform.commit_list = NULL;
+  }
   return app_err;
 }
 
@@ -396,8 +468,12 @@ shutdown(struct app* app)
 
   if(app) {
     #define CALL(func) if((app_err = func) != APP_NO_ERROR) goto error
+    CALL(app_shutdown_scene_graph(app));
+    CALL(app_shutdown_model_watcher(app));
+    CALL(app_shutdown_model_loader(app));
     CALL(app_shutdown_cvar_system(app));
     CALL(app_shutdown_command_system(app));
+    CALL(app_shutdown_stats(app));
     CALL(app_shutdown_term(app));
     CALL(app_shutdown_object_system(app));
     CALL(shutdown_common(app));
@@ -560,6 +636,17 @@ init_common(struct app* app)
       goto error;
     }
   }
+  for(i = 0; i < 2; ++i) {
+    sl_err = sl_create_vector
+      (sizeof(struct app_model_instance*),
+       ALIGNOF(struct app_model_instance*),
+       app->allocator,
+       i == 0 ? &app->transform.dirty_list : &app->transform.commit_list);
+    if(sl_err != SL_NO_ERROR) {
+      app_err = sl_to_app_error(sl_err);
+      goto error;
+    }
+  }
   CALL(app_create_world(app, &app->world));
   CALL(app_create_view(app, &app->view));
   CALL(app_look_at
@@ -644,6 +731,9 @@ init(struct app* app, const char* graphic_driver)
   CALL(app_init_term(app), "error initializing terminal\n");
   CALL(app_init_command_system(app), "error intializing command system\n");
   CALL(app_init_cvar_system(app), "error intializing cvar system\n");
+  CALL(app_init_model_loader(app), "error initializing model loader\n");
+  CALL(app_init_model_watcher(app), "error initializing model watcher\n");
+  CALL(app_init_scene_graph(app), "error initializing scene graph\n");
   #undef CALL
 
 exit:
@@ -759,16 +849,34 @@ enum app_error
 app_run(struct app* app, bool* keep_running)
 {
   enum app_error app_err = APP_NO_ERROR;
+  int64_t swap_begin = 0;
 
+  PROF_BEGIN("app_run");
   if(!app || !keep_running) {
     app_err = APP_INVALID_ARGUMENT;
     goto error;
   }
 
+  app_err = app_commit_model_watcher(app);
+  if(app_err != APP_NO_ERROR)
+    goto error;
+
+  app_err = app_commit_model_loads(app, false);
+  if(app_err != APP_NO_ERROR)
+    goto error;
+
+  app_err = app_commit_model_instance_transforms(app);
+  if(app_err != APP_NO_ERROR)
+    goto error;
+
   app_err = app_draw_world(app->world, app->view);
   if(app_err != APP_NO_ERROR)
     goto error;
 
+  app_err = app_draw_stats(app);
+  if(app_err != APP_NO_ERROR)
+    goto error;
+
   if(app->term.is_enabled) {
     const enum rdr_error rdr_err = rdr_frame_draw_term
       (app->rdr.frame, app->term.render_term);
@@ -779,11 +887,16 @@ app_run(struct app* app, bool* keep_running)
   }
 
   RDR(flush_frame(app->rdr.frame));
+  swap_begin = clock_ticks();
   WM(swap(app->wm.window));
+  app_err = app_record_frame_stats(app, swap_begin);
+  if(app_err != APP_NO_ERROR)
+    goto error;
   *keep_running = !app->post_exit;
   app->post_exit = false;
 
 exit:
+  PROF_END();
   return app_err;
 
 error:
@@ -859,17 +972,25 @@ error:
 enum app_error
 app_cleanup(struct app* app)
 {
+  enum app_error app_err = APP_NO_ERROR;
+
+  app_err = app_flush_model_loads(app);
+  if(app_err != APP_NO_ERROR)
+    return app_err;
   return app_clear_object_system(app);
 }
 
 enum app_error
 app_terminal_font(struct app* app, const char* path)
 {
-  struct rdr_glyph_desc* glyph_desc_list = NULL;
+  struct rdr_font_metrics metrics;
   enum app_error app_err = APP_NO_ERROR;
+  enum rdr_error rdr_err = RDR_NO_ERROR;
   enum rsrc_error rsrc_err = RSRC_NO_ERROR;
+  size_t Bpp = 0;
   size_t nb_chars = 0;
   size_t i = 0;
+  memset(&metrics, 0, sizeof(metrics));
 
   if(!app || !path) {
     app_err = APP_INVALID_ARGUMENT;
@@ -882,75 +1003,51 @@ app_terminal_font(struct app* app, const char* path)
     goto error;
   }
 
+  /* Compute the font metrics from the glyph outlines of the default charset.
+   * The glyph bitmaps are rasterized on their first use. */
+  metrics.min_glyph_width = SIZE_MAX;
+  metrics.min_glyph_pos_y = INT_MAX;
   nb_chars = wcslen(default_charset);
-  if(nb_chars) {
-    size_t line_space = 0;
-    enum rdr_error rdr_err = RDR_NO_ERROR;
-
-    glyph_desc_list = MEM_CALLOC
-      (&app->rdr.allocator, nb_chars, sizeof(struct rdr_glyph_desc));
-    for(i = 0; i < nb_chars; ++i) {
-      struct rsrc_glyph_desc glyph_desc;
-      struct rsrc_glyph* glyph = NULL;
-      size_t width = 0;
-      size_t height = 0;
-      size_t Bpp = 0;
-
-      rsrc_err = rsrc_font_glyph(app->rsrc.font, default_charset[i], &glyph);
-      if(RSRC_NO_ERROR != rsrc_err) {
-        APP_PRINT_WARN
-          (app->logger,
-           "Character `%c' not found in font `%s'.\n",
-           default_charset[i],
-           path);
-      } else {
-        size_t size = 0;
-        /* Get glyph desc. */
-        RSRC(glyph_desc(glyph, &glyph_desc));
-        glyph_desc_list[i].width = glyph_desc.width;
-        glyph_desc_list[i].character = glyph_desc.character;
-        glyph_desc_list[i].bitmap_left = glyph_desc.bbox.x_min;
-        glyph_desc_list[i].bitmap_top = glyph_desc.bbox.y_min;
-        /* Get glyph bitmap. */
-        RSRC(glyph_bitmap(glyph, true, &width, &height, &Bpp, NULL));
-        glyph_desc_list[i].bitmap.width = width;
-        glyph_desc_list[i].bitmap.height = height;
-        glyph_desc_list[i].bitmap.bytes_per_pixel = Bpp;
-        glyph_desc_list[i].bitmap.buffer = NULL;
-        size = width * height * Bpp;
-        if(size) {
-          unsigned char* buffer = MEM_CALLOC(&app->rdr.allocator, 1, size);
-          if(!buffer) {
-            app_err = APP_MEMORY_ERROR;
-            goto error;
-          }
-          RSRC(glyph_bitmap(glyph, true, NULL, NULL, NULL, buffer));
-          glyph_desc_list[i].bitmap.buffer = buffer;
-        }
-        RSRC(glyph_ref_put(glyph));
-      }
-    }
-    RSRC(font_line_space(app->rsrc.font, &line_space));
-
-    rdr_err = rdr_font_data
-      (app->rdr.term_font, line_space, nb_chars, glyph_desc_list);
+  for(i = 0; i < nb_chars; ++i) {
+    struct rsrc_glyph_desc glyph_desc;
+    struct rsrc_glyph* glyph = NULL;
 
-    if(RDR_NO_ERROR != rdr_err) {
-      APP_PRINT_ERR
+    rsrc_err = rsrc_font_glyph(app->rsrc.font, default_charset[i], &glyph);
+    if(RSRC_NO_ERROR != rsrc_err) {
+      APP_PRINT_WARN
         (app->logger,
-         "Error setting-up render data of the font `%s'.\n",
+         "Character `%c' not found in font `%s'.\n",
+         default_charset[i],
          path);
-      app_err = rdr_to_app_error(rdr_err);
-      goto error;
+    } else {
+      RSRC(glyph_desc(glyph, &glyph_desc));
+      metrics.min_glyph_width =
+        MIN(metrics.min_glyph_width, glyph_desc.width);
+      metrics.min_glyph_pos_y =
+        MIN(metrics.min_glyph_pos_y, glyph_desc.bbox.y_min);
+      if(!Bpp)
+        RSRC(glyph_bitmap(glyph, true, NULL, NULL, &Bpp, NULL));
+      RSRC(glyph_ref_put(glyph));
     }
   }
-exit:
-  if(glyph_desc_list) {
-    nb_chars =  wcslen(default_charset);
-    for(i = 0; i < nb_chars; ++i)
-      MEM_FREE(&app->rdr.allocator, glyph_desc_list[i].bitmap.buffer);
-    MEM_FREE(&app->rdr.allocator, glyph_desc_list);
+  if(!Bpp) {
+    APP_PRINT_ERR(app->logger, "No glyph found in font `%s'.\n", path);
+    app_err = APP_INVALID_ARGUMENT;
+    goto error;
+  }
+  RSRC(font_line_space(app->rsrc.font, &metrics.line_space));
+
+  rdr_err = rdr_font_glyph_loader
+    (app->rdr.term_font, &metrics, Bpp, load_term_glyph, app);
+  if(RDR_NO_ERROR != rdr_err) {
+    APP_PRINT_ERR
+      (app->logger,
+       "Error setting-up render data of the font `%s'.\n",
+       path);
+    app_err = rdr_to_app_error(rdr_err);
+    goto error;
   }
+exit:
   return app_err;
 error:
   goto exit;
@@ -1176,6 +1273,7 @@ app_invoke_callbacks(struct app* app, enum app_signal signal, ...)
 {
   va_list arg_list;
   void* arg = NULL;
+  size_t nb_args = 0;
   struct callback* callback_list = NULL;
   size_t len = 0;
   size_t i = 0;
@@ -1188,6 +1286,8 @@ app_invoke_callbacks(struct app* app, enum app_signal signal, ...)
 
   va_start(arg_list, signal);
   arg = va_arg(arg_list, void*);
+  if(signal == APP_SIGNAL_TRANSFORM_MODEL_INSTANCES)
+    nb_args = va_arg(arg_list, size_t);
 
   SL(flat_set_buffer
     (app->callback_list[signal], &len, NULL, NULL, (void**)&callback_list));
@@ -1205,6 +1305,10 @@ app_invoke_callbacks(struct app* app, enum app_signal signal, ...)
       case APP_SIGNAL_DESTROY_MODEL_INSTANCE:
         ((void (*)(struct app_model_instance*, void*))func)(arg, data);
         break;
+      case APP_SIGNAL_TRANSFORM_MODEL_INSTANCES:
+        ((void (*)(struct app_model_instance**, size_t, void*))func)
+          (arg, nb_args, data);
+        break;
       default:
         assert(false);
         break;
@@ -1259,6 +1363,12 @@ rsrc_to_rdr_type(enum rsrc_type type)
     case RSRC_FLOAT4:
       rdr_type = RDR_FLOAT4;
       break;
+    case RSRC_HALF2:
+      rdr_type = RDR_HALF2;
+      break;
+    case RSRC_SNORM16x2:
+      rdr_type = RDR_SNORM16x2;
+      break;
     default:
       rdr_type = RDR_UNKNOWN_TYPE;
       break;
@@ -1266,3 +1376,32 @@ rsrc_to_rdr_type(enum rsrc_type type)
   return rdr_type;
 }
 
+size_t
+sizeof_rsrc_type(enum rsrc_type type)
+{
+  size_t size = 0;
+  switch(type) {
+    case RSRC_FLOAT:
+      size = sizeof(float);
+      break;
+    case RSRC_FLOAT2:
+      size = sizeof(float[2]);
+      break;
+    case RSRC_FLOAT3:
+      size = sizeof(float[3]);
+      break;
+    case RSRC_FLOAT4:
+      size = sizeof(float[4]);
+      break;
+    case RSRC_HALF2:
+      size = sizeof(uint16_t[2]);
+      break;
+    case RSRC_SNORM16x2:
+      size = sizeof(int16_t[2]);
+      break;
+    default:
+      size = 0;
+      break;
+  }
+  return size;
+}
@@ -13,6 +13,7 @@
 #include "sys/ref_count.h"
 #include "sys/sys.h"
 #include <stdbool.h>
+#include <stddef.h>
 
 #define APP_PRINT_MSG(logger, ...) \
   SL(logger_print((logger), __VA_ARGS__))
@@ -25,10 +26,21 @@
 #define APP_PRINT_WARN(logger, ...) \
   SL(logger_print((logger), APP_WARN_PREFIX __VA_ARGS__))
 
+/* Number of frames over which the time statistics are computed. */
+#define APP_STATS_NB_FRAMES 128
+
+/* Number of entries of the command dispatch cache. Must be a power of 2. */
+#define APP_CMD_CACHE_SIZE 64
+
+struct app_command;
 struct app_model;
 struct app_model_instance;
+struct app_model_loader;
+struct app_model_watcher;
+struct app_scene_graph;
 struct app_view;
 struct app_world;
+struct list_node;
 struct rdr_frame;
 struct rdr_material;
 struct rdr_system;
@@ -58,9 +70,29 @@ struct app {
     struct sl_hash_table* htbl; /* htbl of commands. */
     /* set of const char*. Used by completion and ls.*/
     struct sl_flat_set* name_set;
+    /* Syntax that accepted the last command line of a given arity when no
+     * other syntax of the command has this arity. Indexed by the command list
+     * and the arity; cleared when a command is added or deleted. */
+    struct command_cache_entry {
+      struct list_node* list;
+      struct app_command* cmd;
+      size_t argc;
+    } cache[APP_CMD_CACHE_SIZE];
   } cmd;
 
+  /* Model instances whose transform changed since the last commit. The commit
+   * swaps the lists in order to let its callbacks transform instances. Both
+   * lists are reserved to the number of instances. */
+  struct transform {
+    struct sl_vector* dirty_list; /* List of app_model_instance*. */
+    struct sl_vector* commit_list;
+    size_t nb_instances; /* Number of allocated instances. */
+  } transform;
+
   struct app_cvar_system cvar_system;
+  struct app_model_loader* model_loader;
+  struct app_model_watcher* model_watcher;
+  struct app_scene_graph* scene_graph;
 
   struct term {
     struct rdr_term* render_term;
@@ -68,12 +100,24 @@ struct app {
     bool is_enabled;
   } term;
 
+  struct stats {
+    struct rdr_term* overlay; /* Created on its first display. */
+    size_t overlay_height; /* In pixels. */
+    int64_t frame_time[APP_STATS_NB_FRAMES]; /* Ring of times in ticks. */
+    int64_t cpu_time[APP_STATS_NB_FRAMES];
+    size_t nb_frames; /* Total number of recorded frames. */
+    int64_t last_frame_end; /* In ticks. 0 <=> no frame was recorded. */
+    struct app_frame_stats counters; /* The time statistics are not set. */
+  } stats;
+
   struct renderer {
     struct rdr_font* term_font;
     struct rdr_frame* frame;
     struct rdr_material* default_material;
     struct rdr_system* system;
     struct mem_allocator allocator;
+    unsigned char* glyph_bitmap; /* Scratch of the terminal glyph loader. */
+    size_t sizeof_glyph_bitmap;
   } rdr;
 
   struct window_manager {
@@ -116,5 +160,9 @@ LOCAL_SYM enum rdr_type
 rsrc_to_rdr_type
   (enum rsrc_type type);
 
+LOCAL_SYM size_t
+sizeof_rsrc_type
+  (enum rsrc_type type);
+
 #endif /* APP_C_H */
 
@@ -1,3 +1,48 @@
+/* Draw the frame statistics overlay. */
+APP_CVAR
+  (app_show_stats,
+   APP_CVAR_BOOL_DESC(false))
+
+/* Reload the models whose resource file is modified. */
+APP_CVAR
+  (app_hot_reload,
+   APP_CVAR_BOOL_DESC(true))
+
+/* Screen space error, in pixels, of the model levels of detail. Always draw
+ * the finest level if null. */
+APP_CVAR
+  (rdr_lod_threshold,
+   APP_CVAR_FLOAT_DESC(1.f, 0.f, 64.f))
+
+/* Cull the model instances lying outside of the view frustum or behind the
+ * model occluders. */
+APP_CVAR
+  (rdr_occlusion_culling,
+   APP_CVAR_BOOL_DESC(true))
+
+/* Compute the lines of the im grids on the GPU rather than building them on
+ * the CPU. */
+APP_CVAR
+  (rdr_procedural_grid,
+   APP_CVAR_BOOL_DESC(true))
+
 APP_CVAR
   (rdr_show_picking,
    APP_CVAR_BOOL_DESC(false))
+
+/* Directory of the binary geometry cache. It should only be writable by the
+ * user. Disable the cache if empty. */
+APP_CVAR
+  (rsrc_cache_path,
+   APP_CVAR_STRING_DESC("", NULL))
+
+/* Number of levels of detail built by simplifying the loaded geometries, at
+ * most 7. Each level halves the triangles of the previous one. */
+APP_CVAR
+  (rsrc_model_lods,
+   APP_CVAR_INT_DESC(3, 0, 7))
+
+/* Reorder the loaded geometries for the vertex cache and the vertex fetch. */
+APP_CVAR
+  (rsrc_optimize_geometry,
+   APP_CVAR_BOOL_DESC(true))
@@ -2,9 +2,14 @@
 #include "app/core/regular/app_error_c.h"
 #include "app/core/regular/app_model_c.h"
 #include "app/core/regular/app_model_instance_c.h"
+#include "app/core/regular/app_model_loader_c.h"
+#include "app/core/regular/app_model_watcher_c.h"
 #include "app/core/regular/app_object.h"
+#include "app/core/app_cvar.h"
 #include "app/core/app_model.h"
 #include "app/core/app_model_instance.h"
+#include "app/core/app_world.h"
+#include "maths/simd/aosf44.h"
 #include "renderer/rdr.h"
 #include "renderer/rdr_material.h"
 #include "renderer/rdr_mesh.h"
@@ -15,15 +20,19 @@
 #include "resources/rsrc_wavefront_obj.h"
 #include "stdlib/sl.h"
 #include "stdlib/sl_flat_map.h"
+#include "stdlib/sl_hash_table.h"
 #include "stdlib/sl_string.h"
 #include "stdlib/sl_vector.h"
 #include "sys/math.h"
 #include "sys/mem_allocator.h"
+#include "sys/profiler.h"
 #include "sys/ref_count.h"
 #include "sys/sys.h"
 #include <assert.h>
 #include <float.h>
+#include <limits.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -41,6 +50,7 @@ struct app_model {
   struct sl_vector* material_list; /* list of rdr_material*. */
   struct sl_vector* model_list; /* list of rdr_model*. */
   bool invoke_clbk;
+  bool is_occluder;
 };
 
 /*******************************************************************************
@@ -92,11 +102,133 @@ set_default_model_bounds(struct app_model* mdl)
   mdl->max_bound[0] = mdl->max_bound[1] = mdl->max_bound[2] = -FLT_MAX;
 }
 
+/* Set the indices and the vertex data of the prim_set to mesh. */
 static enum app_error
-setup_model(struct app_model* model)
+setup_mesh(struct rdr_mesh* mesh, const struct rsrc_primitive_set* prim_set)
+{
+  enum rdr_error rdr_err = RDR_NO_ERROR;
+  size_t i = 0;
+  assert(mesh && prim_set && prim_set->nb_attribs > 0);
+
+  rdr_err = rdr_mesh_indices(mesh, prim_set->nb_indices, prim_set->index_list);
+  if(rdr_err != RDR_NO_ERROR)
+    return rdr_to_app_error(rdr_err);
+
+  struct rdr_mesh_attrib mesh_attribs[prim_set->nb_attribs];
+  for(i = 0; i < prim_set->nb_attribs; ++i) {
+    mesh_attribs[i].type = rsrc_to_rdr_type(prim_set->attrib_list[i].type);
+    mesh_attribs[i].usage =
+      rsrc_to_rdr_attrib_usage(prim_set->attrib_list[i].usage);
+  }
+  rdr_err = rdr_mesh_data
+    (mesh,
+     prim_set->nb_attribs,
+     mesh_attribs,
+     prim_set->sizeof_data,
+     prim_set->data);
+  return rdr_to_app_error(rdr_err);
+}
+
+/* Update the model AABB with the one of the mesh. */
+static void
+merge_mesh_bounds(struct app_model* model, struct rdr_mesh* mesh)
 {
   float min_bound[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
   float max_bound[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+  assert(model && mesh);
+
+  RDR(get_mesh_aabb(mesh, min_bound, max_bound));
+  model->min_bound[0] = MIN(model->min_bound[0], min_bound[0]);
+  model->min_bound[1] = MIN(model->min_bound[1], min_bound[1]);
+  model->min_bound[2] = MIN(model->min_bound[2], min_bound[2]);
+  model->max_bound[0] = MAX(model->max_bound[0], max_bound[0]);
+  model->max_bound[1] = MAX(model->max_bound[1], max_bound[1]);
+  model->max_bound[2] = MAX(model->max_bound[2], max_bound[2]);
+}
+
+/* Define the occluders of the render models from the positions of the model
+ * geometry if the model is an occluder, or remove them otherwise. */
+static enum app_error
+setup_model_occluders(struct app_model* model)
+{
+  struct rdr_model** mdl_lstbuf = NULL;
+  float* pos_list = NULL;
+  size_t nb_models = 0;
+  size_t nb_prim_set = 0;
+  size_t i = 0;
+  size_t j = 0;
+  size_t k = 0;
+  enum rdr_error rdr_err = RDR_NO_ERROR;
+  enum app_error app_err = APP_NO_ERROR;
+  assert(model && model->geometry);
+
+  SL(vector_buffer
+    (model->model_list, &nb_models, NULL, NULL, (void**)&mdl_lstbuf));
+  RSRC(get_primitive_set_count(model->geometry, &nb_prim_set));
+  for(i = 0, j = 0; i < nb_prim_set; ++i) {
+    struct rsrc_primitive_set prim_set;
+    const char* data = NULL;
+    size_t pos_offset = SIZE_MAX;
+    size_t stride = 0;
+    size_t nb_vertices = 0;
+
+    RSRC(get_primitive_set(model->geometry, i, &prim_set));
+    if(prim_set.primitive_type != RSRC_TRIANGLE)
+      continue;
+    assert(j < nb_models);
+
+    for(k = 0; k < prim_set.nb_attribs; ++k) {
+      if(prim_set.attrib_list[k].usage == RSRC_ATTRIB_POSITION
+      && prim_set.attrib_list[k].type == RSRC_FLOAT3)
+        pos_offset = stride;
+      stride += sizeof_rsrc_type(prim_set.attrib_list[k].type);
+    }
+    if(!model->is_occluder || pos_offset == SIZE_MAX || !stride) {
+      RDR(model_occluder(mdl_lstbuf[j], 0, NULL, 0, NULL));
+      ++j;
+      continue;
+    }
+    /* The occluder vertices are the positions of the interleaved vertices. */
+    nb_vertices = prim_set.sizeof_data / stride;
+    pos_list = MEM_ALLOC
+      (model->app->allocator, MAX(nb_vertices, 1) * sizeof(float[3]));
+    if(!pos_list) {
+      app_err = APP_MEMORY_ERROR;
+      goto error;
+    }
+    data = prim_set.data;
+    for(k = 0; k < nb_vertices; ++k) {
+      memcpy
+        (pos_list + k * 3, data + k * stride + pos_offset, sizeof(float[3]));
+    }
+    rdr_err = rdr_model_occluder
+      (mdl_lstbuf[j],
+       nb_vertices,
+       pos_list,
+       prim_set.nb_indices,
+       prim_set.index_list);
+    if(rdr_err != RDR_NO_ERROR) {
+      app_err = rdr_to_app_error(rdr_err);
+      goto error;
+    }
+    MEM_FREE(model->app->allocator, pos_list);
+    pos_list = NULL;
+    ++j;
+  }
+
+exit:
+  if(pos_list)
+    MEM_FREE(model->app->allocator, pos_list);
+  return app_err;
+error:
+  for(j = 0; j < nb_models; ++j)
+    RDR(model_occluder(mdl_lstbuf[j], 0, NULL, 0, NULL));
+  goto exit;
+}
+
+static enum app_error
+setup_model(struct app_model* model)
+{
   struct rdr_mesh* mesh = NULL;
   struct rdr_model* rmodel = NULL;
   size_t nb_prim_set = 0;
@@ -115,7 +247,6 @@ setup_model(struct app_model* model)
   RSRC(get_primitive_set_count(model->geometry, &nb_prim_set));
   for(i = 0; i < nb_prim_set; ++i) {
     struct rsrc_primitive_set prim_set;
-    size_t j = 0;
     RSRC(get_primitive_set(model->geometry, i, &prim_set));
 
     /* Only triangular geometry are handled. */
@@ -128,36 +259,10 @@ setup_model(struct app_model* model)
       app_err = rdr_to_app_error(rdr_err);
       goto error;
     }
-    rdr_err = rdr_mesh_indices(mesh, prim_set.nb_indices, prim_set.index_list);
-    if(rdr_err != RDR_NO_ERROR) {
-      app_err = rdr_to_app_error(rdr_err);
-      goto error;
-    }
-    assert(prim_set.nb_attribs > 0);
-    struct rdr_mesh_attrib mesh_attribs[prim_set.nb_attribs];
-    for(j = 0; j < prim_set.nb_attribs; ++j) {
-      mesh_attribs[j].type = rsrc_to_rdr_type(prim_set.attrib_list[j].type);
-      mesh_attribs[j].usage=
-        rsrc_to_rdr_attrib_usage(prim_set.attrib_list[j].usage);
-    }
-    rdr_err = rdr_mesh_data
-      (mesh,
-       prim_set.nb_attribs,
-       mesh_attribs,
-       prim_set.sizeof_data,
-       prim_set.data);
-    if(rdr_err != RDR_NO_ERROR) {
-      app_err = rdr_to_app_error(rdr_err);
+    app_err = setup_mesh(mesh, &prim_set);
+    if(app_err != APP_NO_ERROR)
       goto error;
-    }
-    /* Update the model AABB. */
-    RDR(get_mesh_aabb(mesh, min_bound, max_bound));
-    model->min_bound[0] = MIN(model->min_bound[0], min_bound[0]);
-    model->min_bound[1] = MIN(model->min_bound[1], min_bound[1]);
-    model->min_bound[2] = MIN(model->min_bound[2], min_bound[2]);
-    model->max_bound[0] = MAX(model->max_bound[0], max_bound[0]);
-    model->max_bound[1] = MAX(model->max_bound[1], max_bound[1]);
-    model->max_bound[2] = MAX(model->max_bound[2], max_bound[2]);
+    merge_mesh_bounds(model, mesh);
     /* Render model setup. */
     rdr_err = rdr_create_model
       (model->app->rdr.system,
@@ -182,6 +287,9 @@ setup_model(struct app_model* model)
     }
     rmodel = NULL;
   }
+  app_err = setup_model_occluders(model);
+  if(app_err != APP_NO_ERROR)
+    goto error;
 
 exit:
   return app_err;
@@ -194,6 +302,126 @@ error:
   goto exit;
 }
 
+/* Build the levels of detail of the model from its geometry. */
+static enum app_error
+load_model_lods(struct app_model* model)
+{
+  struct rsrc_geometry* lod_list[RDR_MAX_MODEL_LODS - 1];
+  float error_list[RDR_MAX_MODEL_LODS - 1];
+  size_t nb_lods = 0;
+  size_t i = 0;
+  enum rsrc_error rsrc_err = RSRC_NO_ERROR;
+  enum app_error app_err = APP_NO_ERROR;
+  assert(model && model->geometry);
+
+  memset(lod_list, 0, sizeof(lod_list));
+  nb_lods = (size_t)model->app->cvar_system.rsrc_model_lods->value.integer;
+  nb_lods = MIN(nb_lods, RDR_MAX_MODEL_LODS - 1);
+  for(i = 0; i < nb_lods; ++i) {
+    rsrc_err = rsrc_create_geometry(model->app->rsrc.context, lod_list + i);
+    if(rsrc_err != RSRC_NO_ERROR) {
+      app_err = rsrc_to_app_error(rsrc_err);
+      goto error;
+    }
+  }
+  rsrc_err = app_build_model_lods
+    (model->geometry, nb_lods, lod_list, error_list);
+  if(rsrc_err != RSRC_NO_ERROR) {
+    app_err = rsrc_to_app_error(rsrc_err);
+    goto error;
+  }
+  app_err = app_setup_model_lods(model, nb_lods, lod_list, error_list);
+  if(app_err != APP_NO_ERROR)
+    goto error;
+
+exit:
+  for(i = 0; i < nb_lods; ++i) {
+    if(lod_list[i])
+      RSRC(geometry_ref_put(lod_list[i]));
+  }
+  return app_err;
+error:
+  goto exit;
+}
+
+/* Create the render instances of the model instances spawned while the model
+ * had no render model, e.g. before the commit of its asynchronous load. */
+static enum app_error
+setup_model_instances(struct app_model* model)
+{
+  ALIGN(16) float transform[16];
+  struct list_node* node = NULL;
+  struct rdr_model** mdl_lstbuf = NULL;
+  struct rdr_model_instance* render_instance = NULL;
+  size_t nb_models = 0;
+  size_t len = 0;
+  size_t i = 0;
+  enum app_error app_err = APP_NO_ERROR;
+  enum rdr_error rdr_err = RDR_NO_ERROR;
+  enum sl_error sl_err = SL_NO_ERROR;
+  assert(model);
+
+  SL(vector_buffer
+     (model->model_list, &nb_models, NULL, NULL, (void**)&mdl_lstbuf));
+  if(!nb_models)
+    return APP_NO_ERROR;
+
+  LIST_FOR_EACH(node, &model->instance_list) {
+    struct app_model_instance* instance = CONTAINER_OF
+      (node, struct app_model_instance, model_node);
+    struct app_world* world = instance->world;
+
+    SL(vector_length(instance->model_instance_list, &len));
+    if(len)
+      continue;
+    /* The instance is removed from its world and added back in order to
+     * register its render instances and their pick id. */
+    if(world) {
+      app_err = app_world_remove_model_instances(world, 1, &instance);
+      if(app_err != APP_NO_ERROR)
+        goto error;
+    }
+    aosf44_store(transform, &instance->world_transform);
+    for(i = 0; i < nb_models; ++i) {
+      rdr_err = rdr_create_model_instances
+        (model->app->rdr.system, mdl_lstbuf[i], 1, transform,
+         &render_instance);
+      if(rdr_err != RDR_NO_ERROR) {
+        app_err = rdr_to_app_error(rdr_err);
+        break;
+      }
+      sl_err = sl_vector_push_back
+        (instance->model_instance_list, &render_instance);
+      if(sl_err != SL_NO_ERROR) {
+        RDR(model_instance_ref_put(render_instance));
+        app_err = sl_to_app_error(sl_err);
+        break;
+      }
+    }
+    if(app_err != APP_NO_ERROR) {
+      struct rdr_model_instance** buffer = NULL;
+      SL(vector_buffer
+         (instance->model_instance_list, &len, NULL, NULL, (void**)&buffer));
+      for(i = 0; i < len; ++i)
+        RDR(model_instance_ref_put(buffer[i]));
+      SL(clear_vector(instance->model_instance_list));
+    }
+    if(world) {
+      const enum app_error err =
+        app_world_add_model_instances(world, 1, &instance);
+      if(app_err == APP_NO_ERROR)
+        app_err = err;
+    }
+    if(app_err != APP_NO_ERROR)
+      goto error;
+  }
+
+exit:
+  return app_err;
+error:
+  goto exit;
+}
+
 static void
 release_model(struct ref* ref)
 {
@@ -400,12 +628,15 @@ app_model_ref_put(struct app_model* model)
 enum app_error
 app_load_model(const char* path, struct app_model* model)
 {
+  char cache_path[PATH_MAX];
   const char* str_err = NULL;
   enum rsrc_error rsrc_err = RSRC_NO_ERROR;
   enum app_error app_err = APP_NO_ERROR;
-  enum sl_error sl_err = SL_NO_ERROR;
   bool may_have_errors = false;
+  bool is_cached = false;
+  bool is_cache_written = false;
 
+  PROF_BEGIN("app_load_model");
   if(!path || !model) {
     app_err = APP_INVALID_ARGUMENT;
     goto error;
@@ -415,31 +646,39 @@ app_load_model(const char* path, struct app_model* model)
   RSRC(flush_error(model->app->rsrc.context));
   may_have_errors = true;
 
-  rsrc_err = rsrc_load_wavefront_obj
-    (model->app->rsrc.wavefront_obj, path);
+  is_cached = app_model_cache_path
+    (model->app, path,
+     model->app->cvar_system.rsrc_optimize_geometry->value.boolean,
+     cache_path);
+  rsrc_err = app_build_model_geometry
+    (model->app->rsrc.context,
+     model->app->rsrc.wavefront_obj,
+     model->geometry,
+     path,
+     is_cached ? cache_path : NULL,
+     model->app->cvar_system.rsrc_optimize_geometry->value.boolean,
+     &is_cache_written);
   if(rsrc_err != RSRC_NO_ERROR) {
     APP_PRINT_ERR
       (model->app->logger, "error loading geometry resource `%s'\n", path);
     app_err = rsrc_to_app_error(rsrc_err);
     goto error;
   }
-  rsrc_err = rsrc_geometry_from_wavefront_obj
-    (model->geometry, model->app->rsrc.wavefront_obj);
-  if(rsrc_err != RSRC_NO_ERROR) {
-    app_err = rsrc_to_app_error(rsrc_err);
-    goto error;
-  }
-  app_err = setup_model(model);
-  if(app_err != APP_NO_ERROR) {
-    goto error;
+  if(is_cached && !is_cache_written) {
+    APP_PRINT_WARN
+      (model->app->logger, "cannot cache the geometry `%s'\n", path);
   }
-  sl_err = sl_string_set(model->resource_path, path);
-  if(sl_err != SL_NO_ERROR) {
-    app_err = sl_to_app_error(sl_err);
+  app_err = app_setup_model_geometry(model, path, NULL);
+  if(app_err != APP_NO_ERROR)
     goto error;
+  if(load_model_lods(model) != APP_NO_ERROR) {
+    APP_PRINT_WARN
+      (model->app->logger, "cannot build the levels of detail of `%s'\n",
+       path);
   }
 
 exit:
+  PROF_END();
   return app_err;
 error:
   if(model)
@@ -453,6 +692,24 @@ error:
   goto exit;
 }
 
+enum app_error
+app_load_model_async
+  (const char* path,
+   struct app_model* model,
+   app_model_load_callback_t func,
+   void* data)
+{
+  if(!path || !model)
+    return APP_INVALID_ARGUMENT;
+  return app_submit_model_load(model->app, path, model, func, data);
+}
+
+enum app_error
+app_flush_model_loads(struct app* app)
+{
+  return app_commit_model_loads(app, true);
+}
+
 enum app_error
 app_model_path
   (const struct app_model* model,
@@ -502,6 +759,31 @@ app_is_model_instantiated(const struct app_model* model, bool* b)
   return APP_NO_ERROR;
 }
 
+enum app_error
+app_set_model_occluder(struct app_model* model, bool is_occluder)
+{
+  enum app_error app_err = APP_NO_ERROR;
+
+  if(!model)
+    return APP_INVALID_ARGUMENT;
+  if(model->is_occluder == is_occluder)
+    return APP_NO_ERROR;
+  model->is_occluder = is_occluder;
+  app_err = setup_model_occluders(model);
+  if(app_err != APP_NO_ERROR)
+    model->is_occluder = false;
+  return app_err;
+}
+
+enum app_error
+app_is_model_occluder(const struct app_model* model, bool* is_occluder)
+{
+  if(!model || !is_occluder)
+    return APP_INVALID_ARGUMENT;
+  *is_occluder = model->is_occluder;
+  return APP_NO_ERROR;
+}
+
 enum app_error
 app_get_model_aabb
   (const struct app_model* mdl,
@@ -655,6 +937,334 @@ app_object_to_model(struct app_object* obj)
   return CONTAINER_OF(obj, struct app_model, obj);
 }
 
+enum app_error
+app_is_model_registered(struct app_model* model, bool* is_registered)
+{
+  assert(model && is_registered);
+  return app_is_object_registered(model->app, &model->obj, is_registered);
+}
+
+bool
+app_model_cache_path
+  (struct app* app,
+   const char* path,
+   bool optimize,
+   char cache_path[PATH_MAX])
+{
+  const char* cache_dir = NULL;
+  int len = 0;
+  assert(app && path && cache_path);
+
+  cache_dir = app->cvar_system.rsrc_cache_path->value.string;
+  if(!cache_dir || cache_dir[0] == '\0')
+    return false;
+  len = snprintf
+    (cache_path, PATH_MAX, "%s/%016zx%s.geom",
+     cache_dir, sl_hash(path, strlen(path)), optimize ? "-opt" : "");
+  return len > 0 && len < PATH_MAX;
+}
+
+enum rsrc_error
+app_build_model_geometry
+  (struct rsrc_context* ctxt,
+   struct rsrc_wavefront_obj* wobj,
+   struct rsrc_geometry* geom,
+   const char* path,
+   const char* cache_path,
+   bool optimize,
+   bool* is_cache_written)
+{
+  enum rsrc_error rsrc_err = RSRC_NO_ERROR;
+  assert(ctxt && wobj && geom && path && is_cache_written);
+
+  *is_cache_written = false;
+  if(cache_path) {
+    rsrc_err = rsrc_load_geometry(geom, path, cache_path);
+    if(rsrc_err == RSRC_NO_ERROR) {
+      *is_cache_written = true;
+      goto exit;
+    }
+    /* A missing or out of date cache file is not an error. */
+    RSRC(flush_error(ctxt));
+  }
+
+  rsrc_err = rsrc_load_wavefront_obj(wobj, path);
+  if(rsrc_err != RSRC_NO_ERROR)
+    goto error;
+  rsrc_err = rsrc_geometry_from_wavefront_obj(geom, wobj);
+  if(rsrc_err != RSRC_NO_ERROR)
+    goto error;
+  /* The default shaders expect float normals and texcoords. The geometry is
+   * thus not quantized. */
+  if(optimize) {
+    rsrc_err = rsrc_optimize_geometry
+      (geom, RSRC_OPTIMIZE_VERTEX_CACHE|RSRC_OPTIMIZE_VERTEX_FETCH);
+    if(rsrc_err != RSRC_NO_ERROR)
+      goto error;
+  }
+  if(cache_path) {
+    if(rsrc_write_geometry(geom, path, cache_path) == RSRC_NO_ERROR)
+      *is_cache_written = true;
+    else
+      RSRC(flush_error(ctxt));
+  }
+
+exit:
+  return rsrc_err;
+error:
+  goto exit;
+}
+
+enum rsrc_error
+app_build_model_lods
+  (const struct rsrc_geometry* geom,
+   size_t nb_lods,
+   struct rsrc_geometry* const lod_list[],
+   float error_list[])
+{
+  float error = 0.f;
+  size_t i = 0;
+  enum rsrc_error rsrc_err = RSRC_NO_ERROR;
+  assert(geom && (!nb_lods || (lod_list && error_list)));
+
+  for(i = 0; i < nb_lods; ++i) {
+    rsrc_err = rsrc_copy_geometry(lod_list[i], i ? lod_list[i - 1] : geom);
+    if(rsrc_err != RSRC_NO_ERROR)
+      goto error;
+    rsrc_err = rsrc_simplify_geometry(lod_list[i], 0.5f, &error);
+    if(rsrc_err != RSRC_NO_ERROR)
+      goto error;
+    /* The error of a level is measured from the previous one. */
+    error_list[i] = (i ? error_list[i - 1] : 0.f) + error;
+  }
+
+exit:
+  return rsrc_err;
+error:
+  goto exit;
+}
+
+enum app_error
+app_setup_model_geometry
+  (struct app_model* model,
+   const char* path,
+   const struct rsrc_geometry* geom)
+{
+  enum rsrc_error rsrc_err = RSRC_NO_ERROR;
+  enum sl_error sl_err = SL_NO_ERROR;
+  enum app_error app_err = APP_NO_ERROR;
+  assert(model && path);
+
+  if(geom) {
+    rsrc_err = rsrc_copy_geometry(model->geometry, geom);
+    if(rsrc_err != RSRC_NO_ERROR) {
+      app_err = rsrc_to_app_error(rsrc_err);
+      goto error;
+    }
+  }
+  app_err = setup_model(model);
+  if(app_err != APP_NO_ERROR)
+    goto error;
+  app_err = setup_model_instances(model);
+  if(app_err != APP_NO_ERROR)
+    goto error;
+  sl_err = sl_string_set(model->resource_path, path);
+  if(sl_err != SL_NO_ERROR) {
+    app_err = sl_to_app_error(sl_err);
+    goto error;
+  }
+  if(app_watch_model_path(model->app, path) != APP_NO_ERROR) {
+    APP_PRINT_WARN
+      (model->app->logger, "cannot watch the model resource `%s'\n", path);
+  }
+
+exit:
+  return app_err;
+error:
+  APP(clear_model(model));
+  goto exit;
+}
+
+enum app_error
+app_reload_model_geometry
+  (struct app_model* model,
+   const char* path,
+   const struct rsrc_geometry* geom)
+{
+  struct rdr_mesh** mesh_lstbuf = NULL;
+  struct rsrc_geometry* geometry = NULL;
+  size_t nb_meshes = 0;
+  size_t nb_prim_set = 0;
+  size_t nb_triangle_sets = 0;
+  size_t nb_updated_meshes = 0;
+  size_t i = 0;
+  size_t j = 0;
+  enum rsrc_error rsrc_err = RSRC_NO_ERROR;
+  enum app_error app_err = APP_NO_ERROR;
+  bool is_instantiated = false;
+  assert(model && path && geom);
+
+  SL(vector_buffer
+    (model->mesh_list, &nb_meshes, NULL, NULL, (void**)&mesh_lstbuf));
+  RSRC(get_primitive_set_count(geom, &nb_prim_set));
+  for(i = 0; i < nb_prim_set; ++i) {
+    struct rsrc_primitive_set prim_set;
+    RSRC(get_primitive_set(geom, i, &prim_set));
+    nb_triangle_sets += prim_set.primitive_type == RSRC_TRIANGLE;
+  }
+  /* The render models, and thus the instances, are kept only if the meshes
+   * can be updated in place. */
+  if(nb_triangle_sets != nb_meshes) {
+    APP(is_model_instantiated(model, &is_instantiated));
+    if(is_instantiated)
+      return APP_INVALID_ARGUMENT;
+  }
+
+  /* The new geometry is copied aside in order to keep the previous one, and
+   * the meshes it defines, on error. */
+  rsrc_err = rsrc_create_geometry(model->app->rsrc.context, &geometry);
+  if(rsrc_err != RSRC_NO_ERROR) {
+    app_err = rsrc_to_app_error(rsrc_err);
+    goto error;
+  }
+  rsrc_err = rsrc_copy_geometry(geometry, geom);
+  if(rsrc_err != RSRC_NO_ERROR) {
+    app_err = rsrc_to_app_error(rsrc_err);
+    goto error;
+  }
+  if(nb_triangle_sets != nb_meshes) {
+    /* The model is not instantiated; its render data are rebuilt. */
+    struct rsrc_geometry* prev_geometry = model->geometry;
+    model->geometry = geometry;
+    geometry = prev_geometry;
+    app_err = setup_model(model);
+    if(app_err != APP_NO_ERROR) {
+      geometry = model->geometry;
+      model->geometry = prev_geometry;
+      if(setup_model(model) != APP_NO_ERROR) {
+        APP_PRINT_ERR
+          (model->app->logger, "cannot restore the model geometry `%s'\n",
+           path);
+      }
+    }
+    goto exit;
+  }
+  for(i = 0, j = 0; i < nb_prim_set; ++i) {
+    struct rsrc_primitive_set prim_set;
+    RSRC(get_primitive_set(geometry, i, &prim_set));
+    if(prim_set.primitive_type != RSRC_TRIANGLE)
+      continue;
+    ++nb_updated_meshes;
+    app_err = setup_mesh(mesh_lstbuf[j], &prim_set);
+    if(app_err != APP_NO_ERROR)
+      goto error;
+    ++j;
+  }
+  RSRC(geometry_ref_put(model->geometry));
+  model->geometry = geometry;
+  geometry = NULL;
+  set_default_model_bounds(model);
+  for(j = 0; j < nb_meshes; ++j)
+    merge_mesh_bounds(model, mesh_lstbuf[j]);
+  if(setup_model_occluders(model) != APP_NO_ERROR) {
+    APP_PRINT_WARN
+      (model->app->logger, "cannot update the occluders of `%s'\n", path);
+  }
+
+exit:
+  if(geometry)
+    RSRC(geometry_ref_put(geometry));
+  return app_err;
+error:
+  /* Restore the meshes that were updated from the previous geometry. */
+  for(i = 0, j = 0; i < nb_prim_set && j < nb_updated_meshes; ++i) {
+    struct rsrc_primitive_set prim_set;
+    RSRC(get_primitive_set(model->geometry, i, &prim_set));
+    if(prim_set.primitive_type != RSRC_TRIANGLE)
+      continue;
+    if(setup_mesh(mesh_lstbuf[j], &prim_set) != APP_NO_ERROR) {
+      APP_PRINT_ERR
+        (model->app->logger, "cannot restore the model geometry `%s'\n",
+         path);
+    }
+    ++j;
+  }
+  goto exit;
+}
+
+enum app_error
+app_setup_model_lods
+  (struct app_model* model,
+   size_t nb_lods,
+   struct rsrc_geometry* const lod_list[],
+   const float error_list[])
+{
+  struct rdr_model_lod mdl_lod_list[RDR_MAX_MODEL_LODS - 1];
+  struct rdr_model** mdl_lstbuf = NULL;
+  size_t nb_models = 0;
+  size_t nb_mdl_lods = 0;
+  size_t nb_indices = 0;
+  size_t nb_prim_set = 0;
+  size_t i = 0;
+  size_t j = 0;
+  enum rdr_error rdr_err = RDR_NO_ERROR;
+  enum app_error app_err = APP_NO_ERROR;
+  assert(model && nb_lods < RDR_MAX_MODEL_LODS);
+  assert(!nb_lods || (lod_list && error_list));
+
+  SL(vector_buffer
+    (model->model_list, &nb_models, NULL, NULL, (void**)&mdl_lstbuf));
+  RSRC(get_primitive_set_count(model->geometry, &nb_prim_set));
+  for(i = 0, j = 0; i < nb_prim_set; ++i) {
+    struct rsrc_primitive_set prim_set;
+    RSRC(get_primitive_set(model->geometry, i, &prim_set));
+    if(prim_set.primitive_type != RSRC_TRIANGLE)
+      continue;
+    assert(j < nb_models);
+
+    nb_indices = prim_set.nb_indices;
+    for(nb_mdl_lods = 0; nb_mdl_lods < nb_lods; ++nb_mdl_lods) {
+      struct rdr_mesh* mesh = NULL;
+      RSRC(get_primitive_set(lod_list[nb_mdl_lods], i, &prim_set));
+      /* A level is not worth its draw if it removes less than a quarter of
+       * the triangles of the previous one. */
+      if(!prim_set.nb_indices || prim_set.nb_indices > nb_indices * 3 / 4)
+        break;
+      nb_indices = prim_set.nb_indices;
+      rdr_err = rdr_create_mesh(model->app->rdr.system, &mesh);
+      if(rdr_err != RDR_NO_ERROR) {
+        app_err = rdr_to_app_error(rdr_err);
+        goto error;
+      }
+      mdl_lod_list[nb_mdl_lods].mesh = mesh;
+      mdl_lod_list[nb_mdl_lods].error = error_list[nb_mdl_lods];
+      app_err = setup_mesh(mesh, &prim_set);
+      if(app_err != APP_NO_ERROR) {
+        ++nb_mdl_lods;
+        goto error;
+      }
+    }
+    rdr_err = rdr_model_lods(mdl_lstbuf[j], nb_mdl_lods, mdl_lod_list);
+    if(rdr_err != RDR_NO_ERROR) {
+      app_err = rdr_to_app_error(rdr_err);
+      goto error;
+    }
+    /* The render model holds its own references onto the meshes. */
+    for(; nb_mdl_lods > 0; --nb_mdl_lods)
+      RDR(mesh_ref_put(mdl_lod_list[nb_mdl_lods - 1].mesh));
+    ++j;
+  }
+
+exit:
+  return app_err;
+error:
+  for(; nb_mdl_lods > 0; --nb_mdl_lods)
+    RDR(mesh_ref_put(mdl_lod_list[nb_mdl_lods - 1].mesh));
+  for(j = 0; j < nb_models; ++j)
+    RDR(model_lods(mdl_lstbuf[j], 0, NULL));
+  goto exit;
+}
+
 /*******************************************************************************
  *
  * Model instance function(s).
@@ -668,18 +1278,42 @@ app_instantiate_model
    struct app_model_instance** out_instance)
 {
   struct app_model_instance* instance = NULL;
-  struct rdr_model_instance* render_instance = NULL;
-  size_t len = 0;
+  const char* name_list[1] = { name ? name : "unamed" };
+  enum app_error app_err = APP_NO_ERROR;
+
+  app_err = app_instantiate_model_n(app, model, 1, name_list, NULL, &instance);
+  if(out_instance)
+    *out_instance = instance;
+  return app_err;
+}
+
+enum app_error
+app_instantiate_model_n
+  (struct app* app,
+   struct app_model* model,
+   size_t nb_instances,
+   const char* name_list[],
+   const struct aosf44* transform_list,
+   struct app_model_instance* instance_list[])
+{
+  char name_buf[32];
+  struct rdr_model** model_lstbuf = NULL;
+  struct rdr_model_instance** render_instance_list = NULL;
+  float* render_transform_list = NULL;
+  size_t nb_models = 0;
+  size_t first_name_id = 0;
   size_t i = 0;
+  size_t j = 0;
   enum app_error app_err = APP_NO_ERROR;
   enum rdr_error rdr_err = RDR_NO_ERROR;
   enum sl_error sl_err = SL_NO_ERROR;
-  bool is_ref_get = false;
 
-  if(!app || !model) {
-    app_err = APP_INVALID_ARGUMENT;
-    goto error;
-  }
+  /* The instance list is not initialized yet; do not release it. */
+  if(!app || !model || (nb_instances && !instance_list))
+    return APP_INVALID_ARGUMENT;
+  if(!nb_instances)
+    goto exit;
+  memset(instance_list, 0, nb_instances * sizeof(struct app_model_instance*));
 
   #define CALL(func) \
     do { \
@@ -689,55 +1323,94 @@ app_instantiate_model
       } \
     } while(0)
 
-  app_err = app_create_model_instance(app, name, &instance);
-  if(app_err != APP_NO_ERROR)
-    goto error;
-
   if(model->model_list) {
-    struct rdr_model** model_lstbuf = NULL;
-
     SL(vector_buffer
-       (model->model_list, &len, NULL, NULL, (void**)&model_lstbuf));
-    for(i = 0; i < len; ++i) {
-      rdr_err = rdr_create_model_instance
-        (app->rdr.system, model_lstbuf[i], &render_instance);
-      if(rdr_err != RDR_NO_ERROR) {
-        app_err = rdr_to_app_error(rdr_err);
+       (model->model_list, &nb_models, NULL, NULL, (void**)&model_lstbuf));
+  }
+  /* Default names are numbered from the current count of instances rather
+   * than from 0 in order to avoid probing the names that are already used. */
+  APP(get_model_instance_list_length(app, &first_name_id));
+  for(i = 0; i < nb_instances; ++i) {
+    const char* name = name_list ? name_list[i] : NULL;
+    if(!name) {
+      snprintf(name_buf, sizeof(name_buf), "unamed_%zu", first_name_id + i);
+      name = name_buf;
+    }
+    app_err = app_create_model_instance(app, name, instance_list + i);
+    if(app_err != APP_NO_ERROR)
+      goto error;
+    if(transform_list) {
+      instance_list[i]->transform = transform_list[i];
+      instance_list[i]->world_transform = transform_list[i];
+    }
+    CALL(sl_vector_reserve(instance_list[i]->model_instance_list, nb_models));
+  }
+
+  if(nb_models) {
+    render_instance_list = MEM_CALLOC
+      (app->allocator, nb_instances, sizeof(struct rdr_model_instance*));
+    if(!render_instance_list) {
+      app_err = APP_MEMORY_ERROR;
+      goto error;
+    }
+    if(transform_list) {
+      render_transform_list = MEM_ALIGNED_ALLOC
+        (app->allocator, nb_instances * 16 * sizeof(float), 16);
+      if(!render_transform_list) {
+        app_err = APP_MEMORY_ERROR;
         goto error;
       }
+      for(i = 0; i < nb_instances; ++i)
+        aosf44_store(render_transform_list + i * 16, transform_list + i);
+    }
+  }
+  for(j = 0; j < nb_models; ++j) {
+    rdr_err = rdr_create_model_instances
+      (app->rdr.system,
+       model_lstbuf[j],
+       nb_instances,
+       render_transform_list,
+       render_instance_list);
+    if(rdr_err != RDR_NO_ERROR) {
+      app_err = rdr_to_app_error(rdr_err);
+      goto error;
+    }
+    for(i = 0; i < nb_instances; ++i) {
       CALL(sl_vector_push_back
-        (instance->model_instance_list, &render_instance));
-      render_instance = NULL;
+        (instance_list[i]->model_instance_list, render_instance_list + i));
+      render_instance_list[i] = NULL;
     }
   }
-
-  app_err = app_model_ref_get(model);
-  if(app_err != APP_NO_ERROR)
-    goto error;
-  is_ref_get = true;
-  instance->model = model;
-  list_add(&model->instance_list, &instance->model_node);
-
-  APP(invoke_callbacks(app, APP_SIGNAL_CREATE_MODEL_INSTANCE, instance));
-  instance->invoke_clbk = true;
-
   #undef CALL
 
+  for(i = 0; i < nb_instances; ++i) {
+    struct app_model_instance* instance = instance_list[i];
+    APP(model_ref_get(model));
+    instance->model = model;
+    list_add(&model->instance_list, &instance->model_node);
+    APP(invoke_callbacks(app, APP_SIGNAL_CREATE_MODEL_INSTANCE, instance));
+    instance->invoke_clbk = true;
+  }
+
 exit:
-  if(out_instance)
-    *out_instance = instance;
+  if(render_instance_list)
+    MEM_FREE(app->allocator, render_instance_list);
+  if(render_transform_list)
+    MEM_FREE(app->allocator, render_transform_list);
   return app_err;
 error:
-  if(instance) {
-    APP(model_instance_ref_put(instance));
-    instance = NULL;
+  if(render_instance_list) {
+    for(i = 0; i < nb_instances; ++i) {
+      if(render_instance_list[i])
+        RDR(model_instance_ref_put(render_instance_list[i]));
+    }
   }
-  if(render_instance) {
-    RDR(model_instance_ref_put(render_instance));
-    render_instance = NULL;
+  if(instance_list) {
+    for(i = 0; i < nb_instances && instance_list[i]; ++i) {
+      APP(model_instance_ref_put(instance_list[i]));
+      instance_list[i] = NULL;
+    }
   }
-  if(is_ref_get)
-    APP(model_ref_put(model));
   goto exit;
 }
 
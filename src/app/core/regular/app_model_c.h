@@ -1,14 +1,91 @@
 #ifndef APP_MODEL_C_H
 #define APP_MODEL_C_H
 
+#include "app/core/app_error.h"
+#include "resources/rsrc_error.h"
 #include "sys/sys.h"
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
 
+struct app;
 struct app_model;
 struct app_object;
+struct rsrc_context;
+struct rsrc_geometry;
+struct rsrc_wavefront_obj;
 
 LOCAL_SYM struct app_model*
 app_object_to_model
   (struct app_object* obj);
 
+LOCAL_SYM enum app_error
+app_is_model_registered
+  (struct app_model* model,
+   bool* is_registered);
+
+/* Define the path of the binary cache file of the path geometry. The raw and
+ * the optimized geometries have distinct cache files. Return false if the
+ * geometry cache is disabled. */
+LOCAL_SYM bool
+app_model_cache_path
+  (struct app* app,
+   const char* path,
+   bool optimize,
+   char cache_path[PATH_MAX]);
+
+/* Build the geometry of the path resource. Does not rely on the application
+ * state and can thus be invoked by any thread that owns the context, the
+ * parser and the geometry. */
+LOCAL_SYM enum rsrc_error
+app_build_model_geometry
+  (struct rsrc_context* ctxt,
+   struct rsrc_wavefront_obj* wobj,
+   struct rsrc_geometry* geom,
+   const char* path,
+   const char* cache_path, /* May be NULL. */
+   bool optimize,
+   bool* is_cache_written); /* Up to date cache file. */
+
+/* Build the nb_lods coarser levels of detail of geom into lod_list. Each level
+ * is simplified from the previous one and its error, stored in error_list,
+ * bounds its distance to geom. Does not rely on the application state. */
+LOCAL_SYM enum rsrc_error
+app_build_model_lods
+  (const struct rsrc_geometry* geom,
+   size_t nb_lods,
+   struct rsrc_geometry* const lod_list[],
+   float error_list[]);
+
+/* Setup the render data of the model from geom, or from the geometry of the
+ * model if geom is NULL. The instances spawned before this call get their
+ * render instances. The model is cleared on error. */
+LOCAL_SYM enum app_error
+app_setup_model_geometry
+  (struct app_model* model,
+   const char* path,
+   const struct rsrc_geometry* geom); /* May be NULL. */
+
+/* Update the render meshes of the model from geom without creating new render
+ * models, i.e. the model instances are kept and use the new geometry. Return
+ * APP_INVALID_ARGUMENT if the geom layout does not match the meshes of an
+ * instantiated model. The model keeps its previous geometry on error. */
+LOCAL_SYM enum app_error
+app_reload_model_geometry
+  (struct app_model* model,
+   const char* path,
+   const struct rsrc_geometry* geom);
+
+/* Define the levels of detail of the render models from the lod_list built by
+ * app_build_model_lods from the model geometry. A level that does not reduce
+ * enough the triangles of a render model is dropped. A null nb_lods, or an
+ * error, removes the levels of detail. */
+LOCAL_SYM enum app_error
+app_setup_model_lods
+  (struct app_model* model,
+   size_t nb_lods,
+   struct rsrc_geometry* const lod_list[],
+   const float error_list[]);
+
 #endif /* APP_MODEL_C_H */
 
@@ -1,6 +1,7 @@
 #include "app/core/regular/app_core_c.h"
 #include "app/core/regular/app_error_c.h"
 #include "app/core/regular/app_model_instance_c.h"
+#include "app/core/regular/app_scene_graph_c.h"
 #include "app/core/app_model.h"
 #include "app/core/app_model_instance.h"
 #include "app/core/app_world.h"
@@ -22,6 +23,100 @@
  * Helper functions.
  *
  ******************************************************************************/
+/* The dirty lists are reserved to the number of instances. Flagging an
+ * instance thus cannot fail. */
+static void
+flag_dirty_transform(struct app_model_instance* instance)
+{
+  struct sl_vector* dirty_list = NULL;
+  assert(instance);
+
+  if(instance->dirty_id != SIZE_MAX)
+    return;
+  dirty_list = instance->app->transform.dirty_list;
+  SL(vector_length(dirty_list, &instance->dirty_id));
+  SL(vector_push_back(dirty_list, &instance));
+}
+
+static void
+unflag_dirty_transform(struct app_model_instance* instance)
+{
+  struct app_model_instance** dirty_list = NULL;
+  size_t len = 0;
+  assert(instance);
+
+  if(instance->dirty_id == SIZE_MAX)
+    return;
+  SL(vector_buffer
+    (instance->app->transform.dirty_list,
+     &len, NULL, NULL, (void**)&dirty_list));
+  assert(instance->dirty_id < len);
+  assert(dirty_list[instance->dirty_id] == instance);
+  dirty_list[instance->dirty_id] = dirty_list[len - 1];
+  dirty_list[instance->dirty_id]->dirty_id = instance->dirty_id;
+  SL(vector_pop_back(instance->app->transform.dirty_list));
+  instance->dirty_id = SIZE_MAX;
+}
+
+/* The transform is exact even though the hierarchy is not committed yet. */
+static void
+compute_world_transform
+  (const struct app_model_instance* instance,
+   struct aosf44* transform)
+{
+  const struct app_model_instance* parent = NULL;
+  assert(instance && transform);
+
+  *transform = instance->transform;
+  for(parent = instance->parent; parent; parent = parent->parent)
+    aosf44_mulf44(transform, &parent->transform, transform);
+}
+
+/* Pre-order traversal of the subtree of root. */
+static struct app_model_instance*
+next_in_subtree
+  (const struct app_model_instance* root,
+   struct app_model_instance* instance)
+{
+  assert(root && instance);
+
+  if(!is_list_empty(&instance->child_list)) {
+    return CONTAINER_OF
+      (list_head(&instance->child_list), struct app_model_instance,
+       child_node);
+  }
+  while(instance != root) {
+    struct app_model_instance* parent = instance->parent;
+    if(instance->child_node.next != &parent->child_list) {
+      return CONTAINER_OF
+        (instance->child_node.next, struct app_model_instance, child_node);
+    }
+    instance = parent;
+  }
+  return NULL;
+}
+
+static void
+set_parent
+  (struct app_model_instance* instance,
+   struct app_model_instance* parent)
+{
+  struct app_model_instance* node = NULL;
+  assert(instance);
+
+  if(instance->parent)
+    list_del(&instance->child_node);
+  instance->parent = parent;
+  if(parent)
+    list_add_tail(&parent->child_list, &instance->child_node);
+
+  instance->depth = parent ? parent->depth + 1 : 0;
+  node = next_in_subtree(instance, instance);
+  for(; node; node = next_in_subtree(instance, node))
+    node->depth = node->parent->depth + 1;
+  flag_dirty_transform(instance);
+}
+
 static void
 release_model_instance(struct ref* ref)
 {
@@ -37,6 +132,19 @@ release_model_instance(struct ref* ref)
     APP(invoke_callbacks
       (instance->app, APP_SIGNAL_DESTROY_MODEL_INSTANCE, instance));
 
+  /* Detach the children of the instance. Their world transform is kept. */
+  while(!is_list_empty(&instance->child_list)) {
+    struct app_model_instance* child = CONTAINER_OF
+      (list_head(&instance->child_list), struct app_model_instance,
+       child_node);
+    compute_world_transform(child, &child->transform);
+    set_parent(child, NULL);
+  }
+  if(instance->parent)
+    list_del(&instance->child_node);
+  unflag_dirty_transform(instance);
+  --app->transform.nb_instances;
+
   if(instance->model_instance_list) {
     if(instance->world) {
       APP(world_remove_model_instances(instance->world, 1, &instance));
@@ -73,6 +181,7 @@ get_model_instance_obb
 {
   float min_bound[3] = { 0.f, 0.f, 0.f };
   float max_bound[3] = { 0.f, 0.f, 0.f };
+  ALIGN(16) struct aosf44 transform;
   bool is_infinite = false;
 
   assert(instance && position && extend_x && extend_y && extend_z);
@@ -90,11 +199,7 @@ get_model_instance_obb
     *position = vf4_zero();
     *extend_x = *extend_y = *extend_z = vf4_set1(FLT_MAX);
   } else {
-    const struct aosf33 f33 = {
-      .c0 = instance->transform.c0,
-      .c1 = instance->transform.c1,
-      .c2 = instance->transform.c2
-    };
+    struct aosf33 f33;
     const vf4_t vmin = vf4_set(min_bound[0], min_bound[1], min_bound[2], 1.f);
     const vf4_t vmax = vf4_set(max_bound[0], max_bound[1], max_bound[2], 1.f);
     const vf4_t vhmin = vf4_mul(vmin, vf4_set(0.5f, 0.5f, 0.5f, 1.f));
@@ -105,7 +210,11 @@ get_model_instance_obb
     const vf4_t vexty = vf4_and(vext, vf4_mask(false, true, false, true));
     const vf4_t vextz = vf4_and(vext, vf4_mask(false, false, true, true));
 
-    *position = vf4_add(aosf33_mulf3(&f33, vpos), instance->transform.c3);
+    compute_world_transform(instance, &transform);
+    f33.c0 = transform.c0;
+    f33.c1 = transform.c1;
+    f33.c2 = transform.c2;
+    *position = vf4_add(aosf33_mulf3(&f33, vpos), transform.c3);
     *extend_x = aosf33_mulf3(&f33, vextx);
     *extend_y = aosf33_mulf3(&f33, vexty);
     *extend_z = aosf33_mulf3(&f33, vextz);
@@ -224,41 +333,15 @@ app_translate_model_instances
     const vf4_t vec = vf4_set(trans[0], trans[1], trans[2], 1.f);
     for(i = 0; i < nb_instances; ++i) {
       struct app_model_instance* instance = instance_list[i];
-      struct rdr_model_instance** render_instance_list = NULL;
-      size_t nb_render_instances = 0;
-      /* Translate the instance. */
       instance->transform.c3 = aosf44_mulf4(&instance->transform, vec);
-      /* Translate the render data of the instance. */
-      SL(vector_buffer
-        (instance_list[i]->model_instance_list,
-         &nb_render_instances,
-         NULL, NULL,
-         (void**)&render_instance_list));
-      RDR(translate_model_instances
-        (render_instance_list,
-         nb_render_instances,
-         local_translation,
-         trans));
+      flag_dirty_transform(instance);
     }
   } else {
     const vf4_t vec = vf4_set(trans[0], trans[1], trans[2], 0.f);
     for(i = 0; i < nb_instances; ++i) {
       struct app_model_instance* instance = instance_list[i];
-      struct rdr_model_instance** render_instance_list = NULL;
-      size_t nb_render_instances = 0;
-      /* Translate the instance. */
       instance->transform.c3 = vf4_add(instance->transform.c3, vec);
-      /* Translate the render data of the instance. */
-      SL(vector_buffer
-        (instance_list[i]->model_instance_list,
-         &nb_render_instances,
-         NULL, NULL,
-         (void**)&render_instance_list));
-      RDR(translate_model_instances
-        (render_instance_list,
-         nb_render_instances,
-         local_translation,
-         trans));
+      flag_dirty_transform(instance);
     }
   }
   return APP_NO_ERROR;
@@ -278,36 +361,23 @@ app_rotate_model_instances
   if((nb_instances && !instance_list) || !rotation)
     return APP_INVALID_ARGUMENT;
   if((!rotation[PITCH]) & (!rotation[YAW]) & (!rotation[ROLL]))
-     return RDR_NO_ERROR;
+     return APP_NO_ERROR;
 
   aosf33_rotation(&f33, rotation[PITCH], rotation[YAW], rotation[ROLL]);
   if(local_rotation) {
     for(i = 0; i < nb_instances; ++i) {
       struct aosf33 res;
       struct app_model_instance* instance = instance_list[i];
-      struct rdr_model_instance** render_instance_list = NULL;
-      size_t nb_render_instances = 0;
       const struct aosf33 tmp = {
         .c0 = instance->transform.c0,
         .c1 = instance->transform.c1,
         .c2 = instance->transform.c2
       };
-      /* Rotate the instance. */
       aosf33_mulf33(&res, &tmp, &f33);
       instance->transform.c0 = res.c0;
       instance->transform.c1 = res.c1;
       instance->transform.c2 = res.c2;
-      /* Rotate the render data of the instances. */
-      SL(vector_buffer
-       (instance_list[i]->model_instance_list,
-        &nb_render_instances,
-        NULL, NULL,
-        (void**)&render_instance_list));
-      RDR(rotate_model_instances
-        (render_instance_list,
-         nb_render_instances,
-         local_rotation,
-         rotation));
+      flag_dirty_transform(instance);
     }
   } else {
     const struct aosf44 f44 = {
@@ -318,23 +388,8 @@ app_rotate_model_instances
     };
     for(i = 0; i < nb_instances; ++i) {
       struct app_model_instance* instance = instance_list[i];
-      struct rdr_model_instance** render_instance_list = NULL;
-      size_t nb_render_instances = 0;
-      /* Rotate the instance. */
       aosf44_mulf44(&instance->transform, &f44, &instance->transform);
-      /* transform the render data of the instance. Note that we use the
-       * transform function rather than the rotate one ine order to avoid the
-       * costly recomputation of the rotation matrix. */
-      SL(vector_buffer
-       (instance_list[i]->model_instance_list,
-        &nb_render_instances,
-        NULL, NULL,
-        (void**)&render_instance_list));
-      RDR(transform_model_instances
-        (render_instance_list,
-         nb_render_instances,
-         local_rotation,
-         &f44));
+      flag_dirty_transform(instance);
     }
   }
   return APP_NO_ERROR;
@@ -353,7 +408,7 @@ app_scale_model_instances
   if((nb_instances && !instance_list) || !scale)
     return APP_INVALID_ARGUMENT;
   if((scale[0] == 1.f) & (scale[1] == 1.f) & (scale[2] == 1.f))
-    return RDR_NO_ERROR;
+    return APP_NO_ERROR;
 
   f33.c0 = vf4_set(scale[0], 0.f, 0.f, 0.f);
   f33.c1 = vf4_set(0.f, scale[1], 0.f, 0.f);
@@ -367,24 +422,11 @@ app_scale_model_instances
         .c1 = instance->transform.c1,
         .c2 = instance->transform.c2
       };
-      struct rdr_model_instance** render_instance_list = NULL;
-      size_t nb_render_instances = 0;
-      /* Scale the instance. */
       aosf33_mulf33(&tmp, &tmp, &f33);
       instance->transform.c0 = tmp.c0;
       instance->transform.c1 = tmp.c1;
       instance->transform.c2 = tmp.c2;
-      /* Scale the render data of the instance. */
-      SL(vector_buffer
-        (instance_list[i]->model_instance_list,
-         &nb_render_instances,
-         NULL, NULL,
-         (void**)&render_instance_list));
-      RDR(scale_model_instances
-        (render_instance_list,
-         nb_render_instances,
-         local_scale,
-         scale));
+      flag_dirty_transform(instance);
     }
   } else {
     const struct aosf44 f44 = {
@@ -395,21 +437,8 @@ app_scale_model_instances
     };
     for(i = 0; i < nb_instances; ++i) {
       struct app_model_instance* instance = instance_list[i];
-      struct rdr_model_instance** render_instance_list = NULL;
-      size_t nb_render_instances = 0;
-      /* Scale the instance. */
       aosf44_mulf44(&instance->transform, &f44, &instance->transform);
-      /* Scale the render data of the instance. */
-      SL(vector_buffer
-        (instance_list[i]->model_instance_list,
-         &nb_render_instances,
-         NULL, NULL,
-         (void**)&render_instance_list));
-      RDR(scale_model_instances
-        (render_instance_list,
-         nb_render_instances,
-         local_scale,
-         scale));
+      flag_dirty_transform(instance);
     }
   }
   return APP_NO_ERROR;
@@ -428,17 +457,8 @@ app_move_model_instances
 
   for(i = 0; i < nb_instances; ++i) {
     struct app_model_instance* instance = instance_list[i];
-    struct rdr_model_instance** render_instance_list = NULL;
-    size_t nb_render_instances = 0;
-    /* Move the instance. */
     instance->transform.c3 = vf4_set(pos[0], pos[1], pos[2], 1.f);
-    /* Move the render data of the instance. */
-    SL(vector_buffer
-      (instance_list[i]->model_instance_list,
-       &nb_render_instances,
-       NULL, NULL,
-       (void**)&render_instance_list));
-    RDR(move_model_instances(render_instance_list, nb_render_instances, pos));
+    flag_dirty_transform(instance);
   }
   return APP_NO_ERROR;
 }
@@ -458,40 +478,14 @@ app_transform_model_instances
   if(local_transform) {
     for(i = 0; i < nb_instances; ++i) {
       struct app_model_instance* instance = instance_list[i];
-      struct rdr_model_instance** render_instance_list = NULL;
-      size_t nb_render_instances = 0;
-      /* Transform the instance. */
       aosf44_mulf44(&instance->transform, &instance->transform, transform);
-      /* Transform the render data oftthe instance. */
-      SL(vector_buffer
-        (instance_list[i]->model_instance_list,
-         &nb_render_instances,
-         NULL, NULL,
-         (void**)&render_instance_list));
-      RDR(transform_model_instances
-        (render_instance_list,
-         nb_render_instances,
-         local_transform,
-         transform));
+      flag_dirty_transform(instance);
     }
   } else {
     for(i = 0; i < nb_instances; ++i) {
       struct app_model_instance* instance = instance_list[i];
-      struct rdr_model_instance** render_instance_list = NULL;
-      size_t nb_render_instances = 0;
-      /* Transform the instance. */
       aosf44_mulf44(&instance->transform, transform, &instance->transform);
-      /* Transform the render data oftthe instance. */
-      SL(vector_buffer
-        (instance_list[i]->model_instance_list,
-         &nb_render_instances,
-         NULL, NULL,
-         (void**)&render_instance_list));
-      RDR(transform_model_instances
-        (render_instance_list,
-         nb_render_instances,
-         local_transform,
-         transform));
+      flag_dirty_transform(instance);
     }
   }
   return APP_NO_ERROR;
@@ -508,6 +502,47 @@ app_model_instance_world
   return APP_NO_ERROR;
 }
 
+enum app_error
+app_set_model_instance_parent
+  (struct app_model_instance* instance,
+   struct app_model_instance* parent)
+{
+  const struct app_model_instance* ancestor = NULL;
+
+  if(!instance || (parent && parent->app != instance->app))
+    return APP_INVALID_ARGUMENT;
+  /* Reject the cycles. */
+  for(ancestor = parent; ancestor; ancestor = ancestor->parent) {
+    if(ancestor == instance)
+      return APP_INVALID_ARGUMENT;
+  }
+  if(instance->parent != parent)
+    set_parent(instance, parent);
+  return APP_NO_ERROR;
+}
+
+enum app_error
+app_get_model_instance_parent
+  (const struct app_model_instance* instance,
+   struct app_model_instance** parent)
+{
+  if(!instance || !parent)
+    return APP_INVALID_ARGUMENT;
+  *parent = instance->parent;
+  return APP_NO_ERROR;
+}
+
+enum app_error
+app_get_model_instance_world_transform
+  (const struct app_model_instance* instance,
+   struct aosf44* transform)
+{
+  if(!instance || !transform)
+    return APP_INVALID_ARGUMENT;
+  compute_world_transform(instance, transform);
+  return APP_NO_ERROR;
+}
+
 enum app_error
 app_get_model_instance_aabb
   (const struct app_model_instance* instance,
@@ -754,9 +789,26 @@ app_create_model_instance
   ref_init(&instance->ref);
   list_init(&instance->model_node);
   list_init(&instance->world_node);
+  list_init(&instance->child_list);
+  list_init(&instance->child_node);
   aosf44_identity(&instance->transform);
+  aosf44_identity(&instance->world_transform);
+  instance->dirty_id = SIZE_MAX;
   APP(ref_get(app));
   instance->app = app;
+  ++app->transform.nb_instances;
+
+  /* Ensure that the instances can be flagged as dirty without failure. */
+  sl_err = sl_vector_reserve
+    (app->transform.dirty_list, app->transform.nb_instances);
+  if(sl_err == SL_NO_ERROR) {
+    sl_err = sl_vector_reserve
+      (app->transform.commit_list, app->transform.nb_instances);
+  }
+  if(sl_err != SL_NO_ERROR) {
+    app_err = sl_to_app_error(sl_err);
+    goto error;
+  }
 
   app_err = app_init_object
     (app,
@@ -795,3 +847,46 @@ app_object_to_model_instance(struct app_object* obj)
   return CONTAINER_OF(obj, struct app_model_instance, obj);
 }
 
+
+enum app_error
+app_commit_model_instance_transforms(struct app* app)
+{
+  struct app_model_instance** dirty_list = NULL;
+  struct app_model_instance** updated_list = NULL;
+  struct sl_vector* commit_list = NULL;
+  size_t nb_dirty_instances = 0;
+  size_t nb_updated_instances = 0;
+  size_t i = 0;
+  enum app_error app_err = APP_NO_ERROR;
+
+  if(!app)
+    return APP_INVALID_ARGUMENT;
+
+  SL(vector_buffer
+    (app->transform.dirty_list,
+     &nb_dirty_instances,
+     NULL, NULL,
+     (void**)&dirty_list));
+  if(!nb_dirty_instances)
+    return APP_NO_ERROR;
+
+  app_err = app_update_world_transforms
+    (app, nb_dirty_instances, dirty_list, &nb_updated_instances,
+     &updated_list);
+  if(app_err != APP_NO_ERROR)
+    return app_err;
+
+  /* Swap the dirty and the commit lists. The transforms changed by the
+   * callbacks are thus committed by the next invocation. */
+  commit_list = app->transform.dirty_list;
+  app->transform.dirty_list = app->transform.commit_list;
+  app->transform.commit_list = commit_list;
+  for(i = 0; i < nb_dirty_instances; ++i)
+    dirty_list[i]->dirty_id = SIZE_MAX;
+
+  APP(invoke_callbacks
+    (app, APP_SIGNAL_TRANSFORM_MODEL_INSTANCES, updated_list,
+     nb_updated_instances));
+  SL(clear_vector(commit_list));
+  return APP_NO_ERROR;
+}
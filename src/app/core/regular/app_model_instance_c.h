@@ -8,7 +8,10 @@
 #include "sys/ref_count.h"
 #include "sys/sys.h"
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
+struct app;
 struct app_model_instance;
 struct sl_vector;
 
@@ -19,7 +22,8 @@ enum app_model_instance_it_type {
 
 /* Data of app_model_instance. */
 struct app_model_instance {
-  ALIGN(16) struct aosf44 transform;
+  ALIGN(16) struct aosf44 transform; /* Relative to the parent. */
+  ALIGN(16) struct aosf44 world_transform; /* Up to date once committed. */
   struct app_object obj;
   struct ref ref;
   struct list_node model_node; /* Linked the instance against its model.*/
@@ -27,6 +31,15 @@ struct app_model_instance {
   struct app* app;
   struct app_model* model;
   struct app_world* world;
+  struct app_model_instance* parent; /* NULL <=> root of a hierarchy. */
+  struct list_node child_list;
+  struct list_node child_node; /* Linked the instance against its parent. */
+  size_t depth; /* Number of ancestors. */
+  size_t update_stamp; /* Used by the scene graph to visit the instance once. */
+  uint32_t pick_id; /* Id of the instance into its world. */
+  /* Position into the dirty transform list of the app. SIZE_MAX <=> the
+   * render instances are up to date with the transform. */
+  size_t dirty_id;
   struct sl_vector* model_instance_list; /* list of rdr_model_instance*. */
   bool invoke_clbk; /* Help for error management. For internal use nly. */
 };
@@ -0,0 +1,595 @@
+#include "app/core/regular/app_core_c.h"
+#include "app/core/regular/app_error_c.h"
+#include "app/core/regular/app_model_c.h"
+#include "app/core/regular/app_model_loader_c.h"
+#include "app/core/app_cvar.h"
+#include "app/core/app_model.h"
+#include "renderer/rdr_model.h"
+#include "resources/rsrc_context.h"
+#include "resources/rsrc_geometry.h"
+#include "resources/rsrc_wavefront_obj.h"
+#include "stdlib/sl.h"
+#include "sys/list.h"
+#include "sys/math.h"
+#include "sys/mem_allocator.h"
+#include "sys/profiler.h"
+#include "sys/sys.h"
+#include <assert.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAX_LOADER_THREADS 4
+#define MAX_LOADER_LODS (RDR_MAX_MODEL_LODS - 1)
+
+enum model_load_state {
+  MODEL_LOAD_PENDING,
+  MODEL_LOAD_RUNNING,
+  MODEL_LOAD_DONE
+};
+
+/* The paths and the cvar values are copied at submission since the worker
+ * threads cannot access the application. */
+struct model_load {
+  struct list_node node;
+  char path[PATH_MAX];
+  char cache_path[PATH_MAX];
+  char error[512]; /* Error message of the resource context. */
+  struct app_model* model;
+  app_model_load_callback_t func;
+  void* data;
+  struct loader_thread* thread; /* Thread that owns the built geometry. */
+  enum model_load_state state;
+  enum rsrc_error rsrc_err;
+  float lod_error_list[MAX_LOADER_LODS];
+  size_t nb_lods;
+  bool is_cached;
+  bool is_cache_written;
+  bool is_reload; /* The model keeps its geometry if the load fails. */
+  bool is_lod_built;
+  bool optimize;
+};
+
+/* Each thread has its own allocator and resource objects since neither the
+ * allocators nor the reference counters are thread safe. */
+struct loader_thread {
+  pthread_t thread;
+  struct mem_allocator regular_allocator;
+  struct mem_allocator allocator; /* Proxy of the regular allocator. */
+  struct rsrc_context* context;
+  struct rsrc_wavefront_obj* wavefront_obj;
+  struct rsrc_geometry* geometry;
+  struct rsrc_geometry* lod_list[MAX_LOADER_LODS];
+  /* Load whose result is stored in the geometry. The thread waits for its
+   * commit before building another resource. */
+  struct model_load* load;
+  struct app_model_loader* loader;
+  bool is_started;
+};
+
+struct app_model_loader {
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  struct list_node pending_list;
+  struct list_node running_list; /* Running and done loads. */
+  struct loader_thread thread_list[MAX_LOADER_THREADS];
+  size_t nb_threads;
+  bool exit;
+};
+
+/*******************************************************************************
+ *
+ * Helper functions.
+ *
+ ******************************************************************************/
+static void
+build_geometry(struct loader_thread* thread, struct model_load* load)
+{
+  const char* str_err = NULL;
+  enum rsrc_error rsrc_err = RSRC_NO_ERROR;
+  assert(thread && load);
+
+  RSRC(flush_error(thread->context));
+  load->rsrc_err = app_build_model_geometry
+    (thread->context,
+     thread->wavefront_obj,
+     thread->geometry,
+     load->path,
+     load->is_cached ? load->cache_path : NULL,
+     load->optimize,
+     &load->is_cache_written);
+  if(load->rsrc_err != RSRC_NO_ERROR) {
+    RSRC(get_error_string(thread->context, &str_err));
+    if(str_err)
+      snprintf(load->error, sizeof(load->error), "%s", str_err);
+    RSRC(flush_error(thread->context));
+  } else {
+    /* The levels of detail are optional; the geometry is committed even
+     * though they cannot be built. */
+    rsrc_err = app_build_model_lods
+      (thread->geometry, load->nb_lods, thread->lod_list, load->lod_error_list);
+    load->is_lod_built = rsrc_err == RSRC_NO_ERROR;
+    if(!load->is_lod_built) {
+      load->nb_lods = 0;
+      RSRC(flush_error(thread->context));
+    }
+  }
+}
+
+static void*
+loader_thread_main(void* arg)
+{
+  struct loader_thread* thread = arg;
+  struct app_model_loader* loader = NULL;
+  struct model_load* load = NULL;
+  assert(arg);
+
+  loader = thread->loader;
+  prof_thread_name("model loader");
+  pthread_mutex_lock(&loader->mutex);
+  while(true) {
+    while(!loader->exit
+       && (thread->load || is_list_empty(&loader->pending_list)))
+      pthread_cond_wait(&loader->cond, &loader->mutex);
+    if(loader->exit)
+      break;
+
+    load = CONTAINER_OF
+      (list_head(&loader->pending_list), struct model_load, node);
+    list_move_tail(&load->node, &loader->running_list);
+    load->state = MODEL_LOAD_RUNNING;
+    load->thread = thread;
+    thread->load = load;
+    pthread_mutex_unlock(&loader->mutex);
+
+    PROF_BEGIN("build_geometry");
+    build_geometry(thread, load);
+    PROF_END();
+
+    pthread_mutex_lock(&loader->mutex);
+    load->state = MODEL_LOAD_DONE;
+    pthread_cond_broadcast(&loader->cond);
+  }
+  pthread_mutex_unlock(&loader->mutex);
+  return NULL;
+}
+
+static void
+release_loader_thread(struct loader_thread* thread, struct sl_logger* logger)
+{
+  size_t i = 0;
+  assert(thread);
+
+  for(i = 0; i < MAX_LOADER_LODS; ++i) {
+    if(thread->lod_list[i])
+      RSRC(geometry_ref_put(thread->lod_list[i]));
+  }
+  if(thread->geometry)
+    RSRC(geometry_ref_put(thread->geometry));
+  if(thread->wavefront_obj)
+    RSRC(wavefront_obj_ref_put(thread->wavefront_obj));
+  if(thread->context)
+    RSRC(context_ref_put(thread->context));
+  if(MEM_IS_ALLOCATOR_VALID(&thread->allocator)) {
+    if(MEM_ALLOCATED_SIZE(&thread->allocator)) {
+      char dump[BUFSIZ];
+      MEM_DUMP(&thread->allocator, dump, BUFSIZ);
+      if(logger)
+        APP_PRINT_MSG(logger, "Model loader leaks summary:\n%s\n", dump);
+    }
+    mem_shutdown_proxy_allocator(&thread->allocator);
+  }
+  if(MEM_IS_ALLOCATOR_VALID(&thread->regular_allocator))
+    mem_shutdown_regular_allocator(&thread->regular_allocator);
+  memset(thread, 0, sizeof(struct loader_thread));
+}
+
+static enum app_error
+init_loader_thread
+  (struct app_model_loader* loader,
+   struct loader_thread* thread)
+{
+  size_t i = 0;
+  enum rsrc_error rsrc_err = RSRC_NO_ERROR;
+  enum app_error app_err = APP_NO_ERROR;
+  assert(loader && thread);
+
+  memset(thread, 0, sizeof(struct loader_thread));
+  thread->loader = loader;
+
+  mem_init_regular_allocator(&thread->regular_allocator);
+  if(!MEM_IS_ALLOCATOR_VALID(&thread->regular_allocator)) {
+    app_err = APP_MEMORY_ERROR;
+    goto error;
+  }
+  mem_init_proxy_allocator
+    ("model loader", &thread->allocator, &thread->regular_allocator);
+  if(!MEM_IS_ALLOCATOR_VALID(&thread->allocator)) {
+    app_err = APP_MEMORY_ERROR;
+    goto error;
+  }
+
+  #define CALL(func) \
+    do { \
+      if((rsrc_err = func) != RSRC_NO_ERROR) { \
+        app_err = rsrc_to_app_error(rsrc_err); \
+        goto error; \
+      } \
+    } while(0)
+  CALL(rsrc_create_context(&thread->allocator, &thread->context));
+  CALL(rsrc_create_wavefront_obj(thread->context, &thread->wavefront_obj));
+  CALL(rsrc_create_geometry(thread->context, &thread->geometry));
+  for(i = 0; i < MAX_LOADER_LODS; ++i)
+    CALL(rsrc_create_geometry(thread->context, thread->lod_list + i));
+  #undef CALL
+
+  if(pthread_create(&thread->thread, NULL, loader_thread_main, thread) != 0) {
+    app_err = APP_INTERNAL_ERROR;
+    goto error;
+  }
+  thread->is_started = true;
+
+exit:
+  return app_err;
+error:
+  release_loader_thread(thread, NULL);
+  goto exit;
+}
+
+static void
+free_load(struct app* app, struct model_load* load)
+{
+  assert(app && load);
+  APP(model_ref_put(load->model));
+  MEM_FREE(app->allocator, load);
+}
+
+/* Return the first built resource, or NULL if wait is false and no resource
+ * is built. Return NULL if there is no more submitted loads. */
+static struct model_load*
+pop_done_load(struct app_model_loader* loader, bool wait)
+{
+  struct model_load* load = NULL;
+  struct list_node* node = NULL;
+  assert(loader);
+
+  pthread_mutex_lock(&loader->mutex);
+  while(true) {
+    LIST_FOR_EACH(node, &loader->running_list) {
+      struct model_load* l = CONTAINER_OF(node, struct model_load, node);
+      if(l->state == MODEL_LOAD_DONE) {
+        load = l;
+        break;
+      }
+    }
+    if(load
+    || !wait
+    || (  is_list_empty(&loader->pending_list)
+       && is_list_empty(&loader->running_list)))
+      break;
+    pthread_cond_wait(&loader->cond, &loader->mutex);
+  }
+  if(load)
+    list_del(&load->node);
+  pthread_mutex_unlock(&loader->mutex);
+  return load;
+}
+
+static enum app_error
+commit_load(struct app* app, struct model_load* load)
+{
+  struct app_model_loader* loader = NULL;
+  enum app_error app_err = APP_NO_ERROR;
+  enum app_error lod_err = APP_NO_ERROR;
+  bool is_registered = false;
+  assert(app && load && load->state == MODEL_LOAD_DONE && load->thread);
+
+  loader = app->model_loader;
+
+  APP(is_model_registered(load->model, &is_registered));
+  if(!is_registered) {
+    /* The model was removed during its loading. */
+    app_err = APP_INVALID_ARGUMENT;
+  } else if(load->rsrc_err != RSRC_NO_ERROR) {
+    APP_PRINT_ERR
+      (app->logger, "error loading geometry resource `%s'\n", load->path);
+    if(load->error[0] != '\0')
+      APP_PRINT_ERR(app->logger, "%s", load->error);
+    if(!load->is_reload)
+      APP(clear_model(load->model));
+    app_err = rsrc_to_app_error(load->rsrc_err);
+  } else {
+    if(load->is_cached && !load->is_cache_written) {
+      APP_PRINT_WARN
+        (app->logger, "cannot cache the geometry `%s'\n", load->path);
+    }
+    /* The loader thread waits for the commit. Its geometry can be thus safely
+     * read by this thread. */
+    if(!load->is_reload) {
+      app_err = app_setup_model_geometry
+        (load->model, load->path, load->thread->geometry);
+    } else {
+      app_err = app_reload_model_geometry
+        (load->model, load->path, load->thread->geometry);
+      if(app_err == APP_NO_ERROR) {
+        APP_PRINT_MSG(app->logger, "reloaded `%s'\n", load->path);
+      } else if(app_err == APP_INVALID_ARGUMENT) {
+        APP_PRINT_ERR
+          (app->logger,
+           "cannot reload the instantiated model `%s': its layout changed\n",
+           load->path);
+      }
+    }
+    /* A reloaded model loses its previous levels of detail even though the
+     * new ones are not built. */
+    if(app_err == APP_NO_ERROR) {
+      lod_err = app_setup_model_lods
+        (load->model,
+         load->nb_lods,
+         load->thread->lod_list,
+         load->lod_error_list);
+      if(lod_err != APP_NO_ERROR || !load->is_lod_built) {
+        APP_PRINT_WARN
+          (app->logger, "cannot build the levels of detail of `%s'\n",
+           load->path);
+      }
+    }
+  }
+
+  /* Release the loader thread. */
+  pthread_mutex_lock(&loader->mutex);
+  load->thread->load = NULL;
+  pthread_cond_broadcast(&loader->cond);
+  pthread_mutex_unlock(&loader->mutex);
+
+  if(load->func)
+    load->func(load->model, app_err, load->data);
+  free_load(app, load);
+  return app_err;
+}
+
+static enum app_error
+submit_load
+  (struct app* app,
+   const char* path,
+   struct app_model* model,
+   app_model_load_callback_t func,
+   void* data,
+   bool is_reload)
+{
+  struct app_model_loader* loader = NULL;
+  struct model_load* load = NULL;
+  enum app_error app_err = APP_NO_ERROR;
+
+  if(!app || !path || !model) {
+    app_err = APP_INVALID_ARGUMENT;
+    goto error;
+  }
+  if(strlen(path) >= PATH_MAX) {
+    app_err = APP_INVALID_ARGUMENT;
+    goto error;
+  }
+  loader = app->model_loader;
+  assert(loader != NULL);
+
+  load = MEM_CALLOC(app->allocator, 1, sizeof(struct model_load));
+  if(!load) {
+    app_err = APP_MEMORY_ERROR;
+    goto error;
+  }
+  list_init(&load->node);
+  strcpy(load->path, path);
+  load->optimize = app->cvar_system.rsrc_optimize_geometry->value.boolean;
+  load->nb_lods = (size_t)app->cvar_system.rsrc_model_lods->value.integer;
+  load->nb_lods = MIN(load->nb_lods, MAX_LOADER_LODS);
+  load->is_cached = app_model_cache_path
+    (app, path, load->optimize, load->cache_path);
+  load->func = func;
+  load->data = data;
+  load->is_reload = is_reload;
+  load->state = MODEL_LOAD_PENDING;
+  APP(model_ref_get(model));
+  load->model = model;
+
+  pthread_mutex_lock(&loader->mutex);
+  list_add_tail(&loader->pending_list, &load->node);
+  pthread_cond_broadcast(&loader->cond);
+  pthread_mutex_unlock(&loader->mutex);
+
+exit:
+  return app_err;
+error:
+  goto exit;
+}
+
+/*******************************************************************************
+ *
+ * Private model loader functions.
+ *
+ ******************************************************************************/
+enum app_error
+app_init_model_loader(struct app* app)
+{
+  struct app_model_loader* loader = NULL;
+  long nb_cpus = 0;
+  size_t i = 0;
+  enum app_error app_err = APP_NO_ERROR;
+  bool is_mutex_init = false;
+  bool is_cond_init = false;
+
+  if(!app) {
+    app_err = APP_INVALID_ARGUMENT;
+    goto error;
+  }
+  loader = MEM_CALLOC(app->allocator, 1, sizeof(struct app_model_loader));
+  if(!loader) {
+    app_err = APP_MEMORY_ERROR;
+    goto error;
+  }
+  list_init(&loader->pending_list);
+  list_init(&loader->running_list);
+  if(pthread_mutex_init(&loader->mutex, NULL) != 0) {
+    app_err = APP_INTERNAL_ERROR;
+    goto error;
+  }
+  is_mutex_init = true;
+  if(pthread_cond_init(&loader->cond, NULL) != 0) {
+    app_err = APP_INTERNAL_ERROR;
+    goto error;
+  }
+  is_cond_init = true;
+  app->model_loader = loader;
+
+  /* Keep one core for the render thread. */
+  nb_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  loader->nb_threads = nb_cpus > 1 ? (size_t)nb_cpus - 1 : 1;
+  loader->nb_threads = MIN(loader->nb_threads, MAX_LOADER_THREADS);
+  for(i = 0; i < loader->nb_threads; ++i) {
+    app_err = init_loader_thread(loader, loader->thread_list + i);
+    if(app_err != APP_NO_ERROR) {
+      loader->nb_threads = i;
+      goto error;
+    }
+  }
+
+exit:
+  return app_err;
+error:
+  if(loader) {
+    if(app->model_loader) {
+      APP(shutdown_model_loader(app));
+    } else {
+      if(is_cond_init)
+        pthread_cond_destroy(&loader->cond);
+      if(is_mutex_init)
+        pthread_mutex_destroy(&loader->mutex);
+      MEM_FREE(app->allocator, loader);
+    }
+  }
+  goto exit;
+}
+
+enum app_error
+app_shutdown_model_loader(struct app* app)
+{
+  struct app_model_loader* loader = NULL;
+  struct list_node* node = NULL;
+  struct list_node* tmp = NULL;
+  size_t i = 0;
+
+  if(!app)
+    return APP_INVALID_ARGUMENT;
+  if(!app->model_loader)
+    return APP_NO_ERROR;
+
+  loader = app->model_loader;
+  pthread_mutex_lock(&loader->mutex);
+  loader->exit = true;
+  pthread_cond_broadcast(&loader->cond);
+  pthread_mutex_unlock(&loader->mutex);
+
+  for(i = 0; i < loader->nb_threads; ++i) {
+    struct loader_thread* thread = loader->thread_list + i;
+    if(thread->is_started)
+      pthread_join(thread->thread, NULL);
+    release_loader_thread(thread, app->logger);
+  }
+  LIST_FOR_EACH_SAFE(node, tmp, &loader->pending_list) {
+    list_del(node);
+    free_load(app, CONTAINER_OF(node, struct model_load, node));
+  }
+  LIST_FOR_EACH_SAFE(node, tmp, &loader->running_list) {
+    list_del(node);
+    free_load(app, CONTAINER_OF(node, struct model_load, node));
+  }
+  pthread_cond_destroy(&loader->cond);
+  pthread_mutex_destroy(&loader->mutex);
+  MEM_FREE(app->allocator, loader);
+  app->model_loader = NULL;
+  return APP_NO_ERROR;
+}
+
+enum app_error
+app_submit_model_load
+  (struct app* app,
+   const char* path,
+   struct app_model* model,
+   app_model_load_callback_t func,
+   void* data)
+{
+  return submit_load(app, path, model, func, data, false);
+}
+
+enum app_error
+app_submit_model_reload
+  (struct app* app,
+   const char* path,
+   struct app_model* model)
+{
+  return submit_load(app, path, model, NULL, NULL, true);
+}
+
+enum app_error
+app_commit_model_loads(struct app* app, bool wait)
+{
+  struct model_load* load = NULL;
+
+  if(!app)
+    return APP_INVALID_ARGUMENT;
+  if(!app->model_loader)
+    return APP_NO_ERROR;
+
+  /* The load errors are reported to the load callbacks. */
+  PROF_BEGIN("app_commit_model_loads");
+  while(NULL != (load = pop_done_load(app->model_loader, wait))) {
+    commit_load(app, load);
+  }
+  PROF_END();
+  return APP_NO_ERROR;
+}
+
+enum app_error
+app_print_model_loads(struct app* app)
+{
+  static const char* state_name[] = {
+    [MODEL_LOAD_PENDING] = "pending",
+    [MODEL_LOAD_RUNNING] = "loading",
+    [MODEL_LOAD_DONE] = "loaded"
+  };
+  struct app_model_loader* loader = NULL;
+  struct list_node* list_array[2];
+  struct list_node* node = NULL;
+  size_t nb_loads = 0;
+  size_t i = 0;
+
+  if(!app)
+    return APP_INVALID_ARGUMENT;
+
+  loader = app->model_loader;
+  if(loader) {
+    list_array[0] = &loader->running_list;
+    list_array[1] = &loader->pending_list;
+    pthread_mutex_lock(&loader->mutex);
+    for(i = 0; i < sizeof(list_array)/sizeof(struct list_node*); ++i) {
+      LIST_FOR_EACH(node, list_array[i]) {
+        const struct model_load* load =
+          CONTAINER_OF(node, struct model_load, node);
+        const char* name = NULL;
+        APP(model_name(load->model, &name));
+        APP_PRINT_MSG
+          (app->logger, "%s %s `%s'\n", name, state_name[load->state],
+           load->path);
+        ++nb_loads;
+      }
+    }
+    pthread_mutex_unlock(&loader->mutex);
+  }
+  APP_PRINT_MSG(app->logger, "[total %zu model loads]\n", nb_loads);
+  return APP_NO_ERROR;
+}
+
+#undef MAX_LOADER_THREADS
+
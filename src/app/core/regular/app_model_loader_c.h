@@ -0,0 +1,53 @@
+#ifndef APP_MODEL_LOADER_C_H
+#define APP_MODEL_LOADER_C_H
+
+#include "app/core/app_error.h"
+#include "app/core/app_model.h"
+#include "sys/sys.h"
+#include <stdbool.h>
+
+struct app;
+struct app_model;
+
+LOCAL_SYM enum app_error
+app_init_model_loader
+  (struct app* app);
+
+/* Stop the loader threads. The pending loads are discarded without invoking
+ * their callback. */
+LOCAL_SYM enum app_error
+app_shutdown_model_loader
+  (struct app* app);
+
+/* Build the path resource on a loader thread. The model setup is deferred to
+ * the app_commit_model_loads function. */
+LOCAL_SYM enum app_error
+app_submit_model_load
+  (struct app* app,
+   const char* path,
+   struct app_model* model,
+   app_model_load_callback_t func, /* May be NULL. */
+   void* data);
+
+/* Rebuild the path resource of the model on a loader thread. Its meshes are
+ * updated in place by app_commit_model_loads and the model is left unchanged
+ * if the resource cannot be built. */
+LOCAL_SYM enum app_error
+app_submit_model_reload
+  (struct app* app,
+   const char* path,
+   struct app_model* model);
+
+/* Setup the models whose resource is built by the loader threads. If wait is
+ * true, wait for the completion of all the submitted loads. */
+LOCAL_SYM enum app_error
+app_commit_model_loads
+  (struct app* app,
+   bool wait);
+
+LOCAL_SYM enum app_error
+app_print_model_loads
+  (struct app* app);
+
+#endif /* APP_MODEL_LOADER_C_H */
+
@@ -0,0 +1,292 @@
+#include "app/core/regular/app_core_c.h"
+#include "app/core/regular/app_error_c.h"
+#include "app/core/regular/app_model_loader_c.h"
+#include "app/core/regular/app_model_watcher_c.h"
+#include "app/core/app_cvar.h"
+#include "app/core/app_model.h"
+#include "stdlib/sl.h"
+#include "stdlib/sl_vector.h"
+#include "sys/clock_time.h"
+#include "sys/mem_allocator.h"
+#include "sys/sys.h"
+#include <assert.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+/* Delay without event before a modified resource is reloaded. It prevents
+ * the reload of partially written files. */
+#define RELOAD_DELAY_NS 250000000
+
+struct watch {
+  int wd;
+  char dir[PATH_MAX]; /* Prefix of the watched paths, i.e. '/' terminated. */
+};
+
+struct change {
+  char path[PATH_MAX];
+  int64_t time; /* Time of the last event of the path, in nanoseconds. */
+};
+
+struct app_model_watcher {
+  struct sl_vector* watch_list;
+  struct sl_vector* change_list;
+  int fd; /* Inotify instance. Negative if the hot reload is disabled. */
+};
+
+/*******************************************************************************
+ *
+ * Helper functions.
+ *
+ ******************************************************************************/
+static enum app_error
+register_change
+  (struct app_model_watcher* watcher,
+   const char* dir,
+   const char* name,
+   int64_t time)
+{
+  struct change* change_list = NULL;
+  struct change change;
+  size_t nb_changes = 0;
+  size_t i = 0;
+  enum sl_error sl_err = SL_NO_ERROR;
+  assert(watcher && dir && name);
+
+  if(snprintf(change.path, PATH_MAX, "%s%s", dir, name) >= PATH_MAX)
+    return APP_OVERFLOW_ERROR;
+
+  /* Debounce the events of the path. */
+  SL(vector_buffer
+    (watcher->change_list, &nb_changes, NULL, NULL, (void**)&change_list));
+  for(i = 0; i < nb_changes; ++i) {
+    if(strcmp(change_list[i].path, change.path) == 0) {
+      change_list[i].time = time;
+      return APP_NO_ERROR;
+    }
+  }
+  change.time = time;
+  sl_err = sl_vector_push_back(watcher->change_list, &change);
+  return sl_to_app_error(sl_err);
+}
+
+static enum app_error
+read_events(struct app_model_watcher* watcher, int64_t time)
+{
+  ALIGN(ALIGNOF(struct inotify_event)) char buf[4096];
+  struct watch* watch_list = NULL;
+  size_t nb_watches = 0;
+  ssize_t len = 0;
+  size_t i = 0;
+  enum app_error app_err = APP_NO_ERROR;
+  assert(watcher && watcher->fd >= 0);
+
+  SL(vector_buffer
+    (watcher->watch_list, &nb_watches, NULL, NULL, (void**)&watch_list));
+  /* The inotify instance is non blocking. */
+  while((len = read(watcher->fd, buf, sizeof(buf))) > 0) {
+    const char* ptr = buf;
+    while(ptr < buf + len) {
+      const struct inotify_event* event = (const struct inotify_event*)ptr;
+      ptr += sizeof(struct inotify_event) + event->len;
+      if(!event->len)
+        continue;
+      /* Several watches share the same descriptor if their paths refer to
+       * the same directory. */
+      for(i = 0; i < nb_watches; ++i) {
+        if(watch_list[i].wd != event->wd)
+          continue;
+        app_err = register_change
+          (watcher, watch_list[i].dir, event->name, time);
+        if(app_err != APP_NO_ERROR)
+          return app_err;
+      }
+    }
+  }
+  return APP_NO_ERROR;
+}
+
+static enum app_error
+reload_models(struct app* app, const char* path)
+{
+  struct app_model_it it;
+  bool is_end_reached = false;
+  enum app_error app_err = APP_NO_ERROR;
+  assert(app && path);
+
+  APP(get_model_list_begin(app, &it, &is_end_reached));
+  while(!is_end_reached) {
+    const char* model_path = NULL;
+    APP(model_path(it.model, &model_path));
+    if(model_path && strcmp(model_path, path) == 0) {
+      app_err = app_submit_model_reload(app, path, it.model);
+      if(app_err != APP_NO_ERROR)
+        return app_err;
+    }
+    APP(model_it_next(&it, &is_end_reached));
+  }
+  return APP_NO_ERROR;
+}
+
+/*******************************************************************************
+ *
+ * Private model watcher functions.
+ *
+ ******************************************************************************/
+enum app_error
+app_init_model_watcher(struct app* app)
+{
+  struct app_model_watcher* watcher = NULL;
+  enum app_error app_err = APP_NO_ERROR;
+  enum sl_error sl_err = SL_NO_ERROR;
+
+  if(!app) {
+    app_err = APP_INVALID_ARGUMENT;
+    goto error;
+  }
+  watcher = MEM_CALLOC(app->allocator, 1, sizeof(struct app_model_watcher));
+  if(!watcher) {
+    app_err = APP_MEMORY_ERROR;
+    goto error;
+  }
+  watcher->fd = -1;
+  app->model_watcher = watcher;
+
+  #define CALL(func) \
+    do { \
+      if(SL_NO_ERROR != (sl_err = func)) { \
+        app_err = sl_to_app_error(sl_err); \
+        goto error; \
+      } \
+    } while(0)
+  CALL(sl_create_vector
+    (sizeof(struct watch),
+     ALIGNOF(struct watch),
+     app->allocator,
+     &watcher->watch_list));
+  CALL(sl_create_vector
+    (sizeof(struct change),
+     ALIGNOF(struct change),
+     app->allocator,
+     &watcher->change_list));
+  #undef CALL
+
+  watcher->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if(watcher->fd < 0)
+    APP_PRINT_WARN(app->logger, "hot reload of the models is disabled\n");
+
+exit:
+  return app_err;
+error:
+  if(app && app->model_watcher)
+    APP(shutdown_model_watcher(app));
+  goto exit;
+}
+
+enum app_error
+app_shutdown_model_watcher(struct app* app)
+{
+  struct app_model_watcher* watcher = NULL;
+
+  if(!app)
+    return APP_INVALID_ARGUMENT;
+  if(!app->model_watcher)
+    return APP_NO_ERROR;
+
+  watcher = app->model_watcher;
+  if(watcher->fd >= 0)
+    close(watcher->fd);
+  if(watcher->watch_list)
+    SL(free_vector(watcher->watch_list));
+  if(watcher->change_list)
+    SL(free_vector(watcher->change_list));
+  MEM_FREE(app->allocator, watcher);
+  app->model_watcher = NULL;
+  return APP_NO_ERROR;
+}
+
+enum app_error
+app_watch_model_path(struct app* app, const char* path)
+{
+  struct app_model_watcher* watcher = NULL;
+  struct watch* watch_list = NULL;
+  struct watch watch;
+  const char* slash = NULL;
+  size_t nb_watches = 0;
+  size_t len = 0;
+  size_t i = 0;
+  enum sl_error sl_err = SL_NO_ERROR;
+
+  if(!app || !path)
+    return APP_INVALID_ARGUMENT;
+  watcher = app->model_watcher;
+  if(!watcher || watcher->fd < 0)
+    return APP_NO_ERROR;
+
+  /* The events are reported per directory. The changed paths are thus built
+   * from the directory prefix of path as it is submitted. */
+  slash = strrchr(path, '/');
+  len = slash ? (size_t)(slash - path) + 1 : 0;
+  if(len >= PATH_MAX)
+    return APP_OVERFLOW_ERROR;
+  memcpy(watch.dir, path, len);
+  watch.dir[len] = '\0';
+
+  SL(vector_buffer
+    (watcher->watch_list, &nb_watches, NULL, NULL, (void**)&watch_list));
+  for(i = 0; i < nb_watches; ++i) {
+    if(strcmp(watch_list[i].dir, watch.dir) == 0)
+      return APP_NO_ERROR;
+  }
+  watch.wd = inotify_add_watch
+    (watcher->fd, len ? watch.dir : ".", IN_CLOSE_WRITE | IN_MOVED_TO);
+  if(watch.wd < 0)
+    return APP_IO_ERROR;
+  sl_err = sl_vector_push_back(watcher->watch_list, &watch);
+  return sl_to_app_error(sl_err);
+}
+
+enum app_error
+app_commit_model_watcher(struct app* app)
+{
+  struct app_model_watcher* watcher = NULL;
+  struct change* change_list = NULL;
+  size_t nb_changes = 0;
+  size_t i = 0;
+  int64_t time = 0;
+  enum app_error app_err = APP_NO_ERROR;
+
+  if(!app)
+    return APP_INVALID_ARGUMENT;
+  watcher = app->model_watcher;
+  if(!watcher
+  || watcher->fd < 0
+  || app->cvar_system.app_hot_reload->value.boolean == false)
+    return APP_NO_ERROR;
+
+  time = clock_ticks_to_nsec(clock_ticks());
+  app_err = read_events(watcher, time);
+  if(app_err != APP_NO_ERROR)
+    return app_err;
+
+  SL(vector_buffer
+    (watcher->change_list, &nb_changes, NULL, NULL, (void**)&change_list));
+  for(i = nb_changes; i-- > 0; ) {
+    if(time - change_list[i].time < RELOAD_DELAY_NS)
+      continue;
+    app_err = reload_models(app, change_list[i].path);
+    if(app_err != APP_NO_ERROR)
+      APP_PRINT_ERR
+        (app->logger, "cannot reload `%s'\n", change_list[i].path);
+    /* Remove the change; the order of the changes does not matter. */
+    change_list[i] = change_list[--nb_changes];
+    SL(vector_pop_back(watcher->change_list));
+  }
+  return APP_NO_ERROR;
+}
+
+#undef RELOAD_DELAY_NS
+
@@ -0,0 +1,32 @@
+#ifndef APP_MODEL_WATCHER_C_H
+#define APP_MODEL_WATCHER_C_H
+
+#include "app/core/app_error.h"
+#include "sys/sys.h"
+
+struct app;
+
+/* The hot reload is disabled, without error, if the file events cannot be
+ * watched. */
+LOCAL_SYM enum app_error
+app_init_model_watcher
+  (struct app* app);
+
+LOCAL_SYM enum app_error
+app_shutdown_model_watcher
+  (struct app* app);
+
+/* Watch the modifications of the path model resource. */
+LOCAL_SYM enum app_error
+app_watch_model_path
+  (struct app* app,
+   const char* path);
+
+/* Read the pending file events and submit the reload of the models whose
+ * resource is no more modified since the debounce delay. */
+LOCAL_SYM enum app_error
+app_commit_model_watcher
+  (struct app* app);
+
+#endif /* APP_MODEL_WATCHER_C_H */
+
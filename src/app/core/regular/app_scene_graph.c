@@ -0,0 +1,466 @@
+#include "app/core/regular/app_core_c.h"
+#include "app/core/regular/app_error_c.h"
+#include "app/core/regular/app_model_instance_c.h"
+#include "app/core/regular/app_scene_graph_c.h"
+#include "maths/simd/aosf44.h"
+#include "renderer/rdr.h"
+#include "renderer/rdr_model_instance.h"
+#include "stdlib/sl.h"
+#include "stdlib/sl_vector.h"
+#include "sys/list.h"
+#include "sys/math.h"
+#include "sys/mem_allocator.h"
+#include "sys/profiler.h"
+#include "sys/sys.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAX_GRAPH_THREADS 8
+#define TASK_SIZE 256 /* Number of instances updated by a worker at once. */
+
+/* The world transforms of a level only depend on the world transforms of the
+ * previous level. The instances of a level are thus updated in parallel by
+ * the worker threads and the calling thread. */
+struct app_scene_graph {
+  pthread_mutex_t mutex;
+  pthread_cond_t cond; /* Signaled on a new level or on exit. */
+  pthread_cond_t done_cond; /* Signaled when the level is updated. */
+  pthread_t thread_list[MAX_GRAPH_THREADS];
+  size_t nb_threads;
+  /* Level being updated. */
+  struct app_model_instance** level;
+  size_t level_len;
+  size_t next_id; /* Next instance to update. Incremented atomically. */
+  size_t nb_running_threads;
+  size_t level_stamp; /* Incremented for each level shared with the threads. */
+  bool exit;
+  /* Scratch data of the updates. */
+  struct sl_vector* visit_list; /* Breadth first list of app_model_instance*. */
+  struct sl_vector* update_list; /* app_model_instance* sorted by depth. */
+  struct sl_vector* level_offset_list; /* size_t. */
+  size_t update_stamp;
+};
+
+/*******************************************************************************
+ *
+ * Helper functions.
+ *
+ ******************************************************************************/
+static void
+update_instance(struct app_model_instance* instance)
+{
+  ALIGN(16) float mat[16];
+  struct rdr_model_instance** render_instance_list = NULL;
+  size_t nb_render_instances = 0;
+  size_t i = 0;
+  assert(instance);
+
+  if(instance->parent) {
+    aosf44_mulf44
+      (&instance->world_transform,
+       &instance->parent->world_transform,
+       &instance->transform);
+  } else {
+    instance->world_transform = instance->transform;
+  }
+  aosf44_store(mat, &instance->world_transform);
+  SL(vector_buffer
+    (instance->model_instance_list,
+     &nb_render_instances,
+     NULL, NULL,
+     (void**)&render_instance_list));
+  for(i = 0; i < nb_render_instances; ++i)
+    RDR(model_instance_transform(render_instance_list[i], mat));
+}
+
+static void
+update_tasks(struct app_scene_graph* graph)
+{
+  assert(graph);
+
+  while(true) {
+    const size_t begin = __sync_fetch_and_add(&graph->next_id, TASK_SIZE);
+    const size_t end = MIN(begin + TASK_SIZE, graph->level_len);
+    size_t i = 0;
+
+    if(begin >= graph->level_len)
+      break;
+    for(i = begin; i < end; ++i)
+      update_instance(graph->level[i]);
+  }
+}
+
+static void*
+graph_thread_main(void* arg)
+{
+  struct app_scene_graph* graph = arg;
+  size_t level_stamp = 0;
+  assert(arg);
+
+  prof_thread_name("scene graph");
+  pthread_mutex_lock(&graph->mutex);
+  while(true) {
+    while(!graph->exit && graph->level_stamp == level_stamp)
+      pthread_cond_wait(&graph->cond, &graph->mutex);
+    if(graph->exit)
+      break;
+    level_stamp = graph->level_stamp;
+    pthread_mutex_unlock(&graph->mutex);
+
+    update_tasks(graph);
+
+    pthread_mutex_lock(&graph->mutex);
+    if(--graph->nb_running_threads == 0)
+      pthread_cond_signal(&graph->done_cond);
+  }
+  pthread_mutex_unlock(&graph->mutex);
+  return NULL;
+}
+
+static void
+update_level
+  (struct app_scene_graph* graph,
+   struct app_model_instance* level[],
+   size_t level_len)
+{
+  size_t i = 0;
+  assert(graph && (!level_len || level));
+
+  /* Small levels are not worth the synchronisation of the threads. */
+  if(!graph->nb_threads || level_len < 2 * TASK_SIZE) {
+    for(i = 0; i < level_len; ++i)
+      update_instance(level[i]);
+    return;
+  }
+
+  pthread_mutex_lock(&graph->mutex);
+  graph->level = level;
+  graph->level_len = level_len;
+  graph->next_id = 0;
+  graph->nb_running_threads = graph->nb_threads;
+  ++graph->level_stamp;
+  pthread_cond_broadcast(&graph->cond);
+  pthread_mutex_unlock(&graph->mutex);
+
+  update_tasks(graph);
+
+  pthread_mutex_lock(&graph->mutex);
+  while(graph->nb_running_threads)
+    pthread_cond_wait(&graph->done_cond, &graph->mutex);
+  graph->level = NULL;
+  graph->level_len = 0;
+  pthread_mutex_unlock(&graph->mutex);
+}
+
+/* Gather the dirty instances and their descendants in breadth first order.
+ * The subtree of a visited instance is entirely visited; an instance is thus
+ * visited once even though several of its ancestors are dirty. */
+static enum sl_error
+visit_dirty_subtrees
+  (struct app_scene_graph* graph,
+   size_t nb_dirty_instances,
+   struct app_model_instance* dirty_instance_list[],
+   size_t* min_depth,
+   size_t* max_depth)
+{
+  struct app_model_instance** visit_list = NULL;
+  size_t len = 0;
+  size_t i = 0;
+  enum sl_error sl_err = SL_NO_ERROR;
+  assert(graph && dirty_instance_list && min_depth && max_depth);
+
+  ++graph->update_stamp;
+  *min_depth = SIZE_MAX;
+  *max_depth = 0;
+
+  #define VISIT(instance) \
+    do { \
+      (instance)->update_stamp = graph->update_stamp; \
+      sl_err = sl_vector_push_back(graph->visit_list, &(instance)); \
+      if(sl_err != SL_NO_ERROR) \
+        goto error; \
+    } while(0)
+
+  SL(clear_vector(graph->visit_list));
+  for(i = 0; i < nb_dirty_instances; ++i) {
+    if(dirty_instance_list[i]->update_stamp != graph->update_stamp)
+      VISIT(dirty_instance_list[i]);
+  }
+  SL(vector_length(graph->visit_list, &len));
+  for(i = 0; i < len; ++i) {
+    struct app_model_instance* instance = NULL;
+    struct list_node* node = NULL;
+
+    SL(vector_buffer
+      (graph->visit_list, NULL, NULL, NULL, (void**)&visit_list));
+    instance = visit_list[i];
+    *min_depth = MIN(*min_depth, instance->depth);
+    *max_depth = MAX(*max_depth, instance->depth);
+    LIST_FOR_EACH(node, &instance->child_list) {
+      struct app_model_instance* child = CONTAINER_OF
+        (node, struct app_model_instance, child_node);
+      if(child->update_stamp != graph->update_stamp)
+        VISIT(child);
+    }
+    SL(vector_length(graph->visit_list, &len));
+  }
+  #undef VISIT
+
+exit:
+  return sl_err;
+error:
+  goto exit;
+}
+
+/* Counting sort of the visited instances with respect to their depth. */
+static enum sl_error
+sort_by_depth
+  (struct app_scene_graph* graph,
+   size_t min_depth,
+   size_t max_depth)
+{
+  struct app_model_instance** visit_list = NULL;
+  struct app_model_instance** update_list = NULL;
+  size_t* level_offset_list = NULL;
+  size_t nb_levels = 0;
+  size_t len = 0;
+  size_t i = 0;
+  enum sl_error sl_err = SL_NO_ERROR;
+  assert(graph && min_depth <= max_depth);
+
+  nb_levels = max_depth - min_depth + 1;
+  SL(vector_buffer(graph->visit_list, &len, NULL, NULL, (void**)&visit_list));
+  sl_err = sl_vector_resize(graph->update_list, len, NULL);
+  if(sl_err != SL_NO_ERROR)
+    goto error;
+  sl_err = sl_vector_resize(graph->level_offset_list, nb_levels + 1, NULL);
+  if(sl_err != SL_NO_ERROR)
+    goto error;
+  SL(vector_buffer
+    (graph->update_list, NULL, NULL, NULL, (void**)&update_list));
+  SL(vector_buffer
+    (graph->level_offset_list, NULL, NULL, NULL, (void**)&level_offset_list));
+
+  memset(level_offset_list, 0, (nb_levels + 1) * sizeof(size_t));
+  for(i = 0; i < len; ++i)
+    ++level_offset_list[visit_list[i]->depth - min_depth + 1];
+  for(i = 1; i <= nb_levels; ++i)
+    level_offset_list[i] += level_offset_list[i - 1];
+  for(i = 0; i < len; ++i) {
+    const size_t level = visit_list[i]->depth - min_depth;
+    update_list[level_offset_list[level]++] = visit_list[i];
+  }
+  /* The offsets were shifted by the placement. Restore the level begins. */
+  memmove(level_offset_list + 1, level_offset_list, nb_levels*sizeof(size_t));
+  level_offset_list[0] = 0;
+
+exit:
+  return sl_err;
+error:
+  goto exit;
+}
+
+/*******************************************************************************
+ *
+ * Private scene graph functions.
+ *
+ ******************************************************************************/
+enum app_error
+app_init_scene_graph(struct app* app)
+{
+  struct app_scene_graph* graph = NULL;
+  long nb_cpus = 0;
+  size_t i = 0;
+  enum app_error app_err = APP_NO_ERROR;
+  enum sl_error sl_err = SL_NO_ERROR;
+  bool is_mutex_init = false;
+  bool is_cond_init = false;
+  bool is_done_cond_init = false;
+
+  if(!app) {
+    app_err = APP_INVALID_ARGUMENT;
+    goto error;
+  }
+  graph = MEM_CALLOC(app->allocator, 1, sizeof(struct app_scene_graph));
+  if(!graph) {
+    app_err = APP_MEMORY_ERROR;
+    goto error;
+  }
+  if(pthread_mutex_init(&graph->mutex, NULL) != 0) {
+    app_err = APP_INTERNAL_ERROR;
+    goto error;
+  }
+  is_mutex_init = true;
+  if(pthread_cond_init(&graph->cond, NULL) != 0) {
+    app_err = APP_INTERNAL_ERROR;
+    goto error;
+  }
+  is_cond_init = true;
+  if(pthread_cond_init(&graph->done_cond, NULL) != 0) {
+    app_err = APP_INTERNAL_ERROR;
+    goto error;
+  }
+  is_done_cond_init = true;
+  app->scene_graph = graph;
+
+  #define CALL(func) \
+    do { \
+      if((sl_err = func) != SL_NO_ERROR) { \
+        app_err = sl_to_app_error(sl_err); \
+        goto error; \
+      } \
+    } while(0)
+  CALL(sl_create_vector
+    (sizeof(struct app_model_instance*),
+     ALIGNOF(struct app_model_instance*),
+     app->allocator,
+     &graph->visit_list));
+  CALL(sl_create_vector
+    (sizeof(struct app_model_instance*),
+     ALIGNOF(struct app_model_instance*),
+     app->allocator,
+     &graph->update_list));
+  CALL(sl_create_vector
+    (sizeof(size_t), ALIGNOF(size_t), app->allocator,
+     &graph->level_offset_list));
+  #undef CALL
+
+  /* The calling thread updates the levels too. */
+  nb_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  graph->nb_threads = nb_cpus > 1 ? (size_t)nb_cpus - 1 : 0;
+  graph->nb_threads = MIN(graph->nb_threads, MAX_GRAPH_THREADS);
+  for(i = 0; i < graph->nb_threads; ++i) {
+    if(pthread_create
+       (graph->thread_list + i, NULL, graph_thread_main, graph) != 0) {
+      graph->nb_threads = i;
+      app_err = APP_INTERNAL_ERROR;
+      goto error;
+    }
+  }
+
+exit:
+  return app_err;
+error:
+  if(graph) {
+    if(app->scene_graph) {
+      APP(shutdown_scene_graph(app));
+    } else {
+      if(is_done_cond_init)
+        pthread_cond_destroy(&graph->done_cond);
+      if(is_cond_init)
+        pthread_cond_destroy(&graph->cond);
+      if(is_mutex_init)
+        pthread_mutex_destroy(&graph->mutex);
+      MEM_FREE(app->allocator, graph);
+    }
+  }
+  goto exit;
+}
+
+enum app_error
+app_shutdown_scene_graph(struct app* app)
+{
+  struct app_scene_graph* graph = NULL;
+  size_t i = 0;
+
+  if(!app)
+    return APP_INVALID_ARGUMENT;
+  if(!app->scene_graph)
+    return APP_NO_ERROR;
+
+  graph = app->scene_graph;
+  pthread_mutex_lock(&graph->mutex);
+  graph->exit = true;
+  pthread_cond_broadcast(&graph->cond);
+  pthread_mutex_unlock(&graph->mutex);
+  for(i = 0; i < graph->nb_threads; ++i)
+    pthread_join(graph->thread_list[i], NULL);
+
+  if(graph->visit_list)
+    SL(free_vector(graph->visit_list));
+  if(graph->update_list)
+    SL(free_vector(graph->update_list));
+  if(graph->level_offset_list)
+    SL(free_vector(graph->level_offset_list));
+  pthread_cond_destroy(&graph->done_cond);
+  pthread_cond_destroy(&graph->cond);
+  pthread_mutex_destroy(&graph->mutex);
+  MEM_FREE(app->allocator, graph);
+  app->scene_graph = NULL;
+  return APP_NO_ERROR;
+}
+
+enum app_error
+app_update_world_transforms
+  (struct app* app,
+   size_t nb_dirty_instances,
+   struct app_model_instance* dirty_instance_list[],
+   size_t* nb_updated_instances,
+   struct app_model_instance** updated_instance_list[])
+{
+  struct app_scene_graph* graph = NULL;
+  struct app_model_instance** update_list = NULL;
+  size_t* level_offset_list = NULL;
+  size_t min_depth = 0;
+  size_t max_depth = 0;
+  size_t len = 0;
+  size_t i = 0;
+  enum app_error app_err = APP_NO_ERROR;
+  enum sl_error sl_err = SL_NO_ERROR;
+
+  if(!app
+  || (nb_dirty_instances && !dirty_instance_list)
+  || !nb_updated_instances
+  || !updated_instance_list) {
+    app_err = APP_INVALID_ARGUMENT;
+    goto error;
+  }
+  graph = app->scene_graph;
+  SL(clear_vector(graph->update_list));
+  if(!nb_dirty_instances)
+    goto exit;
+
+  sl_err = visit_dirty_subtrees
+    (graph, nb_dirty_instances, dirty_instance_list, &min_depth, &max_depth);
+  if(sl_err != SL_NO_ERROR) {
+    app_err = sl_to_app_error(sl_err);
+    goto error;
+  }
+  sl_err = sort_by_depth(graph, min_depth, max_depth);
+  if(sl_err != SL_NO_ERROR) {
+    app_err = sl_to_app_error(sl_err);
+    goto error;
+  }
+
+  SL(vector_buffer
+    (graph->update_list, NULL, NULL, NULL, (void**)&update_list));
+  SL(vector_buffer
+    (graph->level_offset_list, &len, NULL, NULL, (void**)&level_offset_list));
+  for(i = 0; i + 1 < len; ++i) {
+    update_level
+      (graph,
+       update_list + level_offset_list[i],
+       level_offset_list[i + 1] - level_offset_list[i]);
+  }
+
+exit:
+  if(graph) {
+    SL(vector_buffer
+      (graph->update_list,
+       nb_updated_instances,
+       NULL, NULL,
+       (void**)updated_instance_list));
+  }
+  return app_err;
+error:
+  if(graph)
+    SL(clear_vector(graph->update_list));
+  goto exit;
+}
+
+#undef MAX_GRAPH_THREADS
+#undef TASK_SIZE
+
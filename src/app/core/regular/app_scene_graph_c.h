@@ -0,0 +1,32 @@
+#ifndef APP_SCENE_GRAPH_C_H
+#define APP_SCENE_GRAPH_C_H
+
+#include "app/core/app_error.h"
+#include "sys/sys.h"
+#include <stddef.h>
+
+struct app;
+struct app_model_instance;
+
+LOCAL_SYM enum app_error
+app_init_scene_graph
+  (struct app* app);
+
+LOCAL_SYM enum app_error
+app_shutdown_scene_graph
+  (struct app* app);
+
+/* Recompute the world transform of the dirty instances and of their
+ * descendants, level by level from the roots of the hierarchy, and set it to
+ * their render instances. The returned list of updated instances is valid
+ * until the next update. */
+LOCAL_SYM enum app_error
+app_update_world_transforms
+  (struct app* app,
+   size_t nb_dirty_instances,
+   struct app_model_instance* dirty_instance_list[],
+   size_t* nb_updated_instances,
+   struct app_model_instance** updated_instance_list[]);
+
+#endif /* APP_SCENE_GRAPH_C_H */
+
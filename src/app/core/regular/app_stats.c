@@ -0,0 +1,267 @@
+#include "app/core/regular/app_core_c.h"
+#include "app/core/regular/app_error_c.h"
+#include "app/core/regular/app_stats_c.h"
+#include "app/core/app.h"
+#include "app/core/app_core.h"
+#include "app/core/app_cvar.h"
+#include "renderer/rdr.h"
+#include "renderer/rdr_font.h"
+#include "renderer/rdr_frame.h"
+#include "renderer/rdr_term.h"
+#include "sys/clock_time.h"
+#include "sys/math.h"
+#include "sys/mem_allocator.h"
+#include "sys/sys.h"
+#include "window_manager/wm.h"
+#include "window_manager/wm_window.h"
+#include <assert.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define OVERLAY_WIDTH 480 /* In pixels. */
+#define OVERLAY_NB_LINES 6
+
+/*******************************************************************************
+ *
+ * Helper functions.
+ *
+ ******************************************************************************/
+static int
+cmp_float(const void* a, const void* b)
+{
+  const float f0 = *(const float*)a;
+  const float f1 = *(const float*)b;
+  return (f0 > f1) - (f0 < f1);
+}
+
+static void
+compute_time_stats
+  (const int64_t* ring, /* Times in nanoseconds. */
+   size_t nb_times,
+   struct app_time_stats* stats)
+{
+  float times[APP_STATS_NB_FRAMES];
+  size_t i = 0;
+  assert(ring && nb_times <= APP_STATS_NB_FRAMES && stats);
+
+  memset(stats, 0, sizeof(struct app_time_stats));
+  if(!nb_times)
+    return;
+  for(i = 0; i < nb_times; ++i)
+    times[i] = (float)ring[i] * 1.e-6f;
+  qsort(times, nb_times, sizeof(float), cmp_float);
+
+  /* Nearest rank percentiles. */
+  #define PERCENTILE(p) times[MAX((nb_times * (p) + 99) / 100, 1) - 1]
+  stats->median = PERCENTILE(50);
+  stats->p95 = PERCENTILE(95);
+  stats->p99 = PERCENTILE(99);
+  stats->max = times[nb_times - 1];
+  #undef PERCENTILE
+}
+
+static enum app_error
+create_overlay(struct app* app)
+{
+  struct rdr_font_metrics metrics;
+  enum rdr_error rdr_err = RDR_NO_ERROR;
+  size_t height = 0;
+  assert(app && !app->stats.overlay);
+
+  RDR(get_font_metrics(app->rdr.term_font, &metrics));
+  height = OVERLAY_NB_LINES * (metrics.line_space ? metrics.line_space : 16);
+  rdr_err = rdr_create_term
+    (app->rdr.system,
+     app->rdr.term_font,
+     OVERLAY_WIDTH,
+     height,
+     &app->stats.overlay);
+  app->stats.overlay_height = height;
+  return rdr_to_app_error(rdr_err);
+}
+
+/*******************************************************************************
+ *
+ * Statistics functions.
+ *
+ ******************************************************************************/
+enum app_error
+app_get_frame_stats(struct app* app, struct app_frame_stats* stats)
+{
+  size_t nb_times = 0;
+
+  if(!app || !stats)
+    return APP_INVALID_ARGUMENT;
+
+  *stats = app->stats.counters;
+  nb_times = MIN(app->stats.nb_frames, APP_STATS_NB_FRAMES);
+  compute_time_stats(app->stats.frame_time, nb_times, &stats->frame_time);
+  compute_time_stats(app->stats.cpu_time, nb_times, &stats->cpu_time);
+  stats->nb_timed_frames = nb_times;
+  return APP_NO_ERROR;
+}
+
+/*******************************************************************************
+ *
+ * Private functions.
+ *
+ ******************************************************************************/
+enum app_error
+app_shutdown_stats(struct app* app)
+{
+  if(!app)
+    return APP_INVALID_ARGUMENT;
+  if(app->stats.overlay)
+    RDR(term_ref_put(app->stats.overlay));
+  memset(&app->stats, 0, sizeof(app->stats));
+  return APP_NO_ERROR;
+}
+
+enum app_error
+app_record_frame_stats(struct app* app, int64_t swap_begin)
+{
+  struct rdr_frame_stats rdr_stats;
+  struct app_frame_stats* counters = NULL;
+  int64_t frame_end = 0;
+  size_t allocated_size = 0;
+
+  if(!app)
+    return APP_INVALID_ARGUMENT;
+
+  frame_end = clock_ticks_to_nsec(clock_ticks());
+  if(app->stats.last_frame_end) {
+    const size_t id = app->stats.nb_frames % APP_STATS_NB_FRAMES;
+    const int64_t frame_time = frame_end - app->stats.last_frame_end;
+    const int64_t swap_time = frame_end - clock_ticks_to_nsec(swap_begin);
+    app->stats.frame_time[id] = frame_time;
+    app->stats.cpu_time[id] = MAX(frame_time - swap_time, 0);
+    ++app->stats.nb_frames;
+  }
+  app->stats.last_frame_end = frame_end;
+
+  RDR(get_frame_stats(app->rdr.frame, &rdr_stats));
+  counters = &app->stats.counters;
+  counters->nb_draw_calls = rdr_stats.nb_draw_calls;
+  counters->nb_state_changes = rdr_stats.nb_state_changes;
+  counters->uploaded_size = rdr_stats.uploaded_size;
+  counters->nb_instances = rdr_stats.nb_instances;
+  counters->nb_culled_instances = rdr_stats.nb_culled_instances;
+  counters->nb_triangles = rdr_stats.nb_triangles;
+  allocated_size = MEM_ALLOCATED_SIZE(app->allocator);
+  counters->allocated_size_delta =
+    (int64_t)allocated_size - (int64_t)counters->allocated_size;
+  counters->allocated_size = allocated_size;
+  return APP_NO_ERROR;
+}
+
+enum app_error
+app_draw_stats(struct app* app)
+{
+  char buf[128];
+  struct app_frame_stats stats;
+  struct wm_window_desc win_desc;
+  enum app_error app_err = APP_NO_ERROR;
+  enum rdr_error rdr_err = RDR_NO_ERROR;
+
+  if(!app) {
+    app_err = APP_INVALID_ARGUMENT;
+    goto error;
+  }
+  if(app->cvar_system.app_show_stats->value.boolean == false)
+    goto exit;
+
+  if(!app->stats.overlay) {
+    app_err = create_overlay(app);
+    if(app_err != APP_NO_ERROR)
+      goto error;
+  }
+  /* Draw the overlay in the top right corner of the window. The text of the
+   * main terminal grows from the bottom left one. */
+  WM(get_window_desc(app->wm.window, &win_desc));
+  RDR(term_position
+    (app->stats.overlay,
+     win_desc.width > OVERLAY_WIDTH ? win_desc.width - OVERLAY_WIDTH : 0,
+     win_desc.height > app->stats.overlay_height
+      ? win_desc.height - app->stats.overlay_height : 0));
+
+  APP(get_frame_stats(app, &stats));
+  RDR(clear_term(app->stats.overlay, RDR_TERM_STDOUT));
+
+  #define PRINT(color, ...) \
+    do { \
+      snprintf(buf, sizeof(buf), __VA_ARGS__); \
+      RDR(term_print_string \
+        (app->stats.overlay, RDR_TERM_STDOUT, buf, color)); \
+    } while(0)
+  PRINT(RDR_TERM_COLOR_BRIGHT_WHITE,
+    "frame %6.2f ms  p95 %6.2f  p99 %6.2f\n",
+    stats.frame_time.median, stats.frame_time.p95, stats.frame_time.p99);
+  PRINT(RDR_TERM_COLOR_BRIGHT_WHITE,
+    "cpu   %6.2f ms  p95 %6.2f  p99 %6.2f\n",
+    stats.cpu_time.median, stats.cpu_time.p95, stats.cpu_time.p99);
+  PRINT(RDR_TERM_COLOR_WHITE,
+    "draws %zu  states %zu  upload %zu KB\n",
+    stats.nb_draw_calls, stats.nb_state_changes, stats.uploaded_size / 1024);
+  PRINT(RDR_TERM_COLOR_WHITE,
+    "instances %zu  culled %zu  triangles %zu\n",
+    stats.nb_instances, stats.nb_culled_instances, stats.nb_triangles);
+  PRINT(RDR_TERM_COLOR_WHITE,
+    "memory %zu KB (%+" PRIi64 " B)",
+    stats.allocated_size / 1024, stats.allocated_size_delta);
+  #undef PRINT
+
+  rdr_err = rdr_frame_draw_term(app->rdr.frame, app->stats.overlay);
+  if(rdr_err != RDR_NO_ERROR) {
+    app_err = rdr_to_app_error(rdr_err);
+    goto error;
+  }
+
+exit:
+  return app_err;
+error:
+  goto exit;
+}
+
+enum app_error
+app_print_stats(struct app* app)
+{
+  struct app_frame_stats stats;
+
+  if(!app)
+    return APP_INVALID_ARGUMENT;
+
+  APP(get_frame_stats(app, &stats));
+  APP_PRINT_MSG(app->logger,
+    "frame time (ms) median %.2f p95 %.2f p99 %.2f max %.2f\n",
+    stats.frame_time.median,
+    stats.frame_time.p95,
+    stats.frame_time.p99,
+    stats.frame_time.max);
+  APP_PRINT_MSG(app->logger,
+    "cpu time (ms)   median %.2f p95 %.2f p99 %.2f max %.2f\n",
+    stats.cpu_time.median,
+    stats.cpu_time.p95,
+    stats.cpu_time.p99,
+    stats.cpu_time.max);
+  APP_PRINT_MSG(app->logger,
+    "[over the last %zu frames]\n", stats.nb_timed_frames);
+  APP_PRINT_MSG(app->logger,
+    "draw calls %zu\nstate changes %zu\nuploaded %zu bytes\n",
+    stats.nb_draw_calls,
+    stats.nb_state_changes,
+    stats.uploaded_size);
+  APP_PRINT_MSG(app->logger,
+    "instances %zu\nculled instances %zu\n",
+    stats.nb_instances,
+    stats.nb_culled_instances);
+  APP_PRINT_MSG(app->logger,
+    "allocated %zu bytes (%+" PRIi64 " since the previous frame)\n",
+    stats.allocated_size,
+    stats.allocated_size_delta);
+  return APP_NO_ERROR;
+}
+
+#undef OVERLAY_WIDTH
+#undef OVERLAY_NB_LINES
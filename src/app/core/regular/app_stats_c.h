@@ -0,0 +1,31 @@
+#ifndef APP_STATS_C_H
+#define APP_STATS_C_H
+
+#include "app/core/app_error.h"
+#include "sys/sys.h"
+#include <stdint.h>
+
+struct app;
+
+LOCAL_SYM enum app_error
+app_shutdown_stats
+  (struct app* app);
+
+/* Record the statistics of the frame that ends. Must be invoked right after
+ * the buffer swap that began at the swap_begin clock ticks. */
+LOCAL_SYM enum app_error
+app_record_frame_stats
+  (struct app* app,
+   int64_t swap_begin);
+
+/* Draw the statistics overlay if the app_show_stats cvar is set. */
+LOCAL_SYM enum app_error
+app_draw_stats
+  (struct app* app);
+
+LOCAL_SYM enum app_error
+app_print_stats
+  (struct app* app);
+
+#endif /* APP_STATS_C_H */
+
@@ -11,9 +11,9 @@
 #include "renderer/rdr.h"
 #include "renderer/rdr_error.h"
 #include "renderer/rdr_frame.h"
+#include "renderer/rdr_system.h"
 #include "renderer/rdr_world.h"
 #include "stdlib/sl.h"
-#include "stdlib/sl_hash_table.h"
 #include "stdlib/sl_vector.h"
 #include "sys/mem_allocator.h"
 #include "sys/ref_count.h"
@@ -25,11 +25,12 @@
 struct app_world {
   struct ref ref;
   struct list_node instance_list; /* Linked list of app_model_instance. */
-  struct sl_hash_table* picking_htbl;
+  /* Dense list of app_model_instance* indexed by their pick id. The ids of
+   * the removed instances are NULL and stacked into the free list. */
+  struct sl_vector* pick_list;
+  struct sl_vector* free_pick_id_list; /* List of uint32_t. */
   struct app* app;
   struct rdr_world* render_world;
-  bool is_picking_setuped;
-  uint32_t max_pick_id;
 };
 
 /*******************************************************************************
@@ -37,59 +38,64 @@ struct app_world {
  * Helper functions.
  *
  ******************************************************************************/
-static size_t
-hash_pick_id(const void* ptr)
+static enum app_error
+acquire_pick_id(struct app_world* world, struct app_model_instance* instance)
 {
-  return sl_hash(ptr, sizeof(uint32_t));
+  struct app_model_instance** pick_list = NULL;
+  uint32_t* free_pick_id_list = NULL;
+  size_t nb_free_pick_ids = 0;
+  size_t len = 0;
+  uint32_t pick_id = 0;
+  enum sl_error sl_err = SL_NO_ERROR;
+  assert(world && instance);
+
+  SL(vector_buffer
+    (world->free_pick_id_list,
+     &nb_free_pick_ids, NULL, NULL, (void**)&free_pick_id_list));
+  if(nb_free_pick_ids) {
+    pick_id = free_pick_id_list[nb_free_pick_ids - 1];
+    SL(vector_pop_back(world->free_pick_id_list));
+  } else {
+    SL(vector_length(world->pick_list, &len));
+    if(len > APP_PICK_ID_MAX)
+      return APP_OVERFLOW_ERROR;
+    /* Ensure that the release of the pick id cannot fail. */
+    sl_err = sl_vector_reserve(world->free_pick_id_list, len + 1);
+    if(sl_err != SL_NO_ERROR)
+      return sl_to_app_error(sl_err);
+    sl_err = sl_vector_push_back(world->pick_list, &instance);
+    if(sl_err != SL_NO_ERROR)
+      return sl_to_app_error(sl_err);
+    pick_id = (uint32_t)len;
+  }
+  SL(vector_buffer(world->pick_list, NULL, NULL, NULL, (void**)&pick_list));
+  pick_list[pick_id] = instance;
+  instance->pick_id = pick_id;
+  APP(set_model_instance_pick_id
+    (instance, APP_PICK(pick_id, APP_PICK_GROUP_WORLD)));
+  return APP_NO_ERROR;
 }
 
-static bool
-eq_pick_id(const void* ptr0, const void* ptr1)
+static void
+release_pick_id(struct app_world* world, struct app_model_instance* instance)
 {
-  const uint32_t id0 = *(uint32_t*)ptr0;
-  const uint32_t id1 = *(uint32_t*)ptr1;
-  return id0 == id1;
+  struct app_model_instance** pick_list = NULL;
+  size_t len = 0;
+  assert(world && instance);
+
+  SL(vector_buffer(world->pick_list, &len, NULL, NULL, (void**)&pick_list));
+  assert(instance->pick_id < len && pick_list[instance->pick_id] == instance);
+  pick_list[instance->pick_id] = NULL;
+  SL(vector_push_back(world->free_pick_id_list, &instance->pick_id));
 }
 
-static enum app_error
-setup_picking(struct app_world* world)
+static uint32_t
+max_pick_id(struct app_world* world)
 {
-  enum app_error app_err = APP_NO_ERROR;
-
-  if(world->is_picking_setuped == false) {
-    struct list_node* node = NULL;
-    uint32_t pick_id = 0;
-    enum sl_error sl_err = SL_NO_ERROR;
-
-    /* Setup the pick id of the instances. */
-    LIST_FOR_EACH(node, &world->instance_list) {
-      struct app_model_instance* instance =
-        CONTAINER_OF(node, struct app_model_instance, world_node);
-
-      if(pick_id > APP_PICK_ID_MAX) {
-        app_err = APP_OVERFLOW_ERROR;
-        goto error;
-      }
-      pick_id = APP_PICK(pick_id, APP_PICK_GROUP_WORLD);
-      APP(set_model_instance_pick_id(instance, pick_id));
-
-      sl_err = sl_hash_table_insert(world->picking_htbl, &pick_id, &instance);
-      if(sl_err != SL_NO_ERROR) {
-        app_err = sl_to_app_error(sl_err);
-        goto error;
-      }
-      ++pick_id;
-    }
-    world->is_picking_setuped = true;
-    world->max_pick_id = pick_id - 1;
-  }
-exit:
-  return app_err;
-error:
-  SL(hash_table_clear(world->picking_htbl));
-  world->is_picking_setuped = false;
-  world->max_pick_id = 0;
-  goto exit;
+  size_t len = 0;
+  assert(world);
+  SL(vector_length(world->pick_list, &len));
+  return len ? (uint32_t)(len - 1) : 0;
 }
 
 static void
@@ -109,8 +115,10 @@ release_world(struct ref* ref)
   }
   if(world->render_world)
     RDR(world_ref_put(world->render_world));
-  if(world->picking_htbl)
-    SL(free_hash_table(world->picking_htbl));
+  if(world->pick_list)
+    SL(free_vector(world->pick_list));
+  if(world->free_pick_id_list)
+    SL(free_vector(world->free_pick_id_list));
   MEM_FREE(world->app->allocator, world);
 }
 
@@ -146,15 +154,20 @@ app_create_world(struct app* app, struct app_world** out_world)
     err = rdr_to_app_error(rdr_err);
     goto error;
   }
-  sl_err = sl_create_hash_table
+  sl_err = sl_create_vector
+    (sizeof(struct app_model_instance*),
+     ALIGNOF(struct app_model_instance*),
+     app->allocator,
+     &world->pick_list);
+  if(sl_err != SL_NO_ERROR) {
+    err = sl_to_app_error(sl_err);
+    goto error;
+  }
+  sl_err = sl_create_vector
     (sizeof(uint32_t),
      ALIGNOF(uint32_t),
-     sizeof(void*),
-     ALIGNOF(void*),
-     hash_pick_id,
-     eq_pick_id,
      app->allocator,
-     &world->picking_htbl);
+     &world->free_pick_id_list);
   if(sl_err != SL_NO_ERROR) {
     err = sl_to_app_error(sl_err);
     goto error;
@@ -196,12 +209,12 @@ app_world_add_model_instances
    size_t nb_model_instances,
    struct app_model_instance* instance_list[])
 {
+  struct rdr_model_instance** rdr_instance_list = NULL;
   struct rdr_model_instance** buffer = NULL;
-  size_t nb_added_rdr_instances = 0;
+  size_t nb_rdr_instances = 0;
   size_t nb_added_app_instances = 0;
   size_t len = 0;
   size_t i = 0;
-  size_t j = 0;
   enum app_error app_err = APP_NO_ERROR;
   enum rdr_error rdr_err = RDR_NO_ERROR;
 
@@ -209,47 +222,59 @@ app_world_add_model_instances
     app_err = APP_INVALID_ARGUMENT;
     goto error;
   }
-
-  world->is_picking_setuped = false; /* Reset picking */
-
+  /* Attach the instances to the world and give them a pick id. */
   for(i = 0; i < nb_model_instances; ++i) {
-    /* Link the instance against the world linked list. */
-    if(instance_list[i]->world != NULL) {
+    if(!instance_list[i] || instance_list[i]->world != NULL) {
       app_err = APP_INVALID_ARGUMENT;
       goto error;
     }
+    app_err = acquire_pick_id(world, instance_list[i]);
+    if(app_err != APP_NO_ERROR)
+      goto error;
     instance_list[i]->world = world;
-    list_add(&world->instance_list, &instance_list[i]->world_node);
     ++nb_added_app_instances;
-    /* Add the render data of the instance into the render world. */
     SL(vector_buffer
-       (instance_list[i]->model_instance_list,
-        &len, NULL, NULL, (void**)&buffer));
-    for(j = 0; j < len; ++j) {
-      rdr_err = rdr_add_model_instance(world->render_world, buffer[j]);
-      if(rdr_err != RDR_NO_ERROR) {
-        app_err = rdr_to_app_error(rdr_err);
-        goto error;
-      }
-      ++nb_added_rdr_instances;
+       (instance_list[i]->model_instance_list, &len, NULL, NULL, NULL));
+    nb_rdr_instances += len;
+  }
+
+  /* Gather the render data of the instances in order to add them into the
+   * render world at once. */
+  if(nb_rdr_instances) {
+    rdr_instance_list = MEM_ALLOC
+      (world->app->allocator,
+       nb_rdr_instances * sizeof(struct rdr_model_instance*));
+    if(!rdr_instance_list) {
+      app_err = APP_MEMORY_ERROR;
+      goto error;
+    }
+    nb_rdr_instances = 0;
+    for(i = 0; i < nb_model_instances; ++i) {
+      SL(vector_buffer
+         (instance_list[i]->model_instance_list,
+          &len, NULL, NULL, (void**)&buffer));
+      memcpy(rdr_instance_list + nb_rdr_instances, buffer,
+             len * sizeof(struct rdr_model_instance*));
+      nb_rdr_instances += len;
+    }
+    rdr_err = rdr_add_model_instances
+      (world->render_world, nb_rdr_instances, rdr_instance_list);
+    if(rdr_err != RDR_NO_ERROR) {
+      app_err = rdr_to_app_error(rdr_err);
+      goto error;
     }
   }
+  /* Link the instances against the world linked list. */
+  for(i = 0; i < nb_model_instances; ++i)
+    list_add(&world->instance_list, &instance_list[i]->world_node);
 
 exit:
+  if(rdr_instance_list)
+    MEM_FREE(world->app->allocator, rdr_instance_list);
   return app_err;
-
 error:
-  for(i = 0; i < nb_model_instances && nb_added_rdr_instances; ++i) {
-    SL(vector_buffer
-       (instance_list[i]->model_instance_list,
-        &len, NULL, NULL, (void**)&buffer));
-    for(j = 0; j < len && nb_added_rdr_instances; ++j) {
-      RDR(remove_model_instance(world->render_world, buffer[i]));
-      --nb_added_rdr_instances;
-    }
-  }
   for(i = 0; i < nb_added_app_instances; ++i) {
-    list_del(&instance_list[i]->world_node);
+    release_pick_id(world, instance_list[i]);
     instance_list[i]->world = NULL;
   }
   goto exit;
@@ -276,13 +301,12 @@ app_world_remove_model_instances
     goto error;
   }
 
-  world->is_picking_setuped = false; /* reset picking */
-
   for(i = 0; i < nb_model_instances; ++i) {
     if(instance_list[i]->world != world) {
       app_err = APP_INVALID_ARGUMENT;
       goto error;
     }
+    release_pick_id(world, instance_list[i]);
     instance_list[i]->world = NULL;
     list_del(&instance_list[i]->world_node);
     ++nb_removed_app_instances;
@@ -318,6 +342,9 @@ error:
     }
   }
   for(i = 0; i < nb_removed_app_instances; ++i) {
+    /* The released pick ids are reused and thus cannot be exhausted. */
+    UNUSED const enum app_error err = acquire_pick_id(world, instance_list[i]);
+    assert(err == APP_NO_ERROR);
     instance_list[i]->world = world;
     list_add(&world->instance_list, &instance_list[i]->world_node);
   }
@@ -341,11 +368,6 @@ app_world_pick
     goto error;
   }
 
-  /* Setup the pick id of the instances. */
-  app_err = setup_picking(world);
-  if(app_err != APP_NO_ERROR)
-    goto error;
-
   APP(to_rdr_view(world->app, view, &render_view));
   rdr_err = rdr_frame_pick_model_instance
     (world->app->rdr.frame,
@@ -370,23 +392,20 @@ app_world_picked_model_instance
    const uint32_t pick_id,
    struct app_model_instance** out_instance)
 {
-  struct app_model_instance** instance = NULL;
+  struct app_model_instance** pick_list = NULL;
+  size_t len = 0;
   enum app_error app_err = APP_NO_ERROR;
 
-  if(UNLIKELY
-  (  !world
-  || !out_instance
-  || !world->is_picking_setuped
-  || world->max_pick_id < pick_id)) {
+  if(UNLIKELY(!world || !out_instance)) {
     app_err = APP_INVALID_ARGUMENT;
     goto error;
   }
-
-  /* Look for the instance corresponding to the pick_id */
-  SL(hash_table_find
-    (world->picking_htbl, (void*)&pick_id, (void**)&instance));
-  assert(instance != NULL);
-  *out_instance = *instance;
+  SL(vector_buffer(world->pick_list, &len, NULL, NULL, (void**)&pick_list));
+  if(UNLIKELY(pick_id >= len || pick_list[pick_id] == NULL)) {
+    app_err = APP_INVALID_ARGUMENT;
+    goto error;
+  }
+  *out_instance = pick_list[pick_id];
 
 exit:
   return app_err;
@@ -412,6 +431,15 @@ app_draw_world(struct app_world* world, const struct app_view* view)
   }
 
   APP(to_rdr_view(world->app, view, &render_view));
+  RDR(system_lod_threshold
+    (world->app->rdr.system,
+     world->app->cvar_system.rdr_lod_threshold->value.real));
+  RDR(world_occlusion_culling
+    (world->render_world,
+     world->app->cvar_system.rdr_occlusion_culling->value.boolean));
+  RDR(system_procedural_grid
+    (world->app->rdr.system,
+     world->app->cvar_system.rdr_procedural_grid->value.boolean));
 
   if(world->app->cvar_system.rdr_show_picking->value.boolean == false) {
     rdr_err = rdr_frame_draw_world
@@ -421,12 +449,11 @@ app_draw_world(struct app_world* world, const struct app_view* view)
       goto error;
     }
   } else {
-    setup_picking(world);
     rdr_err = rdr_frame_show_pick_buffer
       (world->app->rdr.frame,
        world->render_world,
        &render_view,
-       world->max_pick_id);
+       max_pick_id(world));
     if(rdr_err != RDR_NO_ERROR) {
       app_err = rdr_to_app_error(rdr_err);
       goto error;
@@ -47,6 +47,12 @@ EDIT_API enum edit_error
 edit_clear_model_instance_selection
   (struct edit_model_instance_selection* selection);
 
+/* The pivot is the mean of the AABB centers of the selected instances. The
+ * bounds of the selection are cached. The selection translation moves them
+ * as is while the other transformations, and the transforms of the selected
+ * instances committed by other paths, make them recomputed on demand. A
+ * selected instance transformed by another path in the same frame as a
+ * selection translation is not detected. */
 EDIT_API enum edit_error
 edit_get_model_instance_selection_pivot
   (struct edit_model_instance_selection* selection,
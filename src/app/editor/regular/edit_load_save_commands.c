@@ -8,16 +8,67 @@
 #include "app/core/app_cvar.h"
 #include "app/core/app_model.h"
 #include "app/core/app_model_instance.h"
+#include "app/core/app_world.h"
 #include "maths/simd/aosf44.h"
+#include "sys/mem_allocator.h"
+#include "sys/sys.h"
+#include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
+/*******************************************************************************
+ *
+ * Binary map format. The file is made of the header, the model table, the
+ * instance table and the string pool, in the host byte order. The strings are
+ * referenced by their offset into the pool and are null terminated.
+ *
+ ******************************************************************************/
+#define MAP_MAGIC "FMAP"
+#define MAP_VERSION 2
+
+/* Flags of the map models. */
+#define MAP_MODEL_OCCLUDER BIT(0)
+
+struct map_header {
+  char magic[4];
+  uint32_t version;
+  uint32_t nb_models;
+  uint32_t nb_instances;
+  uint32_t pool_size; /* In bytes. */
+};
+
+struct map_model {
+  uint32_t path;
+  uint32_t name;
+  uint32_t flags;
+};
+
+struct map_instance {
+  uint32_t name;
+  uint32_t model; /* Index into the model table. */
+  float transform[16]; /* World transform in column major order. */
+};
+
+struct model_id {
+  const struct app_model* model;
+  uint32_t id;
+};
+
 /*******************************************************************************
  *
  * Helper functions.
  *
  ******************************************************************************/
+static int
+cmp_model_id(const void* a, const void* b)
+{
+  const uintptr_t mdl0 = (uintptr_t)((const struct model_id*)a)->model;
+  const uintptr_t mdl1 = (uintptr_t)((const struct model_id*)b)->model;
+  return (mdl0 > mdl1) - (mdl0 < mdl1);
+}
+
 static void
-save_map(struct app* app, const char* cmd_name, const char* output_file)
+save_text_map(struct app* app, const char* cmd_name, const char* output_file)
 {
   FILE* file = NULL;
   struct app_model_it model_it;
@@ -27,6 +78,9 @@ save_map(struct app* app, const char* cmd_name, const char* output_file)
   memset(&model_it, 0, sizeof(model_it));
   memset(&instance_it, 0, sizeof(instance_it));
 
+  /* Wait for the resource path of the models. */
+  APP(flush_model_loads(app));
+
   file = fopen(output_file, "w");
   if(file == NULL) {
     APP(log(app, APP_LOG_ERROR,
@@ -48,9 +102,13 @@ save_map(struct app* app, const char* cmd_name, const char* output_file)
   while(is_end_reached == false) {
     const char* path = NULL;
     const char* name = NULL;
+    bool is_occluder = false;
     APP(model_path(model_it.model, &path));
     APP(model_name(model_it.model, &name));
+    APP(is_model_occluder(model_it.model, &is_occluder));
     FPRINTF(file, "load -m %s -n %s\n", path, name);
+    if(is_occluder)
+      FPRINTF(file, "occluder -m %s\n", name);
     APP(model_it_next(&model_it, &is_end_reached));
   }
 
@@ -60,7 +118,7 @@ save_map(struct app* app, const char* cmd_name, const char* output_file)
     struct app_model* model = NULL;
     const char* mdl_name = NULL;
     const char* inst_name = NULL;
-    const struct aosf44* transform = NULL;
+    ALIGN(16) struct aosf44 transform;
     ALIGN(16) float tmp[16];
 
     APP(model_instance_get_model(instance_it.instance, &model));
@@ -68,8 +126,9 @@ save_map(struct app* app, const char* cmd_name, const char* output_file)
     APP(model_name(model, &mdl_name));
     FPRINTF(file, "spawn -m %s -n %s\n", mdl_name, inst_name);
 
-    APP(get_raw_model_instance_transform(instance_it.instance, &transform));
-    aosf44_store(tmp, transform);
+    /* The hierarchy is not saved; the instances keep their world position. */
+    APP(get_model_instance_world_transform(instance_it.instance, &transform));
+    aosf44_store(tmp, &transform);
     FPRINTF
       (file,
        "transform -i %s "
@@ -100,11 +159,204 @@ error:
   goto exit;
 }
 
+static void
+save_binary_map
+  (struct edit_context* ctxt,
+   const char* cmd_name,
+   const char* output_file)
+{
+  struct map_header header;
+  struct app_model_it model_it;
+  struct app_model_instance_it instance_it;
+  struct model_id* model_ids = NULL;
+  struct app* app = NULL;
+  FILE* file = NULL;
+  size_t nb_models = 0;
+  size_t nb_instances = 0;
+  size_t pool_size = 0;
+  size_t i = 0;
+  bool is_end_reached = false;
+  assert(ctxt && cmd_name && output_file);
+  memset(&model_it, 0, sizeof(model_it));
+  memset(&instance_it, 0, sizeof(instance_it));
+
+  app = ctxt->app;
+
+  /* Wait for the resource path of the models. */
+  APP(flush_model_loads(app));
+
+  /* Count the models, the instances and the size of their strings. */
+  APP(get_model_list_begin(app, &model_it, &is_end_reached));
+  while(is_end_reached == false) {
+    const char* path = NULL;
+    const char* name = NULL;
+    APP(model_path(model_it.model, &path));
+    APP(model_name(model_it.model, &name));
+    pool_size += strlen(path ? path : "") + strlen(name) + 2;
+    ++nb_models;
+    APP(model_it_next(&model_it, &is_end_reached));
+  }
+  APP(get_model_instance_list_begin(app, &instance_it, &is_end_reached));
+  while(is_end_reached == false) {
+    const char* name = NULL;
+    APP(model_instance_name(instance_it.instance, &name));
+    pool_size += strlen(name) + 1;
+    ++nb_instances;
+    APP(model_instance_it_next(&instance_it, &is_end_reached));
+  }
+  if(nb_models > UINT32_MAX
+  || nb_instances > UINT32_MAX
+  || pool_size > UINT32_MAX) {
+    APP(log(app, APP_LOG_ERROR, "%s: the map is too big\n", cmd_name));
+    goto error;
+  }
+
+  /* Sorted list of the models used to retrieve the index of the model of an
+   * instance. */
+  if(nb_models) {
+    model_ids = MEM_CALLOC(ctxt->allocator, nb_models, sizeof(struct model_id));
+    if(!model_ids) {
+      APP(log(app, APP_LOG_ERROR, "%s: insufficient memory\n", cmd_name));
+      goto error;
+    }
+  }
+  APP(get_model_list_begin(app, &model_it, &is_end_reached));
+  for(i = 0; is_end_reached == false; ++i) {
+    model_ids[i].model = model_it.model;
+    model_ids[i].id = (uint32_t)i;
+    APP(model_it_next(&model_it, &is_end_reached));
+  }
+  qsort(model_ids, nb_models, sizeof(struct model_id), cmp_model_id);
+
+  file = fopen(output_file, "wb");
+  if(file == NULL) {
+    APP(log(app, APP_LOG_ERROR,
+      "%s: error opening output file `%s'\n", cmd_name, output_file));
+    goto error;
+  }
+
+  #define FWRITE(file, data, size) \
+    do { \
+      if(fwrite((data), (size), 1, (file)) != 1) { \
+        APP(log(app, APP_LOG_ERROR, \
+          "%s: error writing file `%s'\n", cmd_name, output_file)); \
+        goto error; \
+      } \
+    } while(0)
+
+  memcpy(header.magic, MAP_MAGIC, sizeof(header.magic));
+  header.version = MAP_VERSION;
+  header.nb_models = (uint32_t)nb_models;
+  header.nb_instances = (uint32_t)nb_instances;
+  header.pool_size = (uint32_t)pool_size;
+  FWRITE(file, &header, sizeof(header));
+
+  /* Save the model and the instance tables. The strings are written in the
+   * pool in the order of their reference. */
+  pool_size = 0;
+  APP(get_model_list_begin(app, &model_it, &is_end_reached));
+  while(is_end_reached == false) {
+    struct map_model model;
+    const char* path = NULL;
+    const char* name = NULL;
+    bool is_occluder = false;
+    APP(model_path(model_it.model, &path));
+    APP(model_name(model_it.model, &name));
+    APP(is_model_occluder(model_it.model, &is_occluder));
+    model.flags = is_occluder ? MAP_MODEL_OCCLUDER : 0;
+    model.path = (uint32_t)pool_size;
+    pool_size += strlen(path ? path : "") + 1;
+    model.name = (uint32_t)pool_size;
+    pool_size += strlen(name) + 1;
+    FWRITE(file, &model, sizeof(model));
+    APP(model_it_next(&model_it, &is_end_reached));
+  }
+  APP(get_model_instance_list_begin(app, &instance_it, &is_end_reached));
+  while(is_end_reached == false) {
+    struct map_instance instance;
+    struct model_id key;
+    struct app_model* model = NULL;
+    const struct model_id* model_id = NULL;
+    ALIGN(16) struct aosf44 transform;
+    const char* name = NULL;
+    ALIGN(16) float tmp[16];
+
+    APP(model_instance_name(instance_it.instance, &name));
+    APP(model_instance_get_model(instance_it.instance, &model));
+    key.model = model;
+    model_id = bsearch
+      (&key, model_ids, nb_models, sizeof(struct model_id), cmp_model_id);
+    assert(model_id != NULL);
+    APP(get_model_instance_world_transform(instance_it.instance, &transform));
+    aosf44_store(tmp, &transform);
+
+    instance.name = (uint32_t)pool_size;
+    instance.model = model_id->id;
+    memcpy(instance.transform, tmp, sizeof(instance.transform));
+    pool_size += strlen(name) + 1;
+    FWRITE(file, &instance, sizeof(instance));
+    APP(model_instance_it_next(&instance_it, &is_end_reached));
+  }
+
+  /* Save the string pool. */
+  APP(get_model_list_begin(app, &model_it, &is_end_reached));
+  while(is_end_reached == false) {
+    const char* path = NULL;
+    const char* name = NULL;
+    APP(model_path(model_it.model, &path));
+    APP(model_name(model_it.model, &name));
+    path = path ? path : "";
+    FWRITE(file, path, strlen(path) + 1);
+    FWRITE(file, name, strlen(name) + 1);
+    APP(model_it_next(&model_it, &is_end_reached));
+  }
+  APP(get_model_instance_list_begin(app, &instance_it, &is_end_reached));
+  while(is_end_reached == false) {
+    const char* name = NULL;
+    APP(model_instance_name(instance_it.instance, &name));
+    FWRITE(file, name, strlen(name) + 1);
+    APP(model_instance_it_next(&instance_it, &is_end_reached));
+  }
+  #undef FWRITE
+  APP(log(app, APP_LOG_INFO,
+    "%s: map saved `%s'\n", cmd_name, output_file));
+exit:
+  if(model_ids)
+    MEM_FREE(ctxt->allocator, model_ids);
+  if(file) {
+    fflush(file);
+    if(fclose(file) != 0) {
+      APP(log(app, APP_LOG_ERROR,
+        "%s: error closing output file `%s'\n", cmd_name, output_file));
+    }
+  }
+  return;
+error:
+  goto exit;
+}
+
 /*******************************************************************************
  *
  * Command functions.
  *
  ******************************************************************************/
+static void
+model_loaded(struct app_model* mdl, enum app_error app_err, void* data)
+{
+  struct app* app = data;
+  const char* path = NULL;
+  assert(mdl && app);
+
+  if(app_err != APP_NO_ERROR) {
+    APP(log(app, APP_LOG_ERROR, "model loading error\n"));
+    /* Do not keep the empty model. It may be already removed. */
+    app_remove_model(mdl);
+  } else {
+    APP(model_path(mdl, &path));
+    APP(log(app, APP_LOG_INFO, "model loaded `%s'\n", path));
+  }
+}
+
 static void
 load_model
   (struct app* app,
@@ -123,19 +375,239 @@ load_model
       && argv[FILE_NAME]->type == APP_CMDARG_FILE
       && argv[MODEL_NAME]->type == APP_CMDARG_STRING);
 
+  /* The model is registered right now but its resource is loaded in
+   * background. */
   app_err = app_create_model
     (app,
-     EDIT_CMD_ARGVAL(argv, FILE_NAME).data.string,
+     NULL,
      EDIT_CMD_ARGVAL(argv, MODEL_NAME).is_defined == true
       ? EDIT_CMD_ARGVAL(argv, MODEL_NAME).data.string
       : NULL,
      &mdl);
-  if(app_err != APP_NO_ERROR) {
+  if(app_err == APP_NO_ERROR) {
+    app_err = app_load_model_async
+      (EDIT_CMD_ARGVAL(argv, FILE_NAME).data.string, mdl, model_loaded, app);
+    if(app_err != APP_NO_ERROR)
+      APP(remove_model(mdl));
+  }
+  if(app_err != APP_NO_ERROR)
     APP(log(app, APP_LOG_ERROR, "model loading error\n"));
-  } else {
-    APP(log(app, APP_LOG_INFO,
-      "model loaded `%s'\n", EDIT_CMD_ARGVAL(argv, FILE_NAME).data.string));
+}
+
+static enum app_error
+load_text_map(struct app* app, FILE* file)
+{
+  #define MAXLEN 2048
+  char buffer[MAXLEN];
+  char* ptr = NULL;
+  enum app_error app_err = APP_NO_ERROR;
+  assert(app && file);
+
+  while(NULL != (ptr = fgets(buffer, MAXLEN, file))) {
+    size_t len = strlen(ptr);
+    if(len) {
+      /* Remove the "\n" char */
+      if(ptr[len - 1] == '\n')
+        ptr[len - 1] = '\0';
+
+      /* The models of the map are loaded in parallel. Their loading must be
+       * completed before the execution of the commands that use them. */
+      if(strncmp(ptr, "load ", 5) != 0) {
+        app_err = app_flush_model_loads(app);
+        if(app_err == APP_NO_ERROR)
+          app_err = app_execute_command(app, ptr);
+      } else {
+        app_err = app_execute_command(app, ptr);
+      }
+      if(app_err != APP_NO_ERROR)
+        break;
+    }
   }
+  #undef MAXLEN
+  return app_err;
+}
+
+static enum app_error
+load_binary_map
+  (struct edit_context* ctxt,
+   const struct map_header* header,
+   FILE* file)
+{
+  struct app_world* world = NULL;
+  struct app_model** model_list = NULL;
+  struct app_model_instance** instance_list = NULL;
+  struct aosf44* transform_list = NULL;
+  const char** name_list = NULL;
+  size_t* model_range = NULL;
+  const struct map_model* model_tbl = NULL;
+  const struct map_instance* instance_tbl = NULL;
+  const char* pool = NULL;
+  void* buffer = NULL;
+  size_t size = 0;
+  size_t nb_instances = 0;
+  size_t i = 0;
+  long begin = 0;
+  long end = 0;
+  enum app_error app_err = APP_NO_ERROR;
+  assert(ctxt && header && file);
+
+  if(header->version != MAP_VERSION) {
+    app_err = APP_IO_ERROR;
+    goto error;
+  }
+
+  /* Read the tables and the string pool at once. The counts of the header are
+   * checked against the remaining file length before any allocation. */
+  size =
+    (size_t)header->nb_models * sizeof(struct map_model)
+  + (size_t)header->nb_instances * sizeof(struct map_instance)
+  + (size_t)header->pool_size;
+  if((begin = ftell(file)) < 0
+  || fseek(file, 0, SEEK_END) != 0
+  || (end = ftell(file)) < begin
+  || fseek(file, begin, SEEK_SET) != 0
+  || size > (size_t)(end - begin)) {
+    app_err = APP_IO_ERROR;
+    goto error;
+  }
+  buffer = MEM_ALLOC(ctxt->allocator, size ? size : 1);
+  model_list = MEM_CALLOC
+    (ctxt->allocator, header->nb_models + 1, sizeof(struct app_model*));
+  instance_list = MEM_CALLOC
+    (ctxt->allocator,
+     header->nb_instances + 1,
+     sizeof(struct app_model_instance*));
+  transform_list = MEM_ALIGNED_ALLOC
+    (ctxt->allocator,
+     (header->nb_instances + 1) * sizeof(struct aosf44),
+     16);
+  name_list = MEM_CALLOC
+    (ctxt->allocator, header->nb_instances + 1, sizeof(const char*));
+  model_range = MEM_CALLOC
+    (ctxt->allocator, header->nb_models + 1, sizeof(size_t));
+  if(!buffer
+  || !model_list
+  || !instance_list
+  || !transform_list
+  || !name_list
+  || !model_range) {
+    app_err = APP_MEMORY_ERROR;
+    goto error;
+  }
+  if(size && fread(buffer, size, 1, file) != 1) {
+    app_err = APP_IO_ERROR;
+    goto error;
+  }
+  model_tbl = buffer;
+  instance_tbl = (const struct map_instance*)(model_tbl + header->nb_models);
+  pool = (const char*)(instance_tbl + header->nb_instances);
+  if(header->pool_size && pool[header->pool_size - 1] != '\0') {
+    app_err = APP_IO_ERROR;
+    goto error;
+  }
+  #define CHECK_STRING(offset) \
+    if((offset) >= header->pool_size) { \
+      app_err = APP_IO_ERROR; \
+      goto error; \
+    } (void)0
+
+  /* Load the models in parallel. */
+  for(i = 0; i < header->nb_models; ++i) {
+    struct app_model* mdl = NULL;
+    CHECK_STRING(model_tbl[i].path);
+    CHECK_STRING(model_tbl[i].name);
+    app_err = app_create_model(ctxt->app, NULL, pool+model_tbl[i].name, &mdl);
+    if(app_err != APP_NO_ERROR)
+      goto error;
+    /* The occluders are built once the model is loaded. */
+    if(model_tbl[i].flags & MAP_MODEL_OCCLUDER)
+      APP(set_model_occluder(mdl, true));
+    app_err = app_load_model_async
+      (pool + model_tbl[i].path, mdl, model_loaded, ctxt->app);
+    if(app_err != APP_NO_ERROR) {
+      APP(remove_model(mdl));
+      goto error;
+    }
+  }
+  app_err = app_flush_model_loads(ctxt->app);
+  if(app_err != APP_NO_ERROR)
+    goto error;
+  /* The models that failed to load are removed from the application. */
+  for(i = 0; i < header->nb_models; ++i)
+    APP(get_model(ctxt->app, pool + model_tbl[i].name, model_list + i));
+
+  /* Sort the instances per model with a counting sort. Once sorted, the
+   * instances of the i^th model lie in [model_range[i], model_range[i+1]). */
+  for(i = 0; i < header->nb_instances; ++i) {
+    CHECK_STRING(instance_tbl[i].name);
+    if(instance_tbl[i].model >= header->nb_models) {
+      app_err = APP_IO_ERROR;
+      goto error;
+    }
+    ++model_range[instance_tbl[i].model + 1];
+  }
+  for(i = 0; i < header->nb_models; ++i)
+    model_range[i + 1] += model_range[i];
+  for(i = 0; i < header->nb_instances; ++i) {
+    const struct map_instance* instance = instance_tbl + i;
+    const size_t id = model_range[instance->model]++;
+    ALIGN(16) float tmp[16];
+
+    name_list[id] = pool + instance->name;
+    memcpy(tmp, instance->transform, sizeof(tmp));
+    aosf44_load(transform_list + id, tmp);
+  }
+  /* The counting sort shifted the ranges by one model. */
+  memmove(model_range + 1, model_range, header->nb_models * sizeof(size_t));
+  model_range[0] = 0;
+
+  /* Instantiate each model at once and add the instances to the world. */
+  for(i = 0; i < header->nb_models; ++i) {
+    const size_t first = model_range[i];
+    const size_t count = model_range[i + 1] - first;
+
+    if(!count)
+      continue;
+    if(model_list[i] == NULL) {
+      APP(log(ctxt->app, APP_LOG_ERROR,
+        "the model `%s' does not exist\n", pool + model_tbl[i].name));
+      continue;
+    }
+    app_err = app_instantiate_model_n
+      (ctxt->app,
+       model_list[i],
+       count,
+       name_list + first,
+       transform_list + first,
+       instance_list + nb_instances);
+    if(app_err != APP_NO_ERROR)
+      goto error;
+    nb_instances += count;
+  }
+  #undef CHECK_STRING
+  APP(get_main_world(ctxt->app, &world));
+  app_err = app_world_add_model_instances(world, nb_instances, instance_list);
+  if(app_err != APP_NO_ERROR)
+    goto error;
+
+exit:
+  if(buffer)
+    MEM_FREE(ctxt->allocator, buffer);
+  if(model_list)
+    MEM_FREE(ctxt->allocator, model_list);
+  if(instance_list)
+    MEM_FREE(ctxt->allocator, instance_list);
+  if(transform_list)
+    MEM_FREE(ctxt->allocator, transform_list);
+  if(name_list)
+    MEM_FREE(ctxt->allocator, name_list);
+  if(model_range)
+    MEM_FREE(ctxt->allocator, model_range);
+  return app_err;
+error:
+  for(i = 0; i < nb_instances; ++i)
+    APP(remove_model_instance(instance_list[i]));
+  goto exit;
 }
 
 static void
@@ -143,19 +615,19 @@ load_map
   (struct app* app,
    size_t argc UNUSED,
    const struct app_cmdarg** argv,
-   void* data UNUSED)
+   void* data)
 {
-  #define MAXLEN 2048
-  char buffer[MAXLEN];
+  struct map_header header;
   char filename[256];
   char cmdname[64];
+  struct edit_context* ctxt = data;
   FILE* file = NULL;
-  char* ptr = NULL;
   enum app_error app_err = APP_NO_ERROR;
 
   enum { CMD_NAME, FILE_NAME, ARGC };
 
   assert(app != NULL
+      && data != NULL
       && argc == ARGC
       && argv != NULL
       && argv[CMD_NAME]->type == APP_CMDARG_STRING
@@ -176,7 +648,7 @@ load_map
     strcpy(cmdname, EDIT_CMD_ARGVAL(argv, CMD_NAME).data.string);
   }
 
-  file = fopen(filename, "r");
+  file = fopen(filename, "rb");
   if(!file) {
     APP(log(app, APP_LOG_ERROR,
       "%s: error opening file `%s'\n", cmdname, filename));
@@ -192,21 +664,22 @@ load_map
     goto error;
   }
   APP(cleanup(app));
-  while(NULL != (ptr = fgets(buffer, MAXLEN, file))) {
-    size_t len = strlen(ptr);
-    if(len) {
-      /* Remove the "\n" char */
-      if(ptr[len - 1] == '\n')
-        ptr[len - 1] = '\0';
 
-      app_err = app_execute_command(app, ptr);
-      if(app_err != APP_NO_ERROR) {
-        APP(log(app, APP_LOG_ERROR,
-        "%s: error loading file `%s': %s\n",
-        cmdname, filename, app_error_string(app_err)));
-        goto error;
-      }
-    }
+  /* The maps that do not begin with the binary header are command scripts. */
+  if(fread(&header, sizeof(header), 1, file) == 1
+  && memcmp(header.magic, MAP_MAGIC, sizeof(header.magic)) == 0) {
+    app_err = load_binary_map(ctxt, &header, file);
+  } else {
+    rewind(file);
+    app_err = load_text_map(app, file);
+  }
+  if(app_err == APP_NO_ERROR)
+    app_err = app_flush_model_loads(app);
+  if(app_err != APP_NO_ERROR) {
+    APP(log(app, APP_LOG_ERROR,
+      "%s: error loading file `%s': %s\n",
+      cmdname, filename, app_error_string(app_err)));
+    goto error;
   }
   APP(log(app, APP_LOG_INFO, "%s: map loaded `%s'\n", cmdname, filename));
 
@@ -214,9 +687,7 @@ exit:
   if(file) {
     if(fclose(file) != 0) {
       APP(log(app, APP_LOG_ERROR,
-        "%s: error closing map file `%s'\n",
-        EDIT_CMD_ARGVAL(argv, CMD_NAME).data.string,
-        EDIT_CMD_ARGVAL(argv, FILE_NAME).data.string));
+        "%s: error closing map file `%s'\n", cmdname, filename));
     }
   }
   return;
@@ -236,14 +707,15 @@ save
   const char* cmd_name = NULL;
   const char* output_file = NULL;
   FILE* file = NULL;
-  enum { CMD_NAME, OUTPUT_FILE, FORCE_FLAG, ARGC };
+  enum { CMD_NAME, OUTPUT_FILE, FORCE_FLAG, TEXT_FLAG, ARGC };
 
   assert(app != NULL
       && data != NULL
       && argc == ARGC
       && argv[CMD_NAME]->type == APP_CMDARG_STRING
       && argv[OUTPUT_FILE]->type == APP_CMDARG_FILE
-      && argv[FORCE_FLAG]->type == APP_CMDARG_LITERAL);
+      && argv[FORCE_FLAG]->type == APP_CMDARG_LITERAL
+      && argv[TEXT_FLAG]->type == APP_CMDARG_LITERAL);
 
   cmd_name = EDIT_CMD_ARGVAL(argv, CMD_NAME).data.string;
 
@@ -282,7 +754,10 @@ save
 
   /* Save the map. */
   if(output_file) {
-    save_map(app, cmd_name, output_file);
+    if(EDIT_CMD_ARGVAL(argv, TEXT_FLAG).is_defined)
+      save_text_map(app, cmd_name, output_file);
+    else
+      save_binary_map(ctxt, cmd_name, output_file);
   }
 }
 
@@ -338,7 +813,7 @@ edit_setup_load_save_commands(struct edit_context* ctxt)
       APP_CMDARG_END),
      "load a model"));
   CALL(app_add_command
-    (ctxt->app, "load", load_map, NULL, NULL,
+    (ctxt->app, "load", load_map, ctxt, NULL,
      APP_CMDARGV
      (APP_CMDARG_APPEND_FILE("M", "map", "<map>", NULL, 1, 1),
       APP_CMDARG_END),
@@ -353,6 +828,10 @@ edit_setup_load_save_commands(struct edit_context* ctxt)
         ("f", "force",
          "force save the file even though it already exists",
          0, 1),
+      APP_CMDARG_APPEND_LITERAL
+        ("t", "text",
+         "save the map as a command script rather than in the binary format",
+         0, 1),
       APP_CMDARG_END),
      "save the main world"));
 
@@ -367,3 +846,6 @@ error:
 }
 
 
+
+#undef MAP_MAGIC
+#undef MAP_VERSION
@@ -1,6 +1,7 @@
 #include "app/core/app.h"
 #include "app/core/app_cvar.h"
 #include "app/core/app_imdraw.h"
+#include "app/core/app_model.h"
 #include "app/core/app_model_instance.h"
 #include "app/editor/regular/edit_context_c.h"
 #include "app/editor/regular/edit_error_c.h"
@@ -10,7 +11,7 @@
 #include "maths/simd/aosf44.h"
 #include "stdlib/sl.h"
 #include "stdlib/sl_hash_table.h"
-#include "stdlib/sl_pair.h"
+#include "stdlib/sl_vector.h"
 #include "sys/math.h"
 #include "sys/mem_allocator.h"
 #include "sys/ref_count.h"
@@ -20,9 +21,21 @@
 #include <string.h>
 
 struct edit_model_instance_selection {
+  /* Cached bounds of the selected instances. */
+  struct {
+    vf4_t center_sum; /* Sum of the AABB centers of the instances. */
+    vf4_t min_bound;
+    vf4_t max_bound;
+    bool is_outdated;
+    /* The selection translated its instances since the last commit of the
+     * instance transforms and already updated the bounds accordingly. */
+    bool is_translated;
+  } bounds;
   struct ref ref;
   struct app* app;
-  struct sl_hash_table* instance_htbl;
+  struct sl_vector* instance_list; /* Dense list of app_model_instance*. */
+  struct sl_vector* bounds_buffer; /* Scratch floats of the bounds refit. */
+  struct sl_hash_table* instance_htbl; /* Map an instance to its list id. */
   struct mem_allocator* allocator;
 };
 
@@ -45,6 +58,131 @@ eq_ptr(const void* key0, const void* key1)
   return ptr0 == ptr1;
 }
 
+static void
+get_instance_list
+  (struct edit_model_instance_selection* selection,
+   size_t* nb_instances,
+   struct app_model_instance*** instance_list)
+{
+  assert(selection && nb_instances && instance_list);
+  SL(vector_buffer
+    (selection->instance_list,
+     nb_instances, NULL, NULL, (void**)instance_list));
+}
+
+static void
+reset_bounds(struct edit_model_instance_selection* selection)
+{
+  assert(selection);
+  selection->bounds.center_sum = vf4_zero();
+  selection->bounds.min_bound = vf4_set1(FLT_MAX);
+  selection->bounds.max_bound = vf4_set1(-FLT_MAX);
+  selection->bounds.is_outdated = false;
+  selection->bounds.is_translated = false;
+}
+
+static void
+add_bounds
+  (struct edit_model_instance_selection* selection,
+   const float min_bound[3],
+   const float max_bound[3])
+{
+  vf4_t vmin;
+  vf4_t vmax;
+  assert(selection && min_bound && max_bound);
+  assert(!selection->bounds.is_outdated);
+
+  vmin = vf4_set(min_bound[0], min_bound[1], min_bound[2], 0.f);
+  vmax = vf4_set(max_bound[0], max_bound[1], max_bound[2], 0.f);
+  selection->bounds.center_sum = vf4_add
+    (selection->bounds.center_sum,
+     vf4_mul(vf4_add(vmin, vmax), vf4_set1(0.5f)));
+  selection->bounds.min_bound = vf4_min(selection->bounds.min_bound, vmin);
+  selection->bounds.max_bound = vf4_max(selection->bounds.max_bound, vmax);
+}
+
+static void
+add_instance_bounds
+  (struct edit_model_instance_selection* selection,
+   const struct app_model_instance* instance)
+{
+  float min_bound[3] = { 0.f, 0.f, 0.f };
+  float max_bound[3] = { 0.f, 0.f, 0.f };
+  assert(selection && instance);
+
+  APP(get_model_instance_aabb(instance, min_bound, max_bound));
+  add_bounds(selection, min_bound, max_bound);
+}
+
+static FINLINE bool
+is_infinite_box(const float min_bound[3], const float max_bound[3])
+{
+  return (min_bound[0] == -FLT_MAX)
+    | (min_bound[1] == -FLT_MAX)
+    | (min_bound[2] == -FLT_MAX)
+    | (max_bound[0] == FLT_MAX)
+    | (max_bound[1] == FLT_MAX)
+    | (max_bound[2] == FLT_MAX);
+}
+
+static void
+update_bounds(struct edit_model_instance_selection* selection)
+{
+  struct app_model_instance** instance_list = NULL;
+  float* transforms = NULL;
+  float* lower = NULL;
+  float* upper = NULL;
+  size_t nb_instances = 0;
+  size_t i = 0;
+  enum sl_error sl_err = SL_NO_ERROR;
+  assert(selection);
+
+  if(selection->bounds.is_outdated == false)
+    return;
+  reset_bounds(selection);
+  get_instance_list(selection, &nb_instances, &instance_list);
+
+  /* The world bounds of the instances are refit at once from the model bounds
+   * and the world transforms. Fall back to the bounds of each instance if the
+   * scratch buffer cannot be allocated. */
+  sl_err = sl_vector_resize
+    (selection->bounds_buffer, nb_instances * (16 + 3 + 3), NULL);
+  if(sl_err != SL_NO_ERROR) {
+    for(i = 0; i < nb_instances; ++i)
+      add_instance_bounds(selection, instance_list[i]);
+    return;
+  }
+  SL(vector_buffer
+    (selection->bounds_buffer, NULL, NULL, NULL, (void**)&transforms));
+  lower = transforms + nb_instances * 16;
+  upper = lower + nb_instances * 3;
+  for(i = 0; i < nb_instances; ++i) {
+    struct aosf44 f44;
+    struct app_model* model = NULL;
+    APP(get_model_instance_world_transform(instance_list[i], &f44));
+    aosf44_store(transforms + i * 16, &f44);
+    APP(model_instance_get_model(instance_list[i], &model));
+    APP(get_model_aabb(model, lower + i * 3, upper + i * 3));
+  }
+  aosf44_transform_boxes
+    (transforms, lower, upper, nb_instances, lower, upper);
+  for(i = 0; i < nb_instances; ++i) {
+    float min_bound[3];
+    float max_bound[3];
+    struct app_model* model = NULL;
+    /* The transformed bounds of an infinite model are not significant. */
+    APP(model_instance_get_model(instance_list[i], &model));
+    APP(get_model_aabb(model, min_bound, max_bound));
+    if(is_infinite_box(min_bound, max_bound)) {
+      min_bound[0] = min_bound[1] = min_bound[2] = -FLT_MAX;
+      max_bound[0] = max_bound[1] = max_bound[2] = FLT_MAX;
+      add_bounds(selection, min_bound, max_bound);
+    } else {
+      add_bounds(selection, lower + i * 3, upper + i * 3);
+    }
+  }
+}
+
 static void
 on_destroy_model_instance(struct app_model_instance* instance, void*data)
 {
@@ -56,6 +194,30 @@ on_destroy_model_instance(struct app_model_instance* instance, void*data)
   }
 }
 
+static void
+on_transform_model_instances
+  (struct app_model_instance** instance_list,
+   size_t nb_instances,
+   void* data)
+{
+  struct edit_model_instance_selection* selection = data;
+  void* ptr = NULL;
+  size_t i = 0;
+  assert((instance_list || !nb_instances) && data);
+
+  /* The bounds were already moved with the selected instances. */
+  if(selection->bounds.is_translated) {
+    selection->bounds.is_translated = false;
+    return;
+  }
+  /* The instances may be transformed by other paths than the selection, e.g.
+   * by name, and thus the cached bounds cannot be updated incrementally. */
+  for(i = 0; i < nb_instances && !selection->bounds.is_outdated; ++i) {
+    SL(hash_table_find(selection->instance_htbl, instance_list + i, &ptr));
+    selection->bounds.is_outdated = (ptr != NULL);
+  }
+}
+
 static void
 release_model_instance_selection(struct ref* ref)
 {
@@ -65,10 +227,14 @@ release_model_instance_selection(struct ref* ref)
   assert(ref);
 
   selection = CONTAINER_OF(ref, struct edit_model_instance_selection, ref);
-  if(selection->instance_htbl) {
+  if(selection->instance_htbl && selection->instance_list)
     EDIT(clear_model_instance_selection(selection));
+  if(selection->instance_htbl)
     SL(free_hash_table(selection->instance_htbl));
-  }
+  if(selection->instance_list)
+    SL(free_vector(selection->instance_list));
+  if(selection->bounds_buffer)
+    SL(free_vector(selection->bounds_buffer));
   APP(is_callback_attached
     (selection->app,
      APP_SIGNAL_DESTROY_MODEL_INSTANCE,
@@ -82,6 +248,19 @@ release_model_instance_selection(struct ref* ref)
        APP_CALLBACK(on_destroy_model_instance),
        selection));
   }
+  APP(is_callback_attached
+    (selection->app,
+     APP_SIGNAL_TRANSFORM_MODEL_INSTANCES,
+     APP_CALLBACK(on_transform_model_instances),
+     selection,
+     &is_clbk_attached));
+  if(is_clbk_attached) {
+    APP(detach_callback
+      (selection->app,
+       APP_SIGNAL_TRANSFORM_MODEL_INSTANCES,
+       APP_CALLBACK(on_transform_model_instances),
+       selection));
+  }
 
   app = selection->app;
   MEM_FREE(selection->allocator, selection);
@@ -107,22 +286,39 @@ edit_create_model_instance_selection
     edit_err = EDIT_INVALID_ARGUMENT;
     goto error;
   }
-  selection = MEM_CALLOC
-    (ctxt->allocator, 1, sizeof(struct edit_model_instance_selection));
+  selection = MEM_ALIGNED_ALLOC
+    (ctxt->allocator, sizeof(struct edit_model_instance_selection), 16);
   if(!selection) {
     edit_err = EDIT_MEMORY_ERROR;
     goto error;
   }
+  memset(selection, 0, sizeof(struct edit_model_instance_selection));
   ref_init(&selection->ref);
   APP(ref_get(ctxt->app));
   selection->app = ctxt->app;
   selection->allocator = ctxt->allocator;
+  reset_bounds(selection);
 
-  sl_err = sl_create_hash_table
+  sl_err = sl_create_vector
     (sizeof(struct app_model_instance*),
      ALIGNOF(struct app_model_instance*),
-     sizeof(struct app_model_instance*),
+     selection->allocator,
+     &selection->instance_list);
+  if(sl_err != SL_NO_ERROR) {
+    edit_err = sl_to_edit_error(sl_err);
+    goto error;
+  }
+  sl_err = sl_create_vector
+    (sizeof(float), 16, selection->allocator, &selection->bounds_buffer);
+  if(sl_err != SL_NO_ERROR) {
+    edit_err = sl_to_edit_error(sl_err);
+    goto error;
+  }
+  sl_err = sl_create_hash_table
+    (sizeof(struct app_model_instance*),
      ALIGNOF(struct app_model_instance*),
+     sizeof(size_t),
+     ALIGNOF(size_t),
      hash_ptr,
      eq_ptr,
      selection->allocator,
@@ -140,6 +336,15 @@ edit_create_model_instance_selection
     edit_err = app_to_edit_error(app_err);
     goto error;
   }
+  app_err = app_attach_callback
+    (selection->app,
+     APP_SIGNAL_TRANSFORM_MODEL_INSTANCES,
+     APP_CALLBACK(on_transform_model_instances),
+     selection);
+  if(app_err != APP_NO_ERROR) {
+    edit_err = app_to_edit_error(app_err);
+    goto error;
+  }
 
 exit:
   if(out_selection)
@@ -179,6 +384,7 @@ edit_select_model_instance
    struct app_model_instance* instance)
 {
   void* ptr = NULL;
+  size_t id = 0;
   enum edit_error edit_err = EDIT_NO_ERROR;
   enum sl_error sl_err = SL_NO_ERROR;
 
@@ -193,12 +399,22 @@ edit_select_model_instance
     APP(log(selection->app, APP_LOG_INFO,
       "the instance `%s' is already selected\n", instance_name));
   } else {
-    sl_err = sl_hash_table_insert
-      (selection->instance_htbl, &instance, &instance);
+    SL(vector_length(selection->instance_list, &id));
+    sl_err = sl_hash_table_insert(selection->instance_htbl, &instance, &id);
+    if(sl_err != SL_NO_ERROR) {
+      edit_err = sl_to_edit_error(sl_err);
+      goto error;
+    }
+    sl_err = sl_vector_push_back(selection->instance_list, &instance);
     if(sl_err != SL_NO_ERROR) {
+      SL(hash_table_erase(selection->instance_htbl, &instance, NULL));
       edit_err = sl_to_edit_error(sl_err);
       goto error;
     }
+    if(selection->bounds.is_outdated == false)
+      add_instance_bounds(selection, instance);
+    /* The transforms committed next may not be the ones of the selection. */
+    selection->bounds.is_translated = false;
   }
 exit:
   return edit_err;
@@ -211,17 +427,19 @@ edit_unselect_model_instance
   (struct edit_model_instance_selection* selection,
    struct app_model_instance* instance)
 {
-  enum edit_error edit_err = EDIT_NO_ERROR;
-  struct app_model_instance** selected_instance = NULL;
+  struct app_model_instance** instance_list = NULL;
+  size_t* id = NULL;
+  size_t* last_id = NULL;
+  size_t nb_instances = 0;
   size_t i = 0;
+  enum edit_error edit_err = EDIT_NO_ERROR;
 
   if(UNLIKELY(!selection || !instance)) {
     edit_err = EDIT_INVALID_ARGUMENT;
     goto error;
   }
-  SL(hash_table_find
-    (selection->instance_htbl, &instance, (void**)&selected_instance));
-  if(!selected_instance) {
+  SL(hash_table_find(selection->instance_htbl, &instance, (void**)&id));
+  if(!id) {
     const char* name = NULL;
     APP(model_instance_name(instance, &name));
     APP(log(selection->app, APP_LOG_ERROR,
@@ -229,9 +447,23 @@ edit_unselect_model_instance
     edit_err = EDIT_INVALID_ARGUMENT;
     goto error;
   }
-  assert(instance == *selected_instance);
+  /* Move the last selected instance into the slot of the removed one. */
+  get_instance_list(selection, &nb_instances, &instance_list);
+  assert(*id < nb_instances && instance_list[*id] == instance);
+  if(*id != nb_instances - 1) {
+    SL(hash_table_find
+      (selection->instance_htbl,
+       instance_list + nb_instances - 1,
+       (void**)&last_id));
+    assert(last_id != NULL);
+    *last_id = *id;
+    instance_list[*id] = instance_list[nb_instances - 1];
+  }
+  SL(vector_pop_back(selection->instance_list));
   SL(hash_table_erase(selection->instance_htbl, &instance, &i));
   assert(i == 1);
+  /* The bounds cannot be shrunk incrementally. */
+  selection->bounds.is_outdated = true;
 exit:
   return edit_err;
 error:
@@ -257,31 +489,20 @@ EXPORT_SYM enum edit_error
 edit_remove_selected_model_instances
   (struct edit_model_instance_selection* selection)
 {
-  enum edit_error edit_err = EDIT_NO_ERROR;
-  struct sl_hash_table_it it;
-  bool is_end_reached = false;
-  memset(&it, 0, sizeof(it));
+  struct app_model_instance** instance_list = NULL;
+  size_t nb_instances = 0;
 
-  if(UNLIKELY(!selection)) {
-    edit_err = EDIT_INVALID_ARGUMENT;
-    goto error;
-  }
+  if(UNLIKELY(!selection))
+    return EDIT_INVALID_ARGUMENT;
 
-  SL(hash_table_begin(selection->instance_htbl, &it, &is_end_reached));
-  while(is_end_reached == false) {
-    struct app_model_instance* instance =
-      *(struct app_model_instance**)it.pair.data;
+  get_instance_list(selection, &nb_instances, &instance_list);
+  while(nb_instances) {
+    struct app_model_instance* instance = instance_list[nb_instances - 1];
     EDIT(unselect_model_instance(selection, instance));
     APP(remove_model_instance(instance));
-
-    /* Always retrieve the beginning of the hash table since it is updated by
-     * the unselect_model_instance function. */
-    SL(hash_table_begin(selection->instance_htbl, &it, &is_end_reached));
+    get_instance_list(selection, &nb_instances, &instance_list);
   }
-exit:
-  return edit_err;
-error:
-  goto exit;
+  return EDIT_NO_ERROR;
 }
 
 EXPORT_SYM enum edit_error
@@ -291,6 +512,8 @@ edit_clear_model_instance_selection
   if(UNLIKELY(!selection))
     return EDIT_INVALID_ARGUMENT;
   SL(hash_table_clear(selection->instance_htbl));
+  SL(clear_vector(selection->instance_list));
+  reset_bounds(selection);
   return EDIT_NO_ERROR;
 }
 
@@ -299,36 +522,23 @@ edit_get_model_instance_selection_pivot
   (struct edit_model_instance_selection* selection,
    float pivot[3])
 {
-  struct sl_hash_table_it it;
+  ALIGN(16) float tmp[4];
   size_t nb_instances = 0;
-  float rcp_nb_instances = 0.f;
-  bool is_end_reached = false;
-  memset(&it, 0, sizeof(it));
 
   if(UNLIKELY(!selection || !pivot))
     return EDIT_INVALID_ARGUMENT;
 
-  nb_instances = 0;
-  pivot[0] = pivot[1] = pivot[2] = 0.f;
-  SL(hash_table_begin(selection->instance_htbl, &it, &is_end_reached));
-  while(is_end_reached == false) {
-    float min_bound[3] = {0.f, 0.f, 0.f};
-    float max_bound[3] = {0.f, 0.f, 0.f};
-    const struct app_model_instance* instance =
-      *(struct app_model_instance**)it.pair.data;
-
-    APP(get_model_instance_aabb(instance, min_bound, max_bound));
-    pivot[0] += (min_bound[0] + max_bound[0]) * 0.5f;
-    pivot[1] += (min_bound[1] + max_bound[1]) * 0.5f;
-    pivot[2] += (min_bound[2] + max_bound[2]) * 0.5f;
-    ++nb_instances;
-
-    SL(hash_table_it_next(&it, &is_end_reached));
+  SL(vector_length(selection->instance_list, &nb_instances));
+  if(!nb_instances) {
+    pivot[0] = pivot[1] = pivot[2] = 0.f;
+  } else {
+    update_bounds(selection);
+    vf4_store(tmp, vf4_mul
+      (selection->bounds.center_sum, vf4_set1(1.f / (float)nb_instances)));
+    pivot[0] = tmp[0];
+    pivot[1] = tmp[1];
+    pivot[2] = tmp[2];
   }
-  rcp_nb_instances = 1.f / (float)nb_instances;
-  pivot[0] *= rcp_nb_instances;
-  pivot[1] *= rcp_nb_instances;
-  pivot[2] *= rcp_nb_instances;
   return EDIT_NO_ERROR;
 }
 
@@ -337,20 +547,27 @@ edit_translate_model_instance_selection
   (struct edit_model_instance_selection* selection,
    const float translation[3])
 {
-  struct sl_hash_table_it it;
-  bool is_end_reached = false;
+  struct app_model_instance** instance_list = NULL;
+  size_t nb_instances = 0;
 
   if(UNLIKELY(!selection || !translation))
     return EDIT_INVALID_ARGUMENT;
   if((!translation[0]) & (!translation[1]) & (!translation[2]))
     return EDIT_NO_ERROR;
 
-  SL(hash_table_begin(selection->instance_htbl, &it, &is_end_reached));
-  while(is_end_reached == false) {
-    struct app_model_instance* instance =
-      *(struct app_model_instance**)it.pair.data;
-    APP(translate_model_instances(&instance, 1, false, translation));
-    SL(hash_table_it_next(&it, &is_end_reached));
+  get_instance_list(selection, &nb_instances, &instance_list);
+  APP(translate_model_instances
+    (instance_list, nb_instances, false, translation));
+
+  /* A translation moves the bounds as is. */
+  if(selection->bounds.is_outdated == false) {
+    const vf4_t t = vf4_set
+      (translation[0], translation[1], translation[2], 0.f);
+    selection->bounds.center_sum = vf4_add
+      (selection->bounds.center_sum, vf4_mul(t, vf4_set1((float)nb_instances)));
+    selection->bounds.min_bound = vf4_add(selection->bounds.min_bound, t);
+    selection->bounds.max_bound = vf4_add(selection->bounds.max_bound, t);
+    selection->bounds.is_translated = nb_instances != 0;
   }
   return EDIT_NO_ERROR;
 }
@@ -361,22 +578,17 @@ edit_rotate_model_instance_selection
    bool local_rotation,
    const float rotation[3])
 {
-  struct sl_hash_table_it it;
-  bool is_end_reached = false;
+  struct app_model_instance** instance_list = NULL;
+  size_t nb_instances = 0;
 
   if(UNLIKELY(!selection || !rotation))
     return EDIT_INVALID_ARGUMENT;
   if((!rotation[0]) & (!rotation[1]) & (!rotation[2]))
     return EDIT_NO_ERROR;
 
+  get_instance_list(selection, &nb_instances, &instance_list);
   if(local_rotation == false) {
-    SL(hash_table_begin(selection->instance_htbl, &it, &is_end_reached));
-    while(is_end_reached == false) {
-      struct app_model_instance* instance =
-        *(struct app_model_instance**)it.pair.data;
-      APP(rotate_model_instances(&instance, 1, false, rotation));
-      SL(hash_table_it_next(&it, &is_end_reached));
-    }
+    APP(rotate_model_instances(instance_list, nb_instances, false, rotation));
   } else {
     struct aosf44 transform;
     struct aosf33 rot_3x3;
@@ -393,15 +605,10 @@ edit_rotate_model_instance_selection
     transform.c3 = vf4_xyzd(aosf33_mulf3(&rot_3x3, translation), vf4_set1(1.f));
     transform.c3 = vf4_sub(transform.c3, translation);
 
-    SL(hash_table_begin(selection->instance_htbl, &it, &is_end_reached));
-    while(is_end_reached == false) {
-      struct app_model_instance* instance =
-        *(struct app_model_instance**)it.pair.data;
-      APP(transform_model_instances(&instance, 1, false, &transform));
-      SL(hash_table_it_next(&it, &is_end_reached));
-    }
-
+    APP(transform_model_instances
+      (instance_list, nb_instances, false, &transform));
   }
+  selection->bounds.is_outdated = true;
   return EDIT_NO_ERROR;
 }
 
@@ -411,22 +618,17 @@ edit_scale_model_instance_selection
    bool local_scale,
    const float scale[3])
 {
-  struct sl_hash_table_it it;
-  bool is_end_reached = false;
+  struct app_model_instance** instance_list = NULL;
+  size_t nb_instances = 0;
 
   if(UNLIKELY(!selection || !scale))
     return EDIT_INVALID_ARGUMENT;
   if((scale[0] == 1.f) & (scale[1] == 1.f) & (scale[2] == 1.f))
     return EDIT_NO_ERROR;
 
+  get_instance_list(selection, &nb_instances, &instance_list);
   if(local_scale == false) {
-    SL(hash_table_begin(selection->instance_htbl, &it, &is_end_reached));
-    while(is_end_reached == false) {
-      struct app_model_instance* instance =
-        *(struct app_model_instance**)it.pair.data;
-      APP(scale_model_instances(&instance, 1, false, scale));
-      SL(hash_table_it_next(&it, &is_end_reached));
-    }
+    APP(scale_model_instances(instance_list, nb_instances, false, scale));
   } else {
     struct aosf44 transform;
     struct aosf33 f33;
@@ -442,14 +644,10 @@ edit_scale_model_instance_selection
     transform.c3 = vf4_xyzd(aosf33_mulf3(&f33, translation), vf4_set1(1.f));
     transform.c3 = vf4_sub(transform.c3, translation);
 
-    SL(hash_table_begin(selection->instance_htbl, &it, &is_end_reached));
-    while(is_end_reached == false) {
-      struct app_model_instance* instance =
-        *(struct app_model_instance**)it.pair.data;
-      APP(transform_model_instances(&instance, 1, false, &transform));
-      SL(hash_table_it_next(&it, &is_end_reached));
-    }
+    APP(transform_model_instances
+      (instance_list, nb_instances, false, &transform));
   }
+  selection->bounds.is_outdated = true;
   return EDIT_NO_ERROR;
 }
 
@@ -459,20 +657,16 @@ edit_transform_model_instance_selection
    bool local_transformation,
    const struct aosf44* transform)
 {
-  struct sl_hash_table_it it;
-  bool is_end_reached = false;
+  struct app_model_instance** instance_list = NULL;
+  size_t nb_instances = 0;
 
   if(UNLIKELY(!selection || !transform))
     return EDIT_INVALID_ARGUMENT;
 
+  get_instance_list(selection, &nb_instances, &instance_list);
   if(local_transformation == false) {
-    SL(hash_table_begin(selection->instance_htbl, &it, &is_end_reached));
-    while(is_end_reached == false) {
-      struct app_model_instance* instance =
-        *(struct app_model_instance**)it.pair.data;
-      APP(transform_model_instances(&instance, 1, false, transform));
-      SL(hash_table_it_next(&it, &is_end_reached));
-    }
+    APP(transform_model_instances
+      (instance_list, nb_instances, false, transform));
   } else {
     struct aosf44 tmp_4x4;
     vf4_t translation;
@@ -485,16 +679,12 @@ edit_transform_model_instance_selection
     tmp_4x4.c1 = transform->c1;
     tmp_4x4.c2 = transform->c2;
     tmp_4x4.c3 = aosf44_mulf4(transform, translation);
-    tmp_4x4.c3 = vf4_sub(tmp_4x4.c3, translation);
-
-    SL(hash_table_begin(selection->instance_htbl, &it, &is_end_reached));
-    while(is_end_reached == false) {
-      struct app_model_instance* instance =
-        *(struct app_model_instance**)it.pair.data;
-      APP(transform_model_instances(&instance, 1, false, transform));
-      SL(hash_table_it_next(&it, &is_end_reached));
-    }
+    tmp_4x4.c3 = vf4_xyzd(vf4_sub(tmp_4x4.c3, translation), vf4_set1(1.f));
+
+    APP(transform_model_instances
+      (instance_list, nb_instances, false, &tmp_4x4));
   }
+  selection->bounds.is_outdated = true;
   return EDIT_NO_ERROR;
 }
 
@@ -502,26 +692,22 @@ EXPORT_SYM enum edit_error
 edit_draw_model_instance_selection
   (struct edit_model_instance_selection* selection)
 {
-  struct sl_hash_table_it it;
+  ALIGN(16) float min_bound[4];
+  ALIGN(16) float max_bound[4];
+  struct app_model_instance** instance_list = NULL;
   float pivot[3] = { 0.f, 0.f, 0.f };
   float size[3] = { 0.f, 0.f, 0.f };
-  float selection_max_bound[3] = {-FLT_MAX,-FLT_MAX,-FLT_MAX };
-  float selection_min_bound[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
-  enum edit_error edit_err = EDIT_NO_ERROR;
-  short i = 0;
-  bool is_end_reached = false;
-  memset(&it, 0, sizeof(it));
+  size_t nb_instances = 0;
+  size_t i = 0;
 
-  if(UNLIKELY(!selection)) {
-    edit_err = EDIT_INVALID_ARGUMENT;
-    goto error;
-  }
-  /* Define the aabb of the selected instances. */
-  SL(hash_table_begin(selection->instance_htbl, &it, &is_end_reached));
-  if(is_end_reached == true)
-    goto exit;
+  if(UNLIKELY(!selection))
+    return EDIT_INVALID_ARGUMENT;
+
+  get_instance_list(selection, &nb_instances, &instance_list);
+  if(!nb_instances)
+    return EDIT_NO_ERROR;
 
-  do {
+  for(i = 0; i < nb_instances; ++i) {
     const struct aosf44* raw_transform = NULL;
     struct aosf44 f44;
     vf4_t f4;
@@ -530,10 +716,7 @@ edit_draw_model_instance_selection
     float obb_x[3] = { 0.f, 0.f, 0.f };
     float obb_y[3] = { 0.f, 0.f, 0.f };
     float obb_z[3] = { 0.f, 0.f, 0.f };
-    float min_bound[3] = { 0.f, 0.f, 0.f };
-    float max_bound[3] = { 0.f, 0.f, 0.f };
-    const struct app_model_instance* instance =
-      *(struct app_model_instance**)it.pair.data;
+    const struct app_model_instance* instance = instance_list[i];
 
     APP(get_model_instance_obb(instance, pos, obb_x, obb_y, obb_z));
     APP(get_raw_model_instance_transform(instance, &raw_transform));
@@ -559,20 +742,15 @@ edit_draw_model_instance_selection
        transform,
        (float[]){0.75f, 0.75f, 0.0f, 0.10f}, /* Solid color */
        (float[]){1.f, 1.f, 0.f, 1.f})); /* Wire color */
+  }
 
-    /* Update the bounds of the selection AABB */
-    APP(get_model_instance_aabb(instance, min_bound, max_bound));
-    for(i = 0; i < 3; ++i) {
-      selection_max_bound[i] = MAX(selection_max_bound[i], max_bound[i]);
-      selection_min_bound[i] = MIN(selection_min_bound[i], min_bound[i]);
-    }
-
-    SL(hash_table_it_next(&it, &is_end_reached));
-  } while(is_end_reached == false);
-
+  /* Draw the AABB of the selection. */
+  update_bounds(selection);
+  vf4_store(min_bound, selection->bounds.min_bound);
+  vf4_store(max_bound, selection->bounds.max_bound);
   for(i = 0; i < 3; ++i) {
-    pivot[i] = (selection_min_bound[i] + selection_max_bound[i]) * 0.5f;
-    size[i] = selection_max_bound[i] - selection_min_bound[i];
+    pivot[i] = (min_bound[i] + max_bound[i]) * 0.5f;
+    size[i] = max_bound[i] - min_bound[i];
   }
   APP(imdraw_parallelepiped
     (selection->app,
@@ -583,10 +761,5 @@ edit_draw_model_instance_selection
      (float[]){0.f, 0.f, 0.f}, /* Rotation */
      (float[]){0.f, 0.f, 0.f, 0.f}, /* Solid color */
      (float[]){0.75f, 0.75f, 0.75f, 1.f})); /* Wire color */
-
-exit:
-  return edit_err;
-error:
-  goto exit;
+  return EDIT_NO_ERROR;
 }
-
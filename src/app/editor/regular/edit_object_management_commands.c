@@ -17,6 +17,41 @@
  * Command functions.
  *
  ******************************************************************************/
+static void
+set_model_occluder
+  (struct app* app,
+   size_t argc UNUSED,
+   const struct app_cmdarg** argv,
+   void* data UNUSED)
+{
+  struct app_model* mdl = NULL;
+  enum app_error app_err = APP_NO_ERROR;
+  enum { CMD_NAME, DISABLE_FLAG, MODEL_NAME, ARGC };
+
+  assert(app != NULL
+      && argc == ARGC
+      && argv != NULL
+      && argv[CMD_NAME]->type == APP_CMDARG_STRING
+      && argv[DISABLE_FLAG]->type == APP_CMDARG_LITERAL
+      && argv[MODEL_NAME]->type == APP_CMDARG_STRING);
+
+  APP(get_model(app, EDIT_CMD_ARGVAL(argv, MODEL_NAME).data.string, &mdl));
+  if(mdl == NULL) {
+    APP(log(app, APP_LOG_ERROR,
+      "the model `%s' does not exist\n",
+      EDIT_CMD_ARGVAL(argv, MODEL_NAME).data.string));
+  } else {
+    app_err = app_set_model_occluder
+      (mdl, !EDIT_CMD_ARGVAL(argv, DISABLE_FLAG).is_defined);
+    if(app_err != APP_NO_ERROR) {
+      APP(log(app, APP_LOG_ERROR,
+        "error setting the occluder of the model `%s': %s\n",
+        EDIT_CMD_ARGVAL(argv, MODEL_NAME).data.string,
+        app_error_string(app_err)));
+    }
+  }
+}
+
 static void
 rename_model
   (struct app* app,
@@ -348,6 +383,7 @@ edit_release_object_management_commands(struct edit_context* ctxt)
         APP(del_command(ctxt->app, cmd)); \
     } while(0);
 
+  RELEASE_CMD("occluder");
   RELEASE_CMD("rename");
   RELEASE_CMD("rm");
   RELEASE_CMD("spawn");
@@ -374,6 +410,18 @@ edit_setup_object_management_commands(struct edit_context* ctxt)
       } \
     } while(0)
 
+  CALL(app_add_command
+    (ctxt->app, "occluder", set_model_occluder, NULL,
+     app_model_name_completion,
+     APP_CMDARGV
+     (APP_CMDARG_APPEND_LITERAL
+        ("d", "disable", "stop using the model as an occluder", 0, 1),
+      APP_CMDARG_APPEND_STRING
+        ("m", "model", "<model>", "model whose triangles hide the instances",
+         1, 1, NULL),
+      APP_CMDARG_END),
+     "use the triangles of a model as occluders"));
+
   CALL(app_add_command
     (ctxt->app, "rename", rename_model, NULL, app_model_name_completion,
      APP_CMDARGV
@@ -0,0 +1,206 @@
+#include "bench/bench.h"
+#include "sys/clock_time.h"
+#include "sys/math.h"
+#include "sys/sys.h"
+#include <assert.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define DEFAULT_NB_WARMUPS 3
+#define DEFAULT_NB_REPS 15
+
+struct bench {
+  const char* filter; /* Substring of the case names to run. May be NULL. */
+  const char* rb_path;
+  size_t nb_warmups;
+  size_t nb_reps;
+  int64_t* timings; /* nb_reps timings in nano seconds. */
+  FILE* json;
+  size_t nb_results;
+};
+
+/*******************************************************************************
+ *
+ * Helper functions.
+ *
+ ******************************************************************************/
+static int
+cmp_timing(const void* a, const void* b)
+{
+  const int64_t t0 = *(const int64_t*)a;
+  const int64_t t1 = *(const int64_t*)b;
+  return t0 < t1 ? -1 : (t0 > t1 ? 1 : 0);
+}
+
+/* Nearest rank percentile of the sorted timings. */
+static int64_t
+percentile(const int64_t* sorted, size_t count, unsigned int pc)
+{
+  size_t rank = 0;
+  assert(sorted && count && pc <= 100);
+  rank = (pc * count + 99) / 100;
+  return sorted[rank ? rank - 1 : 0];
+}
+
+static int64_t
+time_run(const struct bench_case* bcase)
+{
+  struct time t0, t1;
+  assert(bcase);
+
+  if(bcase->setup)
+    bcase->setup(bcase->data);
+  current_time(&t0);
+  bcase->run(bcase->data);
+  current_time(&t1);
+  if(bcase->teardown)
+    bcase->teardown(bcase->data);
+
+  time_sub(&t1, &t1, &t0);
+  return time_val(&t1, TIME_NSEC);
+}
+
+static void
+print_usage(const char* cmd)
+{
+  printf
+    ("usage: %s [-b RB_DRIVER] [-o JSON_FILE] [-r REPS] [-w WARMUPS] "
+     "[FILTER]\n", cmd);
+}
+
+/*******************************************************************************
+ *
+ * Bench functions.
+ *
+ ******************************************************************************/
+void
+bench_run(struct bench* bench, const struct bench_case* bcase)
+{
+  int64_t sum = 0;
+  int64_t median = 0;
+  double ns_per_item = 0.0;
+  size_t i = 0;
+  assert(bench && bcase && bcase->name && bcase->run);
+
+  if(bench->filter && !strstr(bcase->name, bench->filter))
+    return;
+
+  for(i = 0; i < bench->nb_warmups; ++i)
+    time_run(bcase);
+  for(i = 0; i < bench->nb_reps; ++i) {
+    bench->timings[i] = time_run(bcase);
+    sum += bench->timings[i];
+  }
+  qsort(bench->timings, bench->nb_reps, sizeof(int64_t), cmp_timing);
+
+  median = percentile(bench->timings, bench->nb_reps, 50);
+  ns_per_item = (double)median / (double)MAX(bcase->nb_items, 1);
+  printf("%-36s %12.3f ms %12.2f ns/item (p90 %.3f ms, p99 %.3f ms)\n",
+    bcase->name,
+    (double)median * 1.e-6,
+    ns_per_item,
+    (double)percentile(bench->timings, bench->nb_reps, 90) * 1.e-6,
+    (double)percentile(bench->timings, bench->nb_reps, 99) * 1.e-6);
+
+  if(bench->json) {
+    fprintf(bench->json,
+      "%s\n    {\"name\": \"%s\", \"items\": %zu, \"reps\": %zu, "
+      "\"min_ns\": %" PRId64 ", \"median_ns\": %" PRId64 ", "
+      "\"p90_ns\": %" PRId64 ", \"p99_ns\": %" PRId64 ", "
+      "\"max_ns\": %" PRId64 ", \"mean_ns\": %" PRId64 ", "
+      "\"ns_per_item\": %.3f}",
+      bench->nb_results ? "," : "",
+      bcase->name,
+      bcase->nb_items,
+      bench->nb_reps,
+      bench->timings[0],
+      median,
+      percentile(bench->timings, bench->nb_reps, 90),
+      percentile(bench->timings, bench->nb_reps, 99),
+      bench->timings[bench->nb_reps - 1],
+      sum / (int64_t)bench->nb_reps,
+      ns_per_item);
+  }
+  ++bench->nb_results;
+}
+
+const char*
+bench_render_backend(const struct bench* bench)
+{
+  assert(bench);
+  return bench->rb_path;
+}
+
+int
+main(int argc, char** argv)
+{
+  struct bench bench;
+  const char* json_path = NULL;
+  int opt = 0;
+  int err = 0;
+
+  memset(&bench, 0, sizeof(bench));
+  bench.nb_warmups = DEFAULT_NB_WARMUPS;
+  bench.nb_reps = DEFAULT_NB_REPS;
+
+  while((opt = getopt(argc, argv, "b:ho:r:w:")) != -1) {
+    switch(opt) {
+      case 'b': bench.rb_path = optarg; break;
+      case 'o': json_path = optarg; break;
+      case 'r': bench.nb_reps = (size_t)strtoul(optarg, NULL, 10); break;
+      case 'w': bench.nb_warmups = (size_t)strtoul(optarg, NULL, 10); break;
+      case 'h':
+        print_usage(argv[0]);
+        goto exit;
+      default:
+        print_usage(argv[0]);
+        goto error;
+    }
+  }
+  if(optind < argc)
+    bench.filter = argv[optind];
+  if(bench.nb_reps == 0) {
+    fprintf(stderr, "The number of repetitions must be positive.\n");
+    goto error;
+  }
+
+  bench.timings = malloc(bench.nb_reps * sizeof(int64_t));
+  if(!bench.timings) {
+    fprintf(stderr, "Not enough memory.\n");
+    goto error;
+  }
+  if(json_path) {
+    bench.json = fopen(json_path, "w");
+    if(!bench.json) {
+      fprintf(stderr, "Unable to open the JSON file `%s'.\n", json_path);
+      goto error;
+    }
+    fprintf(bench.json,
+      "{\n  \"warmups\": %zu,\n  \"reps\": %zu,\n  \"benchmarks\": [",
+      bench.nb_warmups, bench.nb_reps);
+  }
+
+  bench_stdlib(&bench);
+  bench_maths(&bench);
+  bench_resources(&bench);
+  bench_renderer(&bench);
+  bench_app(&bench);
+
+  if(bench.json)
+    fprintf(bench.json, "\n  ]\n}\n");
+
+exit:
+  if(bench.json)
+    fclose(bench.json);
+  free(bench.timings);
+  return err;
+
+error:
+  err = -1;
+  goto exit;
+}
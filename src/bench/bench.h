@@ -0,0 +1,49 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "sys/sys.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Abort the benchmarks if a setup or a measured call fails. */
+#define BENCH_CHECK(a, b) \
+  do { \
+    if((a) != (b)) { \
+      fprintf(stderr, "error:%s:%d\n", __FILE__, __LINE__); \
+      exit(-1); \
+    } \
+  } while(0)
+
+struct bench;
+
+/* One measured case. The run function is timed nb_warmups + nb_reps times;
+ * the optional setup and teardown functions are invoked around each run but
+ * are not timed. */
+struct bench_case {
+  const char* name;
+  size_t nb_items; /* Number of items processed by one run. */
+  void (*setup)(void* data); /* May be NULL. */
+  void (*run)(void* data);
+  void (*teardown)(void* data); /* May be NULL. */
+  void* data;
+};
+
+void
+bench_run
+  (struct bench* bench,
+   const struct bench_case* bcase);
+
+/* Path of the render backend library, or NULL if not defined. */
+const char*
+bench_render_backend
+  (const struct bench* bench);
+
+/* Entry points of the benchmark suites. */
+void bench_stdlib(struct bench* bench);
+void bench_maths(struct bench* bench);
+void bench_resources(struct bench* bench);
+void bench_renderer(struct bench* bench);
+void bench_app(struct bench* bench);
+
+#endif /* BENCH_H */
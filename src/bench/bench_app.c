@@ -0,0 +1,86 @@
+#include "app/core/app.h"
+#include "app/core/app_core.h"
+#include "app/core/app_model.h"
+#include "app/core/app_model_instance.h"
+#include "bench/bench.h"
+#include "sys/sys.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NB_INSTANCES 16384
+#define NB_CHAINS 64 /* Number of roots of the deep hierarchy. */
+
+struct app_data {
+  struct app* app;
+  struct app_model_instance** instances;
+  size_t nb_roots;
+};
+
+static void
+commit_transforms(void* data)
+{
+  struct app_data* adata = data;
+
+  BENCH_CHECK(app_translate_model_instances
+    (adata->instances, adata->nb_roots, false, (float[]){0.f, 1.e-3f, 0.f}),
+    APP_NO_ERROR);
+  BENCH_CHECK(app_commit_model_instance_transforms(adata->app),
+    APP_NO_ERROR);
+}
+
+void
+bench_app(struct bench* bench)
+{
+  struct app_args args = { NULL, NULL, NULL, NULL };
+  struct app_data data;
+  struct app* app = NULL;
+  struct app_model* model = NULL;
+  size_t i = 0;
+
+  args.render_driver = bench_render_backend(bench);
+  if(!args.render_driver) {
+    printf("app benchmarks skipped: no render backend.\n");
+    return;
+  }
+  BENCH_CHECK(app_init(&args, &app), APP_NO_ERROR);
+  data.app = app;
+  /* The model has no geometry. The benchmarks thus measure the propagation
+   * of the world transforms rather than the update of the render data. */
+  BENCH_CHECK(app_create_model(app, NULL, NULL, &model), APP_NO_ERROR);
+  data.instances = malloc(NB_INSTANCES * sizeof(struct app_model_instance*));
+  BENCH_CHECK(data.instances != NULL, 1);
+  BENCH_CHECK(app_instantiate_model_n
+    (app, model, NB_INSTANCES, NULL, NULL, data.instances), APP_NO_ERROR);
+
+  /* Wide hierarchy: one root and a single level of children. */
+  for(i = 1; i < NB_INSTANCES; ++i) {
+    BENCH_CHECK(app_set_model_instance_parent
+      (data.instances[i], data.instances[0]), APP_NO_ERROR);
+  }
+  data.nb_roots = 1;
+  BENCH_CHECK(app_commit_model_instance_transforms(app), APP_NO_ERROR);
+  bench_run(bench, &(struct bench_case){
+    "app_commit_wide_hierarchy", NB_INSTANCES, NULL, commit_transforms,
+    NULL, &data
+  });
+
+  /* Deep hierarchy: NB_CHAINS chains whose roots are the first instances. */
+  for(i = 0; i < NB_INSTANCES; ++i) {
+    BENCH_CHECK(app_set_model_instance_parent
+      (data.instances[i], i < NB_CHAINS ? NULL : data.instances[i-NB_CHAINS]),
+      APP_NO_ERROR);
+  }
+  data.nb_roots = NB_CHAINS;
+  BENCH_CHECK(app_commit_model_instance_transforms(app), APP_NO_ERROR);
+  bench_run(bench, &(struct bench_case){
+    "app_commit_deep_hierarchy", NB_INSTANCES, NULL, commit_transforms,
+    NULL, &data
+  });
+
+  for(i = 0; i < NB_INSTANCES; ++i)
+    BENCH_CHECK(app_remove_model_instance(data.instances[i]), APP_NO_ERROR);
+  free(data.instances);
+  BENCH_CHECK(app_model_ref_put(model), APP_NO_ERROR);
+  BENCH_CHECK(app_ref_put(app), APP_NO_ERROR);
+}
+
@@ -0,0 +1,100 @@
+#include "bench/bench.h"
+#include "maths/simd/aosf33.h"
+#include "maths/simd/aosf44.h"
+#include "maths/simd/soaf44.h"
+#include "sys/sys.h"
+#include <stdlib.h>
+
+#define NB_MATRICES 4096 /* Multiple of the SoA width. */
+
+struct maths_data {
+  struct aosf44* matrices;
+  struct aosf44* results;
+  float* lower;
+  float* upper;
+};
+
+static void
+aosf44_mulf44_run(void* data)
+{
+  struct maths_data* mdata = data;
+  size_t i = 0;
+  for(i = 0; i < NB_MATRICES; ++i) {
+    aosf44_mulf44(mdata->results + i,
+      mdata->matrices + i, mdata->matrices + (i + 1) % NB_MATRICES);
+  }
+}
+
+static void
+aosf44_inverse_run(void* data)
+{
+  struct maths_data* mdata = data;
+  size_t i = 0;
+  for(i = 0; i < NB_MATRICES; ++i)
+    aosf44_inverse(mdata->results + i, mdata->matrices + i);
+}
+
+static void
+aosf44_transform_boxes_run(void* data)
+{
+  struct maths_data* mdata = data;
+  aosf44_transform_boxes
+    ((const float*)mdata->matrices, mdata->lower, mdata->upper, NB_MATRICES,
+     (float*)mdata->results, (float*)mdata->results + NB_MATRICES * 3);
+}
+
+static void
+soaf44_inverse_run(void* data)
+{
+  struct maths_data* mdata = data;
+  struct soaf44 m;
+  size_t i = 0;
+  for(i = 0; i < NB_MATRICES; i += SOA_SIMD_WIDTH) {
+    soaf44_load_aos(&m, (const float*)(mdata->matrices + i));
+    soaf44_inverse(&m, &m);
+    soaf44_store_aos((float*)(mdata->results + i), &m);
+  }
+}
+
+void
+bench_maths(struct bench* bench)
+{
+  struct maths_data data;
+  struct aosf33 f33;
+  size_t i = 0;
+
+  data.matrices = malloc(NB_MATRICES * sizeof(struct aosf44));
+  data.results = malloc(NB_MATRICES * sizeof(struct aosf44));
+  data.lower = malloc(NB_MATRICES * 3 * sizeof(float));
+  data.upper = malloc(NB_MATRICES * 3 * sizeof(float));
+  BENCH_CHECK(data.matrices && data.results && data.lower && data.upper, 1);
+
+  for(i = 0; i < NB_MATRICES; ++i) {
+    const float f = (float)i;
+    aosf33_rotation(&f33, 0.01f * f, -0.02f * f, 0.03f * f);
+    aosf44_set(data.matrices + i, f33.c0, f33.c1, f33.c2,
+      vf4_set(f, -f, 2.f * f, 1.f));
+    data.lower[i*3 + 0] = data.lower[i*3 + 1] = data.lower[i*3 + 2] = -f;
+    data.upper[i*3 + 0] = data.upper[i*3 + 1] = data.upper[i*3 + 2] = f;
+  }
+
+  printf("simd kernels: %s\n", simd_isa_name(simd_get_isa()));
+  bench_run(bench, &(struct bench_case){
+    "aosf44_mulf44", NB_MATRICES, NULL, aosf44_mulf44_run, NULL, &data
+  });
+  bench_run(bench, &(struct bench_case){
+    "aosf44_inverse", NB_MATRICES, NULL, aosf44_inverse_run, NULL, &data
+  });
+  bench_run(bench, &(struct bench_case){
+    "soaf44_inverse", NB_MATRICES, NULL, soaf44_inverse_run, NULL, &data
+  });
+  bench_run(bench, &(struct bench_case){
+    "aosf44_transform_boxes", NB_MATRICES,
+    NULL, aosf44_transform_boxes_run, NULL, &data
+  });
+
+  free(data.matrices);
+  free(data.results);
+  free(data.lower);
+  free(data.upper);
+}
@@ -0,0 +1,151 @@
+#include "bench/bench.h"
+#include "renderer/rdr_frame.h"
+#include "renderer/rdr_material.h"
+#include "renderer/rdr_mesh.h"
+#include "renderer/rdr_model.h"
+#include "renderer/rdr_model_instance.h"
+#include "renderer/rdr_system.h"
+#include "renderer/rdr_world.h"
+#include "sys/sys.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NB_INSTANCES 4096
+#define FRAME_WIDTH 800
+#define FRAME_HEIGHT 600
+
+struct renderer_data {
+  struct rdr_frame* frame;
+  struct rdr_world* world;
+  struct rdr_view view;
+};
+
+static void
+draw_world(void* data)
+{
+  struct renderer_data* rdata = data;
+  BENCH_CHECK(rdr_frame_draw_world(rdata->frame, rdata->world, &rdata->view),
+    RDR_NO_ERROR);
+  BENCH_CHECK(rdr_flush_frame(rdata->frame), RDR_NO_ERROR);
+}
+
+void
+bench_renderer(struct bench* bench)
+{
+  const float vertices[] = {
+    0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 1.f, 0.f, 1.f, 1.f, 0.f
+  };
+  const unsigned int indices[] = { 0, 1, 2, 2, 1, 3 };
+  const struct rdr_mesh_attrib attr[] = {
+    { .usage = RDR_ATTRIB_POSITION, .type = RDR_FLOAT3 }
+  };
+  const char* sources[RDR_NB_SHADER_USAGES] = {
+    [RDR_VERTEX_SHADER] =
+      "#version 330\n"
+      "in vec3 rdr_position;\n"
+      "uniform mat4x4 rdr_modelview_proj;\n"
+      "void main()\n"
+      "{\n"
+      "  gl_Position = rdr_modelview_proj * vec4(rdr_position, 1.0);\n"
+      "}\n",
+    [RDR_GEOMETRY_SHADER] = NULL,
+    [RDR_FRAGMENT_SHADER] =
+      "#version 330\n"
+      "out vec4 color;\n"
+      "void main()\n"
+      "{\n"
+      "  color = vec4(1.0);\n"
+      "}\n"
+  };
+  const struct rdr_frame_desc frame_desc = { FRAME_WIDTH, FRAME_HEIGHT };
+  struct renderer_data data;
+  struct rdr_system* sys = NULL;
+  struct rdr_mesh* mesh = NULL;
+  struct rdr_material* mtr = NULL;
+  struct rdr_model* mdl = NULL;
+  struct rdr_model* wall_mdl = NULL;
+  struct rdr_model_instance* wall = NULL;
+  struct rdr_model_instance** instances = NULL;
+  const char* rb_path = bench_render_backend(bench);
+  size_t i = 0;
+
+  if(!rb_path) {
+    printf("renderer benchmarks skipped: no render backend.\n");
+    return;
+  }
+
+  BENCH_CHECK(rdr_create_system(rb_path, NULL, &sys), RDR_NO_ERROR);
+  BENCH_CHECK(rdr_create_mesh(sys, &mesh), RDR_NO_ERROR);
+  BENCH_CHECK(rdr_mesh_data(mesh, 1, attr, sizeof(vertices), vertices),
+    RDR_NO_ERROR);
+  BENCH_CHECK(rdr_mesh_indices(mesh, 6, indices), RDR_NO_ERROR);
+  BENCH_CHECK(rdr_create_material(sys, &mtr), RDR_NO_ERROR);
+  BENCH_CHECK(rdr_material_program(mtr, sources), RDR_NO_ERROR);
+  BENCH_CHECK(rdr_create_model(sys, mesh, mtr, &mdl), RDR_NO_ERROR);
+  BENCH_CHECK(rdr_create_model(sys, mesh, mtr, &wall_mdl), RDR_NO_ERROR);
+  BENCH_CHECK(rdr_model_occluder(wall_mdl, 4, vertices, 6, indices),
+    RDR_NO_ERROR);
+  BENCH_CHECK(rdr_create_world(sys, &data.world), RDR_NO_ERROR);
+  BENCH_CHECK(rdr_create_frame(sys, &frame_desc, &data.frame), RDR_NO_ERROR);
+
+  instances = calloc(NB_INSTANCES, sizeof(struct rdr_model_instance*));
+  BENCH_CHECK(instances != NULL, 1);
+  for(i = 0; i < NB_INSTANCES; ++i) {
+    const float pos[3] = {
+      (float)(i % 64) * 2.f, 0.f, -(float)(i / 64) * 2.f
+    };
+    BENCH_CHECK(rdr_create_model_instance(sys, mdl, instances + i),
+      RDR_NO_ERROR);
+    BENCH_CHECK(rdr_translate_model_instances(instances + i, 1, false, pos),
+      RDR_NO_ERROR);
+    BENCH_CHECK(rdr_add_model_instance(data.world, instances[i]),
+      RDR_NO_ERROR);
+  }
+
+  data.view = (struct rdr_view) {
+    .transform = {
+      1.f, 0.f, 0.f, 0.f,
+      0.f, 1.f, 0.f, 0.f,
+      0.f, 0.f, 1.f, 0.f,
+      -64.f, -10.f, -10.f, 1.f
+    },
+    .proj_ratio = (float)FRAME_WIDTH / (float)FRAME_HEIGHT,
+    .fov_x = 1.4f,
+    .znear = 1.f,
+    .zfar = 1000.f,
+    .x = 0,
+    .y = 0,
+    .width = FRAME_WIDTH,
+    .height = FRAME_HEIGHT
+  };
+  bench_run(bench, &(struct bench_case){
+    "rdr_draw_world", NB_INSTANCES, NULL, draw_world, NULL, &data
+  });
+  /* The wall hides the left half of the instances. */
+  BENCH_CHECK(rdr_create_model_instance(sys, wall_mdl, &wall), RDR_NO_ERROR);
+  BENCH_CHECK(rdr_scale_model_instances
+    (&wall, 1, false, (float[]){164.f, 10.5f, 1.f}), RDR_NO_ERROR);
+  BENCH_CHECK(rdr_translate_model_instances
+    (&wall, 1, false, (float[]){-100.f, -1.f, -3.f}), RDR_NO_ERROR);
+  BENCH_CHECK(rdr_add_model_instance(data.world, wall), RDR_NO_ERROR);
+  BENCH_CHECK(rdr_world_occlusion_culling(data.world, true), RDR_NO_ERROR);
+  bench_run(bench, &(struct bench_case){
+    "rdr_draw_world_culled", NB_INSTANCES, NULL, draw_world, NULL, &data
+  });
+
+  for(i = 0; i < NB_INSTANCES; ++i) {
+    BENCH_CHECK(rdr_remove_model_instance(data.world, instances[i]),
+      RDR_NO_ERROR);
+    BENCH_CHECK(rdr_model_instance_ref_put(instances[i]), RDR_NO_ERROR);
+  }
+  free(instances);
+  BENCH_CHECK(rdr_remove_model_instance(data.world, wall), RDR_NO_ERROR);
+  BENCH_CHECK(rdr_model_instance_ref_put(wall), RDR_NO_ERROR);
+  BENCH_CHECK(rdr_frame_ref_put(data.frame), RDR_NO_ERROR);
+  BENCH_CHECK(rdr_world_ref_put(data.world), RDR_NO_ERROR);
+  BENCH_CHECK(rdr_model_ref_put(wall_mdl), RDR_NO_ERROR);
+  BENCH_CHECK(rdr_model_ref_put(mdl), RDR_NO_ERROR);
+  BENCH_CHECK(rdr_material_ref_put(mtr), RDR_NO_ERROR);
+  BENCH_CHECK(rdr_mesh_ref_put(mesh), RDR_NO_ERROR);
+  BENCH_CHECK(rdr_system_ref_put(sys), RDR_NO_ERROR);
+}
@@ -0,0 +1,116 @@
+#include "bench/bench.h"
+#include "resources/rsrc_context.h"
+#include "resources/rsrc_geometry.h"
+#include "resources/rsrc_wavefront_obj.h"
+#include "sys/sys.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define GRID_SIZE 256 /* Number of quads per grid side. */
+#define NB_GRID_QUADS (GRID_SIZE * GRID_SIZE)
+
+struct resources_data {
+  struct rsrc_context* ctxt;
+  struct rsrc_wavefront_obj* wobj;
+  struct rsrc_geometry* geom;
+  char path[32];
+};
+
+/* Write a textured grid into a temporary OBJ file. */
+static void
+write_grid(struct resources_data* rdata)
+{
+  FILE* file = NULL;
+  int fd = 0;
+  int i = 0, j = 0;
+
+  snprintf(rdata->path, sizeof(rdata->path), "/tmp/bench_XXXXXX");
+  fd = mkstemp(rdata->path);
+  BENCH_CHECK(fd >= 0, 1);
+  file = fdopen(fd, "w");
+  BENCH_CHECK(file != NULL, 1);
+
+  fprintf(file, "g grid\n");
+  for(i = 0; i <= GRID_SIZE; ++i) {
+    for(j = 0; j <= GRID_SIZE; ++j) {
+      const float u = (float)j / (float)GRID_SIZE;
+      const float v = (float)i / (float)GRID_SIZE;
+      fprintf(file, "v %f %f %f\n", u, 0.1f * (float)((i + j) % 7), v);
+      fprintf(file, "vt %f %f\n", u, v);
+      fprintf(file, "vn 0 1 0\n");
+    }
+  }
+  for(i = 0; i < GRID_SIZE; ++i) {
+    for(j = 0; j < GRID_SIZE; ++j) {
+      const int a = i * (GRID_SIZE + 1) + j + 1;
+      const int b = a + 1;
+      const int c = b + GRID_SIZE + 1;
+      const int d = a + GRID_SIZE + 1;
+      fprintf(file, "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n",
+        a, a, a, b, b, b, c, c, c, d, d, d);
+    }
+  }
+  BENCH_CHECK(fclose(file), 0);
+}
+
+static void
+load_obj(void* data)
+{
+  struct resources_data* rdata = data;
+  BENCH_CHECK(rsrc_load_wavefront_obj(rdata->wobj, rdata->path),
+    RSRC_NO_ERROR);
+}
+
+static void
+build_geometry(void* data)
+{
+  struct resources_data* rdata = data;
+  BENCH_CHECK(rsrc_geometry_from_wavefront_obj(rdata->geom, rdata->wobj),
+    RSRC_NO_ERROR);
+}
+
+static void
+simplify_geometry(void* data)
+{
+  struct resources_data* rdata = data;
+  BENCH_CHECK(rsrc_simplify_geometry(rdata->geom, 0.25f, NULL),
+    RSRC_NO_ERROR);
+}
+
+static void
+clear_geometry(void* data)
+{
+  struct resources_data* rdata = data;
+  BENCH_CHECK(rsrc_clear_geometry(rdata->geom), RSRC_NO_ERROR);
+}
+
+void
+bench_resources(struct bench* bench)
+{
+  struct resources_data data;
+
+  write_grid(&data);
+  BENCH_CHECK(rsrc_create_context(NULL, &data.ctxt), RSRC_NO_ERROR);
+  BENCH_CHECK(rsrc_create_wavefront_obj(data.ctxt, &data.wobj),
+    RSRC_NO_ERROR);
+  BENCH_CHECK(rsrc_create_geometry(data.ctxt, &data.geom), RSRC_NO_ERROR);
+
+  bench_run(bench, &(struct bench_case){
+    "rsrc_load_wavefront_obj", NB_GRID_QUADS, NULL, load_obj, NULL, &data
+  });
+  load_obj(&data);
+  bench_run(bench, &(struct bench_case){
+    "rsrc_geometry_from_wavefront_obj", NB_GRID_QUADS,
+    NULL, build_geometry, clear_geometry, &data
+  });
+  bench_run(bench, &(struct bench_case){
+    "rsrc_simplify_geometry", NB_GRID_QUADS,
+    build_geometry, simplify_geometry, clear_geometry, &data
+  });
+
+  BENCH_CHECK(rsrc_geometry_ref_put(data.geom), RSRC_NO_ERROR);
+  BENCH_CHECK(rsrc_wavefront_obj_ref_put(data.wobj), RSRC_NO_ERROR);
+  BENCH_CHECK(rsrc_context_ref_put(data.ctxt), RSRC_NO_ERROR);
+  BENCH_CHECK(unlink(data.path), 0);
+}
@@ -0,0 +1,204 @@
+#include "bench/bench.h"
+#include "stdlib/sl_flat_set.h"
+#include "stdlib/sl_hash_table.h"
+#include "stdlib/sl_vector.h"
+#include "sys/sys.h"
+#include <stdbool.h>
+#include <stdlib.h>
+
+#define NB_HASH_ENTRIES 100000
+#define NB_SET_ENTRIES 10000
+#define NB_VECTOR_ENTRIES 1000000
+
+struct stdlib_data {
+  struct sl_hash_table* hash_table;
+  struct sl_flat_set* flat_set;
+  struct sl_vector* vector;
+  int* keys;
+  size_t nb_keys;
+};
+
+static bool
+eq_int(const void* a, const void* b)
+{
+  return *(const int*)a == *(const int*)b;
+}
+
+static size_t
+hash_int(const void* key)
+{
+  return sl_hash(key, sizeof(int));
+}
+
+static int
+cmp_int(const void* a, const void* b)
+{
+  const int i0 = *(const int*)a;
+  const int i1 = *(const int*)b;
+  return i0 < i1 ? -1 : (i0 > i1 ? 1 : 0);
+}
+
+static void
+setup_keys(struct stdlib_data* data, size_t nb_keys)
+{
+  size_t i = 0;
+  data->keys = malloc(nb_keys * sizeof(int));
+  BENCH_CHECK(data->keys != NULL, true);
+  /* Shuffled unique keys. */
+  for(i = 0; i < nb_keys; ++i)
+    data->keys[i] = (int)i;
+  srand(0);
+  for(i = nb_keys - 1; i > 0; --i) {
+    const size_t j = (size_t)rand() % (i + 1);
+    const int tmp = data->keys[i];
+    data->keys[i] = data->keys[j];
+    data->keys[j] = tmp;
+  }
+  data->nb_keys = nb_keys;
+}
+
+/*******************************************************************************
+ *
+ * Hash table.
+ *
+ ******************************************************************************/
+static void
+create_hash_table(void* data)
+{
+  struct stdlib_data* sdata = data;
+  BENCH_CHECK(sl_create_hash_table
+    (sizeof(int), ALIGNOF(int), sizeof(int), ALIGNOF(int), hash_int, eq_int,
+     NULL, &sdata->hash_table), SL_NO_ERROR);
+}
+
+static void
+free_hash_table(void* data)
+{
+  struct stdlib_data* sdata = data;
+  BENCH_CHECK(sl_free_hash_table(sdata->hash_table), SL_NO_ERROR);
+  sdata->hash_table = NULL;
+}
+
+static void
+fill_hash_table(void* data)
+{
+  struct stdlib_data* sdata = data;
+  size_t i = 0;
+  for(i = 0; i < sdata->nb_keys; ++i) {
+    BENCH_CHECK(sl_hash_table_insert
+      (sdata->hash_table, sdata->keys + i, sdata->keys + i), SL_NO_ERROR);
+  }
+}
+
+static void
+find_hash_table(void* data)
+{
+  struct stdlib_data* sdata = data;
+  void* ptr = NULL;
+  size_t i = 0;
+  for(i = 0; i < sdata->nb_keys; ++i) {
+    BENCH_CHECK(sl_hash_table_find
+      (sdata->hash_table, sdata->keys + i, &ptr), SL_NO_ERROR);
+    BENCH_CHECK(ptr != NULL, true);
+  }
+}
+
+/*******************************************************************************
+ *
+ * Flat set.
+ *
+ ******************************************************************************/
+static void
+create_flat_set(void* data)
+{
+  struct stdlib_data* sdata = data;
+  BENCH_CHECK(sl_create_flat_set
+    (sizeof(int), ALIGNOF(int), cmp_int, NULL, &sdata->flat_set),
+    SL_NO_ERROR);
+}
+
+static void
+free_flat_set(void* data)
+{
+  struct stdlib_data* sdata = data;
+  BENCH_CHECK(sl_free_flat_set(sdata->flat_set), SL_NO_ERROR);
+  sdata->flat_set = NULL;
+}
+
+static void
+fill_flat_set(void* data)
+{
+  struct stdlib_data* sdata = data;
+  size_t i = 0;
+  for(i = 0; i < sdata->nb_keys; ++i) {
+    BENCH_CHECK(sl_flat_set_insert
+      (sdata->flat_set, sdata->keys + i, NULL), SL_NO_ERROR);
+  }
+}
+
+/*******************************************************************************
+ *
+ * Vector.
+ *
+ ******************************************************************************/
+static void
+create_vector(void* data)
+{
+  struct stdlib_data* sdata = data;
+  BENCH_CHECK(sl_create_vector
+    (sizeof(int), ALIGNOF(int), NULL, &sdata->vector), SL_NO_ERROR);
+}
+
+static void
+free_vector(void* data)
+{
+  struct stdlib_data* sdata = data;
+  BENCH_CHECK(sl_free_vector(sdata->vector), SL_NO_ERROR);
+  sdata->vector = NULL;
+}
+
+static void
+grow_vector(void* data)
+{
+  struct stdlib_data* sdata = data;
+  int i = 0;
+  for(i = 0; i < NB_VECTOR_ENTRIES; ++i)
+    BENCH_CHECK(sl_vector_push_back(sdata->vector, &i), SL_NO_ERROR);
+}
+
+/*******************************************************************************
+ *
+ * Stdlib benchmarks.
+ *
+ ******************************************************************************/
+void
+bench_stdlib(struct bench* bench)
+{
+  struct stdlib_data data = { NULL, NULL, NULL, NULL, 0 };
+
+  setup_keys(&data, NB_HASH_ENTRIES);
+  bench_run(bench, &(struct bench_case){
+    "sl_hash_table_insert", NB_HASH_ENTRIES,
+    create_hash_table, fill_hash_table, free_hash_table, &data
+  });
+  create_hash_table(&data);
+  fill_hash_table(&data);
+  bench_run(bench, &(struct bench_case){
+    "sl_hash_table_find", NB_HASH_ENTRIES,
+    NULL, find_hash_table, NULL, &data
+  });
+  free_hash_table(&data);
+  free(data.keys);
+
+  setup_keys(&data, NB_SET_ENTRIES);
+  bench_run(bench, &(struct bench_case){
+    "sl_flat_set_insert", NB_SET_ENTRIES,
+    create_flat_set, fill_flat_set, free_flat_set, &data
+  });
+  free(data.keys);
+
+  bench_run(bench, &(struct bench_case){
+    "sl_vector_push_back", NB_VECTOR_ENTRIES,
+    create_vector, grow_vector, free_vector, &data
+  });
+}
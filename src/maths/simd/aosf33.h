@@ -232,13 +232,17 @@ aosf33_col(const struct aosf33* m, int id)
 static FINLINE void
 aosf33_rotation(struct aosf33* res, float pitch, float yaw, float roll)
 {
-  /* XYZ norm. */
-  const float c1 = cosf(pitch);
-  const float c2 = cosf(yaw);
-  const float c3 = cosf(roll);
-  const float s1 = sinf(pitch);
-  const float s2 = sinf(yaw);
-  const float s3 = sinf(roll);
+  vf4_t s, c;
+  float c1, c2, c3, s1, s2, s3;
+
+  /* XYZ norm. The sines and cosines of the 3 angles are evaluated at once. */
+  vf4_sincos(vf4_set(pitch, yaw, roll, 0.f), &s, &c);
+  c1 = vf4_x(c);
+  c2 = vf4_y(c);
+  c3 = vf4_z(c);
+  s1 = vf4_x(s);
+  s2 = vf4_y(s);
+  s3 = vf4_z(s);
   res->c0 = vf4_set(c2*c3, c1*s3 + c3*s1*s2, s1*s3 - c1*c3*s2, 0.f);
   res->c1 = vf4_set(-c2*s3, c1*c3 - s1*s2*s3, c1*s2*s3 + c3*s1, 0.f);
   res->c2 = vf4_set(s2, -c2*s1, c1*c2, 0.f);
@@ -247,11 +251,11 @@ aosf33_rotation(struct aosf33* res, float pitch, float yaw, float roll)
 static FINLINE void /* rotation around the Y axis */
 aosf33_yaw_rotation(struct aosf33* res, float yaw)
 {
-  const float c = cosf(yaw);
-  const float s = sinf(yaw);
-  res->c0 = vf4_set(c, 0.f, -s, 0.f);
+  vf4_t s, c;
+  vf4_sincos(vf4_set1(yaw), &s, &c);
+  res->c0 = vf4_set(vf4_x(c), 0.f, -vf4_x(s), 0.f);
   res->c1 = vf4_set(0.f, 1.f, 0.f, 0.f);
-  res->c2 = vf4_set(s, 0.f, c, 0.f);
+  res->c2 = vf4_set(vf4_x(s), 0.f, vf4_x(c), 0.f);
 }
 
 #endif /* AOSF33_H */
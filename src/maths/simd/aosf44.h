@@ -285,6 +285,27 @@ aosf44_det(const struct aosf44* m)
 
 SIMD_API vf4_t aosf44_inverse(struct aosf44* out, const struct aosf44* in);
 
+/* Transform count points { x, y, z } by the affine matrix m. dst may be equal
+ * to src. */
+SIMD_API void
+aosf44_transform_points
+  (const struct aosf44* m,
+   const float* src,
+   size_t count,
+   float* dst);
+
+/* Compute the axis aligned bounding boxes of count boxes transformed by their
+ * own column major affine matrix, e.g. the world space bounds of a list of
+ * instances. The output arrays may be equal to the input ones. */
+SIMD_API void
+aosf44_transform_boxes
+  (const float* transforms, /* count * 16 floats. */
+   const float* lower, /* count * 3 floats. */
+   const float* upper, /* count * 3 floats. */
+   size_t count,
+   float* res_lower,
+   float* res_upper);
+
 static FINLINE vf4_t
 aosf44_invtrans(struct aosf44* out, const struct aosf44* a)
 {
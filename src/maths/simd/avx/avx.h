@@ -0,0 +1,252 @@
+#ifndef SIMD_AVX_H
+#define SIMD_AVX_H
+
+#include "maths/simd/sse/sse.h"
+#include "sys/sys.h"
+#include <assert.h>
+#include <immintrin.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Only the lane-wise operations are provided: the 8 wide registers are used by
+ * the SoA data structures, which never shuffle across lanes. */
+typedef __m256 vf8_t;
+
+/* Set operations. */
+static FINLINE void
+vf8_store(float dst[8], vf8_t v)
+{
+  assert(IS_ALIGNED(dst, 32));
+  _mm256_store_ps(dst, v);
+}
+
+static FINLINE vf8_t
+vf8_load(const float src[8])
+{
+  assert(IS_ALIGNED(src, 32));
+  return _mm256_load_ps(src);
+}
+
+static FINLINE vf8_t
+vf8_set1(float x)
+{
+  return _mm256_set1_ps(x);
+}
+
+static FINLINE vf8_t
+vf8_zero(void)
+{
+  return _mm256_setzero_ps();
+}
+
+static FINLINE vf8_t
+vf8_true(void)
+{
+  const union { float f; int i; } mask = { .i = 0xFFFFFFFF };
+  return vf8_set1(mask.f);
+}
+
+/* Bitwise operations. */
+static FINLINE vf8_t
+vf8_or(vf8_t v0, vf8_t v1)
+{
+  return _mm256_or_ps(v0, v1);
+}
+
+static FINLINE vf8_t
+vf8_and(vf8_t v0, vf8_t v1)
+{
+  return _mm256_and_ps(v0, v1);
+}
+
+static FINLINE vf8_t
+vf8_xor(vf8_t v0, vf8_t v1)
+{
+  return _mm256_xor_ps(v0, v1);
+}
+
+static FINLINE vf8_t
+vf8_sel(vf8_t vfalse, vf8_t vtrue, vf8_t vcond)
+{
+  return _mm256_blendv_ps(vfalse, vtrue, vcond);
+}
+
+/* Arithmetic operations. */
+static FINLINE vf8_t
+vf8_minus(vf8_t v)
+{
+  return vf8_xor(vf8_set1(-0.f), v);
+}
+
+static FINLINE vf8_t
+vf8_add(vf8_t v0, vf8_t v1)
+{
+  return _mm256_add_ps(v0, v1);
+}
+
+static FINLINE vf8_t
+vf8_sub(vf8_t v0, vf8_t v1)
+{
+  return _mm256_sub_ps(v0, v1);
+}
+
+static FINLINE vf8_t
+vf8_mul(vf8_t v0, vf8_t v1)
+{
+  return _mm256_mul_ps(v0, v1);
+}
+
+static FINLINE vf8_t
+vf8_div(vf8_t v0, vf8_t v1)
+{
+  return _mm256_div_ps(v0, v1);
+}
+
+static FINLINE vf8_t
+vf8_madd(vf8_t v0, vf8_t v1, vf8_t v2)
+{
+#ifdef __FMA__
+  return _mm256_fmadd_ps(v0, v1, v2);
+#else
+  return _mm256_add_ps(_mm256_mul_ps(v0, v1), v2);
+#endif
+}
+
+static FINLINE vf8_t
+vf8_abs(vf8_t v)
+{
+  const union { float f; int32_t i; } mask = { .i = 0x7fffffff };
+  return vf8_and(v, vf8_set1(mask.f));
+}
+
+static FINLINE vf8_t
+vf8_sqrt(vf8_t v)
+{
+  return _mm256_sqrt_ps(v);
+}
+
+static FINLINE vf8_t
+vf8_rsqrte(vf8_t v)
+{
+  return _mm256_rsqrt_ps(v);
+}
+
+static FINLINE vf8_t
+vf8_rsqrt(vf8_t v)
+{
+  const vf8_t y = vf8_rsqrte(v);
+  const vf8_t yyv = vf8_mul(vf8_mul(y, y), v);
+  const vf8_t tmp = vf8_sub(vf8_set1(1.5f), vf8_mul(yyv, vf8_set1(0.5f)));
+  return vf8_mul(tmp, y);
+}
+
+static FINLINE vf8_t
+vf8_rcpe(vf8_t v)
+{
+  return _mm256_rcp_ps(v);
+}
+
+static FINLINE vf8_t
+vf8_rcp(vf8_t v)
+{
+  const vf8_t y = vf8_rcpe(v);
+  const vf8_t tmp = vf8_sub(vf8_set1(2.f), vf8_mul(y, v));
+  return vf8_mul(tmp, y);
+}
+
+static FINLINE vf8_t
+vf8_lerp(vf8_t from, vf8_t to, vf8_t param)
+{
+  return vf8_madd(vf8_sub(to, from), param, from);
+}
+
+/* Trigonometric operations. Evaluated per 4 wide halves with the SSE
+ * functions, that share their accuracy. */
+static FINLINE void
+vf8_sincos(vf8_t v, vf8_t* restrict s, vf8_t* restrict c)
+{
+  vf4_t s0, s1, c0, c1;
+  vf4_sincos(_mm256_castps256_ps128(v), &s0, &c0);
+  vf4_sincos(_mm256_extractf128_ps(v, 1), &s1, &c1);
+  *s = _mm256_insertf128_ps(_mm256_castps128_ps256(s0), s1, 1);
+  *c = _mm256_insertf128_ps(_mm256_castps128_ps256(c0), c1, 1);
+}
+
+static FINLINE vf8_t
+vf8_sin(vf8_t v)
+{
+  const vf4_t s0 = vf4_sin(_mm256_castps256_ps128(v));
+  const vf4_t s1 = vf4_sin(_mm256_extractf128_ps(v, 1));
+  return _mm256_insertf128_ps(_mm256_castps128_ps256(s0), s1, 1);
+}
+
+static FINLINE vf8_t
+vf8_cos(vf8_t v)
+{
+  const vf4_t c0 = vf4_cos(_mm256_castps256_ps128(v));
+  const vf4_t c1 = vf4_cos(_mm256_extractf128_ps(v, 1));
+  return _mm256_insertf128_ps(_mm256_castps128_ps256(c0), c1, 1);
+}
+
+/* Comparators. */
+static FINLINE vf8_t
+vf8_eq(vf8_t v0, vf8_t v1)
+{
+  return _mm256_cmp_ps(v0, v1, _CMP_EQ_OQ);
+}
+
+static FINLINE vf8_t
+vf8_neq(vf8_t v0, vf8_t v1)
+{
+  return _mm256_cmp_ps(v0, v1, _CMP_NEQ_UQ);
+}
+
+static FINLINE vf8_t
+vf8_ge(vf8_t v0, vf8_t v1)
+{
+  return _mm256_cmp_ps(v0, v1, _CMP_GE_OS);
+}
+
+static FINLINE vf8_t
+vf8_le(vf8_t v0, vf8_t v1)
+{
+  return _mm256_cmp_ps(v0, v1, _CMP_LE_OS);
+}
+
+static FINLINE vf8_t
+vf8_gt(vf8_t v0, vf8_t v1)
+{
+  return _mm256_cmp_ps(v0, v1, _CMP_GT_OS);
+}
+
+static FINLINE vf8_t
+vf8_lt(vf8_t v0, vf8_t v1)
+{
+  return _mm256_cmp_ps(v0, v1, _CMP_LT_OS);
+}
+
+static FINLINE vf8_t
+vf8_eq_eps(vf8_t v0, vf8_t v1, vf8_t eps)
+{
+  return vf8_lt(vf8_abs(vf8_sub(v0, v1)), eps);
+}
+
+static FINLINE vf8_t
+vf8_min(vf8_t v0, vf8_t v1)
+{
+  return _mm256_min_ps(v0, v1);
+}
+
+static FINLINE vf8_t
+vf8_max(vf8_t v0, vf8_t v1)
+{
+  return _mm256_max_ps(v0, v1);
+}
+
+static FINLINE int
+vf8_movemask(vf8_t v)
+{
+  return _mm256_movemask_ps(v);
+}
+
+#endif /* SIMD_AVX_H */
@@ -0,0 +1,4 @@
+/* Kernels compiled with -mavx2 -mfma. They are invoked only if the host CPU
+ * supports these instruction sets. */
+#define KERNEL(name) CONCAT(name, _avx2)
+#include "maths/simd/regular/simd_kernels.h"
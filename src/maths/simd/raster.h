@@ -0,0 +1,56 @@
+#ifndef RASTER_H
+#define RASTER_H
+
+#include "maths/simd/simd.h"
+#include <stdbool.h>
+
+/* Tiled depth buffer of a software rasterizer, e.g. the occlusion culling of
+ * the renderer. The pixels are stored tile by tile, each tile being row major.
+ * A pixel stores the reciprocal of the clip space w of its nearest triangle,
+ * i.e. larger is nearer and 0 is an empty pixel. The tile width is a multiple
+ * of the widest SIMD width and the tiles must be aligned on RASTER_ALIGNMENT
+ * bytes. Like the aosf44 out of line functions, the raster functions use the
+ * instruction set selected at load time. */
+#define RASTER_TILE_WIDTH 8
+#define RASTER_TILE_HEIGHT 8
+#define RASTER_TILE_SIZE (RASTER_TILE_WIDTH * RASTER_TILE_HEIGHT)
+#define RASTER_ALIGNMENT 32
+
+/* Screen space triangle. The edge functions a*x + b*y + c are positive on the
+ * inner side of the edges and the depth is the a*x + b*y + c plane. */
+struct raster_triangle {
+  float edges[3][3];
+  float depth[3];
+};
+
+/* Keep the nearest of the pixel and the triangle depths for the pixels of the
+ * [row_begin, row_end) rows of the tile whose center lies in the triangle. The
+ * tile origin and the rows are in pixels. */
+SIMD_API void
+raster_draw_tile
+  (float* tile,
+   int x,
+   int y,
+   int row_begin,
+   int row_end,
+   const struct raster_triangle* triangle);
+
+/* Return true if a pixel of the tile, in the [x0, x1) columns and the
+ * [row_begin, row_end) rows, is farther than depth. */
+SIMD_API bool
+raster_test_tile
+  (const float* tile,
+   int x,
+   int y,
+   int x0,
+   int x1,
+   int row_begin,
+   int row_end,
+   float depth);
+
+/* Return the farthest depth of the tile pixels. */
+SIMD_API float
+raster_tile_depth
+  (const float* tile);
+
+#endif /* RASTER_H */
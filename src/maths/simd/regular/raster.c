@@ -0,0 +1,36 @@
+#include "maths/simd/raster.h"
+#include "maths/simd/regular/simd_kernels_c.h"
+#include "sys/sys.h"
+
+void
+raster_draw_tile
+  (float* tile,
+   int x,
+   int y,
+   int row_begin,
+   int row_end,
+   const struct raster_triangle* triangle)
+{
+  simd_kernels.raster_draw_tile(tile, x, y, row_begin, row_end, triangle);
+}
+
+bool
+raster_test_tile
+  (const float* tile,
+   int x,
+   int y,
+   int x0,
+   int x1,
+   int row_begin,
+   int row_end,
+   float depth)
+{
+  return simd_kernels.raster_test_tile
+    (tile, x, y, x0, x1, row_begin, row_end, depth);
+}
+
+float
+raster_tile_depth(const float* tile)
+{
+  return simd_kernels.raster_tile_depth(tile);
+}
@@ -0,0 +1,52 @@
+#include "maths/simd/simd.h"
+#include "maths/simd/regular/simd_kernels_c.h"
+#include "sys/sys.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define SIMD_KERNELS(isa) { \
+  aosf44_inverse_##isa, \
+  aosf44_transform_points_##isa, \
+  aosf44_transform_boxes_##isa, \
+  raster_draw_tile_##isa, \
+  raster_test_tile_##isa, \
+  raster_tile_depth_##isa \
+}
+
+static enum simd_isa simd_isa = SIMD_ISA_SSE3;
+
+/* Initialised with the SSE3 kernels that run on any supported host. */
+struct simd_kernels simd_kernels = SIMD_KERNELS(sse3);
+
+/* The FOO_SIMD_ISA environment variable may force the SSE3 kernels, e.g. to
+ * compare the instruction sets on a same host. */
+static void __attribute__((constructor))
+select_kernels(void)
+{
+  const char* env = getenv("FOO_SIMD_ISA");
+  if(env && !strcmp(env, "sse3"))
+    return;
+
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+    const struct simd_kernels avx2 = SIMD_KERNELS(avx2);
+    simd_kernels = avx2;
+    simd_isa = SIMD_ISA_AVX2_FMA;
+  }
+}
+
+enum simd_isa
+simd_get_isa(void)
+{
+  return simd_isa;
+}
+
+const char*
+simd_isa_name(enum simd_isa isa)
+{
+  switch(isa) {
+    case SIMD_ISA_SSE3: return "SSE3";
+    case SIMD_ISA_AVX2_FMA: return "AVX2/FMA";
+    default: return "unknown";
+  }
+}
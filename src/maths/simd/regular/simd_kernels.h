@@ -0,0 +1,292 @@
+/* Template of the out of line kernels of the simd library. It is compiled
+ * once per instruction set by a unit that defines the KERNEL(name) macro and
+ * that is built with the compilation flags of this instruction set. */
+#ifndef KERNEL
+  #error "The KERNEL macro is not defined"
+#endif
+
+#include "maths/simd/aosf44.h"
+#include "maths/simd/raster.h"
+#include "maths/simd/regular/simd_kernels_c.h"
+#include "maths/simd/soaf3.h"
+#include "maths/simd/soaf44.h"
+#include "sys/math.h"
+#include "sys/sys.h"
+#include <assert.h>
+#include <float.h>
+#include <string.h>
+
+vf4_t
+KERNEL(aosf44_inverse)(struct aosf44* res, const struct aosf44* m)
+{
+  /* Retrieve the columns 0, 1, 2 and 3 and the row 3 of the "m" matrix. */
+  const vf4_t c0 = m->c0;
+  const vf4_t c1 = m->c1;
+  const vf4_t c2 = m->c2;
+  const vf4_t c3 = m->c3;
+  const vf4_t r3 = aosf44_row3(m);
+
+  /* Define the 3x3 sub-matrix and compute their determinant */
+  const struct aosf33 f33_012_012 = { c0, c1, c2 };
+  const struct aosf33 f33_012_013 = { c0, c1, c3 };
+  const struct aosf33 f33_012_023 = { c0, c2, c3 };
+  const struct aosf33 f33_012_123 = { c1, c2, c3 };
+  const vf4_t det_012 = vf4_048C
+    (aosf33_det(&f33_012_123),
+     aosf33_det(&f33_012_023),
+     aosf33_det(&f33_012_013),
+     aosf33_det(&f33_012_012));
+
+  const vf4_t f33_023_c0 = vf4_xzww(c0);
+  const vf4_t f33_023_c1 = vf4_xzww(c1);
+  const vf4_t f33_023_c2 = vf4_xzww(c2);
+  const vf4_t f33_023_c3 = vf4_xzww(c3);
+  const struct aosf33 f33_023_012 = { f33_023_c0, f33_023_c1, f33_023_c2 };
+  const struct aosf33 f33_023_013 = { f33_023_c0, f33_023_c1, f33_023_c3 };
+  const struct aosf33 f33_023_023 = { f33_023_c0, f33_023_c2, f33_023_c3 };
+  const struct aosf33 f33_023_123 = { f33_023_c1, f33_023_c2, f33_023_c3 };
+  const vf4_t det_023 = vf4_048C
+    (aosf33_det(&f33_023_123),
+     aosf33_det(&f33_023_023),
+     aosf33_det(&f33_023_013),
+     aosf33_det(&f33_023_012));
+
+  const vf4_t f33_123_c0 = vf4_yzww(c0);
+  const vf4_t f33_123_c1 = vf4_yzww(c1);
+  const vf4_t f33_123_c2 = vf4_yzww(c2);
+  const vf4_t f33_123_c3 = vf4_yzww(c3);
+  const struct aosf33 f33_123_012 = { f33_123_c0, f33_123_c1, f33_123_c2 };
+  const struct aosf33 f33_123_013 = { f33_123_c0, f33_123_c1, f33_123_c3 };
+  const struct aosf33 f33_123_023 = { f33_123_c0, f33_123_c2, f33_123_c3 };
+  const struct aosf33 f33_123_123 = { f33_123_c1, f33_123_c2, f33_123_c3 };
+  const vf4_t det_123 = vf4_048C
+    (aosf33_det(&f33_123_123),
+     aosf33_det(&f33_123_023),
+     aosf33_det(&f33_123_013),
+     aosf33_det(&f33_123_012));
+
+  const vf4_t f33_013_c0 = vf4_xyww(c0);
+  const vf4_t f33_013_c1 = vf4_xyww(c1);
+  const vf4_t f33_013_c2 = vf4_xyww(c2);
+  const vf4_t f33_013_c3 = vf4_xyww(c3);
+  const struct aosf33 f33_013_012 = { f33_013_c0, f33_013_c1, f33_013_c2 };
+  const struct aosf33 f33_013_013 = { f33_013_c0, f33_013_c1, f33_013_c3 };
+  const struct aosf33 f33_013_023 = { f33_013_c0, f33_013_c2, f33_013_c3 };
+  const struct aosf33 f33_013_123 = { f33_013_c1, f33_013_c2, f33_013_c3 };
+  const vf4_t det_013 = vf4_048C
+    (aosf33_det(&f33_013_123),
+     aosf33_det(&f33_013_023),
+     aosf33_det(&f33_013_013),
+     aosf33_det(&f33_013_012));
+
+  /* Compute the cofactors of the column 3 */
+  const vf4_t cofacts = vf4_mul(det_012, vf4_set(-1.f, 1.f, -1.f, 1.f));
+
+  /* Compute the determinant of the "m" matrix */
+  const vf4_t det = vf4_dot(cofacts, r3);
+
+  /* Invert the matrix */
+  const vf4_t idet = vf4_rcp(det);
+  const vf4_t mpmp_idet = vf4_mul(idet, vf4_set(-1.f, 1.f, -1.f, 1.f));
+  const vf4_t pmpm_idet = vf4_mul(idet, vf4_set(1.f, -1.f, 1.f, -1.f));
+  res->c0 = vf4_mul(det_123, pmpm_idet);
+  res->c1 = vf4_mul(det_023, mpmp_idet);
+  res->c2 = vf4_mul(det_013, pmpm_idet);
+  res->c3 = vf4_mul(det_012, mpmp_idet);
+
+  return det;
+}
+
+
+void
+KERNEL(aosf44_transform_points)
+  (const struct aosf44* m,
+   const float* src,
+   size_t count,
+   float* dst)
+{
+  ALIGN(16) float tmp[16];
+  float pad[SOA_SIMD_WIDTH * 3];
+  struct soaf44 m44;
+  struct soaf3 p;
+  size_t i = 0;
+  size_t nb_remaining = 0;
+  assert(m && (src || !count) && (dst || !count));
+
+  aosf44_store(tmp, m);
+  soaf4_splat(&m44.c0, tmp[0], tmp[1], tmp[2], tmp[3]);
+  soaf4_splat(&m44.c1, tmp[4], tmp[5], tmp[6], tmp[7]);
+  soaf4_splat(&m44.c2, tmp[8], tmp[9], tmp[10], tmp[11]);
+  soaf4_splat(&m44.c3, tmp[12], tmp[13], tmp[14], tmp[15]);
+
+  for(i = 0; i + SOA_SIMD_WIDTH <= count; i += SOA_SIMD_WIDTH) {
+    soaf3_load_aos(&p, src + i * 3);
+    soaf44_transform_point(&p, &m44, &p);
+    soaf3_store_aos(dst + i * 3, &p);
+  }
+  nb_remaining = count - i;
+  if(nb_remaining) {
+    memset(pad, 0, sizeof(pad));
+    memcpy(pad, src + i * 3, nb_remaining * 3 * sizeof(float));
+    soaf3_load_aos(&p, pad);
+    soaf44_transform_point(&p, &m44, &p);
+    soaf3_store_aos(pad, &p);
+    memcpy(dst + i * 3, pad, nb_remaining * 3 * sizeof(float));
+  }
+}
+
+void
+KERNEL(aosf44_transform_boxes)
+  (const float* transforms,
+   const float* lower,
+   const float* upper,
+   size_t count,
+   float* res_lower,
+   float* res_upper)
+{
+  float pad_transforms[SOA_SIMD_WIDTH * 16];
+  float pad_lower[SOA_SIMD_WIDTH * 3];
+  float pad_upper[SOA_SIMD_WIDTH * 3];
+  struct soaf44 m44;
+  struct soaf3 l, u;
+  size_t i = 0;
+  size_t nb_remaining = 0;
+  assert((transforms && lower && upper && res_lower && res_upper) || !count);
+
+  for(i = 0; i + SOA_SIMD_WIDTH <= count; i += SOA_SIMD_WIDTH) {
+    soaf44_load_aos(&m44, transforms + i * 16);
+    soaf3_load_aos(&l, lower + i * 3);
+    soaf3_load_aos(&u, upper + i * 3);
+    soaf44_transform_box(&l, &u, &m44, &l, &u);
+    soaf3_store_aos(res_lower + i * 3, &l);
+    soaf3_store_aos(res_upper + i * 3, &u);
+  }
+  nb_remaining = count - i;
+  if(nb_remaining) {
+    memset(pad_transforms, 0, sizeof(pad_transforms));
+    memset(pad_lower, 0, sizeof(pad_lower));
+    memset(pad_upper, 0, sizeof(pad_upper));
+    memcpy(pad_transforms, transforms + i * 16,
+      nb_remaining * 16 * sizeof(float));
+    memcpy(pad_lower, lower + i * 3, nb_remaining * 3 * sizeof(float));
+    memcpy(pad_upper, upper + i * 3, nb_remaining * 3 * sizeof(float));
+    soaf44_load_aos(&m44, pad_transforms);
+    soaf3_load_aos(&l, pad_lower);
+    soaf3_load_aos(&u, pad_upper);
+    soaf44_transform_box(&l, &u, &m44, &l, &u);
+    soaf3_store_aos(pad_lower, &l);
+    soaf3_store_aos(pad_upper, &u);
+    memcpy(res_lower + i * 3, pad_lower, nb_remaining * 3 * sizeof(float));
+    memcpy(res_upper + i * 3, pad_upper, nb_remaining * 3 * sizeof(float));
+  }
+}
+
+/* Offsets of the pixel centers of the SIMD lanes. */
+static FINLINE soaf_t
+lane_offsets(void)
+{
+  ALIGN(SOA_SIMD_ALIGNMENT) float offsets[SOA_SIMD_WIDTH];
+  int i = 0;
+  for(i = 0; i < SOA_SIMD_WIDTH; ++i)
+    offsets[i] = (float)i + 0.5f;
+  return soaf_load(offsets);
+}
+
+void
+KERNEL(raster_draw_tile)
+  (float* tile,
+   int x,
+   int y,
+   int row_begin,
+   int row_end,
+   const struct raster_triangle* tri)
+{
+  const soaf_t offsets = lane_offsets();
+  const soaf_t zero = soaf_zero();
+  const soaf_t a01 = soaf_set1(tri->edges[0][0]);
+  const soaf_t a12 = soaf_set1(tri->edges[1][0]);
+  const soaf_t a20 = soaf_set1(tri->edges[2][0]);
+  const soaf_t az = soaf_set1(tri->depth[0]);
+  int row = 0;
+  int i = 0;
+  assert(tile && tri && IS_ALIGNED(tile, RASTER_ALIGNMENT));
+  assert(y <= row_begin && row_end <= y + RASTER_TILE_HEIGHT);
+  STATIC_ASSERT
+    (RASTER_TILE_WIDTH % SOA_SIMD_WIDTH == 0, Unexpected_tile_width);
+
+  for(row = row_begin; row < row_end; ++row) {
+    const float py = (float)row + 0.5f;
+    const soaf_t b01 = soaf_set1(tri->edges[0][1] * py + tri->edges[0][2]);
+    const soaf_t b12 = soaf_set1(tri->edges[1][1] * py + tri->edges[1][2]);
+    const soaf_t b20 = soaf_set1(tri->edges[2][1] * py + tri->edges[2][2]);
+    const soaf_t bz = soaf_set1(tri->depth[1] * py + tri->depth[2]);
+    float* pixels = tile + (row - y) * RASTER_TILE_WIDTH;
+    for(i = 0; i < RASTER_TILE_WIDTH; i += SOA_SIMD_WIDTH) {
+      const soaf_t px = soaf_add(soaf_set1((float)(x + i)), offsets);
+      const soaf_t w01 = soaf_madd(a01, px, b01);
+      const soaf_t w12 = soaf_madd(a12, px, b12);
+      const soaf_t w20 = soaf_madd(a20, px, b20);
+      const soaf_t mask = soaf_and
+        (soaf_and(soaf_ge(w01, zero), soaf_ge(w12, zero)),
+         soaf_ge(w20, zero));
+      soaf_t depth;
+      if(!soaf_movemask(mask))
+        continue;
+      depth = soaf_load(pixels + i);
+      depth = soaf_sel(depth, soaf_max(depth, soaf_madd(az, px, bz)), mask);
+      soaf_store(pixels + i, depth);
+    }
+  }
+}
+
+bool
+KERNEL(raster_test_tile)
+  (const float* tile,
+   int x,
+   int y,
+   int x0,
+   int x1,
+   int row_begin,
+   int row_end,
+   float depth)
+{
+  const soaf_t offsets = lane_offsets();
+  const soaf_t vx0 = soaf_set1((float)x0);
+  const soaf_t vx1 = soaf_set1((float)x1);
+  const soaf_t vz = soaf_set1(depth);
+  int row = 0;
+  int i = 0;
+  assert(tile && IS_ALIGNED(tile, RASTER_ALIGNMENT));
+  assert(y <= row_begin && row_end <= y + RASTER_TILE_HEIGHT);
+
+  for(row = row_begin; row < row_end; ++row) {
+    const float* pixels = tile + (row - y) * RASTER_TILE_WIDTH;
+    for(i = 0; i < RASTER_TILE_WIDTH; i += SOA_SIMD_WIDTH) {
+      const soaf_t px = soaf_add(soaf_set1((float)(x + i)), offsets);
+      const soaf_t mask = soaf_and
+        (soaf_and(soaf_gt(px, vx0), soaf_lt(px, vx1)),
+         soaf_le(soaf_load(pixels + i), vz));
+      if(soaf_movemask(mask))
+        return true;
+    }
+  }
+  return false;
+}
+
+float
+KERNEL(raster_tile_depth)(const float* tile)
+{
+  ALIGN(SOA_SIMD_ALIGNMENT) float lanes[SOA_SIMD_WIDTH];
+  soaf_t depth;
+  float tile_depth = FLT_MAX;
+  int i = 0;
+  assert(tile && IS_ALIGNED(tile, RASTER_ALIGNMENT));
+
+  depth = soaf_load(tile);
+  for(i = SOA_SIMD_WIDTH; i < RASTER_TILE_SIZE; i += SOA_SIMD_WIDTH)
+    depth = soaf_min(depth, soaf_load(tile + i));
+  soaf_store(lanes, depth);
+  for(i = 0; i < SOA_SIMD_WIDTH; ++i)
+    tile_depth = MIN(tile_depth, lanes[i]);
+  return tile_depth;
+}
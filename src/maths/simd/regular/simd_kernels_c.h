@@ -0,0 +1,72 @@
+#ifndef SIMD_KERNELS_C_H
+#define SIMD_KERNELS_C_H
+
+#include "maths/simd/simd.h"
+#include "sys/sys.h"
+#include <stdbool.h>
+
+struct aosf44;
+struct raster_triangle;
+
+/* Declare the kernels compiled for the instruction set isa. */
+#define SIMD_DECLARE_KERNELS(isa) \
+  LOCAL_SYM vf4_t \
+  aosf44_inverse_##isa \
+    (struct aosf44* res, \
+     const struct aosf44* m); \
+  LOCAL_SYM void \
+  aosf44_transform_points_##isa \
+    (const struct aosf44* m, \
+     const float* src, \
+     size_t count, \
+     float* dst); \
+  LOCAL_SYM void \
+  aosf44_transform_boxes_##isa \
+    (const float* transforms, \
+     const float* lower, \
+     const float* upper, \
+     size_t count, \
+     float* res_lower, \
+     float* res_upper); \
+  LOCAL_SYM void \
+  raster_draw_tile_##isa \
+    (float* tile, \
+     int x, \
+     int y, \
+     int row_begin, \
+     int row_end, \
+     const struct raster_triangle* triangle); \
+  LOCAL_SYM bool \
+  raster_test_tile_##isa \
+    (const float* tile, \
+     int x, \
+     int y, \
+     int x0, \
+     int x1, \
+     int row_begin, \
+     int row_end, \
+     float depth); \
+  LOCAL_SYM float \
+  raster_tile_depth_##isa \
+    (const float* tile)
+
+SIMD_DECLARE_KERNELS(sse3);
+SIMD_DECLARE_KERNELS(avx2);
+
+/* Kernels of the instruction set selected at load time. */
+struct simd_kernels {
+  vf4_t (*aosf44_inverse)(struct aosf44*, const struct aosf44*);
+  void (*aosf44_transform_points)
+    (const struct aosf44*, const float*, size_t, float*);
+  void (*aosf44_transform_boxes)
+    (const float*, const float*, const float*, size_t, float*, float*);
+  void (*raster_draw_tile)
+    (float*, int, int, int, int, const struct raster_triangle*);
+  bool (*raster_test_tile)
+    (const float*, int, int, int, int, int, int, float);
+  float (*raster_tile_depth)(const float*);
+};
+
+extern LOCAL_SYM struct simd_kernels simd_kernels;
+
+#endif /* SIMD_KERNELS_C_H */
@@ -15,5 +15,21 @@
   #error unsupported_platform
 #endif
 
+#ifdef __AVX__
+  #include "maths/simd/avx/avx.h"
+#endif
+
+/* Instruction set of the out of line functions of the simd library. It is
+ * selected at load time from the features of the host CPU, independently of
+ * the flags the calling code is compiled with. */
+enum simd_isa {
+  SIMD_ISA_SSE3,
+  SIMD_ISA_AVX2_FMA
+};
+
+SIMD_API enum simd_isa simd_get_isa(void);
+
+SIMD_API const char* simd_isa_name(enum simd_isa isa);
+
 #endif /* SIMD_H */
 
@@ -0,0 +1,230 @@
+/* Lane type of the Structure of Arrays data structures. Each soaf_t packs one
+ * component of SOA_SIMD_WIDTH independent values, i.e. 8 with AVX and 4 with
+ * SSE. The width depends on the compilation flags of the including unit; the
+ * SoA functions are thus all inlined and never cross a library boundary. */
+#ifndef SOA_H
+#define SOA_H
+
+#include "maths/simd/simd.h"
+#include "sys/sys.h"
+
+#ifdef __AVX__
+  #define SOA_SIMD_WIDTH 8
+  #define SOA_SIMD_ALIGNMENT 32
+  typedef vf8_t soaf_t;
+  #define SOAF__(func) CONCAT(vf8_, func)
+#else
+  #define SOA_SIMD_WIDTH 4
+  #define SOA_SIMD_ALIGNMENT 16
+  typedef vf4_t soaf_t;
+  #define SOAF__(func) CONCAT(vf4_, func)
+#endif
+
+/* Set operations. */
+static FINLINE void
+soaf_store(float dst[SOA_SIMD_WIDTH], soaf_t v)
+{
+  SOAF__(store)(dst, v);
+}
+
+static FINLINE soaf_t
+soaf_load(const float src[SOA_SIMD_WIDTH])
+{
+  return SOAF__(load)(src);
+}
+
+static FINLINE soaf_t
+soaf_set1(float x)
+{
+  return SOAF__(set1)(x);
+}
+
+static FINLINE soaf_t
+soaf_zero(void)
+{
+  return SOAF__(zero)();
+}
+
+static FINLINE soaf_t
+soaf_true(void)
+{
+  const union { float f; int i; } mask = { .i = 0xFFFFFFFF };
+  return soaf_set1(mask.f);
+}
+
+/* Return a bit field whose bit i is set if the lane i of the mask is set. */
+static FINLINE int
+soaf_movemask(soaf_t v)
+{
+  return SOAF__(movemask)(v);
+}
+
+/* Bitwise operations. */
+static FINLINE soaf_t
+soaf_or(soaf_t v0, soaf_t v1)
+{
+  return SOAF__(or)(v0, v1);
+}
+
+static FINLINE soaf_t
+soaf_and(soaf_t v0, soaf_t v1)
+{
+  return SOAF__(and)(v0, v1);
+}
+
+static FINLINE soaf_t
+soaf_xor(soaf_t v0, soaf_t v1)
+{
+  return SOAF__(xor)(v0, v1);
+}
+
+static FINLINE soaf_t
+soaf_sel(soaf_t vfalse, soaf_t vtrue, soaf_t vcond)
+{
+  return SOAF__(sel)(vfalse, vtrue, vcond);
+}
+
+/* Arithmetic operations. */
+static FINLINE soaf_t
+soaf_minus(soaf_t v)
+{
+  return SOAF__(minus)(v);
+}
+
+static FINLINE soaf_t
+soaf_add(soaf_t v0, soaf_t v1)
+{
+  return SOAF__(add)(v0, v1);
+}
+
+static FINLINE soaf_t
+soaf_sub(soaf_t v0, soaf_t v1)
+{
+  return SOAF__(sub)(v0, v1);
+}
+
+static FINLINE soaf_t
+soaf_mul(soaf_t v0, soaf_t v1)
+{
+  return SOAF__(mul)(v0, v1);
+}
+
+static FINLINE soaf_t
+soaf_div(soaf_t v0, soaf_t v1)
+{
+  return SOAF__(div)(v0, v1);
+}
+
+static FINLINE soaf_t
+soaf_madd(soaf_t v0, soaf_t v1, soaf_t v2)
+{
+  return SOAF__(madd)(v0, v1, v2);
+}
+
+static FINLINE soaf_t
+soaf_abs(soaf_t v)
+{
+  return SOAF__(abs)(v);
+}
+
+static FINLINE soaf_t
+soaf_sqrt(soaf_t v)
+{
+  return SOAF__(sqrt)(v);
+}
+
+static FINLINE soaf_t
+soaf_rsqrt(soaf_t v)
+{
+  return SOAF__(rsqrt)(v);
+}
+
+static FINLINE soaf_t
+soaf_rcp(soaf_t v)
+{
+  return SOAF__(rcp)(v);
+}
+
+static FINLINE soaf_t
+soaf_lerp(soaf_t from, soaf_t to, soaf_t param)
+{
+  return SOAF__(lerp)(from, to, param);
+}
+
+/* Trigonometric operations. */
+static FINLINE soaf_t
+soaf_sin(soaf_t v)
+{
+  return SOAF__(sin)(v);
+}
+
+static FINLINE soaf_t
+soaf_cos(soaf_t v)
+{
+  return SOAF__(cos)(v);
+}
+
+static FINLINE void
+soaf_sincos(soaf_t v, soaf_t* restrict s, soaf_t* restrict c)
+{
+  SOAF__(sincos)(v, s, c);
+}
+
+/* Comparators. */
+static FINLINE soaf_t
+soaf_eq(soaf_t v0, soaf_t v1)
+{
+  return SOAF__(eq)(v0, v1);
+}
+
+static FINLINE soaf_t
+soaf_neq(soaf_t v0, soaf_t v1)
+{
+  return SOAF__(neq)(v0, v1);
+}
+
+static FINLINE soaf_t
+soaf_ge(soaf_t v0, soaf_t v1)
+{
+  return SOAF__(ge)(v0, v1);
+}
+
+static FINLINE soaf_t
+soaf_le(soaf_t v0, soaf_t v1)
+{
+  return SOAF__(le)(v0, v1);
+}
+
+static FINLINE soaf_t
+soaf_gt(soaf_t v0, soaf_t v1)
+{
+  return SOAF__(gt)(v0, v1);
+}
+
+static FINLINE soaf_t
+soaf_lt(soaf_t v0, soaf_t v1)
+{
+  return SOAF__(lt)(v0, v1);
+}
+
+static FINLINE soaf_t
+soaf_eq_eps(soaf_t v0, soaf_t v1, soaf_t eps)
+{
+  return SOAF__(eq_eps)(v0, v1, eps);
+}
+
+static FINLINE soaf_t
+soaf_min(soaf_t v0, soaf_t v1)
+{
+  return SOAF__(min)(v0, v1);
+}
+
+static FINLINE soaf_t
+soaf_max(soaf_t v0, soaf_t v1)
+{
+  return SOAF__(max)(v0, v1);
+}
+
+#undef SOAF__
+
+#endif /* SOA_H */
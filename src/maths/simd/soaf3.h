@@ -0,0 +1,206 @@
+#ifndef SOAF3_H
+#define SOAF3_H
+
+#include "maths/simd/soa.h"
+#include "sys/sys.h"
+#include <assert.h>
+
+/* SOA_SIMD_WIDTH float3 packed per component. */
+struct soaf3 { soaf_t x, y, z; };
+
+/* Set operations. */
+static FINLINE void
+soaf3_set(struct soaf3* res, soaf_t x, soaf_t y, soaf_t z)
+{
+  res->x = x;
+  res->y = y;
+  res->z = z;
+}
+
+static FINLINE void
+soaf3_splat(struct soaf3* res, float x, float y, float z)
+{
+  res->x = soaf_set1(x);
+  res->y = soaf_set1(y);
+  res->z = soaf_set1(z);
+}
+
+static FINLINE void
+soaf3_load
+  (struct soaf3* res,
+   const float x[SOA_SIMD_WIDTH],
+   const float y[SOA_SIMD_WIDTH],
+   const float z[SOA_SIMD_WIDTH])
+{
+  res->x = soaf_load(x);
+  res->y = soaf_load(y);
+  res->z = soaf_load(z);
+}
+
+static FINLINE void
+soaf3_store
+  (float x[SOA_SIMD_WIDTH],
+   float y[SOA_SIMD_WIDTH],
+   float z[SOA_SIMD_WIDTH],
+   const struct soaf3* v)
+{
+  soaf_store(x, v->x);
+  soaf_store(y, v->y);
+  soaf_store(z, v->z);
+}
+
+/* Load SOA_SIMD_WIDTH contiguous float3 { x, y, z }. */
+static FINLINE void
+soaf3_load_aos(struct soaf3* res, const float src[])
+{
+  ALIGN(SOA_SIMD_ALIGNMENT) float tmp[3][SOA_SIMD_WIDTH];
+  int i = 0;
+  assert(src);
+  for(i = 0; i < SOA_SIMD_WIDTH; ++i) {
+    tmp[0][i] = src[i*3 + 0];
+    tmp[1][i] = src[i*3 + 1];
+    tmp[2][i] = src[i*3 + 2];
+  }
+  soaf3_load(res, tmp[0], tmp[1], tmp[2]);
+}
+
+static FINLINE void
+soaf3_store_aos(float dst[], const struct soaf3* v)
+{
+  ALIGN(SOA_SIMD_ALIGNMENT) float tmp[3][SOA_SIMD_WIDTH];
+  int i = 0;
+  assert(dst);
+  soaf3_store(tmp[0], tmp[1], tmp[2], v);
+  for(i = 0; i < SOA_SIMD_WIDTH; ++i) {
+    dst[i*3 + 0] = tmp[0][i];
+    dst[i*3 + 1] = tmp[1][i];
+    dst[i*3 + 2] = tmp[2][i];
+  }
+}
+
+/* Arithmetic operations. */
+static FINLINE void
+soaf3_add(struct soaf3* res, const struct soaf3* v0, const struct soaf3* v1)
+{
+  res->x = soaf_add(v0->x, v1->x);
+  res->y = soaf_add(v0->y, v1->y);
+  res->z = soaf_add(v0->z, v1->z);
+}
+
+static FINLINE void
+soaf3_sub(struct soaf3* res, const struct soaf3* v0, const struct soaf3* v1)
+{
+  res->x = soaf_sub(v0->x, v1->x);
+  res->y = soaf_sub(v0->y, v1->y);
+  res->z = soaf_sub(v0->z, v1->z);
+}
+
+static FINLINE void
+soaf3_mul(struct soaf3* res, const struct soaf3* v, soaf_t f)
+{
+  res->x = soaf_mul(v->x, f);
+  res->y = soaf_mul(v->y, f);
+  res->z = soaf_mul(v->z, f);
+}
+
+static FINLINE void
+soaf3_madd
+  (struct soaf3* res, const struct soaf3* v, soaf_t f, const struct soaf3* a)
+{
+  res->x = soaf_madd(v->x, f, a->x);
+  res->y = soaf_madd(v->y, f, a->y);
+  res->z = soaf_madd(v->z, f, a->z);
+}
+
+static FINLINE void
+soaf3_minus(struct soaf3* res, const struct soaf3* v)
+{
+  res->x = soaf_minus(v->x);
+  res->y = soaf_minus(v->y);
+  res->z = soaf_minus(v->z);
+}
+
+static FINLINE void
+soaf3_abs(struct soaf3* res, const struct soaf3* v)
+{
+  res->x = soaf_abs(v->x);
+  res->y = soaf_abs(v->y);
+  res->z = soaf_abs(v->z);
+}
+
+static FINLINE void
+soaf3_min(struct soaf3* res, const struct soaf3* v0, const struct soaf3* v1)
+{
+  res->x = soaf_min(v0->x, v1->x);
+  res->y = soaf_min(v0->y, v1->y);
+  res->z = soaf_min(v0->z, v1->z);
+}
+
+static FINLINE void
+soaf3_max(struct soaf3* res, const struct soaf3* v0, const struct soaf3* v1)
+{
+  res->x = soaf_max(v0->x, v1->x);
+  res->y = soaf_max(v0->y, v1->y);
+  res->z = soaf_max(v0->z, v1->z);
+}
+
+static FINLINE void
+soaf3_lerp
+  (struct soaf3* res,
+   const struct soaf3* from,
+   const struct soaf3* to,
+   soaf_t param)
+{
+  res->x = soaf_lerp(from->x, to->x, param);
+  res->y = soaf_lerp(from->y, to->y, param);
+  res->z = soaf_lerp(from->z, to->z, param);
+}
+
+static FINLINE soaf_t
+soaf3_dot(const struct soaf3* v0, const struct soaf3* v1)
+{
+  return soaf_madd
+    (v0->z, v1->z, soaf_madd(v0->y, v1->y, soaf_mul(v0->x, v1->x)));
+}
+
+static FINLINE soaf_t
+soaf3_len(const struct soaf3* v)
+{
+  return soaf_sqrt(soaf3_dot(v, v));
+}
+
+static FINLINE void
+soaf3_normalize(struct soaf3* res, const struct soaf3* v)
+{
+  soaf3_mul(res, v, soaf_rsqrt(soaf3_dot(v, v)));
+}
+
+static FINLINE void
+soaf3_cross(struct soaf3* res, const struct soaf3* v0, const struct soaf3* v1)
+{
+  const soaf_t x = soaf_sub(soaf_mul(v0->y, v1->z), soaf_mul(v0->z, v1->y));
+  const soaf_t y = soaf_sub(soaf_mul(v0->z, v1->x), soaf_mul(v0->x, v1->z));
+  const soaf_t z = soaf_sub(soaf_mul(v0->x, v1->y), soaf_mul(v0->y, v1->x));
+  res->x = x;
+  res->y = y;
+  res->z = z;
+}
+
+/* Comparison operations. Return a per lane mask. */
+static FINLINE soaf_t
+soaf3_eq(const struct soaf3* v0, const struct soaf3* v1)
+{
+  return soaf_and
+    (soaf_and(soaf_eq(v0->x, v1->x), soaf_eq(v0->y, v1->y)),
+     soaf_eq(v0->z, v1->z));
+}
+
+static FINLINE soaf_t
+soaf3_eq_eps(const struct soaf3* v0, const struct soaf3* v1, soaf_t eps)
+{
+  return soaf_and
+    (soaf_and(soaf_eq_eps(v0->x, v1->x, eps), soaf_eq_eps(v0->y, v1->y, eps)),
+     soaf_eq_eps(v0->z, v1->z, eps));
+}
+
+#endif /* SOAF3_H */
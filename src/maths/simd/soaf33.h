@@ -0,0 +1,145 @@
+#ifndef SOAF33_H
+#define SOAF33_H
+
+#include "maths/simd/soaf3.h"
+#include "sys/sys.h"
+#include <assert.h>
+
+/* SOA_SIMD_WIDTH column major float33. */
+struct soaf33 { struct soaf3 c0, c1, c2; };
+
+/* Set operations. */
+static FINLINE void
+soaf33_identity(struct soaf33* m)
+{
+  soaf3_splat(&m->c0, 1.f, 0.f, 0.f);
+  soaf3_splat(&m->c1, 0.f, 1.f, 0.f);
+  soaf3_splat(&m->c2, 0.f, 0.f, 1.f);
+}
+
+/* Load SOA_SIMD_WIDTH contiguous column major float33. */
+static FINLINE void
+soaf33_load_aos(struct soaf33* res, const float src[])
+{
+  ALIGN(SOA_SIMD_ALIGNMENT) float tmp[9][SOA_SIMD_WIDTH];
+  int i = 0, j = 0;
+  assert(src);
+  for(i = 0; i < SOA_SIMD_WIDTH; ++i) {
+    for(j = 0; j < 9; ++j)
+      tmp[j][i] = src[i*9 + j];
+  }
+  soaf3_load(&res->c0, tmp[0], tmp[1], tmp[2]);
+  soaf3_load(&res->c1, tmp[3], tmp[4], tmp[5]);
+  soaf3_load(&res->c2, tmp[6], tmp[7], tmp[8]);
+}
+
+static FINLINE void
+soaf33_store_aos(float dst[], const struct soaf33* m)
+{
+  ALIGN(SOA_SIMD_ALIGNMENT) float tmp[9][SOA_SIMD_WIDTH];
+  int i = 0, j = 0;
+  assert(dst);
+  soaf3_store(tmp[0], tmp[1], tmp[2], &m->c0);
+  soaf3_store(tmp[3], tmp[4], tmp[5], &m->c1);
+  soaf3_store(tmp[6], tmp[7], tmp[8], &m->c2);
+  for(i = 0; i < SOA_SIMD_WIDTH; ++i) {
+    for(j = 0; j < 9; ++j)
+      dst[i*9 + j] = tmp[j][i];
+  }
+}
+
+/* Arithmetic operations. */
+static FINLINE void
+soaf33_mul(struct soaf33* res, const struct soaf33* m, soaf_t f)
+{
+  soaf3_mul(&res->c0, &m->c0, f);
+  soaf3_mul(&res->c1, &m->c1, f);
+  soaf3_mul(&res->c2, &m->c2, f);
+}
+
+static FINLINE void
+soaf33_mulf3(struct soaf3* res, const struct soaf33* m, const struct soaf3* v)
+{
+  struct soaf3 tmp;
+  soaf3_mul(&tmp, &m->c0, v->x);
+  soaf3_madd(&tmp, &m->c1, v->y, &tmp);
+  soaf3_madd(res, &m->c2, v->z, &tmp);
+}
+
+static FINLINE void
+soaf33_mulf33
+  (struct soaf33* res,
+   const struct soaf33* a,
+   const struct soaf33* b)
+{
+  struct soaf33 tmp;
+  soaf33_mulf3(&tmp.c0, a, &b->c0);
+  soaf33_mulf3(&tmp.c1, a, &b->c1);
+  soaf33_mulf3(&tmp.c2, a, &b->c2);
+  *res = tmp;
+}
+
+static FINLINE void
+soaf33_transpose(struct soaf33* res, const struct soaf33* m)
+{
+  const struct soaf33 tmp = *m;
+  soaf3_set(&res->c0, tmp.c0.x, tmp.c1.x, tmp.c2.x);
+  soaf3_set(&res->c1, tmp.c0.y, tmp.c1.y, tmp.c2.y);
+  soaf3_set(&res->c2, tmp.c0.z, tmp.c1.z, tmp.c2.z);
+}
+
+static FINLINE soaf_t
+soaf33_det(const struct soaf33* m)
+{
+  struct soaf3 tmp;
+  soaf3_cross(&tmp, &m->c0, &m->c1);
+  return soaf3_dot(&m->c2, &tmp);
+}
+
+static FINLINE soaf_t
+soaf33_invtrans(struct soaf33* res, const struct soaf33* m)
+{
+  struct soaf33 f33;
+  soaf_t det;
+  soaf3_cross(&f33.c0, &m->c1, &m->c2);
+  soaf3_cross(&f33.c1, &m->c2, &m->c0);
+  soaf3_cross(&f33.c2, &m->c0, &m->c1);
+  det = soaf3_dot(&f33.c2, &m->c2);
+  soaf33_mul(res, &f33, soaf_rcp(det));
+  return det;
+}
+
+static FINLINE soaf_t
+soaf33_inverse(struct soaf33* res, const struct soaf33* m)
+{
+  const soaf_t det = soaf33_invtrans(res, m);
+  soaf33_transpose(res, res);
+  return det;
+}
+
+/* Build functions. */
+static FINLINE void
+soaf33_rotation(struct soaf33* res, soaf_t pitch, soaf_t yaw, soaf_t roll)
+{
+  /* XYZ norm, as aosf33_rotation. */
+  soaf_t s1, s2, s3, c1, c2, c3;
+  soaf_t c1s3, c3s1, c1c3, s1s3;
+  soaf_sincos(pitch, &s1, &c1);
+  soaf_sincos(yaw, &s2, &c2);
+  soaf_sincos(roll, &s3, &c3);
+  c1s3 = soaf_mul(c1, s3);
+  c3s1 = soaf_mul(c3, s1);
+  c1c3 = soaf_mul(c1, c3);
+  s1s3 = soaf_mul(s1, s3);
+  soaf3_set(&res->c0,
+    soaf_mul(c2, c3),
+    soaf_madd(c3s1, s2, c1s3),
+    soaf_sub(s1s3, soaf_mul(c1c3, s2)));
+  soaf3_set(&res->c1,
+    soaf_minus(soaf_mul(c2, s3)),
+    soaf_sub(c1c3, soaf_mul(s1s3, s2)),
+    soaf_madd(c1s3, s2, c3s1));
+  soaf3_set(&res->c2, s2, soaf_minus(soaf_mul(c2, s1)), soaf_mul(c1, c2));
+}
+
+#endif /* SOAF33_H */
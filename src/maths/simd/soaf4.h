@@ -0,0 +1,139 @@
+#ifndef SOAF4_H
+#define SOAF4_H
+
+#include "maths/simd/soa.h"
+#include "sys/sys.h"
+#include <assert.h>
+
+/* SOA_SIMD_WIDTH float4 packed per component. */
+struct soaf4 { soaf_t x, y, z, w; };
+
+/* Set operations. */
+static FINLINE void
+soaf4_set(struct soaf4* res, soaf_t x, soaf_t y, soaf_t z, soaf_t w)
+{
+  res->x = x;
+  res->y = y;
+  res->z = z;
+  res->w = w;
+}
+
+static FINLINE void
+soaf4_splat(struct soaf4* res, float x, float y, float z, float w)
+{
+  res->x = soaf_set1(x);
+  res->y = soaf_set1(y);
+  res->z = soaf_set1(z);
+  res->w = soaf_set1(w);
+}
+
+/* Load SOA_SIMD_WIDTH contiguous float4 { x, y, z, w }. */
+static FINLINE void
+soaf4_load_aos(struct soaf4* res, const float src[])
+{
+  ALIGN(SOA_SIMD_ALIGNMENT) float tmp[4][SOA_SIMD_WIDTH];
+  int i = 0;
+  assert(src);
+  for(i = 0; i < SOA_SIMD_WIDTH; ++i) {
+    tmp[0][i] = src[i*4 + 0];
+    tmp[1][i] = src[i*4 + 1];
+    tmp[2][i] = src[i*4 + 2];
+    tmp[3][i] = src[i*4 + 3];
+  }
+  res->x = soaf_load(tmp[0]);
+  res->y = soaf_load(tmp[1]);
+  res->z = soaf_load(tmp[2]);
+  res->w = soaf_load(tmp[3]);
+}
+
+static FINLINE void
+soaf4_store_aos(float dst[], const struct soaf4* v)
+{
+  ALIGN(SOA_SIMD_ALIGNMENT) float tmp[4][SOA_SIMD_WIDTH];
+  int i = 0;
+  assert(dst);
+  soaf_store(tmp[0], v->x);
+  soaf_store(tmp[1], v->y);
+  soaf_store(tmp[2], v->z);
+  soaf_store(tmp[3], v->w);
+  for(i = 0; i < SOA_SIMD_WIDTH; ++i) {
+    dst[i*4 + 0] = tmp[0][i];
+    dst[i*4 + 1] = tmp[1][i];
+    dst[i*4 + 2] = tmp[2][i];
+    dst[i*4 + 3] = tmp[3][i];
+  }
+}
+
+/* Arithmetic operations. */
+static FINLINE void
+soaf4_add(struct soaf4* res, const struct soaf4* v0, const struct soaf4* v1)
+{
+  res->x = soaf_add(v0->x, v1->x);
+  res->y = soaf_add(v0->y, v1->y);
+  res->z = soaf_add(v0->z, v1->z);
+  res->w = soaf_add(v0->w, v1->w);
+}
+
+static FINLINE void
+soaf4_sub(struct soaf4* res, const struct soaf4* v0, const struct soaf4* v1)
+{
+  res->x = soaf_sub(v0->x, v1->x);
+  res->y = soaf_sub(v0->y, v1->y);
+  res->z = soaf_sub(v0->z, v1->z);
+  res->w = soaf_sub(v0->w, v1->w);
+}
+
+static FINLINE void
+soaf4_mul(struct soaf4* res, const struct soaf4* v, soaf_t f)
+{
+  res->x = soaf_mul(v->x, f);
+  res->y = soaf_mul(v->y, f);
+  res->z = soaf_mul(v->z, f);
+  res->w = soaf_mul(v->w, f);
+}
+
+static FINLINE void
+soaf4_madd
+  (struct soaf4* res, const struct soaf4* v, soaf_t f, const struct soaf4* a)
+{
+  res->x = soaf_madd(v->x, f, a->x);
+  res->y = soaf_madd(v->y, f, a->y);
+  res->z = soaf_madd(v->z, f, a->z);
+  res->w = soaf_madd(v->w, f, a->w);
+}
+
+static FINLINE void
+soaf4_minus(struct soaf4* res, const struct soaf4* v)
+{
+  res->x = soaf_minus(v->x);
+  res->y = soaf_minus(v->y);
+  res->z = soaf_minus(v->z);
+  res->w = soaf_minus(v->w);
+}
+
+static FINLINE soaf_t
+soaf4_dot(const struct soaf4* v0, const struct soaf4* v1)
+{
+  const soaf_t xy = soaf_madd(v0->y, v1->y, soaf_mul(v0->x, v1->x));
+  const soaf_t zw = soaf_madd(v0->w, v1->w, soaf_mul(v0->z, v1->z));
+  return soaf_add(xy, zw);
+}
+
+/* Comparison operations. Return a per lane mask. */
+static FINLINE soaf_t
+soaf4_eq(const struct soaf4* v0, const struct soaf4* v1)
+{
+  return soaf_and
+    (soaf_and(soaf_eq(v0->x, v1->x), soaf_eq(v0->y, v1->y)),
+     soaf_and(soaf_eq(v0->z, v1->z), soaf_eq(v0->w, v1->w)));
+}
+
+static FINLINE soaf_t
+soaf4_eq_eps(const struct soaf4* v0, const struct soaf4* v1, soaf_t eps)
+{
+  return soaf_and
+    (soaf_and(soaf_eq_eps(v0->x, v1->x, eps), soaf_eq_eps(v0->y, v1->y, eps)),
+     soaf_and(soaf_eq_eps(v0->z, v1->z, eps), soaf_eq_eps(v0->w, v1->w, eps)));
+}
+
+#endif /* SOAF4_H */
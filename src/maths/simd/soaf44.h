@@ -0,0 +1,247 @@
+#ifndef SOAF44_H
+#define SOAF44_H
+
+#include "maths/simd/soaf3.h"
+#include "maths/simd/soaf33.h"
+#include "maths/simd/soaf4.h"
+#include "sys/sys.h"
+#include <assert.h>
+
+/* SOA_SIMD_WIDTH column major float44. */
+struct soaf44 { struct soaf4 c0, c1, c2, c3; };
+
+/* Set operations. */
+static FINLINE void
+soaf44_identity(struct soaf44* m)
+{
+  soaf4_splat(&m->c0, 1.f, 0.f, 0.f, 0.f);
+  soaf4_splat(&m->c1, 0.f, 1.f, 0.f, 0.f);
+  soaf4_splat(&m->c2, 0.f, 0.f, 1.f, 0.f);
+  soaf4_splat(&m->c3, 0.f, 0.f, 0.f, 1.f);
+}
+
+/* Load SOA_SIMD_WIDTH contiguous column major float44, e.g. the transforms of
+ * a list of instances. */
+static FINLINE void
+soaf44_load_aos(struct soaf44* res, const float src[])
+{
+  ALIGN(SOA_SIMD_ALIGNMENT) float tmp[16][SOA_SIMD_WIDTH];
+  soaf_t* dst = (soaf_t*)res;
+  int i = 0, j = 0;
+  assert(src);
+  for(i = 0; i < SOA_SIMD_WIDTH; ++i) {
+    for(j = 0; j < 16; ++j)
+      tmp[j][i] = src[i*16 + j];
+  }
+  for(j = 0; j < 16; ++j)
+    dst[j] = soaf_load(tmp[j]);
+}
+
+static FINLINE void
+soaf44_store_aos(float dst[], const struct soaf44* m)
+{
+  ALIGN(SOA_SIMD_ALIGNMENT) float tmp[16][SOA_SIMD_WIDTH];
+  const soaf_t* src = (const soaf_t*)m;
+  int i = 0, j = 0;
+  assert(dst);
+  for(j = 0; j < 16; ++j)
+    soaf_store(tmp[j], src[j]);
+  for(i = 0; i < SOA_SIMD_WIDTH; ++i) {
+    for(j = 0; j < 16; ++j)
+      dst[i*16 + j] = tmp[j][i];
+  }
+}
+
+/* Get operations. */
+static FINLINE void
+soaf44_to_soaf33(struct soaf33* res, const struct soaf44* m)
+{
+  soaf3_set(&res->c0, m->c0.x, m->c0.y, m->c0.z);
+  soaf3_set(&res->c1, m->c1.x, m->c1.y, m->c1.z);
+  soaf3_set(&res->c2, m->c2.x, m->c2.y, m->c2.z);
+}
+
+/* Arithmetic operations. */
+static FINLINE void
+soaf44_mul(struct soaf44* res, const struct soaf44* m, soaf_t f)
+{
+  soaf4_mul(&res->c0, &m->c0, f);
+  soaf4_mul(&res->c1, &m->c1, f);
+  soaf4_mul(&res->c2, &m->c2, f);
+  soaf4_mul(&res->c3, &m->c3, f);
+}
+
+static FINLINE void
+soaf44_mulf4(struct soaf4* res, const struct soaf44* m, const struct soaf4* v)
+{
+  struct soaf4 tmp;
+  soaf4_mul(&tmp, &m->c0, v->x);
+  soaf4_madd(&tmp, &m->c1, v->y, &tmp);
+  soaf4_madd(&tmp, &m->c2, v->z, &tmp);
+  soaf4_madd(res, &m->c3, v->w, &tmp);
+}
+
+static FINLINE void
+soaf44_mulf44
+  (struct soaf44* res, const struct soaf44* m0, const struct soaf44* m1)
+{
+  struct soaf44 tmp;
+  soaf44_mulf4(&tmp.c0, m0, &m1->c0);
+  soaf44_mulf4(&tmp.c1, m0, &m1->c1);
+  soaf44_mulf4(&tmp.c2, m0, &m1->c2);
+  soaf44_mulf4(&tmp.c3, m0, &m1->c3);
+  *res = tmp;
+}
+
+/* Transform the point { p, 1 } by the affine matrix m. The fourth row of m is
+ * not used, i.e. no perspective divide is performed. */
+static FINLINE void
+soaf44_transform_point
+  (struct soaf3* res, const struct soaf44* m, const struct soaf3* p)
+{
+  const soaf_t x = soaf_madd(m->c2.x, p->z,
+    soaf_madd(m->c1.x, p->y, soaf_madd(m->c0.x, p->x, m->c3.x)));
+  const soaf_t y = soaf_madd(m->c2.y, p->z,
+    soaf_madd(m->c1.y, p->y, soaf_madd(m->c0.y, p->x, m->c3.y)));
+  const soaf_t z = soaf_madd(m->c2.z, p->z,
+    soaf_madd(m->c1.z, p->y, soaf_madd(m->c0.z, p->x, m->c3.z)));
+  soaf3_set(res, x, y, z);
+}
+
+/* Transform the direction { v, 0 } by the affine matrix m. */
+static FINLINE void
+soaf44_transform_vector
+  (struct soaf3* res, const struct soaf44* m, const struct soaf3* v)
+{
+  const soaf_t x = soaf_madd(m->c2.x, v->z,
+    soaf_madd(m->c1.x, v->y, soaf_mul(m->c0.x, v->x)));
+  const soaf_t y = soaf_madd(m->c2.y, v->z,
+    soaf_madd(m->c1.y, v->y, soaf_mul(m->c0.y, v->x)));
+  const soaf_t z = soaf_madd(m->c2.z, v->z,
+    soaf_madd(m->c1.z, v->y, soaf_mul(m->c0.z, v->x)));
+  soaf3_set(res, x, y, z);
+}
+
+/* Compute the axis aligned bounding box of the { lower, upper } box
+ * transformed by the affine matrix m. The transformed box is defined from its
+ * center and its half extents rather than from its 8 corners. */
+static FINLINE void
+soaf44_transform_box
+  (struct soaf3* res_lower,
+   struct soaf3* res_upper,
+   const struct soaf44* m,
+   const struct soaf3* lower,
+   const struct soaf3* upper)
+{
+  const soaf_t half = soaf_set1(0.5f);
+  struct soaf3 center, extend, tmp;
+
+  soaf3_add(&center, lower, upper);
+  soaf3_mul(&center, &center, half);
+  soaf3_sub(&extend, upper, lower);
+  soaf3_mul(&extend, &extend, half);
+
+  soaf44_transform_point(&center, m, &center);
+  tmp.x = soaf_madd(soaf_abs(m->c2.x), extend.z, soaf_madd
+    (soaf_abs(m->c1.x), extend.y, soaf_mul(soaf_abs(m->c0.x), extend.x)));
+  tmp.y = soaf_madd(soaf_abs(m->c2.y), extend.z, soaf_madd
+    (soaf_abs(m->c1.y), extend.y, soaf_mul(soaf_abs(m->c0.y), extend.x)));
+  tmp.z = soaf_madd(soaf_abs(m->c2.z), extend.z, soaf_madd
+    (soaf_abs(m->c1.z), extend.y, soaf_mul(soaf_abs(m->c0.z), extend.x)));
+
+  soaf3_sub(res_lower, &center, &tmp);
+  soaf3_add(res_upper, &center, &tmp);
+}
+
+static FINLINE void
+soaf44_transpose(struct soaf44* res, const struct soaf44* m)
+{
+  const struct soaf44 tmp = *m;
+  soaf4_set(&res->c0, tmp.c0.x, tmp.c1.x, tmp.c2.x, tmp.c3.x);
+  soaf4_set(&res->c1, tmp.c0.y, tmp.c1.y, tmp.c2.y, tmp.c3.y);
+  soaf4_set(&res->c2, tmp.c0.z, tmp.c1.z, tmp.c2.z, tmp.c3.z);
+  soaf4_set(&res->c3, tmp.c0.w, tmp.c1.w, tmp.c2.w, tmp.c3.w);
+}
+
+/* Invert the matrices from their 2x2 sub determinants. Return the determinant
+ * of the input matrices. */
+static FINLINE soaf_t
+soaf44_inverse(struct soaf44* res, const struct soaf44* m)
+{
+  /* mRC is the entry of the row R and the column C. */
+  const soaf_t m00 = m->c0.x, m01 = m->c1.x, m02 = m->c2.x, m03 = m->c3.x;
+  const soaf_t m10 = m->c0.y, m11 = m->c1.y, m12 = m->c2.y, m13 = m->c3.y;
+  const soaf_t m20 = m->c0.z, m21 = m->c1.z, m22 = m->c2.z, m23 = m->c3.z;
+  const soaf_t m30 = m->c0.w, m31 = m->c1.w, m32 = m->c2.w, m33 = m->c3.w;
+
+  /* Sub determinants of the rows 0 and 1 */
+  const soaf_t s0 = soaf_sub(soaf_mul(m00, m11), soaf_mul(m10, m01));
+  const soaf_t s1 = soaf_sub(soaf_mul(m00, m12), soaf_mul(m10, m02));
+  const soaf_t s2 = soaf_sub(soaf_mul(m00, m13), soaf_mul(m10, m03));
+  const soaf_t s3 = soaf_sub(soaf_mul(m01, m12), soaf_mul(m11, m02));
+  const soaf_t s4 = soaf_sub(soaf_mul(m01, m13), soaf_mul(m11, m03));
+  const soaf_t s5 = soaf_sub(soaf_mul(m02, m13), soaf_mul(m12, m03));
+
+  /* Sub determinants of the rows 2 and 3 */
+  const soaf_t c5 = soaf_sub(soaf_mul(m22, m33), soaf_mul(m32, m23));
+  const soaf_t c4 = soaf_sub(soaf_mul(m21, m33), soaf_mul(m31, m23));
+  const soaf_t c3 = soaf_sub(soaf_mul(m21, m32), soaf_mul(m31, m22));
+  const soaf_t c2 = soaf_sub(soaf_mul(m20, m33), soaf_mul(m30, m23));
+  const soaf_t c1 = soaf_sub(soaf_mul(m20, m32), soaf_mul(m30, m22));
+  const soaf_t c0 = soaf_sub(soaf_mul(m20, m31), soaf_mul(m30, m21));
+
+  const soaf_t det = soaf_add
+    (soaf_add
+      (soaf_sub(soaf_mul(s0, c5), soaf_mul(s1, c4)),
+       soaf_add(soaf_mul(s2, c3), soaf_mul(s3, c2))),
+     soaf_sub(soaf_mul(s5, c0), soaf_mul(s4, c1)));
+  const soaf_t idet = soaf_rcp(det);
+
+  #define COFACTOR(a, b, c, d, e, f) \
+    soaf_add(soaf_sub(soaf_mul(a, b), soaf_mul(c, d)), soaf_mul(e, f))
+  const soaf_t i00 = COFACTOR(m11, c5, m12, c4, m13, c3);
+  const soaf_t i01 = soaf_minus(COFACTOR(m01, c5, m02, c4, m03, c3));
+  const soaf_t i02 = COFACTOR(m31, s5, m32, s4, m33, s3);
+  const soaf_t i03 = soaf_minus(COFACTOR(m21, s5, m22, s4, m23, s3));
+  const soaf_t i10 = soaf_minus(COFACTOR(m10, c5, m12, c2, m13, c1));
+  const soaf_t i11 = COFACTOR(m00, c5, m02, c2, m03, c1);
+  const soaf_t i12 = soaf_minus(COFACTOR(m30, s5, m32, s2, m33, s1));
+  const soaf_t i13 = COFACTOR(m20, s5, m22, s2, m23, s1);
+  const soaf_t i20 = COFACTOR(m10, c4, m11, c2, m13, c0);
+  const soaf_t i21 = soaf_minus(COFACTOR(m00, c4, m01, c2, m03, c0));
+  const soaf_t i22 = COFACTOR(m30, s4, m31, s2, m33, s0);
+  const soaf_t i23 = soaf_minus(COFACTOR(m20, s4, m21, s2, m23, s0));
+  const soaf_t i30 = soaf_minus(COFACTOR(m10, c3, m11, c1, m12, c0));
+  const soaf_t i31 = COFACTOR(m00, c3, m01, c1, m02, c0);
+  const soaf_t i32 = soaf_minus(COFACTOR(m30, s3, m31, s1, m32, s0));
+  const soaf_t i33 = COFACTOR(m20, s3, m21, s1, m22, s0);
+  #undef COFACTOR
+
+  soaf4_set(&res->c0, i00, i10, i20, i30);
+  soaf4_set(&res->c1, i01, i11, i21, i31);
+  soaf4_set(&res->c2, i02, i12, i22, i32);
+  soaf4_set(&res->c3, i03, i13, i23, i33);
+  soaf44_mul(res, res, idet);
+  return det;
+}
+
+static FINLINE soaf_t
+soaf44_invtrans(struct soaf44* res, const struct soaf44* m)
+{
+  const soaf_t det = soaf44_inverse(res, m);
+  soaf44_transpose(res, res);
+  return det;
+}
+
+/* Comparison operations. Return a per lane mask. */
+static FINLINE soaf_t
+soaf44_eq_eps(const struct soaf44* a, const struct soaf44* b, soaf_t eps)
+{
+  return soaf_and
+    (soaf_and(soaf4_eq_eps(&a->c0, &b->c0, eps),
+              soaf4_eq_eps(&a->c1, &b->c1, eps)),
+     soaf_and(soaf4_eq_eps(&a->c2, &b->c2, eps),
+              soaf4_eq_eps(&a->c3, &b->c3, eps)));
+}
+
+#endif /* SOAF44_H */
@@ -0,0 +1,98 @@
+/* SOA_SIMD_WIDTH quaternions { i, j, k, a } packed per component. */
+#ifndef SOAQ_H
+#define SOAQ_H
+
+#include "maths/simd/soaf33.h"
+#include "maths/simd/soaf4.h"
+#include "sys/sys.h"
+
+struct soaq { soaf_t i, j, k, a; };
+
+/* Set operations. */
+static FINLINE void
+soaq_identity(struct soaq* q)
+{
+  q->i = q->j = q->k = soaf_zero();
+  q->a = soaf_set1(1.f);
+}
+
+/* Load SOA_SIMD_WIDTH contiguous quaternions { i, j, k, a }. */
+static FINLINE void
+soaq_load_aos(struct soaq* res, const float src[])
+{
+  struct soaf4 tmp;
+  soaf4_load_aos(&tmp, src);
+  res->i = tmp.x;
+  res->j = tmp.y;
+  res->k = tmp.z;
+  res->a = tmp.w;
+}
+
+static FINLINE void
+soaq_store_aos(float dst[], const struct soaq* q)
+{
+  struct soaf4 tmp;
+  soaf4_set(&tmp, q->i, q->j, q->k, q->a);
+  soaf4_store_aos(dst, &tmp);
+}
+
+/* Arithmetic operations. */
+static FINLINE void
+soaq_mul(struct soaq* res, const struct soaq* q0, const struct soaq* q1)
+{
+  const soaf_t i = soaf_sub
+    (soaf_add(soaf_mul(q0->a, q1->i), soaf_mul(q0->i, q1->a)),
+     soaf_sub(soaf_mul(q0->k, q1->j), soaf_mul(q0->j, q1->k)));
+  const soaf_t j = soaf_sub
+    (soaf_add(soaf_mul(q0->a, q1->j), soaf_mul(q0->j, q1->a)),
+     soaf_sub(soaf_mul(q0->i, q1->k), soaf_mul(q0->k, q1->i)));
+  const soaf_t k = soaf_sub
+    (soaf_add(soaf_mul(q0->a, q1->k), soaf_mul(q0->k, q1->a)),
+     soaf_sub(soaf_mul(q0->j, q1->i), soaf_mul(q0->i, q1->j)));
+  const soaf_t a = soaf_sub
+    (soaf_mul(q0->a, q1->a),
+     soaf_add
+      (soaf_add(soaf_mul(q0->i, q1->i), soaf_mul(q0->j, q1->j)),
+       soaf_mul(q0->k, q1->k)));
+  res->i = i;
+  res->j = j;
+  res->k = k;
+  res->a = a;
+}
+
+static FINLINE void
+soaq_conj(struct soaq* res, const struct soaq* q)
+{
+  res->i = soaf_minus(q->i);
+  res->j = soaf_minus(q->j);
+  res->k = soaf_minus(q->k);
+  res->a = q->a;
+}
+
+/* Conversion operations. */
+static FINLINE void
+soaq_to_soaf33(const struct soaq* q, struct soaf33* out)
+{
+  const soaf_t one = soaf_set1(1.f);
+  const soaf_t i2 = soaf_add(q->i, q->i);
+  const soaf_t j2 = soaf_add(q->j, q->j);
+  const soaf_t k2 = soaf_add(q->k, q->k);
+  const soaf_t ii2 = soaf_mul(q->i, i2);
+  const soaf_t jj2 = soaf_mul(q->j, j2);
+  const soaf_t kk2 = soaf_mul(q->k, k2);
+  const soaf_t ij2 = soaf_mul(q->i, j2);
+  const soaf_t ik2 = soaf_mul(q->i, k2);
+  const soaf_t jk2 = soaf_mul(q->j, k2);
+  const soaf_t ai2 = soaf_mul(q->a, i2);
+  const soaf_t aj2 = soaf_mul(q->a, j2);
+  const soaf_t ak2 = soaf_mul(q->a, k2);
+
+  soaf3_set(&out->c0,
+    soaf_sub(one, soaf_add(jj2, kk2)), soaf_add(ij2, ak2), soaf_sub(ik2, aj2));
+  soaf3_set(&out->c1,
+    soaf_sub(ij2, ak2), soaf_sub(one, soaf_add(ii2, kk2)), soaf_add(jk2, ai2));
+  soaf3_set(&out->c2,
+    soaf_add(ik2, aj2), soaf_sub(jk2, ai2), soaf_sub(one, soaf_add(ii2, jj2)));
+}
+
+#endif /* SOAQ_H */
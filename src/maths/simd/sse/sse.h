@@ -6,6 +6,9 @@
 #include <xmmintrin.h>
 #include <emmintrin.h>
 #include <pmmintrin.h>
+#ifdef __FMA__
+  #include <immintrin.h>
+#endif
 #include <stdbool.h>
 #include <stdint.h>
 
@@ -223,6 +226,13 @@ vf4_mask_w(vf4_t v)
   return ucast.ui32 != 0;
 }
 
+/* Return the sign bits of the 4 floats, i.e. the lanes set in a mask. */
+static FINLINE int
+vf4_movemask(vf4_t v)
+{
+  return _mm_movemask_ps(v);
+}
+
 /* Bitwise operations. */
 static FINLINE vf4_t
 vf4_or(vf4_t v0, vf4_t v1)
@@ -345,7 +355,11 @@ vf4_div(vf4_t v0, vf4_t v1)
 static FINLINE vf4_t
 vf4_madd(vf4_t v0, vf4_t v1, vf4_t v2)
 {
+#ifdef __FMA__
+  return _mm_fmadd_ps(v0, v1, v2);
+#else
   return _mm_add_ps(_mm_mul_ps(v0, v1), v2);
+#endif
 }
 
 static FINLINE vf4_t
@@ -487,7 +501,10 @@ vf4_normalize3(vf4_t v)
   return vf4_mul(v, vf4_rsqrt(vf4_dot3(v, v)));
 }
 
-/* Trigonometric operations. */
+/* Trigonometric operations. The argument is reduced to [-PI/4, PI/4] and the
+ * sine and cosine are then approximated by polynomials of degree 7 and 8. The
+ * absolute error is less than 1.e-6 on [-8PI, 8PI] and grows with the
+ * magnitude of the argument, up to 3.1e-5 on [-1000, 1000]. */
 SIMD_API vf4_t vf4_sin(vf4_t v);
 SIMD_API vf4_t vf4_cos(vf4_t v);
 SIMD_API vf4_t vf4_acos(vf4_t v);
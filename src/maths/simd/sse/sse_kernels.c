@@ -0,0 +1,2 @@
+#define KERNEL(name) CONCAT(name, _sse3)
+#include "maths/simd/regular/simd_kernels.h"
@@ -6,10 +6,14 @@
   #pragma GCC diagnostic ignored "-Wunused-parameter"
 #endif
  
-/* Do not use the X macro to define the rb_get_config function body. */
+/* Do not use the X macro to define the rb_get_config and rb_get_stats
+ * function bodies. */
 static int
 rb_get_config__(struct rb_context* ctxt, struct rb_config* cfg);
+static int
+rb_get_stats__(struct rb_context* ctxt, struct rb_stats* stats);
 #define get_config get_config__
+#define get_stats get_stats__
 
 /* Define NULL function body. */
 #define RB_FUNC(func_name, ...) \
@@ -33,3 +37,12 @@ rb_get_config(struct rb_context* ctxt, struct rb_config* cfg)
   return 0;
 }
 
+/* Nothing is ever drawn or uploaded. */
+int
+rb_get_stats(struct rb_context* ctxt, struct rb_stats* stats)
+{
+  rb_get_stats__(NULL, NULL);
+  memset(stats, 0, sizeof(struct rb_stats));
+  return 0;
+}
+
@@ -162,6 +162,7 @@ rb_buffer_data
   if(size == 0)
     return 0;
 
+  buffer->ctxt->stats.uploaded_size += (size_t)size;
   OGL(BindBuffer(buffer->target, buffer->name));
 
   if(offset == 0 && size == buffer->size) {
@@ -215,6 +216,8 @@ rb_ogl3_create_buffer
   buffer->size = (GLsizei)desc->size;
   buffer->binding = desc->target;
 
+  if(init_data)
+    ctxt->stats.uploaded_size += desc->size;
   OGL(GenBuffers(1, &buffer->name));
   OGL(BindBuffer(buffer->target, buffer->name));
   OGL(BufferData(buffer->target, buffer->size, init_data, buffer->usage));
@@ -245,6 +248,7 @@ rb_ogl3_bind_buffer
   if(current_name != name) {
     OGL(BindBuffer(rb_to_ogl3_buffer_target(target), name));
     ctxt->state_cache.buffer_binding[target] = name;
+    ++ctxt->stats.nb_state_changes;
   }
 
 exit:
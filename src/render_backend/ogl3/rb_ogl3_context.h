@@ -21,6 +21,7 @@ struct rb_context {
     GLuint vertex_array_binding;
     GLenum active_texture;
   } state_cache;
+  struct rb_stats stats;
 };
 
 #endif /* RB_OGL3_CONTEXT_H */
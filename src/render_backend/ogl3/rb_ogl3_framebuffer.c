@@ -251,6 +251,7 @@ rb_bind_framebuffer
   if(UNLIKELY(!ctxt))
     return -1;
   ctxt->state_cache.framebuffer_binding = buffer ? buffer->name : 0;
+  ++ctxt->stats.nb_state_changes;
   OGL(BindFramebuffer(GL_FRAMEBUFFER, ctxt->state_cache.framebuffer_binding));
   return 0;
 }
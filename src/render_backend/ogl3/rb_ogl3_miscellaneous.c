@@ -81,6 +81,7 @@ rb_draw_indexed
 {
   if(!ctxt)
     return -1;
+  ++ctxt->stats.nb_draw_calls;
   OGL(DrawElements
     (rb_to_ogl3_primitive_type[prim_type], count, GL_UNSIGNED_INT, NULL));
   return 0;
@@ -94,6 +95,7 @@ rb_draw
 {
   if(!ctxt)
     return -1;
+  ++ctxt->stats.nb_draw_calls;
   OGL(DrawArrays(rb_to_ogl3_primitive_type[prim_type], 0, count));
   return 0;
 }
@@ -157,6 +159,7 @@ rb_blend(struct rb_context* ctxt, const struct rb_blend_desc* blend)
   if(!ctxt || !blend)
     return -1;
 
+  ++ctxt->stats.nb_state_changes;
   if(blend->enable == 0) {
     OGL(Disable(GL_BLEND));
   } else {
@@ -180,6 +183,7 @@ rb_depth_stencil
   if(!ctxt || !desc)
     return -1;
 
+  ++ctxt->stats.nb_state_changes;
   OGL(DepthMask(desc->enable_depth_write ? GL_TRUE : GL_FALSE));
   if(desc->enable_depth_test == 0) {
     OGL(Disable(GL_DEPTH_TEST));
@@ -224,6 +228,7 @@ rb_rasterizer(struct rb_context* ctxt, const struct rb_rasterizer_desc* desc)
   if(!ctxt || !desc)
     return -1;
 
+  ++ctxt->stats.nb_state_changes;
   if(desc->cull_mode == RB_CULL_NONE) {
     OGL(Disable(GL_CULL_FACE));
   } else {
@@ -245,3 +250,12 @@ rb_get_config(struct rb_context* ctxt, struct rb_config* config)
   return 0;
 }
 
+int
+rb_get_stats(struct rb_context* ctxt, struct rb_stats* stats)
+{
+  if(!ctxt || !stats)
+    return -1;
+  memcpy(stats, &ctxt->stats, sizeof(struct rb_stats));
+  return 0;
+}
+
@@ -200,6 +200,7 @@ rb_bind_program(struct rb_context* ctxt, struct rb_program* program)
     return -1;
 
   ctxt->state_cache.current_program = program ? program->name : 0;
+  ++ctxt->stats.nb_state_changes;
   OGL(UseProgram(ctxt->state_cache.current_program));
   return 0;
 }
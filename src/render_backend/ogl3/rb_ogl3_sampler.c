@@ -227,6 +227,7 @@ rb_bind_sampler
     goto error;
 
   ctxt->state_cache.sampler_binding[tex_unit] = sampler ? sampler->name : 0;
+  ++ctxt->stats.nb_state_changes;
   OGL(BindSampler(tex_unit, ctxt->state_cache.sampler_binding[tex_unit]));
 
 exit:
@@ -288,6 +288,7 @@ rb_bind_tex2d
   }
 
   ctxt->state_cache.texture_binding_2d[tex_unit] = tex ? tex->name : 0;
+  ++ctxt->stats.nb_state_changes;
   OGL(BindTexture
     (GL_TEXTURE_2D, ctxt->state_cache.texture_binding_2d[tex_unit]));
   return 0;
@@ -324,6 +325,8 @@ rb_tex2d_data(struct rb_tex2d* tex, unsigned int level, const void* data)
 
   /* We assume that the default pixel storage alignment is set to 4. */
   if(NULL == tex->pixbuf || NULL == data) {
+    if(data)
+      tex->ctxt->stats.uploaded_size += mip_size;
     if(pixel_size == 4) {
       TEX_IMAGE_2D(data);
     } else {
@@ -354,6 +357,62 @@ rb_tex2d_data(struct rb_tex2d* tex, unsigned int level, const void* data)
   return 0;
 }
 
+int
+rb_tex2d_sub_data
+  (struct rb_tex2d* tex,
+   unsigned int level,
+   unsigned int x,
+   unsigned int y,
+   unsigned int width,
+   unsigned int height,
+   const void* data)
+{
+  struct state_cache* state_cache = NULL;
+  struct mip_level* mip_level = NULL;
+  size_t pixel_size = 0;
+
+  if(!tex || level >= tex->mip_count || !data)
+    return -1;
+  mip_level = tex->mip_list + level;
+  if(x + width > mip_level->width || y + height > mip_level->height)
+    return -1;
+  if(!width || !height)
+    return 0;
+
+  state_cache = &tex->ctxt->state_cache;
+  pixel_size = rb_ogl3_sizeof_pixel(tex->format, tex->type);
+  tex->ctxt->stats.uploaded_size += width * height * pixel_size;
+
+  OGL(BindTexture(GL_TEXTURE_2D, tex->name));
+  /* The sub data are not streamed through the pixel buffer. Ensure that no
+   * pixel unpack buffer is bound. */
+  if(tex->pixbuf)
+    OGL(BindBuffer(tex->pixbuf->target, 0));
+  if(pixel_size != 4)
+    OGL(PixelStorei(GL_UNPACK_ALIGNMENT, 1));
+  OGL(TexSubImage2D
+    (GL_TEXTURE_2D,
+     level,
+     x,
+     y,
+     width,
+     height,
+     tex->format,
+     tex->type,
+     data));
+  if(pixel_size != 4)
+    OGL(PixelStorei(GL_UNPACK_ALIGNMENT, 4));
+  if(tex->pixbuf) {
+    OGL(BindBuffer
+      (tex->pixbuf->target,
+       state_cache->buffer_binding[tex->pixbuf->binding]));
+  }
+  OGL(BindTexture
+    (GL_TEXTURE_2D,
+     state_cache->texture_binding_2d[state_cache->active_texture]));
+  return 0;
+}
+
 #undef BUFFER_OFFSET
 
 /*******************************************************************************
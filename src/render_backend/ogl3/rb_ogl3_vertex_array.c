@@ -29,6 +29,8 @@ ogl3_attrib_nb_components(enum rb_type type)
     case RB_FLOAT2: nb = 2; break;
     case RB_FLOAT3: nb = 3; break;
     case RB_FLOAT4: nb = 4; break;
+    case RB_HALF2: nb = 2; break;
+    case RB_SNORM16x2: nb = 2; break;
     default:
       assert(0);
       break;
@@ -36,6 +38,16 @@ ogl3_attrib_nb_components(enum rb_type type)
   return nb;
 }
 
+static FINLINE GLenum
+ogl3_attrib_component_type(enum rb_type type)
+{
+  switch(type) {
+    case RB_HALF2: return GL_HALF_FLOAT;
+    case RB_SNORM16x2: return GL_SHORT;
+    default: return GL_FLOAT;
+  }
+}
+
 static void
 release_vertex_array(struct ref* ref)
 {
@@ -105,6 +117,7 @@ rb_bind_vertex_array(struct rb_context* ctxt, struct rb_vertex_array* array)
   if(!ctxt)
     return -1;
   ctxt->state_cache.vertex_array_binding = array ? array->name : 0;
+  ++ctxt->stats.nb_state_changes;
   OGL(BindVertexArray(ctxt->state_cache.vertex_array_binding));
   return 0;
 }
@@ -144,8 +157,8 @@ rb_vertex_attrib_array
     OGL(VertexAttribPointer
         (attrib[i].index,
          ogl3_attrib_nb_components(attrib[i].type),
-         GL_FLOAT,
-         GL_FALSE,
+         ogl3_attrib_component_type(attrib[i].type),
+         attrib[i].type == RB_SNORM16x2 ? GL_TRUE : GL_FALSE,
          attrib[i].stride,
          (void*)offset));
   }
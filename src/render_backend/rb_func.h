@@ -48,6 +48,17 @@ RB_FUNC( tex2d_data,
   const void* data
 )
 
+/* Update the sub region of the mip level. The data are tightly packed. */
+RB_FUNC( tex2d_sub_data,
+  struct rb_tex2d* tex,
+  unsigned int mip_level,
+  unsigned int x,
+  unsigned int y,
+  unsigned int width,
+  unsigned int height,
+  const void* data
+)
+
 /*******************************************************************************
  *
  * Sampler
@@ -412,3 +423,8 @@ RB_FUNC( get_config,
   struct rb_config* cfg
 )
 
+RB_FUNC( get_stats,
+  struct rb_context* ctxt,
+  struct rb_stats* stats
+)
+
@@ -77,7 +77,10 @@ enum rb_type {
   RB_FLOAT2,
   RB_FLOAT3,
   RB_FLOAT4,
-  RB_FLOAT4x4
+  RB_FLOAT4x4,
+  /* Packed vertex attrib types. They are seen as RB_FLOAT2 by the shaders. */
+  RB_HALF2,
+  RB_SNORM16x2
 };
 
 enum rb_primitive_type {
@@ -183,6 +186,13 @@ struct rb_config {
   size_t max_tex_max_anisotropy;
 };
 
+/* Counters accumulated since the creation of the context. */
+struct rb_stats {
+  size_t nb_draw_calls;
+  size_t nb_state_changes; /* Bound objects and pipeline states. */
+  size_t uploaded_size; /* In bytes. */
+};
+
 struct rb_sampler_desc {
   enum rb_tex_filter filter;
   enum rb_tex_address address_u;
@@ -16,6 +16,8 @@ enum rdr_type {
   RDR_FLOAT3,
   RDR_FLOAT4,
   RDR_FLOAT4x4,
+  RDR_HALF2, /* 2 half precision floats. */
+  RDR_SNORM16x2, /* 2 normalized signed 16 bits integers. */
   RDR_UNKNOWN_TYPE,
   RDR_NB_TYPES
 };
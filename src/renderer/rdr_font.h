@@ -3,7 +3,9 @@
 
 #include "renderer/rdr.h"
 #include "renderer/rdr_error.h"
+#include <stdbool.h>
 #include <stddef.h>
+#include <wchar.h>
 
 struct rdr_font;
 struct rdr_glyph_desc {
@@ -25,6 +27,11 @@ struct rdr_font_metrics {
 };
 struct rdr_system;
 
+/* Invoked on the first use of a character that is not registered into the
+ * font. Return false if the character cannot be provided. The bitmap buffer
+ * of the glyph must remain valid until the next invocation of the loader. */
+typedef bool (*rdr_glyph_loader_t)(wchar_t, struct rdr_glyph_desc*, void*);
+
 RDR_API enum rdr_error
 rdr_create_font
   (struct rdr_system* sys,
@@ -45,6 +52,15 @@ rdr_font_data
    size_t nb_glyphs,
    const struct rdr_glyph_desc* glyph_list);
 
+/* Reset the font and rasterize its glyphs on demand with the loader. */
+RDR_API enum rdr_error
+rdr_font_glyph_loader
+  (struct rdr_font* font,
+   const struct rdr_font_metrics* metrics,
+   size_t bytes_per_pixel,
+   rdr_glyph_loader_t func,
+   void* data); /* May be NULL. */
+
 RDR_API enum rdr_error
 rdr_get_font_metrics
   (struct rdr_font* font,
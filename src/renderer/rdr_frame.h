@@ -18,6 +18,16 @@ struct rdr_frame_desc {
   unsigned int height;
 };
 
+/* Work submitted to the render backend between two frame flushes. */
+struct rdr_frame_stats {
+  size_t nb_draw_calls;
+  size_t nb_state_changes;
+  size_t uploaded_size; /* In bytes. */
+  size_t nb_instances; /* Submitted model instances. */
+  size_t nb_culled_instances; /* Submitted but not drawn model instances. */
+  size_t nb_triangles; /* Drawn triangles of the model instances. */
+};
+
 RDR_API enum rdr_error
 rdr_create_frame
   (struct rdr_system* sys,
@@ -41,6 +51,12 @@ RDR_API enum rdr_error
 rdr_flush_frame
   (struct rdr_frame* frame);
 
+/* Statistics of the last flushed frame. */
+RDR_API enum rdr_error
+rdr_get_frame_stats
+  (struct rdr_frame* frame,
+   struct rdr_frame_stats* stats);
+
 /*******************************************************************************
  *
  * Draw commands.
@@ -33,6 +33,8 @@ rdr_get_material_log
   (struct rdr_material* mtr,
    const char** out_log);
 
+/* The current program of the material is kept if the new one cannot be
+ * built. Its build log is then available through rdr_get_material_log. */
 RDR_API enum rdr_error
 rdr_material_program
   (struct rdr_material* mtr,
@@ -8,6 +8,15 @@ struct rdr_material;
 struct rdr_mesh;
 struct rdr_system;
 
+/* Maximum number of levels of detail of a model, its mesh included. */
+#define RDR_MAX_MODEL_LODS 8
+
+struct rdr_model_lod {
+  struct rdr_mesh* mesh;
+  /* Object space error of the mesh with respect to the model mesh. */
+  float error;
+};
+
 struct rdr_model;
 
 RDR_API enum rdr_error
@@ -35,6 +44,36 @@ rdr_get_model_mesh
   (struct rdr_model* mdl,
    struct rdr_mesh** mesh);
 
+/* Define the coarser levels of detail of the model, ordered from the finest
+ * to the coarsest with non decreasing errors. The model mesh is the level 0.
+ * The meshes are drawn with the model material and should thus provide the
+ * attribs it uses. A null nb_lods removes the levels of detail. */
+RDR_API enum rdr_error
+rdr_model_lods
+  (struct rdr_model* mdl,
+   size_t nb_lods,
+   const struct rdr_model_lod lod_list[]);
+
+/* Return the levels of detail defined by rdr_model_lods. lod_list may be NULL
+ * or must be large enough to store the returned levels of detail. */
+RDR_API enum rdr_error
+rdr_get_model_lods
+  (struct rdr_model* mdl,
+   size_t* nb_lods,
+   struct rdr_model_lod lod_list[]);
+
+/* Define the triangles that the software occlusion culling rasterizes for
+ * each instance of the model. They hide the instances behind them and should
+ * thus lie inside the model mesh, e.g. its large walls. The vertices are x, y,
+ * z triplets in object space. A null nb_indices removes the occluder. */
+RDR_API enum rdr_error
+rdr_model_occluder
+  (struct rdr_model* mdl,
+   size_t nb_vertices,
+   const float* vertices,
+   size_t nb_indices,
+   const unsigned int* indices);
+
 RDR_API enum rdr_error
 rdr_model_material
   (struct rdr_model* mdl,
@@ -44,6 +44,17 @@ rdr_create_model_instance
    struct rdr_model* model,
    struct rdr_model_instance** out_instance);
 
+/* Create nb_instances instances of model. The transform list stores the 16
+ * column major floats of each instance; if NULL the instances are not
+ * transformed. On error no instance is created. */
+RDR_API enum rdr_error
+rdr_create_model_instances
+  (struct rdr_system* sys,
+   struct rdr_model* model,
+   size_t nb_instances,
+   const float* transform_list, /* May be NULL. */
+   struct rdr_model_instance* instance_list[]);
+
 RDR_API enum rdr_error
 rdr_model_instance_ref_get
   (struct rdr_model_instance* instance);
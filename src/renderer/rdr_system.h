@@ -3,6 +3,7 @@
 
 #include "renderer/rdr.h"
 #include "renderer/rdr_error.h"
+#include <stdbool.h>
 
 struct mem_allocator;
 struct rdr_system;
@@ -33,5 +34,29 @@ rdr_system_detach_log_stream
    void (*stream_func)(const char*, void* stream_data),
    void* stream_data);
 
+/* Notify the dependents of the objects updated since the previous flush. The
+ * notifications are deferred and coalesced, e.g. the instances of a model
+ * whose mesh is updated several times are notified once. The frame flush
+ * implicitly invokes this function. */
+RDR_API enum rdr_error
+rdr_system_flush_notifications
+  (struct rdr_system* sys);
+
+/* Define the maximum screen space error, in pixels, of the levels of detail
+ * selected for the drawn model instances. A null threshold always draws the
+ * model meshes. Default is 1 pixel. */
+RDR_API enum rdr_error
+rdr_system_lod_threshold
+  (struct rdr_system* sys,
+   float pixels);
+
+/* Define whether the im grids are computed on the GPU from a single quad or
+ * built on the CPU as a list of lines. The CPU built grids are cached per
+ * grid parameters. Default is true. */
+RDR_API enum rdr_error
+rdr_system_procedural_grid
+  (struct rdr_system* sys,
+   bool is_enabled);
+
 #endif /* RDR_SYSTEM_H */
 
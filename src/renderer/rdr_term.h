@@ -33,6 +33,16 @@ enum rdr_term_output {
   RDR_TERM_PROMPT
 };
 
+/* Work of the last draw of the terminal. */
+struct rdr_term_stats {
+  size_t nb_glyphs; /* Drawn glyphs. */
+  size_t nb_rebuilt_lines; /* Lines whose glyphs were regenerated. */
+  size_t first_uploaded_glyph; /* First glyph sent to the render backend. */
+  size_t nb_uploaded_glyphs;
+  size_t cursor_pos[2]; /* In pixels, from the bottom left of the term. */
+  size_t cursor_width; /* In pixels. */
+};
+
 RDR_API enum rdr_error
 rdr_create_term
   (struct rdr_system* sys,
@@ -54,6 +64,14 @@ rdr_term_font
   (struct rdr_term* term,
    struct rdr_font* font);
 
+/* Position of the bottom left corner of the terminal in the framebuffer, in
+ * pixels. The terminal lies at the origin by default. */
+RDR_API enum rdr_error
+rdr_term_position
+  (struct rdr_term* term,
+   size_t x,
+   size_t y);
+
 RDR_API enum rdr_error
 rdr_term_translate_cursor
   (struct rdr_term* term,
@@ -101,6 +119,12 @@ RDR_API enum rdr_error
 rdr_term_write_suppr
   (struct rdr_term* term);
 
+/* Statistics of the last draw of the terminal. */
+RDR_API enum rdr_error
+rdr_get_term_stats
+  (struct rdr_term* term,
+   struct rdr_term_stats* stats);
+
 RDR_API enum rdr_error
 rdr_term_dump
   (struct rdr_term* term,
@@ -4,6 +4,7 @@
 #include "renderer/rdr.h"
 #include "renderer/rdr_error.h"
 #include "sys/sys.h"
+#include <stdbool.h>
 
 ALIGN(16) struct rdr_view {
   float transform[16];
@@ -35,10 +36,26 @@ rdr_add_model_instance
   (struct rdr_world* world,
    struct rdr_model_instance* instance);
 
+/* Add a list of instances that are not already in the world. On error none
+ * of them is added. */
+RDR_API enum rdr_error
+rdr_add_model_instances
+  (struct rdr_world* world,
+   size_t nb_instances,
+   struct rdr_model_instance* instance_list[]);
+
 RDR_API enum rdr_error
 rdr_remove_model_instance
   (struct rdr_world* world,
    struct rdr_model_instance* instance);
 
+/* Cull on the CPU the instances that lie outside of the view frustum or behind
+ * the occluders of the drawn models, before their submission to the render
+ * backend. The picking draws all the instances. Disabled by default. */
+RDR_API enum rdr_error
+rdr_world_occlusion_culling
+  (struct rdr_world* world,
+   bool is_enabled);
+
 #endif /* RDR_WORLD_H */
 
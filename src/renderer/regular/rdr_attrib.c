@@ -1,6 +1,7 @@
 #include "renderer/regular/rdr_attrib_c.h"
 #include <assert.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 size_t
 sizeof_rdr_type(enum rdr_type type)
@@ -11,6 +12,8 @@ sizeof_rdr_type(enum rdr_type type)
     case RDR_FLOAT3: return 3 * sizeof(float);
     case RDR_FLOAT4: return 4 * sizeof(float);
     case RDR_FLOAT4x4: return 16 * sizeof(float);
+    case RDR_HALF2: return 2 * sizeof(uint16_t);
+    case RDR_SNORM16x2: return 2 * sizeof(int16_t);
     case RDR_UNKNOWN_TYPE: return 0;
     default:
       assert(false);
@@ -27,6 +30,8 @@ sizeof_rb_type(enum rb_type type)
     case RB_FLOAT3: return 3 * sizeof(float);
     case RB_FLOAT4: return 4 * sizeof(float);
     case RB_FLOAT4x4: return 16 * sizeof(float);
+    case RB_HALF2: return 2 * sizeof(uint16_t);
+    case RB_SNORM16x2: return 2 * sizeof(int16_t);
     case RB_UNKNOWN_TYPE: return 0;
     default:
       assert(false);
@@ -43,6 +48,8 @@ rdr_to_rb_type(enum rdr_type type)
     case RDR_FLOAT3: return RB_FLOAT3;
     case RDR_FLOAT4: return RB_FLOAT4;
     case RDR_FLOAT4x4: return RB_FLOAT4x4;
+    case RDR_HALF2: return RB_HALF2;
+    case RDR_SNORM16x2: return RB_SNORM16x2;
     case RDR_UNKNOWN_TYPE: return RB_UNKNOWN_TYPE;
     default:
       assert(false);
@@ -59,6 +66,8 @@ rb_to_rdr_type(enum rb_type type)
     case RB_FLOAT3: return RDR_FLOAT3;
     case RB_FLOAT4: return RDR_FLOAT4;
     case RB_FLOAT4x4: return RDR_FLOAT4x4;
+    case RB_HALF2: return RDR_HALF2;
+    case RB_SNORM16x2: return RDR_SNORM16x2;
     case RB_UNKNOWN_TYPE: return RDR_UNKNOWN_TYPE;
     default:
       assert(false);
@@ -66,3 +75,14 @@ rb_to_rdr_type(enum rb_type type)
   }
 }
 
+
+enum rb_type
+rb_to_shader_type(enum rb_type type)
+{
+  switch(type) {
+    case RB_HALF2: return RB_FLOAT2;
+    case RB_SNORM16x2: return RB_FLOAT2;
+    default: return type;
+  }
+}
+
@@ -27,5 +27,11 @@ enum rdr_type
 rb_to_rdr_type
   (enum rb_type type);
 
+/* Type of the shader attrib that can be fed by a vertex attrib of the given
+ * type, i.e. RB_FLOAT2 for the packed types. */
+enum rb_type
+rb_to_shader_type
+  (enum rb_type type);
+
 #endif /* RDR_ATTRIB_C_H */
 
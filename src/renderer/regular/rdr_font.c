@@ -8,6 +8,7 @@
 #include "stdlib/sl.h"
 #include "stdlib/sl_hash_table.h"
 #include "stdlib/sl_flat_set.h"
+#include "stdlib/sl_vector.h"
 #include "sys/mem_allocator.h"
 #include "sys/ref_count.h"
 #include "sys/math.h"
@@ -19,19 +20,31 @@
 #include <string.h>
 
 #define DEFAULT_CHAR ((wchar_t)~0)
+#define GLYPH_BORDER 1
 
 struct rdr_font {
   struct ref ref;
   struct sl_flat_set* callback_list[RDR_NB_FONT_SIGNALS];
   struct rdr_system* sys;
   struct sl_hash_table* glyph_htbl;
+  struct sl_vector* skyline; /* Vector of struct segment. */
   struct rb_tex2d* cache_tex;
+  size_t cache_tex_height;
   struct {
     size_t Bpp;
     size_t width;
     size_t height;
     unsigned char* buffer;
   } cache_img;
+  /* Range of the cache image rows that are not uploaded yet. */
+  struct {
+    size_t begin;
+    size_t end;
+  } dirty_rows;
+  struct {
+    rdr_glyph_loader_t func;
+    void* data;
+  } loader;
   size_t line_space;
   size_t min_glyph_width;
   int min_glyph_pos_y;
@@ -78,24 +91,88 @@ compare_callbacks(const void* a, const void* b)
 
 /*******************************************************************************
  *
- * Helper functions and data structure.
+ * Skyline packer. The skyline is the ordered list of the horizontal segments
+ * that bound the packed area of the cache image. A rectangle is positioned
+ * onto the segment that minimizes its top edge, and the skyline is then
+ * raised by the rectangle.
  *
  ******************************************************************************/
-#define EXTENDABLE_X 1
-#define EXTENDABLE_Y 2
-
-struct node {
-  struct node* left;
-  struct node* right;
+struct segment {
   size_t x, y;
-  size_t width, height;
-  int extendable_flag;
-  size_t id;
+  size_t width;
 };
 
-#define GLYPH_BORDER 1
-#define IS_LEAF(n) (!((n)->left || (n)->right))
+static bool
+skyline_fit
+  (const struct segment* segs,
+   size_t nb_segs,
+   size_t id,
+   size_t width,
+   size_t cache_width,
+   size_t* out_y)
+{
+  size_t y = 0;
+  size_t remaining = width;
+  assert(segs && id < nb_segs && out_y);
+
+  if(segs[id].x + width > cache_width)
+    return false;
+
+  while(remaining) {
+    assert(id < nb_segs);
+    y = MAX(y, segs[id].y);
+    remaining -= MIN(remaining, segs[id].width);
+    ++id;
+  }
+  *out_y = y;
+  return true;
+}
+
+static void
+skyline_raise
+  (struct sl_vector* skyline,
+   size_t id,
+   size_t x,
+   size_t y,
+   size_t width)
+{
+  struct segment* segs = NULL;
+  size_t nb_segs = 0;
+  size_t i = 0;
+  assert(skyline);
+
+  SL(vector_insert(skyline, id, (struct segment[]){{x, y, width}}));
+
+  /* Shrink or remove the segments covered by the new segment. */
+  SL(vector_buffer(skyline, &nb_segs, NULL, NULL, (void**)&segs));
+  i = id + 1;
+  while(i < nb_segs && segs[i].x < x + width) {
+    const size_t shrink = x + width - segs[i].x;
+    if(segs[i].width > shrink) {
+      segs[i].x += shrink;
+      segs[i].width -= shrink;
+      break;
+    }
+    SL(vector_erase(skyline, i));
+    SL(vector_buffer(skyline, &nb_segs, NULL, NULL, (void**)&segs));
+  }
+  /* Merge the contiguous segments of same height. */
+  for(i = 0; i + 1 < nb_segs;) {
+    if(segs[i].y != segs[i + 1].y) {
+      ++i;
+    } else {
+      segs[i].width += segs[i + 1].width;
+      SL(vector_erase(skyline, i + 1));
+      SL(vector_buffer(skyline, &nb_segs, NULL, NULL, (void**)&segs));
+    }
+  }
+}
 
+/*******************************************************************************
+ *
+ * Helper functions.
+ *
+ ******************************************************************************/
 static void
 invoke_callbacks(struct rdr_font* font, enum rdr_font_signal signal)
 {
@@ -111,119 +188,6 @@ invoke_callbacks(struct rdr_font* font, enum rdr_font_signal signal)
   }
 }
 
-static struct node*
-insert_rect
-  (struct mem_allocator* allocator,
-   struct node* node,
-   size_t width,
-   size_t height)
-{
-  struct node* ret_node = NULL;
-
-  if(!node) {
-    ret_node = NULL;
-  } else if(!IS_LEAF(node)) {
-    ret_node = insert_rect(allocator, node->left, width, height);
-    if(!ret_node && node->right)
-      ret_node = insert_rect(allocator, node->right, width, height);
-  } else {
-    /* Adjust the width and height in order to take care of the glyph border. */
-    width += GLYPH_BORDER;
-    height += GLYPH_BORDER;
-
-    if(width > node->width || height > node->height) {
-      /* The leaf is too small to store the rectangle. */
-      ret_node = NULL;
-    } else {
-      const size_t w = node->width - width;
-      const size_t h = node->height - height;
-
-      node->left = MEM_CALLOC(allocator, 1, sizeof(struct node));
-      assert(node->left);
-      node->right = MEM_CALLOC(allocator, 1, sizeof(struct node));
-      assert(node->right);
-
-      if(w > h) {
-        /* +-----+
-         * |R |  | ##: current node
-         * +--+L | L : left node
-         * |##|  | R : right node
-         * +--+--+
-         */
-        node->left->x = node->x + width;
-        node->left->y = node->y;
-        node->left->width = w;
-        node->left->height = node->height;
-        node->left->extendable_flag = node->extendable_flag;
-
-        node->right->x = node->x;
-        node->right->y = node->y + height;
-        node->right->width = width;
-        node->right->height = h;
-        node->right->extendable_flag = node->extendable_flag & (~EXTENDABLE_X);
-     } else {
-        /* +-------+
-         * |   L   | ##: current node
-         * +--+----+ L : left node
-         * |##| R  | R : right node
-         * +--+----+
-         */
-        node->left->x = node->x;
-        node->left->y = node->y + height;
-        node->left->width = node->width;
-        node->left->height = h;
-        node->left->extendable_flag = node->extendable_flag;
-
-        node->right->x = node->x + width;
-        node->right->y = node->y;
-        node->right->width = w;
-        node->right->height = height;
-        node->right->extendable_flag = node->extendable_flag & (~EXTENDABLE_Y);
-      }
-      node->width = width;
-      node->height = height;
-      node->extendable_flag = 0;
-      ret_node = node;
-    }
-  }
-  return ret_node;
-}
-static void
-extend_width(struct node* node, size_t size)
-{
-  assert(node);
-  if(!IS_LEAF(node)) {
-    extend_width(node->left, size);
-    extend_width(node->right, size);
-  } else {
-    if((node->extendable_flag & EXTENDABLE_X) != 0)
-      node->width += size;
-  }
-}
-
-static void
-extend_height(struct node* node, size_t size)
-{
-  assert(node);
-  if(!IS_LEAF(node)) {
-    extend_height(node->left, size);
-    extend_height(node->right, size);
-  } else {
-    if((node->extendable_flag & EXTENDABLE_Y) != 0)
-      node->height += size;
-  }
-}
-
-static void
-free_binary_tree(struct mem_allocator* allocator, struct node* node)
-{
-  if(node->left)
-    free_binary_tree(allocator, node->left);
-  if(node->right)
-    free_binary_tree(allocator, node->right);
-  MEM_FREE(allocator, node);
-}
-
 static void
 copy_bitmap
   (unsigned char* restrict dst,
@@ -246,96 +210,15 @@ copy_bitmap
   }
 }
 
-static void
-compute_initial_cache_size
-  (size_t nb_glyphs,
-   const struct rdr_glyph_desc* glyph_list,
-   size_t* out_width,
-   size_t* out_height)
-{
-  size_t width = 0;
-  size_t height = 0;
-  size_t i = 0;
-
-  assert(glyph_list && out_width && out_height);
-
-  for(i = 0; i < nb_glyphs; ++i) {
-    const size_t w =  glyph_list[i].bitmap.width;
-    const size_t h =  glyph_list[i].bitmap.height;
-    width = w > width ? w : width;
-    height = h > height ? h : height;
-  }
-  /* We multiply the max size required by a glyph by 4 in each dimension in
-   * order to store at least 16 glyphs in a the texture. */
-  *out_width = (width + GLYPH_BORDER) * 4;
-  *out_height = (height + GLYPH_BORDER) * 4;
-}
-
-static void
-fill_font_cache
-  (const struct node* node,
-   struct rdr_font* font,
-   const struct rdr_glyph_desc* glyph_list)
-{
-  assert(node && font);
-  if(!IS_LEAF(node)) {
-    struct rdr_glyph* glyph;
-    const struct rdr_glyph_desc* glyph_desc = glyph_list + node->id;
-    const size_t cache_Bpp = font->cache_img.Bpp;
-    const size_t cache_pitch = font->cache_img.width * cache_Bpp;
-    const float rcp_cache_width = 1.f / (float)font->cache_img.width;
-    const float rcp_cache_height = 1.f / (float)font->cache_img.height;
-    const size_t w = node->width - GLYPH_BORDER;
-    const size_t h = node->height - GLYPH_BORDER;
-    const size_t x = node->x == 0 ? GLYPH_BORDER : node->x;
-    const size_t y = node->y == 0 ? GLYPH_BORDER : node->y;
-    const size_t glyph_bmp_size =
-      glyph_desc->bitmap.width
-    * glyph_desc->bitmap.height
-    * glyph_desc->bitmap.bytes_per_pixel;
-
-    SL(hash_table_find
-      (font->glyph_htbl, &glyph_desc->character,(void**)&glyph));
-    assert(glyph);
-
-    glyph->width = glyph_desc->width;
-    glyph->tex[0].x = (float)x * rcp_cache_width;
-    glyph->tex[0].y = (float)(y + h) * rcp_cache_height;
-    glyph->tex[1].x = (float)(x + w) * rcp_cache_width;
-    glyph->tex[1].y = (float)y * rcp_cache_height;
-
-    glyph->pos[0].x = (float)glyph_desc->bitmap_left;
-    glyph->pos[0].y = (float)glyph_desc->bitmap_top;
-    glyph->pos[1].x = (float)(glyph_desc->bitmap_left + w);
-    glyph->pos[1].y = (float)(glyph_desc->bitmap_top + h);
-
-    /* The glyph bitmap size may be equal to zero (e.g.: the space char). */
-    if(0 != glyph_bmp_size) {
-      unsigned char* dst = NULL;
-      assert(glyph_desc->bitmap.bytes_per_pixel == cache_Bpp);
-      dst = font->cache_img.buffer + y * cache_pitch + x * cache_Bpp;
-      copy_bitmap
-        (dst,
-         cache_pitch,
-         glyph_desc->bitmap.buffer,
-         glyph_desc->bitmap.width * cache_Bpp,
-         glyph_desc->bitmap.width,
-         glyph_desc->bitmap.height,
-         cache_Bpp);
-    }
-    fill_font_cache(node->left, font, glyph_list);
-    fill_font_cache(node->right, font, glyph_list);
-  }
-}
-
 static int
 cmp_glyph(const void* a, const void* b)
 {
+  /* Descending order with respect to the bitmap height. */
   const struct rdr_glyph_desc* glyph0 = a;
   const struct rdr_glyph_desc* glyph1 = b;
-  const size_t area0 = glyph0->bitmap.width * glyph0->bitmap.height;
-  const size_t area1 = glyph1->bitmap.width * glyph1->bitmap.height;
-  return (int)(area1 - area0);
+  const size_t h0 = glyph0->bitmap.height;
+  const size_t h1 = glyph1->bitmap.height;
+  return (h0 < h1) - (h0 > h1);
 }
 
 static enum rb_tex_format
@@ -356,21 +239,229 @@ Bpp_to_rb_tex_format(size_t Bpp)
   return tex_format;
 }
 
+/* Grow the cache image height in place. Since its width does not change, the
+ * already packed glyphs keep their position. */
+static enum rdr_error
+grow_cache(struct rdr_font* font, size_t min_height)
+{
+  unsigned char* buffer = NULL;
+  const size_t max_tex_size = font->sys->cfg.max_tex_size;
+  const size_t pitch = font->cache_img.width * font->cache_img.Bpp;
+  size_t height = 0;
+  assert(font && font->cache_img.height && min_height > font->cache_img.height);
+
+  height = font->cache_img.height;
+  while(height < min_height)
+    height *= 2;
+  height = MIN(height, max_tex_size);
+  if(height < min_height)
+    return RDR_MEMORY_ERROR;
+
+  buffer = MEM_REALLOC(font->sys->allocator, font->cache_img.buffer,
+    height * pitch);
+  if(!buffer)
+    return RDR_MEMORY_ERROR;
+  memset
+    (buffer + font->cache_img.height * pitch,
+     0,
+     (height - font->cache_img.height) * pitch);
+  font->cache_img.buffer = buffer;
+  font->cache_img.height = height;
+  return RDR_NO_ERROR;
+}
+
+static enum rdr_error
+pack_rect
+  (struct rdr_font* font,
+   size_t width,
+   size_t height,
+   size_t* out_x,
+   size_t* out_y)
+{
+  struct segment* segs = NULL;
+  size_t nb_segs = 0;
+  size_t best_id = SIZE_MAX;
+  size_t best_y = SIZE_MAX;
+  size_t best_width = SIZE_MAX;
+  size_t i = 0;
+  enum rdr_error rdr_err = RDR_NO_ERROR;
+  assert(font && out_x && out_y);
+
+  SL(vector_buffer(font->skyline, &nb_segs, NULL, NULL, (void**)&segs));
+  for(i = 0; i < nb_segs; ++i) {
+    size_t y = 0;
+    if(skyline_fit(segs, nb_segs, i, width, font->cache_img.width, &y)) {
+      if(y < best_y || (y == best_y && segs[i].width < best_width)) {
+        best_id = i;
+        best_y = y;
+        best_width = segs[i].width;
+      }
+    }
+  }
+  if(best_id == SIZE_MAX)
+    return RDR_MEMORY_ERROR;
+
+  if(best_y + height > font->cache_img.height) {
+    rdr_err = grow_cache(font, best_y + height);
+    if(rdr_err != RDR_NO_ERROR)
+      return rdr_err;
+  }
+  *out_x = segs[best_id].x;
+  *out_y = best_y;
+  skyline_raise(font->skyline, best_id, *out_x, best_y + height, width);
+  return RDR_NO_ERROR;
+}
+
+static enum rdr_error
+register_glyph(struct rdr_font* font, const struct rdr_glyph_desc* desc)
+{
+  struct rdr_glyph glyph;
+  void* data = NULL;
+  const size_t w = desc->bitmap.width;
+  const size_t h = desc->bitmap.height;
+  const size_t bmp_size = w * h * desc->bitmap.bytes_per_pixel;
+  size_t x = 0;
+  size_t y = 0;
+  enum rdr_error rdr_err = RDR_NO_ERROR;
+  enum sl_error sl_err = SL_NO_ERROR;
+  assert(font && desc);
+  memset(&glyph, 0, sizeof(glyph));
+
+  if(desc->bitmap.bytes_per_pixel != font->cache_img.Bpp
+  || (bmp_size && !desc->bitmap.buffer))
+    return RDR_INVALID_ARGUMENT;
+
+  /* Check whether the glyph character is already registered or not. */
+  SL(hash_table_find(font->glyph_htbl, &desc->character, &data));
+  if(data != NULL)
+    return RDR_NO_ERROR;
+
+  /* The glyph bitmap size may be equal to zero (e.g.: the space char). */
+  if(0 != bmp_size) {
+    const size_t Bpp = font->cache_img.Bpp;
+    const size_t pitch = font->cache_img.width * Bpp;
+
+    /* Adjust the width and height in order to take care of the glyph
+     * border. */
+    rdr_err = pack_rect(font, w + GLYPH_BORDER, h + GLYPH_BORDER, &x, &y);
+    if(rdr_err != RDR_NO_ERROR)
+      return rdr_err;
+    x += GLYPH_BORDER;
+    y += GLYPH_BORDER;
+    copy_bitmap
+      (font->cache_img.buffer + y * pitch + x * Bpp,
+       pitch,
+       desc->bitmap.buffer,
+       w * Bpp,
+       w,
+       h,
+       Bpp);
+    if(font->dirty_rows.begin == font->dirty_rows.end) {
+      font->dirty_rows.begin = y;
+      font->dirty_rows.end = y + h;
+    } else {
+      font->dirty_rows.begin = MIN(font->dirty_rows.begin, y);
+      font->dirty_rows.end = MAX(font->dirty_rows.end, y + h);
+    }
+  }
+  /* The texture coordinates are expressed in texels in order to be invariant
+   * to the growth of the cache. */
+  glyph.width = desc->width;
+  glyph.tex[0].x = (float)x;
+  glyph.tex[0].y = (float)(y + h);
+  glyph.tex[1].x = (float)(x + w);
+  glyph.tex[1].y = (float)y;
+
+  glyph.pos[0].x = (float)desc->bitmap_left;
+  glyph.pos[0].y = (float)desc->bitmap_top;
+  glyph.pos[1].x = (float)(desc->bitmap_left + (int)w);
+  glyph.pos[1].y = (float)(desc->bitmap_top + (int)h);
+
+  sl_err = sl_hash_table_insert(font->glyph_htbl, &desc->character, &glyph);
+  if(sl_err != SL_NO_ERROR)
+    return sl_to_rdr_error(sl_err);
+  return RDR_NO_ERROR;
+}
+
+/* Register the character as an alias of the default glyph. On insertion
+ * error the character is simply not cached. */
+static void
+register_default_glyph_alias(struct rdr_font* font, wchar_t character)
+{
+  struct rdr_glyph glyph;
+  struct rdr_glyph* default_glyph = NULL;
+  assert(font);
+
+  SL(hash_table_find
+    (font->glyph_htbl, (wchar_t[]){DEFAULT_CHAR}, (void**)&default_glyph));
+  assert(NULL != default_glyph);
+  glyph = *default_glyph;
+  sl_hash_table_insert(font->glyph_htbl, &character, &glyph);
+}
+
+/* Upload the cache image into the cache texture. The texture is re-created
+ * if the cache grew; otherwise only the dirty rows are updated. */
+static void
+flush_cache(struct rdr_font* font)
+{
+  const size_t pitch = font->cache_img.width * font->cache_img.Bpp;
+  assert(font);
+
+  if(!font->cache_img.buffer)
+    return;
+
+  if(font->cache_tex_height != font->cache_img.height) {
+    struct rb_tex2d_desc tex2d_desc;
+    memset(&tex2d_desc, 0, sizeof(tex2d_desc));
+
+    if(font->cache_tex) {
+      RBI(&font->sys->rb, tex2d_ref_put(font->cache_tex));
+      font->cache_tex = NULL;
+    }
+    tex2d_desc.width = font->cache_img.width;
+    tex2d_desc.height = font->cache_img.height;
+    tex2d_desc.mip_count = 1;
+    tex2d_desc.format = Bpp_to_rb_tex_format(font->cache_img.Bpp);
+    tex2d_desc.usage = RB_USAGE_DEFAULT;
+    tex2d_desc.compress = 0;
+    RBI(&font->sys->rb, create_tex2d
+      (font->sys->ctxt,
+       &tex2d_desc,
+       (const void**)&font->cache_img.buffer,
+       &font->cache_tex));
+    font->cache_tex_height = font->cache_img.height;
+  } else if(font->dirty_rows.begin != font->dirty_rows.end) {
+    RBI(&font->sys->rb, tex2d_sub_data
+      (font->cache_tex,
+       0,
+       0,
+       font->dirty_rows.begin,
+       font->cache_img.width,
+       font->dirty_rows.end - font->dirty_rows.begin,
+       font->cache_img.buffer + font->dirty_rows.begin * pitch));
+  }
+  font->dirty_rows.begin = font->dirty_rows.end = 0;
+}
+
 static void
 reset_font(struct rdr_font* font)
 {
   assert(font);
 
   SL(hash_table_clear(font->glyph_htbl));
+  SL(clear_vector(font->skyline));
 
   if(font->cache_tex) {
     RBI(&font->sys->rb, tex2d_ref_put(font->cache_tex));
     font->cache_tex = NULL;
   }
+  font->cache_tex_height = 0;
 
   if(font->cache_img.buffer)
     MEM_FREE(font->sys->allocator, font->cache_img.buffer);
   memset(&font->cache_img, 0, sizeof(font->cache_img));
+  memset(&font->dirty_rows, 0, sizeof(font->dirty_rows));
+  memset(&font->loader, 0, sizeof(font->loader));
 
   font->line_space = 0;
   invoke_callbacks(font, RDR_FONT_SIGNAL_UPDATE_DATA);
@@ -433,6 +524,59 @@ free_default_glyph
   memset(glyph, 0, sizeof(struct rdr_glyph_desc));
 }
 
+/* Allocate the cache image and register the default glyph whose bitmap is a
+ * box of the submitted size. The cache is sized in order to store at least
+ * 16x4 glyphs of this size. */
+static enum rdr_error
+setup_cache
+  (struct rdr_font* font,
+   size_t Bpp,
+   size_t glyph_width,
+   size_t glyph_height)
+{
+  struct rdr_glyph_desc default_glyph;
+  const size_t max_tex_size = font->sys->cfg.max_tex_size;
+  size_t width = 0;
+  size_t height = 0;
+  enum rdr_error rdr_err = RDR_NO_ERROR;
+  enum sl_error sl_err = SL_NO_ERROR;
+  assert(font && (Bpp == 1 || Bpp == 3) && !font->cache_img.buffer);
+  memset(&default_glyph, 0, sizeof(default_glyph));
+
+  width = MIN((glyph_width + GLYPH_BORDER) * 16 + GLYPH_BORDER, max_tex_size);
+  height = MIN((glyph_height + GLYPH_BORDER) * 4 + GLYPH_BORDER, max_tex_size);
+
+  font->cache_img.buffer = MEM_CALLOC(font->sys->allocator, width * height, Bpp);
+  if(!font->cache_img.buffer) {
+    rdr_err = RDR_MEMORY_ERROR;
+    goto error;
+  }
+  font->cache_img.Bpp = Bpp;
+  font->cache_img.width = width;
+  font->cache_img.height = height;
+
+  sl_err = sl_vector_push_back
+    (font->skyline, (struct segment[]){{0, 0, width}});
+  if(sl_err != SL_NO_ERROR) {
+    rdr_err = sl_to_rdr_error(sl_err);
+    goto error;
+  }
+
+  rdr_err = create_default_glyph
+    (font->sys->allocator, glyph_width, glyph_height, Bpp, &default_glyph);
+  if(rdr_err != RDR_NO_ERROR)
+    goto error;
+  rdr_err = register_glyph(font, &default_glyph);
+  if(rdr_err != RDR_NO_ERROR)
+    goto error;
+
+exit:
+  free_default_glyph(font->sys->allocator, &default_glyph);
+  return rdr_err;
+error:
+  goto exit;
+}
+
 static void
 release_font(struct ref* ref)
 {
@@ -445,6 +589,8 @@ release_font(struct ref* ref)
 
   if(font->glyph_htbl)
     SL(free_hash_table(font->glyph_htbl));
+  if(font->skyline)
+    SL(free_vector(font->skyline));
   for(i = 0; i < RDR_NB_FONT_SIGNALS; ++i) {
     if(font->callback_list[i]) {
       SL(free_flat_set(font->callback_list[i]));
@@ -459,8 +605,6 @@ release_font(struct ref* ref)
   RDR(system_ref_put(sys));
 }
 
-#undef IS_LEAF
-
 /*******************************************************************************
  *
  * Font functions.
@@ -501,6 +645,16 @@ rdr_create_font(struct rdr_system* sys, struct rdr_font** out_font)
     goto error;
   }
 
+  sl_err = sl_create_vector
+    (sizeof(struct segment),
+     ALIGNOF(struct segment),
+     font->sys->allocator,
+     &font->skyline);
+  if(sl_err != SL_NO_ERROR) {
+    rdr_err = sl_to_rdr_error(sl_err);
+    goto error;
+  }
+
   for(i = 0; i < RDR_NB_FONT_SIGNALS; ++i) {
     sl_err = sl_create_flat_set
       (sizeof(struct callback),
@@ -551,19 +705,12 @@ rdr_font_data
    size_t nb_glyphs,
    const struct rdr_glyph_desc* glyph_list)
 {
-  struct rb_tex2d_desc tex2d_desc;
-  struct rdr_glyph_desc default_glyph;
   struct rdr_glyph_desc* sorted_glyphs = NULL;
-  struct node* root = NULL;
   size_t Bpp = 0;
-  size_t cache_width = 0;
-  size_t cache_height = 0;
   size_t i = 0;
   size_t max_bmp_width = 0;
   size_t max_bmp_height = 0;
   enum rdr_error rdr_err = RDR_NO_ERROR;
-  memset(&tex2d_desc, 0, sizeof(tex2d_desc));
-  memset(&default_glyph, 0, sizeof(default_glyph));
 
   if(!font || (nb_glyphs && !glyph_list)) {
     rdr_err = RDR_INVALID_ARGUMENT;
@@ -590,139 +737,79 @@ rdr_font_data
     rdr_err = RDR_INVALID_ARGUMENT;
     goto error;
   }
-  rdr_err = create_default_glyph
-    (font->sys->allocator, max_bmp_width, max_bmp_height, Bpp, &default_glyph);
+  rdr_err = setup_cache(font, Bpp, max_bmp_width, max_bmp_height);
   if(RDR_NO_ERROR != rdr_err)
     goto error;
 
-  /* Sort the input glyphs in descending order with respect to their
-   * bitmap size. */
-  sorted_glyphs = MEM_CALLOC /* +1 <=> default glyph. */
-    (font->sys->allocator, nb_glyphs + 1, sizeof(struct rdr_glyph_desc));
+  /* Sort the input glyphs in descending order with respect to their bitmap
+   * height in order to reduce the space wasted by the skyline packer. */
+  sorted_glyphs = MEM_CALLOC
+    (font->sys->allocator, nb_glyphs, sizeof(struct rdr_glyph_desc));
   if(!sorted_glyphs) {
     rdr_err = RDR_MEMORY_ERROR;
     goto error;
   }
-  memcpy(sorted_glyphs, &default_glyph, sizeof(struct rdr_glyph_desc));
-  memcpy(sorted_glyphs + 1, glyph_list, sizeof(struct rdr_glyph_desc)*nb_glyphs);
-  ++nb_glyphs; /* Take into account the default glyph. */
-
+  memcpy(sorted_glyphs, glyph_list, sizeof(struct rdr_glyph_desc)*nb_glyphs);
   qsort(sorted_glyphs, nb_glyphs, sizeof(struct rdr_glyph_desc), cmp_glyph);
 
-  /* Create the binary tree data structure used to pack the glyphs into the
-   * cache texture. */
-  compute_initial_cache_size
-    (nb_glyphs, sorted_glyphs, &cache_width, &cache_height);
-  root = MEM_CALLOC(font->sys->allocator, 1, sizeof(struct node));
-  if(!root) {
-    rdr_err = RDR_MEMORY_ERROR;
-    goto error;
-  }
-  root->x = 0;
-  root->y = 0;
-  root->width = cache_width;
-  root->height = cache_height;
-  root->extendable_flag = EXTENDABLE_X | EXTENDABLE_Y;
-  root->id = SIZE_MAX;
-
   for(i = 0; i < nb_glyphs; ++i) {
-    void* data = NULL;
-    struct node* node = NULL;
-    size_t width = 0;
-    size_t height = 0;
-
-    /* Check the conformity of the glyph bitmap format. */
-    if(sorted_glyphs[i].bitmap.bytes_per_pixel != Bpp) {
-      rdr_err = RDR_INVALID_ARGUMENT;
-      goto error;
-    }
-    width = sorted_glyphs[i].bitmap.width;
-    height = sorted_glyphs[i].bitmap.height;
-    /* Check whether the glyph character is already registered or not. */
-    SL(hash_table_find(font->glyph_htbl, &sorted_glyphs[i].character, &data));
-    if(data != NULL) {
-      continue;
-    } else {
-      wchar_t character = 0;
-      struct rdr_glyph glyph;
-      enum sl_error sl_err = SL_NO_ERROR;
-      memset(&glyph, 0, sizeof(glyph));
-
-      character = sorted_glyphs[i].character;
-      sl_err = sl_hash_table_insert(font->glyph_htbl, &character, &glyph);
-      if(sl_err != SL_NO_ERROR) {
-        rdr_err = sl_to_rdr_error(sl_err);
-        goto error;
-      }
-    }
-    /* Pack the glyph bitmap. */
-    node = insert_rect(font->sys->allocator, root, width, height);
-    while(!node) {
-      const size_t max_tex_size = font->sys->cfg.max_tex_size;
-      const size_t extend_x = MAX(width / 2, 1);
-      const size_t extend_y = MAX(height / 2, 1);
-      const bool can_extend_w = (cache_width + extend_x) <= max_tex_size;
-      const bool can_extend_h = (cache_height + extend_y) <= max_tex_size;
-      const bool extend_w = can_extend_w && cache_width < cache_height;
-      const bool extend_h = can_extend_h && !extend_w;
-
-      if(extend_w) {
-        extend_width(root, extend_x);
-        cache_width += extend_x;
-      } else if(extend_h) {
-        extend_height(root, extend_y);
-        cache_height += extend_y;
-      } else if(can_extend_w) {
-        extend_width(root, extend_x);
-        cache_width += extend_x;
-      } else if(can_extend_h) {
-        extend_height(root, extend_y);
-        cache_height += extend_y;
-      } else {
-        rdr_err = RDR_MEMORY_ERROR;
-        goto error;
-      }
-      node = insert_rect(font->sys->allocator, root, width, height);
-    }
-    if(!node) {
-      rdr_err = RDR_MEMORY_ERROR;
+    rdr_err = register_glyph(font, sorted_glyphs + i);
+    if(rdr_err != RDR_NO_ERROR)
       goto error;
-    }
-    node->id = i;
   }
-  /* Use the pack information to fill the font glyph cache. */
-  font->cache_img.Bpp = Bpp;
-  font->cache_img.width = cache_width;
-  font->cache_img.height = cache_height;
-  font->cache_img.buffer = MEM_CALLOC
-    (font->sys->allocator, cache_width * cache_height, Bpp);
-  if(!font->cache_img.buffer) {
-    rdr_err = RDR_MEMORY_ERROR;
+  flush_cache(font);
+  invoke_callbacks(font, RDR_FONT_SIGNAL_UPDATE_DATA);
+
+exit:
+  if(sorted_glyphs)
+    MEM_FREE(font->sys->allocator, sorted_glyphs);
+  return rdr_err;
+error:
+  if(font)
+    reset_font(font);
+  goto exit;
+}
+
+enum rdr_error
+rdr_font_glyph_loader
+  (struct rdr_font* font,
+   const struct rdr_font_metrics* metrics,
+   size_t bytes_per_pixel,
+   rdr_glyph_loader_t func,
+   void* data)
+{
+  size_t width = 0;
+  size_t height = 0;
+  enum rdr_error rdr_err = RDR_NO_ERROR;
+
+  if(!font
+  || !metrics
+  || !metrics->line_space
+  || !func
+  || (bytes_per_pixel != 1 && bytes_per_pixel != 3)) {
+    rdr_err = RDR_INVALID_ARGUMENT;
     goto error;
   }
-  fill_font_cache(root, font, sorted_glyphs);
-  /* Setup the cache texture. */
-  tex2d_desc.width = cache_width;
-  tex2d_desc.height = cache_height;
-  tex2d_desc.mip_count = 1;
-  tex2d_desc.format = Bpp_to_rb_tex_format(Bpp);
-  tex2d_desc.usage = RB_USAGE_IMMUTABLE;
-  tex2d_desc.compress = 0;
-  RBI(&font->sys->rb, create_tex2d
-    (font->sys->ctxt,
-     &tex2d_desc,
-     (const void**)&font->cache_img.buffer,
-     &font->cache_tex));
+  reset_font(font);
+
+  font->line_space = metrics->line_space;
+  font->min_glyph_width = metrics->min_glyph_width;
+  font->min_glyph_pos_y = metrics->min_glyph_pos_y;
+
+  /* No glyph bitmap is known yet. The default glyph is thus a box whose width
+   * is half the line space and whose height is 3/4 of the line space. */
+  width = MAX(metrics->line_space / 2, 1);
+  height = MAX(metrics->line_space - metrics->line_space / 4, 1);
+  rdr_err = setup_cache(font, bytes_per_pixel, width, height);
+  if(RDR_NO_ERROR != rdr_err)
+    goto error;
+  font->loader.func = func;
+  font->loader.data = data;
 
+  flush_cache(font);
   invoke_callbacks(font, RDR_FONT_SIGNAL_UPDATE_DATA);
 
 exit:
-  if(font)
-    free_default_glyph(font->sys->allocator, &default_glyph);
-  if(root)
-    free_binary_tree(font->sys->allocator, root);
-  if(sorted_glyphs)
-    MEM_FREE(font->sys->allocator, sorted_glyphs);
   return rdr_err;
 error:
   if(font)
@@ -784,6 +871,22 @@ rdr_get_font_glyph
   }
   SL(hash_table_find(font->glyph_htbl, &character,(void**)&glyph));
 
+  if(glyph == NULL && font->loader.func) {
+    struct rdr_glyph_desc desc;
+    memset(&desc, 0, sizeof(desc));
+
+    /* Rasterize the glyph on its first use. The character that cannot be
+     * loaded or packed is registered as the default glyph in order to not
+     * invoke the loader again. */
+    bool is_loaded = font->loader.func(character, &desc, font->loader.data);
+    if(is_loaded) {
+      desc.character = character;
+      is_loaded = register_glyph(font, &desc) == RDR_NO_ERROR;
+    }
+    if(!is_loaded)
+      register_default_glyph_alias(font, character);
+    SL(hash_table_find(font->glyph_htbl, &character, (void**)&glyph));
+  }
   if(glyph == NULL) {
     SL(hash_table_find
       (font->glyph_htbl, (wchar_t[]){DEFAULT_CHAR}, (void**)&glyph));
@@ -802,6 +905,7 @@ rdr_get_font_texture(struct rdr_font* font, struct rb_tex2d** tex)
 {
   if(!font || !tex)
     return RDR_INVALID_ARGUMENT;
+  flush_cache(font);
   *tex = font->cache_tex;
   return RDR_NO_ERROR;
 }
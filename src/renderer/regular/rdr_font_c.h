@@ -17,7 +17,7 @@ struct rdr_glyph {
   struct {
     float x;
     float y;
-  } tex[2], pos[2];
+  } tex[2], pos[2]; /* Texture coordinates are in texels. */
 };
 
 struct rb_tex2d;
@@ -29,6 +29,8 @@ rdr_get_font_glyph
    wchar_t character,
    struct rdr_glyph* desc);
 
+/* Upload the glyphs rasterized since the last call before returning the
+ * cache texture. */
 LOCAL_SYM enum rdr_error
 rdr_get_font_texture
   (struct rdr_font* font,
@@ -13,6 +13,7 @@
 #include "renderer/rdr_term.h"
 #include "renderer/rdr_world.h"
 #include "sys/mem_allocator.h"
+#include "sys/profiler.h"
 #include "sys/sys.h"
 #include <assert.h>
 #include <stddef.h>
@@ -20,7 +21,7 @@
 
 #define MAX_DRAW_TERM_COMMANDS 4
 #define MAX_DRAW_WORLD_COMMANDS 4
-#define MAX_IMDRAW_COMMANDS 512
+#define NB_IMDRAW_COMMANDS_PER_BLOCK 512
 #define MAX_PICK_COMMANDS 4
 #define MAX_SHOW_PICK_COMMANDS 1
 #define MAX_PICK_IMDRAW_COMMANDS 1
@@ -82,6 +83,10 @@ ALIGN(16) struct rdr_frame {
   struct rdr_system* sys;
   float bkg_color[4];
   bool show_picking;
+  /* Counters of the system at the end of the last flush. */
+  struct rb_stats flushed_rb_stats;
+  struct rdr_system_stats flushed_sys_stats;
+  struct rdr_frame_stats stats; /* Of the last flushed frame. */
 };
 
 /*******************************************************************************
@@ -361,11 +366,11 @@ imdraw_grid
          vaxis_color && haxis_color);
 
   RDR(get_imdraw_command(frame->imdraw.cmdbuf, &cmd));
-  memset(&cmd->data.grid, 0, sizeof(cmd->data.grid));
   if(UNLIKELY(!cmd)) {
     rdr_err = RDR_MEMORY_ERROR;
     goto error;
   }
+  memset(&cmd->data.grid, 0, sizeof(cmd->data.grid));
   compute_imdraw_transform(frame, flag, rview, trans, tmp);
   cmd->type = RDR_IMDRAW_GRID;
   cmd->flag = flag;
@@ -450,7 +455,7 @@ rdr_create_frame
   frame->sys = sys;
 
   rdr_err = rdr_create_imdraw_command_buffer
-    (sys, MAX_IMDRAW_COMMANDS, &frame->imdraw.cmdbuf);
+    (sys, NB_IMDRAW_COMMANDS_PER_BLOCK, &frame->imdraw.cmdbuf);
   if(rdr_err != RDR_NO_ERROR)
     goto error;
 
@@ -460,6 +465,9 @@ rdr_create_frame
   if(rdr_err != RDR_NO_ERROR)
     goto error;
 
+  RBI(&sys->rb, get_stats(sys->ctxt, &frame->flushed_rb_stats));
+  frame->flushed_sys_stats = sys->stats;
+
 exit:
   if(out_frame)
     *out_frame = frame;
@@ -798,6 +806,7 @@ rdr_frame_poll_picking
 {
   enum rdr_error rdr_err = RDR_NO_ERROR;
 
+  PROF_BEGIN("rdr_pick_poll");
   if(UNLIKELY(!frame)) {
     rdr_err = RDR_INVALID_ARGUMENT;
     goto error;
@@ -807,6 +816,7 @@ rdr_frame_poll_picking
   if(rdr_err != RDR_NO_ERROR)
     goto error;
 exit:
+  PROF_END();
   return rdr_err;
 error:
   goto exit;
@@ -852,13 +862,16 @@ rdr_flush_frame(struct rdr_frame* frame)
     .cull_mode = RB_CULL_BACK,
     .front_facing = RB_ORIENTATION_CCW
   };
+  struct rb_stats rb_stats;
   size_t cmd_id = 0;
   enum rdr_error rdr_err = RDR_NO_ERROR;
 
+  PROF_BEGIN("rdr_flush_frame");
   if(UNLIKELY(frame==NULL)) {
     rdr_err = RDR_INVALID_ARGUMENT;
     goto error;
   }
+  RDR(flush_model_updates(frame->sys));
 
   RBI(&frame->sys->rb, rasterizer(frame->sys->ctxt, &raster_desc));
   RBI(&frame->sys->rb, depth_stencil(frame->sys->ctxt, &depth_stencil_desc));
@@ -870,6 +883,7 @@ rdr_flush_frame(struct rdr_frame* frame)
      0));
 
   /* Flush pick commands. */
+  PROF_BEGIN("rdr_pick");
   for(cmd_id = 0; cmd_id < frame->pick_cmd_id; ++cmd_id) {
     struct pick_command* pick_cmd = frame->pick_cmd_list + cmd_id;
     RDR(pick_world
@@ -892,6 +906,7 @@ rdr_flush_frame(struct rdr_frame* frame)
        pick_imdraw_cmd->pos,
        pick_imdraw_cmd->size));
   }
+  PROF_END();
   /* Flush draw world commands. */
   for(cmd_id = 0; cmd_id < frame->draw_world_cmd_id; ++cmd_id) {
     struct draw_world_command* draw_cmd = frame->draw_world_cmd_list + cmd_id;
@@ -929,9 +944,38 @@ rdr_flush_frame(struct rdr_frame* frame)
   frame->pick_imdraw_cmd_id = 0;
   frame->show_pick_cmd_id = 0;
 
+  /* Update the frame statistics. */
+  memset(&rb_stats, 0, sizeof(rb_stats));
+  RBI(&frame->sys->rb, get_stats(frame->sys->ctxt, &rb_stats));
+  frame->stats.nb_draw_calls =
+    rb_stats.nb_draw_calls - frame->flushed_rb_stats.nb_draw_calls;
+  frame->stats.nb_state_changes =
+    rb_stats.nb_state_changes - frame->flushed_rb_stats.nb_state_changes;
+  frame->stats.uploaded_size =
+    rb_stats.uploaded_size - frame->flushed_rb_stats.uploaded_size;
+  frame->stats.nb_instances =
+    frame->sys->stats.nb_instances - frame->flushed_sys_stats.nb_instances;
+  frame->stats.nb_culled_instances =
+      frame->sys->stats.nb_culled_instances
+    - frame->flushed_sys_stats.nb_culled_instances;
+  frame->stats.nb_triangles =
+    frame->sys->stats.nb_triangles - frame->flushed_sys_stats.nb_triangles;
+  frame->flushed_rb_stats = rb_stats;
+  frame->flushed_sys_stats = frame->sys->stats;
+
 exit:
+  PROF_END();
   return rdr_err;
 error:
   goto exit;
 }
 
+enum rdr_error
+rdr_get_frame_stats(struct rdr_frame* frame, struct rdr_frame_stats* stats)
+{
+  if(UNLIKELY(!frame || !stats))
+    return RDR_INVALID_ARGUMENT;
+  *stats = frame->stats;
+  return RDR_NO_ERROR;
+}
+
@@ -1,20 +1,37 @@
 #include "maths/simd/aosf44.h"
+#include "renderer/regular/rdr_error_c.h"
 #include "renderer/regular/rdr_imdraw_c.h"
 #include "renderer/regular/rdr_system_c.h"
 #include "renderer/rdr.h"
 #include "renderer/rdr_imdraw.h"
 #include "renderer/rdr_system.h"
+#include "stdlib/sl_vector.h"
+#include "sys/math.h"
 #include "sys/mem_allocator.h"
+#include <math.h>
 #include <string.h>
 
+/* Commands allocated at once by the command buffer. */
+struct command_block {
+  struct list_node node;
+  struct rdr_imdraw_command buffer[];
+};
+
 struct rdr_imdraw_command_buffer {
   struct ref ref;
   struct rdr_system* sys;
-  size_t max_command_count;
+  size_t nb_commands_per_block;
+  struct list_node block_list; /* Pool of allocated commands. */
   struct list_node emit_command_list; /* Emitted cmds. */
   struct list_node emit_uppermost_command_list; /* Emitted front layer cmds. */
   struct list_node free_command_list; /* Available commands. */
-  struct rdr_imdraw_command buffer[]; /* Pool of allocated commands. */
+};
+
+/* Vertex of the im vertex stream. The color of the picking vertices stores
+ * the pick id. */
+ALIGN(16) struct im_vertex {
+  float pos[4]; /* In clip space. */
+  float color[4]; /* RGBA. */
 };
 
 /******************************************************************************
@@ -22,18 +39,6 @@ struct rdr_imdraw_command_buffer {
  * Embedded common shader.
  *
  ******************************************************************************/
-#define IMDRAW3D_VS_SOURCE(color_type) \
-  "#version 330\n" \
-  "uniform mat4x4 transform;\n" \
-  "uniform " STR(color_type) " color;\n" \
-  "layout(location = 0) in vec3 pos;\n" \
-  "flat out " STR(color_type) " im_color;\n" \
-  "void main()\n" \
-  "{\n" \
-  " im_color = color;\n" \
-  " gl_Position = transform * vec4(pos, 1.f);\n" \
-  "}\n"
-
 #define IMDRAW2D_VS_SOURCE(color_type) \
   "#version 330\n" \
   "uniform mat4x4 transform;\n" \
@@ -67,127 +72,366 @@ static const char* imdraw2d_color_vs_source =
   " gl_Position = transform * vec4(pos, vec2(0.f, 1.f));\n"
   "}\n";
 
-static const char* imdraw2d_vs_source = IMDRAW2D_VS_SOURCE(vec4);
-static const char* imdraw3d_vs_source = IMDRAW3D_VS_SOURCE(vec4);
+/* The vertices of the stream are already transformed in clip space. */
+static const char* imdraw_stream_vs_source =
+  "#version 330\n"
+  "layout(location = 0) in vec4 pos;\n"
+  "layout(location = 1) in vec4 col;\n"
+  "flat out vec4 im_color;\n"
+  "void main()\n"
+  "{\n"
+  " im_color = col;\n"
+  " gl_Position = pos;\n"
+  "}\n";
+
+static const char* imdraw_stream_picking_vs_source =
+  "#version 330\n"
+  "layout(location = 0) in vec4 pos;\n"
+  "layout(location = 1) in vec4 col;\n"
+  "flat out uint im_color;\n"
+  "void main()\n"
+  "{\n"
+  " im_color = uint(col.x) | (uint(col.y) << 16u);\n"
+  " gl_Position = pos;\n"
+  "}\n";
+
+/* The lines of the procedural grid are computed from the position of the
+ * fragments in the unit quad. A fragment belongs to a line if it lies at less
+ * than half a pixel of it. */
+static const char* imdraw_grid_vs_source =
+  "#version 330\n"
+  "uniform mat4x4 transform;\n"
+  "layout(location = 0) in vec2 pos;\n"
+  "out vec2 grid_pos;\n"
+  "void main()\n"
+  "{\n"
+  " grid_pos = pos;\n"
+  " gl_Position = transform * vec4(pos - 0.5f, vec2(0.f, 1.f));\n"
+  "}\n";
+
+#define IMDRAW_GRID_LINE_SOURCE \
+  "uniform vec4 div;\n" \
+  "in vec2 grid_pos;\n" \
+  "vec2 line_dist(vec2 coord)\n" \
+  "{\n" \
+  " return abs(fract(coord + 0.5f) - 0.5f) / max(fwidth(coord), 1.e-6f);\n" \
+  "}\n" \
+  "int grid_line()\n" \
+  "{\n" \
+  " vec2 axis = abs(grid_pos - 0.5f) / max(fwidth(grid_pos), 1.e-6f);\n" \
+  " vec2 divs = line_dist(grid_pos * div.xy);\n" \
+  " vec2 subdivs = line_dist(grid_pos * div.xy * div.zw);\n" \
+  " if(axis.x < 0.5f) return 3;\n" \
+  " if(axis.y < 0.5f) return 4;\n" \
+  " if(min(divs.x, divs.y) < 0.5f) return 1;\n" \
+  " if((div.z > 1.f && subdivs.x < 0.5f)\n" \
+  " || (div.w > 1.f && subdivs.y < 0.5f)) return 2;\n" \
+  " return 0;\n" \
+  "}\n"
+
+static const char* imdraw_grid_fs_source =
+  "#version 330\n"
+  "uniform vec3 div_color;\n"
+  "uniform vec3 subdiv_color;\n"
+  "uniform vec3 vaxis_color;\n"
+  "uniform vec3 haxis_color;\n"
+  "out vec4 im_color;\n"
+  IMDRAW_GRID_LINE_SOURCE
+  "void main()\n"
+  "{\n"
+  " switch(grid_line()) {\n"
+  "   case 1: im_color = vec4(div_color, 1.f); break;\n"
+  "   case 2: im_color = vec4(subdiv_color, 1.f); break;\n"
+  "   case 3: im_color = vec4(vaxis_color, 1.f); break;\n"
+  "   case 4: im_color = vec4(haxis_color, 1.f); break;\n"
+  "   default: discard; break;\n"
+  " }\n"
+  "}\n";
+
+static const char* imdraw_grid_picking_fs_source =
+  "#version 330\n"
+  "uniform uint color;\n"
+  "out uint im_color;\n"
+  IMDRAW_GRID_LINE_SOURCE
+  "void main()\n"
+  "{\n"
+  " if(grid_line() == 0)\n"
+  "   discard;\n"
+  " im_color = color;\n"
+  "}\n";
+
 static const char* imdraw_fs_source = IMDRAW_FS_SOURCE(vec4);
 
 static const char* imdraw2d_picking_vs_source = IMDRAW2D_VS_SOURCE(uint);
-static const char* imdraw3d_picking_vs_source = IMDRAW3D_VS_SOURCE(uint);
 static const char* imdraw_picking_fs_source = IMDRAW_FS_SOURCE(uint);
 
+/******************************************************************************
+ *
+ * Im geometries.
+ *
+ ******************************************************************************/
+/* Unit parallelepiped centered in 0.
+ *     7+----+6
+ *     /|   /|
+ *   4+----+5|
+ *    |3+--|-+2
+ *    |/   |/
+ *   0+----+1    */
+static const float parallelepiped_vertices[8][3] = {
+  {-0.5f,-0.5f, 0.5f}, { 0.5f,-0.5f, 0.5f}, { 0.5f,-0.5f,-0.5f},
+  {-0.5f,-0.5f,-0.5f}, {-0.5f, 0.5f, 0.5f}, { 0.5f, 0.5f, 0.5f},
+  { 0.5f, 0.5f,-0.5f}, {-0.5f, 0.5f,-0.5f}
+};
+
+/* Triangles of the solid parallelepiped of the render backend utils. */
+static const unsigned int solid_parallelepiped_indices[36] = {
+  1, 0, 2, 2, 0, 3, 2, 3, 7, 7, 3, 0, 7, 0, 4, 4, 0, 1,
+  4, 1, 5, 5, 1, 2, 5, 2, 6, 6, 2, 7, 6, 7, 5, 5, 7, 4
+};
+
+static const unsigned int wire_parallelepiped_indices[24] = {
+  0, 1, 1, 2, 2, 3, 3, 0, /* Bottom */
+  4, 5, 5, 6, 6, 7, 7, 4, /* Top */
+  0, 4, 1, 5, 2, 6, 3, 7
+};
+
 /******************************************************************************
  *
  * Helper functions
  *
  ******************************************************************************/
-static void
-invoke_imdraw_parallelepiped
+static FINLINE void
+load_command_transform(const float transform[16], struct aosf44* mat)
+{
+  ALIGN(16) float array[16];
+  assert(transform && mat);
+
+  if(IS_ALIGNED(transform, 16)) {
+    aosf44_load(mat, transform);
+  } else {
+    memcpy(array, transform, 16 * sizeof(float));
+    aosf44_load(mat, array);
+  }
+}
+
+/* The pick id does not fit in the mantissa of a float. It is thus splitted in
+ * two 16 bits values that are merged by the picking shader. */
+static FINLINE vf4_t
+pick_id_color(uint32_t pick_id)
+{
+  return vf4_set
+    ((float)(pick_id & 0xFFFF), (float)(pick_id >> 16), 0.f, 0.f);
+}
+
+/* Append nb_vertices uninitialized vertices to the vertex list. */
+static enum rdr_error
+push_vertices
+  (struct sl_vector* vertex_list,
+   size_t nb_vertices,
+   struct im_vertex** out_vertices)
+{
+  void* buffer = NULL;
+  size_t len = 0;
+  enum sl_error sl_err = SL_NO_ERROR;
+  assert(vertex_list && out_vertices);
+
+  SL(vector_length(vertex_list, &len));
+  sl_err = sl_vector_resize(vertex_list, len + nb_vertices, NULL);
+  if(sl_err != SL_NO_ERROR)
+    return sl_to_rdr_error(sl_err);
+  SL(vector_buffer(vertex_list, NULL, NULL, NULL, &buffer));
+  *out_vertices = (struct im_vertex*)buffer + len;
+  return RDR_NO_ERROR;
+}
+
+static enum rdr_error
+push_indexed_vertices
+  (struct sl_vector* vertex_list,
+   const vf4_t* positions, /* In clip space. */
+   size_t nb_indices,
+   const unsigned int* indices,
+   const vf4_t color)
+{
+  struct im_vertex* vertices = NULL;
+  size_t i = 0;
+  enum rdr_error rdr_err = RDR_NO_ERROR;
+  assert(vertex_list && positions && indices);
+
+  rdr_err = push_vertices(vertex_list, nb_indices, &vertices);
+  if(rdr_err != RDR_NO_ERROR)
+    return rdr_err;
+  for(i = 0; i < nb_indices; ++i) {
+    vf4_store(vertices[i].pos, positions[indices[i]]);
+    vf4_store(vertices[i].color, color);
+  }
+  return RDR_NO_ERROR;
+}
+
+static enum rdr_error
+push_parallelepiped
+  (struct sl_vector* vertex_list,
+   const struct aosf44* transform,
+   const bool wireframe,
+   const vf4_t color)
+{
+  vf4_t positions[8];
+  int i = 0;
+  assert(vertex_list && transform);
+
+  for(i = 0; i < 8; ++i) {
+    positions[i] = aosf44_mulf4(transform, vf4_set
+      (parallelepiped_vertices[i][0],
+       parallelepiped_vertices[i][1],
+       parallelepiped_vertices[i][2],
+       1.f));
+  }
+  if(wireframe) {
+    return push_indexed_vertices
+      (vertex_list,
+       positions,
+       sizeof(wire_parallelepiped_indices) / sizeof(unsigned int),
+       wire_parallelepiped_indices,
+       color);
+  } else {
+    return push_indexed_vertices
+      (vertex_list,
+       positions,
+       sizeof(solid_parallelepiped_indices) / sizeof(unsigned int),
+       solid_parallelepiped_indices,
+       color);
+  }
+}
+
+/* Push the lines of the unit circle centered in 0 in the XY plane. */
+static enum rdr_error
+push_circle
+  (struct rdr_system* sys,
+   struct sl_vector* vertex_list,
+   const struct aosf44* transform,
+   const vf4_t color)
+{
+  vf4_t positions[RDR_IMCIRCLE_NPOINTS];
+  unsigned int indices[RDR_IMCIRCLE_NPOINTS * 2];
+  unsigned int i = 0;
+  assert(sys && vertex_list && transform);
+
+  for(i = 0; i < RDR_IMCIRCLE_NPOINTS; ++i) {
+    positions[i] = aosf44_mulf4(transform, vf4_set
+      (sys->im.circle[i][0], sys->im.circle[i][1], 0.f, 1.f));
+    indices[i * 2 + 0] = i;
+    indices[i * 2 + 1] = (i + 1) % RDR_IMCIRCLE_NPOINTS;
+  }
+  return push_indexed_vertices
+    (vertex_list, positions, RDR_IMCIRCLE_NPOINTS * 2, indices, color);
+}
+
+/* Push the triangles of a cone of height 1 and base radius 0.5 centered in 0
+ * and whose apex points toward +Y. */
+static enum rdr_error
+push_cone
+  (struct rdr_system* sys,
+   struct sl_vector* vertex_list,
+   const struct aosf44* transform,
+   const vf4_t color)
+{
+  enum { APEX = RDR_IMCIRCLE_NPOINTS, BASE_CENTER };
+  vf4_t positions[RDR_IMCIRCLE_NPOINTS + 2];
+  unsigned int indices[RDR_IMCIRCLE_NPOINTS * 6];
+  unsigned int i = 0;
+  assert(sys && vertex_list && transform);
+
+  for(i = 0; i < RDR_IMCIRCLE_NPOINTS; ++i) {
+    const unsigned int next = (i + 1) % RDR_IMCIRCLE_NPOINTS;
+    positions[i] = aosf44_mulf4(transform, vf4_set
+      (sys->im.circle[i][0]*0.5f, -0.5f, sys->im.circle[i][1]*0.5f, 1.f));
+    /* Side and base triangles, counter clockwise from the outside. */
+    indices[i * 6 + 0] = i;
+    indices[i * 6 + 1] = APEX;
+    indices[i * 6 + 2] = next;
+    indices[i * 6 + 3] = BASE_CENTER;
+    indices[i * 6 + 4] = i;
+    indices[i * 6 + 5] = next;
+  }
+  positions[APEX] = aosf44_mulf4(transform, vf4_set(0.f, 0.5f, 0.f, 1.f));
+  positions[BASE_CENTER] = aosf44_mulf4
+    (transform, vf4_set(0.f, -0.5f, 0.f, 1.f));
+  return push_indexed_vertices
+    (vertex_list, positions, RDR_IMCIRCLE_NPOINTS * 6, indices, color);
+}
+
+static enum rdr_error
+batch_imdraw_parallelepiped
   (struct rdr_system* sys,
    struct rdr_imdraw_command* cmd,
    const int exec_flag)
 {
+  struct aosf44 transform;
+  struct sl_vector** vertex_lists = NULL;
+  const float* solid_color = NULL;
+  const float* wire_color = NULL;
+  vf4_t solid, wire;
+  enum rdr_imdraw_bucket solid_bucket = RDR_IMDRAW_BUCKET_SOLIDS;
+  enum rdr_error rdr_err = RDR_NO_ERROR;
   assert(sys && cmd && cmd->type == RDR_IMDRAW_PARALLELEPIPED);
 
+  vertex_lists = sys->im.vertex_stream.vertex_list;
+  solid_color = cmd->data.parallelepiped.solid_color;
+  wire_color = cmd->data.parallelepiped.wire_color;
   if(exec_flag & RDR_IMDRAW_EXEC_FLAG_PICKING) {
     if(cmd->pick_id == UINT32_MAX)
-      return;
-
-    RBI(&sys->rb, bind_program
-      (sys->ctxt, sys->im.draw3d_picking.shading_program));
-    RBI(&sys->rb, uniform_data
-      (sys->im.draw3d_picking.transform, 1,cmd->data.parallelepiped.transform));
+      return RDR_NO_ERROR;
+    solid = wire = pick_id_color(cmd->pick_id);
   } else {
-    RBI(&sys->rb, bind_program(sys->ctxt, sys->im.draw3d.shading_program));
-    RBI(&sys->rb, uniform_data
-      (sys->im.draw3d.transform, 1, cmd->data.parallelepiped.transform));
+    solid = vf4_set
+      (solid_color[0], solid_color[1], solid_color[2], solid_color[3]);
+    wire = vf4_set(wire_color[0], wire_color[1], wire_color[2], wire_color[3]);
+    if(solid_color[3] < 1.f)
+      solid_bucket = RDR_IMDRAW_BUCKET_TRANSLUCENT_SOLIDS;
   }
+  load_command_transform(cmd->data.parallelepiped.transform, &transform);
 
-  if(cmd->data.parallelepiped.solid_color[3] > 0.f) {
-    if(exec_flag & RDR_IMDRAW_EXEC_FLAG_PICKING) {
-      RBI(&sys->rb, uniform_data
-        (sys->im.draw3d_picking.color, 1, &cmd->pick_id));
-    } else {
-      RBI(&sys->rb, uniform_data
-        (sys->im.draw3d.color, 1, cmd->data.parallelepiped.solid_color));
-    }
-
-    if(cmd->data.parallelepiped.solid_color[3] >= 1.f) {
-      RBU(draw_geometry(&sys->rbu.solid_parallelepiped));
-    } else {
-      struct rb_rasterizer_desc raster = {
-        .fill_mode = RB_FILL_SOLID,
-        .cull_mode = RB_CULL_FRONT,
-        .front_facing = RB_ORIENTATION_CCW
-      };
-      struct rb_depth_stencil_desc depth_stencil = {
-        .enable_depth_test = 1,
-        .enable_depth_write = 0,
-        .enable_stencil_test = 0,
-        .depth_func = RB_COMPARISON_LESS_EQUAL
-      };
-      struct rb_blend_desc blend = {
-        .enable = 1,
-        .src_blend_RGB = RB_BLEND_SRC_ALPHA,
-        .src_blend_Alpha = RB_BLEND_ZERO,
-        .dst_blend_RGB = RB_BLEND_ONE_MINUS_SRC_ALPHA,
-        .dst_blend_Alpha = RB_BLEND_ONE,
-        .blend_op_RGB = RB_BLEND_OP_ADD,
-        .blend_op_Alpha = RB_BLEND_OP_ADD
-     };
-      RBI(&sys->rb, depth_stencil(sys->ctxt, &depth_stencil));
-      RBI(&sys->rb, blend(sys->ctxt, &blend));
-
-      /* Draw back-facing triangles. */
-      RBI(&sys->rb, rasterizer(sys->ctxt, &raster));
-      RBU(draw_geometry(&sys->rbu.solid_parallelepiped));
-      /* Draw front-facing triangles. */
-      raster.cull_mode = RB_CULL_BACK;
-      RBI(&sys->rb, rasterizer(sys->ctxt, &raster));
-      RBU(draw_geometry(&sys->rbu.solid_parallelepiped));
-
-      blend.enable = 0;
-      RBI(&sys->rb, blend(sys->ctxt, &blend));
-      depth_stencil.enable_depth_write = 1;
-      RBI(&sys->rb, depth_stencil(sys->ctxt, &depth_stencil));
-    }
+  if(solid_color[3] > 0.f) {
+    rdr_err = push_parallelepiped
+      (vertex_lists[solid_bucket], &transform, false, solid);
+    if(rdr_err != RDR_NO_ERROR)
+      return rdr_err;
   }
-  if(cmd->data.parallelepiped.wire_color[3] > 0.f) {
-    if(exec_flag & RDR_IMDRAW_EXEC_FLAG_PICKING) {
-      RBI(&sys->rb, uniform_data
-        (sys->im.draw3d_picking.color, 1, &cmd->pick_id));
-    } else {
-      RBI(&sys->rb, uniform_data
-        (sys->im.draw3d.color, 1, cmd->data.parallelepiped.wire_color));
-    }
-    RBU(draw_geometry(&sys->rbu.wire_parallelepiped));
+  if(wire_color[3] > 0.f) {
+    rdr_err = push_parallelepiped
+      (vertex_lists[RDR_IMDRAW_BUCKET_LINES], &transform, true, wire);
+    if(rdr_err != RDR_NO_ERROR)
+      return rdr_err;
   }
+  return RDR_NO_ERROR;
 }
 
-static void
-invoke_imdraw_circle
+static enum rdr_error
+batch_imdraw_circle
   (struct rdr_system* sys,
    struct rdr_imdraw_command* cmd,
    const int exec_flag)
 {
+  struct aosf44 transform;
+  vf4_t color;
   assert(sys && cmd && cmd->type == RDR_IMDRAW_CIRCLE);
 
   if(exec_flag & RDR_IMDRAW_EXEC_FLAG_PICKING) {
-    if(cmd->pick_id != UINT32_MAX) { /* UINT32_MAX <=> no pick_id */
-      RBI(&sys->rb, bind_program
-        (sys->ctxt, sys->im.draw2d_picking.shading_program));
-      RBI(&sys->rb, uniform_data
-        (sys->im.draw2d_picking.transform, 1, cmd->data.circle.transform));
-      RBI(&sys->rb, uniform_data
-        (sys->im.draw2d_picking.color, 1, &cmd->pick_id));
-    }
+    if(cmd->pick_id == UINT32_MAX) /* UINT32_MAX <=> no pick_id */
+      return RDR_NO_ERROR;
+    color = pick_id_color(cmd->pick_id);
   } else {
-    RBI(&sys->rb, bind_program(sys->ctxt, sys->im.draw2d.shading_program));
-    RBI(&sys->rb, uniform_data
-      (sys->im.draw2d.transform, 1, cmd->data.circle.transform));
-    RBI(&sys->rb, uniform_data
-      (sys->im.draw2d.color, 1, cmd->data.circle.color));
-    RBU(draw_geometry(&sys->rbu.circle));
+    color = vf4_set
+      (cmd->data.circle.color[0],
+       cmd->data.circle.color[1],
+       cmd->data.circle.color[2],
+       cmd->data.circle.color[3]);
   }
+  load_command_transform(cmd->data.circle.transform, &transform);
+  return push_circle
+    (sys,
+     sys->im.vertex_stream.vertex_list[RDR_IMDRAW_BUCKET_LINES],
+     &transform,
+     color);
 }
 
 /* Return the length of the im vector */
@@ -246,62 +490,65 @@ setup_im_vector_matrix(struct rdr_imdraw_command* cmd, struct aosf44* mat)
   return vec_len;
 }
 
-static void
-invoke_imdraw_vector
+static enum rdr_error
+push_marker
+  (struct rdr_system* sys,
+   const enum rdr_im_vector_marker marker,
+   const struct aosf44* transform,
+   const vf4_t color)
+{
+  struct sl_vector* vertex_list = NULL;
+  assert(sys && transform);
+
+  vertex_list = sys->im.vertex_stream.vertex_list[RDR_IMDRAW_BUCKET_SOLIDS];
+  switch(marker) {
+    case RDR_IM_VECTOR_CUBE_MARKER:
+      return push_parallelepiped(vertex_list, transform, false, color);
+    case RDR_IM_VECTOR_CONE_MARKER:
+      return push_cone(sys, vertex_list, transform, color);
+    default: assert(0); return RDR_NO_ERROR;
+  }
+}
+
+static enum rdr_error
+batch_imdraw_vector
   (struct rdr_system* sys,
    struct rdr_imdraw_command* cmd,
    const int exec_flag)
 {
   struct aosf44 transform;
   struct aosf44 f44;
-  struct rb_uniform* transform_uniform = NULL;
-  ALIGN(16) float array[16];
+  vf4_t color;
   vf4_t len = setup_im_vector_matrix(cmd, &transform);
+  enum rdr_error rdr_err = RDR_NO_ERROR;
 
   if(exec_flag & RDR_IMDRAW_EXEC_FLAG_PICKING) {
     if(cmd->pick_id == UINT32_MAX)
-      return;
-
-    RBI(&sys->rb, bind_program
-      (sys->ctxt, sys->im.draw3d_picking.shading_program));
-    RBI(&sys->rb, uniform_data
-      (sys->im.draw3d_picking.color, 1, &cmd->pick_id));
-
-    transform_uniform = sys->im.draw3d_picking.transform;
+      return RDR_NO_ERROR;
+    color = pick_id_color(cmd->pick_id);
   } else {
-    RBI(&sys->rb, bind_program(sys->ctxt, sys->im.draw3d.shading_program));
-    RBI(&sys->rb, uniform_data
-      (sys->im.draw3d.color, 1, cmd->data.vector.color));
-    transform_uniform = sys->im.draw3d.transform;
+    color = vf4_set
+      (cmd->data.vector.color[0],
+       cmd->data.vector.color[1],
+       cmd->data.vector.color[2],
+       1.f);
   }
   /* TODO take into account the stroke style!!! */
   if( cmd->data.vector.stroke_style == RDR_IM_STROKE_STYLE_PLAIN ) {
-    RBI(&sys->rb, bind_vertex_array(sys->ctxt, sys->im.line.vertex_array));
-
-    /* Stretch the line to the correct size by scaling the matrix by the vector
-     * length */
-    f44.c0 = vf4_mul(transform.c0, len);
-    f44.c1 = vf4_mul(transform.c1, len);
-    f44.c2 = vf4_mul(transform.c2, len);
-    f44.c3 = transform.c3;
-    aosf44_store(array, &f44);
-    RBI(&sys->rb, uniform_data(transform_uniform, 1, array));
-    RBI(&sys->rb, draw(sys->ctxt, RB_LINES, 2));
+    struct im_vertex* vertices = NULL;
+
+    rdr_err = push_vertices
+      (sys->im.vertex_stream.vertex_list[RDR_IMDRAW_BUCKET_LINES], 2,
+       &vertices);
+    if(rdr_err != RDR_NO_ERROR)
+      return rdr_err;
+    /* Stretch the line (0, 0, 0) (0, 1, 0) to the vector length. */
+    vf4_store(vertices[0].pos, transform.c3);
+    vf4_store(vertices[0].color, color);
+    vf4_store(vertices[1].pos, vf4_madd(transform.c1, len, transform.c3));
+    vf4_store(vertices[1].color, color);
   }
 
-  #define DRAW_MARKER(marker) \
-    do { \
-      switch(marker) { \
-        case RDR_IM_VECTOR_CUBE_MARKER:  \
-          RBU(draw_geometry(&sys->rbu.solid_parallelepiped)); \
-          break; \
-        case RDR_IM_VECTOR_CONE_MARKER: \
-          RBU(draw_geometry(&sys->rbu.cone)); \
-          break; \
-        default: assert(0); break; \
-      } \
-    } while(0)
-
   if(cmd->data.vector.end_marker != RDR_IM_VECTOR_MARKER_NONE
   || cmd->data.vector.start_marker != RDR_IM_VECTOR_MARKER_NONE) {
 
@@ -325,33 +572,34 @@ invoke_imdraw_vector
       /* Set the end marker to its position by translating the matrix
        * by the vector length. */
       f44.c3 = vf4_madd(f44.c1, len, f44.c3);
-      aosf44_store(array, &f44);
-      RBI(&sys->rb, uniform_data(transform_uniform, 1, array));
-      DRAW_MARKER(cmd->data.vector.end_marker);
+      rdr_err = push_marker(sys, cmd->data.vector.end_marker, &f44, color);
+      if(rdr_err != RDR_NO_ERROR)
+        return rdr_err;
       f44.c3 = saved_c3;
     }
     if(cmd->data.vector.start_marker != RDR_IM_VECTOR_MARKER_NONE) {
       /* rotate the start marker by PI around the X axis. */
       f44.c1 = vf4_minus(f44.c1);
       f44.c2 = vf4_minus(f44.c2);
-      aosf44_store(array, &f44);
-      RBI(&sys->rb, uniform_data(transform_uniform, 1, array));
-      DRAW_MARKER(cmd->data.vector.start_marker);
+      rdr_err = push_marker(sys, cmd->data.vector.start_marker, &f44, color);
+      if(rdr_err != RDR_NO_ERROR)
+        return rdr_err;
     }
   }
-  #undef DRAW_MARKER
+  return RDR_NO_ERROR;
 }
 
 static void
 setup_im_grid
   (struct rdr_system* sys,
+   struct im_grid* grid,
    const float* vertices, /* Interleaved list of 2D positions and RGB colors */
    unsigned int nvertices)
 {
-  assert(sys && (vertices || !nvertices));
+  assert(sys && grid && (vertices || !nvertices));
 
   if(nvertices == 0) {
-    sys->im.grid.nvertices = 0;
+    grid->nvertices = 0;
   } else {
     const size_t sizeof_vertex = 5 /* 2D pos + RGB color */ * sizeof(float);
     const size_t sizeof_vertices = nvertices * sizeof_vertex;
@@ -370,136 +618,206 @@ setup_im_grid
        }
      };
     /* Setup vertex buffer */
-    if(sizeof_vertices <= sys->im.grid.sizeof_vertex_buffer) {
+    if(sizeof_vertices <= grid->sizeof_vertex_buffer) {
       RBI(&sys->rb, buffer_data
-        (sys->im.grid.vertex_buffer, 0, sizeof_vertices, vertices));
+        (grid->vertex_buffer, 0, sizeof_vertices, vertices));
     } else {
       const struct rb_buffer_desc buf_desc = {
         .size = sizeof_vertices,
         .target = RB_BIND_VERTEX_BUFFER,
         .usage = RB_USAGE_IMMUTABLE
       };
-      if(sys->im.grid.vertex_buffer != NULL) {
-        RBI(&sys->rb, buffer_ref_put(sys->im.grid.vertex_buffer));
+      if(grid->vertex_buffer != NULL) {
+        RBI(&sys->rb, buffer_ref_put(grid->vertex_buffer));
       }
       RBI(&sys->rb, create_buffer
-        (sys->ctxt, &buf_desc, vertices, &sys->im.grid.vertex_buffer));
-      sys->im.grid.sizeof_vertex_buffer = sizeof_vertices;
+        (sys->ctxt, &buf_desc, vertices, &grid->vertex_buffer));
+      grid->sizeof_vertex_buffer = sizeof_vertices;
     }
-    sys->im.grid.nvertices = nvertices;
+    grid->nvertices = nvertices;
     /* Setup vertex array */
-    if(sys->im.grid.vertex_array == NULL) {
-      RBI(&sys->rb, create_vertex_array(sys->ctxt, &sys->im.grid.vertex_array));
+    if(grid->vertex_array == NULL) {
+      RBI(&sys->rb, create_vertex_array(sys->ctxt, &grid->vertex_array));
     }
     RBI(&sys->rb, vertex_attrib_array
-      (sys->im.grid.vertex_array, sys->im.grid.vertex_buffer, 2, buf_attr));
+      (grid->vertex_array, grid->vertex_buffer, 2, buf_attr));
   }
 }
 
 static void
-build_im_grid(struct rdr_system* sys, const struct rdr_imdraw_command* cmd)
+build_im_grid
+  (struct rdr_system* sys,
+   struct im_grid* grid,
+   const struct rdr_im_grid_desc* grid_desc)
 {
   float* vertices = NULL;
-  const struct rdr_im_grid_desc* grid_desc = NULL;
-  assert(cmd && sys);
-
-  grid_desc = &cmd->data.grid.desc;
+  unsigned int nvertices = 0;
+  assert(sys && grid && grid_desc);
 
-  if(0 != memcmp
-     (&sys->im.grid.desc,
-      &cmd->data.grid.desc,
-      sizeof(struct rdr_im_grid_desc))) {
-    unsigned int nvertices = 0;
+  if(grid_desc->ndiv[0] && grid_desc->ndiv[1]) {
+    float* vertex = NULL;
+    size_t line_id = 0, subline_id = 0;
 
-    if(cmd->data.grid.desc.ndiv[0] && cmd->data.grid.desc.ndiv[1]) {
-      float* vertex = NULL;
-      size_t line_id = 0, subline_id = 0;
+    /* Precompute several values */
+    const float step[2] = {
+      1.f / (float)grid_desc->ndiv[0],
+      1.f / (float)grid_desc->ndiv[1]
+    };
+    const float substep[2] = {
+      step[0] / (float)grid_desc->nsubdiv[0],
+      step[1] / (float)grid_desc->nsubdiv[1]
+    };
+    const unsigned int nfloat_per_vertex = 5; /* 2D position + RGB color */
+    const unsigned int nb_vlines = grid_desc->ndiv[0] + 1;
+    const unsigned int nb_hlines = grid_desc->ndiv[1] + 1;
+    const unsigned int nb_vsublines =
+      grid_desc->nsubdiv[0] - (grid_desc->nsubdiv[0] > 0);
+    const unsigned int nb_hsublines =
+      grid_desc->nsubdiv[1] - (grid_desc->nsubdiv[1] > 0);
+    const unsigned int total_nb_lines =
+        nb_vlines
+      + nb_hlines
+      + (grid_desc->ndiv[0] * nb_vsublines)
+      + (grid_desc->ndiv[1] * nb_hsublines)
+      + 2 /* axis */;
+
+    /* Allocate temporary client side vertex buffer */
+    nvertices = total_nb_lines * 2;
+    vertices = MEM_ALLOC
+      (sys->allocator, nvertices * nfloat_per_vertex * sizeof(float));
+    assert(vertices != NULL);
+    vertex = vertices;
+
+    #define FARRAY(...) ((float[]){__VA_ARGS__})
+    #define PUSH_VERTEX(vertex, xy, rgb) \
+    do { \
+      (vertex)[0] = (xy)[0]; \
+      (vertex)[1] = (xy)[1]; \
+      (vertex)[2] = (rgb)[0]; \
+      (vertex)[3] = (rgb)[1]; \
+      (vertex)[4] = (rgb)[2]; \
+      (vertex) += nfloat_per_vertex; \
+    } while(0)
 
-      /* Precompute several values */
-      const float step[2] = {
-        1.f / (float)grid_desc->ndiv[0],
-        1.f / (float)grid_desc->ndiv[1]
-      };
-      const float substep[2] = {
-        step[0] / (float)grid_desc->nsubdiv[0],
-        step[1] / (float)grid_desc->nsubdiv[1]
-      };
-      const unsigned int nfloat_per_vertex = 5; /* 2D position + RGB color */
-      const unsigned int nb_vlines = grid_desc->ndiv[0] + 1;
-      const unsigned int nb_hlines = grid_desc->ndiv[1] + 1;
-      const unsigned int nb_vsublines =
-        grid_desc->nsubdiv[0] - (grid_desc->nsubdiv[0] > 0);
-      const unsigned int nb_hsublines =
-        grid_desc->nsubdiv[1] - (grid_desc->nsubdiv[1] > 0);
-      const unsigned int total_nb_lines =
-          nb_vlines
-        + nb_hlines
-        + (grid_desc->ndiv[0] * nb_vsublines)
-        + (grid_desc->ndiv[1] * nb_hsublines)
-        + 2 /* axis */;
-
-      /* Allocate temporary client side vertex buffer */
-      nvertices = total_nb_lines * 2;
-      vertices = MEM_ALLOC
-        (sys->allocator, nvertices * nfloat_per_vertex * sizeof(float));
-      assert(vertices != NULL);
-      vertex = vertices;
-
-      #define FARRAY(...) ((float[]){__VA_ARGS__})
-      #define PUSH_VERTEX(vertex, xy, rgb) \
-      do { \
-        (vertex)[0] = (xy)[0]; \
-        (vertex)[1] = (xy)[1]; \
-        (vertex)[2] = (rgb)[0]; \
-        (vertex)[3] = (rgb)[1]; \
-        (vertex)[4] = (rgb)[2]; \
-        (vertex) += nfloat_per_vertex; \
-      } while(0)
-
-      /* Setup vertical lines */
-      for(line_id = 0;  line_id < nb_vlines; ++line_id) {
-        float x = -0.5f + line_id * step[0];
-        PUSH_VERTEX(vertex, FARRAY(x, 0.5f), grid_desc->div_color);
-        PUSH_VERTEX(vertex, FARRAY(x,-0.5f), grid_desc->div_color);
-        if(line_id < nb_vlines - 1) {
-          x += substep[0];
-          /* Setup sub vertical lines */
-          for(subline_id = 0; subline_id < nb_vsublines; ++subline_id) {
-            const float subx = x + subline_id * substep[0];
-            PUSH_VERTEX(vertex, FARRAY(subx, 0.5f), grid_desc->subdiv_color);
-            PUSH_VERTEX(vertex, FARRAY(subx,-0.5f), grid_desc->subdiv_color);
-          }
+    /* Setup vertical lines */
+    for(line_id = 0;  line_id < nb_vlines; ++line_id) {
+      float x = -0.5f + line_id * step[0];
+      PUSH_VERTEX(vertex, FARRAY(x, 0.5f), grid_desc->div_color);
+      PUSH_VERTEX(vertex, FARRAY(x,-0.5f), grid_desc->div_color);
+      if(line_id < nb_vlines - 1) {
+        x += substep[0];
+        /* Setup sub vertical lines */
+        for(subline_id = 0; subline_id < nb_vsublines; ++subline_id) {
+          const float subx = x + subline_id * substep[0];
+          PUSH_VERTEX(vertex, FARRAY(subx, 0.5f), grid_desc->subdiv_color);
+          PUSH_VERTEX(vertex, FARRAY(subx,-0.5f), grid_desc->subdiv_color);
         }
       }
-      /* Setup horizontal lines */
-     for(line_id = 0; line_id < nb_hlines; ++line_id) {
-        float y = -0.5f + line_id * step[1];
-        PUSH_VERTEX(vertex, FARRAY( 0.5f,y), grid_desc->div_color);
-        PUSH_VERTEX(vertex, FARRAY(-0.5f,y), grid_desc->div_color);
-        if(line_id < nb_hlines - 1) {
-          y += substep[1];
-          for(subline_id = 0; subline_id < nb_hsublines; ++subline_id) {
-            const float suby = y + subline_id * substep[1];
-            PUSH_VERTEX(vertex, FARRAY( 0.5f,suby), grid_desc->subdiv_color);
-            PUSH_VERTEX(vertex, FARRAY(-0.5f,suby), grid_desc->subdiv_color);
-          }
+    }
+    /* Setup horizontal lines */
+   for(line_id = 0; line_id < nb_hlines; ++line_id) {
+      float y = -0.5f + line_id * step[1];
+      PUSH_VERTEX(vertex, FARRAY( 0.5f,y), grid_desc->div_color);
+      PUSH_VERTEX(vertex, FARRAY(-0.5f,y), grid_desc->div_color);
+      if(line_id < nb_hlines - 1) {
+        y += substep[1];
+        for(subline_id = 0; subline_id < nb_hsublines; ++subline_id) {
+          const float suby = y + subline_id * substep[1];
+          PUSH_VERTEX(vertex, FARRAY( 0.5f,suby), grid_desc->subdiv_color);
+          PUSH_VERTEX(vertex, FARRAY(-0.5f,suby), grid_desc->subdiv_color);
         }
       }
-      /* Vertical axis */
-      PUSH_VERTEX(vertex, FARRAY(0.f, 0.5f), grid_desc->vaxis_color);
-      PUSH_VERTEX(vertex, FARRAY(0.f,-0.5f), grid_desc->vaxis_color);
-      /* Horizontal axis */
-      PUSH_VERTEX(vertex, FARRAY( 0.5f,0.f), grid_desc->haxis_color);
-      PUSH_VERTEX(vertex, FARRAY(-0.5f,0.f), grid_desc->haxis_color);
     }
+    /* Vertical axis */
+    PUSH_VERTEX(vertex, FARRAY(0.f, 0.5f), grid_desc->vaxis_color);
+    PUSH_VERTEX(vertex, FARRAY(0.f,-0.5f), grid_desc->vaxis_color);
+    /* Horizontal axis */
+    PUSH_VERTEX(vertex, FARRAY( 0.5f,0.f), grid_desc->haxis_color);
+    PUSH_VERTEX(vertex, FARRAY(-0.5f,0.f), grid_desc->haxis_color);
+  }
 
-    #undef FARRAY
-    #undef PUSH_VERTEX
-    setup_im_grid(sys, vertices, nvertices);
-    memcpy(&sys->im.grid.desc, grid_desc, sizeof(struct rdr_im_grid_desc));
-    if(vertices)
-      MEM_FREE(sys->allocator, vertices);
+  #undef FARRAY
+  #undef PUSH_VERTEX
+  setup_im_grid(sys, grid, vertices, nvertices);
+  memcpy(&grid->desc, grid_desc, sizeof(struct rdr_im_grid_desc));
+  if(vertices)
+    MEM_FREE(sys->allocator, vertices);
+}
+
+/* Retrieve the cached grid of the submitted descriptor. On a miss, the least
+ * recently used grid is rebuilt from it. */
+static struct im_grid*
+get_im_grid(struct rdr_system* sys, const struct rdr_im_grid_desc* grid_desc)
+{
+  struct im_grid* grid = NULL;
+  size_t i = 0;
+  assert(sys && grid_desc);
+
+  ++sys->im.grid_clock;
+  for(i = 0; i < RDR_IMGRID_CACHE_SIZE; ++i) {
+    struct im_grid* entry = sys->im.grid_cache + i;
+    if(entry->last_use != 0
+    && 0 == memcmp(&entry->desc, grid_desc, sizeof(struct rdr_im_grid_desc))) {
+      grid = entry;
+      break;
+    }
+    if(!grid || entry->last_use < grid->last_use)
+      grid = entry;
   }
+  if(i == RDR_IMGRID_CACHE_SIZE)
+    build_im_grid(sys, grid, grid_desc);
+  grid->last_use = sys->im.grid_clock;
+  return grid;
+}
+
+static void
+draw_procedural_grid
+  (struct rdr_system* sys,
+   struct rdr_imdraw_command* cmd,
+   const int exec_flag)
+{
+  struct rb_rasterizer_desc raster = {
+    .fill_mode = RB_FILL_SOLID,
+    .cull_mode = RB_CULL_NONE,
+    .front_facing = RB_ORIENTATION_CCW
+  };
+  const struct rdr_im_grid_desc* grid_desc = NULL;
+  struct im_grid_draw* grid = NULL;
+  float div[4];
+  assert(sys && cmd && cmd->type == RDR_IMDRAW_GRID);
+
+  grid_desc = &cmd->data.grid.desc;
+  if(!grid_desc->ndiv[0] || !grid_desc->ndiv[1])
+    return;
+
+  if(exec_flag & RDR_IMDRAW_EXEC_FLAG_PICKING) {
+    if(cmd->pick_id == UINT32_MAX)
+      return;
+    grid = &sys->im.procedural_grid_picking;
+    RBI(&sys->rb, bind_program(sys->ctxt, grid->draw.shading_program));
+    RBI(&sys->rb, uniform_data(grid->draw.color, 1, &cmd->pick_id));
+  } else {
+    grid = &sys->im.procedural_grid;
+    RBI(&sys->rb, bind_program(sys->ctxt, grid->draw.shading_program));
+    RBI(&sys->rb, uniform_data(grid->div_color, 1, grid_desc->div_color));
+    RBI(&sys->rb, uniform_data
+      (grid->subdiv_color, 1, grid_desc->subdiv_color));
+    RBI(&sys->rb, uniform_data(grid->vaxis_color, 1, grid_desc->vaxis_color));
+    RBI(&sys->rb, uniform_data(grid->haxis_color, 1, grid_desc->haxis_color));
+  }
+  div[0] = (float)grid_desc->ndiv[0];
+  div[1] = (float)grid_desc->ndiv[1];
+  div[2] = (float)grid_desc->nsubdiv[0];
+  div[3] = (float)grid_desc->nsubdiv[1];
+  RBI(&sys->rb, uniform_data(grid->div, 1, div));
+  RBI(&sys->rb, uniform_data
+    (grid->draw.transform, 1, cmd->data.grid.transform));
+
+  /* The grid is visible from both sides. */
+  RBI(&sys->rb, rasterizer(sys->ctxt, &raster));
+  RBU(draw_geometry(&sys->rbu.quad));
+  raster.cull_mode = RB_CULL_BACK;
+  RBI(&sys->rb, rasterizer(sys->ctxt, &raster));
 }
 
 static void
@@ -508,10 +826,15 @@ invoke_imdraw_grid
    struct rdr_imdraw_command* cmd,
    const int exec_flag)
 {
+  struct im_grid* grid = NULL;
   assert(sys && cmd && cmd->type == RDR_IMDRAW_GRID);
 
-  build_im_grid(sys, cmd);
-  if(sys->im.grid.nvertices != 0) {
+  if(sys->im.is_grid_procedural) {
+    draw_procedural_grid(sys, cmd, exec_flag);
+    return;
+  }
+  grid = get_im_grid(sys, &cmd->data.grid.desc);
+  if(grid->nvertices != 0) {
     if(exec_flag & RDR_IMDRAW_EXEC_FLAG_PICKING) {
       if(cmd->pick_id != UINT32_MAX) {
         RBI(&sys->rb, bind_program
@@ -520,21 +843,161 @@ invoke_imdraw_grid
           (sys->im.draw2d_picking.transform, 1, cmd->data.grid.transform));
         RBI(&sys->rb, uniform_data
           (sys->im.draw2d_picking.color, 1, &cmd->pick_id));
-        RBI(&sys->rb, bind_vertex_array(sys->ctxt, sys->im.grid.vertex_array));
-        RBI(&sys->rb, draw(sys->ctxt, RB_LINES, sys->im.grid.nvertices));
+        RBI(&sys->rb, bind_vertex_array(sys->ctxt, grid->vertex_array));
+        RBI(&sys->rb, draw(sys->ctxt, RB_LINES, grid->nvertices));
       }
     } else {
       RBI(&sys->rb, bind_program
         (sys->ctxt, sys->im.draw2d_color.shading_program));
       RBI(&sys->rb, uniform_data
         (sys->im.draw2d_color.transform, 1, cmd->data.grid.transform));
-      RBI(&sys->rb, bind_vertex_array(sys->ctxt, sys->im.grid.vertex_array));
-      RBI(&sys->rb, draw(sys->ctxt, RB_LINES, sys->im.grid.nvertices));
+      RBI(&sys->rb, bind_vertex_array(sys->ctxt, grid->vertex_array));
+      RBI(&sys->rb, draw(sys->ctxt, RB_LINES, grid->nvertices));
     }
   }
 }
 
 static void
+draw_translucent_solids(struct rdr_system* sys, unsigned int nb_vertices)
+{
+  struct rb_rasterizer_desc raster = {
+    .fill_mode = RB_FILL_SOLID,
+    .cull_mode = RB_CULL_FRONT,
+    .front_facing = RB_ORIENTATION_CCW
+  };
+  struct rb_depth_stencil_desc depth_stencil = {
+    .enable_depth_test = 1,
+    .enable_depth_write = 0,
+    .enable_stencil_test = 0,
+    .depth_func = RB_COMPARISON_LESS_EQUAL
+  };
+  struct rb_blend_desc blend = {
+    .enable = 1,
+    .src_blend_RGB = RB_BLEND_SRC_ALPHA,
+    .src_blend_Alpha = RB_BLEND_ZERO,
+    .dst_blend_RGB = RB_BLEND_ONE_MINUS_SRC_ALPHA,
+    .dst_blend_Alpha = RB_BLEND_ONE,
+    .blend_op_RGB = RB_BLEND_OP_ADD,
+    .blend_op_Alpha = RB_BLEND_OP_ADD
+  };
+  assert(sys);
+
+  RBI(&sys->rb, depth_stencil(sys->ctxt, &depth_stencil));
+  RBI(&sys->rb, blend(sys->ctxt, &blend));
+
+  /* Draw back-facing triangles. */
+  RBI(&sys->rb, rasterizer(sys->ctxt, &raster));
+  RBI(&sys->rb, draw(sys->ctxt, RB_TRIANGLE_LIST, nb_vertices));
+  /* Draw front-facing triangles. */
+  raster.cull_mode = RB_CULL_BACK;
+  RBI(&sys->rb, rasterizer(sys->ctxt, &raster));
+  RBI(&sys->rb, draw(sys->ctxt, RB_TRIANGLE_LIST, nb_vertices));
+
+  blend.enable = 0;
+  RBI(&sys->rb, blend(sys->ctxt, &blend));
+  depth_stencil.enable_depth_write = 1;
+  RBI(&sys->rb, depth_stencil(sys->ctxt, &depth_stencil));
+}
+
+/* Upload the batched vertices in the vertex stream and draw each of its
+ * buckets at once. The opaque buckets are drawn first. */
+static void
+flush_vertex_stream(struct rdr_system* sys, const int exec_flag)
+{
+  struct rb_buffer_attrib buf_attr[2] = {
+    [0] = {
+      .index = 0,
+      .stride = sizeof(struct im_vertex),
+      .offset = 0,
+      .type = RB_FLOAT4
+    },
+    [1] = {
+      .index = 1,
+      .stride = sizeof(struct im_vertex),
+      .offset = 4 * sizeof(float),
+      .type = RB_FLOAT4
+    }
+  };
+  struct im_stream* stream = NULL;
+  size_t nb_vertices[RDR_NB_IMDRAW_BUCKETS];
+  size_t total_nb_vertices = 0;
+  size_t first_vertex = 0;
+  size_t sizeof_vertices = 0;
+  int i = 0;
+  assert(sys);
+
+  stream = &sys->im.vertex_stream;
+  for(i = 0; i < RDR_NB_IMDRAW_BUCKETS; ++i) {
+    SL(vector_length(stream->vertex_list[i], nb_vertices + i));
+    total_nb_vertices += nb_vertices[i];
+  }
+  if(total_nb_vertices == 0)
+    return;
+
+  /* Setup the vertex buffer. */
+  sizeof_vertices = total_nb_vertices * sizeof(struct im_vertex);
+  if(sizeof_vertices > stream->sizeof_vertex_buffer) {
+    const struct rb_buffer_desc buf_desc = {
+      .size = MAX(sizeof_vertices, stream->sizeof_vertex_buffer * 2),
+      .target = RB_BIND_VERTEX_BUFFER,
+      .usage = RB_USAGE_DYNAMIC
+    };
+    if(stream->vertex_buffer != NULL)
+      RBI(&sys->rb, buffer_ref_put(stream->vertex_buffer));
+    RBI(&sys->rb, create_buffer
+      (sys->ctxt, &buf_desc, NULL, &stream->vertex_buffer));
+    stream->sizeof_vertex_buffer = buf_desc.size;
+  }
+  if(stream->vertex_array == NULL)
+    RBI(&sys->rb, create_vertex_array(sys->ctxt, &stream->vertex_array));
+  for(i = 0; i < RDR_NB_IMDRAW_BUCKETS; ++i) {
+    void* vertices = NULL;
+    if(nb_vertices[i] == 0)
+      continue;
+    SL(vector_buffer(stream->vertex_list[i], NULL, NULL, NULL, &vertices));
+    RBI(&sys->rb, buffer_data
+      (stream->vertex_buffer,
+       (int)(first_vertex * sizeof(struct im_vertex)),
+       (int)(nb_vertices[i] * sizeof(struct im_vertex)),
+       vertices));
+    first_vertex += nb_vertices[i];
+  }
+
+  /* Draw the buckets. */
+  if(exec_flag & RDR_IMDRAW_EXEC_FLAG_PICKING) {
+    RBI(&sys->rb, bind_program
+      (sys->ctxt, sys->im.stream_picking.shading_program));
+  } else {
+    RBI(&sys->rb, bind_program(sys->ctxt, sys->im.stream.shading_program));
+  }
+  RBI(&sys->rb, bind_vertex_array(sys->ctxt, stream->vertex_array));
+  first_vertex = 0;
+  for(i = 0; i < RDR_NB_IMDRAW_BUCKETS; ++i) {
+    if(nb_vertices[i] == 0)
+      continue;
+    buf_attr[0].offset = first_vertex * sizeof(struct im_vertex);
+    buf_attr[1].offset = buf_attr[0].offset + 4 * sizeof(float);
+    RBI(&sys->rb, vertex_attrib_array
+      (stream->vertex_array, stream->vertex_buffer, 2, buf_attr));
+    switch(i) {
+      case RDR_IMDRAW_BUCKET_LINES:
+        RBI(&sys->rb, draw(sys->ctxt, RB_LINES, nb_vertices[i]));
+        break;
+      case RDR_IMDRAW_BUCKET_SOLIDS:
+        RBI(&sys->rb, draw(sys->ctxt, RB_TRIANGLE_LIST, nb_vertices[i]));
+        break;
+      case RDR_IMDRAW_BUCKET_TRANSLUCENT_SOLIDS:
+        draw_translucent_solids(sys, nb_vertices[i]);
+        break;
+      default: assert(0); break;
+    }
+    first_vertex += nb_vertices[i];
+    SL(clear_vector(stream->vertex_list[i]));
+  }
+  RBI(&sys->rb, bind_vertex_array(sys->ctxt, NULL));
+}
+
+static enum rdr_error
 execute_command_list
   (struct rdr_imdraw_command_buffer* cmdbuf,
    struct list_node* cmdlist,
@@ -543,12 +1006,18 @@ execute_command_list
   struct rb_viewport_desc viewport_desc;
   struct list_node* node = NULL;
   struct list_node* tmp = NULL;
+  struct rdr_system* sys = NULL;
+  int i = 0;
+  enum rdr_error rdr_err = RDR_NO_ERROR;
   memset(&viewport_desc, 0, sizeof(viewport_desc));
   assert(cmdbuf && cmdlist);
 
+  sys = cmdbuf->sys;
   viewport_desc.min_depth = 0.f;
   viewport_desc.max_depth = 1.f;
 
+  /* The commands are batched in the vertex stream and flushed when the
+   * viewport changes. Only the grids are directly drawn. */
   LIST_FOR_EACH_SAFE(node, tmp, cmdlist) {
     struct rdr_imdraw_command* cmd = CONTAINER_OF
       (node, struct rdr_imdraw_command, node);
@@ -557,36 +1026,52 @@ execute_command_list
      | ((int)cmd->viewport[1] != viewport_desc.y)
      | ((int)cmd->viewport[2] != viewport_desc.width)
      | ((int)cmd->viewport[3] != viewport_desc.height)) {
+      flush_vertex_stream(sys, exec_flag);
       viewport_desc.x = cmd->viewport[0];
       viewport_desc.y = cmd->viewport[1];
       viewport_desc.width = cmd->viewport[2];
       viewport_desc.height = cmd->viewport[3];
-      RBI(&cmdbuf->sys->rb, viewport(cmdbuf->sys->ctxt, &viewport_desc));
+      RBI(&sys->rb, viewport(sys->ctxt, &viewport_desc));
     }
     switch(cmd->type) {
       case RDR_IMDRAW_CIRCLE:
-        invoke_imdraw_circle(cmdbuf->sys, cmd, exec_flag);
+        rdr_err = batch_imdraw_circle(sys, cmd, exec_flag);
         break;
       case RDR_IMDRAW_GRID:
-        invoke_imdraw_grid(cmdbuf->sys, cmd, exec_flag);
+        invoke_imdraw_grid(sys, cmd, exec_flag);
         break;
       case RDR_IMDRAW_PARALLELEPIPED:
-        invoke_imdraw_parallelepiped(cmdbuf->sys, cmd, exec_flag);
+        rdr_err = batch_imdraw_parallelepiped(sys, cmd, exec_flag);
         break;
       case RDR_IMDRAW_VECTOR:
-        invoke_imdraw_vector(cmdbuf->sys, cmd, exec_flag);
+        rdr_err = batch_imdraw_vector(sys, cmd, exec_flag);
         break;
       default: assert(0); break;
     }
+    if(rdr_err != RDR_NO_ERROR)
+      goto error;
     if((exec_flag & RDR_IMDRAW_EXEC_FLAG_FLUSH) != 0)
       list_move_tail(node, &cmdbuf->free_command_list);
   }
-  RBI(&cmdbuf->sys->rb, bind_program(cmdbuf->sys->ctxt, NULL));
+  flush_vertex_stream(sys, exec_flag);
+
+exit:
+  RBI(&sys->rb, bind_program(sys->ctxt, NULL));
+  return rdr_err;
+error:
+  for(i = 0; i < RDR_NB_IMDRAW_BUCKETS; ++i)
+    SL(clear_vector(sys->im.vertex_stream.vertex_list[i]));
+  if((exec_flag & RDR_IMDRAW_EXEC_FLAG_FLUSH) != 0) {
+    LIST_FOR_EACH_SAFE(node, tmp, cmdlist)
+      list_move_tail(node, &cmdbuf->free_command_list);
+  }
+  goto exit;
 }
 
 enum im_draw_flag {
   IM_DRAW_NONE = 0,
-  IM_DRAW_HAS_COLOR_UNIFORM = BIT(0)
+  IM_DRAW_HAS_COLOR_UNIFORM = BIT(0),
+  IM_DRAW_HAS_TRANSFORM_UNIFORM = BIT(1)
 };
 
 static void
@@ -614,41 +1099,17 @@ init_im_draw
   RBI(rbi, attach_shader(im_draw->shading_program, im_draw->vertex_shader));
   RBI(rbi, attach_shader(im_draw->shading_program, im_draw->fragment_shader));
   RBI(rbi, link_program(im_draw->shading_program));
-  RBI(rbi, get_named_uniform
-    (ctxt, im_draw->shading_program, "transform", &im_draw->transform));
 
+  if(flag & IM_DRAW_HAS_TRANSFORM_UNIFORM) {
+    RBI(rbi, get_named_uniform
+      (ctxt, im_draw->shading_program, "transform", &im_draw->transform));
+  }
   if(flag & IM_DRAW_HAS_COLOR_UNIFORM) {
     RBI(rbi, get_named_uniform
       (ctxt, im_draw->shading_program, "color", &im_draw->color));
   }
 }
 
-static void
-init_im_line(struct rbi* rbi, struct rb_context* ctxt, struct im_line* line)
-{
-  struct rb_buffer* vbuf = NULL;
-  struct rb_vertex_array* varray = NULL;
-  const float vertices[] = {  0.f, 0.f, 0.f, 0.f, 1.f, 0.f };
-  const struct rb_buffer_desc vbuf_desc = {
-    .size = sizeof(vertices),
-    .target = RB_BIND_VERTEX_BUFFER,
-    .usage = RB_USAGE_IMMUTABLE
-  };
-  const struct rb_buffer_attrib vbuf_attr = {
-    .index = 0,
-    .stride = sizeof(vertices) / 2,
-    .offset = 0,
-    .type = RB_FLOAT3
-  };
-  assert(rbi && line);
-
-  RBI(rbi, create_buffer(ctxt, &vbuf_desc, vertices, &vbuf));
-  RBI(rbi, create_vertex_array(ctxt, &varray));
-  RBI(rbi, vertex_attrib_array(varray, vbuf, 1, &vbuf_attr));
-  line->vertex_buffer = vbuf;
-  line->vertex_array = varray;
-}
-
 static void
 release_im_draw(struct rbi* rbi, struct im_draw* im_draw)
 {
@@ -667,6 +1128,54 @@ release_im_draw(struct rbi* rbi, struct im_draw* im_draw)
   memset(im_draw, 0, sizeof(struct im_draw));
 }
 
+static void
+init_im_grid_draw
+  (struct rbi* rbi,
+   struct rb_context* ctxt,
+   struct im_grid_draw* im_grid_draw,
+   const char* fs_source,
+   int flag)
+{
+  assert(rbi && im_grid_draw && fs_source);
+
+  init_im_draw
+    (rbi, ctxt, &im_grid_draw->draw, imdraw_grid_vs_source, fs_source,
+     flag | IM_DRAW_HAS_TRANSFORM_UNIFORM);
+  RBI(rbi, get_named_uniform
+    (ctxt, im_grid_draw->draw.shading_program, "div", &im_grid_draw->div));
+  /* The picking grid outputs the pick id of the color uniform. */
+  if((flag & IM_DRAW_HAS_COLOR_UNIFORM) == 0) {
+    #define GET_UNIFORM(name) \
+      RBI(rbi, get_named_uniform \
+        (ctxt, im_grid_draw->draw.shading_program, #name, \
+         &im_grid_draw->name))
+    GET_UNIFORM(div_color);
+    GET_UNIFORM(subdiv_color);
+    GET_UNIFORM(vaxis_color);
+    GET_UNIFORM(haxis_color);
+    #undef GET_UNIFORM
+  }
+}
+
+static void
+release_im_grid_draw(struct rbi* rbi, struct im_grid_draw* im_grid_draw)
+{
+  assert(rbi && im_grid_draw);
+
+  release_im_draw(rbi, &im_grid_draw->draw);
+  if(im_grid_draw->div)
+    RBI(rbi, uniform_ref_put(im_grid_draw->div));
+  if(im_grid_draw->div_color)
+    RBI(rbi, uniform_ref_put(im_grid_draw->div_color));
+  if(im_grid_draw->subdiv_color)
+    RBI(rbi, uniform_ref_put(im_grid_draw->subdiv_color));
+  if(im_grid_draw->vaxis_color)
+    RBI(rbi, uniform_ref_put(im_grid_draw->vaxis_color));
+  if(im_grid_draw->haxis_color)
+    RBI(rbi, uniform_ref_put(im_grid_draw->haxis_color));
+  memset(im_grid_draw, 0, sizeof(struct im_grid_draw));
+}
+
 static void
 release_im_grid(struct rbi* rbi, struct im_grid* im_grid)
 {
@@ -680,15 +1189,42 @@ release_im_grid(struct rbi* rbi, struct im_grid* im_grid)
 }
 
 static void
-release_im_line(struct rbi* rbi, struct im_line* im_line)
+release_im_stream(struct rbi* rbi, struct im_stream* im_stream)
 {
-  assert(rbi && im_line);
+  int i = 0;
+  assert(rbi && im_stream);
 
-  if(im_line->vertex_array)
-    RBI(rbi, vertex_array_ref_put(im_line->vertex_array));
-  if(im_line->vertex_buffer)
-    RBI(rbi, buffer_ref_put(im_line->vertex_buffer));
-  memset(im_line, 0, sizeof(struct im_line));
+  for(i = 0; i < RDR_NB_IMDRAW_BUCKETS; ++i) {
+    if(im_stream->vertex_list[i])
+      SL(free_vector(im_stream->vertex_list[i]));
+  }
+  if(im_stream->vertex_array)
+    RBI(rbi, vertex_array_ref_put(im_stream->vertex_array));
+  if(im_stream->vertex_buffer)
+    RBI(rbi, buffer_ref_put(im_stream->vertex_buffer));
+  memset(im_stream, 0, sizeof(struct im_stream));
+}
+
+static enum rdr_error
+add_command_block(struct rdr_imdraw_command_buffer* cmdbuf)
+{
+  struct command_block* block = NULL;
+  size_t i = 0;
+  assert(cmdbuf);
+
+  block = MEM_CALLOC
+    (cmdbuf->sys->allocator, 1,
+     sizeof(struct command_block) +
+     cmdbuf->nb_commands_per_block * sizeof(struct rdr_imdraw_command));
+  if(!block)
+    return RDR_MEMORY_ERROR;
+  list_init(&block->node);
+  list_add_tail(&cmdbuf->block_list, &block->node);
+  for(i = 0; i < cmdbuf->nb_commands_per_block; ++i) {
+    list_init(&block->buffer[i].node);
+    list_add_tail(&cmdbuf->free_command_list, &block->buffer[i].node);
+  }
+  return RDR_NO_ERROR;
 }
 
 static void
@@ -696,10 +1232,16 @@ release_imdraw_command_buffer(struct ref* ref)
 {
   struct rdr_imdraw_command_buffer* cmdbuf = NULL;
   struct rdr_system* sys = NULL;
+  struct list_node* node = NULL;
+  struct list_node* tmp = NULL;
   assert(ref);
 
   cmdbuf = CONTAINER_OF(ref, struct rdr_imdraw_command_buffer, ref);
   sys = cmdbuf->sys;
+  LIST_FOR_EACH_SAFE(node, tmp, &cmdbuf->block_list) {
+    list_del(node);
+    MEM_FREE(sys->allocator, CONTAINER_OF(node, struct command_block, node));
+  }
   MEM_FREE(sys->allocator, cmdbuf);
   RDR(system_ref_put(sys));
 }
@@ -712,62 +1254,88 @@ release_imdraw_command_buffer(struct ref* ref)
 enum rdr_error
 rdr_init_im_rendering(struct rdr_system* sys)
 {
+  size_t i = 0;
+  enum sl_error sl_err = SL_NO_ERROR;
+
   if(UNLIKELY(sys==NULL))
     return RDR_INVALID_ARGUMENT;
 
-  init_im_draw
-    (&sys->rb,
-     sys->ctxt,
-     &sys->im.draw2d,
-     imdraw2d_vs_source,
-     imdraw_fs_source,
-     IM_DRAW_HAS_COLOR_UNIFORM);
   init_im_draw
     (&sys->rb,
      sys->ctxt,
      &sys->im.draw2d_picking,
      imdraw2d_picking_vs_source,
      imdraw_picking_fs_source,
-     IM_DRAW_HAS_COLOR_UNIFORM);
+     IM_DRAW_HAS_TRANSFORM_UNIFORM | IM_DRAW_HAS_COLOR_UNIFORM);
   init_im_draw
     (&sys->rb,
      sys->ctxt,
-     &sys->im.draw3d,
-     imdraw3d_vs_source,
+     &sys->im.draw2d_color,
+     imdraw2d_color_vs_source,
      imdraw_fs_source,
-     IM_DRAW_HAS_COLOR_UNIFORM);
+     IM_DRAW_HAS_TRANSFORM_UNIFORM);
   init_im_draw
     (&sys->rb,
      sys->ctxt,
-     &sys->im.draw3d_picking,
-     imdraw3d_picking_vs_source,
-     imdraw_picking_fs_source,
-     IM_DRAW_HAS_COLOR_UNIFORM);
+     &sys->im.stream,
+     imdraw_stream_vs_source,
+     imdraw_fs_source,
+     IM_DRAW_NONE);
   init_im_draw
     (&sys->rb,
      sys->ctxt,
-     &sys->im.draw2d_color,
-     imdraw2d_color_vs_source,
-     imdraw_fs_source,
+     &sys->im.stream_picking,
+     imdraw_stream_picking_vs_source,
+     imdraw_picking_fs_source,
      IM_DRAW_NONE);
-  /* The im grid is not intialized. It is automatically created in runtime. */
-  init_im_line(&sys->rb, sys->ctxt, &sys->im.line);
-
+  init_im_grid_draw
+    (&sys->rb,
+     sys->ctxt,
+     &sys->im.procedural_grid,
+     imdraw_grid_fs_source,
+     IM_DRAW_NONE);
+  init_im_grid_draw
+    (&sys->rb,
+     sys->ctxt,
+     &sys->im.procedural_grid_picking,
+     imdraw_grid_picking_fs_source,
+     IM_DRAW_HAS_COLOR_UNIFORM);
+  sys->im.is_grid_procedural = true;
+  /* The cached im grids are built in runtime. The render backend buffers of
+   * the vertex stream are also created on demand. */
+  for(i = 0; i < RDR_NB_IMDRAW_BUCKETS; ++i) {
+    sl_err = sl_create_vector
+      (sizeof(struct im_vertex),
+       ALIGNOF(struct im_vertex),
+       sys->allocator,
+       sys->im.vertex_stream.vertex_list + i);
+    if(sl_err != SL_NO_ERROR)
+      return sl_to_rdr_error(sl_err);
+  }
+  for(i = 0; i < RDR_IMCIRCLE_NPOINTS; ++i) {
+    const float angle = (float)i * 2.f * (float)PI / RDR_IMCIRCLE_NPOINTS;
+    sys->im.circle[i][0] = cosf(angle);
+    sys->im.circle[i][1] = sinf(angle);
+  }
   return RDR_NO_ERROR;
 }
 
 enum rdr_error
 rdr_shutdown_im_rendering(struct rdr_system* sys)
 {
+  size_t i = 0;
+
   if(UNLIKELY(sys==NULL))
     return RDR_INVALID_ARGUMENT;
-  release_im_draw(&sys->rb, &sys->im.draw2d);
   release_im_draw(&sys->rb, &sys->im.draw2d_picking);
-  release_im_draw(&sys->rb, &sys->im.draw3d);
-  release_im_draw(&sys->rb, &sys->im.draw3d_picking);
   release_im_draw(&sys->rb, &sys->im.draw2d_color);
-  release_im_grid(&sys->rb, &sys->im.grid);
-  release_im_line(&sys->rb, &sys->im.line);
+  release_im_draw(&sys->rb, &sys->im.stream);
+  release_im_draw(&sys->rb, &sys->im.stream_picking);
+  release_im_grid_draw(&sys->rb, &sys->im.procedural_grid);
+  release_im_grid_draw(&sys->rb, &sys->im.procedural_grid_picking);
+  for(i = 0; i < RDR_IMGRID_CACHE_SIZE; ++i)
+    release_im_grid(&sys->rb, sys->im.grid_cache + i);
+  release_im_stream(&sys->rb, &sys->im.vertex_stream);
   return RDR_NO_ERROR;
 }
 
@@ -779,37 +1347,34 @@ rdr_shutdown_im_rendering(struct rdr_system* sys)
 enum rdr_error
 rdr_create_imdraw_command_buffer
   (struct rdr_system* sys,
-   size_t max_command_count,
+   size_t nb_commands_per_block,
    struct rdr_imdraw_command_buffer** out_cmdbuf)
 {
   struct rdr_imdraw_command_buffer* cmdbuf = NULL;
-  size_t i = 0;
   enum rdr_error rdr_err = RDR_NO_ERROR;
 
-  if(UNLIKELY(sys==NULL || max_command_count==0 || out_cmdbuf==NULL)) {
+  if(UNLIKELY(sys==NULL || nb_commands_per_block==0 || out_cmdbuf==NULL)) {
     rdr_err = RDR_INVALID_ARGUMENT;
     goto error;
   }
   cmdbuf = MEM_CALLOC
-    (sys->allocator, 1,
-     sizeof(struct rdr_imdraw_command_buffer) +
-     max_command_count * sizeof(struct rdr_imdraw_command));
+    (sys->allocator, 1, sizeof(struct rdr_imdraw_command_buffer));
   if(!cmdbuf) {
     rdr_err = RDR_MEMORY_ERROR;
     goto error;
   }
   ref_init(&cmdbuf->ref);
+  list_init(&cmdbuf->block_list);
   list_init(&cmdbuf->emit_command_list);
   list_init(&cmdbuf->emit_uppermost_command_list);
   list_init(&cmdbuf->free_command_list);
   RDR(system_ref_get(sys));
   cmdbuf->sys = sys;
-  cmdbuf->max_command_count = max_command_count;
+  cmdbuf->nb_commands_per_block = nb_commands_per_block;
 
-  for(i = 0; i < max_command_count; ++i) {
-    list_init(&cmdbuf->buffer[i].node);
-    list_add_tail(&cmdbuf->free_command_list, &cmdbuf->buffer[i].node);
-  }
+  rdr_err = add_command_block(cmdbuf);
+  if(rdr_err != RDR_NO_ERROR)
+    goto error;
 exit:
   if(out_cmdbuf)
     *out_cmdbuf = cmdbuf;
@@ -851,7 +1416,10 @@ rdr_get_imdraw_command
     rdr_err = RDR_INVALID_ARGUMENT;
     goto error;
   }
-  if(is_list_empty(&cmdbuf->free_command_list)) {
+  /* Grow the command buffer if all its commands are emitted. A NULL command
+   * means that the memory is exhausted. */
+  if(is_list_empty(&cmdbuf->free_command_list)
+  && add_command_block(cmdbuf) != RDR_NO_ERROR) {
     *cmd = NULL;
   } else {
     struct list_node* node = list_head(&cmdbuf->free_command_list);
@@ -872,17 +1440,24 @@ rdr_emit_imdraw_command
   (struct rdr_imdraw_command_buffer* cmdbuf,
    struct rdr_imdraw_command* cmd)
 {
+  struct list_node* node = NULL;
+
   if(UNLIKELY(cmdbuf==NULL || cmd==NULL || cmd->type==RDR_NB_IMDRAW_TYPES))
     return RDR_INVALID_ARGUMENT;
 
   /* Check that the command to emit is effectively get from cmdbuf. */
-  if(UNLIKELY(false == IS_MEMORY_OVERLAPPED
-    (cmd,
-     sizeof(struct rdr_imdraw_command),
-     cmdbuf->buffer,
-     sizeof(struct rdr_imdraw_command) * cmdbuf->max_command_count))) {
-    return RDR_INVALID_ARGUMENT;
+  LIST_FOR_EACH(node, &cmdbuf->block_list) {
+    struct command_block* block = CONTAINER_OF
+      (node, struct command_block, node);
+    if(IS_MEMORY_OVERLAPPED
+       (cmd,
+        sizeof(struct rdr_imdraw_command),
+        block->buffer,
+        sizeof(struct rdr_imdraw_command) * cmdbuf->nb_commands_per_block))
+      break;
   }
+  if(UNLIKELY(node == &cmdbuf->block_list))
+    return RDR_INVALID_ARGUMENT;
   if((cmd->flag & RDR_IMDRAW_FLAG_UPPERMOST_LAYER) != 0) {
     list_add_tail(&cmdbuf->emit_uppermost_command_list, &cmd->node);
   } else {
@@ -896,10 +1471,13 @@ rdr_execute_imdraw_command_buffer
   (struct rdr_imdraw_command_buffer* cmdbuf,
    const int flag)
 {
+  enum rdr_error rdr_err = RDR_NO_ERROR;
+  enum rdr_error uppermost_err = RDR_NO_ERROR;
+
   if(UNLIKELY(cmdbuf == NULL))
     return RDR_INVALID_ARGUMENT;
 
-  execute_command_list(cmdbuf, &cmdbuf->emit_command_list, flag);
+  rdr_err = execute_command_list(cmdbuf, &cmdbuf->emit_command_list, flag);
   if(!is_list_empty(&cmdbuf->emit_uppermost_command_list)) {
     const struct rb_depth_stencil_desc depth_stencil_desc = {
       .enable_depth_test = 1,
@@ -913,8 +1491,9 @@ rdr_execute_imdraw_command_buffer
       (cmdbuf->sys->ctxt, &depth_stencil_desc));
     RBI(&cmdbuf->sys->rb, clear
       (cmdbuf->sys->ctxt, RB_CLEAR_DEPTH_BIT, NULL, 1.f, 0x00));
-    execute_command_list(cmdbuf, &cmdbuf->emit_uppermost_command_list, flag);
+    uppermost_err = execute_command_list
+      (cmdbuf, &cmdbuf->emit_uppermost_command_list, flag);
   }
-  return RDR_NO_ERROR;
+  return rdr_err != RDR_NO_ERROR ? rdr_err : uppermost_err;
 }
 
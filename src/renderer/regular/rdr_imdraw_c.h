@@ -8,6 +8,8 @@
 #include "sys/sys.h"
 
 #define RDR_IMGRID_NSUBDIV 32
+#define RDR_IMCIRCLE_NPOINTS 32
+#define RDR_IMGRID_CACHE_SIZE 4
 
 enum rdr_imdraw_type {
   RDR_IMDRAW_CIRCLE,
@@ -17,6 +19,15 @@ enum rdr_imdraw_type {
   RDR_NB_IMDRAW_TYPES
 };
 
+/* Render states of the batched im draw commands. Each bucket is drawn at once
+ * from the im vertex stream. */
+enum rdr_imdraw_bucket {
+  RDR_IMDRAW_BUCKET_LINES,
+  RDR_IMDRAW_BUCKET_SOLIDS,
+  RDR_IMDRAW_BUCKET_TRANSLUCENT_SOLIDS, /* Blended and not depth written */
+  RDR_NB_IMDRAW_BUCKETS
+};
+
 enum rdr_imdraw_exec_flag {
   RDR_IMDRAW_EXEC_FLAG_FLUSH = BIT(0), /* Clear the command buffer */
   RDR_IMDRAW_EXEC_FLAG_PICKING = BIT(1), /* Draw pick_id */
@@ -86,10 +97,12 @@ rdr_shutdown_im_rendering
  * Im draw command buffer function prototypes.
  *
  ******************************************************************************/
+/* The command buffer grows by nb_commands_per_block commands when all its
+ * commands are emitted. */
 LOCAL_SYM enum rdr_error
 rdr_create_imdraw_command_buffer
   (struct rdr_system* sys,
-   size_t max_command_count,
+   size_t nb_commands_per_block,
    struct rdr_imdraw_command_buffer** out_cmdbuf);
 
 LOCAL_SYM enum rdr_error
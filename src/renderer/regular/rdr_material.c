@@ -475,53 +475,72 @@ rdr_material_program
   (struct rdr_material* mtr,
    const char* shader_sources[RDR_NB_SHADER_USAGES])
 {
+  struct rb_shader* shader_list[RDR_NB_SHADER_USAGES];
+  struct rb_program* program = NULL;
+  struct rb_attrib** attrib_list = NULL;
+  struct rb_uniform** uniform_list = NULL;
+  char* log = NULL;
+  size_t nb_attribs = 0;
+  size_t nb_uniforms = 0;
   enum rdr_error rdr_err = RDR_NO_ERROR;
+  bool is_linked = false;
+  int err = 0;
 
+  memset(shader_list, 0, sizeof(shader_list));
   if(!mtr || !shader_sources) {
     rdr_err = RDR_INVALID_ARGUMENT;
     goto error;
   }
-  release_attribs(mtr->sys, mtr->nb_attribs, mtr->attrib_list);
-  mtr->nb_attribs = 0;
-  mtr->attrib_list = NULL;
-
-  release_uniforms(mtr->sys, mtr->nb_uniforms, mtr->uniform_list);
-  mtr->nb_uniforms = 0;
-  mtr->uniform_list = NULL;
-
-  release_shaders(mtr->sys, mtr->program, mtr->shader_list);
-
-  if(mtr->log) {
-    MEM_FREE(mtr->sys->allocator, mtr->log);
-    mtr->log = NULL;
+  /* The program is built aside. The current program is thus kept if the new
+   * one cannot be linked, e.g. on the reload of an erroneous shader. */
+  err = mtr->sys->rb.create_program(mtr->sys->ctxt, &program);
+  if(err != 0) {
+    rdr_err = RDR_DRIVER_ERROR;
+    goto error;
   }
   rdr_err = build_program
-    (mtr->sys,
-     mtr->program,
-     shader_sources,
-     mtr->shader_list,
-     &mtr->log,
-     &mtr->is_linked);
+    (mtr->sys, program, shader_sources, shader_list, &log, &is_linked);
   if(rdr_err != RDR_NO_ERROR)
     goto error;
 
-  if(mtr->is_linked) {
-    rdr_err = get_attribs
-      (mtr->sys, mtr->program, &mtr->nb_attribs, &mtr->attrib_list);
-    if(rdr_err != RDR_NO_ERROR)
-      goto error;
+  assert(is_linked);
+  rdr_err = get_attribs(mtr->sys, program, &nb_attribs, &attrib_list);
+  if(rdr_err != RDR_NO_ERROR)
+    goto error;
+  rdr_err = get_uniforms(mtr->sys, program, &nb_uniforms, &uniform_list);
+  if(rdr_err != RDR_NO_ERROR)
+    goto error;
 
-    rdr_err = get_uniforms
-      (mtr->sys, mtr->program, &mtr->nb_uniforms, &mtr->uniform_list);
-    if(rdr_err != RDR_NO_ERROR)
-      goto error;
-  }
+  /* Swap the current program with the new one. */
+  release_attribs(mtr->sys, mtr->nb_attribs, mtr->attrib_list);
+  release_uniforms(mtr->sys, mtr->nb_uniforms, mtr->uniform_list);
+  release_shaders(mtr->sys, mtr->program, mtr->shader_list);
+  RBI(&mtr->sys->rb, program_ref_put(mtr->program));
+  if(mtr->log)
+    MEM_FREE(mtr->sys->allocator, mtr->log);
+  mtr->program = program;
+  memcpy(mtr->shader_list, shader_list, sizeof(shader_list));
+  mtr->attrib_list = attrib_list;
+  mtr->nb_attribs = nb_attribs;
+  mtr->uniform_list = uniform_list;
+  mtr->nb_uniforms = nb_uniforms;
+  mtr->log = log;
+  mtr->is_linked = true;
+  invoke_callbacks(mtr, RDR_MATERIAL_SIGNAL_UPDATE_PROGRAM);
 
 exit:
-  if(mtr)
-    invoke_callbacks(mtr, RDR_MATERIAL_SIGNAL_UPDATE_PROGRAM);
   return rdr_err;
 error:
+  if(program) {
+    release_attribs(mtr->sys, nb_attribs, attrib_list);
+    release_uniforms(mtr->sys, nb_uniforms, uniform_list);
+    release_shaders(mtr->sys, program, shader_list);
+    RBI(&mtr->sys->rb, program_ref_put(program));
+    /* Report the build log of the rejected program. */
+    if(mtr->log)
+      MEM_FREE(mtr->sys->allocator, mtr->log);
+    mtr->log = log;
+  }
   goto exit;
 }
 
@@ -14,6 +14,8 @@
 #include "renderer/rdr_system.h"
 #include "stdlib/sl.h"
 #include "stdlib/sl_flat_set.h"
+#include "stdlib/sl_vector.h"
+#include "sys/math.h"
 #include "sys/ref_count.h"
 #include "sys/sys.h"
 #include <assert.h>
@@ -21,6 +23,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+/* Fraction of the error tolerance below which a coarser level of detail is
+ * selected. */
+#define LOD_HYSTERESIS 0.75f
+
 static const char*
 builtin_attrib_name_list[] = {
   [RDR_ATTRIB_POSITION] = "rdr_position",
@@ -38,17 +44,26 @@ builtin_uniform_name_list[] = {
   [RDR_PICK_ID_UNIFORM] = "rdr_pick_id"
 };
 
-struct rdr_model {
-  struct rdr_system* sys;
-  /* Vertex array of the model and its associated informations. */
+/* Level of detail of a model, i.e. a mesh and the vertex arrays that bind it
+ * to the model material. */
+struct lod {
+  struct rdr_mesh* mesh;
+  float error;
+  /* Vertex array of the mesh and its associated informations. */
   struct rb_vertex_array* vertex_array;
   size_t nb_indices;
   int bound_attrib_index_list[RDR_NB_ATTRIB_USAGES];
   int bound_attrib_mask;
   /* Vertex array which bound only position attribs. */
   struct rb_vertex_array* vertex_pos_array;
-  /* Data of the model. */
-  struct rdr_mesh* mesh;
+  bool hold_position;
+};
+
+struct rdr_model {
+  struct rdr_system* sys;
+  /* Levels of detail of the model. The first one is the model mesh. */
+  struct lod lod_list[RDR_MAX_MODEL_LODS];
+  size_t nb_lods;
   struct rdr_material* material;
   /* List of model callbacks. */
   struct sl_flat_set* callback_set[RDR_NB_MODEL_SIGNALS];
@@ -61,8 +76,16 @@ struct rdr_model {
   /* Cumulated size in bytes of the size of the instance attrib/uniform data. */
   size_t sizeof_instance_attrib_data;
   size_t sizeof_uniform_data;
+  /* Index into the list of pending updates or SIZE_MAX if not pending. */
+  size_t pending_id;
+  /* Triangles of the software occlusion culling. */
+  struct occluder {
+    float* vertices;
+    unsigned int* indices;
+    size_t nb_vertices;
+    size_t nb_indices;
+  } occluder;
   /* Miscellaneous. */
-  bool hold_position;
   bool is_setuped;
   struct ref ref;
 };
@@ -122,25 +145,25 @@ is_attrib_bound(int bound_attrib_mask, enum rdr_attrib_usage usage)
 }
 
 static enum rdr_error
-unbind_all_attribs(struct rdr_model* model)
+unbind_all_attribs(struct rdr_system* sys, struct lod* lod)
 {
   size_t i = 0;
   enum rdr_error rdr_err = RDR_NO_ERROR;
   int err = 0;
 
-  assert(model);
+  assert(sys && lod);
 
   for(i = 0; i < RDR_NB_ATTRIB_USAGES; ++i) {
-    if(is_attrib_bound(model->bound_attrib_mask, i) == true) {
-      err = model->sys->rb.remove_vertex_attrib
-        (model->vertex_array, 1, model->bound_attrib_index_list + i);
+    if(is_attrib_bound(lod->bound_attrib_mask, i) == true) {
+      err = sys->rb.remove_vertex_attrib
+        (lod->vertex_array, 1, lod->bound_attrib_index_list + i);
       if(err != 0) {
         rdr_err = RDR_DRIVER_ERROR;
         goto error;
       }
     }
   }
-  model->bound_attrib_mask = 0;
+  lod->bound_attrib_mask = 0;
 
 exit:
   return rdr_err;
@@ -155,7 +178,8 @@ bind_mtr_attrib_to_mesh_attrib
    size_t nb_mesh_attribs,
    struct rdr_mesh_attrib_desc* mesh_attrib_list,
    struct rb_buffer* mesh_data,
-   struct rdr_model* model)
+   struct rdr_system* sys,
+   struct lod* lod)
 {
   enum rdr_attrib_usage mtr_attr_usage = RDR_ATTRIB_UNKNOWN;
   enum rdr_error rdr_err = RDR_NO_ERROR;
@@ -164,7 +188,8 @@ bind_mtr_attrib_to_mesh_attrib
 
   assert(mtr_attr_desc
       && (!nb_mesh_attribs || mesh_attrib_list)
-      && model);
+      && sys
+      && lod);
 
   mtr_attr_usage = attrib_name_to_attrib_usage(mtr_attr_desc->name);
 
@@ -176,7 +201,7 @@ bind_mtr_attrib_to_mesh_attrib
       struct rdr_mesh_attrib_desc* mesh_attr = mesh_attrib_list + i;
 
       if(mesh_attr->usage == mtr_attr_usage
-      && mesh_attr->type == mtr_attr_desc->type) {
+      && rb_to_shader_type(mesh_attr->type) == mtr_attr_desc->type) {
         struct rb_buffer_attrib buffer_attrib;
         int err = 0;
 
@@ -184,24 +209,24 @@ bind_mtr_attrib_to_mesh_attrib
         buffer_attrib.stride = mesh_attr->stride;
         buffer_attrib.offset = mesh_attr->offset;
         buffer_attrib.type = mesh_attr->type;
-        err = model->sys->rb.vertex_attrib_array
-          (model->vertex_array, mesh_data, 1, &buffer_attrib);
+        err = sys->rb.vertex_attrib_array
+          (lod->vertex_array, mesh_data, 1, &buffer_attrib);
         if(err != 0) {
           rdr_err = RDR_DRIVER_ERROR;
           goto error;
         }
         is_vertex_array_updated = true;
         if(mtr_attr_usage == RDR_ATTRIB_POSITION) {
-          err = model->sys->rb.vertex_attrib_array
-            (model->vertex_array, mesh_data, 1, &buffer_attrib);
+          err = sys->rb.vertex_attrib_array
+            (lod->vertex_array, mesh_data, 1, &buffer_attrib);
           if(err != 0) {
             rdr_err = RDR_DRIVER_ERROR;
             goto error;
           }
         }
         is_attr_bound = true;
-        model->bound_attrib_index_list[mtr_attr_usage] = mtr_attr_desc->index;
-        model->bound_attrib_mask |= (1 << mesh_attr->usage);
+        lod->bound_attrib_index_list[mtr_attr_usage] = mtr_attr_desc->index;
+        lod->bound_attrib_mask |= (1 << mesh_attr->usage);
       }
     }
   }
@@ -210,12 +235,14 @@ exit:
   return rdr_err;
 error:
   if(is_vertex_array_updated) {
-    RBI(&model->sys->rb, remove_vertex_attrib
-      (model->vertex_array, 1, (const int[]){mtr_attr_desc->index}));
+    RBI(&sys->rb, remove_vertex_attrib
+      (lod->vertex_array, 1, (const int[]){mtr_attr_desc->index}));
   }
   goto exit;
 }
 
+/* The instance attribs of the model are the material attribs that are not
+ * bound to the mesh of its first level of detail. */
 static enum rdr_error
 setup_model_vertex_array
   (size_t nb_mtr_attribs,
@@ -224,7 +251,8 @@ setup_model_vertex_array
    struct rdr_mesh_attrib_desc* mesh_attrib_list,
    struct rb_buffer* mesh_data,
    struct rb_buffer* mesh_indices,
-   struct rdr_model* mdl)
+   struct rdr_model* mdl,
+   struct lod* lod)
 {
   struct rb_attrib** instance_attrib_list = NULL;
   size_t nb_instance_attribs = 0;
@@ -232,19 +260,21 @@ setup_model_vertex_array
   size_t i = 0;
   enum rdr_error rdr_err = RDR_NO_ERROR;
   int err = 0;
+  const bool is_first_lod = lod == mdl->lod_list;
 
   assert((!nb_mtr_attribs || mtr_attrib_list)
       && (!nb_mesh_attribs || mesh_attrib_list)
       && mdl
-      && !mdl->nb_instance_attribs
-      && !mdl->instance_attrib_list
-      && !mdl->sizeof_instance_attrib_data);
+      && lod
+      && (!is_first_lod || !mdl->nb_instance_attribs)
+      && (!is_first_lod || !mdl->instance_attrib_list)
+      && (!is_first_lod || !mdl->sizeof_instance_attrib_data));
 
- rdr_err = unbind_all_attribs(mdl);
+  rdr_err = unbind_all_attribs(mdl->sys, lod);
   if(rdr_err != RDR_NO_ERROR)
     goto error;
 
-  if(nb_mtr_attribs) {
+  if(nb_mtr_attribs && is_first_lod) {
     instance_attrib_list = MEM_ALLOC
       (mdl->sys->allocator, sizeof(struct rb_attrib*) * nb_mtr_attribs);
     if(!instance_attrib_list) {
@@ -257,7 +287,7 @@ setup_model_vertex_array
   for(i = 0; i < nb_mtr_attribs; ++i) {
     struct rb_attrib_desc mtr_attr_desc;
     struct rb_attrib* mtr_attr = mtr_attrib_list[i];
-    const int saved_bound_attrib_mask = mdl->bound_attrib_mask;
+    const int saved_bound_attrib_mask = lod->bound_attrib_mask;
 
     err = mdl->sys->rb.get_attrib_desc(mtr_attr, &mtr_attr_desc);
     if(err != 0) {
@@ -266,13 +296,18 @@ setup_model_vertex_array
     }
 
     rdr_err = bind_mtr_attrib_to_mesh_attrib
-      (&mtr_attr_desc, nb_mesh_attribs, mesh_attrib_list, mesh_data, mdl);
+      (&mtr_attr_desc,
+       nb_mesh_attribs,
+       mesh_attrib_list,
+       mesh_data,
+       mdl->sys,
+       lod);
     if(rdr_err != RDR_NO_ERROR)
       goto error;
 
     /* If the bound attrib mask was not updated then the mtr attrib was not
      * bound to the mesh, i.e. it is an instance attrib. */
-    if(mdl->bound_attrib_mask == saved_bound_attrib_mask) {
+    if(is_first_lod && lod->bound_attrib_mask == saved_bound_attrib_mask) {
       instance_attrib_list[nb_instance_attribs] = mtr_attr;
       sizeof_instance_attrib_data += sizeof_rb_type(mtr_attr_desc.type);
       ++nb_instance_attribs;
@@ -284,7 +319,7 @@ setup_model_vertex_array
     instance_attrib_list = NULL;
   }
 
-  err = mdl->sys->rb.vertex_index_array(mdl->vertex_array, mesh_indices);
+  err = mdl->sys->rb.vertex_index_array(lod->vertex_array, mesh_indices);
   if(err != 0) {
     rdr_err = RDR_DRIVER_ERROR;
     goto error;
@@ -292,9 +327,11 @@ setup_model_vertex_array
 
 exit:
   assert(!instance_attrib_list || nb_instance_attribs);
-  mdl->nb_instance_attribs = nb_instance_attribs;
-  mdl->instance_attrib_list = instance_attrib_list;
-  mdl->sizeof_instance_attrib_data = sizeof_instance_attrib_data;
+  if(is_first_lod) {
+    mdl->nb_instance_attribs = nb_instance_attribs;
+    mdl->instance_attrib_list = instance_attrib_list;
+    mdl->sizeof_instance_attrib_data = sizeof_instance_attrib_data;
+  }
   return rdr_err;
 
 error:
@@ -314,27 +351,28 @@ setup_model_vertex_pos_array
    struct rdr_mesh_attrib_desc* mesh_attrib_list,
    struct rb_buffer* mesh_data,
    struct rb_buffer* mesh_indices,
-   struct rdr_model* mdl)
+   struct rdr_system* sys,
+   struct lod* lod)
 {
   size_t i = 0;
   int err = 0;
   enum rdr_error rdr_err = RDR_NO_ERROR;
   bool is_vertex_pos_array_updated = false;
 
-  assert((!nb_mesh_attribs || mesh_attrib_list) && mdl);
+  assert((!nb_mesh_attribs || mesh_attrib_list) && sys && lod);
 
-  mdl->hold_position = false;
-  for(i = 0; i < nb_mesh_attribs && !mdl->hold_position; ++i) {
-    mdl->hold_position = (mesh_attrib_list[i].usage == RDR_ATTRIB_POSITION);
-    if(mdl->hold_position) {
+  lod->hold_position = false;
+  for(i = 0; i < nb_mesh_attribs && !lod->hold_position; ++i) {
+    lod->hold_position = (mesh_attrib_list[i].usage == RDR_ATTRIB_POSITION);
+    if(lod->hold_position) {
       struct rb_buffer_attrib buffer_attrib;
 
       buffer_attrib.index = RDR_ATTRIB_POSITION_ID;
       buffer_attrib.stride = mesh_attrib_list[i].stride;
       buffer_attrib.offset = mesh_attrib_list[i].offset;
       buffer_attrib.type = mesh_attrib_list[i].type;
-      err = mdl->sys->rb.vertex_attrib_array
-        (mdl->vertex_pos_array, mesh_data, 1, &buffer_attrib);
+      err = sys->rb.vertex_attrib_array
+        (lod->vertex_pos_array, mesh_data, 1, &buffer_attrib);
       if(err != 0) {
         rdr_err = RDR_DRIVER_ERROR;
         goto error;
@@ -343,7 +381,7 @@ setup_model_vertex_pos_array
     }
   }
 
-  err = mdl->sys->rb.vertex_index_array(mdl->vertex_pos_array, mesh_indices);
+  err = sys->rb.vertex_index_array(lod->vertex_pos_array, mesh_indices);
   if(err != 0) {
     rdr_err = RDR_DRIVER_ERROR;
     goto error;
@@ -353,8 +391,8 @@ exit:
   return rdr_err;
 error:
   if(is_vertex_pos_array_updated) {
-    RBI(&mdl->sys->rb, remove_vertex_attrib
-      (mdl->vertex_pos_array, 1, (const int[]){0}));
+    RBI(&sys->rb, remove_vertex_attrib
+      (lod->vertex_pos_array, 1, (const int[]){0}));
   }
   goto exit;
 }
@@ -436,9 +474,11 @@ error:
 }
 
 static enum rdr_error
-setup_model(struct rdr_model* model)
+setup_lod
+  (struct rdr_model* model,
+   struct rdr_material_desc* mtr_desc,
+   struct lod* lod)
 {
-  struct rdr_material_desc mtr_desc;
   struct rdr_mesh_attrib_desc* mesh_attrib_list = NULL;
   struct rb_buffer* mesh_data = NULL;
   struct rb_buffer* mesh_indices = NULL;
@@ -446,15 +486,10 @@ setup_model(struct rdr_model* model)
   size_t nb_mesh_indices = 0;
   enum rdr_error rdr_err = RDR_NO_ERROR;
 
-  assert(model);
-
-  /* Retrieve the material descriptor (attribs, uniforms, etc.) */
-  rdr_err = rdr_get_material_desc(model->material, &mtr_desc);
-  if(rdr_err != RDR_NO_ERROR)
-    goto error;
+  assert(model && mtr_desc && lod);
 
   /* Get the mesh attribs and data. */
-  rdr_err = rdr_get_mesh_attribs(model->mesh, &nb_mesh_attribs, NULL);
+  rdr_err = rdr_get_mesh_attribs(lod->mesh, &nb_mesh_attribs, NULL);
   if(rdr_err != RDR_NO_ERROR)
     goto error;
 
@@ -467,46 +502,79 @@ setup_model(struct rdr_model* model)
     }
 
     rdr_err = rdr_get_mesh_attribs
-      (model->mesh, &nb_mesh_attribs, mesh_attrib_list);
+      (lod->mesh, &nb_mesh_attribs, mesh_attrib_list);
     if(rdr_err != RDR_NO_ERROR)
       goto error;
   }
 
   rdr_err = rdr_get_mesh_indexed_data
-    (model->mesh, &nb_mesh_indices, &mesh_indices, &mesh_data);
+    (lod->mesh, &nb_mesh_indices, &mesh_indices, &mesh_data);
   if(rdr_err != RDR_NO_ERROR)
     goto error;
 
-  /* Setup the model attribs/uniforms. */
   rdr_err = setup_model_vertex_array
-    (mtr_desc.nb_attribs,
-     mtr_desc.attrib_list,
+    (mtr_desc->nb_attribs,
+     mtr_desc->attrib_list,
      nb_mesh_attribs,
      mesh_attrib_list,
      mesh_data,
      mesh_indices,
-     model);
-  if(rdr_err != RDR_NO_ERROR)
-    goto error;
-
-  rdr_err = setup_model_uniforms
-    (mtr_desc.nb_uniforms, mtr_desc.uniform_list, model);
+     model,
+     lod);
   if(rdr_err != RDR_NO_ERROR)
     goto error;
 
-  /* Setup the model position vertex array. */
+  /* Setup the position vertex array of the level of detail. */
   rdr_err = setup_model_vertex_pos_array
-     (nb_mesh_attribs, mesh_attrib_list, mesh_data, mesh_indices, model);
+     (nb_mesh_attribs,
+      mesh_attrib_list,
+      mesh_data,
+      mesh_indices,
+      model->sys,
+      lod);
   if(rdr_err != RDR_NO_ERROR)
     goto error;
 
-  model->nb_indices = nb_mesh_indices;
-  model->is_setuped = true;
+  lod->nb_indices = nb_mesh_indices;
 
 exit:
   if(mesh_attrib_list)
     MEM_FREE(model->sys->allocator, mesh_attrib_list);
+  return rdr_err;
+error:
+  goto exit;
+}
 
+static enum rdr_error
+setup_model(struct rdr_model* model)
+{
+  struct rdr_material_desc mtr_desc;
+  size_t i = 0;
+  enum rdr_error rdr_err = RDR_NO_ERROR;
+
+  assert(model);
+
+  /* Retrieve the material descriptor (attribs, uniforms, etc.) */
+  rdr_err = rdr_get_material_desc(model->material, &mtr_desc);
+  if(rdr_err != RDR_NO_ERROR)
+    goto error;
+
+  /* Setup the model attribs/uniforms. The instance attribs are defined by
+   * the first level of detail. */
+  for(i = 0; i < model->nb_lods; ++i) {
+    rdr_err = setup_lod(model, &mtr_desc, model->lod_list + i);
+    if(rdr_err != RDR_NO_ERROR)
+      goto error;
+  }
+
+  rdr_err = setup_model_uniforms
+    (mtr_desc.nb_uniforms, mtr_desc.uniform_list, model);
+  if(rdr_err != RDR_NO_ERROR)
+    goto error;
+
+  model->is_setuped = true;
+
+exit:
   return rdr_err;
 
 error:
@@ -525,14 +593,50 @@ error:
   goto exit;
 }
 
+/* The pending list is reserved to the number of models, i.e. flagging a
+ * model for update cannot fail. */
+static void
+flag_update(struct rdr_model* mdl)
+{
+  UNUSED enum sl_error sl_err = SL_NO_ERROR;
+  size_t len = 0;
+  assert(mdl);
+
+  if(mdl->pending_id != SIZE_MAX)
+    return;
+  SL(vector_length(mdl->sys->model_updates.pending_list, &len));
+  sl_err = sl_vector_push_back(mdl->sys->model_updates.pending_list, &mdl);
+  assert(sl_err == SL_NO_ERROR);
+  mdl->pending_id = len;
+}
+
+static void
+unflag_update(struct rdr_model* mdl)
+{
+  struct rdr_model** buffer = NULL;
+  size_t len = 0;
+  assert(mdl);
+
+  if(mdl->pending_id == SIZE_MAX)
+    return;
+  SL(vector_buffer
+    (mdl->sys->model_updates.pending_list, &len, NULL, NULL,
+     (void**)&buffer));
+  assert(mdl->pending_id < len && buffer[mdl->pending_id] == mdl);
+  buffer[mdl->pending_id] = buffer[len - 1];
+  buffer[mdl->pending_id]->pending_id = mdl->pending_id;
+  SL(vector_pop_back(mdl->sys->model_updates.pending_list));
+  mdl->pending_id = SIZE_MAX;
+}
+
 static enum rdr_error
 reset_model(struct rdr_model* mdl)
 {
+  size_t i = 0;
   enum rdr_error rdr_err = RDR_NO_ERROR;
 
   assert(mdl);
 
-  mdl->nb_indices = 0;
   mdl->is_setuped = false;
 
   if(mdl->instance_attrib_list) {
@@ -553,10 +657,75 @@ reset_model(struct rdr_model* mdl)
     mdl->sizeof_uniform_data = 0;
   }
 
-  rdr_err = unbind_all_attribs(mdl);
+  /* The vertex arrays of the discarded levels of detail are unbound too. */
+  for(i = 0; i < RDR_MAX_MODEL_LODS && rdr_err == RDR_NO_ERROR; ++i) {
+    mdl->lod_list[i].nb_indices = 0;
+    if(mdl->lod_list[i].vertex_array)
+      rdr_err = unbind_all_attribs(mdl->sys, mdl->lod_list + i);
+  }
   return rdr_err;
 }
 
+static enum rdr_error
+create_lod_vertex_arrays(struct rdr_system* sys, struct lod* lod)
+{
+  int err = 0;
+  assert(sys && lod && !lod->vertex_array && !lod->vertex_pos_array);
+
+  err = sys->rb.create_vertex_array(sys->ctxt, &lod->vertex_array);
+  if(err != 0)
+    return RDR_DRIVER_ERROR;
+  err = sys->rb.create_vertex_array(sys->ctxt, &lod->vertex_pos_array);
+  if(err != 0) {
+    RBI(&sys->rb, vertex_array_ref_put(lod->vertex_array));
+    lod->vertex_array = NULL;
+    return RDR_DRIVER_ERROR;
+  }
+  return RDR_NO_ERROR;
+}
+
+static bool
+is_mesh_used(struct rdr_model* mdl, struct rdr_mesh* mesh)
+{
+  size_t i = 0;
+  assert(mdl && mesh);
+  for(i = 0; i < mdl->nb_lods && mdl->lod_list[i].mesh != mesh; ++i);
+  return i < mdl->nb_lods;
+}
+
+/* Attach the model to the mesh updates. */
+static enum rdr_error
+watch_mesh(struct rdr_model* mdl, struct rdr_mesh* mesh)
+{
+  bool b = false;
+  assert(mdl && mesh);
+
+  RDR(is_mesh_callback_attached
+    (mesh, RDR_MESH_SIGNAL_UPDATE_DATA, mesh_callback_func, mdl, &b));
+  if(b)
+    return RDR_NO_ERROR;
+  return rdr_attach_mesh_callback
+    (mesh, RDR_MESH_SIGNAL_UPDATE_DATA, mesh_callback_func, mdl);
+}
+
+/* Detach the model from the updates of the mesh if none of its levels of
+ * detail uses it anymore. */
+static void
+unwatch_mesh(struct rdr_model* mdl, struct rdr_mesh* mesh)
+{
+  bool b = false;
+  assert(mdl && mesh);
+
+  if(is_mesh_used(mdl, mesh))
+    return;
+  RDR(is_mesh_callback_attached
+    (mesh, RDR_MESH_SIGNAL_UPDATE_DATA, mesh_callback_func, mdl, &b));
+  if(b) {
+    RDR(detach_mesh_callback
+      (mesh, RDR_MESH_SIGNAL_UPDATE_DATA, mesh_callback_func, mdl));
+  }
+}
+
 static void
 release_model(struct ref* ref)
 {
@@ -570,6 +739,8 @@ release_model(struct ref* ref)
   mdl = CONTAINER_OF(ref, struct rdr_model, ref);
   rdr_err = reset_model(mdl);
   assert(rdr_err == RDR_NO_ERROR);
+  unflag_update(mdl);
+  --mdl->sys->model_updates.nb_models;
 
   for(i = 0; i < RDR_NB_MODEL_SIGNALS; ++i) {
     if(mdl->callback_set[i]) {
@@ -594,21 +765,24 @@ release_model(struct ref* ref)
        material_callback_func,
        mdl));
   }
-  RDR(is_mesh_callback_attached
-    (mdl->mesh, RDR_MESH_SIGNAL_UPDATE_DATA, mesh_callback_func, mdl, &b));
-  if(b) {
-    RDR(detach_mesh_callback
-      (mdl->mesh, RDR_MESH_SIGNAL_UPDATE_DATA, mesh_callback_func, mdl));
+  while(mdl->nb_lods) {
+    struct lod* lod = mdl->lod_list + (--mdl->nb_lods);
+    unwatch_mesh(mdl, lod->mesh);
+    RDR(mesh_ref_put(lod->mesh));
+  }
+  for(i = 0; i < RDR_MAX_MODEL_LODS; ++i) {
+    struct lod* lod = mdl->lod_list + i;
+    if(lod->vertex_array)
+      RBI(&mdl->sys->rb, vertex_array_ref_put(lod->vertex_array));
+    if(lod->vertex_pos_array)
+      RBI(&mdl->sys->rb, vertex_array_ref_put(lod->vertex_pos_array));
   }
-
-  if(mdl->vertex_array)
-    RBI(&mdl->sys->rb, vertex_array_ref_put(mdl->vertex_array));
-  if(mdl->vertex_pos_array)
-    RBI(&mdl->sys->rb, vertex_array_ref_put(mdl->vertex_pos_array));
-  if(mdl->mesh)
-    RDR(mesh_ref_put(mdl->mesh));
   if(mdl->material)
     RDR(material_ref_put(mdl->material));
+  if(mdl->occluder.vertices)
+    MEM_FREE(mdl->sys->allocator, mdl->occluder.vertices);
+  if(mdl->occluder.indices)
+    MEM_FREE(mdl->sys->allocator, mdl->occluder.indices);
 
   sys = mdl->sys;
   MEM_FREE(mdl->sys->allocator, mdl);
@@ -631,13 +805,15 @@ invoke_callbacks(struct rdr_model* mdl, enum rdr_model_signal signal)
   }
 }
 
-/* Factorize the code of the material/mesh callbacks. */
+/* Reset the model and notify its dependents once, whatever the number of
+ * mesh/material updates since the model was flagged. */
 static void
-generic_callback_func(struct rdr_model* mdl)
+update_model(struct rdr_model* mdl)
 {
   enum rdr_error rdr_err = RDR_NO_ERROR;
-  assert(mdl);
+  assert(mdl && mdl->pending_id != SIZE_MAX);
 
+  unflag_update(mdl);
   rdr_err = reset_model(mdl);
   assert(rdr_err == RDR_NO_ERROR);
   invoke_callbacks(mdl, RDR_MODEL_SIGNAL_UPDATE_DATA);
@@ -646,13 +822,13 @@ generic_callback_func(struct rdr_model* mdl)
 static void
 material_callback_func(struct rdr_material* mtr_obj UNUSED, void* data)
 {
-  generic_callback_func(data);
+  flag_update(data);
 }
 
 static void
 mesh_callback_func(struct rdr_mesh* mesh UNUSED, void* data)
 {
-  generic_callback_func(data);
+  flag_update(data);
 }
 
 /******************************************************************************
@@ -671,7 +847,6 @@ rdr_create_model
   size_t i = 0;
   enum rdr_error rdr_err = RDR_NO_ERROR;
   enum sl_error sl_err = SL_NO_ERROR;
-  int err = 0;
 
   if(!sys || !mesh || !material || !out_model) {
     rdr_err = RDR_INVALID_ARGUMENT;
@@ -686,6 +861,15 @@ rdr_create_model
   ref_init(&model->ref);
   RDR(system_ref_get(sys));
   model->sys = sys;
+  model->pending_id = SIZE_MAX;
+  ++sys->model_updates.nb_models;
+
+  sl_err = sl_vector_reserve
+    (sys->model_updates.pending_list, sys->model_updates.nb_models);
+  if(sl_err != SL_NO_ERROR) {
+    rdr_err = sl_to_rdr_error(sl_err);
+    goto error;
+  }
 
   for(i = 0; i < RDR_NB_MODEL_SIGNALS; ++i) {
     sl_err = sl_create_flat_set
@@ -699,18 +883,9 @@ rdr_create_model
       goto error;
     }
   }
-  err = model->sys->rb.create_vertex_array
-    (model->sys->ctxt, &model->vertex_array);
-  if(err != 0) {
-    rdr_err = RDR_DRIVER_ERROR;
-    goto error;
-  }
-  err = model->sys->rb.create_vertex_array
-    (model->sys->ctxt, &model->vertex_pos_array);
-  if(err != 0) {
-    rdr_err = RDR_DRIVER_ERROR;
+  rdr_err = create_lod_vertex_arrays(model->sys, model->lod_list);
+  if(rdr_err != RDR_NO_ERROR)
     goto error;
-  }
 
   #define CALL(func) \
     do { \
@@ -718,8 +893,6 @@ rdr_create_model
         goto error; \
     } while(0)
   CALL(rdr_model_mesh(model, mesh));
-  CALL(rdr_attach_mesh_callback
-    (mesh, RDR_MESH_SIGNAL_UPDATE_DATA, &mesh_callback_func, model));
   CALL(rdr_model_material(model, material));
   CALL(rdr_attach_material_callback
     (material,
@@ -764,56 +937,194 @@ rdr_model_mesh
   (struct rdr_model* model,
    struct rdr_mesh* mesh)
 {
-  /* Used when an error occurs. */
   struct rdr_mesh* released_mesh = NULL;
-  struct rdr_mesh* retained_mesh = NULL;
-
   enum rdr_error rdr_err = RDR_NO_ERROR;
-  bool mesh_has_changed = false;
 
   if(!model || !mesh) {
     rdr_err = RDR_INVALID_ARGUMENT;
     goto error;
   }
+  if(model->nb_lods && model->lod_list[0].mesh == mesh)
+    goto exit;
+
+  rdr_err = watch_mesh(model, mesh);
+  if(rdr_err != RDR_NO_ERROR)
+    goto error;
+  rdr_err = reset_model(model);
+  if(rdr_err != RDR_NO_ERROR) {
+    unwatch_mesh(model, mesh);
+    goto error;
+  }
 
-  if(model->mesh != mesh)  {
-    mesh_has_changed = true;
+  RDR(mesh_ref_get(mesh));
+  if(model->nb_lods)
+    released_mesh = model->lod_list[0].mesh;
+  model->lod_list[0].mesh = mesh;
+  model->lod_list[0].error = 0.f;
+  model->nb_lods = model->nb_lods ? model->nb_lods : 1;
+  if(released_mesh) {
+    unwatch_mesh(model, released_mesh);
+    RDR(mesh_ref_put(released_mesh));
+  }
+  flag_update(model);
 
-    rdr_err = reset_model(model);
-    if(rdr_err != RDR_NO_ERROR)
-      goto error;
+exit:
+  return rdr_err;
+error:
+  goto exit;
+}
 
-    if(model->mesh) {
-      RDR(mesh_ref_put(model->mesh));
-      released_mesh = model->mesh;
+enum rdr_error
+rdr_get_model_mesh(struct rdr_model* model, struct rdr_mesh** mesh)
+{
+  if(UNLIKELY(!model || !mesh))
+    return RDR_INVALID_ARGUMENT;
+  *mesh = model->lod_list[0].mesh;
+  return RDR_NO_ERROR;
+}
+
+enum rdr_error
+rdr_model_lods
+  (struct rdr_model* model,
+   size_t nb_lods,
+   const struct rdr_model_lod lod_list[])
+{
+  struct rdr_mesh* released_mesh_list[RDR_MAX_MODEL_LODS];
+  bool is_watched[RDR_MAX_MODEL_LODS];
+  size_t nb_released_meshes = 0;
+  size_t i = 0;
+  enum rdr_error rdr_err = RDR_NO_ERROR;
+
+  memset(is_watched, 0, sizeof(is_watched));
+  if(!model || nb_lods >= RDR_MAX_MODEL_LODS || (nb_lods && !lod_list)) {
+    rdr_err = RDR_INVALID_ARGUMENT;
+    goto error;
+  }
+  /* The levels of detail are ordered by increasing errors. */
+  for(i = 0; i < nb_lods; ++i) {
+    if(!lod_list[i].mesh
+    || !(lod_list[i].error >= (i ? lod_list[i - 1].error : 0.f))) {
+      rdr_err = RDR_INVALID_ARGUMENT;
+      goto error;
     }
+  }
+  for(i = 0; i < nb_lods; ++i) {
+    struct lod* lod = model->lod_list + i + 1;
+    bool b = false;
+    if(!lod->vertex_array) {
+      rdr_err = create_lod_vertex_arrays(model->sys, lod);
+      if(rdr_err != RDR_NO_ERROR)
+        goto error;
+    }
+    RDR(is_mesh_callback_attached
+      (lod_list[i].mesh, RDR_MESH_SIGNAL_UPDATE_DATA, mesh_callback_func,
+       model, &b));
+    if(!b) {
+      rdr_err = rdr_attach_mesh_callback
+        (lod_list[i].mesh, RDR_MESH_SIGNAL_UPDATE_DATA, mesh_callback_func,
+         model);
+      if(rdr_err != RDR_NO_ERROR)
+        goto error;
+      is_watched[i] = true;
+    }
+  }
+  rdr_err = reset_model(model);
+  if(rdr_err != RDR_NO_ERROR)
+    goto error;
 
-    RDR(mesh_ref_get(mesh));
-    retained_mesh = mesh;
-    model->mesh = mesh;
+  for(i = 1; i < model->nb_lods; ++i)
+    released_mesh_list[nb_released_meshes++] = model->lod_list[i].mesh;
+  for(i = 0; i < nb_lods; ++i) {
+    RDR(mesh_ref_get(lod_list[i].mesh));
+    model->lod_list[i + 1].mesh = lod_list[i].mesh;
+    model->lod_list[i + 1].error = lod_list[i].error;
+  }
+  for(i = nb_lods + 1; i < RDR_MAX_MODEL_LODS; ++i)
+    model->lod_list[i].mesh = NULL;
+  model->nb_lods = nb_lods + 1;
+  for(i = 0; i < nb_released_meshes; ++i) {
+    unwatch_mesh(model, released_mesh_list[i]);
+    RDR(mesh_ref_put(released_mesh_list[i]));
   }
+  flag_update(model);
 
 exit:
-  if(mesh_has_changed)
-    invoke_callbacks(model, RDR_MODEL_SIGNAL_UPDATE_DATA);
   return rdr_err;
-
 error:
-  if(model && released_mesh) {
-    RDR(mesh_ref_get(released_mesh));
-    model->mesh = released_mesh;
+  for(i = 0; i < nb_lods; ++i) {
+    if(is_watched[i]) {
+      RDR(detach_mesh_callback
+        (lod_list[i].mesh, RDR_MESH_SIGNAL_UPDATE_DATA, mesh_callback_func,
+         model));
+    }
   }
-  if(retained_mesh)
-    RDR(mesh_ref_put(retained_mesh));
   goto exit;
 }
 
 enum rdr_error
-rdr_get_model_mesh(struct rdr_model* model, struct rdr_mesh** mesh)
+rdr_get_model_lods
+  (struct rdr_model* model,
+   size_t* nb_lods,
+   struct rdr_model_lod lod_list[])
 {
-  if(UNLIKELY(!model || !mesh))
+  size_t i = 0;
+
+  if(UNLIKELY(!model || !nb_lods))
+    return RDR_INVALID_ARGUMENT;
+  *nb_lods = model->nb_lods - 1;
+  if(lod_list) {
+    for(i = 1; i < model->nb_lods; ++i) {
+      lod_list[i - 1].mesh = model->lod_list[i].mesh;
+      lod_list[i - 1].error = model->lod_list[i].error;
+    }
+  }
+  return RDR_NO_ERROR;
+}
+
+enum rdr_error
+rdr_model_occluder
+  (struct rdr_model* model,
+   size_t nb_vertices,
+   const float* vertices,
+   size_t nb_indices,
+   const unsigned int* indices)
+{
+  float* vertex_list = NULL;
+  unsigned int* index_list = NULL;
+  size_t i = 0;
+
+  if(!model
+  || (nb_vertices && !vertices)
+  || (nb_indices && !indices)
+  || nb_indices % 3)
     return RDR_INVALID_ARGUMENT;
-  *mesh = model->mesh;
+  for(i = 0; i < nb_indices; ++i) {
+    if(indices[i] >= nb_vertices)
+      return RDR_INVALID_ARGUMENT;
+  }
+  if(nb_indices) {
+    vertex_list = MEM_ALLOC
+      (model->sys->allocator, nb_vertices * 3 * sizeof(float));
+    index_list = MEM_ALLOC
+      (model->sys->allocator, nb_indices * sizeof(unsigned int));
+    if(!vertex_list || !index_list) {
+      if(vertex_list)
+        MEM_FREE(model->sys->allocator, vertex_list);
+      if(index_list)
+        MEM_FREE(model->sys->allocator, index_list);
+      return RDR_MEMORY_ERROR;
+    }
+    memcpy(vertex_list, vertices, nb_vertices * 3 * sizeof(float));
+    memcpy(index_list, indices, nb_indices * sizeof(unsigned int));
+  }
+  if(model->occluder.vertices)
+    MEM_FREE(model->sys->allocator, model->occluder.vertices);
+  if(model->occluder.indices)
+    MEM_FREE(model->sys->allocator, model->occluder.indices);
+  model->occluder.vertices = vertex_list;
+  model->occluder.indices = index_list;
+  model->occluder.nb_vertices = nb_indices ? nb_vertices : 0;
+  model->occluder.nb_indices = nb_indices;
   return RDR_NO_ERROR;
 }
 
@@ -863,7 +1174,7 @@ rdr_model_material
 
 exit:
   if(material_has_changed)
-    invoke_callbacks(model, RDR_MODEL_SIGNAL_UPDATE_DATA);
+    flag_update(model);
   return rdr_err;
 
 error:
@@ -889,11 +1200,13 @@ enum rdr_error
 rdr_bind_model
   (struct rdr_system* sys,
    struct rdr_model* model,
+   size_t lod_id,
    size_t* out_nb_indices,
    int flag)
 {
   struct rdr_material* mtr = NULL;
   struct rb_vertex_array* vertex_array = NULL;
+  struct lod* lod = NULL;
   size_t nb_indices = 0;
   enum rdr_error rdr_err = RDR_NO_ERROR;
   int err = 0;
@@ -903,25 +1216,30 @@ rdr_bind_model
     goto error;
   }
   if(model && flag != RDR_BIND_NONE) {
-    nb_indices = model->nb_indices;
-    if(flag == RDR_BIND_ALL) {
-      vertex_array = model->vertex_array;
-      mtr = model->material;
-    } else if(flag == RDR_BIND_ATTRIB_POSITION) {
-      if(model->hold_position == false) {
-        rdr_err = RDR_INVALID_ARGUMENT;
-        goto error;
-      }
-      vertex_array = model->vertex_pos_array;
-    } else {
+    if(flag != RDR_BIND_ALL && flag != RDR_BIND_ATTRIB_POSITION) {
       rdr_err = RDR_INVALID_ARGUMENT;
       goto error;
     }
+    if(model->pending_id != SIZE_MAX)
+      update_model(model);
     if(model->is_setuped == false) {
       rdr_err = setup_model(model);
       if(rdr_err != RDR_NO_ERROR)
         goto error;
     }
+    /* The levels of detail may be removed since lod_id was selected. */
+    lod = model->lod_list + MIN(lod_id, model->nb_lods - 1);
+    if(flag == RDR_BIND_ALL) {
+      vertex_array = lod->vertex_array;
+      mtr = model->material;
+    } else {
+      if(lod->hold_position == false) {
+        rdr_err = RDR_INVALID_ARGUMENT;
+        goto error;
+      }
+      vertex_array = lod->vertex_pos_array;
+    }
+    nb_indices = lod->nb_indices;
   }
 
   err = sys->rb.bind_vertex_array(sys->ctxt, vertex_array);
@@ -945,6 +1263,47 @@ error:
   goto exit;
 }
 
+enum rdr_error
+rdr_get_model_occluder
+  (struct rdr_model* model,
+   size_t* nb_vertices,
+   const float** vertices,
+   size_t* nb_indices,
+   const unsigned int** indices)
+{
+  if(UNLIKELY(!model || !nb_vertices || !vertices || !nb_indices || !indices))
+    return RDR_INVALID_ARGUMENT;
+  *nb_vertices = model->occluder.nb_vertices;
+  *vertices = model->occluder.vertices;
+  *nb_indices = model->occluder.nb_indices;
+  *indices = model->occluder.indices;
+  return RDR_NO_ERROR;
+}
+
+enum rdr_error
+rdr_select_model_lod
+  (struct rdr_model* model,
+   float error_scale,
+   size_t* lod)
+{
+  size_t i = 0;
+
+  if(!model || error_scale < 0.f || !lod)
+    return RDR_INVALID_ARGUMENT;
+
+  /* Refine up to the finest level whose projected error is tolerated. Coarser
+   * levels are only selected below a lower bound of the tolerance to avoid
+   * the popping of the instances lying at the transition distance. */
+  i = MIN(*lod, model->nb_lods - 1);
+  while(i > 0 && model->lod_list[i].error * error_scale > 1.f)
+    --i;
+  while(i + 1 < model->nb_lods
+     && model->lod_list[i + 1].error * error_scale <= LOD_HYSTERESIS)
+    ++i;
+  *lod = i;
+  return RDR_NO_ERROR;
+}
+
 /******************************************************************************
  *
  * Private render model functions.
@@ -962,6 +1321,8 @@ rdr_get_model_desc
     goto error;
   }
 
+  if(model->pending_id != SIZE_MAX)
+    update_model(model);
   if(!model->is_setuped) {
     enum rdr_error rdr_err = setup_model(model);
     if(rdr_err != RDR_NO_ERROR)
@@ -996,6 +1357,54 @@ rdr_attach_model_callback
   return RDR_NO_ERROR;
 }
 
+enum rdr_error
+rdr_attach_model_callbacks
+  (struct rdr_model* model,
+   enum rdr_model_signal sig,
+   void (*func)(struct rdr_model*, void*),
+   size_t nb_callbacks,
+   void* data_list[])
+{
+  struct callback* callback_list = NULL;
+  size_t i = 0;
+  enum rdr_error rdr_err = RDR_NO_ERROR;
+  enum sl_error sl_err = SL_NO_ERROR;
+
+  if(!model
+  || !func
+  || (nb_callbacks && !data_list)
+  || sig >= RDR_NB_MODEL_SIGNALS) {
+    rdr_err = RDR_INVALID_ARGUMENT;
+    goto error;
+  }
+  if(!nb_callbacks)
+    goto exit;
+
+  callback_list = MEM_ALLOC
+    (model->sys->allocator, nb_callbacks * sizeof(struct callback));
+  if(!callback_list) {
+    rdr_err = RDR_MEMORY_ERROR;
+    goto error;
+  }
+  for(i = 0; i < nb_callbacks; ++i) {
+    callback_list[i].func = func;
+    callback_list[i].data = data_list[i];
+  }
+  sl_err = sl_flat_set_insert_n
+    (model->callback_set[sig], nb_callbacks, callback_list);
+  if(sl_err != SL_NO_ERROR) {
+    rdr_err = sl_to_rdr_error(sl_err);
+    goto error;
+  }
+
+exit:
+  if(callback_list)
+    MEM_FREE(model->sys->allocator, callback_list);
+  return rdr_err;
+error:
+  goto exit;
+}
+
 enum rdr_error
 rdr_detach_model_callback
   (struct rdr_model* model,
@@ -1030,3 +1439,25 @@ rdr_is_model_callback_attached
   return RDR_NO_ERROR;
 }
 
+
+enum rdr_error
+rdr_flush_model_updates(struct rdr_system* sys)
+{
+  struct rdr_model** buffer = NULL;
+  size_t len = 0;
+
+  if(!sys)
+    return RDR_INVALID_ARGUMENT;
+  /* The update of a model removes it from the pending list. */
+  SL(vector_buffer
+    (sys->model_updates.pending_list, &len, NULL, NULL, (void**)&buffer));
+  while(len) {
+    update_model(buffer[len - 1]);
+    SL(vector_buffer
+      (sys->model_updates.pending_list, &len, NULL, NULL, (void**)&buffer));
+  }
+  return RDR_NO_ERROR;
+}
+
+#undef LOD_HYSTERESIS
+
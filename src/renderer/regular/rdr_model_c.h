@@ -28,9 +28,27 @@ LOCAL_SYM enum rdr_error
 rdr_bind_model
   (struct rdr_system* sys,
    struct rdr_model* model,
+   size_t lod, /* Clamped to the coarsest level of detail of the model */
    size_t* out_nb_indices,
    int flag); /* Combination of enum rdr_bind_flag */
 
+LOCAL_SYM enum rdr_error
+rdr_get_model_occluder
+  (struct rdr_model* model,
+   size_t* nb_vertices,
+   const float** vertices, /* x, y, z triplets */
+   size_t* nb_indices,
+   const unsigned int** indices);
+
+/* Select the level of detail of the model whose object space error, scaled by
+ * error_scale, does not exceed 1. The lod argument is the level selected
+ * previously and is updated with the new level. */
+LOCAL_SYM enum rdr_error
+rdr_select_model_lod
+  (struct rdr_model* model,
+   float error_scale,
+   size_t* lod);
+
 LOCAL_SYM enum rdr_error
 rdr_get_model_desc
   (struct rdr_model* model,
@@ -43,6 +61,15 @@ rdr_attach_model_callback
    void (*func)(struct rdr_model*, void*),
    void* data);
 
+/* Attach the func callback once per item of the data list. */
+LOCAL_SYM enum rdr_error
+rdr_attach_model_callbacks
+  (struct rdr_model* model,
+   enum rdr_model_signal signal,
+   void (*func)(struct rdr_model*, void*),
+   size_t nb_callbacks,
+   void* data_list[]);
+
 LOCAL_SYM enum rdr_error
 rdr_detach_model_callback
   (struct rdr_model* model,
@@ -58,5 +85,11 @@ rdr_is_model_callback_attached
    void* data,
    bool* is_attached);
 
+/* Reset the models whose mesh or material was updated since the previous
+ * flush and invoke their callbacks once per model. */
+LOCAL_SYM enum rdr_error
+rdr_flush_model_updates
+  (struct rdr_system* sys);
+
 #endif /* RDR_MODEL_C_H */
 
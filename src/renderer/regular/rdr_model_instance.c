@@ -4,6 +4,7 @@
 #include "renderer/regular/rdr_error_c.h"
 #include "renderer/regular/rdr_model_c.h"
 #include "renderer/regular/rdr_model_instance_c.h"
+#include "renderer/regular/rdr_occlusion.h"
 #include "renderer/regular/rdr_system_c.h"
 #include "renderer/regular/rdr_uniform.h"
 #include "renderer/rdr.h"
@@ -95,6 +96,8 @@ struct rdr_model_instance {
   struct aosf44 transform;
   /* The model from which the instance is created. */
   struct rdr_model* model;
+  /* Level of detail of the model selected by the last regular draw. */
+  size_t lod;
   /* List of callbacks to call when the instance change. */
   struct sl_flat_set* callback_set;
   /* Data of the model instance. */
@@ -390,6 +393,8 @@ invoke_callbacks(struct rdr_model_instance* instance)
   size_t i = 0;
   assert(instance);
 
+  if(!instance->callback_set)
+    return;
   SL(flat_set_buffer
     (instance->callback_set, &len, NULL, NULL, (void**)&buffer));
   for(i = 0; i < len; ++i) {
@@ -458,6 +463,7 @@ model_callback_func(struct rdr_model* model, void* data)
   }
   rdr_err = setup_model_instance_buffers(instance, &model_desc);
   assert(RDR_NO_ERROR == rdr_err);
+  instance->lod = 0;
   invoke_callbacks(instance);
 }
 
@@ -515,16 +521,58 @@ get_model_instance_obb
   return is_infinite;
 }
 
+/* Select the level of detail of the instance from the view depth of its
+ * bounding sphere, i.e. the error is projected at the nearest point of the
+ * instance. */
+static void
+select_instance_lod
+  (struct rdr_model_instance* instance,
+   const struct aosf44* view_matrix,
+   float lod_scale)
+{
+  vf4_t pos, ext_x, ext_y, ext_z;
+  vf4_t vlen;
+  float radius = 0.f;
+  float depth = 0.f;
+  float scale = 0.f;
+  size_t nb_lods = 0;
+  assert(instance && view_matrix && lod_scale > 0.f);
+
+  RDR(get_model_lods(instance->model, &nb_lods, NULL));
+  if(!nb_lods
+  || get_model_instance_obb(instance, &pos, &ext_x, &ext_y, &ext_z)) {
+    instance->lod = 0;
+    return;
+  }
+  vlen = vf4_add(vf4_dot3(ext_x, ext_x), vf4_dot3(ext_y, ext_y));
+  radius = vf4_x(vf4_sqrt(vf4_add(vlen, vf4_dot3(ext_z, ext_z))));
+  pos = vf4_xyzd(pos, vf4_set1(1.f));
+  depth = -vf4_z(aosf44_mulf4(view_matrix, pos)) - radius;
+  if(depth <= 0.f) {
+    instance->lod = 0;
+    return;
+  }
+  vlen = vf4_max
+    (vf4_len3(instance->transform.c0),
+     vf4_max
+      (vf4_len3(instance->transform.c1), vf4_len3(instance->transform.c2)));
+  scale = vf4_x(vlen);
+  RDR(select_model_lod
+    (instance->model, lod_scale * scale / depth, &instance->lod));
+}
+
 static enum rdr_error
 regular_draw_instances
   (struct rdr_system* sys,
    const struct aosf44* view_matrix,
    const struct aosf44* proj_matrix,
+   float lod_scale,
    size_t nb_instances,
    struct rdr_model_instance** instance_list)
 {
   struct rdr_model_desc bound_mdl_desc;
   struct rdr_model* bound_mdl = NULL;
+  size_t bound_lod = 0;
   size_t nb_bound_indices = 0;
   size_t draw_id = 0;
   enum rdr_material_density used_density = NB_MATERIAL_DENSITY;
@@ -541,16 +589,23 @@ regular_draw_instances
       rdr_err = RDR_INVALID_ARGUMENT;
       goto error;
     }
-    if(instance->model != bound_mdl) {
+    if(lod_scale > 0.f) {
+      select_instance_lod(instance, view_matrix, lod_scale);
+    } else {
+      instance->lod = 0;
+    }
+    if(instance->model != bound_mdl || instance->lod != bound_lod) {
       rdr_err = rdr_bind_model
-        (sys, instance->model, &nb_bound_indices, RDR_BIND_ALL);
-      if(rdr_err != RDR_NO_ERROR)
-        goto error;
-      bound_mdl = instance->model;
-
-      rdr_err = rdr_get_model_desc(bound_mdl, &bound_mdl_desc);
+        (sys, instance->model, instance->lod, &nb_bound_indices, RDR_BIND_ALL);
       if(rdr_err != RDR_NO_ERROR)
         goto error;
+      bound_lod = instance->lod;
+      if(instance->model != bound_mdl) {
+        bound_mdl = instance->model;
+        rdr_err = rdr_get_model_desc(bound_mdl, &bound_mdl_desc);
+        if(rdr_err != RDR_NO_ERROR)
+          goto error;
+      }
     }
 
     rdr_err = dispatch_uniform_data
@@ -600,11 +655,12 @@ regular_draw_instances
       rdr_err = RDR_DRIVER_ERROR;
       goto error;
     }
+    sys->stats.nb_triangles += nb_bound_indices / 3;
   }
 
 exit:
   if(sys)
-    RDR(bind_model(sys, NULL, NULL, 0));
+    RDR(bind_model(sys, NULL, 0, NULL, 0));
   return rdr_err;
 error:
   goto exit;
@@ -620,6 +676,7 @@ draw_instances
    const struct rdr_draw_desc* draw_desc)
 {
   struct rdr_model* bound_mdl = NULL;
+  size_t bound_lod = 0;
   size_t nb_bound_indices = 0;
   size_t draw_id = 0;
   enum rdr_fill_mode used_fill_mode = NB_FILL_MODES;
@@ -641,12 +698,17 @@ draw_instances
       goto error;
     }
 
-    if(instance->model != bound_mdl) {
+    if(instance->model != bound_mdl || instance->lod != bound_lod) {
       rdr_err = rdr_bind_model
-        (sys, instance->model, &nb_bound_indices, RDR_BIND_ATTRIB_POSITION);
+        (sys,
+         instance->model,
+         instance->lod,
+         &nb_bound_indices,
+         RDR_BIND_ATTRIB_POSITION);
       if(rdr_err != RDR_NO_ERROR)
         goto error;
       bound_mdl = instance->model;
+      bound_lod = instance->lod;
     }
 
     rdr_err = dispatch_uniform_data
@@ -678,11 +740,12 @@ draw_instances
       rdr_err = RDR_DRIVER_ERROR;
       goto error;
     }
+    sys->stats.nb_triangles += nb_bound_indices / 3;
   }
 
 exit:
   if(sys)
-    RDR(bind_model(sys, NULL, NULL, 0));
+    RDR(bind_model(sys, NULL, 0, NULL, 0));
   return rdr_err;
 error:
   goto exit;
@@ -740,6 +803,19 @@ rdr_create_model_instance
   (struct rdr_system* sys,
    struct rdr_model* model,
    struct rdr_model_instance** out_instance)
+{
+  if(!out_instance)
+    return RDR_INVALID_ARGUMENT;
+  return rdr_create_model_instances(sys, model, 1, NULL, out_instance);
+}
+
+enum rdr_error
+rdr_create_model_instances
+  (struct rdr_system* sys,
+   struct rdr_model* model,
+   size_t nb_instances,
+   const float* transform_list,
+   struct rdr_model_instance* instance_list[])
 {
   const struct rdr_rasterizer_desc default_raster = {
     .cull_mode = RDR_CULL_BACK,
@@ -753,60 +829,64 @@ rdr_create_model_instance
   };
   struct rdr_model_desc model_desc;
   struct rdr_model_instance* instance = NULL;
-  enum sl_error sl_err = SL_NO_ERROR;
+  size_t i = 0;
   enum rdr_error rdr_err = RDR_NO_ERROR;
 
-  if(!sys || !model || !out_instance) {
+  if(!sys || !model || (nb_instances && !instance_list)) {
     rdr_err = RDR_INVALID_ARGUMENT;
     goto error;
   }
+  if(!nb_instances)
+    goto exit;
 
-  instance = MEM_ALIGNED_ALLOC
-    (sys->allocator, sizeof(struct rdr_model_instance), 16);
-  if(!instance) {
-    rdr_err = RDR_MEMORY_ERROR;
-    goto error;
-  }
-  memset(instance, 0, sizeof(struct rdr_model_instance));
-  ref_init(&instance->ref);
-  RDR(model_ref_get(model));
-  instance->model = model;
-  RDR(system_ref_get(sys));
-  instance->sys = sys;
-
-  sl_err = sl_create_flat_set
-    (sizeof(struct callback),
-     ALIGNOF(struct callback),
-     cmp_callbacks,
-     sys->allocator,
-     &instance->callback_set);
-  if(sl_err != SL_NO_ERROR) {
-    rdr_err = sl_to_rdr_error(sl_err);
+  memset(instance_list, 0, nb_instances * sizeof(struct rdr_model_instance*));
+  rdr_err = rdr_get_model_desc(model, &model_desc);
+  if(rdr_err != RDR_NO_ERROR)
     goto error;
-  }
+
   #define CALL(func) \
     do { \
       if(RDR_NO_ERROR != (rdr_err = func)) \
         goto error; \
     } while(0)
-  CALL(rdr_attach_model_callback
-    (model, RDR_MODEL_SIGNAL_UPDATE_DATA, &model_callback_func, instance));
-  CALL(rdr_get_model_desc(model, &model_desc));
-  CALL(setup_model_instance_buffers(instance, &model_desc));
-  CALL(rdr_model_instance_transform(instance, identity));
-  CALL(rdr_model_instance_material_density(instance, RDR_OPAQUE));
-  CALL(rdr_model_instance_rasterizer(instance, &default_raster));
+  for(i = 0; i < nb_instances; ++i) {
+    instance = MEM_ALIGNED_ALLOC
+      (sys->allocator, sizeof(struct rdr_model_instance), 16);
+    if(!instance) {
+      rdr_err = RDR_MEMORY_ERROR;
+      goto error;
+    }
+    memset(instance, 0, sizeof(struct rdr_model_instance));
+    ref_init(&instance->ref);
+    RDR(model_ref_get(model));
+    instance->model = model;
+    RDR(system_ref_get(sys));
+    instance->sys = sys;
+    instance_list[i] = instance;
+    /* The callback set of the instance is created on its first attachment. */
+    CALL(setup_model_instance_buffers(instance, &model_desc));
+    CALL(rdr_model_instance_transform
+      (instance, transform_list ? transform_list + i * 16 : identity));
+    CALL(rdr_model_instance_material_density(instance, RDR_OPAQUE));
+    CALL(rdr_model_instance_rasterizer(instance, &default_raster));
+  }
+  CALL(rdr_attach_model_callbacks
+    (model,
+     RDR_MODEL_SIGNAL_UPDATE_DATA,
+     &model_callback_func,
+     nb_instances,
+     (void**)instance_list));
   #undef CALL
 
 exit:
-  if(out_instance)
-    *out_instance = instance;
   return rdr_err;
 
 error:
-  if(instance) {
-    RDR(model_instance_ref_put(instance));
-    instance = NULL;
+  if(instance_list) {
+    for(i = 0; i < nb_instances && instance_list[i]; ++i) {
+      RDR(model_instance_ref_put(instance_list[i]));
+      instance_list[i] = NULL;
+    }
   }
   goto exit;
 }
@@ -1261,8 +1341,20 @@ rdr_attach_model_instance_callback
    void (*func)(struct rdr_model_instance*, void*),
    void* data)
 {
+  enum sl_error sl_err = SL_NO_ERROR;
+
   if(!instance || !func)
     return  RDR_INVALID_ARGUMENT;
+  if(!instance->callback_set) {
+    sl_err = sl_create_flat_set
+      (sizeof(struct callback),
+       ALIGNOF(struct callback),
+       cmp_callbacks,
+       instance->sys->allocator,
+       &instance->callback_set);
+    if(sl_err != SL_NO_ERROR)
+      return sl_to_rdr_error(sl_err);
+  }
   SL(flat_set_insert
     (instance->callback_set, (struct callback[]){{func, data}}, NULL));
   return RDR_NO_ERROR;
@@ -1299,6 +1391,10 @@ rdr_is_model_instance_callback_attached
 
   if(!instance || !func || !is_attached)
     return RDR_INVALID_ARGUMENT;
+  if(!instance->callback_set) {
+    *is_attached = false;
+    return RDR_NO_ERROR;
+  }
   SL(flat_set_find
     (instance->callback_set, (struct callback[]){{func, data}}, &i));
   SL(flat_set_buffer(instance->callback_set, &len, NULL, NULL, NULL));
@@ -1311,11 +1407,97 @@ rdr_is_model_instance_callback_attached
  * Private functions.
  *
  ******************************************************************************/
+enum rdr_error
+rdr_cull_instances
+  (struct rdr_system* sys,
+   struct rdr_occlusion* occlusion,
+   const struct aosf44* view_matrix,
+   const struct aosf44* proj_matrix,
+   size_t nb_instances,
+   struct rdr_model_instance** instance_list,
+   size_t* out_nb_visible_instances,
+   struct rdr_model_instance** visible_list)
+{
+  struct aosf44 view_proj;
+  struct aosf44 transform;
+  const float* vertices = NULL;
+  const unsigned int* indices = NULL;
+  size_t nb_vertices = 0;
+  size_t nb_indices = 0;
+  size_t nb_visible_instances = 0;
+  size_t i = 0;
+  enum rdr_error rdr_err = RDR_NO_ERROR;
+
+  if(UNLIKELY
+  (  !sys
+  || !occlusion
+  || !view_matrix
+  || !proj_matrix
+  || (nb_instances && (!instance_list || !visible_list))
+  || !out_nb_visible_instances)) {
+    rdr_err = RDR_INVALID_ARGUMENT;
+    goto error;
+  }
+  aosf44_mulf44(&view_proj, proj_matrix, view_matrix);
+
+  RDR(occlusion_clear(occlusion));
+  for(i = 0; i < nb_instances; ++i) {
+    if(!instance_list[i]) {
+      rdr_err = RDR_INVALID_ARGUMENT;
+      goto error;
+    }
+    RDR(get_model_occluder
+      (instance_list[i]->model, &nb_vertices, &vertices, &nb_indices,
+       &indices));
+    if(nb_indices) {
+      aosf44_mulf44(&transform, &view_proj, &instance_list[i]->transform);
+      RDR(occlusion_draw
+        (occlusion, &transform, nb_vertices, vertices, nb_indices, indices));
+    }
+  }
+  RDR(occlusion_update_tiles(occlusion));
+
+  for(i = 0; i < nb_instances; ++i) {
+    struct rdr_model_instance* instance = instance_list[i];
+    struct rdr_mesh* mesh = NULL;
+    float min_bound[3] = { 0.f, 0.f, 0.f };
+    float max_bound[3] = { 0.f, 0.f, 0.f };
+    bool is_visible = true;
+
+    RDR(get_model_occluder
+      (instance->model, &nb_vertices, &vertices, &nb_indices, &indices));
+    RDR(get_model_mesh(instance->model, &mesh));
+    RDR(get_mesh_aabb(mesh, min_bound, max_bound));
+    if(!nb_indices
+    && min_bound[0] > -FLT_MAX && max_bound[0] < FLT_MAX
+    && min_bound[1] > -FLT_MAX && max_bound[1] < FLT_MAX
+    && min_bound[2] > -FLT_MAX && max_bound[2] < FLT_MAX) {
+      aosf44_mulf44(&transform, &view_proj, &instance->transform);
+      RDR(occlusion_test_box
+        (occlusion, &transform, min_bound, max_bound, &is_visible));
+    }
+    if(is_visible)
+      visible_list[nb_visible_instances++] = instance;
+  }
+  /* The culled instances are submitted but not drawn. */
+  sys->stats.nb_instances += nb_instances - nb_visible_instances;
+  sys->stats.nb_culled_instances += nb_instances - nb_visible_instances;
+
+exit:
+  if(out_nb_visible_instances)
+    *out_nb_visible_instances = nb_visible_instances;
+  return rdr_err;
+error:
+  nb_visible_instances = 0;
+  goto exit;
+}
+
 enum rdr_error
 rdr_draw_instances
   (struct rdr_system* sys,
    const struct aosf44* view_matrix,
    const struct aosf44* proj_matrix,
+   float lod_scale,
    size_t nb_instances,
    struct rdr_model_instance** instance_list,
    const struct rdr_draw_desc* draw_desc)
@@ -1326,14 +1508,16 @@ rdr_draw_instances
   (  !sys
   || !view_matrix
   || !proj_matrix
+  || !(lod_scale >= 0.f)
   || (nb_instances && !instance_list))) {
     rdr_err = RDR_INVALID_ARGUMENT;
     goto error;
   }
 
+  sys->stats.nb_instances += nb_instances;
   if(!draw_desc) {
     rdr_err = regular_draw_instances
-      (sys, view_matrix, proj_matrix, nb_instances, instance_list);
+      (sys, view_matrix, proj_matrix, lod_scale, nb_instances, instance_list);
   } else {
     rdr_err = draw_instances
       (sys, view_matrix, proj_matrix, nb_instances, instance_list, draw_desc);
@@ -7,13 +7,33 @@
 struct aosf44;
 struct rdr_draw_desc;
 struct rdr_model_instance;
+struct rdr_occlusion;
 struct rdr_system;
 
+/* Draw the occluders of the instances and write in visible_list the instances
+ * that are neither outside of the view frustum nor hidden by the occluders.
+ * The instances with an occluder are always visible. */
+LOCAL_SYM enum rdr_error
+rdr_cull_instances
+  (struct rdr_system* sys,
+   struct rdr_occlusion* occlusion,
+   const struct aosf44* view_matrix,
+   const struct aosf44* proj_matrix,
+   size_t nb_instances,
+   struct rdr_model_instance** instance_list,
+   size_t* nb_visible_instances,
+   struct rdr_model_instance** visible_list);
+
+/* The lod_scale argument converts the ratio of an object space error to its
+ * view depth in a fraction of the system lod threshold. A null lod_scale
+ * draws the model meshes. The draws with a desc use the levels of detail
+ * selected by the previous regular draw of the instances. */
 LOCAL_SYM enum rdr_error
 rdr_draw_instances
   (struct rdr_system* sys,
    const struct aosf44* view_matrix,
    const struct aosf44* proj_matrix,
+   float lod_scale,
    size_t nb_instances,
    struct rdr_model_instance** instance_list,
    const struct rdr_draw_desc* desc);
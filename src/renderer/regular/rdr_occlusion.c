@@ -0,0 +1,367 @@
+#include "maths/simd/aosf44.h"
+#include "maths/simd/raster.h"
+#include "renderer/regular/rdr_occlusion.h"
+#include "renderer/regular/rdr_system_c.h"
+#include "renderer/rdr.h"
+#include "sys/math.h"
+#include "sys/mem_allocator.h"
+#include "sys/sys.h"
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+/* Definition of the depth buffer. Its tiles are rasterized by the simd
+ * library whose kernels match the instruction set of the host rather than
+ * the compilation flags of the renderer. */
+#define WIDTH 256 /* In pixels. */
+#define HEIGHT 128 /* In pixels. */
+#define TILE_WIDTH RASTER_TILE_WIDTH
+#define TILE_HEIGHT RASTER_TILE_HEIGHT
+#define TILE_SIZE RASTER_TILE_SIZE
+#define NB_TILES_X (WIDTH / TILE_WIDTH)
+#define NB_TILES_Y (HEIGHT / TILE_HEIGHT)
+
+struct rdr_occlusion {
+  /* Per pixel reciprocal of the clip space w of the nearest occluder, i.e.
+   * larger is nearer and 0 is an empty pixel. The pixels are stored tile by
+   * tile, each tile being row major. */
+  ALIGN(RASTER_ALIGNMENT) float depth[NB_TILES_X*NB_TILES_Y*TILE_SIZE];
+  /* Farthest depth of the pixels of each tile. */
+  float tile_depth[NB_TILES_X * NB_TILES_Y];
+  /* No occluder was drawn since the last clear. The buffer is thus neither
+   * cleared nor tested, e.g. for a world without occluder. */
+  bool is_empty;
+};
+
+/* Screen space vertex, in pixels, and reciprocal of its clip space w. */
+struct vertex {
+  float x, y, z;
+};
+
+/*******************************************************************************
+ *
+ * Helper functions.
+ *
+ ******************************************************************************/
+static FINLINE void
+to_screen(const float clip[4], struct vertex* vtx)
+{
+  const float rcp_w = 1.f / clip[3];
+  assert(clip && vtx && clip[3] > 0.f);
+  vtx->x = (clip[0] * rcp_w * 0.5f + 0.5f) * (float)WIDTH;
+  vtx->y = (clip[1] * rcp_w * 0.5f + 0.5f) * (float)HEIGHT;
+  vtx->z = rcp_w;
+}
+
+/* Edge function a*x + b*y + c, positive on the inner side of the edge. */
+static FINLINE void
+setup_edge(float edge[3], const struct vertex* v0, const struct vertex* v1)
+{
+  assert(edge && v0 && v1);
+  edge[0] = v0->y - v1->y;
+  edge[1] = v1->x - v0->x;
+  edge[2] = -(edge[0] * v0->x + edge[1] * v0->y);
+}
+
+static void
+draw_triangle
+  (struct rdr_occlusion* occlusion,
+   const struct vertex* v0,
+   const struct vertex* v1,
+   const struct vertex* v2)
+{
+  struct raster_triangle tri;
+  float area = 0.f;
+  float d1 = 0.f, d2 = 0.f;
+  float xmin = 0.f, xmax = 0.f, ymin = 0.f, ymax = 0.f;
+  int x0 = 0, x1 = 0, y0 = 0, y1 = 0;
+  int tx = 0, ty = 0;
+  assert(occlusion && v0 && v1 && v2);
+
+  area = (v1->x - v0->x)*(v2->y - v0->y) - (v2->x - v0->x)*(v1->y - v0->y);
+  if(area == 0.f)
+    return;
+  /* The occluders are not back face culled. */
+  if(area < 0.f) {
+    const struct vertex* tmp = v1;
+    v1 = v2;
+    v2 = tmp;
+    area = -area;
+  }
+  xmin = MAX(MIN(MIN(v0->x, v1->x), v2->x), 0.f);
+  xmax = MIN(MAX(MAX(v0->x, v1->x), v2->x), (float)WIDTH);
+  ymin = MAX(MIN(MIN(v0->y, v1->y), v2->y), 0.f);
+  ymax = MIN(MAX(MAX(v0->y, v1->y), v2->y), (float)HEIGHT);
+  if(xmin >= xmax || ymin >= ymax)
+    return;
+  x0 = (int)floorf(xmin);
+  x1 = (int)ceilf(xmax);
+  y0 = (int)floorf(ymin);
+  y1 = (int)ceilf(ymax);
+
+  setup_edge(tri.edges[0], v0, v1);
+  setup_edge(tri.edges[1], v1, v2);
+  setup_edge(tri.edges[2], v2, v0);
+  /* The depth is linear in screen space: z = z0 + w1*(z1-z0) + w2*(z2-z0)
+   * with the barycentric coordinates w1 = e20/area and w2 = e01/area. */
+  d1 = (v1->z - v0->z) / area;
+  d2 = (v2->z - v0->z) / area;
+  tri.depth[0] = tri.edges[2][0] * d1 + tri.edges[0][0] * d2;
+  tri.depth[1] = tri.edges[2][1] * d1 + tri.edges[0][1] * d2;
+  tri.depth[2] = tri.edges[2][2] * d1 + tri.edges[0][2] * d2 + v0->z;
+
+  for(ty = y0 / TILE_HEIGHT; ty * TILE_HEIGHT < y1; ++ty) {
+    const int row_begin = MAX(y0, ty * TILE_HEIGHT);
+    const int row_end = MIN(y1, (ty + 1) * TILE_HEIGHT);
+    for(tx = x0 / TILE_WIDTH; tx * TILE_WIDTH < x1; ++tx) {
+      raster_draw_tile
+        (occlusion->depth + (ty * NB_TILES_X + tx) * TILE_SIZE,
+         tx * TILE_WIDTH,
+         ty * TILE_HEIGHT,
+         row_begin,
+         row_end,
+         &tri);
+    }
+  }
+}
+
+/* Clip the triangle against the near plane, i.e. z >= -w, and draw the
+ * resulting polygon as a fan. */
+static void
+clip_and_draw_triangle
+  (struct rdr_occlusion* occlusion,
+   float clip[3][4])
+{
+  float poly[4][4];
+  struct vertex vtx[4];
+  float dist[3];
+  size_t nb_vertices = 0;
+  size_t i = 0;
+  size_t k = 0;
+  assert(occlusion && clip);
+
+  for(i = 0; i < 3; ++i)
+    dist[i] = clip[i][2] + clip[i][3];
+  if(dist[0] < 0.f && dist[1] < 0.f && dist[2] < 0.f)
+    return;
+
+  for(i = 0; i < 3; ++i) {
+    const size_t j = (i + 1) % 3;
+    if(dist[i] >= 0.f)
+      memcpy(poly[nb_vertices++], clip[i], sizeof(float[4]));
+    if((dist[i] >= 0.f) != (dist[j] >= 0.f)) {
+      const float t = dist[i] / (dist[i] - dist[j]);
+      for(k = 0; k < 4; ++k)
+        poly[nb_vertices][k] = clip[i][k] + t * (clip[j][k] - clip[i][k]);
+      ++nb_vertices;
+    }
+  }
+  assert(nb_vertices <= 4);
+  for(i = 0; i < nb_vertices; ++i) {
+    if(poly[i][3] <= 0.f)
+      return;
+    to_screen(poly[i], vtx + i);
+  }
+  for(i = 1; i + 1 < nb_vertices; ++i)
+    draw_triangle(occlusion, vtx, vtx + i, vtx + i + 1);
+}
+
+/*******************************************************************************
+ *
+ * Occlusion functions.
+ *
+ ******************************************************************************/
+enum rdr_error
+rdr_create_occlusion
+  (struct rdr_system* sys,
+   struct rdr_occlusion** out_occlusion)
+{
+  struct rdr_occlusion* occlusion = NULL;
+
+  if(UNLIKELY(!sys || !out_occlusion))
+    return RDR_INVALID_ARGUMENT;
+  occlusion = MEM_ALIGNED_ALLOC
+    (sys->allocator, sizeof(struct rdr_occlusion), RASTER_ALIGNMENT);
+  if(!occlusion)
+    return RDR_MEMORY_ERROR;
+  occlusion->is_empty = false;
+  RDR(occlusion_clear(occlusion));
+  RDR(occlusion_update_tiles(occlusion));
+  *out_occlusion = occlusion;
+  return RDR_NO_ERROR;
+}
+
+enum rdr_error
+rdr_free_occlusion(struct rdr_system* sys, struct rdr_occlusion* occlusion)
+{
+  if(UNLIKELY(!sys || !occlusion))
+    return RDR_INVALID_ARGUMENT;
+  MEM_FREE(sys->allocator, occlusion);
+  return RDR_NO_ERROR;
+}
+
+enum rdr_error
+rdr_occlusion_clear(struct rdr_occlusion* occlusion)
+{
+  if(UNLIKELY(!occlusion))
+    return RDR_INVALID_ARGUMENT;
+  if(!occlusion->is_empty) {
+    memset(occlusion->depth, 0, sizeof(occlusion->depth));
+    memset(occlusion->tile_depth, 0, sizeof(occlusion->tile_depth));
+    occlusion->is_empty = true;
+  }
+  return RDR_NO_ERROR;
+}
+
+enum rdr_error
+rdr_occlusion_draw
+  (struct rdr_occlusion* occlusion,
+   const struct aosf44* transform,
+   size_t nb_vertices,
+   const float* vertices,
+   size_t nb_indices,
+   const unsigned int* indices)
+{
+  ALIGN(16) float clip[3][4];
+  size_t i = 0;
+  size_t j = 0;
+
+  if(UNLIKELY
+  (  !occlusion
+  || !transform
+  || (nb_vertices && !vertices)
+  || (nb_indices && !indices)
+  || nb_indices % 3))
+    return RDR_INVALID_ARGUMENT;
+
+  occlusion->is_empty &= nb_indices == 0;
+  for(i = 0; i < nb_indices; i += 3) {
+    for(j = 0; j < 3; ++j) {
+      const float* pos = NULL;
+      assert(indices[i + j] < nb_vertices);
+      pos = vertices + indices[i + j] * 3;
+      vf4_store
+        (clip[j],
+         aosf44_mulf4(transform, vf4_set(pos[0], pos[1], pos[2], 1.f)));
+    }
+    clip_and_draw_triangle(occlusion, clip);
+  }
+  return RDR_NO_ERROR;
+}
+
+enum rdr_error
+rdr_occlusion_update_tiles(struct rdr_occlusion* occlusion)
+{
+  size_t tile_id = 0;
+
+  if(UNLIKELY(!occlusion))
+    return RDR_INVALID_ARGUMENT;
+  /* The tiles of an empty buffer are cleared with its pixels. */
+  if(occlusion->is_empty)
+    return RDR_NO_ERROR;
+
+  for(tile_id = 0; tile_id < NB_TILES_X * NB_TILES_Y; ++tile_id) {
+    occlusion->tile_depth[tile_id] =
+      raster_tile_depth(occlusion->depth + tile_id * TILE_SIZE);
+  }
+  return RDR_NO_ERROR;
+}
+
+enum rdr_error
+rdr_occlusion_test_box
+  (struct rdr_occlusion* occlusion,
+   const struct aosf44* transform,
+   const float min_bound[3],
+   const float max_bound[3],
+   bool* out_is_visible)
+{
+  ALIGN(16) float clip[8][4];
+  struct vertex vtx;
+  float xmin = FLT_MAX, xmax = -FLT_MAX;
+  float ymin = FLT_MAX, ymax = -FLT_MAX;
+  float zmax = 0.f;
+  int nb_outside[6] = { 0, 0, 0, 0, 0, 0 };
+  int x0 = 0, x1 = 0, y0 = 0, y1 = 0;
+  int tx = 0, ty = 0;
+  int i = 0;
+  bool is_visible = true;
+
+  if(UNLIKELY
+  (  !occlusion
+  || !transform
+  || !min_bound
+  || !max_bound
+  || !out_is_visible))
+    return RDR_INVALID_ARGUMENT;
+
+  for(i = 0; i < 8; ++i) {
+    const vf4_t pos = vf4_set
+      ((i & 1) ? max_bound[0] : min_bound[0],
+       (i & 2) ? max_bound[1] : min_bound[1],
+       (i & 4) ? max_bound[2] : min_bound[2],
+       1.f);
+    vf4_store(clip[i], aosf44_mulf4(transform, pos));
+    nb_outside[0] += clip[i][0] < -clip[i][3];
+    nb_outside[1] += clip[i][0] > clip[i][3];
+    nb_outside[2] += clip[i][1] < -clip[i][3];
+    nb_outside[3] += clip[i][1] > clip[i][3];
+    nb_outside[4] += clip[i][2] < -clip[i][3];
+    nb_outside[5] += clip[i][2] > clip[i][3];
+  }
+  for(i = 0; i < 6; ++i) {
+    if(nb_outside[i] == 8) {
+      is_visible = false;
+      goto exit;
+    }
+  }
+  /* The box crosses the near plane or there is no occluder. */
+  if(nb_outside[4] || occlusion->is_empty)
+    goto exit;
+
+  for(i = 0; i < 8; ++i) {
+    to_screen(clip[i], &vtx);
+    xmin = MIN(xmin, vtx.x);
+    xmax = MAX(xmax, vtx.x);
+    ymin = MIN(ymin, vtx.y);
+    ymax = MAX(ymax, vtx.y);
+    zmax = MAX(zmax, vtx.z);
+  }
+  /* Pixels overlapped by the screen space bounds of the box. A flat box
+   * covers at least one pixel. */
+  x0 = MIN((int)floorf(MAX(xmin, 0.f)), WIDTH - 1);
+  x1 = MAX((int)ceilf(MIN(xmax, (float)WIDTH)), x0 + 1);
+  y0 = MIN((int)floorf(MAX(ymin, 0.f)), HEIGHT - 1);
+  y1 = MAX((int)ceilf(MIN(ymax, (float)HEIGHT)), y0 + 1);
+
+  /* The box is visible if one of its pixels is farther than its nearest
+   * point. The tiles whose pixels are all nearer are skipped. */
+  for(ty = y0 / TILE_HEIGHT; ty * TILE_HEIGHT < y1; ++ty) {
+    const int row_begin = MAX(y0, ty * TILE_HEIGHT);
+    const int row_end = MIN(y1, (ty + 1) * TILE_HEIGHT);
+    for(tx = x0 / TILE_WIDTH; tx * TILE_WIDTH < x1; ++tx) {
+      const size_t tile_id = (size_t)(ty * NB_TILES_X + tx);
+      const float* tile = occlusion->depth + tile_id * TILE_SIZE;
+      if(occlusion->tile_depth[tile_id] > zmax)
+        continue;
+      if(raster_test_tile
+        (tile, tx * TILE_WIDTH, ty * TILE_HEIGHT, x0, x1, row_begin, row_end,
+         zmax))
+        goto exit;
+    }
+  }
+  is_visible = false;
+
+exit:
+  *out_is_visible = is_visible;
+  return RDR_NO_ERROR;
+}
+
+#undef WIDTH
+#undef HEIGHT
+#undef TILE_WIDTH
+#undef TILE_HEIGHT
+#undef TILE_SIZE
+#undef NB_TILES_X
+#undef NB_TILES_Y
+
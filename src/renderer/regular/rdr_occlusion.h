@@ -0,0 +1,57 @@
+#ifndef RDR_OCCLUSION_H
+#define RDR_OCCLUSION_H
+
+#include "renderer/rdr_error.h"
+#include "sys/sys.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+struct aosf44;
+struct rdr_occlusion;
+struct rdr_system;
+
+/* Low resolution depth buffer rasterized on the CPU. It stores the nearest
+ * occluder of each pixel and, per tile of pixels, the farthest of them. */
+LOCAL_SYM enum rdr_error
+rdr_create_occlusion
+  (struct rdr_system* sys,
+   struct rdr_occlusion** occlusion);
+
+LOCAL_SYM enum rdr_error
+rdr_free_occlusion
+  (struct rdr_system* sys,
+   struct rdr_occlusion* occlusion);
+
+LOCAL_SYM enum rdr_error
+rdr_occlusion_clear
+  (struct rdr_occlusion* occlusion);
+
+/* Rasterize the nb_indices / 3 triangles of the occluder. The vertices are
+ * x, y, z triplets that the transform matrix projects in clip space. */
+LOCAL_SYM enum rdr_error
+rdr_occlusion_draw
+  (struct rdr_occlusion* occlusion,
+   const struct aosf44* transform,
+   size_t nb_vertices,
+   const float* vertices,
+   size_t nb_indices,
+   const unsigned int* indices);
+
+/* Update the depth of the tiles from the drawn occluders. It must be invoked
+ * before the tests of the boxes. */
+LOCAL_SYM enum rdr_error
+rdr_occlusion_update_tiles
+  (struct rdr_occlusion* occlusion);
+
+/* A box is not visible if it lies outside of the view frustum or behind the
+ * drawn occluders. The transform matrix projects the box in clip space. */
+LOCAL_SYM enum rdr_error
+rdr_occlusion_test_box
+  (struct rdr_occlusion* occlusion,
+   const struct aosf44* transform,
+   const float min_bound[3],
+   const float max_bound[3],
+   bool* is_visible);
+
+#endif /* RDR_OCCLUSION_H */
+
@@ -204,6 +204,8 @@ read_back_picking_buffer
    const unsigned int pos[2],
    const unsigned int size[2])
 {
+  /* The result buffers are 16 bytes aligned. */
+  ALIGN(16) const uint32_t invalid_id = UINT32_MAX;
   struct sl_vector* pick_id_list = NULL;
   uint32_t* buf = NULL;
   size_t bufsize = 0;
@@ -242,9 +244,7 @@ read_back_picking_buffer
   /* Read back pick content. */
   pick_id_list = result_get_buffer(&picking->result);
   SL(vector_push_back_n
-    (pick_id_list,
-     blit_size[0] * blit_size[1],
-     (uint32_t[]){UINT32_MAX}));
+    (pick_id_list, blit_size[0] * blit_size[1], &invalid_id));
   SL(vector_buffer(pick_id_list, &bufsize, NULL, NULL, (void**)&buf));
 #ifndef NDEBUG
   {
@@ -1,11 +1,13 @@
 #include "renderer/regular/rdr_error_c.h"
 #include "renderer/regular/rdr_imdraw_c.h"
+#include "renderer/regular/rdr_model_c.h"
 #include "renderer/regular/rdr_system_c.h"
 #include "renderer/rdr.h"
 #include "renderer/rdr_system.h"
 #include "render_backend/rbi.h"
 #include "stdlib/sl.h"
 #include "stdlib/sl_logger.h"
+#include "stdlib/sl_vector.h"
 #include "sys/sys.h"
 #include <assert.h>
 #include <stdlib.h>
@@ -42,6 +44,11 @@ release_system(struct ref* ref)
 
   RDR(shutdown_im_rendering(sys));
 
+  if(LIKELY(sys->model_updates.pending_list != NULL)) {
+    assert(sys->model_updates.nb_models == 0);
+    SL(free_vector(sys->model_updates.pending_list));
+  }
+
   if(LIKELY(MEM_IS_ALLOCATOR_VALID(&sys->render_backend_allocator))) {
     if(0 != MEM_ALLOCATED_SIZE(&sys->render_backend_allocator)) {
       #define BUF_SIZE 2048
@@ -98,6 +105,7 @@ rdr_create_system
     goto error;
   }
   sys->allocator = allocator;
+  sys->lod_threshold = 1.f;
   ref_init(&sys->ref);
 
   /* The render backend does not use the user defined allocator since when its
@@ -118,6 +126,15 @@ rdr_create_system
     rdr_err = sl_to_rdr_error(sl_err);
     goto error;
   }
+  sl_err = sl_create_vector
+    (sizeof(struct rdr_model*),
+     ALIGNOF(struct rdr_model*),
+     sys->allocator,
+     &sys->model_updates.pending_list);
+  if(sl_err != SL_NO_ERROR) {
+    rdr_err = sl_to_rdr_error(sl_err);
+    goto error;
+  }
 
   #define CALL(func) \
     do { \
@@ -257,3 +274,29 @@ error:
   goto exit;
 }
 
+
+enum rdr_error
+rdr_system_flush_notifications(struct rdr_system* sys)
+{
+  if(UNLIKELY(!sys))
+    return RDR_INVALID_ARGUMENT;
+  return rdr_flush_model_updates(sys);
+}
+
+enum rdr_error
+rdr_system_lod_threshold(struct rdr_system* sys, float pixels)
+{
+  if(UNLIKELY(!sys || !(pixels >= 0.f)))
+    return RDR_INVALID_ARGUMENT;
+  sys->lod_threshold = pixels;
+  return RDR_NO_ERROR;
+}
+
+enum rdr_error
+rdr_system_procedural_grid(struct rdr_system* sys, bool is_enabled)
+{
+  if(UNLIKELY(!sys))
+    return RDR_INVALID_ARGUMENT;
+  sys->im.is_grid_procedural = is_enabled;
+  return RDR_NO_ERROR;
+}
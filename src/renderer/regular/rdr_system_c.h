@@ -6,11 +6,13 @@
 #include "renderer/regular/rdr_imdraw_c.h"
 #include "sys/mem_allocator.h"
 #include "sys/ref_count.h"
+#include <stdbool.h>
 
 #define RDR_ERRBUF_LEN 1024
 
 struct rb_context;
 struct sl_logger;
+struct sl_vector;
 
 struct rdr_system {
   struct mem_allocator* allocator;
@@ -23,6 +25,24 @@ struct rdr_system {
   struct rb_context* ctxt;
   struct rb_config cfg;
 
+  /* Screen space error, in pixels, tolerated by the selection of the model
+   * levels of detail. Zero disables the levels of detail. */
+  float lod_threshold;
+
+  /* Counters accumulated since the creation of the system. */
+  struct rdr_system_stats {
+    size_t nb_instances;
+    size_t nb_culled_instances;
+    size_t nb_triangles;
+  } stats;
+
+  /* Models whose mesh or material was updated. Their dependents are notified
+   * once, at the next flush. */
+  struct model_updates {
+    struct sl_vector* pending_list;
+    size_t nb_models;
+  } model_updates;
+
   /* im rendering. */
   struct im_rendering {
     struct im_draw {
@@ -31,18 +51,38 @@ struct rdr_system {
       struct rb_program* shading_program;
       struct rb_uniform* transform;
       struct rb_uniform* color;
-    } draw2d, draw3d, draw2d_color, draw2d_picking, draw3d_picking;
+    } draw2d_color, draw2d_picking, stream, stream_picking;
+    /* Grid whose lines are computed by the fragment shader of a quad. The
+     * picking program has no color uniforms. */
+    struct im_grid_draw {
+      struct im_draw draw;
+      struct rb_uniform* div; /* XY divisions and XY sub divisions. */
+      struct rb_uniform* div_color;
+      struct rb_uniform* subdiv_color;
+      struct rb_uniform* vaxis_color;
+      struct rb_uniform* haxis_color;
+    } procedural_grid, procedural_grid_picking;
+    /* Line vertices of the last used grids, built on the CPU when the
+     * procedural grid is disabled. The entries are retrieved from their
+     * descriptor and the least recently used one is rebuilt on a miss. */
     struct im_grid {
       struct rdr_im_grid_desc desc;
       struct rb_buffer* vertex_buffer;
       struct rb_vertex_array* vertex_array;
       size_t sizeof_vertex_buffer;
+      size_t last_use; /* 0 <=> unused entry. */
       unsigned int nvertices;
-    } grid;
-    struct im_line {
+    } grid_cache[RDR_IMGRID_CACHE_SIZE];
+    size_t grid_clock; /* Time stamp of the grid cache. */
+    bool is_grid_procedural;
+    /* Clip space vertices of the batched commands, per render state. */
+    struct im_stream {
+      struct sl_vector* vertex_list[RDR_NB_IMDRAW_BUCKETS];
       struct rb_buffer* vertex_buffer;
       struct rb_vertex_array* vertex_array;
-    } line;
+      size_t sizeof_vertex_buffer;
+    } vertex_stream;
+    float circle[RDR_IMCIRCLE_NPOINTS][2]; /* Points of the unit circle. */
   } im;
 
   /* Render backend utils. */
@@ -30,10 +30,36 @@
 #define GLYPH_CACHE_TEX_UNIT 0
 #define NB_ATTRIBS 3
 
+/* Glyph of a line whose vertices are expressed relatively to the bottom row of
+ * the line. */
+struct line_glyph {
+  float vertices[VERTICES_PER_GLYPH * SIZEOF_GLYPH_VERTEX / sizeof(float)];
+  size_t row_y; /* Offset of the glyph row from the bottom row of the line. */
+  size_t cursor_x;
+  size_t cursor_width;
+  bool has_quad;
+};
+
 struct line {
   struct list_node node;
   struct sl_wstring* string;
   struct sl_vector* color_list; /* Vector of unsigned char{3]. */
+  /* Glyph data of the line, regenerated when the line is dirty. */
+  struct sl_vector* glyph_list; /* Vector of struct line_glyph. */
+  size_t nb_wraps;
+  size_t end_x; /* Pen position after the last glyph. */
+  size_t end_width; /* Width of the cursor after the last glyph. */
+  size_t version; /* Incremented each time the glyph data are regenerated. */
+  bool is_dirty;
+};
+
+/* Line drawn by the printer. */
+struct draw_line {
+  const struct line* line;
+  size_t version;
+  size_t y; /* Position of the bottom row of the line. */
+  size_t first_glyph;
+  size_t nb_glyphs;
 };
 
 struct screen {
@@ -96,7 +122,12 @@ struct rdr_term {
   struct rdr_system* sys;
   size_t width; /* In pixels. */
   size_t height; /* In Pixels. */
+  size_t position[2]; /* Bottom left corner in the framebuffer, in pixels. */
   struct blob scratch;
+  struct blob glyph_vertices; /* Copy of the printer glyph vertex buffer. */
+  struct blob draw_lists[2]; /* struct draw_line of the last 2 frames. */
+  size_t draw_list_id; /* Id of the draw list of the last frame. */
+  struct rdr_term_stats stats;
   struct screen screen;
   struct printer printer;
 };
@@ -130,7 +161,8 @@ static const char* print_fs_source =
   "out vec4 color;\n"
   "void main()\n"
   "{\n"
-  "  float val = texture(glyph_cache, glyph_tex).r;\n"
+  "  vec2 tex = glyph_tex / vec2(textureSize(glyph_cache, 0));\n"
+  "  float val = texture(glyph_cache, tex).r;\n"
   "  color = vec4(val * glyph_col, val);\n"
   "}\n";
 
@@ -308,6 +340,7 @@ new_buf(struct screen* scr, enum rdr_term_output output)
   (*line) = CONTAINER_OF(node, struct line, node);
   SL(clear_wstring((*line)->string));
   SL(clear_vector((*line)->color_list));
+  (*line)->is_dirty = true;
 
   /* Init the cmdbuf with prompt text. */
   if(RDR_TERM_CMDOUT == output && 0 != scr->cursor) {
@@ -337,6 +370,8 @@ reset_screen(struct rdr_system* sys, struct screen* scr)
       SL(free_wstring(line->string));
     if(line->color_list)
       SL(free_vector(line->color_list));
+    if(line->glyph_list)
+      SL(free_vector(line->glyph_list));
   }
   if(scr->line_list) {
     MEM_FREE(sys->allocator, scr->line_list);
@@ -417,8 +452,8 @@ screen_storage
     goto exit;
 
   scr->nb_lines = total_nb_lines;
-  scr->line_list = MEM_ALLOC
-    (sys->allocator, total_nb_lines * sizeof(struct line));
+  scr->line_list = MEM_CALLOC
+    (sys->allocator, total_nb_lines, sizeof(struct line));
   if(!scr->line_list) {
     rdr_err = RDR_MEMORY_ERROR;
     goto error;
@@ -441,6 +476,16 @@ screen_storage
       rdr_err = sl_to_rdr_error(sl_err);
       goto error;
     }
+    sl_err = sl_create_vector
+      (sizeof(struct line_glyph),
+       ALIGNOF(struct line_glyph),
+       sys->allocator,
+       &line->glyph_list);
+    if(SL_NO_ERROR != sl_err) {
+      rdr_err = sl_to_rdr_error(sl_err);
+      goto error;
+    }
+    line->is_dirty = true;
     list_add(&scr->free_line_list, &line->node);
   }
 
@@ -537,20 +582,32 @@ printer_storage
   }
 }
 
+/* Update the [first_glyph, first_glyph + nb_updated_glyphs[ range of the
+ * glyph vertex buffer with the corresponding glyphs of data. */
 static void
 printer_data
   (struct rdr_system* sys,
    struct printer* printer,
    size_t nb_glyphs,
-   float* data)
+   size_t first_glyph,
+   size_t nb_updated_glyphs,
+   const unsigned char* data)
 {
-  const size_t size = nb_glyphs * VERTICES_PER_GLYPH * SIZEOF_GLYPH_VERTEX;
-  assert(sys && printer && (!nb_glyphs || data));
-  assert
-    (  size
-    <= (printer->text.max_nb_glyphs*VERTICES_PER_GLYPH*SIZEOF_GLYPH_VERTEX));
-
-  RBI(&sys->rb, buffer_data(printer->text.glyph_vertex_buffer, 0, size, data));
+  const size_t sizeof_glyph = VERTICES_PER_GLYPH * SIZEOF_GLYPH_VERTEX;
+  const size_t offset = first_glyph * sizeof_glyph;
+  const size_t size = nb_updated_glyphs * sizeof_glyph;
+  assert(sys && printer && (!nb_updated_glyphs || data));
+  assert(nb_glyphs <= printer->text.max_nb_glyphs);
+  assert(first_glyph + nb_updated_glyphs <= printer->text.max_nb_glyphs);
+  assert(offset <= INT_MAX && size <= INT_MAX);
+
+  if(size) {
+    RBI(&sys->rb, buffer_data
+      (printer->text.glyph_vertex_buffer,
+       (int)offset,
+       (int)size,
+       data + offset));
+  }
   printer->text.nb_glyphs = nb_glyphs;
 }
 
@@ -673,6 +730,7 @@ printer_draw
   (struct rdr_system* sys,
    struct rdr_font* font,
    struct printer* printer,
+   const size_t position[2],
    size_t width,
    size_t height,
    size_t cursor_x,
@@ -683,8 +741,9 @@ printer_draw
   struct rb_viewport_desc viewport_desc;
   memset(&depth_stencil_desc, 0, sizeof(depth_stencil_desc));
   memset(&viewport_desc, 0, sizeof(viewport_desc));
-  assert(sys && printer);
+  assert(sys && printer && position);
   assert(width < INT_MAX && height < INT_MAX);
+  assert(position[0] < INT_MAX && position[1] < INT_MAX);
 
   depth_stencil_desc.enable_depth_test = 0;
   depth_stencil_desc.enable_depth_write = 0;
@@ -693,8 +752,8 @@ printer_draw
   depth_stencil_desc.back_face_op.write_mask = 0;
   RBI(&sys->rb, depth_stencil(sys->ctxt, &depth_stencil_desc));
 
-  viewport_desc.x = 0;
-  viewport_desc.y = 0;
+  viewport_desc.x = (int)position[0];
+  viewport_desc.y = (int)position[1];
   viewport_desc.width = (int)width;
   viewport_desc.height = (int)height;
   viewport_desc.min_depth = 0.f;
@@ -1031,6 +1090,7 @@ generic_print_string
       CALL(wstring_insert(term->screen.cmdbuf->string, old_prompt_len, str));
       CALL(sl_vector_insert_n
         (term->screen.cmdbuf->color_list, old_prompt_len, len, color));
+      term->screen.cmdbuf->is_dirty = true;
     }
     term->screen.cursor += len;
   } else if(0 != term->screen.lines_per_screen) {
@@ -1041,6 +1101,7 @@ generic_print_string
       CALL(wstring_insert(line->string, term->screen.cursor, str));
       CALL(sl_vector_insert_n
         (line->color_list, term->screen.cursor, len, color));
+      line->is_dirty = true;
       term->screen.cursor += len;
     } else { /* RDR_TERM_STDOUT. */
       void* end_str = NULL;
@@ -1058,6 +1119,7 @@ generic_print_string
         tokenize(ptr, &tkn);
         CALL(wstring_append(line->string, tkn.str));
         CALL(sl_vector_push_back_n(line->color_list, tkn.len, color));
+        line->is_dirty = true;
         ptr = (void*)((uintptr_t)ptr + (tkn.len + 1) * sizeof_char);
         if(tkn.new_line)
           new_buf(&term->screen, RDR_TERM_STDOUT);
@@ -1107,6 +1169,160 @@ wrap_count
   return wrap_count;
 }
 
+/* Regenerate the glyph data of the line. The glyph vertices are expressed
+ * relatively to the bottom row of the line. */
+static void
+setup_line_glyphs
+  (struct rdr_term* term,
+   struct line* line,
+   const struct rdr_font_metrics* metrics)
+{
+  struct rdr_glyph glyph;
+  struct line_glyph* glyph_list = NULL;
+  const unsigned char (*col_lst)[3] = NULL;
+  const wchar_t* cstr = NULL;
+  size_t line_len = 0;
+  size_t nb_colors = 0;
+  size_t width = 0;
+  size_t row_y = 0;
+  size_t x = 0;
+  size_t id = 0;
+  assert(term && line && line->is_dirty && metrics);
+
+  SL(wstring_length(line->string, &line_len));
+  SL(wstring_get(line->string, &cstr));
+  SL(vector_buffer(line->color_list, &nb_colors, NULL, NULL, (void**)&col_lst));
+  assert(nb_colors == line_len);
+  SL(vector_resize(line->glyph_list, line_len, NULL));
+  SL(vector_buffer(line->glyph_list, NULL, NULL, NULL, (void**)&glyph_list));
+
+  /* TODO write a wrap func which tokenizes the string with respect to the wrap
+   * conditions. */
+  line->nb_wraps = wrap_count(cstr, line_len, term->width, term->font);
+  row_y = line->nb_wraps * metrics->line_space;
+  width = term->width;
+  x = 0;
+
+  #define SET_VERTEX(data, x, y, u, v, col) \
+    (data)[0] = (x), \
+    (data)[1] = (y), \
+    (data)[2] = 0.f, \
+    (data)[3] = (u), \
+    (data)[4] = (v), \
+    (data)[5] = (float)(col)[0] * (1.f / 255.f), \
+    (data)[6] = (float)(col)[1] * (1.f / 255.f), \
+    (data)[7] = (float)(col)[2] * (1.f / 255.f)
+
+  for(id = 0; id < line_len; ++id) {
+    struct line_glyph* line_glyph = glyph_list + id;
+    struct { float x; float y; } translated_pos[2];
+    const size_t nb_floats = SIZEOF_GLYPH_VERTEX / sizeof(float);
+    size_t adjusted_width = 0;
+
+    /* Handle special chars. */
+    if(cstr[id] == L'\t') {
+      RDR(get_font_glyph(term->font, L' ', &glyph));
+      adjusted_width = glyph.width * TAB_WIDTH;
+    } else if (cstr[id] == L'\n') {
+      memset(&glyph, 0, sizeof(glyph));
+      adjusted_width = SIZE_MAX;
+    } else {
+      RDR(get_font_glyph(term->font, cstr[id], &glyph));
+      adjusted_width = glyph.width;
+    }
+    /* Wrap the line. */
+    if(width >= adjusted_width) {
+      width -= adjusted_width;
+    } else {
+      width = term->width;
+      x = 0;
+      assert(row_y >= metrics->line_space);
+      row_y -= metrics->line_space;
+    }
+    line_glyph->row_y = row_y;
+    line_glyph->cursor_x = (size_t)((float)x + glyph.pos[0].x);
+    line_glyph->cursor_width =
+      (size_t)MAX((float)glyph.width, glyph.pos[1].x - glyph.pos[0].x);
+    line_glyph->has_quad = cstr[id] != L'\n';
+    if(!line_glyph->has_quad)
+      continue;
+
+    translated_pos[0].x = glyph.pos[0].x + (float)x;
+    translated_pos[0].y = glyph.pos[0].y + (float)row_y;
+    translated_pos[1].x = glyph.pos[1].x + (float)x;
+    translated_pos[1].y = glyph.pos[1].y + (float)row_y;
+
+    /* bottom left. */
+    SET_VERTEX(line_glyph->vertices + 0 * nb_floats,
+      translated_pos[0].x, translated_pos[1].y,
+      glyph.tex[0].x, glyph.tex[1].y, col_lst[id]);
+    /* top left. */
+    SET_VERTEX(line_glyph->vertices + 1 * nb_floats,
+      translated_pos[0].x, translated_pos[0].y,
+      glyph.tex[0].x, glyph.tex[0].y, col_lst[id]);
+    /* top right. */
+    SET_VERTEX(line_glyph->vertices + 2 * nb_floats,
+      translated_pos[1].x, translated_pos[0].y,
+      glyph.tex[1].x, glyph.tex[0].y, col_lst[id]);
+    /* bottom right. */
+    SET_VERTEX(line_glyph->vertices + 3 * nb_floats,
+      translated_pos[1].x, translated_pos[1].y,
+      glyph.tex[1].x, glyph.tex[1].y, col_lst[id]);
+
+    x += adjusted_width;
+  }
+  #undef SET_VERTEX
+
+  RDR(get_font_glyph(term->font, L' ', &glyph));
+  line->end_x = x;
+  line->end_width = glyph.width;
+  line->is_dirty = false;
+  ++line->version;
+}
+
+/* Write the visible glyphs of the line into the glyph vertices. Return the
+ * number of written glyphs. */
+static size_t
+write_line_glyphs
+  (struct rdr_term* term,
+   const struct line* line,
+   const struct rdr_font_metrics* metrics,
+   size_t y,
+   size_t first_glyph)
+{
+  const struct line_glyph* glyph_list = NULL;
+  const size_t nb_floats = VERTICES_PER_GLYPH*SIZEOF_GLYPH_VERTEX/sizeof(float);
+  const size_t max_nb_glyphs = term->printer.text.max_nb_glyphs;
+  float* dst = NULL;
+  size_t nb_glyphs = 0;
+  size_t len = 0;
+  size_t i = 0;
+  assert(term && line && !line->is_dirty && metrics);
+
+  SL(vector_buffer(line->glyph_list, &len, NULL, NULL, (void**)&glyph_list));
+  dst = (float*)blob_buffer(&term->glyph_vertices) + first_glyph * nb_floats;
+
+  for(i = 0; i < len; ++i) {
+    const struct line_glyph* glyph = glyph_list + i;
+    size_t j = 0;
+
+    /* Do not draw the rows that are cut by the terminal borders. */
+    if(!glyph->has_quad || y + glyph->row_y + metrics->line_space > term->height)
+      continue;
+    /* The glyphs rasterized on demand may be narrower than the font metrics
+     * used to size the printer storage. */
+    if(first_glyph + nb_glyphs >= max_nb_glyphs)
+      break;
+
+    memcpy(dst, glyph->vertices, sizeof(glyph->vertices));
+    for(j = 0; j < VERTICES_PER_GLYPH; ++j)
+      dst[j * SIZEOF_GLYPH_VERTEX / sizeof(float) + 1] += (float)y;
+    dst += nb_floats;
+    ++nb_glyphs;
+  }
+  return nb_glyphs;
+}
+
 static void
 setup_font(struct rdr_term* term)
 {
@@ -1135,6 +1351,11 @@ setup_font(struct rdr_term* term)
     + ((term->height % metrics.line_space) != 0);
   }
   max_nb_glyphs = chars_per_line * lines_per_screen;
+  blob_reserve
+    (&term->glyph_vertices,
+     max_nb_glyphs * VERTICES_PER_GLYPH * SIZEOF_GLYPH_VERTEX);
+  blob_clear(&term->draw_lists[0]);
+  blob_clear(&term->draw_lists[1]);
   printer_storage
     (term->sys,
      &term->printer,
@@ -1166,6 +1387,9 @@ release_term(struct ref* ref)
   if(term->font)
     RDR(font_ref_put(term->font));
   blob_release(&term->scratch);
+  blob_release(&term->glyph_vertices);
+  blob_release(&term->draw_lists[0]);
+  blob_release(&term->draw_lists[1]);
   shutdown_screen(term->sys, &term->screen);
   shutdown_printer(term->sys, &term->printer);
 
@@ -1203,6 +1427,9 @@ rdr_create_term
   RDR(system_ref_get(sys));
   term->sys = sys;
   blob_init(term->sys->allocator, &term->scratch);
+  blob_init(term->sys->allocator, &term->glyph_vertices);
+  blob_init(term->sys->allocator, &term->draw_lists[0]);
+  blob_init(term->sys->allocator, &term->draw_lists[1]);
   term->width = width;
   term->height = height;
 
@@ -1245,6 +1472,16 @@ rdr_term_ref_put(struct rdr_term* term)
   return RDR_NO_ERROR;
 }
 
+enum rdr_error
+rdr_term_position(struct rdr_term* term, size_t x, size_t y)
+{
+  if(!term || x >= INT_MAX || y >= INT_MAX)
+    return RDR_INVALID_ARGUMENT;
+  term->position[0] = x;
+  term->position[1] = y;
+  return RDR_NO_ERROR;
+}
+
 enum rdr_error
 rdr_term_font(struct rdr_term* term, struct rdr_font* font)
 {
@@ -1364,6 +1601,7 @@ rdr_term_print_wchar
       rdr_err = sl_to_rdr_error(sl_err);
       goto error;
     }
+    line->is_dirty = true;
     ++term->screen.cursor;
   } else {
     if(L'\n' == ch) {
@@ -1381,6 +1619,7 @@ rdr_term_print_wchar
         rdr_err = sl_to_rdr_error(sl_err);
         goto error;
       }
+      line->is_dirty = true;
     }
   }
 
@@ -1408,6 +1647,7 @@ rdr_clear_term(struct rdr_term* term, enum rdr_term_output output)
     if(cmdlen > len) {
       SL(wstring_erase(term->screen.cmdbuf->string, len, SIZE_MAX));
       SL(vector_erase_n(term->screen.cmdbuf->color_list, len, SIZE_MAX));
+      term->screen.cmdbuf->is_dirty = true;
       term->screen.cursor = len;
     } else {
       assert(term->screen.cursor == len);
@@ -1418,6 +1658,7 @@ rdr_clear_term(struct rdr_term* term, enum rdr_term_output output)
     SL(clear_vector(term->screen.prompt.color_list));
     SL(wstring_erase(term->screen.cmdbuf->string, 0, len));
     SL(vector_erase_n(term->screen.cmdbuf->color_list, 0, len));
+    term->screen.cmdbuf->is_dirty = true;
     term->screen.cursor -= len;
   } else {
     struct list_node* node = NULL;
@@ -1427,6 +1668,7 @@ rdr_clear_term(struct rdr_term* term, enum rdr_term_output output)
     }
     SL(clear_wstring(term->screen.outbuf->string));
     SL(clear_vector(term->screen.outbuf->color_list));
+    term->screen.outbuf->is_dirty = true;
     term->screen.scroll_id = 0;
   }
   return RDR_NO_ERROR;
@@ -1451,6 +1693,7 @@ rdr_term_write_backspace(struct rdr_term* term)
     --term->screen.cursor;
     SL(wstring_erase_wchar(line->string, term->screen.cursor));
     SL(vector_erase(line->color_list, term->screen.cursor));
+    line->is_dirty = true;
   }
 
 exit:
@@ -1497,6 +1740,15 @@ error:
   goto exit;
 }
 
+enum rdr_error
+rdr_get_term_stats(struct rdr_term* term, struct rdr_term_stats* stats)
+{
+  if(!term || !stats)
+    return RDR_INVALID_ARGUMENT;
+  *stats = term->stats;
+  return RDR_NO_ERROR;
+}
+
 enum rdr_error
 rdr_term_dump(struct rdr_term* term, size_t* out_len, wchar_t* buffer)
 {
@@ -1546,19 +1798,25 @@ enum rdr_error
 rdr_draw_term(struct rdr_term* term)
 {
   struct rdr_font_metrics metrics;
-  struct rdr_glyph glyph;
   struct {
     size_t width;
     size_t x;
     size_t y;
   } cursor = { 0, 0, 0 };
-  float vertex_data[SIZEOF_GLYPH_VERTEX / sizeof(float)];
+  struct blob* draw_list = NULL;
+  struct blob* prev_draw_list = NULL;
+  struct draw_line* draw_lines = NULL;
+  const struct draw_line* prev_draw_lines = NULL;
   struct list_node* node = NULL;
+  size_t nb_draw_lines = 0;
+  size_t nb_prev_draw_lines = 0;
   size_t nb_glyphs = 0;
-  size_t x = 0;
+  size_t nb_rebuilt_lines = 0;
+  size_t first_dirty_glyph = SIZE_MAX;
+  size_t end_dirty_glyph = 0;
   size_t y = 0;
+  size_t i = 0;
   enum rdr_error rdr_err = RDR_NO_ERROR;
-  memset(&vertex_data, 0, sizeof(vertex_data));
 
   if(!term) {
     rdr_err = RDR_INVALID_ARGUMENT;
@@ -1569,132 +1827,107 @@ rdr_draw_term(struct rdr_term* term)
   if(!metrics.line_space)
     goto exit;
 
-  blob_clear(&term->scratch);
-  nb_glyphs = 0;
+  prev_draw_list = term->draw_lists + term->draw_list_id;
+  term->draw_list_id = !term->draw_list_id;
+  draw_list = term->draw_lists + term->draw_list_id;
+  blob_clear(draw_list);
   y = metrics.line_space / 2;
 
   /* temporary add the cmdbuf to the stdout_line_list. */
   assert(term->screen.cmdbuf);
   list_add(&term->screen.stdout_line_list, &term->screen.cmdbuf->node);
 
+  /* Define the visible lines from the bottom to the top of the terminal and
+   * regenerate the glyphs of the dirty lines. */
   LIST_FOR_EACH(node, &term->screen.stdout_line_list) {
-    const unsigned char (*col_lst)[3] = NULL;
-    struct line* line = NULL;
-    const wchar_t* cstr = NULL;
-    size_t id = 0;
-    size_t line_len = 0;
-    size_t width = 0;
-    size_t wrap = 0;
-    size_t nb_colors = 0;
-
-    #define SET_VERTEX_POS(data, x, y, z) data[0]=(x), data[1]=(y), data[2]=(z)
-    #define SET_VERTEX_TEX(data, u, v)    data[3]=(u), data[4]=(v)
-    #define SET_VERTEX_COL(data, r, g, b) \
-      data[5]=(float)(r) * (1.f / 255.f), \
-      data[6]=(float)(g) * (1.f / 255.f), \
-      data[7]=(float)(b) * (1.f / 255.f)
+    struct draw_line draw_line;
+    struct line* line = CONTAINER_OF(node, struct line, node);
 
     /* Do not draw the line that are cut by the terminal borders. */
     if(y + metrics.line_space > term->height)
       break;
-
-    line = CONTAINER_OF(node, struct line, node);
-    SL(wstring_length(line->string, &line_len));
-    SL(wstring_get(line->string, &cstr));
-    SL(vector_buffer(line->color_list, &nb_colors, NULL, NULL, (void**)&col_lst));
-    assert(nb_colors == line_len);
-
-    /* TODO write a wrap func which tokenizes the string with respect to the wrap
-     * conditions. */
-    wrap = wrap_count(cstr, line_len, term->width, term->font);
-    width = term->width;
-    id = 0;
-    x = 0;
-    y += wrap * metrics.line_space;
-
-    /* Fill the scratch buffer with the glyphs of the line. */
-    for(id = 0; cstr[id] != L'\0'; ++id) {
-      struct { float x; float y; } translated_pos[2];
-      size_t adjusted_width = 0;
-      int cond = 0;
-
-     do {
-        assert(cstr[id] != L'\0');
-        /* Handle special chars. */
-        if(cstr[id] == L'\t') {
-          RDR(get_font_glyph(term->font, L' ', &glyph));
-          adjusted_width = glyph.width * TAB_WIDTH;
-        } else if (cstr[id] == L'\n') {
-          adjusted_width = SIZE_MAX;
-        } else {
-          RDR(get_font_glyph(term->font, cstr[id], &glyph));
-          adjusted_width = glyph.width;
-        }
-        /* Wrap the line. */
-        if(width >= adjusted_width) {
-          width -= adjusted_width;
-        } else {
-          width = term->width;
-          x = 0;
-          y -= metrics.line_space;
-        }
-        if(term->screen.cmdbuf == line && id == term->screen.cursor) {
-          cursor.width = MAX(glyph.width, glyph.pos[1].x - glyph.pos[0].x);
-          cursor.x = x + glyph.pos[0].x;
-          cursor.y = y;
-        }
-        cond = (y + metrics.line_space) > term->height;
-        id += cond;
-      } while(cond);
-
-      SET_VERTEX_COL(vertex_data, col_lst[id][0],col_lst[id][1],col_lst[id][2]);
-
-      translated_pos[0].x = glyph.pos[0].x + (float)x;
-      translated_pos[0].y = glyph.pos[0].y + (float)y;
-      translated_pos[1].x = glyph.pos[1].x + (float)x;
-      translated_pos[1].y = glyph.pos[1].y + (float)y;
-
-      /* bottom left. */
-      SET_VERTEX_POS(vertex_data, translated_pos[0].x, translated_pos[1].y,0.f);
-      SET_VERTEX_TEX(vertex_data, glyph.tex[0].x, glyph.tex[1].y);
-      blob_push_back(&term->scratch, vertex_data, sizeof(vertex_data));
-      /* top left. */
-      SET_VERTEX_POS(vertex_data, translated_pos[0].x, translated_pos[0].y,0.f);
-      SET_VERTEX_TEX(vertex_data, glyph.tex[0].x, glyph.tex[0].y);
-      blob_push_back(&term->scratch, vertex_data, sizeof(vertex_data));
-      /* top right. */
-      SET_VERTEX_POS(vertex_data, translated_pos[1].x, translated_pos[0].y,0.f);
-      SET_VERTEX_TEX(vertex_data, glyph.tex[1].x, glyph.tex[0].y);
-      blob_push_back(&term->scratch, vertex_data, sizeof(vertex_data));
-      /* bottom right. */
-      SET_VERTEX_POS(vertex_data, translated_pos[1].x, translated_pos[1].y,0.f);
-      SET_VERTEX_TEX(vertex_data, glyph.tex[1].x, glyph.tex[1].y);
-      blob_push_back(&term->scratch, vertex_data, sizeof(vertex_data));
-
-      ++nb_glyphs;
-      x += adjusted_width;
+    if(line->is_dirty) {
+      setup_line_glyphs(term, line, &metrics);
+      ++nb_rebuilt_lines;
     }
-    if(term->screen.cmdbuf == line && id == term->screen.cursor) {
-      RDR(get_font_glyph(term->font, L' ', &glyph));
-      cursor.width = glyph.width;
-      cursor.x = x;
-      cursor.y = y;
+
+    if(line == term->screen.cmdbuf) {
+      size_t len = 0;
+      SL(vector_length(line->glyph_list, &len));
+      if(term->screen.cursor < len) {
+        const struct line_glyph* glyph = NULL;
+        SL(vector_at(line->glyph_list, term->screen.cursor, (void**)&glyph));
+        cursor.width = glyph->cursor_width;
+        cursor.x = glyph->cursor_x;
+        cursor.y = y + glyph->row_y;
+      } else {
+        cursor.width = line->end_width;
+        cursor.x = line->end_x;
+        cursor.y = y;
+      }
     }
-    y += (wrap + 1) * metrics.line_space;
+    memset(&draw_line, 0, sizeof(draw_line));
+    draw_line.line = line;
+    draw_line.version = line->version;
+    draw_line.y = y;
+    blob_push_back(draw_list, &draw_line, sizeof(draw_line));
 
-    #undef SET_VERTEX_POS
-    #undef SET_VERTEX_TEX
-    #undef SET_VERTEX_COL
+    y += (line->nb_wraps + 1) * metrics.line_space;
   }
   /* Remove the cmdbuf from the stdout. */
   list_del(&term->screen.cmdbuf->node);
 
-  /* Send the glyph data to the printer and draw. */
+  /* Write the glyphs of the lines from the top to the bottom of the terminal.
+   * The glyphs of the line drawn at the same place in the previous frame are
+   * already up to date. */
+  draw_lines = blob_buffer(draw_list);
+  nb_draw_lines = blob_id(draw_list) / sizeof(struct draw_line);
+  prev_draw_lines = blob_buffer(prev_draw_list);
+  nb_prev_draw_lines = blob_id(prev_draw_list) / sizeof(struct draw_line);
+  for(i = 0; i < nb_draw_lines; ++i) {
+    struct draw_line* draw_line = draw_lines + (nb_draw_lines - 1 - i);
+    const struct draw_line* prev_draw_line = i < nb_prev_draw_lines
+      ? prev_draw_lines + (nb_prev_draw_lines - 1 - i) : NULL;
+
+    draw_line->first_glyph = nb_glyphs;
+    if(prev_draw_line
+    && prev_draw_line->line == draw_line->line
+    && prev_draw_line->version == draw_line->version
+    && prev_draw_line->y == draw_line->y
+    && prev_draw_line->first_glyph == draw_line->first_glyph) {
+      draw_line->nb_glyphs = prev_draw_line->nb_glyphs;
+    } else {
+      draw_line->nb_glyphs = write_line_glyphs
+        (term, draw_line->line, &metrics, draw_line->y, nb_glyphs);
+      if(draw_line->nb_glyphs) {
+        first_dirty_glyph = MIN(first_dirty_glyph, nb_glyphs);
+        end_dirty_glyph = nb_glyphs + draw_line->nb_glyphs;
+      }
+    }
+    nb_glyphs += draw_line->nb_glyphs;
+  }
+
+  /* Send the updated glyph data to the printer and draw. */
+  if(first_dirty_glyph > end_dirty_glyph)
+    first_dirty_glyph = end_dirty_glyph = 0;
   printer_data
-    (term->sys, &term->printer, nb_glyphs, blob_buffer(&term->scratch));
+    (term->sys,
+     &term->printer,
+     nb_glyphs,
+     first_dirty_glyph,
+     end_dirty_glyph - first_dirty_glyph,
+     blob_buffer(&term->glyph_vertices));
   printer_draw
-    (term->sys, term->font, &term->printer, term->width, term->height,
-     cursor.x, cursor.y, cursor.width);
+    (term->sys, term->font, &term->printer, term->position,
+     term->width, term->height, cursor.x, cursor.y, cursor.width);
+
+  term->stats.nb_glyphs = nb_glyphs;
+  term->stats.nb_rebuilt_lines = nb_rebuilt_lines;
+  term->stats.first_uploaded_glyph = first_dirty_glyph;
+  term->stats.nb_uploaded_glyphs = end_dirty_glyph - first_dirty_glyph;
+  term->stats.cursor_pos[0] = cursor.x;
+  term->stats.cursor_pos[1] = cursor.y;
+  term->stats.cursor_width = cursor.width;
 
  exit:
   return rdr_err;
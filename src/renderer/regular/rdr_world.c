@@ -1,6 +1,7 @@
 #include "maths/simd/aosf44.h"
 #include "renderer/regular/rdr_error_c.h"
 #include "renderer/regular/rdr_model_instance_c.h"
+#include "renderer/regular/rdr_occlusion.h"
 #include "renderer/regular/rdr_system_c.h"
 #include "renderer/regular/rdr_world_c.h"
 #include "renderer/rdr.h"
@@ -9,6 +10,8 @@
 #include "renderer/rdr_world.h"
 #include "stdlib/sl.h"
 #include "stdlib/sl_flat_set.h"
+#include "stdlib/sl_vector.h"
+#include "sys/profiler.h"
 #include "sys/ref_count.h"
 #include "sys/sys.h"
 #include <assert.h>
@@ -21,6 +24,11 @@ struct rdr_world {
   struct ref ref;
   struct rdr_system* sys;
   struct sl_flat_set* model_instance_list;
+  /* Occlusion culling data. The occlusion buffer is created at the first
+   * culled draw. */
+  struct rdr_occlusion* occlusion;
+  struct sl_vector* visible_list;
+  bool is_occlusion_culling_enabled;
 };
 
 /*******************************************************************************
@@ -62,11 +70,53 @@ release_world(struct ref* ref)
 
     SL(free_flat_set(world->model_instance_list));
   }
+  if(world->visible_list)
+    SL(free_vector(world->visible_list));
+  if(world->occlusion)
+    RDR(free_occlusion(world->sys, world->occlusion));
   sys = world->sys;
   MEM_FREE(world->sys->allocator, world);
   RDR(system_ref_put(sys));
 }
 
+static enum rdr_error
+cull_instances
+  (struct rdr_world* world,
+   const struct aosf44* view_matrix,
+   const struct aosf44* proj_matrix,
+   size_t* nb_instances,
+   struct rdr_model_instance*** instance_list)
+{
+  struct rdr_model_instance** visible_list = NULL;
+  enum rdr_error rdr_err = RDR_NO_ERROR;
+  enum sl_error sl_err = SL_NO_ERROR;
+  assert(world && view_matrix && proj_matrix && nb_instances && instance_list);
+
+  if(!world->occlusion) {
+    rdr_err = rdr_create_occlusion(world->sys, &world->occlusion);
+    if(rdr_err != RDR_NO_ERROR)
+      return rdr_err;
+  }
+  sl_err = sl_vector_resize(world->visible_list, *nb_instances, NULL);
+  if(sl_err != SL_NO_ERROR)
+    return sl_to_rdr_error(sl_err);
+  SL(vector_buffer
+    (world->visible_list, NULL, NULL, NULL, (void**)&visible_list));
+  rdr_err = rdr_cull_instances
+    (world->sys,
+     world->occlusion,
+     view_matrix,
+     proj_matrix,
+     *nb_instances,
+     *instance_list,
+     nb_instances,
+     visible_list);
+  if(rdr_err != RDR_NO_ERROR)
+    return rdr_err;
+  *instance_list = visible_list;
+  return RDR_NO_ERROR;
+}
+
 /*******************************************************************************
  *
  * Implementation of the render world functions.
@@ -103,6 +153,15 @@ rdr_create_world(struct rdr_system* sys, struct rdr_world** out_world)
     rdr_err = sl_to_rdr_error(sl_err);
     goto error;
   }
+  sl_err = sl_create_vector
+    (sizeof(struct rdr_model_instance*),
+     ALIGNOF(struct rdr_model_instance*),
+     world->sys->allocator,
+     &world->visible_list);
+  if(sl_err != SL_NO_ERROR) {
+    rdr_err = sl_to_rdr_error(sl_err);
+    goto error;
+  }
 
 exit:
   if(out_world)
@@ -173,6 +232,42 @@ error:
   goto exit;
 }
 
+enum rdr_error
+rdr_add_model_instances
+  (struct rdr_world* world,
+   size_t nb_instances,
+   struct rdr_model_instance* instance_list[])
+{
+  size_t i = 0;
+  enum rdr_error rdr_err = RDR_NO_ERROR;
+  enum sl_error sl_err = SL_NO_ERROR;
+
+  if(!world || (nb_instances && !instance_list)) {
+    rdr_err = RDR_INVALID_ARGUMENT;
+    goto error;
+  }
+  for(i = 0; i < nb_instances; ++i) {
+    if(!instance_list[i]) {
+      rdr_err = RDR_INVALID_ARGUMENT;
+      goto error;
+    }
+  }
+  /* The instances are sorted once rather than inserted one by one. */
+  sl_err = sl_flat_set_insert_n
+    (world->model_instance_list, nb_instances, instance_list);
+  if(sl_err != SL_NO_ERROR) {
+    rdr_err = sl_to_rdr_error(sl_err);
+    goto error;
+  }
+  for(i = 0; i < nb_instances; ++i)
+    RDR(model_instance_ref_get(instance_list[i]));
+
+exit:
+  return rdr_err;
+error:
+  goto exit;
+}
+
 enum rdr_error
 rdr_remove_model_instance
   (struct rdr_world* world,
@@ -211,6 +306,15 @@ error:
   goto exit;
 }
 
+enum rdr_error
+rdr_world_occlusion_culling(struct rdr_world* world, bool is_enabled)
+{
+  if(UNLIKELY(!world))
+    return RDR_INVALID_ARGUMENT;
+  world->is_occlusion_culling_enabled = is_enabled;
+  return RDR_NO_ERROR;
+}
+
 /*******************************************************************************
  *
  * Private functions.
@@ -237,8 +341,10 @@ rdr_draw_world
   enum rdr_error rdr_err = RDR_NO_ERROR;
   enum sl_error sl_err = SL_NO_ERROR;
   size_t nb_instances = 0;
+  float lod_scale = 0.f;
   memset(&viewport_desc, 0, sizeof(struct rb_viewport_desc));
 
+  PROF_BEGIN("rdr_draw_world");
   if(UNLIKELY(!world || !view)) {
     rdr_err = RDR_INVALID_ARGUMENT;
     goto error;
@@ -267,10 +373,24 @@ rdr_draw_world
   if(instance_list != NULL) {
     aosf44_load(&view_matrix, view->transform);
     RDR(compute_projection_matrix(view, &proj_matrix));
+    if(world->is_occlusion_culling_enabled && !draw_desc) {
+      rdr_err = cull_instances
+        (world, &view_matrix, &proj_matrix, &nb_instances, &instance_list);
+      if(rdr_err != RDR_NO_ERROR)
+        goto error;
+    }
+    /* Half of the viewport height over the tangent of the half fov_y, i.e.
+     * the pixel size at unit depth, divided by the tolerated error. */
+    if(world->sys->lod_threshold > 0.f) {
+      lod_scale =
+          0.5f * (float)view->height * vf4_y(proj_matrix.c1)
+        / world->sys->lod_threshold;
+    }
     rdr_err = rdr_draw_instances
       (world->sys, 
        &view_matrix, 
        &proj_matrix, 
+       lod_scale,
        nb_instances, 
        instance_list, 
        draw_desc);
@@ -279,6 +399,7 @@ rdr_draw_world
   }
 
 exit:
+  PROF_END();
   return rdr_err;
 error:
   goto exit;
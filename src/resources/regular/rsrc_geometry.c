@@ -9,15 +9,28 @@
 #include "sys/mem_allocator.h"
 #include "sys/ref_count.h"
 #include "sys/sys.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <assert.h>
+#include <fcntl.h>
 #include <limits.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 struct primitive_set {
-  struct sl_vector* data_list; /* vector of float. */
-  struct sl_vector* index_list; /* vector of unsigned int. */
+  struct sl_vector* data_list; /* vector of float. NULL if mapped. */
+  struct sl_vector* index_list; /* vector of unsigned int. NULL if mapped. */
   struct sl_vector* attrib_list; /* vector of struct rsrc_attrib. */
+  /* Data of the primitive set when it is mapped from a geometry file. */
+  const void* mapped_data;
+  const unsigned int* mapped_index_list;
+  size_t sizeof_mapped_data;
+  size_t nb_mapped_indices;
   enum rsrc_primitive_type primitive_type;
 };
 
@@ -26,8 +39,200 @@ struct rsrc_geometry {
   struct rsrc_context* ctxt;
   struct sl_vector* primitive_set_list; /* vector of vector of primitive_set. */
   struct sl_hash_table* hash_table; /* Internal hash table. */
+  void* mapping; /* Mapped geometry file. May be NULL. */
+  size_t sizeof_mapping;
 };
 
+/*******************************************************************************
+ *
+ * Binary geometry file.
+ *
+ * The file is a header followed by the table of the primitive set descriptors
+ * and by the interleaved vertex data and the index data of each primitive set.
+ * Each section is aligned on GEOMETRY_FILE_ALIGNMENT bytes from the beginning
+ * of the file so that the data can be used in place once the file is mapped.
+ * The values are stored in the native byte order.
+ *
+ ******************************************************************************/
+#define GEOMETRY_FILE_MAGIC "FOOGEOM"
+#define GEOMETRY_FILE_VERSION 1
+#define GEOMETRY_FILE_ALIGNMENT 64
+#define GEOMETRY_FILE_MAX_ATTRIBS 4
+
+struct geometry_file_header {
+  char magic[8];
+  uint32_t version;
+  uint32_t nb_primitive_sets;
+  uint64_t sizeof_file;
+  uint64_t checksum; /* Of the bytes following the header. */
+  /* Key of the source resource. Null if the file has no source. */
+  uint64_t source_path_hash;
+  uint64_t source_size;
+  int64_t source_mtime_sec;
+  int64_t source_mtime_nsec;
+};
+
+struct geometry_file_primitive_set {
+  uint64_t data_offset;
+  uint64_t sizeof_data;
+  uint64_t index_offset;
+  uint64_t nb_indices;
+  uint32_t primitive_type;
+  uint32_t nb_attribs;
+  uint32_t attrib_list[GEOMETRY_FILE_MAX_ATTRIBS][2]; /* type, usage. */
+  float min_bound[3];
+  float max_bound[3];
+  char padding[32];
+};
+
+STATIC_ASSERT
+  (sizeof(struct geometry_file_header) % GEOMETRY_FILE_ALIGNMENT == 0,
+   Unexpected_sizeof_geometry_file_header);
+STATIC_ASSERT
+  (sizeof(struct geometry_file_primitive_set) % GEOMETRY_FILE_ALIGNMENT == 0,
+   Unexpected_sizeof_geometry_file_primitive_set);
+
+#define FNV64_OFFSET_BASIS 14695981039346656037ULL
+#define FNV64_PRIME 1099511628211ULL
+
+/* FNV-1a applied on 64 bits words. The sizes of the file sections are
+ * multiples of 8 bytes since they are aligned on GEOMETRY_FILE_ALIGNMENT. */
+static uint64_t
+checksum_update(uint64_t sum, const void* data, size_t size)
+{
+  const char* bytes = data;
+  size_t i = 0;
+  assert(size % sizeof(uint64_t) == 0);
+
+  for(i = 0; i < size; i += sizeof(uint64_t)) {
+    uint64_t word = 0;
+    memcpy(&word, bytes + i, sizeof(uint64_t));
+    sum ^= word;
+    sum *= FNV64_PRIME;
+  }
+  return sum;
+}
+
+/* Write the data padded with zeros up to GEOMETRY_FILE_ALIGNMENT bytes and
+ * update the checksum of the written bytes. */
+static enum rsrc_error
+write_section(FILE* fptr, const void* data, size_t size, uint64_t* sum)
+{
+  char tail[GEOMETRY_FILE_ALIGNMENT];
+  const size_t sizeof_body = size - size % GEOMETRY_FILE_ALIGNMENT;
+  const size_t sizeof_tail =
+    ALIGN_SIZE(size, GEOMETRY_FILE_ALIGNMENT) - sizeof_body;
+  assert(fptr && (!size || data) && sum);
+
+  if(sizeof_body) {
+    if(fwrite(data, 1, sizeof_body, fptr) != sizeof_body)
+      return RSRC_IO_ERROR;
+    *sum = checksum_update(*sum, data, sizeof_body);
+  }
+  if(sizeof_tail) {
+    memset(tail, 0, sizeof(tail));
+    memcpy(tail, (const char*)data + sizeof_body, size - sizeof_body);
+    if(fwrite(tail, 1, sizeof_tail, fptr) != sizeof_tail)
+      return RSRC_IO_ERROR;
+    *sum = checksum_update(*sum, tail, sizeof_tail);
+  }
+  return RSRC_NO_ERROR;
+}
+
+static uint64_t
+hash_path(const char* path)
+{
+  uint64_t hash = FNV64_OFFSET_BASIS;
+  assert(path);
+  for(; *path != '\0'; ++path) {
+    hash ^= (uint64_t)(unsigned char)*path;
+    hash *= FNV64_PRIME;
+  }
+  return hash;
+}
+
+static size_t
+sizeof_rsrc_type(enum rsrc_type type)
+{
+  switch(type) {
+    case RSRC_FLOAT: return sizeof(float);
+    case RSRC_FLOAT2: return sizeof(float[2]);
+    case RSRC_FLOAT3: return sizeof(float[3]);
+    case RSRC_FLOAT4: return sizeof(float[4]);
+    case RSRC_HALF2: return sizeof(uint16_t[2]);
+    case RSRC_SNORM16x2: return sizeof(int16_t[2]);
+    default: return 0;
+  }
+}
+
+/* Setup the source key of the header from the file stats of src_path. */
+static enum rsrc_error
+stat_source
+  (struct rsrc_context* ctxt,
+   const char* src_path,
+   struct geometry_file_header* header)
+{
+  struct stat src_stat;
+  assert(ctxt && header);
+
+  if(!src_path) {
+    header->source_path_hash = 0;
+    header->source_size = 0;
+    header->source_mtime_sec = 0;
+    header->source_mtime_nsec = 0;
+  } else {
+    if(stat(src_path, &src_stat) != 0) {
+      RSRC(print_error(ctxt, "error accessing file `%s'\n", src_path));
+      return RSRC_IO_ERROR;
+    }
+    header->source_path_hash = hash_path(src_path);
+    header->source_size = (uint64_t)src_stat.st_size;
+    header->source_mtime_sec = (int64_t)src_stat.st_mtim.tv_sec;
+    header->source_mtime_nsec = (int64_t)src_stat.st_mtim.tv_nsec;
+  }
+  return RSRC_NO_ERROR;
+}
+
+/* Compute the bounds of the positions of the interleaved vertex data. */
+static void
+primitive_set_bounds
+  (const struct rsrc_primitive_set* prim_set,
+   float min_bound[3],
+   float max_bound[3])
+{
+  size_t stride = 0;
+  size_t offset = 0;
+  size_t nb_pos_comps = 0;
+  size_t i = 0;
+  assert(prim_set && min_bound && max_bound);
+
+  min_bound[0] = min_bound[1] = min_bound[2] = 0.f;
+  max_bound[0] = max_bound[1] = max_bound[2] = 0.f;
+  for(i = 0; i < prim_set->nb_attribs; ++i) {
+    if(prim_set->attrib_list[i].usage == RSRC_ATTRIB_POSITION
+    && prim_set->attrib_list[i].type <= RSRC_FLOAT4) {
+      offset = stride;
+      nb_pos_comps = sizeof_rsrc_type(prim_set->attrib_list[i].type);
+      nb_pos_comps = nb_pos_comps > 12 ? 3 : nb_pos_comps / sizeof(float);
+    }
+    stride += sizeof_rsrc_type(prim_set->attrib_list[i].type);
+  }
+  if(!nb_pos_comps || stride > prim_set->sizeof_data)
+    return;
+
+  for(i = 0; i < prim_set->sizeof_data / stride; ++i) {
+    const float* pos = (const float*)
+      ((const char*)prim_set->data + i * stride + offset);
+    size_t j = 0;
+    for(j = 0; j < nb_pos_comps; ++j) {
+      if(i == 0 || pos[j] < min_bound[j])
+        min_bound[j] = pos[j];
+      if(i == 0 || pos[j] > max_bound[j])
+        max_bound[j] = pos[j];
+    }
+  }
+}
+
 /*******************************************************************************
  *
  * Vertex pair data type.
@@ -58,54 +263,213 @@ compare(const void* p0, const void* p1)
  * Helper functions.
  *
  ******************************************************************************/
+/* Maximum number of vertices of a polygon that can be triangulated. It bounds
+ * the size of the scratch buffers of the triangulation that are allocated on
+ * the stack. */
+#define MAX_POLYGON_VERTS 256
+
+/* Twice the signed area of the 2D triangle (a, b, c). */
+static FINLINE float
+orient2d(const float a[2], const float b[2], const float c[2])
+{
+  return (b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]);
+}
+
+/* Define whether p lies into the counter clockwise 2D triangle (a, b, c),
+ * boundaries included. */
+static FINLINE bool
+is_point_in_triangle
+  (const float p[2],
+   const float a[2],
+   const float b[2],
+   const float c[2])
+{
+  return orient2d(a, b, p) >= 0.f
+      && orient2d(b, c, p) >= 0.f
+      && orient2d(c, a, p) >= 0.f;
+}
+
+/* Project the positions of the polygon onto the axis aligned plane that is the
+ * most orthogonal to its Newell normal. The 2D axes are chosen in order to
+ * make the projected polygon counter clockwise. Return false if the polygon
+ * normal is degenerated or if a vertex does not reference a position. */
+static bool
+project_polygon
+  (const float (*pos)[3],
+   const struct rsrc_wavefront_obj_face* vert_list,
+   size_t nb_verts,
+   float (*out_proj)[2])
+{
+  float nor[3] = { 0.f, 0.f, 0.f };
+  float abs_nor[3] = { 0.f, 0.f, 0.f };
+  size_t axis[2] = { 0, 0 };
+  size_t i = 0;
+  int dominant_axis = 0;
+  assert(pos && vert_list && nb_verts >= 3 && out_proj);
+
+  for(i = 0; i < nb_verts; ++i) {
+    if(vert_list[i].v == 0)
+      return false;
+  }
+  for(i = 0; i < nb_verts; ++i) {
+    /* NOTE: the obj indexing starts at 1. */
+    const float* a = pos[vert_list[i].v - 1];
+    const float* b = pos[vert_list[(i + 1) % nb_verts].v - 1];
+    nor[0] += (a[1] - b[1]) * (a[2] + b[2]);
+    nor[1] += (a[2] - b[2]) * (a[0] + b[0]);
+    nor[2] += (a[0] - b[0]) * (a[1] + b[1]);
+  }
+  abs_nor[0] = fabsf(nor[0]);
+  abs_nor[1] = fabsf(nor[1]);
+  abs_nor[2] = fabsf(nor[2]);
+  if(abs_nor[0] > abs_nor[1])
+    dominant_axis = abs_nor[0] > abs_nor[2] ? 0 : 2;
+  else
+    dominant_axis = abs_nor[1] > abs_nor[2] ? 1 : 2;
+  if(abs_nor[dominant_axis] == 0.f)
+    return false;
+
+  /* (axis[0], axis[1], dominant_axis) is a direct frame. Swap the 2D axes if
+   * the polygon normal points toward the negative dominant axis. */
+  axis[0] = (dominant_axis + 1) % 3;
+  axis[1] = (dominant_axis + 2) % 3;
+  if(nor[dominant_axis] < 0.f) {
+    const size_t tmp = axis[0];
+    axis[0] = axis[1];
+    axis[1] = tmp;
+  }
+  for(i = 0; i < nb_verts; ++i) {
+    const float* p = pos[vert_list[i].v - 1];
+    out_proj[i][0] = p[axis[0]];
+    out_proj[i][1] = p[axis[1]];
+  }
+  return true;
+}
+
 /* Triangulate the face defined by nb_verts stored into vert_list. The
  * triangulation is performed without adding any new vertex by reindexing
- * the vert_list into out_vert_id_list. */
+ * the vert_list into out_vert_id_list. Convex polygons are triangulated as a
+ * fan while concave ones are ear clipped in the plane of projection of the
+ * polygon. The triangulation does not allocate any memory and always outputs
+ * nb_verts - 2 triangles that keep the winding of the polygon. */
 static enum rsrc_error
 triangulate
   (struct rsrc_context* ctxt,
-   struct rsrc_wavefront_obj_face* vert_list UNUSED,
+   const float (*pos)[3],
+   const struct rsrc_wavefront_obj_face* vert_list,
    size_t nb_verts,
-   size_t max_nb_verts,
+   size_t max_nb_vert_ids,
    size_t* out_nb_vert_ids,
    size_t* out_vert_id_list)
 {
+  float proj[MAX_POLYGON_VERTS][2];
+  size_t poly[MAX_POLYGON_VERTS];
+  size_t nb_poly_verts = 0;
+  size_t nb_ids = 0;
+  size_t i = 0;
   enum rsrc_error rsrc_err = RSRC_NO_ERROR;
+  bool is_convex = true;
   assert
-    (  (!nb_verts || vert_list)
-    && max_nb_verts >= 3
+    (  pos
+    && (!nb_verts || vert_list)
     && out_nb_vert_ids
     && out_vert_id_list);
 
-  /* Right now only triangles (sic!) and quads are supported.
-   * TODO implement a generic triangulation algorithm. */
-  if(nb_verts != 3 && nb_verts != 4) {
+  if(nb_verts < 3) {
+    RSRC(print_error
+      (ctxt, "unexpected polygon with %zu vertices\n", nb_verts));
+    rsrc_err = RSRC_PARSING_ERROR;
+    goto error;
+  }
+  if(nb_verts > MAX_POLYGON_VERTS) {
     RSRC(print_error
       (ctxt,
        "unexpected polygon with %zu vertices: "
-       "only triangles or quads are supported\n",
-       nb_verts));
-    rsrc_err = RSRC_PARSING_ERROR;
+       "at most %d vertices are supported\n",
+       nb_verts, MAX_POLYGON_VERTS));
+    rsrc_err = RSRC_MEMORY_ERROR;
+    goto error;
+  }
+  if(max_nb_vert_ids < (nb_verts - 2) * 3) {
+    rsrc_err = RSRC_MEMORY_ERROR;
     goto error;
   }
-  if(nb_verts == 3) {
-    *out_nb_vert_ids = 3;
-    out_vert_id_list[0] = 0;
-    out_vert_id_list[1] = 1;
-    out_vert_id_list[2] = 2;
+
+  #define EMIT_TRIANGLE(a, b, c) \
+    do { \
+      out_vert_id_list[nb_ids + 0] = (a); \
+      out_vert_id_list[nb_ids + 1] = (b); \
+      out_vert_id_list[nb_ids + 2] = (c); \
+      nb_ids += 3; \
+    } while(0)
+
+  /* A degenerated polygon cannot be projected; it is thus triangulated as a
+   * fan as convex polygons. */
+  if(nb_verts > 3 && project_polygon(pos, vert_list, nb_verts, proj)) {
+    for(i = 0; is_convex && i < nb_verts; ++i) {
+      is_convex = orient2d
+        (proj[i],
+         proj[(i + 1) % nb_verts],
+         proj[(i + 2) % nb_verts]) >= 0.f;
+    }
+  }
+
+  if(is_convex) {
+    for(i = 1; i + 1 < nb_verts; ++i)
+      EMIT_TRIANGLE(0, i, i + 1);
   } else {
-    if(max_nb_verts < 6) {
-      rsrc_err = RSRC_MEMORY_ERROR;
-      goto error;
+    size_t nb_failures = 0;
+
+    for(i = 0; i < nb_verts; ++i)
+      poly[i] = i;
+    nb_poly_verts = nb_verts;
+
+    i = 0;
+    while(nb_poly_verts > 3) {
+      const size_t prev = poly[(i + nb_poly_verts - 1) % nb_poly_verts];
+      const size_t curr = poly[i];
+      const size_t next = poly[(i + 1) % nb_poly_verts];
+      bool is_ear = orient2d(proj[prev], proj[curr], proj[next]) > 0.f;
+
+      /* An ear cannot contain any other vertex of the remaining polygon.
+       * Vertices that coincide with the ear vertices are ignored to handle
+       * polygons whose boundary touches itself. Once every vertex was tested
+       * without finding an ear, i.e. the polygon is self intersecting or
+       * numerically degenerated, the current vertex is clipped anyway. */
+      if(is_ear && nb_failures < nb_poly_verts) {
+        size_t j = 0;
+        for(j = 0; is_ear && j < nb_poly_verts; ++j) {
+          const float* p = proj[poly[j]];
+          if(poly[j] == prev || poly[j] == curr || poly[j] == next)
+            continue;
+          if((p[0] == proj[prev][0] && p[1] == proj[prev][1])
+          || (p[0] == proj[curr][0] && p[1] == proj[curr][1])
+          || (p[0] == proj[next][0] && p[1] == proj[next][1]))
+            continue;
+          is_ear = !is_point_in_triangle
+            (p, proj[prev], proj[curr], proj[next]);
+        }
+      }
+      if(is_ear || nb_failures >= nb_poly_verts) {
+        EMIT_TRIANGLE(prev, curr, next);
+        memmove
+          (poly + i,
+           poly + i + 1,
+           (nb_poly_verts - i - 1) * sizeof(size_t));
+        --nb_poly_verts;
+        i = i % nb_poly_verts;
+        nb_failures = 0;
+      } else {
+        i = (i + 1) % nb_poly_verts;
+        ++nb_failures;
+      }
     }
-    *out_nb_vert_ids = 6;
-    out_vert_id_list[0] = 0;
-    out_vert_id_list[1] = 1;
-    out_vert_id_list[2] = 2;
-    out_vert_id_list[3] = 0;
-    out_vert_id_list[4] = 2;
-    out_vert_id_list[5] = 3;
+    EMIT_TRIANGLE(poly[0], poly[1], poly[2]);
   }
+  #undef EMIT_TRIANGLE
+  assert(nb_ids == (nb_verts - 2) * 3);
+  *out_nb_vert_ids = nb_ids;
+
 exit:
   return rsrc_err;
 error:
@@ -125,7 +489,7 @@ build_triangle_list
    struct sl_vector** out_indices,
    struct sl_vector** out_attribs)
 {
-  #define MAX_TRIANGULATE_FACE_IDS 6
+  #define MAX_TRIANGULATE_FACE_IDS ((MAX_POLYGON_VERTS - 2) * 3)
   size_t triangulate_face_ids[MAX_TRIANGULATE_FACE_IDS];
   struct sl_vector* data = NULL;
   struct sl_vector* indices = NULL;
@@ -193,6 +557,7 @@ build_triangle_list
 
     err = triangulate
       (ctxt,
+       pos,
        face_verts,
        nb_verts,
        MAX_TRIANGULATE_FACE_IDS,
@@ -266,7 +631,1028 @@ error:
     SL(free_vector(attribs));
     attribs = NULL;
   }
-  goto exit;
+  goto exit;
+}
+
+/*******************************************************************************
+ *
+ * Mesh optimization.
+ *
+ ******************************************************************************/
+/* Size of the FIFO post transform vertex cache targeted by the triangle
+ * reordering. */
+#define VERTEX_CACHE_SIZE 16
+
+static FINLINE int16_t
+float_to_snorm16(float f)
+{
+  f = f < -1.f ? -1.f : f > 1.f ? 1.f : f;
+  return (int16_t)(f * 32767.f + (f < 0.f ? -0.5f : 0.5f));
+}
+
+/* Round to nearest conversion of a single precision float to half. */
+static uint16_t
+float_to_half(float f)
+{
+  uint32_t bits = 0;
+  uint32_t abs = 0;
+  uint16_t sign = 0;
+
+  memcpy(&bits, &f, sizeof(bits));
+  sign = (uint16_t)((bits >> 16) & 0x8000);
+  abs = bits & 0x7FFFFFFF;
+
+  if(abs >= 0x7F800000) { /* Inf or NaN. */
+    return sign | 0x7C00 | (abs > 0x7F800000 ? 0x0200 : 0);
+  } else if(abs >= 0x477FF000) { /* Rounded to Inf. */
+    return sign | 0x7C00;
+  } else if(abs < 0x38800000) { /* Denormalized half. */
+    const uint32_t mantissa = (abs & 0x007FFFFF) | 0x00800000;
+    const uint32_t shift = 126 - (abs >> 23);
+    if(abs < 0x33000000)
+      return sign;
+    return sign | (uint16_t)
+      ((mantissa + (1u << (shift - 1)) - 1 + ((mantissa >> shift) & 1))
+       >> shift);
+  } else {
+    abs += 0x0FFF + ((abs >> 13) & 1);
+    return sign | (uint16_t)((abs - 0x38000000) >> 13);
+  }
+}
+
+/* Map the unit normal onto the octahedron and unfold it in [-1, 1]^2. */
+static void
+encode_octahedral_normal(const float nor[3], int16_t out[2])
+{
+  const float l1 = fabsf(nor[0]) + fabsf(nor[1]) + fabsf(nor[2]);
+  float x = 0.f;
+  float y = 0.f;
+
+  if(l1 > 0.f) {
+    x = nor[0] / l1;
+    y = nor[1] / l1;
+    if(nor[2] < 0.f) {
+      const float tmp = x;
+      x = (1.f - fabsf(y)) * (tmp >= 0.f ? 1.f : -1.f);
+      y = (1.f - fabsf(tmp)) * (y >= 0.f ? 1.f : -1.f);
+    }
+  }
+  out[0] = float_to_snorm16(x);
+  out[1] = float_to_snorm16(y);
+}
+
+static size_t
+sizeof_vertex(const struct rsrc_attrib* attrib_list, size_t nb_attribs)
+{
+  size_t size = 0;
+  size_t i = 0;
+  assert(!nb_attribs || attrib_list);
+  for(i = 0; i < nb_attribs; ++i)
+    size += sizeof_rsrc_type(attrib_list[i].type);
+  return size;
+}
+
+/* Next fanning vertex of the triangle reordering when the candidates of the
+ * current fan have no more live triangle. */
+static size_t
+skip_dead_end
+  (const size_t* live_list,
+   size_t* dead_end_stack,
+   size_t* nb_dead_ends,
+   size_t* cursor,
+   size_t nb_verts)
+{
+  while(*nb_dead_ends) {
+    const size_t v = dead_end_stack[--(*nb_dead_ends)];
+    if(live_list[v] > 0)
+      return v;
+  }
+  for(; *cursor < nb_verts; ++(*cursor)) {
+    if(live_list[*cursor] > 0)
+      return *cursor;
+  }
+  return SIZE_MAX;
+}
+
+/* Reorder the triangles for the post transform vertex cache with the Tipsify
+ * algorithm of Sander et al., "Fast Triangle Reordering for Vertex Locality
+ * and Reduced Overdraw". The triangles are emitted as fans around vertices
+ * chosen with respect to their age in a simulated FIFO cache. */
+static enum rsrc_error
+optimize_vertex_cache
+  (struct rsrc_context* ctxt,
+   unsigned int* index_list,
+   size_t nb_indices,
+   size_t nb_verts)
+{
+  struct mem_allocator* allocator = NULL;
+  unsigned int* out_list = NULL;
+  size_t* offset_list = NULL; /* Triangles of the i^th vertex start at i. */
+  size_t* adjacency_list = NULL;
+  size_t* live_list = NULL; /* Number of non emitted triangles per vertex. */
+  size_t* stamp_list = NULL;
+  size_t* dead_end_stack = NULL;
+  size_t* candidate_list = NULL;
+  char* is_emitted = NULL;
+  const size_t nb_tris = nb_indices / 3;
+  size_t nb_out = 0;
+  size_t nb_dead_ends = 0;
+  size_t cursor = 0;
+  size_t time = VERTEX_CACHE_SIZE + 1;
+  size_t fan = 0;
+  size_t i = 0;
+  enum rsrc_error err = RSRC_NO_ERROR;
+  assert(ctxt && (!nb_indices || index_list) && nb_indices % 3 == 0);
+
+  if(!nb_tris)
+    goto exit;
+
+  allocator = ctxt->allocator;
+  out_list = MEM_ALLOC(allocator, nb_indices * sizeof(unsigned int));
+  offset_list = MEM_CALLOC(allocator, nb_verts + 1, sizeof(size_t));
+  adjacency_list = MEM_ALLOC(allocator, nb_indices * sizeof(size_t));
+  live_list = MEM_CALLOC(allocator, nb_verts, sizeof(size_t));
+  stamp_list = MEM_CALLOC(allocator, nb_verts, sizeof(size_t));
+  dead_end_stack = MEM_ALLOC(allocator, nb_indices * sizeof(size_t));
+  candidate_list = MEM_ALLOC(allocator, nb_indices * sizeof(size_t));
+  is_emitted = MEM_CALLOC(allocator, nb_tris, sizeof(char));
+  if(!out_list
+  || !offset_list
+  || !adjacency_list
+  || !live_list
+  || !stamp_list
+  || !dead_end_stack
+  || !candidate_list
+  || !is_emitted) {
+    err = RSRC_MEMORY_ERROR;
+    goto error;
+  }
+
+  /* Build the vertex to triangle adjacency. The stamp list is used as the
+   * write cursors of the adjacency lists. */
+  for(i = 0; i < nb_indices; ++i)
+    ++live_list[index_list[i]];
+  for(i = 0; i < nb_verts; ++i)
+    offset_list[i + 1] = offset_list[i] + live_list[i];
+  for(i = 0; i < nb_indices; ++i) {
+    const size_t v = index_list[i];
+    adjacency_list[offset_list[v] + stamp_list[v]++] = i / 3;
+  }
+  memset(stamp_list, 0, nb_verts * sizeof(size_t));
+
+  fan = skip_dead_end
+    (live_list, dead_end_stack, &nb_dead_ends, &cursor, nb_verts);
+  while(fan != SIZE_MAX) {
+    size_t nb_candidates = 0;
+    size_t best_vertex = SIZE_MAX;
+    size_t best_priority = 0;
+    size_t j = 0;
+
+    for(i = offset_list[fan]; i < offset_list[fan + 1]; ++i) {
+      const size_t tri = adjacency_list[i];
+      if(is_emitted[tri])
+        continue;
+      for(j = 0; j < 3; ++j) {
+        const size_t v = index_list[tri * 3 + j];
+        out_list[nb_out++] = (unsigned int)v;
+        dead_end_stack[nb_dead_ends++] = v;
+        candidate_list[nb_candidates++] = v;
+        --live_list[v];
+        if(time - stamp_list[v] > VERTEX_CACHE_SIZE)
+          stamp_list[v] = time++;
+      }
+      is_emitted[tri] = 1;
+    }
+    /* Choose the candidate that will still be in the cache once all of its
+     * live triangles are emitted, preferring the oldest one. */
+    for(i = 0; i < nb_candidates; ++i) {
+      const size_t v = candidate_list[i];
+      size_t priority = 0;
+      if(live_list[v] == 0)
+        continue;
+      if(time - stamp_list[v] + 2 * live_list[v] <= VERTEX_CACHE_SIZE)
+        priority = time - stamp_list[v];
+      if(best_vertex == SIZE_MAX || priority > best_priority) {
+        best_vertex = v;
+        best_priority = priority;
+      }
+    }
+    fan = best_vertex != SIZE_MAX ? best_vertex : skip_dead_end
+      (live_list, dead_end_stack, &nb_dead_ends, &cursor, nb_verts);
+  }
+  assert(nb_out == nb_indices);
+  memcpy(index_list, out_list, nb_indices * sizeof(unsigned int));
+
+exit:
+  if(out_list)
+    MEM_FREE(allocator, out_list);
+  if(offset_list)
+    MEM_FREE(allocator, offset_list);
+  if(adjacency_list)
+    MEM_FREE(allocator, adjacency_list);
+  if(live_list)
+    MEM_FREE(allocator, live_list);
+  if(stamp_list)
+    MEM_FREE(allocator, stamp_list);
+  if(dead_end_stack)
+    MEM_FREE(allocator, dead_end_stack);
+  if(candidate_list)
+    MEM_FREE(allocator, candidate_list);
+  if(is_emitted)
+    MEM_FREE(allocator, is_emitted);
+  return err;
+error:
+  goto exit;
+}
+
+/* Rebuild the vertices of the primitive set. If remap_vertices is true, the
+ * vertices are stored in the order of their first reference by the indices
+ * and the unreferenced ones are discarded. The normals and the texcoords are
+ * packed with respect to the quantization flags. */
+static enum rsrc_error
+rebuild_vertices
+  (struct rsrc_context* ctxt,
+   struct primitive_set* prim_set,
+   bool remap_vertices,
+   int flags)
+{
+  struct rsrc_attrib* attrib_list = NULL;
+  struct sl_vector* data_list = NULL;
+  const char* src = NULL;
+  char* dst = NULL;
+  unsigned int* index_list = NULL;
+  unsigned int* remap_list = NULL;
+  unsigned int* new_id_list = NULL;
+  size_t sizeof_data = 0;
+  size_t nb_attribs = 0;
+  size_t nb_indices = 0;
+  size_t nb_verts = 0;
+  size_t nb_new_verts = 0;
+  size_t src_stride = 0;
+  size_t dst_stride = 0;
+  size_t i = 0;
+  enum rsrc_error err = RSRC_NO_ERROR;
+  enum sl_error sl_err = SL_NO_ERROR;
+  assert(ctxt && prim_set && prim_set->data_list);
+
+  SL(vector_buffer
+    (prim_set->attrib_list, &nb_attribs, NULL, NULL, (void**)&attrib_list));
+  SL(vector_buffer
+    (prim_set->index_list, &nb_indices, NULL, NULL, (void**)&index_list));
+  SL(vector_buffer
+    (prim_set->data_list, &nb_verts, &sizeof_data, NULL, (void**)&src));
+  sizeof_data *= nb_verts;
+
+  src_stride = sizeof_vertex(attrib_list, nb_attribs);
+  dst_stride = 0;
+  for(i = 0; i < nb_attribs; ++i) {
+    if((flags & RSRC_QUANTIZE_NORMALS)
+    && attrib_list[i].usage == RSRC_ATTRIB_NORMAL
+    && attrib_list[i].type == RSRC_FLOAT3) {
+      dst_stride += sizeof_rsrc_type(RSRC_SNORM16x2);
+    } else if((flags & RSRC_QUANTIZE_TEXCOORDS)
+    && attrib_list[i].usage == RSRC_ATTRIB_TEXCOORD
+    && attrib_list[i].type == RSRC_FLOAT2) {
+      dst_stride += sizeof_rsrc_type(RSRC_HALF2);
+    } else {
+      dst_stride += sizeof_rsrc_type(attrib_list[i].type);
+    }
+  }
+  if(!src_stride || !dst_stride)
+    goto exit;
+  nb_verts = sizeof_data / src_stride;
+
+  /* remap_list[i] is the source vertex of the i^th vertex. */
+  remap_list = MEM_ALLOC(ctxt->allocator, nb_verts * sizeof(unsigned int));
+  if(nb_verts && !remap_list) {
+    err = RSRC_MEMORY_ERROR;
+    goto error;
+  }
+  if(!remap_vertices) {
+    for(i = 0; i < nb_verts; ++i)
+      remap_list[i] = (unsigned int)i;
+    nb_new_verts = nb_verts;
+  } else {
+    new_id_list = MEM_ALLOC(ctxt->allocator, nb_verts * sizeof(unsigned int));
+    if(nb_verts && !new_id_list) {
+      err = RSRC_MEMORY_ERROR;
+      goto error;
+    }
+    for(i = 0; i < nb_verts; ++i)
+      new_id_list[i] = UINT_MAX;
+    for(i = 0; i < nb_indices; ++i) {
+      const unsigned int v = index_list[i];
+      if(new_id_list[v] == UINT_MAX) {
+        new_id_list[v] = (unsigned int)nb_new_verts;
+        remap_list[nb_new_verts++] = v;
+      }
+    }
+  }
+
+  sl_err = sl_create_vector
+    (dst_stride, ALIGNOF(float), ctxt->allocator, &data_list);
+  if(sl_err == SL_NO_ERROR && nb_new_verts)
+    sl_err = sl_vector_resize(data_list, nb_new_verts, NULL);
+  if(sl_err != SL_NO_ERROR) {
+    err = sl_to_rsrc_error(sl_err);
+    goto error;
+  }
+  SL(vector_buffer(data_list, NULL, NULL, NULL, (void**)&dst));
+
+  for(i = 0; i < nb_new_verts; ++i) {
+    const char* src_vertex = src + remap_list[i] * src_stride;
+    char* dst_vertex = dst + i * dst_stride;
+    size_t j = 0;
+
+    for(j = 0; j < nb_attribs; ++j) {
+      const size_t size = sizeof_rsrc_type(attrib_list[j].type);
+      if((flags & RSRC_QUANTIZE_NORMALS)
+      && attrib_list[j].usage == RSRC_ATTRIB_NORMAL
+      && attrib_list[j].type == RSRC_FLOAT3) {
+        float nor[3];
+        int16_t oct[2];
+        memcpy(nor, src_vertex, sizeof(nor));
+        encode_octahedral_normal(nor, oct);
+        memcpy(dst_vertex, oct, sizeof(oct));
+        dst_vertex += sizeof(oct);
+      } else if((flags & RSRC_QUANTIZE_TEXCOORDS)
+      && attrib_list[j].usage == RSRC_ATTRIB_TEXCOORD
+      && attrib_list[j].type == RSRC_FLOAT2) {
+        float tex[2];
+        uint16_t half[2];
+        memcpy(tex, src_vertex, sizeof(tex));
+        half[0] = float_to_half(tex[0]);
+        half[1] = float_to_half(tex[1]);
+        memcpy(dst_vertex, half, sizeof(half));
+        dst_vertex += sizeof(half);
+      } else {
+        memcpy(dst_vertex, src_vertex, size);
+        dst_vertex += size;
+      }
+      src_vertex += size;
+    }
+  }
+
+  /* Commit the new vertex layout. */
+  if(new_id_list) {
+    for(i = 0; i < nb_indices; ++i)
+      index_list[i] = new_id_list[index_list[i]];
+  }
+  for(i = 0; i < nb_attribs; ++i) {
+    if((flags & RSRC_QUANTIZE_NORMALS)
+    && attrib_list[i].usage == RSRC_ATTRIB_NORMAL
+    && attrib_list[i].type == RSRC_FLOAT3) {
+      attrib_list[i].type = RSRC_SNORM16x2;
+    } else if((flags & RSRC_QUANTIZE_TEXCOORDS)
+    && attrib_list[i].usage == RSRC_ATTRIB_TEXCOORD
+    && attrib_list[i].type == RSRC_FLOAT2) {
+      attrib_list[i].type = RSRC_HALF2;
+    }
+  }
+  SL(free_vector(prim_set->data_list));
+  prim_set->data_list = data_list;
+
+exit:
+  if(remap_list)
+    MEM_FREE(ctxt->allocator, remap_list);
+  if(new_id_list)
+    MEM_FREE(ctxt->allocator, new_id_list);
+  return err;
+error:
+  if(data_list)
+    SL(free_vector(data_list));
+  goto exit;
+}
+
+/*******************************************************************************
+ *
+ * Mesh simplification.
+ *
+ * The triangles are simplified with half edge collapses ordered by the
+ * quadric error metric of Garland and Heckbert, "Surface Simplification Using
+ * Quadric Error Metrics". The vertices are welded by position beforehand so
+ * that the attribute seams do not open. A vertex is always collapsed onto one
+ * of its neighbours, i.e. the attributes of the remaining vertices are kept
+ * as is and no new vertex is created.
+ *
+ ******************************************************************************/
+/* Symmetric 4x4 matrix of a quadric, i.e. aa, ab, ac, ad, bb, bc, bd, cc, cd
+ * and dd for the plane ax + by + cz + d = 0. */
+struct quadric {
+  double q[10];
+};
+
+struct collapse {
+  double cost;
+  unsigned int src; /* Collapsed class. */
+  unsigned int dst; /* Class onto which src is collapsed. */
+  unsigned int src_stamp;
+  unsigned int dst_stamp;
+};
+
+struct simplifier {
+  struct mem_allocator* allocator;
+  struct sl_vector* heap; /* Min heap of struct collapse. */
+  /* Per vertex data. */
+  unsigned int* class_list; /* Class of equal positions of the vertex. */
+  /* Per class data. */
+  float (*pos_list)[3];
+  struct quadric* quadric_list;
+  unsigned int* rep_list; /* First vertex of the class. */
+  unsigned int* stamp_list; /* Incremented on each update of the class. */
+  unsigned int* mark_list;
+  unsigned int* next_list; /* Next class collapsed in the class. */
+  unsigned int* last_list; /* Last class collapsed in the class. */
+  size_t* offset_list; /* Triangles of the i^th class start at i. */
+  size_t* adjacency_list;
+  char* is_alive;
+  /* Per triangle data. */
+  unsigned int* corner_list; /* Current class of the triangle corners. */
+  char* is_tri_alive;
+  size_t nb_classes;
+  size_t nb_tris;
+  size_t nb_live_tris;
+  unsigned int mark;
+};
+
+struct weld_vertex {
+  float pos[3];
+  unsigned int id;
+};
+
+static int
+cmp_weld_vertices(const void* a, const void* b)
+{
+  const struct weld_vertex* v0 = a;
+  const struct weld_vertex* v1 = b;
+  int i = 0;
+  for(i = 0; i < 3; ++i) {
+    if(v0->pos[i] != v1->pos[i])
+      return v0->pos[i] < v1->pos[i] ? -1 : 1;
+  }
+  return -(v0->id < v1->id) | (v0->id > v1->id);
+}
+
+static void
+quadric_add_plane
+  (struct quadric* quadric,
+   const double nor[3], /* Normalized. */
+   const double pos[3],
+   double weight)
+{
+  const double d = -(nor[0]*pos[0] + nor[1]*pos[1] + nor[2]*pos[2]);
+  double* q = quadric->q;
+  q[0] += weight * nor[0] * nor[0];
+  q[1] += weight * nor[0] * nor[1];
+  q[2] += weight * nor[0] * nor[2];
+  q[3] += weight * nor[0] * d;
+  q[4] += weight * nor[1] * nor[1];
+  q[5] += weight * nor[1] * nor[2];
+  q[6] += weight * nor[1] * d;
+  q[7] += weight * nor[2] * nor[2];
+  q[8] += weight * nor[2] * d;
+  q[9] += weight * d * d;
+}
+
+/* Error of the position p with respect to the sum of the q0 and q1 quadrics,
+ * i.e. the sum of its squared distances to their planes. */
+static double
+quadric_error
+  (const struct quadric* q0,
+   const struct quadric* q1,
+   const float p[3])
+{
+  double q[10];
+  double err = 0.0;
+  int i = 0;
+  for(i = 0; i < 10; ++i)
+    q[i] = q0->q[i] + q1->q[i];
+  err = q[0]*p[0]*p[0] + q[4]*p[1]*p[1] + q[7]*p[2]*p[2] + q[9]
+      + 2.0 * (q[1]*p[0]*p[1] + q[2]*p[0]*p[2] + q[5]*p[1]*p[2])
+      + 2.0 * (q[3]*p[0] + q[6]*p[1] + q[8]*p[2]);
+  return err > 0.0 ? err : 0.0;
+}
+
+static void
+triangle_normal
+  (const float a[3],
+   const float b[3],
+   const float c[3],
+   double nor[3])
+{
+  const double e0[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+  const double e1[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+  nor[0] = e0[1] * e1[2] - e0[2] * e1[1];
+  nor[1] = e0[2] * e1[0] - e0[0] * e1[2];
+  nor[2] = e0[0] * e1[1] - e0[1] * e1[0];
+}
+
+static enum sl_error
+push_collapse
+  (struct simplifier* simp,
+   unsigned int src,
+   unsigned int dst)
+{
+  struct collapse* heap = NULL;
+  struct collapse collapse;
+  size_t i = 0;
+  enum sl_error sl_err = SL_NO_ERROR;
+  assert(simp && src != dst);
+
+  collapse.cost = quadric_error
+    (simp->quadric_list + src, simp->quadric_list + dst, simp->pos_list[dst]);
+  collapse.src = src;
+  collapse.dst = dst;
+  collapse.src_stamp = simp->stamp_list[src];
+  collapse.dst_stamp = simp->stamp_list[dst];
+  sl_err = sl_vector_push_back(simp->heap, &collapse);
+  if(sl_err != SL_NO_ERROR)
+    return sl_err;
+
+  SL(vector_buffer(simp->heap, &i, NULL, NULL, (void**)&heap));
+  for(--i; i > 0 && heap[(i - 1) / 2].cost > collapse.cost; i = (i - 1) / 2)
+    heap[i] = heap[(i - 1) / 2];
+  heap[i] = collapse;
+  return SL_NO_ERROR;
+}
+
+static bool
+pop_collapse(struct simplifier* simp, struct collapse* out)
+{
+  struct collapse* heap = NULL;
+  struct collapse last;
+  size_t len = 0;
+  size_t i = 0;
+  assert(simp && out);
+
+  SL(vector_buffer(simp->heap, &len, NULL, NULL, (void**)&heap));
+  if(!len)
+    return false;
+  *out = heap[0];
+  last = heap[--len];
+  while(2 * i + 1 < len) {
+    size_t child = 2 * i + 1;
+    if(child + 1 < len && heap[child + 1].cost < heap[child].cost)
+      ++child;
+    if(heap[child].cost >= last.cost)
+      break;
+    heap[i] = heap[child];
+    i = child;
+  }
+  heap[i] = last;
+  SL(vector_pop_back(simp->heap));
+  return true;
+}
+
+/* Iterate over the live triangles of the cls class, i.e. the triangles of the
+ * classes collapsed in cls. */
+#define FOR_EACH_TRIANGLE(simp, cls, tri) \
+  for(size_t c__ = (cls); c__ != UINT_MAX; c__ = (simp)->next_list[c__]) \
+    for(size_t i__ = (simp)->offset_list[c__]; \
+        i__ < (simp)->offset_list[c__ + 1]; \
+        ++i__) \
+      if(((tri) = (simp)->adjacency_list[i__]), (simp)->is_tri_alive[tri])
+
+/* Check that the collapse neither flips a triangle nor makes the mesh non
+ * manifold, i.e. src and dst share only the neighbours of their common
+ * triangles. */
+static bool
+is_collapse_valid(struct simplifier* simp, const struct collapse* collapse)
+{
+  const unsigned int src = collapse->src;
+  const unsigned int dst = collapse->dst;
+  size_t tri = 0;
+  size_t nb_shared_tris = 0;
+  size_t nb_shared_verts = 0;
+  int i = 0;
+  assert(simp && collapse);
+
+  simp->mark += 2;
+  FOR_EACH_TRIANGLE(simp, src, tri) {
+    const unsigned int* corners = simp->corner_list + tri * 3;
+    const float* pos[3];
+    double nor0[3], nor1[3];
+    bool has_dst = false;
+    for(i = 0; i < 3; ++i) {
+      has_dst |= corners[i] == dst;
+      if(corners[i] != src)
+        simp->mark_list[corners[i]] = simp->mark;
+    }
+    if(has_dst) {
+      ++nb_shared_tris;
+      continue;
+    }
+    for(i = 0; i < 3; ++i)
+      pos[i] = simp->pos_list[corners[i]];
+    triangle_normal(pos[0], pos[1], pos[2], nor0);
+    for(i = 0; i < 3; ++i) {
+      if(corners[i] == src)
+        pos[i] = simp->pos_list[dst];
+    }
+    triangle_normal(pos[0], pos[1], pos[2], nor1);
+    if(nor0[0]*nor1[0] + nor0[1]*nor1[1] + nor0[2]*nor1[2] <= 0.0)
+      return false;
+  }
+  FOR_EACH_TRIANGLE(simp, dst, tri) {
+    const unsigned int* corners = simp->corner_list + tri * 3;
+    for(i = 0; i < 3; ++i) {
+      if(simp->mark_list[corners[i]] == simp->mark) {
+        simp->mark_list[corners[i]] = simp->mark + 1;
+        ++nb_shared_verts;
+      }
+    }
+  }
+  /* The dst class is itself marked as a neighbour of src. */
+  return nb_shared_verts == nb_shared_tris + 1;
+}
+
+static enum sl_error
+apply_collapse(struct simplifier* simp, const struct collapse* collapse)
+{
+  const unsigned int src = collapse->src;
+  const unsigned int dst = collapse->dst;
+  size_t tri = 0;
+  int i = 0;
+  enum sl_error sl_err = SL_NO_ERROR;
+  assert(simp && collapse);
+
+  FOR_EACH_TRIANGLE(simp, src, tri) {
+    unsigned int* corners = simp->corner_list + tri * 3;
+    if(corners[0] == dst || corners[1] == dst || corners[2] == dst) {
+      simp->is_tri_alive[tri] = 0;
+      --simp->nb_live_tris;
+    } else {
+      for(i = 0; i < 3; ++i) {
+        if(corners[i] == src)
+          corners[i] = dst;
+      }
+    }
+  }
+  for(i = 0; i < 10; ++i)
+    simp->quadric_list[dst].q[i] += simp->quadric_list[src].q[i];
+  simp->next_list[simp->last_list[dst]] = src;
+  simp->last_list[dst] = simp->last_list[src];
+  simp->is_alive[src] = 0;
+  ++simp->stamp_list[dst];
+
+  /* Register the collapses of the edges whose cost has changed. */
+  FOR_EACH_TRIANGLE(simp, dst, tri) {
+    const unsigned int* corners = simp->corner_list + tri * 3;
+    for(i = 0; i < 3; ++i) {
+      if(corners[i] == dst)
+        continue;
+      if(SL_NO_ERROR != (sl_err = push_collapse(simp, dst, corners[i])))
+        return sl_err;
+      if(SL_NO_ERROR != (sl_err = push_collapse(simp, corners[i], dst)))
+        return sl_err;
+    }
+  }
+  return SL_NO_ERROR;
+}
+
+static void
+release_simplifier(struct simplifier* simp)
+{
+  assert(simp);
+  #define FREE(ptr) if(ptr) MEM_FREE(simp->allocator, ptr)
+  FREE(simp->class_list);
+  FREE(simp->pos_list);
+  FREE(simp->quadric_list);
+  FREE(simp->rep_list);
+  FREE(simp->stamp_list);
+  FREE(simp->mark_list);
+  FREE(simp->next_list);
+  FREE(simp->last_list);
+  FREE(simp->offset_list);
+  FREE(simp->adjacency_list);
+  FREE(simp->is_alive);
+  FREE(simp->corner_list);
+  FREE(simp->is_tri_alive);
+  #undef FREE
+  if(simp->heap)
+    SL(free_vector(simp->heap));
+}
+
+/* Weld the vertices by position and build the classes of the simplifier. */
+static enum rsrc_error
+setup_simplifier
+  (struct simplifier* simp,
+   const char* data,
+   size_t stride,
+   size_t nb_verts,
+   const unsigned int* index_list,
+   size_t nb_indices)
+{
+  struct weld_vertex* weld_list = NULL;
+  size_t i = 0;
+  enum rsrc_error err = RSRC_NO_ERROR;
+  enum sl_error sl_err = SL_NO_ERROR;
+  assert(simp && data && stride && index_list && nb_indices % 3 == 0);
+
+  simp->nb_tris = simp->nb_live_tris = nb_indices / 3;
+  weld_list = MEM_ALLOC(simp->allocator, nb_verts * sizeof(struct weld_vertex));
+  simp->class_list = MEM_ALLOC(simp->allocator, nb_verts*sizeof(unsigned int));
+  if(!weld_list || !simp->class_list) {
+    err = RSRC_MEMORY_ERROR;
+    goto error;
+  }
+  for(i = 0; i < nb_verts; ++i) {
+    memcpy(weld_list[i].pos, data + i * stride, sizeof(float[3]));
+    weld_list[i].id = (unsigned int)i;
+  }
+  qsort(weld_list, nb_verts, sizeof(struct weld_vertex), cmp_weld_vertices);
+  for(i = 0; i < nb_verts; ++i) {
+    if(i && memcmp(weld_list[i].pos, weld_list[i-1].pos, sizeof(float[3])))
+      ++simp->nb_classes;
+    simp->class_list[weld_list[i].id] = (unsigned int)simp->nb_classes;
+  }
+  simp->nb_classes += nb_verts != 0;
+
+  #define ALLOC(ptr, count) \
+    do { \
+      if(!((ptr) = MEM_CALLOC(simp->allocator, (count), sizeof(*(ptr))))) { \
+        err = RSRC_MEMORY_ERROR; \
+        goto error; \
+      } \
+    } while(0)
+  ALLOC(simp->pos_list, simp->nb_classes);
+  ALLOC(simp->quadric_list, simp->nb_classes);
+  ALLOC(simp->rep_list, simp->nb_classes);
+  ALLOC(simp->stamp_list, simp->nb_classes);
+  ALLOC(simp->mark_list, simp->nb_classes);
+  ALLOC(simp->next_list, simp->nb_classes);
+  ALLOC(simp->last_list, simp->nb_classes);
+  ALLOC(simp->offset_list, simp->nb_classes + 1);
+  ALLOC(simp->adjacency_list, nb_indices);
+  ALLOC(simp->is_alive, simp->nb_classes);
+  ALLOC(simp->corner_list, nb_indices);
+  ALLOC(simp->is_tri_alive, simp->nb_tris);
+  #undef ALLOC
+  sl_err = sl_create_vector
+    (sizeof(struct collapse),
+     ALIGNOF(struct collapse),
+     simp->allocator,
+     &simp->heap);
+  if(sl_err != SL_NO_ERROR) {
+    err = sl_to_rsrc_error(sl_err);
+    goto error;
+  }
+
+  for(i = nb_verts; i-- > 0; ) {
+    const unsigned int cls = simp->class_list[i];
+    simp->rep_list[cls] = (unsigned int)i;
+    memcpy(simp->pos_list[cls], data + i * stride, sizeof(float[3]));
+  }
+  for(i = 0; i < simp->nb_classes; ++i) {
+    simp->next_list[i] = UINT_MAX;
+    simp->last_list[i] = (unsigned int)i;
+    simp->is_alive[i] = 1;
+  }
+  for(i = 0; i < nb_indices; ++i) {
+    simp->corner_list[i] = simp->class_list[index_list[i]];
+    ++simp->offset_list[simp->corner_list[i] + 1];
+  }
+  for(i = 0; i < simp->nb_classes; ++i)
+    simp->offset_list[i + 1] += simp->offset_list[i];
+  /* The mark list is used as the write cursors of the adjacency lists. */
+  for(i = 0; i < nb_indices; ++i) {
+    const unsigned int cls = simp->corner_list[i];
+    simp->adjacency_list[simp->offset_list[cls] + simp->mark_list[cls]++] =
+      i / 3;
+  }
+  memset(simp->mark_list, 0, simp->nb_classes * sizeof(unsigned int));
+
+  /* The degenerated triangles are discarded. */
+  for(i = 0; i < simp->nb_tris; ++i) {
+    const unsigned int* corners = simp->corner_list + i * 3;
+    simp->is_tri_alive[i] = corners[0] != corners[1]
+                         && corners[1] != corners[2]
+                         && corners[2] != corners[0];
+    simp->nb_live_tris -= !simp->is_tri_alive[i];
+  }
+
+exit:
+  if(weld_list)
+    MEM_FREE(simp->allocator, weld_list);
+  return err;
+error:
+  goto exit;
+}
+
+/* Accumulate the planes of the triangles and of the boundary edges into the
+ * quadrics of their classes and register the initial collapses. */
+static enum rsrc_error
+setup_collapses(struct simplifier* simp)
+{
+  size_t tri = 0;
+  size_t i = 0;
+  enum sl_error sl_err = SL_NO_ERROR;
+  assert(simp);
+
+  for(tri = 0; tri < simp->nb_tris; ++tri) {
+    const unsigned int* corners = simp->corner_list + tri * 3;
+    double nor[3];
+    double pos[3];
+    double len = 0.0;
+    int j = 0;
+
+    if(!simp->is_tri_alive[tri])
+      continue;
+    triangle_normal
+      (simp->pos_list[corners[0]],
+       simp->pos_list[corners[1]],
+       simp->pos_list[corners[2]],
+       nor);
+    len = sqrt(nor[0]*nor[0] + nor[1]*nor[1] + nor[2]*nor[2]);
+    if(len <= 0.0)
+      continue;
+    nor[0] /= len;
+    nor[1] /= len;
+    nor[2] /= len;
+    for(j = 0; j < 3; ++j) {
+      const float* p = simp->pos_list[corners[j]];
+      pos[0] = p[0];
+      pos[1] = p[1];
+      pos[2] = p[2];
+      quadric_add_plane(simp->quadric_list + corners[j], nor, pos, 1.0);
+    }
+    /* An edge shared by no other triangle is constrained by the plane
+     * orthogonal to its triangle. */
+    for(j = 0; j < 3; ++j) {
+      const unsigned int a = corners[j];
+      const unsigned int b = corners[(j + 1) % 3];
+      const float* pa = simp->pos_list[a];
+      const float* pb = simp->pos_list[b];
+      size_t other = 0;
+      size_t nb_tris = 0;
+      double edge[3];
+      double bnor[3];
+      double blen = 0.0;
+
+      FOR_EACH_TRIANGLE(simp, a, other) {
+        const unsigned int* c = simp->corner_list + other * 3;
+        nb_tris += c[0] == b || c[1] == b || c[2] == b;
+      }
+      if(nb_tris != 1)
+        continue;
+      edge[0] = pb[0] - pa[0];
+      edge[1] = pb[1] - pa[1];
+      edge[2] = pb[2] - pa[2];
+      bnor[0] = edge[1] * nor[2] - edge[2] * nor[1];
+      bnor[1] = edge[2] * nor[0] - edge[0] * nor[2];
+      bnor[2] = edge[0] * nor[1] - edge[1] * nor[0];
+      blen = sqrt(bnor[0]*bnor[0] + bnor[1]*bnor[1] + bnor[2]*bnor[2]);
+      if(blen <= 0.0)
+        continue;
+      bnor[0] /= blen;
+      bnor[1] /= blen;
+      bnor[2] /= blen;
+      pos[0] = pa[0];
+      pos[1] = pa[1];
+      pos[2] = pa[2];
+      quadric_add_plane(simp->quadric_list + a, bnor, pos, 1.0);
+      quadric_add_plane(simp->quadric_list + b, bnor, pos, 1.0);
+    }
+  }
+  for(tri = 0; tri < simp->nb_tris; ++tri) {
+    const unsigned int* corners = simp->corner_list + tri * 3;
+    if(!simp->is_tri_alive[tri])
+      continue;
+    for(i = 0; i < 3; ++i) {
+      const unsigned int a = corners[i];
+      const unsigned int b = corners[(i + 1) % 3];
+      if(SL_NO_ERROR != (sl_err = push_collapse(simp, a, b))
+      || SL_NO_ERROR != (sl_err = push_collapse(simp, b, a)))
+        return sl_to_rsrc_error(sl_err);
+    }
+  }
+  return RSRC_NO_ERROR;
+}
+
+/* Collapse the edges of the triangle primitive set until its number of
+ * triangles is at most ratio times its initial number of triangles. The
+ * returned cost is the maximum quadric error of the applied collapses. */
+static enum rsrc_error
+simplify_triangles
+  (struct rsrc_context* ctxt,
+   struct primitive_set* prim_set,
+   float ratio,
+   double* out_cost)
+{
+  struct simplifier simp;
+  struct collapse collapse;
+  struct rsrc_attrib* attrib_list = NULL;
+  unsigned int* index_list = NULL;
+  const char* data = NULL;
+  size_t nb_attribs = 0;
+  size_t nb_indices = 0;
+  size_t nb_target_tris = 0;
+  size_t sizeof_data = 0;
+  size_t stride = 0;
+  size_t offset = SIZE_MAX;
+  size_t nb_verts = 0;
+  size_t i = 0;
+  size_t j = 0;
+  double max_cost = 0.0;
+  enum rsrc_error err = RSRC_NO_ERROR;
+  enum sl_error sl_err = SL_NO_ERROR;
+  assert(ctxt && prim_set && prim_set->data_list && out_cost);
+
+  memset(&simp, 0, sizeof(simp));
+  simp.allocator = ctxt->allocator;
+
+  SL(vector_buffer
+    (prim_set->attrib_list, &nb_attribs, NULL, NULL, (void**)&attrib_list));
+  SL(vector_buffer
+    (prim_set->index_list, &nb_indices, NULL, NULL, (void**)&index_list));
+  SL(vector_buffer
+    (prim_set->data_list, &nb_verts, &sizeof_data, NULL, (void**)&data));
+  for(i = 0; i < nb_attribs; ++i) {
+    if(attrib_list[i].usage == RSRC_ATTRIB_POSITION
+    && attrib_list[i].type == RSRC_FLOAT3)
+      offset = stride;
+    stride += sizeof_rsrc_type(attrib_list[i].type);
+  }
+  /* Only the primitive sets with float3 positions can be simplified. */
+  if(offset == SIZE_MAX || !stride || nb_indices < 3)
+    goto exit;
+  nb_verts = nb_verts * sizeof_data / stride;
+  nb_target_tris = (size_t)((float)(nb_indices / 3) * ratio);
+
+  err = setup_simplifier
+    (&simp, data + offset, stride, nb_verts, index_list, nb_indices);
+  if(err != RSRC_NO_ERROR)
+    goto error;
+  err = setup_collapses(&simp);
+  if(err != RSRC_NO_ERROR)
+    goto error;
+
+  while(simp.nb_live_tris > nb_target_tris && pop_collapse(&simp, &collapse)) {
+    if(!simp.is_alive[collapse.src]
+    || !simp.is_alive[collapse.dst]
+    || simp.stamp_list[collapse.src] != collapse.src_stamp
+    || simp.stamp_list[collapse.dst] != collapse.dst_stamp
+    || !is_collapse_valid(&simp, &collapse))
+      continue;
+    sl_err = apply_collapse(&simp, &collapse);
+    if(sl_err != SL_NO_ERROR) {
+      err = sl_to_rsrc_error(sl_err);
+      goto error;
+    }
+    max_cost = collapse.cost > max_cost ? collapse.cost : max_cost;
+  }
+
+  /* A corner keeps its vertex, and thus its attributes, if its class was not
+   * collapsed. */
+  for(i = 0, j = 0; i < simp.nb_tris; ++i) {
+    int k = 0;
+    if(!simp.is_tri_alive[i])
+      continue;
+    for(k = 0; k < 3; ++k) {
+      const unsigned int vert = index_list[i * 3 + k];
+      const unsigned int cls = simp.corner_list[i * 3 + k];
+      index_list[j++] =
+        simp.class_list[vert] == cls ? vert : simp.rep_list[cls];
+    }
+  }
+  assert(j == simp.nb_live_tris * 3);
+  sl_err = sl_vector_resize(prim_set->index_list, j, NULL);
+  if(sl_err != SL_NO_ERROR) {
+    err = sl_to_rsrc_error(sl_err);
+    goto error;
+  }
+  /* Discard the vertices that are no more referenced. */
+  err = rebuild_vertices(ctxt, prim_set, true, 0);
+  if(err != RSRC_NO_ERROR)
+    goto error;
+
+exit:
+  release_simplifier(&simp);
+  *out_cost = max_cost;
+  return err;
+error:
+  goto exit;
+}
+
+#undef FOR_EACH_TRIANGLE
+
+/* Resize the vector to count elements and copy data into it. */
+static enum sl_error
+copy_to_vector(struct sl_vector* vec, size_t count, const void* data)
+{
+  void* buffer = NULL;
+  size_t size = 0;
+  enum sl_error sl_err = SL_NO_ERROR;
+  assert(vec && (!count || data));
+
+  sl_err = sl_vector_resize(vec, count, NULL);
+  if(sl_err != SL_NO_ERROR)
+    return sl_err;
+  if(count) {
+    SL(vector_buffer(vec, NULL, &size, NULL, &buffer));
+    memcpy(buffer, data, count * size);
+  }
+  return SL_NO_ERROR;
 }
 
 static void
@@ -404,18 +1790,22 @@ rsrc_clear_geometry(struct rsrc_geometry* geom)
     }
 
     for(i = 0; i < len; ++i) {
-      assert(prim_set[i].data_list != NULL);
-      sl_err = sl_free_vector(prim_set[i].data_list);
-      if(sl_err != SL_NO_ERROR) {
-        err = sl_to_rsrc_error(sl_err);
-        goto error;
+      assert((prim_set[i].data_list != NULL) ^ (geom->mapping != NULL));
+      if(prim_set[i].data_list) {
+        sl_err = sl_free_vector(prim_set[i].data_list);
+        if(sl_err != SL_NO_ERROR) {
+          err = sl_to_rsrc_error(sl_err);
+          goto error;
+        }
       }
 
-      assert(prim_set[i].index_list != NULL);
-      sl_err = sl_free_vector(prim_set[i].index_list);
-      if(sl_err != SL_NO_ERROR) {
-        err = sl_to_rsrc_error(sl_err);
-        goto error;
+      assert((prim_set[i].index_list != NULL) ^ (geom->mapping != NULL));
+      if(prim_set[i].index_list) {
+        sl_err = sl_free_vector(prim_set[i].index_list);
+        if(sl_err != SL_NO_ERROR) {
+          err = sl_to_rsrc_error(sl_err);
+          goto error;
+        }
       }
 
       assert(prim_set[i].attrib_list != NULL);
@@ -432,6 +1822,14 @@ rsrc_clear_geometry(struct rsrc_geometry* geom)
       goto error;
     }
   }
+  if(geom->mapping) {
+    if(munmap(geom->mapping, geom->sizeof_mapping) != 0) {
+      err = RSRC_INTERNAL_ERROR;
+      goto error;
+    }
+    geom->mapping = NULL;
+    geom->sizeof_mapping = 0;
+  }
 
 exit:
   return err;
@@ -574,16 +1972,23 @@ rsrc_get_primitive_set
     goto error;
   }
 
-  SL(vector_buffer
-     (prim_set_lst[id].data_list, &len, &size, NULL, &buffer));
-  primitive_set->data = buffer;
-  primitive_set->sizeof_data = len * size;
-
-  SL(vector_buffer
-     (prim_set_lst[id].index_list, &len, NULL, NULL, &buffer));
-  assert(primitive_set->data != NULL || len == 0);
-  primitive_set->index_list = buffer;
-  primitive_set->nb_indices = len;
+  if(prim_set_lst[id].data_list == NULL) {
+    primitive_set->data = prim_set_lst[id].mapped_data;
+    primitive_set->sizeof_data = prim_set_lst[id].sizeof_mapped_data;
+    primitive_set->index_list = prim_set_lst[id].mapped_index_list;
+    primitive_set->nb_indices = prim_set_lst[id].nb_mapped_indices;
+  } else {
+    SL(vector_buffer
+       (prim_set_lst[id].data_list, &len, &size, NULL, &buffer));
+    primitive_set->data = buffer;
+    primitive_set->sizeof_data = len * size;
+
+    SL(vector_buffer
+       (prim_set_lst[id].index_list, &len, NULL, NULL, &buffer));
+    assert(primitive_set->data != NULL || len == 0);
+    primitive_set->index_list = buffer;
+    primitive_set->nb_indices = len;
+  }
 
   SL(vector_buffer
      (prim_set_lst[id].attrib_list, &len, NULL, NULL, &buffer));
@@ -599,3 +2004,634 @@ error:
   goto exit;
 }
 
+enum rsrc_error
+rsrc_copy_geometry
+  (struct rsrc_geometry* dst,
+   const struct rsrc_geometry* src)
+{
+  struct primitive_set prim_set;
+  size_t nb_prim_sets = 0;
+  size_t i = 0;
+  enum rsrc_error err = RSRC_NO_ERROR;
+  enum sl_error sl_err = SL_NO_ERROR;
+
+  memset(&prim_set, 0, sizeof(prim_set));
+
+  if(!dst || !src) {
+    err = RSRC_INVALID_ARGUMENT;
+    goto error;
+  }
+  if(dst == src)
+    goto exit;
+
+  err = rsrc_clear_geometry(dst);
+  if(err != RSRC_NO_ERROR)
+    goto error;
+
+  #define CALL(func) \
+    do { \
+      if(SL_NO_ERROR != (sl_err = func)) { \
+        err = sl_to_rsrc_error(sl_err); \
+        goto error; \
+      } \
+    } while(0)
+
+  RSRC(get_primitive_set_count(src, &nb_prim_sets));
+  for(i = 0; i < nb_prim_sets; ++i) {
+    struct rsrc_primitive_set desc;
+    RSRC(get_primitive_set(src, i, &desc));
+
+    /* The size of the attrib types are multiples of sizeof(float). */
+    assert(desc.sizeof_data % sizeof(float) == 0);
+    memset(&prim_set, 0, sizeof(prim_set));
+    prim_set.primitive_type = desc.primitive_type;
+    CALL(sl_create_vector
+      (sizeof(float), ALIGNOF(float), dst->ctxt->allocator,
+       &prim_set.data_list));
+    CALL(sl_create_vector
+      (sizeof(unsigned int), ALIGNOF(unsigned int), dst->ctxt->allocator,
+       &prim_set.index_list));
+    CALL(sl_create_vector
+      (sizeof(struct rsrc_attrib), ALIGNOF(struct rsrc_attrib),
+       dst->ctxt->allocator, &prim_set.attrib_list));
+    CALL(copy_to_vector
+      (prim_set.data_list, desc.sizeof_data / sizeof(float), desc.data));
+    CALL(copy_to_vector
+      (prim_set.index_list, desc.nb_indices, desc.index_list));
+    CALL(copy_to_vector
+      (prim_set.attrib_list, desc.nb_attribs, desc.attrib_list));
+    CALL(sl_vector_push_back(dst->primitive_set_list, &prim_set));
+    memset(&prim_set, 0, sizeof(prim_set));
+  }
+  #undef CALL
+
+exit:
+  return err;
+
+error:
+  if(prim_set.data_list)
+    SL(free_vector(prim_set.data_list));
+  if(prim_set.index_list)
+    SL(free_vector(prim_set.index_list));
+  if(prim_set.attrib_list)
+    SL(free_vector(prim_set.attrib_list));
+  if(dst && dst != src)
+    RSRC(clear_geometry(dst));
+  goto exit;
+}
+
+enum rsrc_error
+rsrc_write_geometry
+  (const struct rsrc_geometry* geom,
+   const char* src_path,
+   const char* path)
+{
+  struct geometry_file_header header;
+  struct geometry_file_primitive_set file_set;
+  struct rsrc_primitive_set prim_set;
+  FILE* fptr = NULL;
+  char* tmp_path = NULL;
+  size_t nb_prim_sets = 0;
+  int fd = -1;
+  size_t i = 0;
+  uint64_t offset = 0;
+  uint64_t sum = FNV64_OFFSET_BASIS;
+  enum rsrc_error err = RSRC_NO_ERROR;
+
+  if(!geom || !path) {
+    err = RSRC_INVALID_ARGUMENT;
+    goto error;
+  }
+  err = rsrc_get_primitive_set_count(geom, &nb_prim_sets);
+  if(err != RSRC_NO_ERROR)
+    goto error;
+  if(nb_prim_sets > UINT32_MAX) {
+    err = RSRC_OVERFOW_ERROR;
+    goto error;
+  }
+
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, GEOMETRY_FILE_MAGIC, sizeof(GEOMETRY_FILE_MAGIC));
+  header.version = GEOMETRY_FILE_VERSION;
+  header.nb_primitive_sets = (uint32_t)nb_prim_sets;
+  err = stat_source(geom->ctxt, src_path, &header);
+  if(err != RSRC_NO_ERROR)
+    goto error;
+
+  /* The geometry is written into a temporary file that then replaces the
+   * destination. A previous version of the file can thus still be mapped, even
+   * by the geometry to write. */
+  tmp_path = MEM_ALLOC
+    (geom->ctxt->allocator, strlen(path) + sizeof(".XXXXXX"));
+  if(!tmp_path) {
+    err = RSRC_MEMORY_ERROR;
+    goto error;
+  }
+  strcpy(tmp_path, path);
+  strcat(tmp_path, ".XXXXXX");
+  /* The temporary file is exclusively created by mkstemp and is only
+   * readable by the user. The rename replaces a destination symbolic link
+   * rather than following it. */
+  fd = mkstemp(tmp_path);
+  if(fd < 0) {
+    RSRC(print_error(geom->ctxt, "error opening file `%s'\n", tmp_path));
+    MEM_FREE(geom->ctxt->allocator, tmp_path);
+    tmp_path = NULL;
+    err = RSRC_IO_ERROR;
+    goto error;
+  }
+  fptr = fdopen(fd, "wb");
+  if(!fptr) {
+    close(fd);
+    err = RSRC_IO_ERROR;
+    goto error;
+  }
+  /* The header is written once the checksum of the file is known. */
+  if(fseek(fptr, sizeof(header), SEEK_SET) != 0) {
+    err = RSRC_IO_ERROR;
+    goto error;
+  }
+
+  offset = sizeof(header) + nb_prim_sets * sizeof(file_set);
+  for(i = 0; i < nb_prim_sets; ++i) {
+    size_t j = 0;
+
+    RSRC(get_primitive_set(geom, i, &prim_set));
+    if(prim_set.nb_attribs > GEOMETRY_FILE_MAX_ATTRIBS) {
+      RSRC(print_error
+        (geom->ctxt,
+         "unexpected primitive set with %zu attribs: "
+         "at most %d attribs are supported\n",
+         prim_set.nb_attribs, GEOMETRY_FILE_MAX_ATTRIBS));
+      err = RSRC_INVALID_ARGUMENT;
+      goto error;
+    }
+    memset(&file_set, 0, sizeof(file_set));
+    file_set.data_offset = offset;
+    file_set.sizeof_data = prim_set.sizeof_data;
+    offset += ALIGN_SIZE(prim_set.sizeof_data, GEOMETRY_FILE_ALIGNMENT);
+    file_set.index_offset = offset;
+    file_set.nb_indices = prim_set.nb_indices;
+    offset += ALIGN_SIZE
+      (prim_set.nb_indices * sizeof(unsigned int), GEOMETRY_FILE_ALIGNMENT);
+    file_set.primitive_type = (uint32_t)prim_set.primitive_type;
+    file_set.nb_attribs = (uint32_t)prim_set.nb_attribs;
+    for(j = 0; j < prim_set.nb_attribs; ++j) {
+      file_set.attrib_list[j][0] = (uint32_t)prim_set.attrib_list[j].type;
+      file_set.attrib_list[j][1] = (uint32_t)prim_set.attrib_list[j].usage;
+    }
+    primitive_set_bounds(&prim_set, file_set.min_bound, file_set.max_bound);
+
+    err = write_section(fptr, &file_set, sizeof(file_set), &sum);
+    if(err != RSRC_NO_ERROR)
+      goto error;
+  }
+  for(i = 0; i < nb_prim_sets; ++i) {
+    RSRC(get_primitive_set(geom, i, &prim_set));
+    err = write_section(fptr, prim_set.data, prim_set.sizeof_data, &sum);
+    if(err != RSRC_NO_ERROR)
+      goto error;
+    err = write_section
+      (fptr,
+       prim_set.index_list,
+       prim_set.nb_indices * sizeof(unsigned int),
+       &sum);
+    if(err != RSRC_NO_ERROR)
+      goto error;
+  }
+
+  header.sizeof_file = offset;
+  header.checksum = sum;
+  if(fseek(fptr, 0, SEEK_SET) != 0
+  || fwrite(&header, sizeof(header), 1, fptr) != 1) {
+    err = RSRC_IO_ERROR;
+    goto error;
+  }
+  if(fclose(fptr) != 0) {
+    fptr = NULL;
+    err = RSRC_IO_ERROR;
+    goto error;
+  }
+  fptr = NULL;
+  if(rename(tmp_path, path) != 0) {
+    RSRC(print_error(geom->ctxt, "error writing file `%s'\n", path));
+    err = RSRC_IO_ERROR;
+    goto error;
+  }
+
+exit:
+  if(tmp_path)
+    MEM_FREE(geom->ctxt->allocator, tmp_path);
+  return err;
+
+error:
+  if(fptr) {
+    fclose(fptr);
+    fptr = NULL;
+  }
+  if(tmp_path)
+    remove(tmp_path);
+  goto exit;
+}
+
+enum rsrc_error
+rsrc_load_geometry
+  (struct rsrc_geometry* geom,
+   const char* src_path,
+   const char* path)
+{
+  struct geometry_file_header src_header;
+  struct stat file_stat;
+  const struct geometry_file_header* header = NULL;
+  const struct geometry_file_primitive_set* file_set_list = NULL;
+  void* mapping = MAP_FAILED;
+  struct primitive_set* prim_set_list = NULL;
+  size_t sizeof_mapping = 0;
+  size_t nb_prim_sets = 0;
+  size_t i = 0;
+  int fd = -1;
+  enum rsrc_error err = RSRC_NO_ERROR;
+  enum sl_error sl_err = SL_NO_ERROR;
+
+  if(!geom || !path) {
+    err = RSRC_INVALID_ARGUMENT;
+    goto error;
+  }
+  err = stat_source(geom->ctxt, src_path, &src_header);
+  if(err != RSRC_NO_ERROR)
+    goto error;
+
+  /* Do not load a geometry file that another user may have planted. */
+  fd = open(path, O_RDONLY | O_NOFOLLOW);
+  if(fd < 0) {
+    RSRC(print_error(geom->ctxt, "error opening file `%s'\n", path));
+    err = RSRC_IO_ERROR;
+    goto error;
+  }
+  if(fstat(fd, &file_stat) != 0) {
+    err = RSRC_IO_ERROR;
+    goto error;
+  }
+  if(!S_ISREG(file_stat.st_mode) || file_stat.st_uid != geteuid()) {
+    RSRC(print_error(geom->ctxt, "untrusted geometry file `%s'\n", path));
+    err = RSRC_IO_ERROR;
+    goto error;
+  }
+  sizeof_mapping = (size_t)file_stat.st_size;
+  if(sizeof_mapping < sizeof(struct geometry_file_header)) {
+    RSRC(print_error(geom->ctxt, "invalid geometry file `%s'\n", path));
+    err = RSRC_PARSING_ERROR;
+    goto error;
+  }
+  mapping = mmap(NULL, sizeof_mapping, PROT_READ, MAP_PRIVATE, fd, 0);
+  if(mapping == MAP_FAILED) {
+    RSRC(print_error(geom->ctxt, "error mapping file `%s'\n", path));
+    err = RSRC_IO_ERROR;
+    goto error;
+  }
+
+  header = mapping;
+  file_set_list = (const struct geometry_file_primitive_set*)(header + 1);
+  if(memcmp(header->magic, GEOMETRY_FILE_MAGIC, sizeof(GEOMETRY_FILE_MAGIC))
+  || header->version != GEOMETRY_FILE_VERSION
+  || header->sizeof_file != sizeof_mapping
+  || sizeof_mapping % GEOMETRY_FILE_ALIGNMENT != 0
+  || header->nb_primitive_sets > (sizeof_mapping - sizeof(*header))
+      / sizeof(struct geometry_file_primitive_set)
+  || header->checksum != checksum_update
+      (FNV64_OFFSET_BASIS, header + 1, sizeof_mapping - sizeof(*header))) {
+    RSRC(print_error(geom->ctxt, "invalid geometry file `%s'\n", path));
+    err = RSRC_PARSING_ERROR;
+    goto error;
+  }
+  if(header->source_path_hash != src_header.source_path_hash
+  || header->source_size != src_header.source_size
+  || header->source_mtime_sec != src_header.source_mtime_sec
+  || header->source_mtime_nsec != src_header.source_mtime_nsec) {
+    RSRC(print_error(geom->ctxt, "out of date geometry file `%s'\n", path));
+    err = RSRC_PARSING_ERROR;
+    goto error;
+  }
+
+  /* Check the whole file before building its primitive sets. */
+  for(i = 0; i < header->nb_primitive_sets; ++i) {
+    const struct geometry_file_primitive_set* file_set = file_set_list + i;
+    size_t sizeof_vertex = 0;
+    size_t j = 0;
+
+    if(file_set->data_offset > sizeof_mapping
+    || file_set->index_offset > sizeof_mapping
+    || file_set->sizeof_data > sizeof_mapping - file_set->data_offset
+    || file_set->nb_indices
+        > (sizeof_mapping - file_set->index_offset) / sizeof(unsigned int)
+    || file_set->data_offset % GEOMETRY_FILE_ALIGNMENT != 0
+    || file_set->index_offset % GEOMETRY_FILE_ALIGNMENT != 0
+    || file_set->nb_attribs > GEOMETRY_FILE_MAX_ATTRIBS
+    || file_set->primitive_type > RSRC_TRIANGLE) {
+      RSRC(print_error(geom->ctxt, "invalid geometry file `%s'\n", path));
+      err = RSRC_PARSING_ERROR;
+      goto error;
+    }
+    for(j = 0; j < file_set->nb_attribs; ++j) {
+      if(file_set->attrib_list[j][0] > RSRC_SNORM16x2
+      || file_set->attrib_list[j][1] > RSRC_ATTRIB_COLOR) {
+        RSRC(print_error(geom->ctxt, "invalid geometry file `%s'\n", path));
+        err = RSRC_PARSING_ERROR;
+        goto error;
+      }
+      sizeof_vertex += sizeof_rsrc_type
+        ((enum rsrc_type)file_set->attrib_list[j][0]);
+    }
+    /* The mapped indices are used as is and must thus reference a vertex. */
+    if(file_set->nb_indices) {
+      const unsigned int* index_list = (const unsigned int*)
+        ((const char*)mapping + file_set->index_offset);
+      const size_t nb_vertices =
+        sizeof_vertex ? file_set->sizeof_data / sizeof_vertex : 0;
+
+      for(j = 0; j < file_set->nb_indices; ++j) {
+        if(index_list[j] >= nb_vertices)
+          break;
+      }
+      if(j < file_set->nb_indices) {
+        RSRC(print_error(geom->ctxt, "invalid geometry file `%s'\n", path));
+        err = RSRC_PARSING_ERROR;
+        goto error;
+      }
+    }
+  }
+
+  /* The primitive sets are built aside. The geometry is thus left unchanged
+   * if an allocation fails. */
+  nb_prim_sets = header->nb_primitive_sets;
+  if(nb_prim_sets) {
+    prim_set_list = MEM_CALLOC
+      (geom->ctxt->allocator, nb_prim_sets, sizeof(struct primitive_set));
+    if(!prim_set_list) {
+      err = RSRC_MEMORY_ERROR;
+      goto error;
+    }
+  }
+  for(i = 0; i < nb_prim_sets; ++i) {
+    const struct geometry_file_primitive_set* file_set = file_set_list + i;
+    struct primitive_set* prim_set = prim_set_list + i;
+    size_t j = 0;
+
+    sl_err = sl_create_vector
+      (sizeof(struct rsrc_attrib),
+       ALIGNOF(struct rsrc_attrib),
+       geom->ctxt->allocator,
+       &prim_set->attrib_list);
+    if(sl_err != SL_NO_ERROR) {
+      err = sl_to_rsrc_error(sl_err);
+      goto error;
+    }
+    for(j = 0; j < file_set->nb_attribs; ++j) {
+      const struct rsrc_attrib attrib = {
+        .type = (enum rsrc_type)file_set->attrib_list[j][0],
+        .usage = (enum rsrc_attrib_usage)file_set->attrib_list[j][1]
+      };
+      sl_err = sl_vector_push_back(prim_set->attrib_list, &attrib);
+      if(sl_err != SL_NO_ERROR) {
+        err = sl_to_rsrc_error(sl_err);
+        goto error;
+      }
+    }
+    prim_set->mapped_data = (const char*)mapping + file_set->data_offset;
+    prim_set->sizeof_mapped_data = file_set->sizeof_data;
+    prim_set->mapped_index_list = (const unsigned int*)
+      ((const char*)mapping + file_set->index_offset);
+    prim_set->nb_mapped_indices = file_set->nb_indices;
+    prim_set->primitive_type =
+      (enum rsrc_primitive_type)file_set->primitive_type;
+  }
+  sl_err = sl_vector_reserve(geom->primitive_set_list, nb_prim_sets);
+  if(sl_err != SL_NO_ERROR) {
+    err = sl_to_rsrc_error(sl_err);
+    goto error;
+  }
+
+  err = rsrc_clear_geometry(geom);
+  if(err != RSRC_NO_ERROR)
+    goto error;
+  /* From now on the mapping and the primitive sets are owned by the
+   * geometry. The reserved primitive set list cannot fail to grow. */
+  geom->mapping = mapping;
+  geom->sizeof_mapping = sizeof_mapping;
+  mapping = MAP_FAILED;
+  for(i = 0; i < nb_prim_sets; ++i)
+    SL(vector_push_back(geom->primitive_set_list, prim_set_list + i));
+  nb_prim_sets = 0;
+
+exit:
+  if(prim_set_list)
+    MEM_FREE(geom->ctxt->allocator, prim_set_list);
+  if(fd >= 0)
+    close(fd);
+  return err;
+
+error:
+  if(mapping != MAP_FAILED)
+    munmap(mapping, sizeof_mapping);
+  for(i = 0; prim_set_list && i < nb_prim_sets; ++i) {
+    if(prim_set_list[i].attrib_list)
+      SL(free_vector(prim_set_list[i].attrib_list));
+  }
+  goto exit;
+}
+
+enum rsrc_error
+rsrc_optimize_geometry(struct rsrc_geometry* geom, int flags)
+{
+  struct primitive_set* prim_set_list = NULL;
+  size_t nb_prim_sets = 0;
+  size_t i = 0;
+  enum rsrc_error err = RSRC_NO_ERROR;
+
+  if(!geom) {
+    err = RSRC_INVALID_ARGUMENT;
+    goto error;
+  }
+  if(geom->mapping) {
+    RSRC(print_error(geom->ctxt, "cannot optimize a mapped geometry\n"));
+    err = RSRC_INVALID_CALL;
+    goto error;
+  }
+  SL(vector_buffer
+    (geom->primitive_set_list,
+     &nb_prim_sets,
+     NULL,
+     NULL,
+     (void**)&prim_set_list));
+
+  for(i = 0; i < nb_prim_sets; ++i) {
+    struct primitive_set* prim_set = prim_set_list + i;
+
+    if((flags & RSRC_OPTIMIZE_VERTEX_CACHE)
+    && prim_set->primitive_type == RSRC_TRIANGLE) {
+      struct rsrc_attrib* attrib_list = NULL;
+      unsigned int* index_list = NULL;
+      size_t nb_attribs = 0;
+      size_t nb_indices = 0;
+      size_t sizeof_data = 0;
+      size_t len = 0;
+
+      SL(vector_buffer
+        (prim_set->attrib_list, &nb_attribs, NULL, NULL, (void**)&attrib_list));
+      SL(vector_buffer
+        (prim_set->index_list, &nb_indices, NULL, NULL, (void**)&index_list));
+      SL(vector_buffer(prim_set->data_list, &len, &sizeof_data, NULL, NULL));
+      err = optimize_vertex_cache
+        (geom->ctxt,
+         index_list,
+         nb_indices,
+         len * sizeof_data / sizeof_vertex(attrib_list, nb_attribs));
+      if(err != RSRC_NO_ERROR)
+        goto error;
+    }
+    if(flags & (RSRC_OPTIMIZE_VERTEX_FETCH
+              | RSRC_QUANTIZE_NORMALS
+              | RSRC_QUANTIZE_TEXCOORDS)) {
+      err = rebuild_vertices
+        (geom->ctxt,
+         prim_set,
+         (flags & RSRC_OPTIMIZE_VERTEX_FETCH) != 0,
+         flags);
+      if(err != RSRC_NO_ERROR)
+        goto error;
+    }
+  }
+
+exit:
+  return err;
+error:
+  goto exit;
+}
+
+enum rsrc_error
+rsrc_simplify_geometry
+  (struct rsrc_geometry* geom,
+   float ratio,
+   float* out_error)
+{
+  struct primitive_set* prim_set_list = NULL;
+  size_t nb_prim_sets = 0;
+  size_t i = 0;
+  double max_cost = 0.0;
+  enum rsrc_error err = RSRC_NO_ERROR;
+
+  if(!geom || !(ratio >= 0.f && ratio <= 1.f)) {
+    err = RSRC_INVALID_ARGUMENT;
+    goto error;
+  }
+  if(geom->mapping) {
+    RSRC(print_error(geom->ctxt, "cannot simplify a mapped geometry\n"));
+    err = RSRC_INVALID_CALL;
+    goto error;
+  }
+  SL(vector_buffer
+    (geom->primitive_set_list,
+     &nb_prim_sets,
+     NULL,
+     NULL,
+     (void**)&prim_set_list));
+
+  for(i = 0; i < nb_prim_sets; ++i) {
+    double cost = 0.0;
+    if(prim_set_list[i].primitive_type != RSRC_TRIANGLE)
+      continue;
+    err = simplify_triangles(geom->ctxt, prim_set_list + i, ratio, &cost);
+    if(err != RSRC_NO_ERROR)
+      goto error;
+    max_cost = cost > max_cost ? cost : max_cost;
+  }
+
+exit:
+  if(out_error)
+    *out_error = (float)sqrt(max_cost);
+  return err;
+error:
+  max_cost = 0.0;
+  goto exit;
+}
+
+enum rsrc_error
+rsrc_get_geometry_stats
+  (const struct rsrc_geometry* geom,
+   size_t cache_size,
+   struct rsrc_geometry_stats* stats)
+{
+  struct rsrc_primitive_set prim_set;
+  size_t* stamp_list = NULL;
+  size_t max_nb_verts = 0;
+  size_t nb_prim_sets = 0;
+  size_t i = 0;
+  enum rsrc_error err = RSRC_NO_ERROR;
+
+  if(!geom || !cache_size || !stats) {
+    err = RSRC_INVALID_ARGUMENT;
+    goto error;
+  }
+  memset(stats, 0, sizeof(struct rsrc_geometry_stats));
+  RSRC(get_primitive_set_count(geom, &nb_prim_sets));
+
+  for(i = 0; i < nb_prim_sets; ++i) {
+    size_t stride = 0;
+    size_t nb_verts = 0;
+    size_t nb_misses = 0;
+    size_t j = 0;
+
+    RSRC(get_primitive_set(geom, i, &prim_set));
+    stride = sizeof_vertex(prim_set.attrib_list, prim_set.nb_attribs);
+    nb_verts = stride ? prim_set.sizeof_data / stride : 0;
+    stats->nb_vertices += nb_verts;
+    stats->sizeof_vertex_data += prim_set.sizeof_data;
+    stats->sizeof_index_data += prim_set.nb_indices * sizeof(unsigned int);
+    if(prim_set.primitive_type != RSRC_TRIANGLE)
+      continue;
+
+    /* Simulate a FIFO post transform cache. The stamp of a vertex is the
+     * number of cache misses before its insertion into the cache. */
+    if(nb_verts > max_nb_verts) {
+      if(stamp_list)
+        MEM_FREE(geom->ctxt->allocator, stamp_list);
+      stamp_list = MEM_ALLOC(geom->ctxt->allocator, nb_verts * sizeof(size_t));
+      if(!stamp_list) {
+        err = RSRC_MEMORY_ERROR;
+        goto error;
+      }
+      max_nb_verts = nb_verts;
+    }
+    for(j = 0; j < nb_verts; ++j)
+      stamp_list[j] = SIZE_MAX;
+    for(j = 0; j < prim_set.nb_indices; ++j) {
+      const unsigned int v = prim_set.index_list[j];
+      if(v >= nb_verts) {
+        err = RSRC_INVALID_ARGUMENT;
+        goto error;
+      }
+      if(stamp_list[v] == SIZE_MAX || stamp_list[v] + cache_size < nb_misses) {
+        stamp_list[v] = nb_misses;
+        ++nb_misses;
+      }
+    }
+    stats->nb_triangles += prim_set.nb_indices / 3;
+    stats->nb_transformed_vertices += nb_misses;
+  }
+  if(stats->nb_triangles) {
+    stats->acmr =
+      (float)stats->nb_transformed_vertices / (float)stats->nb_triangles;
+  }
+  if(stats->nb_vertices) {
+    stats->atvr =
+      (float)stats->nb_transformed_vertices / (float)stats->nb_vertices;
+  }
+
+exit:
+  if(stamp_list)
+    MEM_FREE(geom->ctxt->allocator, stamp_list);
+  return err;
+error:
+  goto exit;
+}
+
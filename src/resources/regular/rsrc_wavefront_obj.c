@@ -998,8 +998,11 @@ exit:
 
 error:
   fprintf(stderr, "%s:%zd: error: parsing failed.\n", path, line_id);
-  err = clear_wavefront_obj(wobj);
-  assert(err == RSRC_NO_ERROR);
+  {
+    /* Keep the parsing error. */
+    UNUSED const enum rsrc_error tmp_err = clear_wavefront_obj(wobj);
+    assert(tmp_err == RSRC_NO_ERROR);
+  }
   goto exit;
 }
 
@@ -24,7 +24,9 @@ enum rsrc_type {
   RSRC_FLOAT,
   RSRC_FLOAT2,
   RSRC_FLOAT3,
-  RSRC_FLOAT4
+  RSRC_FLOAT4,
+  RSRC_HALF2, /* 2 half precision floats. */
+  RSRC_SNORM16x2 /* 2 normalized signed 16 bits integers. */
 };
 
 /* Basic image saving function. */
@@ -22,6 +22,29 @@ enum rsrc_primitive_type {
   RSRC_TRIANGLE
 };
 
+/* Post processes of rsrc_optimize_geometry. */
+enum rsrc_optimization_flag {
+  /* Reorder the triangles for the post transform vertex cache. */
+  RSRC_OPTIMIZE_VERTEX_CACHE = BIT(0),
+  /* Store the vertices in the order of their first use by the indices. */
+  RSRC_OPTIMIZE_VERTEX_FETCH = BIT(1),
+  /* Encode the RSRC_FLOAT3 normals as RSRC_SNORM16x2 octahedral coordinates.
+   * The shaders have to unfold them back onto the unit sphere. */
+  RSRC_QUANTIZE_NORMALS = BIT(2),
+  /* Encode the RSRC_FLOAT2 texcoords as RSRC_HALF2. */
+  RSRC_QUANTIZE_TEXCOORDS = BIT(3)
+};
+
+struct rsrc_geometry_stats {
+  size_t nb_vertices;
+  size_t nb_triangles;
+  size_t nb_transformed_vertices; /* Misses of the simulated vertex cache. */
+  size_t sizeof_vertex_data; /* In bytes. */
+  size_t sizeof_index_data; /* In bytes. */
+  float acmr; /* Average cache miss ratio, i.e. misses per triangle. */
+  float atvr; /* Average transformed vertex ratio, i.e. misses per vertex. */
+};
+
 struct rsrc_attrib {
   enum rsrc_type type;
   enum rsrc_attrib_usage usage;
@@ -70,5 +93,60 @@ rsrc_get_primitive_set
    size_t prim_list_id,
    struct rsrc_primitive_set* desc);
 
+/* Deep copy of src into dst. The copied data are owned by dst, even though src
+ * is mapped from a geometry file. */
+RSRC_API enum rsrc_error
+rsrc_copy_geometry
+  (struct rsrc_geometry* dst,
+   const struct rsrc_geometry* src);
+
+/* Save the geometry into a binary file that can be mapped back with the
+ * rsrc_load_geometry function. If src_path is not NULL, the path, size and
+ * modification time of the src_path file are saved as the key of the binary
+ * file. */
+RSRC_API enum rsrc_error
+rsrc_write_geometry
+  (const struct rsrc_geometry* geom,
+   const char* src_path, /* May be NULL. */
+   const char* path);
+
+/* Map the binary geometry file into the geometry. The primitive set data
+ * directly reference the mapped file until the geometry is cleared. The load
+ * fails if the file is corrupted or if its key does not match the current
+ * state of the src_path file. */
+RSRC_API enum rsrc_error
+rsrc_load_geometry
+  (struct rsrc_geometry* geom,
+   const char* src_path, /* May be NULL. */
+   const char* path);
+
+/* Apply the post processes defined by the combination of
+ * rsrc_optimization_flag. A mapped geometry cannot be optimized. */
+RSRC_API enum rsrc_error
+rsrc_optimize_geometry
+  (struct rsrc_geometry* geom,
+   int flags);
+
+/* Simplify the triangle primitive sets by collapsing their edges until their
+ * number of triangles is at most ratio times their current number of
+ * triangles, or until no edge can be collapsed without flipping a triangle.
+ * A vertex is collapsed onto one of its neighbours, i.e. the remaining
+ * vertices keep their attributes. The returned error estimates the maximum
+ * distance between the simplified and the initial surfaces, in the units of
+ * the positions. A mapped geometry cannot be simplified. */
+RSRC_API enum rsrc_error
+rsrc_simplify_geometry
+  (struct rsrc_geometry* geom,
+   float ratio, /* In [0, 1]. */
+   float* error); /* May be NULL. */
+
+/* Compute the statistics of the geometry. The vertex cache is simulated as a
+ * FIFO of cache_size entries. */
+RSRC_API enum rsrc_error
+rsrc_get_geometry_stats
+  (const struct rsrc_geometry* geom,
+   size_t cache_size,
+   struct rsrc_geometry_stats* stats);
+
 #endif /* RSRC_GEOMETRY_H */
 
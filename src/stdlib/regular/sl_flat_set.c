@@ -181,6 +181,70 @@ sl_flat_set_insert
   return SL_NO_ERROR;
 }
 
+EXPORT_SYM enum sl_error
+sl_flat_set_insert_n
+  (struct sl_flat_set* set,
+   size_t count,
+   const void* data)
+{
+  char* buffer = NULL;
+  char* src = NULL;
+  size_t len = 0;
+  size_t size = 0;
+  size_t id = 0;
+  size_t i = 0;
+  size_t j = 0;
+  size_t k = 0;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!set || (count && !data))
+    return SL_INVALID_ARGUMENT;
+  if(!count)
+    return SL_NO_ERROR;
+
+  SL(vector_buffer(set->vector, &len, &size, NULL, NULL));
+  for(i = 0; i < count; ++i) {
+    if(data_id(set, (const char*)data + i * size, &id, EXACT_VALUE))
+      return SL_INVALID_ARGUMENT;
+  }
+  /* The appended items are sorted past the len + count items of the merged
+   * set, from where they are merged backward. Note that sl_vector_push_back_n
+   * replicates a single item. */
+  err = sl_vector_resize(set->vector, len + 2 * count, NULL);
+  if(err != SL_NO_ERROR)
+    return err;
+  SL(vector_buffer(set->vector, NULL, NULL, NULL, (void**)&buffer));
+  src = buffer + (len + count) * size;
+  memcpy(src, data, count * size);
+
+  /* Sort the appended items to look for duplicates. */
+  qsort(src, count, size, set->compare);
+  for(i = 1; i < count; ++i) {
+    if(set->compare(src + (i - 1) * size, src + i * size) == 0) {
+      SL(vector_resize(set->vector, len, NULL));
+      return SL_INVALID_ARGUMENT;
+    }
+  }
+  /* Merge the two sorted ranges from their end. An item of the set is moved
+   * to a greater index than its own and thus never overwrites an item that
+   * is not merged yet. */
+  i = len;
+  j = count;
+  k = len + count;
+  while(j) {
+    --k;
+    if(i && set->compare(buffer + (i - 1) * size, src + (j - 1) * size) > 0) {
+      --i;
+      memcpy(buffer + k * size, buffer + i * size, size);
+    } else {
+      --j;
+      memcpy(buffer + k * size, src + j * size, size);
+    }
+  }
+  SL(vector_resize(set->vector, len + count, NULL));
+  return SL_NO_ERROR;
+}
+
 EXPORT_SYM enum sl_error
 sl_flat_set_find
   (struct sl_flat_set* set,
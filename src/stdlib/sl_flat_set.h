@@ -32,6 +32,15 @@ sl_flat_set_insert
    const void* data,
    size_t* insert_id); /* May be NULL. */
 
+/* Insert the count items of the data array at once. Fail if an item already
+ * lies into the set or is duplicated in the array; the set is then left
+ * unchanged. */
+SL_API enum sl_error
+sl_flat_set_insert_n
+  (struct sl_flat_set* set,
+   size_t count,
+   const void* data);
+
 SL_API enum sl_error
 sl_flat_set_erase
   (struct sl_flat_set* set,
@@ -19,7 +19,7 @@
 #else
   #include <time.h>
 
-  #define CURRENT_TIME__(time) clock_gettime(CLOCK_REALTIME, &(time)->val)
+  #define CURRENT_TIME__(time) clock_gettime(CLOCK_MONOTONIC, &(time)->val)
   #define GREATER_TIME_UNIT__(time) (time)->val.tv_sec
   #define SMALLER_TIME_UNIT__(time) (time)->val.tv_nsec
   #define GREATER_TO_SMALLER_TIME_UNIT__ 1000000000L
@@ -47,6 +47,8 @@ struct time {
   timeval_t val;
 };
 
+/* The time is read from the monotonic clock: it starts at an unspecified point
+ * and is not affected by the adjustments of the wall clock. */
 static FINLINE void
 current_time(struct time* time)
 {
@@ -87,6 +89,18 @@ time_val
   (const struct time* time,
    enum time_unit unit);
 
+/* Return a timestamp of a fast monotonic counter. It reads the time stamp
+ * counter of the CPU if it is invariant and the monotonic clock otherwise. The
+ * FOO_CLOCK=monotonic environment variable disables the time stamp counter. */
+SYS_API int64_t
+clock_ticks
+  (void);
+
+/* Convert a clock_ticks timestamp into nanoseconds of the monotonic clock. */
+SYS_API int64_t
+clock_ticks_to_nsec
+  (int64_t ticks);
+
 SYS_API void
 time_dump
   (const struct time* time,
@@ -95,7 +109,5 @@ time_dump
    char* dump, /* May be NULL. */
    size_t max_dump_len);
 
-
-
 #endif /* TIME. */
 
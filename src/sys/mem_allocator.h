@@ -55,6 +55,17 @@ struct mem_allocator {
 /* Default allocator. */
 extern struct mem_allocator mem_default_allocator;
 
+/* Allocator with the policy of the default allocator but with its own
+ * allocation counters. Allocators initialised by distinct calls can thus be
+ * used concurrently by distinct threads. */
+SYS_API void
+mem_init_regular_allocator
+  (struct mem_allocator* allocator);
+
+SYS_API void
+mem_shutdown_regular_allocator
+  (struct mem_allocator* allocator);
+
 #define MEM_ALLOC(allocator, size) \
   ((allocator)->alloc((allocator)->data, (size), __FILE__, __LINE__))
 
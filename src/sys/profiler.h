@@ -0,0 +1,71 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "sys/sys.h"
+#include <stdbool.h>
+#include <stdio.h>
+
+/*******************************************************************************
+ *
+ * CPU profiler zones. A zone records the clock_ticks at which it begins and
+ * ends into a ring buffer of the calling thread; the oldest zones are
+ * overwritten once the ring is full. Zones must be properly nested on a
+ * thread and their name must outlive the profiler, e.g. a string literal.
+ *
+ ******************************************************************************/
+#ifdef PROFILER_DISABLE
+  #define PROF_BEGIN(name) (void)0
+  #define PROF_END() (void)0
+  #define PROF_SCOPE(name) (void)0
+#else
+  #define PROF_BEGIN(name) prof_begin(name)
+  #define PROF_END() prof_end()
+  /* Profile the remaining of the enclosing block. It has to appear before any
+   * goto that jumps over its declaration. */
+  #define PROF_SCOPE(name) \
+    int CONCAT(prof_scope_, __LINE__) \
+      __attribute__((cleanup(prof_scope_end__))) UNUSED = \
+      (prof_begin(name), 0)
+#endif
+
+/* The profiler is disabled by default: zones cost a branch until then. */
+SYS_API void
+prof_enable
+  (bool enable);
+
+SYS_API bool
+prof_is_enabled
+  (void);
+
+SYS_API void
+prof_begin
+  (const char* name);
+
+SYS_API void
+prof_end
+  (void);
+
+/* Name the calling thread in the exported trace. */
+SYS_API void
+prof_thread_name
+  (const char* name);
+
+/* Discard the recorded zones of all threads. */
+SYS_API void
+prof_clear
+  (void);
+
+/* Write the recorded zones in the Chrome trace event format. The threads
+ * should not record zones during the dump. Return 0 on success. */
+SYS_API int
+prof_dump_chrome_trace
+  (FILE* stream);
+
+static FINLINE void
+prof_scope_end__(int* scope UNUSED)
+{
+  prof_end();
+}
+
+#endif /* PROFILER_H */
+
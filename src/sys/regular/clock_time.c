@@ -1,7 +1,16 @@
 #include "sys/clock_time.h"
 #include <inttypes.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
 
+#if defined(__x86_64__) || defined(__i386__)
+  #include <cpuid.h>
+  #include <x86intrin.h>
+  #define USE_TSC
+#endif
+
 #define NSEC_PER_USEC 1000L
 #define NSEC_PER_MSEC (1000L * NSEC_PER_USEC)
 #define NSEC_PER_SEC (1000L * NSEC_PER_MSEC)
@@ -116,6 +125,92 @@ time_dump
   }
 }
 
+/*******************************************************************************
+ *
+ * Ticks of the fast monotonic counter.
+ *
+ ******************************************************************************/
+/* Minimal duration over which the tick frequency is measured. */
+#define TICKS_CALIBRATION_NSEC (10L * NSEC_PER_MSEC)
+
+static struct {
+  bool use_tsc;
+  int64_t tsc0; /* Time stamp counter at the load of the library. */
+  int64_t nsec0; /* Monotonic clock at the load of the library. */
+  double nsec_per_tick; /* Calibrated once, by the first conversion. */
+  pthread_once_t calibration;
+} tsc_clock = { false, 0, 0, 0.0, PTHREAD_ONCE_INIT };
+
+static int64_t
+monotonic_nsec(void)
+{
+  struct time t;
+  current_time(&t);
+  return TIME_TO_NSEC__(&t);
+}
+
+static void __attribute__((constructor))
+init_ticks(void)
+{
+#ifdef USE_TSC
+  const char* env = getenv("FOO_CLOCK");
+  unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+
+  /* Only rely on an invariant time stamp counter, i.e. one ticking at a
+   * constant rate whatever the power state of the core. */
+  if((!env || strcmp(env, "monotonic") != 0)
+  && __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)
+  && (edx & BIT(8))) {
+    tsc_clock.use_tsc = true;
+    tsc_clock.nsec0 = monotonic_nsec();
+    tsc_clock.tsc0 = (int64_t)__rdtsc();
+  }
+#endif
+}
+
+#ifdef USE_TSC
+static void
+calibrate_ticks(void)
+{
+  int64_t nsec = 0;
+  int64_t tsc = 0;
+  /* Wait up to TICKS_CALIBRATION_NSEC after the load of the library. */
+  do {
+    nsec = monotonic_nsec();
+    tsc = (int64_t)__rdtsc();
+  } while(nsec - tsc_clock.nsec0 < TICKS_CALIBRATION_NSEC);
+  tsc_clock.nsec_per_tick =
+    (double)(nsec - tsc_clock.nsec0) / (double)(tsc - tsc_clock.tsc0);
+}
+#endif
+
+int64_t
+clock_ticks(void)
+{
+#ifdef USE_TSC
+  if(LIKELY(tsc_clock.use_tsc))
+    return (int64_t)__rdtsc();
+#endif
+  return monotonic_nsec();
+}
+
+int64_t
+clock_ticks_to_nsec(int64_t ticks)
+{
+#ifdef USE_TSC
+  if(!tsc_clock.use_tsc)
+    return ticks;
+
+  pthread_once(&tsc_clock.calibration, calibrate_ticks);
+  return tsc_clock.nsec0
+    + (int64_t)((double)(ticks - tsc_clock.tsc0) * tsc_clock.nsec_per_tick);
+#else
+  return ticks;
+#endif
+}
+
+#undef TICKS_CALIBRATION_NSEC
+#undef USE_TSC
 #undef NSEC_PER_USEC
 #undef NSEC_PER_MSEC
 #undef NSEC_PER_SEC
@@ -447,6 +447,42 @@ EXPORT_SYM struct mem_allocator mem_default_allocator = {
   .data = (void*) &default_alloc_counter
 };
 
+/*******************************************************************************
+ *
+ * Regular allocator.
+ *
+ ******************************************************************************/
+void
+mem_init_regular_allocator(struct mem_allocator* allocator)
+{
+  struct alloc_counter* alloc_counter = NULL;
+
+  if(!allocator)
+    return;
+
+  memset(allocator, 0, sizeof(struct mem_allocator));
+  alloc_counter = calloc(1, sizeof(struct alloc_counter));
+  if(!alloc_counter)
+    return;
+
+  allocator->alloc = default_alloc;
+  allocator->calloc = default_calloc;
+  allocator->realloc = default_realloc;
+  allocator->aligned_alloc = default_aligned_alloc;
+  allocator->free = default_free;
+  allocator->allocated_size = default_allocated_size;
+  allocator->dump = default_dump;
+  allocator->data = (void*)alloc_counter;
+}
+
+void
+mem_shutdown_regular_allocator(struct mem_allocator* allocator)
+{
+  assert(allocator && allocator->data != (void*)&default_alloc_counter);
+  free(allocator->data);
+  memset(allocator, 0, sizeof(struct mem_allocator));
+}
+
 /*******************************************************************************
  *
  * Proxy allocator.
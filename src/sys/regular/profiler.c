@@ -0,0 +1,208 @@
+#include "sys/clock_time.h"
+#include "sys/math.h"
+#include "sys/profiler.h"
+#include "sys/sys.h"
+#include <assert.h>
+#include <inttypes.h>
+#include <stdlib.h>
+
+#define PROF_RING_SIZE 16384 /* Must be a power of 2. */
+#define PROF_MAX_DEPTH 64
+
+struct prof_zone {
+  const char* name;
+  int64_t begin;
+  int64_t end;
+};
+
+struct prof_thread {
+  struct prof_thread* next;
+  const char* name;
+  unsigned int id;
+  /* Stack of the opened zones. */
+  struct prof_zone stack[PROF_MAX_DEPTH];
+  int depth;
+  /* Ring of the closed zones. */
+  struct prof_zone ring[PROF_RING_SIZE];
+  size_t nb_zones; /* Total number of zones pushed into the ring. */
+};
+
+STATIC_ASSERT(!(PROF_RING_SIZE & (PROF_RING_SIZE - 1)), Unexpected_ring_size);
+
+static struct {
+  struct prof_thread* thread_list; /* Updated atomically. */
+  unsigned int nb_threads;
+  volatile bool is_enabled;
+  int64_t epoch; /* Ticks of the first enabling. */
+} prof;
+
+static __thread struct prof_thread* prof_self = NULL;
+static __thread const char* prof_self_name = NULL;
+
+/*******************************************************************************
+ *
+ * Helper functions.
+ *
+ ******************************************************************************/
+static struct prof_thread*
+get_thread(void)
+{
+  struct prof_thread* thread = prof_self;
+
+  if(UNLIKELY(thread == NULL)) {
+    thread = calloc(1, sizeof(struct prof_thread));
+    if(!thread)
+      return NULL;
+    thread->id = __sync_fetch_and_add(&prof.nb_threads, 1);
+    thread->name = prof_self_name;
+    do {
+      thread->next = prof.thread_list;
+    } while(!__sync_bool_compare_and_swap
+      (&prof.thread_list, thread->next, thread));
+    prof_self = thread;
+  }
+  return thread;
+}
+
+static void
+dump_string(FILE* stream, const char* str)
+{
+  assert(stream && str);
+  fputc('"', stream);
+  for(; *str; ++str) {
+    if(*str == '"' || *str == '\\')
+      fputc('\\', stream);
+    fputc(*str, stream);
+  }
+  fputc('"', stream);
+}
+
+static void __attribute__((destructor))
+release_threads(void)
+{
+  struct prof_thread* thread = prof.thread_list;
+  while(thread) {
+    struct prof_thread* next = thread->next;
+    free(thread);
+    thread = next;
+  }
+  prof.thread_list = NULL;
+}
+
+/*******************************************************************************
+ *
+ * Profiler functions.
+ *
+ ******************************************************************************/
+void
+prof_enable(bool enable)
+{
+  if(enable && !prof.epoch)
+    prof.epoch = clock_ticks();
+  prof.is_enabled = enable;
+}
+
+bool
+prof_is_enabled(void)
+{
+  return prof.is_enabled;
+}
+
+void
+prof_begin(const char* name)
+{
+  struct prof_thread* thread = NULL;
+
+  assert(name);
+  if(LIKELY(!prof.is_enabled))
+    return;
+  thread = get_thread();
+  if(UNLIKELY(!thread))
+    return;
+  /* Zones deeper than the stack are counted but not recorded. */
+  if(thread->depth < PROF_MAX_DEPTH) {
+    thread->stack[thread->depth].name = name;
+    thread->stack[thread->depth].begin = clock_ticks();
+  }
+  ++thread->depth;
+}
+
+void
+prof_end(void)
+{
+  struct prof_thread* thread = prof_self;
+
+  /* The thread may have no opened zone if the profiler was enabled after the
+   * zone began. Closing it is thus not an error. */
+  if(!thread || thread->depth == 0)
+    return;
+  --thread->depth;
+  if(thread->depth < PROF_MAX_DEPTH) {
+    struct prof_zone* zone =
+      thread->ring + (thread->nb_zones & (PROF_RING_SIZE - 1));
+    *zone = thread->stack[thread->depth];
+    zone->end = clock_ticks();
+    ++thread->nb_zones;
+  }
+}
+
+void
+prof_thread_name(const char* name)
+{
+  /* The name is kept until the thread records its first zone. */
+  prof_self_name = name;
+  if(prof_self)
+    prof_self->name = name;
+}
+
+void
+prof_clear(void)
+{
+  struct prof_thread* thread = NULL;
+  for(thread = prof.thread_list; thread; thread = thread->next)
+    thread->nb_zones = 0;
+}
+
+int
+prof_dump_chrome_trace(FILE* stream)
+{
+  struct prof_thread* thread = NULL;
+  const int64_t epoch = clock_ticks_to_nsec(prof.epoch);
+  bool is_first = true;
+
+  if(!stream)
+    return -1;
+
+  fprintf(stream, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+  for(thread = prof.thread_list; thread; thread = thread->next) {
+    const size_t nb_zones = thread->nb_zones;
+    size_t i = nb_zones > PROF_RING_SIZE ? nb_zones - PROF_RING_SIZE : 0;
+
+    if(thread->name) {
+      fprintf(stream, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\","
+        "\"pid\":0,\"tid\":%u,\"args\":{\"name\":", is_first ? "" : ",",
+        thread->id);
+      dump_string(stream, thread->name);
+      fprintf(stream, "}}");
+      is_first = false;
+    }
+    for(; i < nb_zones; ++i) {
+      const struct prof_zone* zone = thread->ring + (i & (PROF_RING_SIZE - 1));
+      const int64_t begin = MAX(clock_ticks_to_nsec(zone->begin) - epoch, 0);
+      const int64_t end = MAX(clock_ticks_to_nsec(zone->end) - epoch, begin);
+
+      fprintf(stream, "%s\n{\"name\":", is_first ? "" : ",");
+      dump_string(stream, zone->name);
+      fprintf(stream, ",\"ph\":\"X\",\"pid\":0,\"tid\":%u,"
+        "\"ts\":%" PRIi64 ".%03" PRIi64 ",\"dur\":%" PRIi64 ".%03" PRIi64 "}",
+        thread->id, begin / 1000, begin % 1000,
+        (end - begin) / 1000, (end - begin) % 1000);
+      is_first = false;
+    }
+  }
+  fprintf(stream, "\n]}\n");
+  return ferror(stream) ? -1 : 0;
+}
+
+#undef PROF_RING_SIZE
+#undef PROF_MAX_DEPTH
@@ -1,4 +1,5 @@
 #include "app/core/app_core.h"
+#include "app/core/app_cvar.h"
 #include "app/core/app_view.h"
 #include "sys/mem_allocator.h"
 #include "utest/utest.h"
@@ -11,6 +12,7 @@ main(int argc, char** argv)
 {
   struct app_args args = { NULL, NULL, NULL, NULL };
   struct app* app = NULL;
+  struct app_frame_stats stats;
   struct app_view* view = NULL;
   struct wm_device* wm = NULL;
   bool b = false;
@@ -31,6 +33,22 @@ main(int argc, char** argv)
   CHECK(app_run(NULL, &b), APP_INVALID_ARGUMENT);
   CHECK(app_run(app, &b), APP_NO_ERROR);
 
+  CHECK(app_get_frame_stats(NULL, NULL), APP_INVALID_ARGUMENT);
+  CHECK(app_get_frame_stats(app, NULL), APP_INVALID_ARGUMENT);
+  CHECK(app_get_frame_stats(NULL, &stats), APP_INVALID_ARGUMENT);
+  CHECK(app_get_frame_stats(app, &stats), APP_NO_ERROR);
+  CHECK(stats.nb_timed_frames, 0);
+  CHECK(app_set_cvar
+    (app, "app_show_stats", APP_CVAR_BOOL_VALUE(true)), APP_NO_ERROR);
+  CHECK(app_run(app, &b), APP_NO_ERROR);
+  CHECK(app_run(app, &b), APP_NO_ERROR);
+  CHECK(app_get_frame_stats(app, &stats), APP_NO_ERROR);
+  CHECK(stats.nb_timed_frames, 2);
+  CHECK(stats.frame_time.median <= stats.frame_time.p95, true);
+  CHECK(stats.frame_time.p95 <= stats.frame_time.max, true);
+  CHECK(stats.cpu_time.max <= stats.frame_time.max, true);
+  NCHECK(stats.allocated_size, 0);
+
   CHECK(app_get_window_manager_device(NULL, NULL), APP_INVALID_ARGUMENT);
   CHECK(app_get_window_manager_device(app, NULL), APP_INVALID_ARGUMENT);
   CHECK(app_get_window_manager_device(NULL, &wm), APP_INVALID_ARGUMENT);
@@ -42,6 +42,30 @@ static const char* load_model__ = NULL;
 static bool load_verbose_opt__ = false;
 static bool load_name_opt__ = false;
 
+static void
+count_calls
+  (struct app* app UNUSED,
+   size_t argc UNUSED,
+   const struct app_cmdarg** argv UNUSED,
+   void* data)
+{
+  ++(*(int*)data);
+}
+
+static void
+count_defined_values
+  (struct app* app UNUSED,
+   size_t argc,
+   const struct app_cmdarg** argv,
+   void* data)
+{
+  size_t i = 0;
+  CHECK(argc, 2);
+  *(size_t*)data = 0;
+  for(i = 0; i < argv[1]->count; ++i)
+    *(size_t*)data += argv[1]->value_list[i].is_defined;
+}
+
 static void
 load
   (struct app* app UNUSED, 
@@ -402,6 +426,7 @@ main(int argc, char **argv)
   struct app* app = NULL;
   const char** lst = NULL;
   size_t len = 0;
+  int nb_calls[5] = { 0, 0, 0, 0, 0 };
   bool b = false;
 
   if(argc != 2) {
@@ -458,6 +483,85 @@ main(int argc, char **argv)
   CHECK(app_execute_command(app, "__foo -vV"), CMD_ERR);
   CHECK(app_del_command(app, "__foo"), OK);
 
+  CHECK(app_add_command
+    (app, "__ovl", count_calls, &nb_calls[0], NULL,
+     APP_CMDARGV
+      (APP_CMDARG_APPEND_INT("i", NULL, NULL, NULL, 1, 1, INT_MIN, INT_MAX),
+       APP_CMDARG_END),
+      NULL),
+    OK);
+  CHECK(app_add_command
+    (app, "__ovl", count_calls, &nb_calls[1], NULL,
+     APP_CMDARGV
+      (APP_CMDARG_APPEND_STRING("s", NULL, NULL, NULL, 1, 1, NULL),
+       APP_CMDARG_END),
+      NULL),
+    OK);
+  CHECK(app_execute_command(app, "__ovl -i 1"), OK);
+  CHECK(app_execute_command(app, "__ovl -s a"), OK);
+  CHECK(app_execute_command(app, "__ovl -s b"), OK);
+  CHECK(app_execute_command(app, "__ovl -i 2"), OK);
+  CHECK(app_execute_command(app, "__ovl -i3"), OK);
+  CHECK(app_execute_command(app, "__ovl"), CMD_ERR);
+  CHECK(app_execute_command(app, "__ovl -i"), CMD_ERR);
+  CHECK(app_execute_command(app, "__ovl -i 1 -s a"), CMD_ERR);
+  CHECK(nb_calls[0], 3);
+  CHECK(nb_calls[1], 2);
+  CHECK(app_add_command
+    (app, "__ovl", count_calls, &nb_calls[2], NULL,
+     APP_CMDARGV
+      (APP_CMDARG_APPEND_INT("i", NULL, NULL, NULL, 1, 1, INT_MIN, INT_MAX),
+       APP_CMDARG_APPEND_STRING("s", NULL, NULL, NULL, 1, 1, NULL),
+       APP_CMDARG_END),
+      NULL),
+    OK);
+  CHECK(app_execute_command(app, "__ovl -i 1 -s a"), OK);
+  CHECK(app_execute_command(app, "__ovl -s a"), OK);
+  CHECK(nb_calls[1], 3);
+  CHECK(nb_calls[2], 1);
+  CHECK(app_del_command(app, "__ovl"), OK);
+  CHECK(app_execute_command(app, "__ovl -s a"), CMD_ERR);
+
+  /* The values that are not set by a line are not defined, whatever the
+   * previous line. */
+  CHECK(app_add_command
+    (app, "__vals", count_defined_values, &len, NULL,
+     APP_CMDARGV
+      (APP_CMDARG_APPEND_INT("i", NULL, NULL, NULL, 0, 3, INT_MIN, INT_MAX),
+       APP_CMDARG_END),
+      NULL),
+    OK);
+  CHECK(app_execute_command(app, "__vals -i 1 -i 2"), OK);
+  CHECK(len, 2);
+  CHECK(app_execute_command(app, "__vals"), OK);
+  CHECK(len, 0);
+  CHECK(app_execute_command(app, "__vals -i 3"), OK);
+  CHECK(len, 1);
+  CHECK(app_del_command(app, "__vals"), OK);
+
+  /* The last added syntax that accepts a line is invoked whatever the syntax
+   * that accepted the previous line of the same arity. */
+  CHECK(app_add_command
+    (app, "__ord", count_calls, &nb_calls[4], NULL,
+     APP_CMDARGV
+      (APP_CMDARG_APPEND_STRING("i", NULL, NULL, NULL, 1, 1, NULL),
+       APP_CMDARG_END),
+      NULL),
+    OK);
+  CHECK(app_add_command
+    (app, "__ord", count_calls, &nb_calls[3], NULL,
+     APP_CMDARGV
+      (APP_CMDARG_APPEND_INT("i", NULL, NULL, NULL, 1, 1, INT_MIN, INT_MAX),
+       APP_CMDARG_END),
+      NULL),
+    OK);
+  CHECK(app_execute_command(app, "__ord -i a"), OK);
+  CHECK(app_execute_command(app, "__ord -i 1"), OK);
+  CHECK(app_execute_command(app, "__ord -i b"), OK);
+  CHECK(nb_calls[3], 1);
+  CHECK(nb_calls[4], 2);
+  CHECK(app_del_command(app, "__ord"), OK);
+
   CHECK(app_add_command
     (app, "__load", load, NULL, NULL,
      APP_CMDARGV
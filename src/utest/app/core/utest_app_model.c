@@ -1,6 +1,8 @@
 #include "app/core/app.h"
+#include "app/core/app_cvar.h"
 #include "app/core/app_model.h"
 #include "app/core/app_model_instance.h"
+#include "app/core/app_view.h"
 #include "app/core/app_world.h"
 #include "maths/simd/aosf44.h"
 #include "sys/mem_allocator.h"
@@ -9,11 +11,17 @@
 #include "utest/utest.h"
 #include <float.h>
 #include <math.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #define PATH "/tmp/cube.obj"
+#define RELOAD_PATH "/tmp/reload_box.obj"
+#define LOD_PATH "/tmp/lod_grid.obj"
+#define WALL_PATH "/tmp/occluder_wall.obj"
+#define BOX_PATH "/tmp/occluded_box.obj"
 
 #define OK APP_NO_ERROR
 #define BAD_ARG APP_INVALID_ARGUMENT
@@ -757,6 +765,680 @@ test_app_model_instance_bound(struct app* app)
   CHECK(app_model_instance_ref_put(inst), OK);
 }
 
+static void
+test_app_model_instantiate_n(struct app* app)
+{
+  struct aosf44 transform_list[3];
+  const char* name_list[3] = { "bulk0", NULL, "bulk2" };
+  struct app_model* model = NULL;
+  struct app_model* model1 = NULL;
+  struct app_model_instance* list[3] = { NULL, NULL, NULL };
+  struct app_world* world = NULL;
+  struct app_world* world1 = NULL;
+  const char* cstr = NULL;
+  size_t i = 0;
+
+  CHECK(app_create_model(app, PATH, NULL, &model), OK);
+  for(i = 0; i < 3; ++i) {
+    aosf44_identity(transform_list + i);
+    transform_list[i].c3 = vf4_set((float)i, 1.f, 2.f, 1.f);
+  }
+
+  CHECK(app_instantiate_model_n(NULL, NULL, 0, NULL, NULL, NULL), BAD_ARG);
+  CHECK(app_instantiate_model_n(app, NULL, 0, NULL, NULL, NULL), BAD_ARG);
+  CHECK(app_instantiate_model_n(app, model, 0, NULL, NULL, NULL), OK);
+  CHECK(app_instantiate_model_n(app, model, 3, NULL, NULL, NULL), BAD_ARG);
+  /* The list is not released on invalid arguments, whatever its content. */
+  memset(list, 0xFF, sizeof(list));
+  CHECK(app_instantiate_model_n
+    (NULL, model, 3, name_list, transform_list, list), BAD_ARG);
+  CHECK(app_instantiate_model_n
+    (app, NULL, 3, name_list, transform_list, list), BAD_ARG);
+  CHECK((uintptr_t)list[0], UINTPTR_MAX);
+  memset(list, 0, sizeof(list));
+  CHECK(app_instantiate_model_n
+    (app, model, 3, name_list, transform_list, list), OK);
+
+  CHECK(app_model_instance_name(list[0], &cstr), OK);
+  CHECK(strcmp(cstr, "bulk0"), 0);
+  CHECK(app_model_instance_name(list[1], &cstr), OK);
+  CHECK(strncmp(cstr, "unamed", 6), 0);
+  CHECK(app_model_instance_name(list[2], &cstr), OK);
+  CHECK(strcmp(cstr, "bulk2"), 0);
+  for(i = 0; i < 3; ++i) {
+    CHECK(app_model_instance_get_model(list[i], &model1), OK);
+    CHECK(model1, model);
+  }
+  CHECK_TRANSFORM(list[2],
+    1.f, 0.f, 0.f, 0.f,
+    0.f, 1.f, 0.f, 0.f,
+    0.f, 0.f, 1.f, 0.f,
+    2.f, 1.f, 2.f, 1.f);
+
+  CHECK(app_get_main_world(app, &world), OK);
+  CHECK(app_world_add_model_instances(world, 3, list), OK);
+  CHECK(app_world_add_model_instances(world, 1, list + 1), BAD_ARG);
+  for(i = 0; i < 3; ++i) {
+    CHECK(app_model_instance_world(list[i], &world1), OK);
+    CHECK(world1, world);
+  }
+  CHECK(app_world_remove_model_instances(world, 3, list), OK);
+
+  for(i = 0; i < 3; ++i)
+    CHECK(app_remove_model_instance(list[i]), OK);
+  CHECK(app_model_ref_put(model), OK);
+}
+
+struct transform_status {
+  struct app_model_instance* list[4];
+  size_t nb_instances;
+  size_t count;
+};
+
+static void
+transform_cbk
+  (struct app_model_instance* list[],
+   size_t nb_instances,
+   void* data)
+{
+  struct transform_status* status = data;
+  size_t i = 0;
+  for(i = 0; i < nb_instances && i < 4; ++i)
+    status->list[i] = list[i];
+  status->nb_instances = nb_instances;
+  ++status->count;
+}
+
+static void
+test_app_model_instance_commit(struct app* app)
+{
+  struct transform_status status;
+  struct app_model* model = NULL;
+  struct app_model_instance* list[3] = { NULL, NULL, NULL };
+  bool keep_running = false;
+
+  memset(&status, 0, sizeof(status));
+  CHECK(app_create_model(app, PATH, NULL, &model), OK);
+  CHECK(app_instantiate_model_n(app, model, 3, NULL, NULL, list), OK);
+  CHECK(app_attach_callback
+    (app, APP_SIGNAL_TRANSFORM_MODEL_INSTANCES, APP_CALLBACK(transform_cbk),
+     &status), OK);
+
+  /* The transforms are committed once per frame whatever the number of times
+   * the instances are transformed. */
+  CHECK(app_translate_model_instances
+    (list, 2, false, (float[]){1.f, 0.f, 0.f}), OK);
+  CHECK(app_translate_model_instances
+    (list, 1, false, (float[]){1.f, 0.f, 0.f}), OK);
+  CHECK(app_move_model_instances(list + 2, 1, (float[]){0.f, 0.f, 3.f}), OK);
+  CHECK(app_scale_model_instances
+    (list + 1, 1, true, (float[]){2.f, 2.f, 2.f}), OK);
+  CHECK(status.count, 0);
+  CHECK_TRANSFORM(list[0],
+    1.f, 0.f, 0.f, 0.f,
+    0.f, 1.f, 0.f, 0.f,
+    0.f, 0.f, 1.f, 0.f,
+    2.f, 0.f, 0.f, 1.f);
+
+  /* A released instance is not committed. */
+  CHECK(app_remove_model_instance(list[2]), OK);
+  list[2] = NULL;
+
+  CHECK(app_run(app, &keep_running), OK);
+  CHECK(status.count, 1);
+  CHECK(status.nb_instances, 2);
+  CHECK(status.list[0] == list[0] || status.list[0] == list[1], true);
+  CHECK(status.list[1] == list[0] || status.list[1] == list[1], true);
+  CHECK(status.list[0] != status.list[1], true);
+
+  CHECK(app_run(app, &keep_running), OK);
+  CHECK(status.count, 1);
+
+  /* Identity transformations do not flag the instances. */
+  CHECK(app_translate_model_instances
+    (list, 2, true, (float[]){0.f, 0.f, 0.f}), OK);
+  CHECK(app_run(app, &keep_running), OK);
+  CHECK(status.count, 1);
+
+  CHECK(app_rotate_model_instances
+    (list + 1, 1, false, (float[]){0.f, 1.f, 0.f}), OK);
+  CHECK(app_run(app, &keep_running), OK);
+  CHECK(status.count, 2);
+  CHECK(status.nb_instances, 1);
+  CHECK(status.list[0], list[1]);
+
+  CHECK(app_detach_callback
+    (app, APP_SIGNAL_TRANSFORM_MODEL_INSTANCES, APP_CALLBACK(transform_cbk),
+     &status), OK);
+  CHECK(app_remove_model_instance(list[0]), OK);
+  CHECK(app_remove_model_instance(list[1]), OK);
+  CHECK(app_model_ref_put(model), OK);
+}
+
+static void
+check_world_position
+  (const struct app_model_instance* instance,
+   const float x,
+   const float y,
+   const float z)
+{
+  ALIGN(16) float m[16];
+  struct aosf44 f44;
+  CHECK(app_get_model_instance_world_transform(instance, &f44), OK);
+  aosf44_store(m, &f44);
+  CHECK(fabsf(m[12] - x) < 1.e-5f, true);
+  CHECK(fabsf(m[13] - y) < 1.e-5f, true);
+  CHECK(fabsf(m[14] - z) < 1.e-5f, true);
+}
+
+static void
+test_app_model_instance_hierarchy(struct app* app)
+{
+  #define NB_CHILDREN 1024
+  #define DEPTH 64
+  struct transform_status status;
+  struct app_model* model = NULL;
+  struct app_model_instance* list[3] = { NULL, NULL, NULL };
+  struct app_model_instance** children = NULL;
+  struct app_model_instance* parent = NULL;
+  struct aosf44 f44;
+  float min0[3], max0[3], min1[3], max1[3];
+  bool keep_running = false;
+  size_t i = 0;
+
+  memset(&status, 0, sizeof(status));
+  children = malloc(NB_CHILDREN * sizeof(struct app_model_instance*));
+  NCHECK(children, NULL);
+  CHECK(app_create_model(app, PATH, NULL, &model), OK);
+  CHECK(app_instantiate_model_n(app, model, 3, NULL, NULL, list), OK);
+  CHECK(app_attach_callback
+    (app, APP_SIGNAL_TRANSFORM_MODEL_INSTANCES, APP_CALLBACK(transform_cbk),
+     &status), OK);
+
+  CHECK(app_set_model_instance_parent(NULL, NULL), BAD_ARG);
+  CHECK(app_set_model_instance_parent(NULL, list[0]), BAD_ARG);
+  CHECK(app_set_model_instance_parent(list[0], list[0]), BAD_ARG);
+  CHECK(app_set_model_instance_parent(list[0], NULL), OK);
+  CHECK(app_set_model_instance_parent(list[1], list[0]), OK);
+  CHECK(app_set_model_instance_parent(list[2], list[1]), OK);
+  CHECK(app_set_model_instance_parent(list[0], list[2]), BAD_ARG);
+  CHECK(app_get_model_instance_parent(NULL, NULL), BAD_ARG);
+  CHECK(app_get_model_instance_parent(list[0], NULL), BAD_ARG);
+  CHECK(app_get_model_instance_parent(NULL, &parent), BAD_ARG);
+  CHECK(app_get_model_instance_parent(list[0], &parent), OK);
+  CHECK(parent, NULL);
+  CHECK(app_get_model_instance_parent(list[2], &parent), OK);
+  CHECK(parent, list[1]);
+  CHECK(app_get_model_instance_world_transform(NULL, NULL), BAD_ARG);
+  CHECK(app_get_model_instance_world_transform(list[0], NULL), BAD_ARG);
+  CHECK(app_get_model_instance_world_transform(NULL, &f44), BAD_ARG);
+
+  /* The raw transforms are relative to the parent. */
+  CHECK(app_translate_model_instances
+    (list, 1, false, (float[]){1.f, 0.f, 0.f}), OK);
+  CHECK(app_translate_model_instances
+    (list + 1, 1, false, (float[]){0.f, 1.f, 0.f}), OK);
+  CHECK(app_translate_model_instances
+    (list + 2, 1, false, (float[]){0.f, 0.f, 1.f}), OK);
+  check_world_position(list[2], 1.f, 1.f, 1.f);
+  CHECK_TRANSFORM(list[2],
+    1.f, 0.f, 0.f, 0.f,
+    0.f, 1.f, 0.f, 0.f,
+    0.f, 0.f, 1.f, 0.f,
+    0.f, 0.f, 1.f, 1.f);
+  CHECK(app_scale_model_instances
+    (list, 1, false, (float[]){2.f, 2.f, 2.f}), OK);
+  check_world_position(list[0], 2.f, 0.f, 0.f);
+  check_world_position(list[2], 2.f, 2.f, 2.f);
+
+  /* The bounds are in world space. */
+  CHECK(app_get_model_instance_aabb(list[0], min0, max0), OK);
+  CHECK(app_get_model_instance_aabb(list[2], min1, max1), OK);
+  CHECK_EPS(min1[0] - min0[0], 0.f);
+  CHECK_EPS(min1[1] - min0[1], 2.f);
+  CHECK_EPS(max1[2] - max0[2], 2.f);
+
+  CHECK(app_run(app, &keep_running), OK);
+  CHECK(status.count, 1);
+  CHECK(status.nb_instances, 3);
+
+  /* Only the dirty subtrees are updated. */
+  CHECK(app_translate_model_instances
+    (list + 2, 1, false, (float[]){0.f, 0.f, 1.f}), OK);
+  CHECK(app_commit_model_instance_transforms(NULL), BAD_ARG);
+  CHECK(app_commit_model_instance_transforms(app), OK);
+  CHECK(status.count, 2);
+  CHECK(status.nb_instances, 1);
+  CHECK(status.list[0], list[2]);
+  CHECK(app_commit_model_instance_transforms(app), OK);
+  CHECK(status.count, 2);
+  CHECK(app_translate_model_instances
+    (list + 1, 1, false, (float[]){0.f, 0.f, 1.f}), OK);
+  CHECK(app_translate_model_instances
+    (list + 2, 1, false, (float[]){0.f, 0.f, 1.f}), OK);
+  CHECK(app_commit_model_instance_transforms(app), OK);
+  CHECK(status.count, 3);
+  CHECK(status.nb_instances, 2);
+
+  /* Detach an instance. */
+  CHECK(app_set_model_instance_parent(list[2], NULL), OK);
+  check_world_position(list[2], 0.f, 0.f, 3.f);
+  CHECK(app_set_model_instance_parent(list[2], list[1]), OK);
+  check_world_position(list[2], 2.f, 2.f, 8.f);
+
+  /* The children of a released instance keep their world transform. */
+  CHECK(app_remove_model_instance(list[1]), OK);
+  list[1] = NULL;
+  CHECK(app_get_model_instance_parent(list[2], &parent), OK);
+  CHECK(parent, NULL);
+  check_world_position(list[2], 2.f, 2.f, 8.f);
+  CHECK(app_commit_model_instance_transforms(app), OK);
+  CHECK(status.nb_instances, 1);
+  CHECK(status.list[0], list[2]);
+
+  /* Wide hierarchy. */
+  CHECK(app_instantiate_model_n
+    (app, model, NB_CHILDREN, NULL, NULL, children), OK);
+  for(i = 0; i < NB_CHILDREN; ++i) {
+    CHECK(app_set_model_instance_parent(children[i], list[0]), OK);
+  }
+  CHECK(app_commit_model_instance_transforms(app), OK);
+  CHECK(status.nb_instances, NB_CHILDREN);
+  CHECK(app_translate_model_instances
+    (list, 1, false, (float[]){0.f, 1.f, 0.f}), OK);
+  CHECK(app_commit_model_instance_transforms(app), OK);
+  CHECK(status.nb_instances, NB_CHILDREN + 1);
+  check_world_position(children[NB_CHILDREN - 1], 2.f, 1.f, 0.f);
+  for(i = 0; i < NB_CHILDREN; ++i)
+    CHECK(app_remove_model_instance(children[i]), OK);
+
+  /* Deep hierarchy. */
+  CHECK(app_instantiate_model_n(app, model, DEPTH, NULL, NULL, children), OK);
+  for(i = 1; i < DEPTH; ++i) {
+    CHECK(app_set_model_instance_parent(children[i], children[i - 1]), OK);
+  }
+  CHECK(app_translate_model_instances
+    (children, DEPTH, false, (float[]){1.f, 0.f, 0.f}), OK);
+  CHECK(app_commit_model_instance_transforms(app), OK);
+  CHECK(status.nb_instances, DEPTH);
+  check_world_position(children[DEPTH - 1], (float)DEPTH, 0.f, 0.f);
+  CHECK(app_set_model_instance_parent(children[0], children[DEPTH-1]),BAD_ARG);
+  /* Release the root first. */
+  for(i = 0; i < DEPTH; ++i)
+    CHECK(app_remove_model_instance(children[i]), OK);
+
+  CHECK(app_detach_callback
+    (app, APP_SIGNAL_TRANSFORM_MODEL_INSTANCES, APP_CALLBACK(transform_cbk),
+     &status), OK);
+  CHECK(app_remove_model_instance(list[0]), OK);
+  CHECK(app_remove_model_instance(list[2]), OK);
+  CHECK(app_model_ref_put(model), OK);
+  free(children);
+  #undef NB_CHILDREN
+  #undef DEPTH
+}
+
+struct load_status {
+  struct app_model* model;
+  enum app_error err;
+  size_t count;
+};
+
+static void
+load_cbk(struct app_model* model, enum app_error err, void* data)
+{
+  struct load_status* status = data;
+  status->model = model;
+  status->err = err;
+  ++status->count;
+}
+
+static void
+test_app_model_async(struct app* app)
+{
+  #define NB_MODELS 8
+  struct load_status status_list[NB_MODELS];
+  struct load_status status;
+  struct app_model* model_list[NB_MODELS];
+  struct app_frame_stats stats;
+  struct app_model* model = NULL;
+  struct app_model_instance* instance = NULL;
+  struct app_world* world = NULL;
+  float min_bound[3];
+  float max_bound[3];
+  const char* cstr = NULL;
+  size_t i = 0;
+  size_t len = 0;
+  bool b = false;
+
+  memset(&status, 0, sizeof(status));
+  CHECK(app_create_model(app, NULL, "async", &model), OK);
+  CHECK(app_load_model_async(NULL, NULL, NULL, NULL), BAD_ARG);
+  CHECK(app_load_model_async(PATH, NULL, NULL, NULL), BAD_ARG);
+  CHECK(app_load_model_async(NULL, model, NULL, NULL), BAD_ARG);
+  CHECK(app_load_model_async(PATH, model, NULL, NULL), OK);
+  CHECK(app_flush_model_loads(NULL), BAD_ARG);
+  CHECK(app_flush_model_loads(app), OK);
+  CHECK(app_model_path(model, &cstr), OK);
+  CHECK(strcmp(cstr, PATH), 0);
+  CHECK(app_get_model_aabb(model, min_bound, max_bound), OK);
+  CHECK(min_bound[0] <= max_bound[0], true);
+
+  CHECK(app_load_model_async(PATH, model, load_cbk, &status), OK);
+  CHECK(app_flush_model_loads(app), OK);
+  CHECK(status.count, 1);
+  CHECK(status.model, model);
+  CHECK(status.err, OK);
+  CHECK(app_flush_model_loads(app), OK);
+  CHECK(status.count, 1);
+
+  /* Load error. */
+  memset(&status, 0, sizeof(status));
+  CHECK(app_load_model_async("/tmp/__no_such_file.obj", model, load_cbk,
+    &status), OK);
+  CHECK(app_flush_model_loads(app), OK);
+  CHECK(status.count, 1);
+  NCHECK(status.err, OK);
+  CHECK(app_model_path(model, &cstr), OK);
+  CHECK(cstr, NULL);
+
+  /* Model removed while it is loading. */
+  memset(&status, 0, sizeof(status));
+  CHECK(app_load_model_async(PATH, model, load_cbk, &status), OK);
+  CHECK(app_remove_model(model), OK);
+  CHECK(app_flush_model_loads(app), OK);
+  CHECK(status.count, 1);
+  NCHECK(status.err, OK);
+
+  /* Concurrent loads. */
+  for(i = 0; i < NB_MODELS; ++i) {
+    memset(status_list + i, 0, sizeof(struct load_status));
+    CHECK(app_create_model(app, NULL, NULL, model_list + i), OK);
+    CHECK(app_load_model_async
+      (PATH, model_list[i], load_cbk, status_list + i), OK);
+  }
+  CHECK(app_flush_model_loads(app), OK);
+  for(i = 0; i < NB_MODELS; ++i) {
+    CHECK(status_list[i].count, 1);
+    CHECK(status_list[i].model, model_list[i]);
+    CHECK(status_list[i].err, OK);
+    CHECK(app_model_path(model_list[i], &cstr), OK);
+    CHECK(strcmp(cstr, PATH), 0);
+  }
+
+  /* Instances spawned before the commit of the load are rendered. */
+  CHECK(app_create_model(app, NULL, "spawned", &model), OK);
+  CHECK(app_get_main_world(app, &world), OK);
+  CHECK(app_run(app, &b), OK);
+  CHECK(app_get_frame_stats(app, &stats), OK);
+  len = stats.nb_instances;
+  CHECK(app_load_model_async(PATH, model, NULL, NULL), OK);
+  CHECK(app_instantiate_model(app, model, "spawned0", &instance), OK);
+  CHECK(app_world_add_model_instances(world, 1, &instance), OK);
+  CHECK(app_flush_model_loads(app), OK);
+  CHECK(app_run(app, &b), OK);
+  CHECK(app_get_frame_stats(app, &stats), OK);
+  CHECK(stats.nb_instances, len + 1);
+  CHECK(app_remove_model(model), OK);
+
+  /* The cleanup waits for the pending loads. */
+  memset(&status, 0, sizeof(status));
+  CHECK(app_load_model_async(PATH, model_list[0], load_cbk, &status), OK);
+  CHECK(app_cleanup(app), OK);
+  CHECK(status.count, 1);
+  #undef NB_MODELS
+}
+
+/* Write a flat grid of 2 * nb * nb triangles. */
+static void
+write_grid(const char* path, int nb)
+{
+  FILE* fp = NULL;
+  int i = 0;
+  int j = 0;
+
+  fp = fopen(path, "w");
+  NCHECK(fp, NULL);
+  fprintf(fp, "g grid\n");
+  for(j = 0; j <= nb; ++j) {
+    for(i = 0; i <= nb; ++i)
+      fprintf(fp, "v %g %g 0\n", (float)i / (float)nb, (float)j / (float)nb);
+  }
+  fprintf(fp, "vt 0 0\nvn 0 0 1\n");
+  for(j = 0; j < nb; ++j) {
+    for(i = 0; i < nb; ++i) {
+      const int id = j * (nb + 1) + i + 1;
+      fprintf(fp, "f %d/1/1 %d/1/1 %d/1/1\n", id, id + 1, id + nb + 2);
+      fprintf(fp, "f %d/1/1 %d/1/1 %d/1/1\n", id, id + nb + 2, id + nb + 1);
+    }
+  }
+  CHECK(fclose(fp), 0);
+}
+
+/* Return the number of triangles drawn by the next frame. */
+static size_t
+draw_triangles(struct app* app)
+{
+  struct app_frame_stats stats;
+  bool b = false;
+
+  CHECK(app_run(app, &b), OK);
+  CHECK(app_get_frame_stats(app, &stats), OK);
+  return stats.nb_triangles;
+}
+
+static void
+test_app_model_lods(struct app* app)
+{
+  struct app_model* model_list[3];
+  struct app_model_instance* instance_list[3];
+  struct app_view* view = NULL;
+  struct app_world* world = NULL;
+  float pos[3] = { 0.5f, 0.5f, 8.f };
+  float target[3] = { 0.5f, 0.5f, 0.f };
+  float up[3] = { 0.f, 1.f, 0.f };
+  size_t nb_triangles = 0;
+  size_t i = 0;
+
+  write_grid(LOD_PATH, 16);
+  CHECK(app_get_main_view(app, &view), OK);
+  CHECK(app_look_at(view, pos, target, up), OK);
+  CHECK(app_get_main_world(app, &world), OK);
+
+  CHECK(app_set_cvar(app, "rsrc_model_lods", APP_CVAR_INT_VALUE(0)), OK);
+  CHECK(app_create_model(app, LOD_PATH, NULL, model_list + 0), OK);
+  CHECK(app_set_cvar(app, "rsrc_model_lods", APP_CVAR_INT_VALUE(3)), OK);
+  CHECK(app_create_model(app, LOD_PATH, NULL, model_list + 1), OK);
+  CHECK(app_create_model(app, NULL, NULL, model_list + 2), OK);
+  CHECK(app_load_model_async(LOD_PATH, model_list[2], NULL, NULL), OK);
+  CHECK(app_flush_model_loads(app), OK);
+  for(i = 0; i < 3; ++i) {
+    CHECK(app_instantiate_model
+      (app, model_list[i], NULL, instance_list + i), OK);
+  }
+
+  /* Without levels of detail the whole grid is drawn. */
+  nb_triangles = draw_triangles(app);
+  CHECK(app_world_add_model_instances(world, 1, instance_list + 0), OK);
+  CHECK(draw_triangles(app), nb_triangles + 512);
+  CHECK(app_world_remove_model_instances(world, 1, instance_list + 0), OK);
+
+  /* The flat grid is simplified without error. Its coarsest level is thus
+   * drawn, whether the model is loaded by the application or the loader. */
+  for(i = 1; i < 3; ++i) {
+    CHECK(app_world_add_model_instances(world, 1, instance_list + i), OK);
+    CHECK(draw_triangles(app) - nb_triangles <= 512 / 4, true);
+    CHECK(app_world_remove_model_instances(world, 1, instance_list + i), OK);
+  }
+
+  for(i = 0; i < 3; ++i) {
+    CHECK(app_remove_model_instance(instance_list[i]), OK);
+    CHECK(app_remove_model(model_list[i]), OK);
+  }
+  CHECK(remove(LOD_PATH), 0);
+}
+
+static void
+write_box(const char* path, float size)
+{
+  const int ids[] = {
+    1, 3, 4,  1, 4, 2,  5, 6, 8,  5, 8, 7,  1, 2, 6,  1, 6, 5,
+    3, 7, 8,  3, 8, 4,  1, 5, 7,  1, 7, 3,  2, 4, 8,  2, 8, 6
+  };
+  FILE* fp = NULL;
+  int i = 0;
+
+  fp = fopen(path, "w");
+  NCHECK(fp, NULL);
+  fprintf(fp, "g box\n");
+  for(i = 0; i < 8; ++i) {
+    fprintf(fp, "v %g %g %g\n",
+      i & 1 ? size : 0.f, i & 2 ? size : 0.f, i & 4 ? size : 0.f);
+  }
+  /* The texcoords and the normals are not significant. */
+  fprintf(fp, "vt 0 0\nvn 0 0 1\n");
+  for(i = 0; i < 36; i += 3)
+    fprintf(fp, "f %d/1/1 %d/1/1 %d/1/1\n", ids[i], ids[i+1], ids[i+2]);
+  CHECK(fclose(fp), 0);
+}
+
+/* Return the number of instances culled by the next frame. */
+static size_t
+cull_instances(struct app* app)
+{
+  struct app_frame_stats stats;
+  bool b = false;
+
+  CHECK(app_run(app, &b), OK);
+  CHECK(app_get_frame_stats(app, &stats), OK);
+  return stats.nb_culled_instances;
+}
+
+/* Run the application until the max bound of the model is size. */
+static bool
+wait_model_size(struct app* app, struct app_model* model, float size)
+{
+  float min_bound[3];
+  float max_bound[3];
+  const struct timespec delay = { .tv_sec = 0, .tv_nsec = 10000000 };
+  bool keep_running = true;
+  int i = 0;
+
+  for(i = 0; i < 200; ++i) {
+    CHECK(app_run(app, &keep_running), OK);
+    CHECK(app_get_model_aabb(model, min_bound, max_bound), OK);
+    if(max_bound[0] == size)
+      return true;
+    nanosleep(&delay, NULL);
+  }
+  return false;
+}
+
+static void
+test_app_model_occluder(struct app* app)
+{
+  struct app_model* wall = NULL;
+  struct app_model* box = NULL;
+  struct app_model_instance* instance_list[2];
+  struct app_view* view = NULL;
+  struct app_world* world = NULL;
+  float pos[3] = { 0.5f, 0.5f, 8.f };
+  float target[3] = { 0.5f, 0.5f, 0.f };
+  float up[3] = { 0.f, 1.f, 0.f };
+  size_t nb_culled = 0;
+  bool b = true;
+
+  write_grid(WALL_PATH, 1);
+  write_box(BOX_PATH, 1.f);
+  CHECK(app_get_main_view(app, &view), OK);
+  CHECK(app_look_at(view, pos, target, up), OK);
+  CHECK(app_get_main_world(app, &world), OK);
+
+  CHECK(app_create_model(app, WALL_PATH, NULL, &wall), OK);
+  CHECK(app_create_model(app, BOX_PATH, NULL, &box), OK);
+  CHECK(app_is_model_occluder(NULL, NULL), BAD_ARG);
+  CHECK(app_is_model_occluder(wall, NULL), BAD_ARG);
+  CHECK(app_is_model_occluder(NULL, &b), BAD_ARG);
+  CHECK(app_is_model_occluder(wall, &b), OK);
+  CHECK(b, false);
+
+  /* The wall lies between the view point and the box. */
+  CHECK(app_instantiate_model(app, wall, NULL, instance_list + 0), OK);
+  CHECK(app_scale_model_instances
+    (instance_list, 1, false, (float[]){64.f, 64.f, 1.f}), OK);
+  CHECK(app_translate_model_instances
+    (instance_list, 1, false, (float[]){-31.5f, -31.5f, 0.f}), OK);
+  CHECK(app_instantiate_model(app, box, NULL, instance_list + 1), OK);
+  CHECK(app_translate_model_instances
+    (instance_list + 1, 1, false, (float[]){0.f, 0.f, -10.f}), OK);
+  CHECK(app_world_add_model_instances(world, 2, instance_list), OK);
+  nb_culled = cull_instances(app);
+
+  CHECK(app_set_model_occluder(NULL, true), BAD_ARG);
+  CHECK(app_set_model_occluder(wall, true), OK);
+  CHECK(app_is_model_occluder(wall, &b), OK);
+  CHECK(b, true);
+  CHECK(cull_instances(app), nb_culled + 1);
+
+  /* The occluders follow the reloaded geometry. */
+  write_box(WALL_PATH, 2.f);
+  CHECK(wait_model_size(app, wall, 2.f), true);
+  CHECK(cull_instances(app), nb_culled + 1);
+
+  CHECK(app_set_model_occluder(wall, false), OK);
+  CHECK(app_is_model_occluder(wall, &b), OK);
+  CHECK(b, false);
+  CHECK(cull_instances(app), nb_culled);
+
+  CHECK(app_remove_model_instance(instance_list[0]), OK);
+  CHECK(app_remove_model_instance(instance_list[1]), OK);
+  CHECK(app_remove_model(wall), OK);
+  CHECK(app_remove_model(box), OK);
+  CHECK(remove(WALL_PATH), 0);
+  CHECK(remove(BOX_PATH), 0);
+}
+
+static void
+test_app_model_hot_reload(struct app* app)
+{
+  struct app_model* model = NULL;
+  struct app_model_instance* instance = NULL;
+  float min_bound[3];
+  float max_bound[3];
+  const char* cstr = NULL;
+  FILE* fp = NULL;
+
+  write_box(RELOAD_PATH, 1.f);
+  CHECK(app_create_model(app, RELOAD_PATH, "reload", &model), OK);
+  CHECK(app_instantiate_model(app, model, NULL, &instance), OK);
+  CHECK(app_get_model_aabb(model, min_bound, max_bound), OK);
+  CHECK(max_bound[0], 1.f);
+
+  /* The instances use the reloaded geometry. */
+  write_box(RELOAD_PATH, 2.f);
+  CHECK(wait_model_size(app, model, 2.f), true);
+  CHECK(app_get_model_instance_aabb(instance, min_bound, max_bound), OK);
+  CHECK(max_bound[0], 2.f);
+
+  /* An erroneous file does not replace the current geometry. */
+  fp = fopen(RELOAD_PATH, "w");
+  NCHECK(fp, NULL);
+  fprintf(fp, "f 1 2 a\n");
+  CHECK(fclose(fp), 0);
+  CHECK(wait_model_size(app, model, 3.f), false);
+  CHECK(app_get_model_aabb(model, min_bound, max_bound), OK);
+  CHECK(max_bound[0], 2.f);
+  CHECK(app_model_path(model, &cstr), OK);
+  CHECK(strcmp(cstr, RELOAD_PATH), 0);
+
+  write_box(RELOAD_PATH, 3.f);
+  CHECK(wait_model_size(app, model, 3.f), true);
+
+  CHECK(app_remove_model_instance(instance), OK);
+  CHECK(app_remove_model(model), OK);
+  CHECK(remove(RELOAD_PATH), 0);
+}
+
 int
 main(int argc, char** argv)
 {
@@ -1156,6 +1838,13 @@ main(int argc, char** argv)
 
   test_app_model_instance_transform(app);
   test_app_model_instance_bound(app);
+  test_app_model_instantiate_n(app);
+  test_app_model_instance_commit(app);
+  test_app_model_instance_hierarchy(app);
+  test_app_model_async(app);
+  test_app_model_lods(app);
+  test_app_model_occluder(app);
+  test_app_model_hot_reload(app);
   CHECK(app_ref_put(app), OK);
 
   CHECK(MEM_ALLOCATED_SIZE(&mem_default_allocator), 0);
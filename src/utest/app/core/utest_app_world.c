@@ -21,6 +21,7 @@ main(int argc, char** argv)
   struct app* app = NULL;
   struct app_model* model = NULL;
   struct app_model_instance* instances[2] = { NULL, NULL };
+  struct app_model_instance* instance = NULL;
   struct app_world* world = NULL;
   FILE* fp = NULL;
   size_t i = 0;
@@ -56,6 +57,26 @@ main(int argc, char** argv)
   CHECK(app_world_add_model_instances(world, 2, NULL), BAD_ARG);
   CHECK(app_world_add_model_instances(NULL, 2, instances), BAD_ARG);
   CHECK(app_world_add_model_instances(world, 2, instances), OK);
+  CHECK(app_world_add_model_instances(world, 1, instances), BAD_ARG);
+
+  CHECK(app_world_picked_model_instance(NULL, 0, NULL), BAD_ARG);
+  CHECK(app_world_picked_model_instance(world, 0, NULL), BAD_ARG);
+  CHECK(app_world_picked_model_instance(NULL, 0, &instance), BAD_ARG);
+  CHECK(app_world_picked_model_instance(world, 0, &instance), OK);
+  CHECK(instance, instances[0]);
+  CHECK(app_world_picked_model_instance(world, 1, &instance), OK);
+  CHECK(instance, instances[1]);
+  CHECK(app_world_picked_model_instance(world, 2, &instance), BAD_ARG);
+
+  /* The pick id of a removed instance is reused. */
+  CHECK(app_world_remove_model_instances(world, 1, &instances[0]), OK);
+  CHECK(app_world_picked_model_instance(world, 0, &instance), BAD_ARG);
+  CHECK(app_world_picked_model_instance(world, 1, &instance), OK);
+  CHECK(instance, instances[1]);
+  CHECK(app_world_add_model_instances(world, 1, &instances[0]), OK);
+  CHECK(app_world_picked_model_instance(world, 0, &instance), OK);
+  CHECK(instance, instances[0]);
+  CHECK(app_world_picked_model_instance(world, 2, &instance), BAD_ARG);
 
   CHECK(app_world_remove_model_instances(NULL, 0, NULL), BAD_ARG);
   CHECK(app_world_remove_model_instances(world, 0, NULL), OK);
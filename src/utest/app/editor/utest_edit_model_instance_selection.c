@@ -1,4 +1,5 @@
 #include "app/core/app.h"
+#include "app/core/app_command.h"
 #include "app/core/app_model.h"
 #include "app/core/app_model_instance.h"
 #include "app/editor/edit_context.h"
@@ -6,6 +7,7 @@
 #include "sys/mem_allocator.h"
 #include "utest/app/core/cube_obj.h"
 #include "utest/utest.h"
+#include <math.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -28,6 +30,8 @@ main(int argc, char** argv)
   float max[3] = { 0.f, 0.f, 0.f };
   float pivot[3] = { 0.f, 0.f, 0.f };
   float tmp[3] = { 0.f, 0.f, 0.f };
+  char cmd[128];
+  const char* name = NULL;
   size_t i = 0;
   bool b = false;
   bool b0 = false;
@@ -178,6 +182,13 @@ main(int argc, char** argv)
   CHECK(edit_get_model_instance_selection_pivot(selection, NULL), BAD_ARG);
   CHECK(edit_get_model_instance_selection_pivot(NULL, pivot), BAD_ARG);
   CHECK(edit_get_model_instance_selection_pivot(selection, pivot), OK);
+  CHECK(pivot[0], 0.f);
+  CHECK(pivot[1], 0.f);
+  CHECK(pivot[2], 0.f);
+
+  CHECK(edit_select_model_instance(selection, instance[2]), OK);
+  CHECK(edit_select_model_instance(selection, instance[3]), OK);
+  CHECK(edit_get_model_instance_selection_pivot(selection, pivot), OK);
   CHECK(app_get_model_instance_aabb(instance[2], min, max), APP_NO_ERROR);
   tmp[0] = (min[0] + max[0]) * 0.5f;
   tmp[1] = (min[1] + max[1]) * 0.5f;
@@ -190,6 +201,58 @@ main(int argc, char** argv)
   CHECK(pivot[1], tmp[1] * 0.5f);
   CHECK(pivot[2], tmp[2] * 0.5f);
 
+  /* The cached pivot follows the transformations of the selection. */
+  CHECK(edit_translate_model_instance_selection(NULL, NULL), BAD_ARG);
+  CHECK(edit_translate_model_instance_selection(selection, NULL), BAD_ARG);
+  CHECK(edit_translate_model_instance_selection
+    (selection, (float[]){1.f, -2.f, 0.5f}), OK);
+  CHECK(edit_get_model_instance_selection_pivot(selection, tmp), OK);
+  CHECK(fabsf(tmp[0] - (pivot[0] + 1.f)) < 1.e-5f, true);
+  CHECK(fabsf(tmp[1] - (pivot[1] - 2.f)) < 1.e-5f, true);
+  CHECK(fabsf(tmp[2] - (pivot[2] + 0.5f)) < 1.e-5f, true);
+  CHECK(edit_scale_model_instance_selection
+    (selection, true, (float[]){2.f, 2.f, 2.f}), OK);
+  CHECK(edit_get_model_instance_selection_pivot(selection, pivot), OK);
+  CHECK(fabsf(tmp[0] - pivot[0]) < 1.e-5f, true);
+  CHECK(fabsf(tmp[1] - pivot[1]) < 1.e-5f, true);
+  CHECK(fabsf(tmp[2] - pivot[2]) < 1.e-5f, true);
+
+  CHECK(edit_unselect_model_instance(selection, instance[2]), OK);
+  CHECK(edit_get_model_instance_selection_pivot(selection, pivot), OK);
+  CHECK(app_get_model_instance_aabb(instance[3], min, max), APP_NO_ERROR);
+  CHECK(fabsf(pivot[0] - (min[0] + max[0]) * 0.5f) < 1.e-5f, true);
+  CHECK(fabsf(pivot[1] - (min[1] + max[1]) * 0.5f) < 1.e-5f, true);
+  CHECK(fabsf(pivot[2] - (min[2] + max[2]) * 0.5f) < 1.e-5f, true);
+
+  /* The pivot follows the selected instances transformed by name. */
+  CHECK(app_model_instance_name(instance[3], &name), APP_NO_ERROR);
+  i = (size_t)snprintf
+    (cmd, sizeof(cmd), "translate -w -i %s -x 1 -y -2 -z 4", name);
+  CHECK(i < sizeof(cmd), true);
+  CHECK(app_execute_command(app, cmd), APP_NO_ERROR);
+  CHECK(app_commit_model_instance_transforms(app), APP_NO_ERROR);
+  CHECK(edit_get_model_instance_selection_pivot(selection, tmp), OK);
+  CHECK(fabsf(tmp[0] - (pivot[0] + 1.f)) < 1.e-5f, true);
+  CHECK(fabsf(tmp[1] - (pivot[1] - 2.f)) < 1.e-5f, true);
+  CHECK(fabsf(tmp[2] - (pivot[2] + 4.f)) < 1.e-5f, true);
+  CHECK(edit_draw_model_instance_selection(selection), OK);
+
+  /* The commit of a selection translation keeps the cached bounds while the
+   * next commit of an instance transformed by name still updates them. */
+  CHECK(edit_translate_model_instance_selection
+    (selection, (float[]){-1.f, 2.f, -4.f}), OK);
+  CHECK(app_commit_model_instance_transforms(app), APP_NO_ERROR);
+  CHECK(edit_get_model_instance_selection_pivot(selection, tmp), OK);
+  CHECK(fabsf(tmp[0] - pivot[0]) < 1.e-5f, true);
+  CHECK(fabsf(tmp[1] - pivot[1]) < 1.e-5f, true);
+  CHECK(fabsf(tmp[2] - pivot[2]) < 1.e-5f, true);
+  CHECK(app_execute_command(app, cmd), APP_NO_ERROR);
+  CHECK(app_commit_model_instance_transforms(app), APP_NO_ERROR);
+  CHECK(edit_get_model_instance_selection_pivot(selection, tmp), OK);
+  CHECK(fabsf(tmp[0] - (pivot[0] + 1.f)) < 1.e-5f, true);
+  CHECK(fabsf(tmp[1] - (pivot[1] - 2.f)) < 1.e-5f, true);
+  CHECK(fabsf(tmp[2] - (pivot[2] + 4.f)) < 1.e-5f, true);
+
   CHECK(edit_model_instance_selection_ref_get(NULL), BAD_ARG);
   CHECK(edit_model_instance_selection_ref_get(selection), OK);
   CHECK(edit_model_instance_selection_ref_put(NULL), BAD_ARG);
@@ -1,7 +1,53 @@
+#include "app/core/app_command.h"
 #include "app/core/app_core.h"
+#include "app/core/app_model.h"
+#include "app/core/app_model_instance.h"
 #include "app/editor/edit_context.h"
+#include "maths/simd/aosf44.h"
 #include "sys/mem_allocator.h"
+#include "utest/app/core/cube_obj.h"
 #include "utest/utest.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define MODEL_PATH "/tmp/cube.obj"
+#define MAP_PATH "/tmp/utest_editor.map"
+
+static void
+check_map(struct app* app, const char* cmd)
+{
+  struct app_model* mdl = NULL;
+  struct app_model_instance* instance = NULL;
+  const struct aosf44* f44 = NULL;
+  ALIGN(16) float m[16];
+  bool is_occluder = false;
+
+  CHECK(app_execute_command(app, cmd), APP_NO_ERROR);
+  CHECK(app_get_model(app, "cube", &mdl), APP_NO_ERROR);
+  NCHECK(mdl, NULL);
+  CHECK(app_is_model_occluder(mdl, &is_occluder), APP_NO_ERROR);
+  CHECK(is_occluder, true);
+  CHECK(app_get_model_instance(app, "inst1", &instance), APP_NO_ERROR);
+  NCHECK(instance, NULL);
+  CHECK(app_get_raw_model_instance_transform(instance, &f44), APP_NO_ERROR);
+  aosf44_store(m, f44);
+  CHECK(m[12], 1.f);
+  CHECK(m[13], 2.f);
+  CHECK(m[14], 3.f);
+  CHECK(m[15], 1.f);
+  CHECK(app_get_model_instance(app, "inst0", &instance), APP_NO_ERROR);
+  NCHECK(instance, NULL);
+  /* The child of inst1 is saved with its world transform. */
+  CHECK(app_get_model_instance(app, "inst2", &instance), APP_NO_ERROR);
+  NCHECK(instance, NULL);
+  CHECK(app_get_raw_model_instance_transform(instance, &f44), APP_NO_ERROR);
+  aosf44_store(m, f44);
+  CHECK(m[12], 2.f);
+  CHECK(m[13], 2.f);
+  CHECK(m[14], 3.f);
+}
 
 int
 main(int argc, char** argv)
@@ -9,6 +55,10 @@ main(int argc, char** argv)
   struct app_args args = { NULL, NULL, NULL, NULL };
   struct app* app = NULL;
   struct edit_context* edit = NULL;
+  struct app_model_instance* instance = NULL;
+  struct app_model_instance* child = NULL;
+  FILE* file = NULL;
+  char magic[4];
 
   if(argc != 2) {
     printf("usage: %s RB_DRIVER\n", argv[0]);
@@ -26,6 +76,53 @@ main(int argc, char** argv)
   CHECK(edit_run(NULL), EDIT_INVALID_ARGUMENT);
   CHECK(edit_run(edit), EDIT_NO_ERROR);
 
+  file = fopen(MODEL_PATH, "w");
+  NCHECK(file, NULL);
+  fwrite(cube_obj, sizeof(char), strlen(cube_obj), file);
+  fclose(file);
+  CHECK(app_execute_command
+    (app, "load -m " MODEL_PATH " -n cube"), APP_NO_ERROR);
+  CHECK(app_flush_model_loads(app), APP_NO_ERROR);
+  CHECK(app_execute_command(app, "occluder -m cube"), APP_NO_ERROR);
+  CHECK(app_execute_command(app, "spawn -m cube -n inst0"), APP_NO_ERROR);
+  CHECK(app_execute_command(app, "spawn -m cube -n inst1"), APP_NO_ERROR);
+  CHECK(app_get_model_instance(app, "inst1", &instance), APP_NO_ERROR);
+  CHECK(app_translate_model_instances
+    (&instance, 1, false, (float[]){1.f, 2.f, 3.f}), APP_NO_ERROR);
+  CHECK(app_execute_command(app, "spawn -m cube -n inst2"), APP_NO_ERROR);
+  CHECK(app_get_model_instance(app, "inst2", &child), APP_NO_ERROR);
+  CHECK(app_set_model_instance_parent(child, instance), APP_NO_ERROR);
+  CHECK(app_translate_model_instances
+    (&child, 1, false, (float[]){1.f, 0.f, 0.f}), APP_NO_ERROR);
+
+  CHECK(app_execute_command(app, "save -f -o " MAP_PATH), APP_NO_ERROR);
+  file = fopen(MAP_PATH, "r");
+  NCHECK(file, NULL);
+  CHECK(fread(magic, sizeof(magic), 1, file), 1);
+  CHECK(memcmp(magic, "FMAP", sizeof(magic)), 0);
+  fclose(file);
+  check_map(app, "load -M " MAP_PATH);
+
+  CHECK(app_execute_command(app, "save -f -t -o " MAP_PATH), APP_NO_ERROR);
+  file = fopen(MAP_PATH, "r");
+  NCHECK(file, NULL);
+  CHECK(fread(magic, sizeof(magic), 1, file), 1);
+  CHECK(memcmp(magic, "load", sizeof(magic)), 0);
+  fclose(file);
+  check_map(app, "load -M " MAP_PATH);
+
+  /* A binary map whose header counts exceed the file length is rejected
+   * before its tables are allocated. */
+  file = fopen(MAP_PATH, "w");
+  NCHECK(file, NULL);
+  CHECK(fwrite("FMAP", 4, 1, file), 1);
+  CHECK(fwrite((uint32_t[]){2, 1, UINT32_MAX, 8}, 16, 1, file), 1);
+  fclose(file);
+  CHECK(app_execute_command(app, "load -M " MAP_PATH), APP_NO_ERROR);
+  CHECK(app_get_model_instance(app, "inst1", &instance), APP_NO_ERROR);
+  CHECK(instance, NULL);
+  CHECK(app_cleanup(app), APP_NO_ERROR);
+
   CHECK(edit_context_ref_get(NULL), EDIT_INVALID_ARGUMENT);
   CHECK(edit_context_ref_get(edit), EDIT_NO_ERROR);
   CHECK(edit_context_ref_put(NULL), EDIT_INVALID_ARGUMENT);
@@ -81,6 +81,7 @@ test_vf4(void)
   vf4_t i, j, k;
   vi4_t l;
   ALIGN(16) float tmp[4] = { 0.f, 1.f, 2.f, 3.f };
+  float f = 0.f;
 
   i = vf4_load(tmp);
   CHECK(vf4_x(i), 0.f);
@@ -270,11 +271,13 @@ test_vf4(void)
   CHECK(vf4_z(k), -9.f);
   CHECK(vf4_w(k), -16.f);
 
+  /* The division is not exact when it is compiled with -ffast-math. */
   k = vf4_div(k, i);
-  CHECK(vf4_x(k), 1.f);
-  CHECK(vf4_y(k), -2.f);
-  CHECK(vf4_z(k), 3.f);
-  CHECK(vf4_w(k), -4.f);
+  CHECK(EQ_EPS(vf4_x(k), 1.f, 1.e-6f), true);
+  CHECK(EQ_EPS(vf4_y(k), -2.f, 1.e-6f), true);
+  CHECK(EQ_EPS(vf4_z(k), 3.f, 1.e-6f), true);
+  CHECK(EQ_EPS(vf4_w(k), -4.f, 1.e-6f), true);
+  k = j; /* Exact result of the division. */
 
   k = vf4_madd(i, j, k);
   CHECK(vf4_x(k), 0.f);
@@ -446,6 +449,22 @@ test_vf4(void)
   CHECK(EQ_EPS(vf4_z(j), cosf(PI/4.f), 1.e-6f), true);
   CHECK(EQ_EPS(vf4_w(j), cosf(PI/6.f), 1.e-6f), true);
 
+  /* Check the documented accuracy of the trigonometric functions. */
+  for(f = -8.f*PI; f <= 8.f*PI; f += 0.001f) {
+    i = vf4_set(f, f + 0.00025f, f + 0.0005f, f + 0.00075f);
+    vf4_sincos(i, &k, &j);
+    CHECK(EQ_EPS(vf4_x(k), (float)sin((double)vf4_x(i)), 1.e-6f), true);
+    CHECK(EQ_EPS(vf4_y(k), (float)sin((double)vf4_y(i)), 1.e-6f), true);
+    CHECK(EQ_EPS(vf4_z(k), (float)sin((double)vf4_z(i)), 1.e-6f), true);
+    CHECK(EQ_EPS(vf4_w(k), (float)sin((double)vf4_w(i)), 1.e-6f), true);
+    CHECK(EQ_EPS(vf4_x(j), (float)cos((double)vf4_x(i)), 1.e-6f), true);
+    CHECK(EQ_EPS(vf4_y(j), (float)cos((double)vf4_y(i)), 1.e-6f), true);
+    CHECK(EQ_EPS(vf4_z(j), (float)cos((double)vf4_z(i)), 1.e-6f), true);
+    CHECK(EQ_EPS(vf4_w(j), (float)cos((double)vf4_w(i)), 1.e-6f), true);
+    CHECK(vf4_x(vf4_sin(i)), vf4_x(k));
+    CHECK(vf4_w(vf4_cos(i)), vf4_w(j));
+  }
+
   i = vf4_set(PI/8.f, PI/3.f, PI/4.f, PI/6.f);
   k = vf4_tan(i);
   CHECK(EQ_EPS(vf4_x(k), tanf(PI/8.f), 1.e-6f), true);
@@ -950,6 +969,26 @@ test_aosf33(void)
      vf4_x(n.c0), vf4_x(n.c1), vf4_x(n.c2),
      vf4_y(n.c0), vf4_y(n.c1), vf4_y(n.c2),
      vf4_z(n.c0), vf4_z(n.c1), vf4_z(n.c2));
+
+  aosf33_rotation(&m, PI/3.f, -PI/5.f, 2.5f);
+  {
+    const float c1 = cosf(PI/3.f), s1 = sinf(PI/3.f);
+    const float c2 = cosf(-PI/5.f), s2 = sinf(-PI/5.f);
+    const float c3 = cosf(2.5f), s3 = sinf(2.5f);
+    AOSF33_EQ_EPS
+      (m,
+       c2*c3, c1*s3 + c3*s1*s2, s1*s3 - c1*c3*s2,
+       -c2*s3, c1*c3 - s1*s2*s3, c1*s2*s3 + c3*s1,
+       s2, -c2*s1, c1*c2,
+       1.e-5f);
+  }
+  aosf33_yaw_rotation(&m, -0.7f);
+  AOSF33_EQ_EPS
+    (m,
+     cosf(-0.7f), 0.f, -sinf(-0.7f),
+     0.f, 1.f, 0.f,
+     sinf(-0.7f), 0.f, cosf(-0.7f),
+     1.e-6f);
 }
 
 static void
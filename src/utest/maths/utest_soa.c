@@ -0,0 +1,508 @@
+#include "maths/simd/aosf33.h"
+#include "maths/simd/aosf44.h"
+#include "maths/simd/aosq.h"
+#include "maths/simd/raster.h"
+#include "maths/simd/soaf3.h"
+#include "maths/simd/soaf33.h"
+#include "maths/simd/soaf44.h"
+#include "maths/simd/soaq.h"
+#include "sys/math.h"
+#include "sys/sys.h"
+#include "utest/utest.h"
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#define W SOA_SIMD_WIDTH
+#define EQ_EPS(x, y, eps) (fabsf((x) - (y)) <= (eps))
+#define ALL_LANES ((1 << W) - 1)
+
+/* Define an affine transform per lane, with a rotation, a non uniform scale
+ * and a translation that differ from one lane to the other. */
+static void
+setup_transforms(float mats[W*16])
+{
+  struct aosf44 m;
+  struct aosf33 r;
+  int i = 0;
+
+  for(i = 0; i < W; ++i) {
+    const float f = (float)i;
+    aosf33_rotation(&r, 0.1f + 0.3f*f, -0.7f + 0.2f*f, 1.3f - 0.4f*f);
+    aosf44_set
+      (&m,
+       vf4_mul(r.c0, vf4_set1(1.f + f)),
+       vf4_mul(r.c1, vf4_set1(2.f - 0.1f*f)),
+       vf4_mul(r.c2, vf4_set1(0.5f + 0.25f*f)),
+       vf4_set(f, -2.f*f + 1.f, 3.f, 1.f));
+    aosf44_store(mats + i*16, &m);
+  }
+}
+
+static void
+check_f44(const float* soa, const struct aosf44* aos, float eps)
+{
+  ALIGN(16) float tmp[16];
+  int i = 0;
+
+  aosf44_store(tmp, aos);
+  for(i = 0; i < 16; ++i)
+    CHECK(EQ_EPS(soa[i], tmp[i], eps*MAX(1.f, fabsf(tmp[i]))), true);
+}
+
+static void
+check_f4(const float* soa, vf4_t aos, int nb_comps, float eps)
+{
+  ALIGN(16) float tmp[4];
+  int i = 0;
+
+  vf4_store(tmp, aos);
+  for(i = 0; i < nb_comps; ++i)
+    CHECK(EQ_EPS(soa[i], tmp[i], eps*MAX(1.f, fabsf(tmp[i]))), true);
+}
+
+static void
+test_soaf3(void)
+{
+  ALIGN(16) float a[W*4];
+  ALIGN(16) float b[W*4];
+  float res[W*3];
+  float src[W*3];
+  ALIGN(16) float dots[W];
+  struct soaf3 u, v, w;
+  int i = 0;
+
+  for(i = 0; i < W; ++i) {
+    const float f = (float)i;
+    a[i*4+0] = src[i*3+0] = 1.f + f;
+    a[i*4+1] = src[i*3+1] = -2.f*f;
+    a[i*4+2] = src[i*3+2] = 0.5f - f;
+    a[i*4+3] = 0.f;
+    b[i*4+0] = 3.f - f;
+    b[i*4+1] = 0.25f*f;
+    b[i*4+2] = 1.f + 2.f*f;
+    b[i*4+3] = 0.f;
+  }
+
+  soaf3_load_aos(&u, src);
+  soaf3_store_aos(res, &u);
+  for(i = 0; i < W*3; ++i)
+    CHECK(res[i], src[i]);
+
+  for(i = 0; i < W; ++i) {
+    src[i*3+0] = b[i*4+0];
+    src[i*3+1] = b[i*4+1];
+    src[i*3+2] = b[i*4+2];
+  }
+  soaf3_load_aos(&v, src);
+  CHECK(soaf_movemask(soaf3_eq(&u, &u)), ALL_LANES);
+  CHECK(soaf_movemask(soaf3_eq(&u, &v)), 0);
+
+  soaf3_cross(&w, &u, &v);
+  soaf3_store_aos(res, &w);
+  soaf_store(dots, soaf3_dot(&u, &v));
+  for(i = 0; i < W; ++i) {
+    const vf4_t va = vf4_load(a + i*4);
+    const vf4_t vb = vf4_load(b + i*4);
+    check_f4(res + i*3, vf4_cross3(va, vb), 3, 1.e-6f);
+    CHECK(EQ_EPS(dots[i], vf4_x(vf4_dot3(va, vb)), 1.e-5f), true);
+  }
+
+  soaf3_min(&w, &u, &v);
+  soaf3_store_aos(res, &w);
+  for(i = 0; i < W; ++i) {
+    check_f4(res + i*3, vf4_min(vf4_load(a + i*4), vf4_load(b + i*4)), 3, 0.f);
+  }
+}
+
+static void
+test_soaf33(void)
+{
+  ALIGN(16) float mats[W*16];
+  ALIGN(16) float dets[W];
+  float f33[W*9];
+  float res[W*9];
+  float vec[W*3];
+  struct soaf44 m44;
+  struct soaf33 m, n;
+  struct soaf3 v;
+  int i = 0, j = 0;
+
+  setup_transforms(mats);
+  soaf44_load_aos(&m44, mats);
+  soaf44_to_soaf33(&m, &m44);
+  soaf33_store_aos(f33, &m);
+  for(i = 0; i < W; ++i) {
+    for(j = 0; j < 3; ++j) {
+      CHECK(f33[i*9 + j*3 + 0], mats[i*16 + j*4 + 0]);
+      CHECK(f33[i*9 + j*3 + 1], mats[i*16 + j*4 + 1]);
+      CHECK(f33[i*9 + j*3 + 2], mats[i*16 + j*4 + 2]);
+    }
+  }
+  soaf33_load_aos(&n, f33);
+  soaf33_store_aos(res, &n);
+  for(i = 0; i < W*9; ++i)
+    CHECK(res[i], f33[i]);
+
+  for(i = 0; i < W; ++i) {
+    vec[i*3+0] = 1.f;
+    vec[i*3+1] = (float)i;
+    vec[i*3+2] = -2.f;
+  }
+  soaf3_load_aos(&v, vec);
+  soaf33_mulf3(&v, &m, &v);
+  soaf3_store_aos(vec, &v);
+  for(i = 0; i < W; ++i) {
+    const struct aosf33 a = {
+      vf4_load(mats + i*16 + 0),
+      vf4_load(mats + i*16 + 4),
+      vf4_load(mats + i*16 + 8)
+    };
+    check_f4
+      (vec + i*3, aosf33_mulf3(&a, vf4_set(1.f, (float)i, -2.f, 0.f)),
+       3, 1.e-6f);
+  }
+
+  soaf_store(dets, soaf33_det(&m));
+  soaf33_inverse(&n, &m);
+  soaf33_store_aos(res, &n);
+  for(i = 0; i < W; ++i) {
+    const struct aosf33 a = {
+      vf4_load(mats + i*16 + 0),
+      vf4_load(mats + i*16 + 4),
+      vf4_load(mats + i*16 + 8)
+    };
+    struct aosf33 b;
+    CHECK(EQ_EPS(dets[i], vf4_x(aosf33_det(&a)), 1.e-5f * dets[i]), true);
+    aosf33_inverse(&b, &a);
+    check_f4(res + i*9 + 0, b.c0, 3, 1.e-5f);
+    check_f4(res + i*9 + 3, b.c1, 3, 1.e-5f);
+    check_f4(res + i*9 + 6, b.c2, 3, 1.e-5f);
+  }
+
+  soaf33_mulf33(&n, &m, &n);
+  soaf33_identity(&m);
+  soaf33_store_aos(res, &n);
+  soaf33_store_aos(f33, &m);
+  for(i = 0; i < W*9; ++i)
+    CHECK(EQ_EPS(res[i], f33[i], 1.e-5f), true);
+
+  for(i = 0; i < W; ++i) {
+    vec[i*3+0] = 0.1f + 0.3f*(float)i;
+    vec[i*3+1] = -0.7f + 0.9f*(float)i;
+    vec[i*3+2] = 4.f - 1.3f*(float)i;
+  }
+  soaf3_load_aos(&v, vec);
+  soaf33_rotation(&m, v.x, v.y, v.z);
+  soaf33_store_aos(res, &m);
+  for(i = 0; i < W; ++i) {
+    struct aosf33 a;
+    aosf33_rotation(&a, vec[i*3+0], vec[i*3+1], vec[i*3+2]);
+    check_f4(res + i*9 + 0, a.c0, 3, 1.e-6f);
+    check_f4(res + i*9 + 3, a.c1, 3, 1.e-6f);
+    check_f4(res + i*9 + 6, a.c2, 3, 1.e-6f);
+  }
+}
+
+static void
+test_soaf44(void)
+{
+  ALIGN(16) float mats[W*16];
+  ALIGN(16) float res[W*16];
+  ALIGN(16) float dets[W];
+  float lower[W*3], upper[W*3];
+  float vec[W*3];
+  struct soaf44 m, n, o;
+  struct soaf3 v, l, u;
+  int i = 0, j = 0;
+
+  setup_transforms(mats);
+  soaf44_load_aos(&m, mats);
+  soaf44_store_aos(res, &m);
+  for(i = 0; i < W*16; ++i)
+    CHECK(res[i], mats[i]);
+
+  soaf44_identity(&n);
+  soaf44_mulf44(&o, &m, &n);
+  CHECK(soaf_movemask(soaf44_eq_eps(&o, &m, soaf_set1(0.f))), 0);
+  CHECK(soaf_movemask(soaf44_eq_eps(&o, &m, soaf_set1(1.e-6f))), ALL_LANES);
+
+  /* Multiply each transform by the transform of the next lane. */
+  for(i = 0; i < W; ++i)
+    aosf44_store(res + i*16, (struct aosf44[]){{
+      vf4_load(mats + ((i+1)%W)*16 + 0),
+      vf4_load(mats + ((i+1)%W)*16 + 4),
+      vf4_load(mats + ((i+1)%W)*16 + 8),
+      vf4_load(mats + ((i+1)%W)*16 + 12)}});
+  soaf44_load_aos(&n, res);
+  soaf44_mulf44(&o, &m, &n);
+  soaf44_store_aos(res, &o);
+  for(i = 0; i < W; ++i) {
+    struct aosf44 a, b, c;
+    aosf44_load(&a, mats + i*16);
+    aosf44_load(&b, mats + ((i+1)%W)*16);
+    aosf44_mulf44(&c, &a, &b);
+    check_f44(res + i*16, &c, 1.e-5f);
+  }
+
+  for(i = 0; i < W; ++i) {
+    vec[i*3+0] = 0.5f*(float)i;
+    vec[i*3+1] = -1.f;
+    vec[i*3+2] = 2.f;
+  }
+  soaf3_load_aos(&v, vec);
+  soaf44_transform_point(&v, &m, &v);
+  soaf3_store_aos(vec, &v);
+  for(i = 0; i < W; ++i) {
+    struct aosf44 a;
+    aosf44_load(&a, mats + i*16);
+    check_f4(vec + i*3,
+      aosf44_mulf4(&a, vf4_set(0.5f*(float)i, -1.f, 2.f, 1.f)), 3, 1.e-5f);
+  }
+  soaf3_splat(&v, 1.f, 2.f, 3.f);
+  soaf44_transform_vector(&v, &m, &v);
+  soaf3_store_aos(vec, &v);
+  for(i = 0; i < W; ++i) {
+    struct aosf44 a;
+    aosf44_load(&a, mats + i*16);
+    check_f4(vec + i*3,
+      aosf44_mulf4(&a, vf4_set(1.f, 2.f, 3.f, 0.f)), 3, 1.e-5f);
+  }
+
+  soaf_store(dets, soaf44_inverse(&n, &m));
+  soaf44_store_aos(res, &n);
+  for(i = 0; i < W; ++i) {
+    struct aosf44 a, b;
+    aosf44_load(&a, mats + i*16);
+    CHECK(EQ_EPS(dets[i], vf4_x(aosf44_inverse(&b, &a)), 1.e-5f*dets[i]), true);
+    check_f44(res + i*16, &b, 1.e-5f);
+  }
+  soaf44_mulf44(&o, &n, &m);
+  soaf44_identity(&n);
+  CHECK(soaf_movemask(soaf44_eq_eps(&o, &n, soaf_set1(1.e-5f))), ALL_LANES);
+
+  soaf44_invtrans(&n, &m);
+  soaf44_store_aos(res, &n);
+  for(i = 0; i < W; ++i) {
+    struct aosf44 a, b;
+    aosf44_load(&a, mats + i*16);
+    aosf44_invtrans(&b, &a);
+    check_f44(res + i*16, &b, 1.e-5f);
+  }
+
+  /* Check the transformed box against the bounds of its 8 corners. */
+  for(i = 0; i < W; ++i) {
+    lower[i*3+0] = -1.f - (float)i;
+    lower[i*3+1] = 0.5f;
+    lower[i*3+2] = -3.f;
+    upper[i*3+0] = 2.f;
+    upper[i*3+1] = 1.f + (float)i;
+    upper[i*3+2] = -1.f;
+  }
+  soaf3_load_aos(&l, lower);
+  soaf3_load_aos(&u, upper);
+  soaf44_transform_box(&l, &u, &m, &l, &u);
+  soaf3_store_aos(vec, &l);
+  for(i = 0; i < W; ++i) {
+    vf4_t vmin = vf4_set1(FLT_MAX);
+    vf4_t vmax = vf4_set1(-FLT_MAX);
+    struct aosf44 a;
+    float box[W*3];
+    aosf44_load(&a, mats + i*16);
+    for(j = 0; j < 8; ++j) {
+      const vf4_t corner = vf4_set
+        (j & 1 ? upper[i*3+0] : lower[i*3+0],
+         j & 2 ? upper[i*3+1] : lower[i*3+1],
+         j & 4 ? upper[i*3+2] : lower[i*3+2],
+         1.f);
+      const vf4_t p = aosf44_mulf4(&a, corner);
+      vmin = vf4_min(vmin, p);
+      vmax = vf4_max(vmax, p);
+    }
+    check_f4(vec + i*3, vmin, 3, 1.e-5f);
+    soaf3_store_aos(box, &u);
+    check_f4(box + i*3, vmax, 3, 1.e-5f);
+  }
+}
+
+static void
+test_soaq(void)
+{
+  ALIGN(16) float q0[W*4];
+  ALIGN(16) float q1[W*4];
+  ALIGN(16) float res[W*4];
+  float f33[W*9];
+  struct soaq p, q;
+  struct soaf33 m;
+  int i = 0;
+
+  for(i = 0; i < W; ++i) {
+    const float f = (float)i;
+    vf4_store(q0 + i*4, aosq_set_axis_angle
+      (vf4_normalize3(vf4_set(1.f, f, -2.f, 0.f)), vf4_set1(0.3f + f)));
+    vf4_store(q1 + i*4, aosq_set_axis_angle
+      (vf4_normalize3(vf4_set(-f, 1.f, 0.5f, 0.f)), vf4_set1(1.1f - f)));
+  }
+  soaq_load_aos(&p, q0);
+  soaq_store_aos(res, &p);
+  for(i = 0; i < W*4; ++i)
+    CHECK(res[i], q0[i]);
+
+  soaq_load_aos(&q, q1);
+  soaq_mul(&q, &p, &q);
+  soaq_store_aos(res, &q);
+  for(i = 0; i < W; ++i) {
+    check_f4(res + i*4,
+      aosq_mul(vf4_load(q0 + i*4), vf4_load(q1 + i*4)), 4, 1.e-6f);
+  }
+
+  soaq_conj(&q, &p);
+  soaq_store_aos(res, &q);
+  for(i = 0; i < W; ++i)
+    check_f4(res + i*4, aosq_conj(vf4_load(q0 + i*4)), 4, 0.f);
+
+  soaq_to_soaf33(&p, &m);
+  soaf33_store_aos(f33, &m);
+  for(i = 0; i < W; ++i) {
+    struct aosf33 a;
+    aosq_to_aosf33(vf4_load(q0 + i*4), &a);
+    check_f4(f33 + i*9 + 0, a.c0, 3, 1.e-6f);
+    check_f4(f33 + i*9 + 3, a.c1, 3, 1.e-6f);
+    check_f4(f33 + i*9 + 6, a.c2, 3, 1.e-6f);
+  }
+
+  soaq_identity(&q);
+  soaq_mul(&q, &p, &q);
+  soaq_store_aos(res, &q);
+  for(i = 0; i < W*4; ++i)
+    CHECK(res[i], q0[i]);
+}
+
+static void
+test_batch(void)
+{
+  #define NB 11 /* Not a multiple of the SIMD width. */
+  ALIGN(16) float mats[W*16];
+  float transforms[NB*16];
+  float pts[NB*3], res[NB*3];
+  float lower[NB*3], upper[NB*3];
+  float res_lower[NB*3], res_upper[NB*3];
+  struct aosf44 m, n;
+  int i = 0, j = 0;
+
+  printf("SIMD ISA: %s\n", simd_isa_name(simd_get_isa()));
+
+  setup_transforms(mats);
+  for(i = 0; i < NB; ++i) {
+    for(j = 0; j < 16; ++j)
+      transforms[i*16 + j] = mats[(i%W)*16 + j];
+    pts[i*3+0] = lower[i*3+0] = -(float)i;
+    pts[i*3+1] = lower[i*3+1] = 0.5f;
+    pts[i*3+2] = lower[i*3+2] = 1.f - 0.5f*(float)i;
+    upper[i*3+0] = lower[i*3+0] + 1.f;
+    upper[i*3+1] = lower[i*3+1] + 2.f + (float)i;
+    upper[i*3+2] = lower[i*3+2] + 0.25f;
+  }
+
+  aosf44_load(&m, mats + 16);
+  aosf44_transform_points(&m, pts, 0, NULL);
+  aosf44_transform_points(&m, pts, NB, res);
+  for(i = 0; i < NB; ++i) {
+    const vf4_t p = vf4_set(pts[i*3+0], pts[i*3+1], pts[i*3+2], 1.f);
+    check_f4(res + i*3, aosf44_mulf4(&m, p), 3, 1.e-5f);
+  }
+  aosf44_transform_points(&m, pts, NB, pts);
+  for(i = 0; i < NB*3; ++i)
+    CHECK(pts[i], res[i]);
+
+  aosf44_transform_boxes(NULL, NULL, NULL, 0, NULL, NULL);
+  aosf44_transform_boxes
+    (transforms, lower, upper, NB, res_lower, res_upper);
+  for(i = 0; i < NB; ++i) {
+    vf4_t vmin = vf4_set1(FLT_MAX);
+    vf4_t vmax = vf4_set1(-FLT_MAX);
+    aosf44_load(&m, mats + (i%W)*16);
+    for(j = 0; j < 8; ++j) {
+      const vf4_t p = aosf44_mulf4(&m, vf4_set
+        (j & 1 ? upper[i*3+0] : lower[i*3+0],
+         j & 2 ? upper[i*3+1] : lower[i*3+1],
+         j & 4 ? upper[i*3+2] : lower[i*3+2],
+         1.f));
+      vmin = vf4_min(vmin, p);
+      vmax = vf4_max(vmax, p);
+    }
+    check_f4(res_lower + i*3, vmin, 3, 1.e-5f);
+    check_f4(res_upper + i*3, vmax, 3, 1.e-5f);
+  }
+
+  aosf44_inverse(&n, &m);
+  aosf44_mulf44(&n, &n, &m);
+  CHECK(EQ_EPS(vf4_x(n.c0), 1.f, 1.e-5f), true);
+  CHECK(EQ_EPS(vf4_y(n.c1), 1.f, 1.e-5f), true);
+  CHECK(EQ_EPS(vf4_x(n.c3), 0.f, 1.e-5f), true);
+  #undef NB
+}
+
+static void
+test_raster(void)
+{
+  ALIGN(RASTER_ALIGNMENT) float tile[RASTER_TILE_SIZE];
+  /* Large triangle that covers the tile at the 0.5 depth. */
+  struct raster_triangle tri = {
+    .edges = {{ 0.f, 1.f, 100.f }, { -1.f, -1.f, 100.f }, { 1.f, 0.f, 100.f }},
+    .depth = { 0.f, 0.f, 0.5f }
+  };
+  int i = 0;
+
+  memset(tile, 0, sizeof(tile));
+  CHECK(raster_tile_depth(tile), 0.f);
+  CHECK(raster_test_tile(tile, 16, 8, 16, 24, 8, 16, 0.f), true);
+
+  /* Only the rows [2, 5) of the tile are drawn. */
+  raster_draw_tile(tile, 16, 8, 10, 13, &tri);
+  for(i = 0; i < RASTER_TILE_SIZE; ++i) {
+    const int row = i / RASTER_TILE_WIDTH;
+    CHECK(tile[i], row >= 2 && row < 5 ? 0.5f : 0.f);
+  }
+  CHECK(raster_tile_depth(tile), 0.f);
+  CHECK(raster_test_tile(tile, 16, 8, 16, 24, 10, 13, 0.25f), false);
+  CHECK(raster_test_tile(tile, 16, 8, 16, 24, 10, 13, 0.75f), true);
+  CHECK(raster_test_tile(tile, 16, 8, 16, 24, 8, 16, 0.25f), true);
+
+  /* Nearer triangle whose edge x = 20 splits the tile. */
+  tri.edges[1][0] = -1.f;
+  tri.edges[1][1] = 0.f;
+  tri.edges[1][2] = 20.f;
+  tri.depth[2] = 1.f;
+  raster_draw_tile(tile, 16, 8, 8, 16, &tri);
+  for(i = 0; i < RASTER_TILE_SIZE; ++i) {
+    const int row = i / RASTER_TILE_WIDTH;
+    const int column = i % RASTER_TILE_WIDTH;
+    if(column < 4)
+      CHECK(tile[i], 1.f);
+    else
+      CHECK(tile[i], row >= 2 && row < 5 ? 0.5f : 0.f);
+  }
+  CHECK(raster_tile_depth(tile), 0.f);
+  CHECK(raster_test_tile(tile, 16, 8, 16, 20, 8, 16, 0.75f), false);
+  CHECK(raster_test_tile(tile, 16, 8, 18, 21, 8, 16, 0.75f), true);
+
+  memset(tile, 0, sizeof(tile));
+  raster_draw_tile(tile, 16, 8, 8, 16, &tri);
+  tri.edges[1][2] = 100.f;
+  tri.depth[2] = 0.5f;
+  raster_draw_tile(tile, 16, 8, 8, 16, &tri);
+  CHECK(raster_tile_depth(tile), 0.5f);
+}
+
+int
+main(int argc UNUSED, char** argv UNUSED)
+{
+  test_batch();
+  test_raster();
+  test_soaf3();
+  test_soaf33();
+  test_soaf44();
+  test_soaq();
+  return 0;
+}
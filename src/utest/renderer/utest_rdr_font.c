@@ -14,6 +14,18 @@
 #define BAD_ARG RDR_INVALID_ARGUMENT
 #define OK RDR_NO_ERROR
 
+static size_t nb_loaded_glyphs = 0;
+
+static bool
+load_glyph
+  (wchar_t ch UNUSED,
+   struct rdr_glyph_desc* desc UNUSED,
+   void* data UNUSED)
+{
+  ++nb_loaded_glyphs;
+  return false;
+}
+
 int
 main(int argc, char** argv)
 {
@@ -180,6 +192,32 @@ main(int argc, char** argv)
   CHECK(metrics.line_space, i);
   CHECK(metrics.min_glyph_width, min_width);
 
+  metrics.line_space = i;
+  metrics.min_glyph_width = min_width;
+  metrics.min_glyph_pos_y = -4;
+  CHECK(rdr_font_glyph_loader(NULL, NULL, 0, NULL, NULL), BAD_ARG);
+  CHECK(rdr_font_glyph_loader(font, NULL, 1, load_glyph, NULL), BAD_ARG);
+  CHECK(rdr_font_glyph_loader(font, &metrics, 1, NULL, NULL), BAD_ARG);
+  CHECK(rdr_font_glyph_loader(font, &metrics, 2, load_glyph, NULL), BAD_ARG);
+  CHECK(rdr_font_glyph_loader(NULL, &metrics, 1, load_glyph, NULL), BAD_ARG);
+  CHECK(rdr_font_glyph_loader(font, &metrics, 1, load_glyph, NULL), OK);
+  CHECK(nb_loaded_glyphs, 0);
+  CHECK(rdr_font_bitmap_cache(font, &width, &height, &Bpp, &bmp_cache), OK);
+  NCHECK(bmp_cache, NULL);
+  NCHECK(width, 0);
+  NCHECK(height, 0);
+  CHECK(Bpp, 1);
+
+  memset(&metrics, 0, sizeof(metrics));
+  CHECK(rdr_get_font_metrics(font, &metrics), OK);
+  CHECK(metrics.line_space, i);
+  CHECK(metrics.min_glyph_width, min_width);
+  CHECK(metrics.min_glyph_pos_y, -4);
+
+  CHECK(rdr_font_data(font, i, nb_glyphs, glyph_desc_list), OK);
+  CHECK(rdr_get_font_metrics(font, &metrics), OK);
+  CHECK(metrics.min_glyph_width, min_width);
+
   CHECK(rdr_font_ref_get(NULL), BAD_ARG);
   CHECK(rdr_font_ref_get(font), OK);
   CHECK(rdr_font_ref_put(NULL), BAD_ARG);
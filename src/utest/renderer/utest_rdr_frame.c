@@ -1,5 +1,6 @@
 #include "renderer/rdr_font.h"
 #include "renderer/rdr_frame.h"
+#include "renderer/rdr_imdraw.h"
 #include "renderer/rdr_system.h"
 #include "renderer/rdr_term.h"
 #include "renderer/rdr_world.h"
@@ -16,6 +17,7 @@ main(int argc, char** argv)
 {
   const char* driver_name = NULL;
   int err = 0;
+  int i = 0;
   /* Window manager data structures. */
   struct wm_device* device = NULL;
   struct wm_window* window = NULL;
@@ -27,6 +29,7 @@ main(int argc, char** argv)
   };
   /* Renderer data structure. */
   struct rdr_frame* frame = NULL;
+  struct rdr_frame_stats stats;
   struct rdr_system* sys = NULL;
   struct rdr_world* world = NULL;
   struct rdr_font* font = NULL;
@@ -91,6 +94,63 @@ main(int argc, char** argv)
   CHECK(rdr_frame_draw_term(NULL, term), BAD_ARG);
   CHECK(rdr_frame_draw_term(frame, term), OK);
 
+  /* Emit more im draw commands than a command block can store. */
+  for(i = 0; i < 600; ++i) {
+    const float p[3] = { (float)i * 0.1f, 0.f, -10.f };
+    const float s[3] = { 1.f, 1.f, 1.f };
+    const float r[3] = { 0.f, 0.f, 0.f };
+    const float opaque[4] = { 1.f, 0.f, 0.f, 1.f };
+    const float translucent[4] = { 0.f, 1.f, 0.f, 0.5f };
+    const int flag = (i % 2)
+      ? RDR_IMDRAW_FLAG_UPPERMOST_LAYER : RDR_IMDRAW_FLAG_NONE;
+
+    switch(i % 4) {
+      case 0:
+        CHECK(rdr_frame_imdraw_parallelepiped
+          (frame, &view, flag, i, p, s, r, opaque, translucent), OK);
+        break;
+      case 1:
+        CHECK(rdr_frame_imdraw_parallelepiped
+          (frame, &view, flag, i, p, s, r, translucent, NULL), OK);
+        break;
+      case 2:
+        CHECK(rdr_frame_imdraw_ellipse
+          (frame, &view, flag, i, p, s, r, opaque), OK);
+        break;
+      case 3:
+        CHECK(rdr_frame_imdraw_vector
+          (frame, &view, flag, i, RDR_IM_VECTOR_CUBE_MARKER,
+           RDR_IM_VECTOR_CONE_MARKER, RDR_IM_STROKE_STYLE_PLAIN,
+           r, p, opaque), OK);
+        break;
+    }
+  }
+  CHECK(rdr_frame_imdraw_grid
+    (frame, &view, RDR_IMDRAW_FLAG_NONE, 0,
+     (float[]){0.f, 0.f, 0.f}, (float[]){10.f, 10.f}, (float[]){0.f, 0.f, 0.f},
+     (unsigned int[]){10, 10}, (unsigned int[]){2, 2},
+     (float[]){1.f, 1.f, 1.f}, (float[]){0.5f, 0.5f, 0.5f},
+     (float[]){0.f, 0.f, 1.f}, (float[]){1.f, 0.f, 0.f}), OK);
+  CHECK(rdr_flush_frame(frame), OK);
+
+  /* Draw more distinct grids than the CPU grid cache can store. */
+  CHECK(rdr_system_procedural_grid(NULL, false), BAD_ARG);
+  CHECK(rdr_system_procedural_grid(sys, false), OK);
+  for(i = 0; i < 2; ++i) {
+    unsigned int ndiv = 0;
+    for(ndiv = 0; ndiv < 8; ++ndiv) {
+      CHECK(rdr_frame_imdraw_grid
+        (frame, &view, RDR_IMDRAW_FLAG_NONE, 0,
+         (float[]){0.f, 0.f, 0.f}, (float[]){10.f, 10.f},
+         (float[]){0.f, 0.f, 0.f},
+         (unsigned int[]){ndiv, ndiv}, (unsigned int[]){2, 2},
+         (float[]){1.f, 1.f, 1.f}, (float[]){0.5f, 0.5f, 0.5f},
+         (float[]){0.f, 0.f, 1.f}, (float[]){1.f, 0.f, 0.f}), OK);
+    }
+    CHECK(rdr_flush_frame(frame), OK);
+  }
+  CHECK(rdr_system_procedural_grid(sys, true), OK);
+
   CHECK(rdr_frame_pick_model_instance(NULL, NULL, NULL, NULL, NULL), BAD_ARG);
   CHECK(rdr_frame_pick_model_instance(frame, NULL, NULL, NULL, NULL), BAD_ARG);
   CHECK(rdr_frame_pick_model_instance(NULL, world, NULL, NULL, NULL), BAD_ARG);
@@ -127,6 +187,18 @@ main(int argc, char** argv)
   CHECK(rdr_flush_frame(NULL), BAD_ARG);
   CHECK(rdr_flush_frame(frame), OK);
 
+  CHECK(rdr_get_frame_stats(NULL, NULL), BAD_ARG);
+  CHECK(rdr_get_frame_stats(frame, NULL), BAD_ARG);
+  CHECK(rdr_get_frame_stats(NULL, &stats), BAD_ARG);
+  CHECK(rdr_get_frame_stats(frame, &stats), OK);
+  CHECK(stats.nb_instances, 0);
+  CHECK(stats.nb_culled_instances, 0);
+  CHECK(stats.nb_triangles, 0);
+  CHECK(rdr_flush_frame(frame), OK);
+  CHECK(rdr_get_frame_stats(frame, &stats), OK);
+  CHECK(stats.nb_instances, 0);
+  CHECK(stats.nb_culled_instances, 0);
+
   CHECK(rdr_frame_ref_get(NULL), BAD_ARG);
   CHECK(rdr_frame_ref_get(frame), OK);
   CHECK(rdr_frame_ref_put(NULL), BAD_ARG);
@@ -1,4 +1,6 @@
 #include "renderer/rdr_material.h"
+#include "renderer/rdr_mesh.h"
+#include "renderer/rdr_model.h"
 #include "renderer/rdr_system.h"
 #include "sys/mem_allocator.h"
 #include "utest/utest.h"
@@ -39,6 +41,8 @@ main(int argc, char** argv)
     .width = 800, .height = 600, .fullscreen = 0
   };
   struct rdr_material* mtr = NULL;
+  struct rdr_mesh* mesh = NULL;
+  struct rdr_model* model = NULL;
   const char* bad_source = "__INVALID_SOURCE_";
   const char* good_source =
     "#version 330\n"
@@ -89,6 +93,18 @@ main(int argc, char** argv)
   sources[RDR_VERTEX_SHADER] = good_source;
   CHECK(rdr_material_program(mtr, sources), OK);
 
+  /* An erroneous program does not replace the linked one. */
+  if(null_driver == false) {
+    sources[RDR_VERTEX_SHADER] = bad_source;
+    CHECK(rdr_material_program(mtr, sources), RDR_DRIVER_ERROR);
+    CHECK(rdr_get_material_log(mtr, &log), OK);
+    CHECK(log != NULL, true);
+  }
+  CHECK(rdr_create_mesh(sys, &mesh), OK);
+  CHECK(rdr_create_model(sys, mesh, mtr, &model), OK);
+  CHECK(rdr_model_ref_put(model), OK);
+  CHECK(rdr_mesh_ref_put(mesh), OK);
+
   CHECK(rdr_material_ref_get(NULL), BAD_ARG);
   CHECK(rdr_material_ref_get(mtr), OK);
   CHECK(rdr_material_ref_put(NULL), BAD_ARG);
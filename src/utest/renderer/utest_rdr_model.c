@@ -26,6 +26,7 @@ main(int argc, char** argv)
   };
   struct rdr_material* mtr = NULL;
   struct rdr_mesh* mesh = NULL;
+  struct rdr_mesh* lod_mesh = NULL;
   struct rdr_model* model0 = NULL;
   struct rdr_model* model1 = NULL;
   const char* vs_source =
@@ -35,6 +36,10 @@ main(int argc, char** argv)
       "gl_Position = vec4(0.f,0.f,0.f,0.f);\n"
     "}\n";
   const char* sources[RDR_NB_SHADER_USAGES];
+  struct rdr_model_lod lods[RDR_MAX_MODEL_LODS];
+  size_t nb_lods = 0;
+  const float occluder[] = { 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 1.f, 0.f };
+  const unsigned int occluder_indices[] = { 0, 1, 2 };
   const float data[] = { 0.f, 0.f, 0.f, 1.f, 1.f, 1.f };
   const struct rdr_mesh_attrib attr0[] = {
     { .usage = RDR_ATTRIB_POSITION, .type = RDR_FLOAT2 },
@@ -65,6 +70,8 @@ main(int argc, char** argv)
   CHECK(rdr_create_system(driver_name, NULL, &sys), OK);
   CHECK(rdr_create_mesh(sys, &mesh), OK);
   CHECK(rdr_mesh_data(mesh, 2, attr0, SZ(data), data), OK);
+  CHECK(rdr_create_mesh(sys, &lod_mesh), OK);
+  CHECK(rdr_mesh_data(lod_mesh, 2, attr0, SZ(data), data), OK);
   CHECK(rdr_create_material(sys, &mtr), OK);
   CHECK(rdr_material_program(mtr, sources), OK);
 
@@ -91,14 +98,67 @@ main(int argc, char** argv)
 
   CHECK(rdr_mesh_data(mesh, 1, attr1, SZ(data), data), OK);
 
+  CHECK(rdr_get_model_lods(NULL, NULL, NULL), BAD_ARG);
+  CHECK(rdr_get_model_lods(model0, NULL, NULL), BAD_ARG);
+  CHECK(rdr_get_model_lods(NULL, &nb_lods, NULL), BAD_ARG);
+  CHECK(rdr_get_model_lods(model0, &nb_lods, NULL), OK);
+  CHECK(nb_lods, 0);
+
+  lods[0].mesh = lod_mesh;
+  lods[0].error = 0.1f;
+  lods[1].mesh = lod_mesh;
+  lods[1].error = 0.05f;
+  CHECK(rdr_model_lods(NULL, 1, lods), BAD_ARG);
+  CHECK(rdr_model_lods(model0, 1, NULL), BAD_ARG);
+  CHECK(rdr_model_lods(model0, RDR_MAX_MODEL_LODS, lods), BAD_ARG);
+  CHECK(rdr_model_lods(model0, 2, lods), BAD_ARG);
+  lods[1].error = 0.2f;
+  lods[2].mesh = NULL;
+  lods[2].error = 0.3f;
+  CHECK(rdr_model_lods(model0, 3, lods), BAD_ARG);
+  lods[2].mesh = mesh;
+  CHECK(rdr_model_lods(model0, 3, lods), OK);
+  CHECK(rdr_get_model_lods(model0, &nb_lods, NULL), OK);
+  CHECK(nb_lods, 3);
+  memset(lods, 0, SZ(lods));
+  CHECK(rdr_get_model_lods(model0, &nb_lods, lods), OK);
+  CHECK(nb_lods, 3);
+  CHECK(lods[0].mesh, lod_mesh);
+  CHECK(lods[0].error, 0.1f);
+  CHECK(lods[1].mesh, lod_mesh);
+  CHECK(lods[1].error, 0.2f);
+  CHECK(lods[2].mesh, mesh);
+  CHECK(lods[2].error, 0.3f);
+
+  CHECK(rdr_mesh_data(lod_mesh, 1, attr1, SZ(data), data), OK);
+  CHECK(rdr_model_lods(model0, 1, lods + 1), OK);
+  CHECK(rdr_get_model_lods(model0, &nb_lods, lods), OK);
+  CHECK(nb_lods, 1);
+  CHECK(lods[0].mesh, lod_mesh);
+  CHECK(lods[0].error, 0.2f);
+  CHECK(rdr_model_lods(model1, 1, lods), OK);
+
+  CHECK(rdr_model_occluder(NULL, 3, occluder, 3, occluder_indices), BAD_ARG);
+  CHECK(rdr_model_occluder(model0, 3, NULL, 3, occluder_indices), BAD_ARG);
+  CHECK(rdr_model_occluder(model0, 3, occluder, 3, NULL), BAD_ARG);
+  CHECK(rdr_model_occluder(model0, 3, occluder, 2, occluder_indices), BAD_ARG);
+  CHECK(rdr_model_occluder(model0, 2, occluder, 3, occluder_indices), BAD_ARG);
+  CHECK(rdr_model_occluder(model0, 3, occluder, 3, occluder_indices), OK);
+  CHECK(rdr_model_occluder(model0, 0, NULL, 0, NULL), OK);
+  CHECK(rdr_model_occluder(model1, 3, occluder, 3, occluder_indices), OK);
+
   CHECK(rdr_model_ref_get(NULL), BAD_ARG);
   CHECK(rdr_model_ref_get(model0), OK);
 
   CHECK(rdr_model_ref_put(NULL), BAD_ARG);
   CHECK(rdr_model_ref_put(model0), OK);
   CHECK(rdr_model_ref_put(model0), OK);
+  CHECK(rdr_model_lods(model1, 0, NULL), OK);
+  CHECK(rdr_get_model_lods(model1, &nb_lods, NULL), OK);
+  CHECK(nb_lods, 0);
   CHECK(rdr_model_ref_put(model1), OK);
 
+  CHECK(rdr_mesh_ref_put(lod_mesh), OK);
   CHECK(rdr_mesh_ref_put(mesh), OK);
   CHECK(rdr_material_ref_put(mtr), OK);
   CHECK(rdr_system_ref_put(sys), OK);
@@ -48,6 +48,7 @@ struct instance_cbk_data {
   struct rdr_model_instance_data* attrib_list;
   size_t nb_uniforms;
   size_t nb_attribs;
+  size_t nb_notifications;
 };
 
 static bool
@@ -74,6 +75,7 @@ instance_cbk_func
   struct instance_cbk_data* cbk_data = data;
 
   assert(cbk_data != NULL);
+  ++cbk_data->nb_notifications;
 
   if(cbk_data->uniform_list) {
     MEM_FREE(&mem_default_allocator, cbk_data->uniform_list);
@@ -318,6 +320,13 @@ main(int argc, char** argv)
   struct rdr_model* model = NULL;
   struct rdr_model_instance* inst = NULL;
   struct rdr_model_instance* inst1 = NULL;
+  struct rdr_model_instance* list[2] = { NULL, NULL };
+  const float transform_list[32] = {
+    1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f,
+    0.f, 0.f, 1.f, 0.f, 1.f, 2.f, 3.f, 1.f,
+    2.f, 0.f, 0.f, 0.f, 0.f, 2.f, 0.f, 0.f,
+    0.f, 0.f, 2.f, 0.f, 0.f, 0.f, 0.f, 1.f
+  };
   const char* vs_source =
     "#version 330\n"
     "uniform mat4x4 rdr_modelviewproj;\n"
@@ -406,6 +415,25 @@ main(int argc, char** argv)
   CHECK(rdr_create_model_instance(NULL, model, &inst), BAD_ARG);
   CHECK(rdr_create_model_instance(sys, model, &inst), OK);
 
+  CHECK(rdr_create_model_instances(NULL, NULL, 0, NULL, NULL), BAD_ARG);
+  CHECK(rdr_create_model_instances(sys, model, 2, NULL, NULL), BAD_ARG);
+  CHECK(rdr_create_model_instances(NULL, model, 2, NULL, list), BAD_ARG);
+  CHECK(rdr_create_model_instances(sys, NULL, 2, NULL, list), BAD_ARG);
+  CHECK(rdr_create_model_instances(sys, model, 0, NULL, NULL), OK);
+  CHECK(rdr_create_model_instances(sys, model, 2, transform_list, list), OK);
+  CHECK_TRANSFORM(list[0],
+     1.f, 0.f, 0.f, 0.f,
+     0.f, 1.f, 0.f, 0.f,
+     0.f, 0.f, 1.f, 0.f,
+     1.f, 2.f, 3.f, 1.f);
+  CHECK_TRANSFORM(list[1],
+     2.f, 0.f, 0.f, 0.f,
+     0.f, 2.f, 0.f, 0.f,
+     0.f, 0.f, 2.f, 0.f,
+     0.f, 0.f, 0.f, 1.f);
+  CHECK(rdr_model_instance_ref_put(list[0]), OK);
+  CHECK(rdr_model_instance_ref_put(list[1]), OK);
+
   CHECK(rdr_mesh_data(mesh, 1, attr1, SZ(data), data), OK);
 
   CHECK(rdr_attach_model_instance_callback(NULL, NULL, NULL), BAD_ARG);
@@ -426,6 +454,8 @@ main(int argc, char** argv)
     (inst, instance_cbk_func, &instance_cbk_data), OK);
 
   CHECK(rdr_mesh_data(mesh, 1, attr1, SZ(data), data), OK);
+  CHECK(rdr_system_flush_notifications(NULL), BAD_ARG);
+  CHECK(rdr_system_flush_notifications(sys), OK);
   if(!null_driver) {
     CHECK(instance_cbk_data.nb_uniforms, 1);
     CHECK(strcmp(instance_cbk_data.uniform_list[0].name, "tmp"), 0);
@@ -436,6 +466,7 @@ main(int argc, char** argv)
   }
 
   CHECK(rdr_mesh_data(mesh, 2, attr0, SZ(data), data), OK);
+  CHECK(rdr_system_flush_notifications(sys), OK);
   if(!null_driver) {
     CHECK(instance_cbk_data.nb_uniforms, 1);
     CHECK(strcmp(instance_cbk_data.uniform_list[0].name, "tmp"), 0);
@@ -445,12 +476,29 @@ main(int argc, char** argv)
 
   sources[RDR_VERTEX_SHADER] = vs_source1;
   CHECK(rdr_material_program(mtr, sources), OK);
+  CHECK(rdr_system_flush_notifications(sys), OK);
   if(!null_driver) {
     CHECK(instance_cbk_data.nb_uniforms, 0);
     CHECK(instance_cbk_data.nb_attribs, 2);
   }
 
   CHECK(rdr_mesh_data(mesh, 3, attr2, SZ(data), data), OK);
+  CHECK(rdr_system_flush_notifications(sys), OK);
+  if(!null_driver) {
+    CHECK(instance_cbk_data.nb_uniforms, 0);
+    CHECK(instance_cbk_data.nb_attribs, 0);
+  }
+
+  /* The updates of a frame are notified once to the instance. */
+  instance_cbk_data.nb_notifications = 0;
+  CHECK(rdr_mesh_data(mesh, 2, attr0, SZ(data), data), OK);
+  CHECK(rdr_mesh_data(mesh, 3, attr2, SZ(data), data), OK);
+  CHECK(rdr_material_program(mtr, sources), OK);
+  CHECK(instance_cbk_data.nb_notifications, 0);
+  CHECK(rdr_system_flush_notifications(sys), OK);
+  CHECK(instance_cbk_data.nb_notifications, 1);
+  CHECK(rdr_system_flush_notifications(sys), OK);
+  CHECK(instance_cbk_data.nb_notifications, 1);
   if(!null_driver) {
     CHECK(instance_cbk_data.nb_uniforms, 0);
     CHECK(instance_cbk_data.nb_attribs, 0);
@@ -1,4 +1,5 @@
 #include "renderer/rdr_font.h"
+#include "renderer/rdr_frame.h"
 #include "renderer/rdr_system.h"
 #include "renderer/rdr_term.h"
 #include "resources/rsrc_context.h"
@@ -23,6 +24,12 @@
     CHECK(wcscmp(dump, str), 0); \
     CHECK(wcslen(dump), len); \
   } while(0)
+#define DRAW(frame, term, stats) \
+  do { \
+    CHECK(rdr_frame_draw_term(frame, term), OK); \
+    CHECK(rdr_flush_frame(frame), OK); \
+    CHECK(rdr_get_term_stats(term, &stats), OK); \
+  } while(0)
 
 STATIC_ASSERT(BUFSIZ >= 128, Unexpected_constant);
 
@@ -56,7 +63,13 @@ main(int argc, char** argv)
   };
   /* Renderer data structures. */
   struct rdr_glyph_desc glyph_desc_list[nb_chars];
+  struct rdr_frame_desc frame_desc = {
+    .width = win_desc.width, .height = win_desc.height
+  };
+  struct rdr_term_stats stats;
+  size_t cursor_pos[2] = { 0, 0 };
   struct rdr_font* font = NULL;
+  struct rdr_frame* frame = NULL;
   struct rdr_system* sys = NULL;
   struct rdr_term* term = NULL;
 
@@ -162,6 +175,11 @@ main(int argc, char** argv)
   CHECK(rdr_term_font(NULL, font), BAD_ARG);
   CHECK(rdr_term_font(term, font), OK);
 
+  CHECK(rdr_term_position(NULL, 0, 0), BAD_ARG);
+  CHECK(rdr_term_position(term, INT_MAX, 0), BAD_ARG);
+  CHECK(rdr_term_position(term, 0, INT_MAX), BAD_ARG);
+  CHECK(rdr_term_position(term, 16, 8), OK);
+
   CHECK(rdr_term_write_backspace(NULL), BAD_ARG);
   CHECK(rdr_term_write_backspace(term), OK);
   CHECK(rdr_term_write_backspace(term), OK);
@@ -340,6 +358,82 @@ main(int argc, char** argv)
   CHECK(rdr_term_write_tab(NULL), BAD_ARG);
   CHECK(rdr_term_write_tab(term), OK);
 
+  /* Only the glyphs of the updated lines are rebuilt and uploaded. */
+  CHECK(rdr_create_frame(sys, &frame_desc, &frame), OK);
+  CHECK(rdr_clear_term(term, STDOUT), OK);
+  CHECK(rdr_clear_term(term, CMDOUT), OK);
+  CHECK(rdr_clear_term(term, PROMPT), OK);
+  CHECK(rdr_get_term_stats(NULL, NULL), BAD_ARG);
+  CHECK(rdr_get_term_stats(term, NULL), BAD_ARG);
+  CHECK(rdr_get_term_stats(NULL, &stats), BAD_ARG);
+  CHECK(rdr_term_print_wstring(term, STDOUT, L"12345\n", WHITE), OK);
+  CHECK(rdr_term_print_wstring(term, CMDOUT, L"abc", WHITE), OK);
+  DRAW(frame, term, stats);
+  CHECK(stats.nb_glyphs, 8);
+  CHECK(stats.first_uploaded_glyph, 0);
+  CHECK(stats.nb_uploaded_glyphs, 8);
+  NCHECK(stats.nb_rebuilt_lines, 0);
+  NCHECK(stats.cursor_pos[0], 0);
+  NCHECK(stats.cursor_width, 0);
+  cursor_pos[0] = stats.cursor_pos[0];
+  cursor_pos[1] = stats.cursor_pos[1];
+
+  DRAW(frame, term, stats);
+  CHECK(stats.nb_glyphs, 8);
+  CHECK(stats.nb_rebuilt_lines, 0);
+  CHECK(stats.nb_uploaded_glyphs, 0);
+
+  /* The cursor is read back from the cached glyphs. */
+  CHECK(rdr_term_translate_cursor(term, -1), OK);
+  DRAW(frame, term, stats);
+  CHECK(stats.nb_rebuilt_lines, 0);
+  CHECK(stats.nb_uploaded_glyphs, 0);
+  CHECK(stats.cursor_pos[0] < cursor_pos[0], true);
+  CHECK(stats.cursor_pos[1], cursor_pos[1]);
+  CHECK(rdr_term_translate_cursor(term, -INT_MAX), OK);
+  DRAW(frame, term, stats);
+  CHECK(stats.cursor_pos[0], 0);
+  CHECK(stats.cursor_pos[1], cursor_pos[1]);
+  CHECK(rdr_term_translate_cursor(term, INT_MAX), OK);
+  DRAW(frame, term, stats);
+  CHECK(stats.cursor_pos[0], cursor_pos[0]);
+  CHECK(stats.cursor_pos[1], cursor_pos[1]);
+
+  /* The command line shrinks. Only its glyphs are uploaded. */
+  CHECK(rdr_term_write_backspace(term), OK);
+  DRAW(frame, term, stats);
+  CHECK(stats.nb_glyphs, 7);
+  CHECK(stats.nb_rebuilt_lines, 1);
+  CHECK(stats.first_uploaded_glyph, 5);
+  CHECK(stats.nb_uploaded_glyphs, 2);
+  CHECK(stats.cursor_pos[0] < cursor_pos[0], true);
+  cursor_pos[0] = stats.cursor_pos[0];
+
+  CHECK(rdr_term_print_wchar(term, CMDOUT, L'd', WHITE), OK);
+  DRAW(frame, term, stats);
+  CHECK(stats.nb_glyphs, 8);
+  CHECK(stats.nb_rebuilt_lines, 1);
+  CHECK(stats.first_uploaded_glyph, 5);
+  CHECK(stats.nb_uploaded_glyphs, 3);
+  CHECK(stats.cursor_pos[0] > cursor_pos[0], true);
+
+  /* An empty line has no glyph to upload. */
+  CHECK(rdr_clear_term(term, CMDOUT), OK);
+  DRAW(frame, term, stats);
+  CHECK(stats.nb_glyphs, 5);
+  CHECK(stats.nb_rebuilt_lines, 1);
+  CHECK(stats.nb_uploaded_glyphs, 0);
+  CHECK(stats.cursor_pos[0], 0);
+
+  /* The command line is moved at the beginning of the glyphs. */
+  CHECK(rdr_term_print_wstring(term, CMDOUT, L"ab", WHITE), OK);
+  CHECK(rdr_clear_term(term, STDOUT), OK);
+  DRAW(frame, term, stats);
+  CHECK(stats.nb_glyphs, 2);
+  CHECK(stats.first_uploaded_glyph, 0);
+  CHECK(stats.nb_uploaded_glyphs, 2);
+  CHECK(rdr_frame_ref_put(frame), OK);
+
   CHECK(rdr_term_ref_get(NULL), BAD_ARG);
   CHECK(rdr_term_ref_get(term), OK);
   CHECK(rdr_term_ref_put(NULL), BAD_ARG);
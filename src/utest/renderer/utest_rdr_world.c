@@ -1,3 +1,4 @@
+#include "renderer/rdr_frame.h"
 #include "renderer/rdr_material.h"
 #include "renderer/rdr_mesh.h"
 #include "renderer/rdr_model.h"
@@ -29,16 +30,53 @@ main(int argc, char** argv)
   /* Renderer data structures. */
   struct rdr_system* sys = NULL;
   struct rdr_mesh* mesh = NULL;
+  struct rdr_mesh* lod_mesh = NULL;
   struct rdr_material* mtr = NULL;
   struct rdr_model* mdl = NULL;
+  struct rdr_model* wall = NULL;
   struct rdr_model_instance* inst0 = NULL;
   struct rdr_model_instance* inst1 = NULL;
   struct rdr_model_instance* inst2 = NULL;
+  struct rdr_model_instance* wall_inst = NULL;
+  struct rdr_model_instance* list[4] = { NULL, NULL, NULL, NULL };
   struct rdr_world* world = NULL;
+  struct rdr_frame* frame = NULL;
+  struct rdr_frame_stats stats;
+  struct rdr_model_lod lod;
+  float transform[16] = {
+    1.f, 0.f, 0.f, 0.f,
+    0.f, 1.f, 0.f, 0.f,
+    0.f, 0.f, 1.f, 0.f,
+    0.f, 0.f, 0.f, 1.f
+  };
+  size_t i = 0;
+  const struct rdr_frame_desc frame_desc = {
+    .width = win_desc.width, .height = win_desc.height
+  };
+  const struct rdr_view view = {
+    .transform = {
+      1.f, 0.f, 0.f, 0.f,
+      0.f, 1.f, 0.f, 0.f,
+      0.f, 0.f, 1.f, 0.f,
+      0.f, 0.f, 0.f, 1.f
+    },
+    .proj_ratio = 4.f / 3.f,
+    .fov_x = 1.4f,
+    .znear = 1.f,
+    .zfar = 100.f,
+    .x = 0,
+    .y = 0,
+    .width = win_desc.width,
+    .height = win_desc.height
+  };
 
   /* Renderer data. */
   const float data[] = { 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 1.f };
-  const unsigned int indices[] = { 0, 1, 0 };
+  const unsigned int indices[] = { 0, 1, 0, 1, 0, 1 };
+  const float wall_vertices[] = {
+    -1.f, -1.f, -5.f, 1.f, -1.f, -5.f, -1.f, 1.f, -5.f, 1.f, 1.f, -5.f
+  };
+  const unsigned int wall_indices[] = { 0, 1, 2, 2, 1, 3 };
   const struct rdr_mesh_attrib attr[] = {
     { .usage = RDR_ATTRIB_POSITION, .type = RDR_FLOAT4 }
   };
@@ -74,7 +112,10 @@ main(int argc, char** argv)
 
   CHECK(rdr_create_mesh(sys, &mesh), RDR_NO_ERROR);
   CHECK(rdr_mesh_data(mesh, 1, attr, sizeof(data), data), RDR_NO_ERROR);
-  CHECK(rdr_mesh_indices(mesh, 3, indices), RDR_NO_ERROR);
+  CHECK(rdr_mesh_indices(mesh, 6, indices), RDR_NO_ERROR);
+  CHECK(rdr_create_mesh(sys, &lod_mesh), RDR_NO_ERROR);
+  CHECK(rdr_mesh_data(lod_mesh, 1, attr, sizeof(data), data), RDR_NO_ERROR);
+  CHECK(rdr_mesh_indices(lod_mesh, 3, indices), RDR_NO_ERROR);
   CHECK(rdr_create_material(sys, &mtr), RDR_NO_ERROR);
   CHECK(rdr_material_program(mtr, sources), RDR_NO_ERROR);
   CHECK(rdr_create_model(sys, mesh, mtr, &mdl), RDR_NO_ERROR);
@@ -95,6 +136,114 @@ main(int argc, char** argv)
   CHECK(rdr_add_model_instance(world, inst1), RDR_NO_ERROR);
   CHECK(rdr_add_model_instance(world, inst2), RDR_NO_ERROR);
 
+  CHECK(rdr_create_frame(sys, &frame_desc, &frame), RDR_NO_ERROR);
+  CHECK(rdr_frame_draw_world(frame, world, &view), RDR_NO_ERROR);
+  CHECK(rdr_flush_frame(frame), RDR_NO_ERROR);
+  CHECK(rdr_get_frame_stats(frame, &stats), RDR_NO_ERROR);
+  CHECK(stats.nb_instances, 3);
+  CHECK(stats.nb_triangles, 6);
+  CHECK(rdr_flush_frame(frame), RDR_NO_ERROR);
+  CHECK(rdr_get_frame_stats(frame, &stats), RDR_NO_ERROR);
+  CHECK(stats.nb_instances, 0);
+  CHECK(stats.nb_triangles, 0);
+
+  /* The coarse level of detail is projected onto 1 pixel at a distance of
+   * ~5.2 from the view point, and is selected below 0.75 pixel. */
+  lod.mesh = lod_mesh;
+  lod.error = 0.01f;
+  CHECK(rdr_model_lods(mdl, 1, &lod), RDR_NO_ERROR);
+  transform[14] = -2.f;
+  CHECK(rdr_model_instance_transform(inst0, transform), RDR_NO_ERROR);
+  transform[14] = -50.f;
+  CHECK(rdr_model_instance_transform(inst1, transform), RDR_NO_ERROR);
+  CHECK(rdr_frame_draw_world(frame, world, &view), RDR_NO_ERROR);
+  CHECK(rdr_flush_frame(frame), RDR_NO_ERROR);
+  CHECK(rdr_get_frame_stats(frame, &stats), RDR_NO_ERROR);
+  CHECK(stats.nb_triangles, 5);
+
+  /* Hysteresis of the selection between 0.75 and 1 pixel. */
+  transform[14] = -6.5f;
+  CHECK(rdr_model_instance_transform(inst0, transform), RDR_NO_ERROR);
+  CHECK(rdr_model_instance_transform(inst1, transform), RDR_NO_ERROR);
+  CHECK(rdr_frame_draw_world(frame, world, &view), RDR_NO_ERROR);
+  CHECK(rdr_flush_frame(frame), RDR_NO_ERROR);
+  CHECK(rdr_get_frame_stats(frame, &stats), RDR_NO_ERROR);
+  CHECK(stats.nb_triangles, 5);
+
+  CHECK(rdr_system_lod_threshold(NULL, 1.f), RDR_INVALID_ARGUMENT);
+  CHECK(rdr_system_lod_threshold(sys, -1.f), RDR_INVALID_ARGUMENT);
+  CHECK(rdr_system_lod_threshold(sys, 0.f), RDR_NO_ERROR);
+  CHECK(rdr_frame_draw_world(frame, world, &view), RDR_NO_ERROR);
+  CHECK(rdr_flush_frame(frame), RDR_NO_ERROR);
+  CHECK(rdr_get_frame_stats(frame, &stats), RDR_NO_ERROR);
+  CHECK(stats.nb_triangles, 6);
+  CHECK(rdr_system_lod_threshold(sys, 1.f), RDR_NO_ERROR);
+  CHECK(rdr_frame_draw_world(frame, world, &view), RDR_NO_ERROR);
+  CHECK(rdr_flush_frame(frame), RDR_NO_ERROR);
+  CHECK(rdr_get_frame_stats(frame, &stats), RDR_NO_ERROR);
+  CHECK(stats.nb_triangles, 6);
+
+  CHECK(rdr_model_lods(mdl, 0, NULL), RDR_NO_ERROR);
+  transform[14] = -50.f;
+  CHECK(rdr_model_instance_transform(inst1, transform), RDR_NO_ERROR);
+  CHECK(rdr_frame_draw_world(frame, world, &view), RDR_NO_ERROR);
+  CHECK(rdr_flush_frame(frame), RDR_NO_ERROR);
+  CHECK(rdr_get_frame_stats(frame, &stats), RDR_NO_ERROR);
+  CHECK(stats.nb_triangles, 6);
+
+  /* The wall hides inst0 and inst1, and inst2 lies behind the near plane. */
+  CHECK(rdr_create_model(sys, mesh, mtr, &wall), RDR_NO_ERROR);
+  CHECK(rdr_model_occluder(NULL, 4, wall_vertices, 6, wall_indices),
+    RDR_INVALID_ARGUMENT);
+  CHECK(rdr_model_occluder(wall, 4, wall_vertices, 5, wall_indices),
+    RDR_INVALID_ARGUMENT);
+  CHECK(rdr_model_occluder(wall, 3, wall_vertices, 6, wall_indices),
+    RDR_INVALID_ARGUMENT);
+  CHECK(rdr_model_occluder(wall, 4, wall_vertices, 6, wall_indices),
+    RDR_NO_ERROR);
+  CHECK(rdr_create_model_instance(sys, wall, &wall_inst), RDR_NO_ERROR);
+  CHECK(rdr_add_model_instance(world, wall_inst), RDR_NO_ERROR);
+  CHECK(rdr_world_occlusion_culling(NULL, true), RDR_INVALID_ARGUMENT);
+  CHECK(rdr_world_occlusion_culling(world, true), RDR_NO_ERROR);
+  CHECK(rdr_frame_draw_world(frame, world, &view), RDR_NO_ERROR);
+  CHECK(rdr_flush_frame(frame), RDR_NO_ERROR);
+  CHECK(rdr_get_frame_stats(frame, &stats), RDR_NO_ERROR);
+  CHECK(stats.nb_instances, 4);
+  CHECK(stats.nb_culled_instances, 3);
+  CHECK(stats.nb_triangles, 2);
+
+  transform[14] = -2.f;
+  CHECK(rdr_model_instance_transform(inst0, transform), RDR_NO_ERROR);
+  transform[12] = 20.f;
+  transform[14] = -50.f;
+  CHECK(rdr_model_instance_transform(inst1, transform), RDR_NO_ERROR);
+  CHECK(rdr_frame_draw_world(frame, world, &view), RDR_NO_ERROR);
+  CHECK(rdr_flush_frame(frame), RDR_NO_ERROR);
+  CHECK(rdr_get_frame_stats(frame, &stats), RDR_NO_ERROR);
+  CHECK(stats.nb_instances, 4);
+  CHECK(stats.nb_culled_instances, 1);
+
+  /* Without occluder, only inst2 and wall_inst that lie on the view point
+   * are culled. */
+  transform[12] = 0.f;
+  CHECK(rdr_model_instance_transform(inst1, transform), RDR_NO_ERROR);
+  CHECK(rdr_model_occluder(wall, 0, NULL, 0, NULL), RDR_NO_ERROR);
+  CHECK(rdr_frame_draw_world(frame, world, &view), RDR_NO_ERROR);
+  CHECK(rdr_flush_frame(frame), RDR_NO_ERROR);
+  CHECK(rdr_get_frame_stats(frame, &stats), RDR_NO_ERROR);
+  CHECK(stats.nb_culled_instances, 2);
+
+  CHECK(rdr_world_occlusion_culling(world, false), RDR_NO_ERROR);
+  CHECK(rdr_frame_draw_world(frame, world, &view), RDR_NO_ERROR);
+  CHECK(rdr_flush_frame(frame), RDR_NO_ERROR);
+  CHECK(rdr_get_frame_stats(frame, &stats), RDR_NO_ERROR);
+  CHECK(stats.nb_instances, 4);
+  CHECK(stats.nb_culled_instances, 0);
+  CHECK(rdr_remove_model_instance(world, wall_inst), RDR_NO_ERROR);
+  CHECK(rdr_model_instance_ref_put(wall_inst), RDR_NO_ERROR);
+  CHECK(rdr_model_ref_put(wall), RDR_NO_ERROR);
+  CHECK(rdr_frame_ref_put(frame), RDR_NO_ERROR);
+
   CHECK(rdr_remove_model_instance(NULL, NULL), RDR_INVALID_ARGUMENT);
   CHECK(rdr_remove_model_instance(world, NULL), RDR_INVALID_ARGUMENT);
   CHECK(rdr_remove_model_instance(NULL, inst0), RDR_INVALID_ARGUMENT);
@@ -103,6 +252,26 @@ main(int argc, char** argv)
   CHECK(rdr_remove_model_instance(world, inst1), RDR_NO_ERROR);
   CHECK(rdr_remove_model_instance(world, inst2), RDR_NO_ERROR);
 
+  CHECK(rdr_create_model_instances(sys, mdl, 4, NULL, list), RDR_NO_ERROR);
+  CHECK(rdr_add_model_instances(NULL, 4, list), RDR_INVALID_ARGUMENT);
+  CHECK(rdr_add_model_instances(world, 4, NULL), RDR_INVALID_ARGUMENT);
+  CHECK(rdr_add_model_instances(world, 0, NULL), RDR_NO_ERROR);
+  CHECK(rdr_add_model_instances(world, 4, list), RDR_NO_ERROR);
+  CHECK(rdr_add_model_instances(world, 1, list + 2), RDR_INVALID_ARGUMENT);
+  CHECK(rdr_add_model_instances
+    (world, 2, (struct rdr_model_instance*[]){inst0, inst0}),
+    RDR_INVALID_ARGUMENT);
+  CHECK(rdr_add_model_instances
+    (world, 2, (struct rdr_model_instance*[]){inst0, list[1]}),
+    RDR_INVALID_ARGUMENT);
+  CHECK(rdr_remove_model_instance(world, inst0), RDR_INVALID_ARGUMENT);
+  CHECK(rdr_add_model_instances(world, 1, &inst0), RDR_NO_ERROR);
+  CHECK(rdr_remove_model_instance(world, inst0), RDR_NO_ERROR);
+  for(i = 0; i < 4; ++i) {
+    CHECK(rdr_remove_model_instance(world, list[i]), RDR_NO_ERROR);
+    CHECK(rdr_model_instance_ref_put(list[i]), RDR_NO_ERROR);
+  }
+
   CHECK(rdr_world_ref_get(NULL), RDR_INVALID_ARGUMENT);
   CHECK(rdr_world_ref_get(world), RDR_NO_ERROR);
   CHECK(rdr_world_ref_put(NULL), RDR_INVALID_ARGUMENT);
@@ -114,6 +283,7 @@ main(int argc, char** argv)
   CHECK(rdr_model_instance_ref_put(inst2), RDR_NO_ERROR);
   CHECK(rdr_model_ref_put(mdl), RDR_NO_ERROR);
   CHECK(rdr_material_ref_put(mtr), RDR_NO_ERROR);
+  CHECK(rdr_mesh_ref_put(lod_mesh), RDR_NO_ERROR);
   CHECK(rdr_mesh_ref_put(mesh), RDR_NO_ERROR);
   CHECK(rdr_system_ref_put(sys), RDR_NO_ERROR);
 
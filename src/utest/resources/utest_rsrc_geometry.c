@@ -0,0 +1,745 @@
+#include "resources/rsrc_context.h"
+#include "resources/rsrc_geometry.h"
+#include "resources/rsrc_wavefront_obj.h"
+#include "sys/mem_allocator.h"
+#include "utest/utest.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define OK RSRC_NO_ERROR
+#define BAD_ARG RSRC_INVALID_ARGUMENT
+#define PATH "/tmp/ngons.obj"
+#define GEOM_PATH "/tmp/ngons.geom"
+#define PI 3.14159265358979323846f
+
+/* Shapes of the generated n-gon corpus. */
+enum shape {
+  SHAPE_CONVEX, /* Regular polygon. */
+  SHAPE_STAR, /* Concave star with nb_verts / 2 spikes. */
+  SHAPE_COMB, /* Concave comb with (nb_verts - 2) / 4 teeth. */
+  NB_SHAPES
+};
+
+/* Planes onto which the 2D shapes are mapped with an isometry. */
+enum plane {
+  PLANE_XY,
+  PLANE_YZ,
+  PLANE_ZX,
+  PLANE_TILTED,
+  NB_PLANES
+};
+
+/* Make the first index of the geometry file reference a missing vertex and
+ * update the file checksum accordingly. The offsets follow the layout of the
+ * version 1 geometry files. */
+static void
+write_invalid_index(const char* path)
+{
+  const size_t sizeof_header = 64;
+  const size_t checksum_offset = 24;
+  const size_t index_offset_offset = sizeof_header + 16;
+  const unsigned int invalid_index = 0xFFFFFFFF;
+  FILE* fp = NULL;
+  char* file = NULL;
+  uint64_t index_offset = 0;
+  uint64_t sum = 14695981039346656037ULL;
+  long size = 0;
+  size_t i = 0;
+
+  fp = fopen(path, "r+");
+  NCHECK(fp, NULL);
+  CHECK(fseek(fp, 0, SEEK_END), 0);
+  size = ftell(fp);
+  CHECK(size > 0 && (size_t)size > index_offset_offset + 8, true);
+  file = malloc((size_t)size);
+  NCHECK(file, NULL);
+  rewind(fp);
+  CHECK(fread(file, (size_t)size, 1, fp), 1);
+
+  memcpy(&index_offset, file + index_offset_offset, sizeof(uint64_t));
+  CHECK(index_offset + sizeof(unsigned int) <= (uint64_t)size, true);
+  memcpy(file + index_offset, &invalid_index, sizeof(unsigned int));
+  for(i = sizeof_header; i < (size_t)size; i += sizeof(uint64_t)) {
+    uint64_t word = 0;
+    memcpy(&word, file + i, sizeof(uint64_t));
+    sum = (sum ^ word) * 1099511628211ULL;
+  }
+  memcpy(file + checksum_offset, &sum, sizeof(uint64_t));
+
+  rewind(fp);
+  CHECK(fwrite(file, (size_t)size, 1, fp), 1);
+  CHECK(fclose(fp), 0);
+  free(file);
+}
+
+static void
+shape_vertex(enum shape shape, size_t nb_verts, size_t i, float out[2])
+{
+  float angle = 0.f;
+  float radius = 1.f;
+
+  switch(shape) {
+    case SHAPE_CONVEX:
+      angle = 2.f * PI * (float)i / (float)nb_verts;
+      break;
+    case SHAPE_STAR:
+      angle = 2.f * PI * (float)i / (float)nb_verts;
+      radius = (i % 2) ? 0.25f : 1.f;
+      break;
+    case SHAPE_COMB:
+      /* The comb lies on a straight bottom edge. Its teeth are listed from
+       * right to left. */
+      if(i < 2) {
+        out[0] = i == 0 ? 0.f : (float)((nb_verts - 2) / 4);
+        out[1] = 0.f;
+      } else {
+        const size_t tooth = (nb_verts - 2) / 4 - 1 - (i - 2) / 4;
+        switch((i - 2) % 4) {
+          case 0: out[0] = (float)tooth + 1.f; out[1] = 2.f; break;
+          case 1: out[0] = (float)tooth + 0.5f; out[1] = 2.f; break;
+          case 2: out[0] = (float)tooth + 0.5f; out[1] = 1.f; break;
+          case 3: out[0] = (float)tooth; out[1] = 1.f; break;
+        }
+      }
+      return;
+    default: ERROR; break;
+  }
+  out[0] = radius * cosf(angle);
+  out[1] = radius * sinf(angle);
+}
+
+static void
+plane_vertex(enum plane plane, const float v[2], float out[3])
+{
+  switch(plane) {
+    case PLANE_XY: out[0] = v[0]; out[1] = v[1]; out[2] = 0.f; break;
+    case PLANE_YZ: out[0] = 5.f; out[1] = v[0]; out[2] = v[1]; break;
+    case PLANE_ZX: out[0] = v[1]; out[1] = -2.f; out[2] = v[0]; break;
+    case PLANE_TILTED:
+      out[0] = v[0]; out[1] = 0.6f * v[1]; out[2] = 0.8f * v[1];
+      break;
+    default: ERROR; break;
+  }
+}
+
+/* Twice the signed area of the 2D polygon. */
+static float
+shape_area(enum shape shape, size_t nb_verts)
+{
+  float area = 0.f;
+  size_t i = 0;
+  for(i = 0; i < nb_verts; ++i) {
+    float a[2], b[2];
+    shape_vertex(shape, nb_verts, i, a);
+    shape_vertex(shape, nb_verts, (i + 1) % nb_verts, b);
+    area += a[0] * b[1] - a[1] * b[0];
+  }
+  return area;
+}
+
+static size_t
+shape_nb_verts(enum shape shape, size_t n)
+{
+  switch(shape) {
+    case SHAPE_CONVEX: return n;
+    case SHAPE_STAR: return 2 * n;
+    case SHAPE_COMB: return 4 * n + 2;
+    default: ERROR; break;
+  }
+  return 0;
+}
+
+/* Write a polygon per group and return the overall number of triangles
+ * expected from their triangulation. */
+static size_t
+write_corpus(FILE* fp, size_t max_n, bool* flip_list, float* area_list)
+{
+  size_t nb_polys = 0;
+  size_t nb_verts_overall = 0;
+  size_t nb_triangles = 0;
+  size_t n = 0;
+  int shape = 0;
+  int plane = 0;
+
+  /* The polygon vertices share the same texture coordinate and normal. */
+  fprintf(fp, "vt 0 0\nvn 0 0 1\n");
+  for(shape = 0; shape < NB_SHAPES; ++shape) {
+  for(plane = 0; plane < NB_PLANES; ++plane) {
+  for(n = 3; n <= max_n; ++n) {
+    const size_t nb_verts = shape_nb_verts(shape, n);
+    const bool flip = (n % 2) == 0;
+    size_t i = 0;
+
+    for(i = 0; i < nb_verts; ++i) {
+      float v2[2], v3[3];
+      shape_vertex(shape, nb_verts, i, v2);
+      plane_vertex(plane, v2, v3);
+      fprintf(fp, "v %f %f %f\n", v3[0], v3[1], v3[2]);
+    }
+    fprintf(fp, "g poly%zu\nf", nb_polys);
+    /* Reverse the winding of half the polygons. */
+    for(i = 0; i < nb_verts; ++i) {
+      const size_t id = flip ? nb_verts - 1 - i : i;
+      fprintf(fp, " %zu/1/1", nb_verts_overall + id + 1);
+    }
+    fprintf(fp, "\n");
+
+    flip_list[nb_polys] = flip;
+    area_list[nb_polys] = shape_area(shape, nb_verts);
+    nb_verts_overall += nb_verts;
+    nb_triangles += nb_verts - 2;
+    ++nb_polys;
+  }}}
+  return nb_triangles;
+}
+
+/* Write a grid of nb_quads^2 quads whose faces are listed in a pseudo random
+ * order. Each vertex has its own normal and texcoord. The grid is bumped by
+ * height in its center. */
+static float
+grid_height(float height, float u, float v)
+{
+  return height * sinf(PI * u) * sinf(PI * v);
+}
+
+static void
+write_grid(FILE* fp, size_t nb_quads, float height)
+{
+  const size_t nb_verts = (nb_quads + 1) * (nb_quads + 1);
+  size_t* quad_list = NULL;
+  size_t i = 0;
+  unsigned int seed = 1;
+
+  for(i = 0; i < nb_verts; ++i) {
+    const float u = (float)(i % (nb_quads + 1)) / (float)nb_quads;
+    const float v = (float)(i / (nb_quads + 1)) / (float)nb_quads;
+    const float nor[3] = { cosf(6.f*u), sinf(6.f*u), cosf(3.f*v) };
+    const float len =
+      sqrtf(nor[0]*nor[0] + nor[1]*nor[1] + nor[2]*nor[2]);
+    fprintf(fp, "v %f %f %f\n", u, v, grid_height(height, u, v));
+    fprintf(fp, "vn %f %f %f\n", nor[0]/len, nor[1]/len, nor[2]/len);
+    fprintf(fp, "vt %f %f\n", u, v);
+  }
+  quad_list = malloc(nb_quads * nb_quads * sizeof(size_t));
+  NCHECK(quad_list, NULL);
+  for(i = 0; i < nb_quads * nb_quads; ++i)
+    quad_list[i] = i;
+  for(i = nb_quads * nb_quads - 1; i > 0; --i) {
+    size_t j = 0;
+    size_t tmp = 0;
+    seed = seed * 1103515245u + 12345u;
+    j = (seed >> 8) % (i + 1);
+    tmp = quad_list[i];
+    quad_list[i] = quad_list[j];
+    quad_list[j] = tmp;
+  }
+  fprintf(fp, "g grid\n");
+  for(i = 0; i < nb_quads * nb_quads; ++i) {
+    const size_t x = quad_list[i] % nb_quads;
+    const size_t y = quad_list[i] / nb_quads;
+    const size_t a = y * (nb_quads + 1) + x + 1;
+    const size_t b = a + 1;
+    const size_t c = b + nb_quads + 1;
+    const size_t d = a + nb_quads + 1;
+    fprintf(fp, "f %zu/%zu/%zu %zu/%zu/%zu %zu/%zu/%zu\n", a,a,a, b,b,b, c,c,c);
+    fprintf(fp, "f %zu/%zu/%zu %zu/%zu/%zu %zu/%zu/%zu\n", a,a,a, c,c,c, d,d,d);
+  }
+  free(quad_list);
+}
+
+static float
+half_to_float(uint16_t half)
+{
+  const float sign = (half & 0x8000) ? -1.f : 1.f;
+  const int exponent = (half >> 10) & 0x1F;
+  const float mantissa = (float)(half & 0x3FF);
+  if(exponent == 0)
+    return sign * ldexpf(mantissa, -24);
+  return sign * ldexpf(1024.f + mantissa, exponent - 25);
+}
+
+static void
+decode_octahedral_normal(const int16_t oct[2], float nor[3])
+{
+  const float x = (float)oct[0] / 32767.f;
+  const float y = (float)oct[1] / 32767.f;
+  float len = 0.f;
+  nor[2] = 1.f - fabsf(x) - fabsf(y);
+  if(nor[2] < 0.f) {
+    nor[0] = (1.f - fabsf(y)) * (x >= 0.f ? 1.f : -1.f);
+    nor[1] = (1.f - fabsf(x)) * (y >= 0.f ? 1.f : -1.f);
+  } else {
+    nor[0] = x;
+    nor[1] = y;
+  }
+  len = sqrtf(nor[0]*nor[0] + nor[1]*nor[1] + nor[2]*nor[2]);
+  nor[0] /= len;
+  nor[1] /= len;
+  nor[2] /= len;
+}
+
+static int
+cmp_triangle(const void* a, const void* b)
+{
+  return memcmp(a, b, sizeof(float[9]));
+}
+
+/* List the positions of the triangles of the primitive set. Each triangle
+ * starts with its smallest vertex in order to be independent of the first
+ * vertex while keeping its winding. */
+static float*
+sorted_triangles(const struct rsrc_primitive_set* prim_set, size_t stride)
+{
+  float* tri_list = malloc(prim_set->nb_indices * sizeof(float[3]));
+  size_t i = 0;
+  NCHECK(tri_list, NULL);
+
+  for(i = 0; i < prim_set->nb_indices; i += 3) {
+    const float* pos[3];
+    size_t first = 0;
+    size_t j = 0;
+    for(j = 0; j < 3; ++j) {
+      pos[j] = (const float*)
+        ((const char*)prim_set->data + prim_set->index_list[i+j] * stride);
+      if(memcmp(pos[j], pos[first], sizeof(float[3])) < 0)
+        first = j;
+    }
+    for(j = 0; j < 3; ++j)
+      memcpy(tri_list + (i + j) * 3, pos[(first+j)%3], sizeof(float[3]));
+  }
+  qsort(tri_list, prim_set->nb_indices / 3, sizeof(float[9]), cmp_triangle);
+  return tri_list;
+}
+
+static void
+test_optimization
+  (struct rsrc_context* ctxt,
+   struct rsrc_wavefront_obj* wobj,
+   struct rsrc_geometry* geom)
+{
+  #define NB_QUADS 64
+  struct rsrc_geometry_stats stats_ref;
+  struct rsrc_geometry_stats stats;
+  struct rsrc_primitive_set prim_set_ref;
+  struct rsrc_primitive_set prim_set;
+  struct rsrc_geometry* geom_ref = NULL;
+  float* tri_list_ref = NULL;
+  float* tri_list = NULL;
+  float (*vertex_list)[8] = NULL;
+  FILE* fp = NULL;
+  size_t nb_verts = 0;
+  size_t i = 0;
+
+  fp = fopen(PATH, "w");
+  NCHECK(fp, NULL);
+  write_grid(fp, NB_QUADS, 0.f);
+  CHECK(fclose(fp), 0);
+
+  CHECK(rsrc_create_geometry(ctxt, &geom_ref), OK);
+  CHECK(rsrc_load_wavefront_obj(wobj, PATH), OK);
+  CHECK(rsrc_geometry_from_wavefront_obj(geom_ref, wobj), OK);
+  CHECK(rsrc_geometry_from_wavefront_obj(geom, wobj), OK);
+
+  CHECK(rsrc_get_geometry_stats(NULL, 0, NULL), BAD_ARG);
+  CHECK(rsrc_get_geometry_stats(geom, 0, NULL), BAD_ARG);
+  CHECK(rsrc_get_geometry_stats(NULL, 16, NULL), BAD_ARG);
+  CHECK(rsrc_get_geometry_stats(geom, 16, NULL), BAD_ARG);
+  CHECK(rsrc_get_geometry_stats(NULL, 0, &stats), BAD_ARG);
+  CHECK(rsrc_get_geometry_stats(geom, 0, &stats), BAD_ARG);
+  CHECK(rsrc_get_geometry_stats(NULL, 16, &stats), BAD_ARG);
+  CHECK(rsrc_get_geometry_stats(geom_ref, 16, &stats_ref), OK);
+  CHECK(stats_ref.nb_vertices, (NB_QUADS + 1) * (NB_QUADS + 1));
+  CHECK(stats_ref.nb_triangles, 2 * NB_QUADS * NB_QUADS);
+  CHECK(stats_ref.sizeof_vertex_data, stats_ref.nb_vertices*sizeof(float[8]));
+  CHECK(stats_ref.sizeof_index_data, stats_ref.nb_triangles * 3 * 4);
+  /* The faces are randomly ordered. */
+  CHECK(stats_ref.acmr > 1.9f, true);
+
+  /* Reorder the triangles and the vertices. */
+  CHECK(rsrc_optimize_geometry(NULL, 0), BAD_ARG);
+  CHECK(rsrc_optimize_geometry(geom, 0), OK);
+  CHECK(rsrc_optimize_geometry
+    (geom, RSRC_OPTIMIZE_VERTEX_CACHE | RSRC_OPTIMIZE_VERTEX_FETCH), OK);
+  CHECK(rsrc_get_geometry_stats(geom, 16, &stats), OK);
+  CHECK(stats.nb_vertices, stats_ref.nb_vertices);
+  CHECK(stats.nb_triangles, stats_ref.nb_triangles);
+  CHECK(stats.sizeof_vertex_data, stats_ref.sizeof_vertex_data);
+  CHECK(stats.acmr < 0.7f, true);
+  CHECK(stats.atvr < 1.3f, true);
+
+  CHECK(rsrc_get_primitive_set(geom_ref, 0, &prim_set_ref), OK);
+  CHECK(rsrc_get_primitive_set(geom, 0, &prim_set), OK);
+  CHECK(prim_set.nb_indices, prim_set_ref.nb_indices);
+  /* The vertices are stored in the order of their first use. */
+  for(i = 0, nb_verts = 0; i < prim_set.nb_indices; ++i) {
+    CHECK(prim_set.index_list[i] <= nb_verts, true);
+    if(prim_set.index_list[i] == nb_verts)
+      ++nb_verts;
+  }
+  CHECK(nb_verts, stats.nb_vertices);
+  /* The optimized geometry has the same triangles. */
+  tri_list_ref = sorted_triangles(&prim_set_ref, sizeof(float[8]));
+  tri_list = sorted_triangles(&prim_set, sizeof(float[8]));
+  CHECK(memcmp
+    (tri_list, tri_list_ref, prim_set.nb_indices * sizeof(float[3])), 0);
+  free(tri_list_ref);
+  free(tri_list);
+
+  /* Quantize the normals and the texcoords. */
+  vertex_list = malloc(prim_set.sizeof_data);
+  NCHECK(vertex_list, NULL);
+  memcpy(vertex_list, prim_set.data, prim_set.sizeof_data);
+  CHECK(rsrc_optimize_geometry
+    (geom, RSRC_QUANTIZE_NORMALS | RSRC_QUANTIZE_TEXCOORDS), OK);
+  CHECK(rsrc_get_geometry_stats(geom, 16, &stats_ref), OK);
+  CHECK(stats_ref.nb_vertices, stats.nb_vertices);
+  CHECK(stats_ref.nb_transformed_vertices, stats.nb_transformed_vertices);
+  CHECK(stats_ref.sizeof_vertex_data, stats.nb_vertices * 20);
+  CHECK(rsrc_get_primitive_set(geom, 0, &prim_set), OK);
+  CHECK(prim_set.nb_attribs, 3);
+  CHECK(prim_set.attrib_list[0].type, RSRC_FLOAT3);
+  CHECK(prim_set.attrib_list[1].usage, RSRC_ATTRIB_NORMAL);
+  CHECK(prim_set.attrib_list[1].type, RSRC_SNORM16x2);
+  CHECK(prim_set.attrib_list[2].usage, RSRC_ATTRIB_TEXCOORD);
+  CHECK(prim_set.attrib_list[2].type, RSRC_HALF2);
+  for(i = 0; i < stats.nb_vertices; ++i) {
+    const char* vertex = (const char*)prim_set.data + i * 20;
+    float pos[3], nor[3];
+    int16_t oct[2];
+    uint16_t tex[2];
+
+    memcpy(pos, vertex, sizeof(pos));
+    memcpy(oct, vertex + 12, sizeof(oct));
+    memcpy(tex, vertex + 16, sizeof(tex));
+    CHECK(memcmp(pos, vertex_list[i], sizeof(pos)), 0);
+    decode_octahedral_normal(oct, nor);
+    CHECK(fabsf(nor[0] - vertex_list[i][3]) < 1.e-3f, true);
+    CHECK(fabsf(nor[1] - vertex_list[i][4]) < 1.e-3f, true);
+    CHECK(fabsf(nor[2] - vertex_list[i][5]) < 1.e-3f, true);
+    CHECK(fabsf(half_to_float(tex[0]) - vertex_list[i][6]) < 1.e-3f, true);
+    CHECK(fabsf(half_to_float(tex[1]) - vertex_list[i][7]) < 1.e-3f, true);
+  }
+  free(vertex_list);
+
+  /* The quantized geometry can be cached but not optimized once mapped. */
+  CHECK(rsrc_write_geometry(geom, NULL, GEOM_PATH), OK);
+  CHECK(rsrc_load_geometry(geom_ref, NULL, GEOM_PATH), OK);
+  CHECK(rsrc_get_geometry_stats(geom_ref, 16, &stats), OK);
+  CHECK(memcmp(&stats, &stats_ref, sizeof(stats)), 0);
+  CHECK(rsrc_optimize_geometry(geom_ref, 0), RSRC_INVALID_CALL);
+  CHECK(rsrc_flush_error(ctxt), OK);
+
+  CHECK(rsrc_geometry_ref_put(geom_ref), OK);
+  #undef NB_QUADS
+}
+
+static float
+triangles_area(const struct rsrc_primitive_set* prim_set)
+{
+  const float* data = prim_set->data;
+  float area = 0.f;
+  size_t i = 0;
+
+  for(i = 0; i < prim_set->nb_indices; i += 3) {
+    const float* a = data + prim_set->index_list[i + 0] * 8;
+    const float* b = data + prim_set->index_list[i + 1] * 8;
+    const float* c = data + prim_set->index_list[i + 2] * 8;
+    const float e0[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+    const float e1[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+    const float cross[3] = {
+      e0[1] * e1[2] - e0[2] * e1[1],
+      e0[2] * e1[0] - e0[0] * e1[2],
+      e0[0] * e1[1] - e0[1] * e1[0]
+    };
+    /* The grid faces up, i.e. a flipped triangle has a negative area. */
+    area += 0.5f * (cross[2] > 0.f ? 1.f : -1.f)
+      * sqrtf(cross[0]*cross[0] + cross[1]*cross[1] + cross[2]*cross[2]);
+  }
+  return area;
+}
+
+static void
+test_simplification
+  (struct rsrc_context* ctxt,
+   struct rsrc_wavefront_obj* wobj,
+   struct rsrc_geometry* geom)
+{
+  #define NB_QUADS 32
+  #define HEIGHT 0.25f
+  struct rsrc_geometry_stats stats;
+  struct rsrc_primitive_set prim_set;
+  struct rsrc_geometry* geom2 = NULL;
+  FILE* fp = NULL;
+  float error = 0.f;
+  float error2 = 0.f;
+  size_t i = 0;
+
+  fp = fopen(PATH, "w");
+  NCHECK(fp, NULL);
+  write_grid(fp, NB_QUADS, 0.f);
+  CHECK(fclose(fp), 0);
+  CHECK(rsrc_load_wavefront_obj(wobj, PATH), OK);
+  CHECK(rsrc_geometry_from_wavefront_obj(geom, wobj), OK);
+
+  CHECK(rsrc_simplify_geometry(NULL, 0.5f, NULL), BAD_ARG);
+  CHECK(rsrc_simplify_geometry(geom, -0.5f, NULL), BAD_ARG);
+  CHECK(rsrc_simplify_geometry(geom, 1.5f, NULL), BAD_ARG);
+  CHECK(rsrc_simplify_geometry(geom, 1.f, &error), OK);
+  CHECK(error, 0.f);
+  CHECK(rsrc_get_geometry_stats(geom, 16, &stats), OK);
+  CHECK(stats.nb_triangles, 2 * NB_QUADS * NB_QUADS);
+
+  /* A plane is simplified without error down to the 2 triangles of its
+   * corners. */
+  CHECK(rsrc_simplify_geometry(geom, 0.001f, &error), OK);
+  CHECK(error < 1.e-3f, true);
+  CHECK(rsrc_get_geometry_stats(geom, 16, &stats), OK);
+  CHECK(stats.nb_triangles, 2);
+  CHECK(stats.nb_vertices, 4);
+  CHECK(rsrc_get_primitive_set(geom, 0, &prim_set), OK);
+  CHECK(stats.nb_vertices, prim_set.sizeof_data / sizeof(float[8]));
+  CHECK(fabsf(triangles_area(&prim_set) - 1.f) < 1.e-3f, true);
+
+  /* The error of a bumped grid grows with the number of collapses. */
+  fp = fopen(PATH, "w");
+  NCHECK(fp, NULL);
+  write_grid(fp, NB_QUADS, HEIGHT);
+  CHECK(fclose(fp), 0);
+  CHECK(rsrc_load_wavefront_obj(wobj, PATH), OK);
+  CHECK(rsrc_geometry_from_wavefront_obj(geom, wobj), OK);
+  CHECK(rsrc_create_geometry(ctxt, &geom2), OK);
+  CHECK(rsrc_copy_geometry(geom2, geom), OK);
+  CHECK(rsrc_simplify_geometry(geom, 0.25f, &error), OK);
+  CHECK(rsrc_simplify_geometry(geom2, 0.05f, &error2), OK);
+  CHECK(error > 0.f, true);
+  CHECK(error < error2, true);
+  CHECK(error2 < HEIGHT, true);
+  CHECK(rsrc_get_geometry_stats(geom, 16, &stats), OK);
+  CHECK(stats.nb_triangles <= NB_QUADS * NB_QUADS / 2, true);
+  CHECK(rsrc_get_geometry_stats(geom2, 16, &stats), OK);
+  CHECK(stats.nb_triangles <= NB_QUADS * NB_QUADS / 10, true);
+
+  /* The remaining vertices are vertices of the initial grid. */
+  CHECK(rsrc_get_primitive_set(geom2, 0, &prim_set), OK);
+  CHECK(triangles_area(&prim_set) > 1.f, true);
+  for(i = 0; i < prim_set.sizeof_data / sizeof(float[8]); ++i) {
+    const float* pos = ((const float (*)[8])prim_set.data)[i];
+    const float z = grid_height(HEIGHT, pos[0], pos[1]);
+    CHECK(fabsf(pos[2] - z) < 1.e-4f, true);
+  }
+
+  /* A mapped geometry cannot be simplified. */
+  CHECK(rsrc_write_geometry(geom2, NULL, GEOM_PATH), OK);
+  CHECK(rsrc_load_geometry(geom2, NULL, GEOM_PATH), OK);
+  CHECK(rsrc_simplify_geometry(geom2, 0.5f, NULL), RSRC_INVALID_CALL);
+  CHECK(rsrc_flush_error(ctxt), OK);
+
+  CHECK(rsrc_geometry_ref_put(geom2), OK);
+  #undef NB_QUADS
+  #undef HEIGHT
+}
+
+int
+main(int argc, char** argv)
+{
+  #define MAX_N 32
+  #define NB_POLYS (NB_SHAPES * NB_PLANES * (MAX_N - 2))
+  bool flip_list[NB_POLYS];
+  float area_list[NB_POLYS];
+  struct rsrc_primitive_set prim_set;
+  struct rsrc_context* ctxt = NULL;
+  struct rsrc_wavefront_obj* wobj = NULL;
+  struct rsrc_primitive_set prim_set2;
+  struct rsrc_geometry* geom = NULL;
+  struct rsrc_geometry* geom2 = NULL;
+  FILE* fp = NULL;
+  size_t nb_triangles = 0;
+  size_t nb_prim_sets = 0;
+  size_t i = 0;
+  size_t j = 0;
+
+  if(argc != 1) {
+    printf("usage: %s\n", argv[0]);
+    goto error;
+  }
+
+  fp = fopen(PATH, "w");
+  NCHECK(fp, NULL);
+  nb_triangles = write_corpus(fp, MAX_N, flip_list, area_list);
+  CHECK(fclose(fp), 0);
+
+  CHECK(rsrc_create_context(NULL, &ctxt), OK);
+  CHECK(rsrc_create_wavefront_obj(ctxt, &wobj), OK);
+  CHECK(rsrc_create_geometry(ctxt, &geom), OK);
+
+  CHECK(rsrc_geometry_from_wavefront_obj(geom, NULL), BAD_ARG);
+
+  CHECK(rsrc_load_wavefront_obj(wobj, PATH), OK);
+  CHECK(rsrc_geometry_from_wavefront_obj(geom, wobj), OK);
+  CHECK(rsrc_get_primitive_set_count(geom, &nb_prim_sets), OK);
+  CHECK(nb_prim_sets, NB_POLYS);
+
+  for(i = 0, j = 0; i < nb_prim_sets; ++i) {
+    const float (*data)[8] = NULL;
+    float area = 0.f;
+    size_t k = 0;
+
+    CHECK(rsrc_get_primitive_set(geom, i, &prim_set), OK);
+    CHECK(prim_set.primitive_type, RSRC_TRIANGLE);
+    CHECK(prim_set.nb_indices % 3, 0);
+    j += prim_set.nb_indices / 3;
+    data = (const float (*)[8])prim_set.data;
+
+    /* Sum the signed area of the triangles in the plane of the polygon. A
+     * valid triangulation covers the polygon without any overlap and keeps
+     * its winding. */
+    for(k = 0; k < prim_set.nb_indices; k += 3) {
+      const float* a = data[prim_set.index_list[k + 0]];
+      const float* b = data[prim_set.index_list[k + 1]];
+      const float* c = data[prim_set.index_list[k + 2]];
+      const float e0[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+      const float e1[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+      const float cross[3] = {
+        e0[1] * e1[2] - e0[2] * e1[1],
+        e0[2] * e1[0] - e0[0] * e1[2],
+        e0[0] * e1[1] - e0[1] * e1[0]
+      };
+      const float tri_area =
+        sqrtf(cross[0]*cross[0] + cross[1]*cross[1] + cross[2]*cross[2]);
+      float plane_nor[3] = { 0.f, 0.f, 0.f };
+      float dot = 0.f;
+
+      switch((i / (MAX_N - 2)) % NB_PLANES) {
+        case PLANE_XY: plane_nor[2] = 1.f; break;
+        case PLANE_YZ: plane_nor[0] = 1.f; break;
+        case PLANE_ZX: plane_nor[1] = 1.f; break;
+        case PLANE_TILTED: plane_nor[1] = -0.8f; plane_nor[2] = 0.6f; break;
+        default: ERROR; break;
+      }
+      dot = cross[0] * plane_nor[0]
+          + cross[1] * plane_nor[1]
+          + cross[2] * plane_nor[2];
+      if(flip_list[i])
+        dot = -dot;
+      if(dot < -1.e-4f)
+        ERROR;
+      area += tri_area;
+    }
+    if(fabsf(area - area_list[i]) > 1.e-3f * area_list[i])
+      ERROR;
+  }
+  CHECK(j, nb_triangles);
+
+  /* Binary geometry round trip. */
+  CHECK(rsrc_create_geometry(ctxt, &geom2), OK);
+  CHECK(rsrc_write_geometry(NULL, NULL, NULL), BAD_ARG);
+  CHECK(rsrc_write_geometry(geom, NULL, NULL), BAD_ARG);
+  CHECK(rsrc_write_geometry(NULL, NULL, GEOM_PATH), BAD_ARG);
+  CHECK(rsrc_write_geometry(geom, PATH, GEOM_PATH), OK);
+  CHECK(rsrc_load_geometry(NULL, NULL, NULL), BAD_ARG);
+  CHECK(rsrc_load_geometry(geom2, NULL, NULL), BAD_ARG);
+  CHECK(rsrc_load_geometry(NULL, NULL, GEOM_PATH), BAD_ARG);
+  CHECK(rsrc_load_geometry(geom2, PATH, GEOM_PATH), OK);
+  CHECK(rsrc_get_primitive_set_count(geom2, &i), OK);
+  CHECK(i, nb_prim_sets);
+  for(i = 0; i < nb_prim_sets; ++i) {
+    CHECK(rsrc_get_primitive_set(geom, i, &prim_set), OK);
+    CHECK(rsrc_get_primitive_set(geom2, i, &prim_set2), OK);
+    CHECK(prim_set2.primitive_type, prim_set.primitive_type);
+    CHECK(prim_set2.sizeof_data, prim_set.sizeof_data);
+    CHECK(prim_set2.nb_indices, prim_set.nb_indices);
+    CHECK(prim_set2.nb_attribs, prim_set.nb_attribs);
+    CHECK(((uintptr_t)prim_set2.data) % 64, 0);
+    CHECK(((uintptr_t)prim_set2.index_list) % 64, 0);
+    CHECK(memcmp
+      (prim_set2.data, prim_set.data, prim_set.sizeof_data), 0);
+    CHECK(memcmp
+      (prim_set2.index_list,
+       prim_set.index_list,
+       prim_set.nb_indices * sizeof(unsigned int)), 0);
+    CHECK(memcmp
+      (prim_set2.attrib_list,
+       prim_set.attrib_list,
+       prim_set.nb_attribs * sizeof(struct rsrc_attrib)), 0);
+  }
+  /* A mapped geometry can be saved as well. */
+  CHECK(rsrc_write_geometry(geom2, NULL, GEOM_PATH), OK);
+  CHECK(rsrc_load_geometry(geom2, NULL, GEOM_PATH), OK);
+  CHECK(rsrc_get_primitive_set_count(geom2, &i), OK);
+  CHECK(i, nb_prim_sets);
+
+  /* The key of the file must match the source. A failed load keeps the
+   * loaded geometry. */
+  NCHECK(rsrc_load_geometry(geom2, PATH, GEOM_PATH), OK);
+  CHECK(rsrc_get_primitive_set_count(geom2, &i), OK);
+  CHECK(i, nb_prim_sets);
+  CHECK(rsrc_write_geometry(geom, PATH, GEOM_PATH), OK);
+  fp = fopen(PATH, "a");
+  NCHECK(fp, NULL);
+  fprintf(fp, "# Update the size of the source.\n");
+  CHECK(fclose(fp), 0);
+  NCHECK(rsrc_load_geometry(geom2, PATH, GEOM_PATH), OK);
+
+  /* Symbolic links are not followed. */
+  CHECK(rsrc_write_geometry(geom, PATH, GEOM_PATH), OK);
+  remove(GEOM_PATH ".link");
+  CHECK(symlink(GEOM_PATH, GEOM_PATH ".link"), 0);
+  NCHECK(rsrc_load_geometry(geom2, PATH, GEOM_PATH ".link"), OK);
+  CHECK(remove(GEOM_PATH ".link"), 0);
+
+  /* Corrupted files are rejected. */
+  CHECK(rsrc_write_geometry(geom, PATH, GEOM_PATH), OK);
+  CHECK(rsrc_load_geometry(geom2, PATH, GEOM_PATH), OK);
+  CHECK(rsrc_clear_geometry(geom2), OK);
+  fp = fopen(GEOM_PATH, "r+");
+  NCHECK(fp, NULL);
+  CHECK(fseek(fp, 1000, SEEK_SET), 0);
+  CHECK(fputc(0xFF ^ fgetc(fp), fp) == EOF, false);
+  CHECK(fclose(fp), 0);
+  NCHECK(rsrc_load_geometry(geom2, PATH, GEOM_PATH), OK);
+  /* So are the indices that do not reference a vertex. */
+  CHECK(rsrc_write_geometry(geom, PATH, GEOM_PATH), OK);
+  write_invalid_index(GEOM_PATH);
+  NCHECK(rsrc_load_geometry(geom2, PATH, GEOM_PATH), OK);
+  CHECK(rsrc_flush_error(ctxt), OK);
+  CHECK(rsrc_geometry_ref_put(geom2), OK);
+
+  /* Polygons with too many vertices cannot be triangulated. */
+  fp = fopen(PATH, "w");
+  NCHECK(fp, NULL);
+  for(i = 0; i < 257; ++i) {
+    float v2[2];
+    shape_vertex(SHAPE_STAR, 257, i, v2);
+    fprintf(fp, "v %f %f 0\n", v2[0], v2[1]);
+  }
+  fprintf(fp, "vt 0 0\nvn 0 0 1\ng big\nf");
+  for(i = 0; i < 257; ++i)
+    fprintf(fp, " %zu/1/1", i + 1);
+  fprintf(fp, "\n");
+  CHECK(fclose(fp), 0);
+  CHECK(rsrc_load_wavefront_obj(wobj, PATH), OK);
+  NCHECK(rsrc_geometry_from_wavefront_obj(geom, wobj), OK);
+  CHECK(rsrc_get_primitive_set_count(geom, &nb_prim_sets), OK);
+  CHECK(nb_prim_sets, 0);
+  CHECK(rsrc_flush_error(ctxt), OK);
+
+  test_optimization(ctxt, wobj, geom);
+  test_simplification(ctxt, wobj, geom);
+
+  CHECK(rsrc_geometry_ref_put(geom), OK);
+  CHECK(rsrc_wavefront_obj_ref_put(wobj), OK);
+  CHECK(rsrc_context_ref_put(ctxt), OK);
+
+  CHECK(MEM_ALLOCATED_SIZE(&mem_default_allocator), 0);
+  #undef MAX_N
+  #undef NB_POLYS
+  return 0;
+
+error:
+  return -1;
+}
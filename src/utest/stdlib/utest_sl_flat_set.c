@@ -39,6 +39,7 @@ main(int argc UNUSED, char** argv UNUSED)
   void* data = NULL;
   size_t capacity = 0;
   size_t capacity2 = 0;
+  size_t i = 0;
   size_t id = 0;
   size_t len = 0;
   size_t sz = 0;
@@ -346,6 +347,36 @@ main(int argc UNUSED, char** argv UNUSED)
   CHECK(sl_flat_set_insert(vec, &array[1], NULL), BAD_ALIGN);
   CHECK(sl_free_flat_set(vec), OK);
 
+  CHECK(sl_create_flat_set(SZ(int), AL(int), cmp, NULL, &vec), OK);
+  CHECK(sl_flat_set_insert_n(NULL, 0, NULL), BAD_ARG);
+  CHECK(sl_flat_set_insert_n(vec, 0, NULL), OK);
+  CHECK(sl_flat_set_insert_n(vec, 2, NULL), BAD_ARG);
+  CHECK(sl_flat_set_insert(vec, (int[]){4}, NULL), OK);
+  CHECK(sl_flat_set_insert(vec, (int[]){1}, NULL), OK);
+  CHECK(sl_flat_set_insert_n(vec, 3, (int[]){7, 4, 2}), BAD_ARG);
+  CHECK(sl_flat_set_insert_n(vec, 3, (int[]){7, 3, 7}), BAD_ARG);
+  CHECK(sl_flat_set_length(vec, &len), OK);
+  CHECK(len, 2);
+  CHECK(sl_flat_set_insert_n(vec, 4, (int[]){7, 0, 2, 5}), OK);
+  CHECK(sl_flat_set_buffer(vec, &len, NULL, NULL, &buffer), OK);
+  CHECK(len, 6);
+  CHECK(((int*)buffer)[0], 0);
+  CHECK(((int*)buffer)[1], 1);
+  CHECK(((int*)buffer)[2], 2);
+  CHECK(((int*)buffer)[3], 4);
+  CHECK(((int*)buffer)[4], 5);
+  CHECK(((int*)buffer)[5], 7);
+  CHECK(sl_flat_set_find(vec, (int[]){5}, &id), OK);
+  CHECK(id, 4);
+  CHECK(sl_flat_set_insert_n(vec, 4, (int[]){9, -1, 6, 3}), OK);
+  CHECK(sl_flat_set_buffer(vec, &len, NULL, NULL, &buffer), OK);
+  CHECK(len, 10);
+  for(i = 0; i < 8; ++i)
+    CHECK(((int*)buffer)[i], (int)i - 1);
+  CHECK(((int*)buffer)[8], 7);
+  CHECK(((int*)buffer)[9], 9);
+  CHECK(sl_free_flat_set(vec), OK);
+
   CHECK(MEM_ALLOCATED_SIZE(&mem_default_allocator), 0);
 
   return 0;
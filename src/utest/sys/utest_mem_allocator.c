@@ -81,6 +81,12 @@ main(int argc UNUSED, char** argv UNUSED)
   regular_test(&allocator);
   mem_shutdown_proxy_allocator(&allocator);
 
+  printf("\nRegular allocator\n");
+  mem_init_regular_allocator(&allocator);
+  CHECK(MEM_IS_ALLOCATOR_VALID(&allocator), true);
+  regular_test(&allocator);
+  mem_shutdown_regular_allocator(&allocator);
+
   CHECK(MEM_ALLOCATED_SIZE(&mem_default_allocator), 0);
 
   return 0;
@@ -0,0 +1,123 @@
+#include "sys/clock_time.h"
+#include "sys/profiler.h"
+#include "sys/sys.h"
+#include "utest/utest.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static size_t
+count(const char* str, const char* pattern)
+{
+  size_t i = 0;
+  while(NULL != (str = strstr(str, pattern))) {
+    ++str;
+    ++i;
+  }
+  return i;
+}
+
+static void
+scoped_zone(void)
+{
+  PROF_SCOPE("scope");
+  PROF_BEGIN("inner \"quoted\"");
+  PROF_END();
+}
+
+static void
+test_clock(void)
+{
+  struct time t0, t1, dt;
+  int64_t ticks0 = 0;
+  int64_t ticks1 = 0;
+  int64_t nsec = 0;
+
+  current_time(&t0);
+  ticks0 = clock_ticks();
+  do {
+    current_time(&t1);
+    time_sub(&dt, &t1, &t0);
+  } while(time_val(&dt, TIME_MSEC) < 20);
+  ticks1 = clock_ticks();
+  CHECK(ticks1 >= ticks0, true);
+
+  /* The converted ticks are on the timeline of the monotonic clock. */
+  nsec = clock_ticks_to_nsec(ticks1) - clock_ticks_to_nsec(ticks0);
+  CHECK(nsec >= 19000000L, true);
+  CHECK(nsec < 1000000000L, true);
+  current_time(&t1);
+  time_sub(&dt, &t1, &t0);
+  CHECK(clock_ticks_to_nsec(ticks1) - time_val(&t0, TIME_NSEC)
+     <= time_val(&dt, TIME_NSEC) + 1000000L, true);
+}
+
+static void
+test_profiler(void)
+{
+  char buf[BUFSIZ];
+  FILE* stream = NULL;
+  size_t len = 0;
+  int i = 0;
+
+  CHECK(prof_is_enabled(), false);
+  /* Zones are not recorded while the profiler is disabled. The thread name is
+   * applied once the thread records its first zone. */
+  prof_thread_name("main");
+  PROF_BEGIN("disabled");
+  PROF_END();
+
+  prof_enable(true);
+  CHECK(prof_is_enabled(), true);
+  PROF_BEGIN("frame");
+  for(i = 0; i < 3; ++i) {
+    PROF_BEGIN("draw");
+    PROF_END();
+  }
+  scoped_zone();
+  PROF_END();
+  /* An unbalanced end is ignored. */
+  PROF_END();
+  prof_enable(false);
+  PROF_BEGIN("disabled");
+  PROF_END();
+
+  CHECK(prof_dump_chrome_trace(NULL), -1);
+  stream = tmpfile();
+  NCHECK(stream, NULL);
+  CHECK(prof_dump_chrome_trace(stream), 0);
+  rewind(stream);
+  len = fread(buf, 1, sizeof(buf) - 1, stream);
+  buf[len] = '\0';
+  fclose(stream);
+
+  CHECK(strncmp(buf, "{\"displayTimeUnit\"", 18), 0);
+  CHECK(count(buf, "\"ph\":\"X\""), 6);
+  CHECK(count(buf, "\"ph\":\"M\""), 1);
+  CHECK(count(buf, "\"name\":\"main\""), 1);
+  CHECK(count(buf, "\"name\":\"frame\""), 1);
+  CHECK(count(buf, "\"name\":\"draw\""), 3);
+  CHECK(count(buf, "\"name\":\"scope\""), 1);
+  CHECK(count(buf, "\"name\":\"inner \\\"quoted\\\"\""), 1);
+  CHECK(count(buf, "disabled"), 0);
+  CHECK(strcmp(buf + len - 3, "]}\n"), 0);
+
+  prof_clear();
+  stream = tmpfile();
+  NCHECK(stream, NULL);
+  CHECK(prof_dump_chrome_trace(stream), 0);
+  rewind(stream);
+  len = fread(buf, 1, sizeof(buf) - 1, stream);
+  buf[len] = '\0';
+  fclose(stream);
+  CHECK(count(buf, "\"ph\":\"X\""), 0);
+}
+
+int
+main(int argc UNUSED, char** argv UNUSED)
+{
+  test_clock();
+  test_profiler();
+  return 0;
+}